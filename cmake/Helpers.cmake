@@ -12,6 +12,8 @@ macro(set_common_target_properties TARGET)
     if(USE_TRACY_PROFILER)
         target_compile_definitions(${TARGET} PRIVATE TRACY_ENABLE TRACY_ON_DEMAND)
         target_link_libraries(${TARGET} PUBLIC Threads::Threads)
+    elseif(USE_TRACE_PROFILER)
+        target_compile_definitions(${TARGET} PRIVATE TRACE_PROFILER_ENABLE)
     endif()
 endmacro()
 
@@ -38,15 +38,145 @@
 #include "core/method_bind_interface.h"
 #include "core/method_info.h"
 #include "core/object.h"
+#include "core/os/mutex.h"
+#include "core/os/reader_epoch.h"
 #include "core/os/rw_lock.h"
 #include "core/string_utils.h"
 #include "core/version.h"
+#include <atomic>
 #include <cassert>
 
 #define OBJTYPE_RLOCK RWLockRead _rw_lockr_(classdb_lock);
 #define OBJTYPE_WLOCK RWLockWrite _rw_lockw_(classdb_lock);
 static RWLock classdb_lock;
 
+// Flattened dispatch tables are read without taking classdb_lock, so a table is never modified once published and a
+// stale one is replaced by a fresh table. Lookups hold a ReaderEpoch::Scope while they use a table, a replaced table
+// is retired and freed once no lookup can still be using it.
+static ReaderEpoch dispatch_readers;
+// Guarded by dispatch_tables_mutex: tables replaced during the current epoch, and during the previous one.
+static Vector<ClassDB_DispatchTable *> retired_dispatch_tables;
+static Vector<ClassDB_DispatchTable *> waiting_dispatch_tables;
+static Mutex dispatch_tables_mutex;
+static std::atomic<bool> dispatch_enabled { false };
+// Bumped whenever a registration may change what a name resolves to, tables of older generations are rebuilt on use.
+static std::atomic<uint32_t> dispatch_generation { 1 };
+
+static void _free_dispatch_tables(Vector<ClassDB_DispatchTable *> &r_tables) {
+    for (ClassDB_DispatchTable *table : r_tables) {
+        memdelete(table);
+    }
+    r_tables.clear();
+}
+
+// Caller holds dispatch_tables_mutex.
+static void _reclaim_dispatch_tables() {
+    if (!waiting_dispatch_tables.empty()) {
+        if (!dispatch_readers.previous_done()) {
+            return;
+        }
+        _free_dispatch_tables(waiting_dispatch_tables);
+    }
+    if (retired_dispatch_tables.empty()) {
+        return;
+    }
+    waiting_dispatch_tables.swap(retired_dispatch_tables);
+    dispatch_readers.advance();
+    if (dispatch_readers.previous_done()) {
+        _free_dispatch_tables(waiting_dispatch_tables);
+    }
+}
+
+static ClassDB_DispatchTable *_build_dispatch(const ClassDB_ClassInfo *p_type, uint32_t p_generation) {
+    ClassDB_DispatchTable *table = memnew(ClassDB_DispatchTable);
+    table->generation = p_generation;
+    // most derived first, so a name keeps the entry the chain walk would have stopped at
+    for (const ClassDB_ClassInfo *check = p_type; check; check = check->inherits_ptr) {
+        for (const auto &m : check->method_map) {
+            table->methods.insert(m);
+        }
+        for (const auto &p : check->property_setget) {
+            table->properties.insert(p);
+        }
+        for (const auto &c : check->constant_map) {
+            if (!table->properties.contains(c.first)) {
+                table->constants.insert(c);
+            }
+        }
+    }
+    return table;
+}
+
+// Caller holds classdb_lock for reading, so no registration runs while the table is built, and a
+// ReaderEpoch::Scope on dispatch_readers for as long as it uses the table.
+static const ClassDB_DispatchTable *_get_dispatch_locked(const ClassDB_ClassInfo *p_type) {
+    if (!p_type || !dispatch_enabled.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    const uint32_t generation = dispatch_generation.load(std::memory_order_acquire);
+    const ClassDB_DispatchTable *table = p_type->dispatch.table.load(std::memory_order_acquire);
+    if (table && table->generation == generation) {
+        return table;
+    }
+
+    ClassDB_DispatchTable *fresh = _build_dispatch(p_type, generation);
+    MutexLock guard(dispatch_tables_mutex);
+    // another reader may have published the same generation meanwhile
+    table = p_type->dispatch.table.load(std::memory_order_acquire);
+    if (table && table->generation == generation) {
+        memdelete(fresh);
+        return table;
+    }
+    p_type->dispatch.table.store(fresh, std::memory_order_release);
+    if (table) {
+        retired_dispatch_tables.push_back(const_cast<ClassDB_DispatchTable *>(table));
+        _reclaim_dispatch_tables();
+    }
+    return fresh;
+}
+
+// Caller holds a ReaderEpoch::Scope on dispatch_readers for as long as it uses the table.
+static const ClassDB_DispatchTable *_get_dispatch(const ClassDB_ClassInfo *p_type) {
+    if (!p_type || !dispatch_enabled.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    const ClassDB_DispatchTable *table = p_type->dispatch.table.load(std::memory_order_acquire);
+    if (table && table->generation == dispatch_generation.load(std::memory_order_acquire)) {
+        return table;
+    }
+    RWLockRead _rw_lockr_(classdb_lock);
+    return _get_dispatch_locked(p_type);
+}
+
+static bool _has_method_walk(const ClassDB_ClassInfo *p_type, const StringName &p_method, bool p_no_inheritance) {
+    for (const ClassDB_ClassInfo *check = p_type; check; check = check->inherits_ptr) {
+        if (check->method_map.contains(p_method)) {
+            return true;
+        }
+        if (p_no_inheritance) {
+            return false;
+        }
+    }
+    return false;
+}
+
+// The result may point into a dispatch table, see _get_dispatch().
+static const ClassDB_PropertySetGet *_find_property_setget(const ClassDB_ClassInfo *p_type, const StringName &p_property) {
+    if (const ClassDB_DispatchTable *table = _get_dispatch(p_type)) {
+        auto iter = table->properties.find(p_property);
+        return iter != table->properties.end() ? &iter->second : nullptr;
+    }
+    const ClassDB_ClassInfo *check = p_type;
+    while (check) {
+        auto iter = check->property_setget.find(p_property);
+        if (iter != check->property_setget.end()) {
+            return &iter->second;
+        }
+        check = check->inherits_ptr;
+    }
+    return nullptr;
+}
+
 #ifdef DEBUG_METHODS_ENABLED
 
 // MethodDefinition D_METHOD(StringName p_name) {
@@ -367,6 +497,29 @@ Object *ClassDB::instance(const StringName &p_class) {
     return ti->creation_func();
 }
 
+// Same resolution as instance(), but returns the class info so callers creating many objects of one class can
+// keep its creation_func around instead of going through the lookup every time.
+const ClassDB_ClassInfo *ClassDB::get_instancing_info(const StringName &p_class) {
+    const ClassDB_ClassInfo *ti;
+    {
+        RWLockRead _rw_lockr_(classdb_lock);
+        auto iter = classes.find(p_class);
+        if (iter == classes.end() || iter->second.disabled || !iter->second.creation_func) {
+            if (compat_classes.contains(p_class)) {
+                iter = classes.find(compat_classes[p_class]);
+            }
+        }
+        if (iter == classes.end() || iter->second.disabled || !iter->second.creation_func) {
+            return nullptr;
+        }
+        ti = &iter->second;
+    }
+    if (!Tooling::class_can_instance_cb(const_cast<ClassDB_ClassInfo *>(ti), p_class)) {
+        return nullptr;
+    }
+    return ti;
+}
+
 bool ClassDB::can_instance(const StringName &p_class) {
     RWLockRead _rw_lockr_(classdb_lock);
 
@@ -493,6 +646,10 @@ MethodBind *ClassDB::get_method(StringName p_class, StringName p_name) {
     auto iter = classes.find(p_class);
 
     ClassDB_ClassInfo *type = iter != classes.end() ? &iter->second : nullptr;
+    ReaderEpoch::Scope scope(dispatch_readers);
+    if (const ClassDB_DispatchTable *table = _get_dispatch_locked(type)) {
+        return table->methods.at(p_name, nullptr);
+    }
     while (type) {
         MethodBind *method = type->method_map.at(p_name, nullptr);
         if (method) {
@@ -503,6 +660,17 @@ MethodBind *ClassDB::get_method(StringName p_class, StringName p_name) {
     return nullptr;
 }
 
+MethodBind *ClassDB::get_method_cached(ClassDB_MethodCache &r_cache, const StringName &p_class, const StringName &p_name) {
+    const uint32_t generation = dispatch_generation.load(std::memory_order_acquire);
+    if (r_cache.generation != generation || r_cache.class_name != p_class || r_cache.method_name != p_name) {
+        r_cache.method = get_method(p_class, p_name);
+        r_cache.class_name = p_class;
+        r_cache.method_name = p_name;
+        r_cache.generation = generation;
+    }
+    return r_cache.method;
+}
+
 HashMap<StringName, MethodInfo> *ClassDB::get_signal_list(const StringName &p_class) {
     RWLockRead _rw_lockr_(classdb_lock);
 
@@ -542,6 +710,7 @@ void ClassDB::bind_integer_constant(
     }
 
     type->constant_map[p_name] = p_constant;
+    invalidate_dispatch_tables();
 
     StringView enum_name(p_enum);
     if (!p_enum.empty()) {
@@ -834,6 +1003,7 @@ void ClassDB::add_property(StringName p_class, const PropertyInfo &p_pinfo, cons
     psg.type = p_pinfo.type;
 
     type->property_setget[p_pinfo.name] = psg;
+    invalidate_dispatch_tables();
 }
 
 void ClassDB::set_property_default_value(StringName p_class, const StringName &p_name, const Variant &p_default) {
@@ -867,80 +1037,95 @@ void ClassDB::get_property_list(
 bool ClassDB::set_property(Object *p_object, const StringName &p_property, const Variant &p_value, bool *r_valid) {
     ERR_FAIL_NULL_V(p_object, false);
     auto iter = classes.find(p_object->get_class_name());
-    ClassDB_ClassInfo *type = iter != classes.end() ? &iter->second : nullptr;
-    ClassDB_ClassInfo *check = type;
-    while (check) {
-        auto iter = check->property_setget.find(p_property);
-        if (iter != check->property_setget.end()) {
-            const ClassDB_PropertySetGet &psg(iter->second);
-            if (!psg.setter) {
-                if (r_valid) {
-                    *r_valid = false;
-                }
-                return true; // return true but do nothing
-            }
-
-            Callable::CallError ce;
+    const ClassDB_ClassInfo *type = iter != classes.end() ? &iter->second : nullptr;
+    ReaderEpoch::Scope scope(dispatch_readers);
+    const ClassDB_PropertySetGet *found = _find_property_setget(type, p_property);
+    if (!found) {
+        return false;
+    }
 
-            if (psg.index >= 0) {
-                Variant index = psg.index;
-                const Variant *arg[2] = { &index, &p_value };
-                // p_object->call(psg.setter,arg,2,ce);
-                if (psg._setptr) {
-                    psg._setptr->call(p_object, arg, 2, ce);
-                } else {
-                    p_object->call(psg.setter, arg, 2, ce);
-                }
+    const ClassDB_PropertySetGet &psg(*found);
+    if (!psg.setter) {
+        if (r_valid) {
+            *r_valid = false;
+        }
+        return true; // return true but do nothing
+    }
 
-            } else {
-                const Variant *arg[1] = { &p_value };
-                if (psg._setptr) {
-                    psg._setptr->call(p_object, arg, 1, ce);
-                } else {
-                    p_object->call(psg.setter, arg, 1, ce);
-                }
-            }
+    Callable::CallError ce;
 
-            if (r_valid) {
-                *r_valid = ce.error == Callable::CallError::CALL_OK;
-            }
+    if (psg.index >= 0) {
+        Variant index = psg.index;
+        const Variant *arg[2] = { &index, &p_value };
+        // p_object->call(psg.setter,arg,2,ce);
+        if (psg._setptr) {
+            psg._setptr->call(p_object, arg, 2, ce);
+        } else {
+            p_object->call(psg.setter, arg, 2, ce);
+        }
 
-            return true;
+    } else {
+        const Variant *arg[1] = { &p_value };
+        if (psg._setptr) {
+            psg._setptr->call(p_object, arg, 1, ce);
+        } else {
+            p_object->call(psg.setter, arg, 1, ce);
         }
+    }
 
-        check = check->inherits_ptr;
+    if (r_valid) {
+        *r_valid = ce.error == Callable::CallError::CALL_OK;
     }
 
-    return false;
+    return true;
+}
+static bool _get_property_value(Object *p_object, const ClassDB_PropertySetGet &psg, Variant &r_value) {
+    if (!psg.getter) {
+        return true; // return true but do nothing
+    }
+
+    if (psg.index >= 0) {
+        Variant index = psg.index;
+        const Variant *arg[1] = { &index };
+        Callable::CallError ce;
+        r_value = p_object->call(psg.getter, arg, 1, ce);
+
+    } else {
+        Callable::CallError ce;
+        if (psg._getptr) {
+            r_value = psg._getptr->call(p_object, nullptr, 0, ce);
+        } else {
+            r_value = p_object->call(psg.getter, nullptr, 0, ce);
+        }
+    }
+    return true;
 }
+
 bool ClassDB::get_property(Object *p_object, const StringName &p_property, Variant &r_value) {
     ERR_FAIL_NULL_V(p_object, false);
     auto iter = classes.find(p_object->get_class_name());
     ClassDB_ClassInfo *type = iter != classes.end() ? &iter->second : nullptr;
+
+    ReaderEpoch::Scope scope(dispatch_readers);
+    if (const ClassDB_DispatchTable *table = _get_dispatch(type)) {
+        // the table only keeps constants no property hides, so one found there wins like it would in the chain walk
+        auto iter3 = table->constants.find(p_property);
+        if (iter3 != table->constants.end()) {
+            r_value = iter3->second;
+            return true;
+        }
+        auto iter2 = table->properties.find(p_property);
+        if (iter2 != table->properties.end()) {
+            return _get_property_value(p_object, iter2->second, r_value);
+        }
+        return false;
+    }
+
     ClassDB_ClassInfo *check = type;
     while (check) {
         auto iter2 = check->property_setget.find(p_property);
         if (iter2 != check->property_setget.end()) {
-            const ClassDB_PropertySetGet &psg(iter2->second);
-            if (!psg.getter) {
-                return true; // return true but do nothing
-            }
-
-            if (psg.index >= 0) {
-                Variant index = psg.index;
-                const Variant *arg[1] = { &index };
-                Callable::CallError ce;
-                r_value = p_object->call(psg.getter, arg, 1, ce);
-
-            } else {
-                Callable::CallError ce;
-                if (psg._getptr) {
-                    r_value = psg._getptr->call(p_object, nullptr, 0, ce);
-                } else {
-                    r_value = p_object->call(psg.getter, nullptr, 0, ce);
-                }
-            }
-            return true;
+            return _get_property_value(p_object, iter2->second, r_value);
         }
         auto iter = check->constant_map.find(p_property);
         if (iter != check->constant_map.end()) {
@@ -956,20 +1141,14 @@ bool ClassDB::get_property(Object *p_object, const StringName &p_property, Varia
 
 int ClassDB::get_property_index(const StringName &p_class, const StringName &p_property, bool *r_is_valid) {
     auto iter = classes.find(p_class);
-    ClassDB_ClassInfo *type = iter != classes.end() ? &iter->second : nullptr;
-    ClassDB_ClassInfo *check = type;
-    while (check) {
-        auto iter2 = check->property_setget.find(p_property);
-        if (iter2 != check->property_setget.end()) {
-            const ClassDB_PropertySetGet &psg(iter2->second);
-            if (r_is_valid) {
-                *r_is_valid = true;
-            }
-
-            return psg.index;
+    const ClassDB_ClassInfo *type = iter != classes.end() ? &iter->second : nullptr;
+    ReaderEpoch::Scope scope(dispatch_readers);
+    if (const ClassDB_PropertySetGet *psg = _find_property_setget(type, p_property)) {
+        if (r_is_valid) {
+            *r_is_valid = true;
         }
 
-        check = check->inherits_ptr;
+        return psg->index;
     }
     if (r_is_valid) {
         *r_is_valid = false;
@@ -1021,6 +1200,22 @@ StringName ClassDB::get_property_setter(StringName p_class, const StringName &p_
     return StringName();
 }
 
+const ClassDB_PropertySetGet *ClassDB::get_property_setget(StringName p_class, const StringName &p_property) {
+    auto iter = classes.find(p_class);
+    // The result outlives any lookup scope, so it has to point into the class itself rather than a dispatch table.
+    ClassDB_ClassInfo *check = iter != classes.end() ? &iter->second : nullptr;
+    while (check) {
+        auto iter2 = check->property_setget.find(p_property);
+        if (iter2 != check->property_setget.end()) {
+            return &iter2->second;
+        }
+
+        check = check->inherits_ptr;
+    }
+
+    return nullptr;
+}
+
 StringName ClassDB::get_property_getter(StringName p_class, const StringName &p_property) {
     auto iter = classes.find(p_class);
     ClassDB_ClassInfo *type = iter != classes.end() ? &iter->second : nullptr;
@@ -1068,19 +1263,14 @@ void ClassDB::set_method_flags(StringName p_class, StringName p_method, int p_fl
 
 bool ClassDB::has_method(StringName p_class, StringName p_method, bool p_no_inheritance) {
     auto iter = classes.find(p_class);
-    ClassDB_ClassInfo *type = iter != classes.end() ? &iter->second : nullptr;
-    ClassDB_ClassInfo *check = type;
-    while (check) {
-        if (check->method_map.contains(p_method)) {
-            return true;
-        }
-        if (p_no_inheritance) {
-            return false;
+    const ClassDB_ClassInfo *type = iter != classes.end() ? &iter->second : nullptr;
+    if (!p_no_inheritance) {
+        ReaderEpoch::Scope scope(dispatch_readers);
+        if (const ClassDB_DispatchTable *table = _get_dispatch(type)) {
+            return table->methods.contains(p_method);
         }
-        check = check->inherits_ptr;
     }
-
-    return false;
+    return _has_method_walk(type, p_method, p_no_inheritance);
 }
 
 #ifdef DEBUG_METHODS_ENABLED
@@ -1101,7 +1291,9 @@ MethodBind *ClassDB::bind_methodfi(
 
 #ifdef DEBUG_ENABLED
 
-    ERR_FAIL_COND_V_MSG(has_method(StringName(instance_type), mdname), nullptr,
+    // classdb_lock is held for writing here, so walk the chain rather than going through dispatch tables
+    auto existing = classes.find(StringName(instance_type));
+    ERR_FAIL_COND_V_MSG(_has_method_walk(existing != classes.end() ? &existing->second : nullptr, mdname, false), nullptr,
             "Class " + String(instance_type) + " already has a method " + String(mdname) + ".");
 #endif
 
@@ -1132,6 +1324,7 @@ MethodBind *ClassDB::bind_methodfi(
 #endif
 
     type->method_map[mdname] = p_bind;
+    invalidate_dispatch_tables();
 
     Vector<Variant> defvals;
 
@@ -1313,8 +1506,36 @@ void ClassDB::cleanup_defaults() {
     default_values_cached.clear();
 }
 
+void ClassDB::build_dispatch_tables() {
+    OBJTYPE_RLOCK
+
+    dispatch_enabled.store(true, std::memory_order_release);
+    // Warm up every class now, whatever gets registered later is picked up lazily by the next lookup.
+    for (const auto &entry : classes) {
+        _get_dispatch_locked(&entry.second);
+    }
+}
+
+void ClassDB::set_dispatch_tables_enabled(bool p_enabled) {
+    dispatch_enabled.store(p_enabled, std::memory_order_release);
+}
+
+void ClassDB::invalidate_dispatch_tables() {
+    dispatch_generation.fetch_add(1, std::memory_order_acq_rel);
+}
+
+uint32_t ClassDB::get_dispatch_generation() {
+    return dispatch_generation.load(std::memory_order_acquire);
+}
+
 void ClassDB::cleanup() {
     // OBJTYPE_LOCK; hah not here
+    dispatch_enabled.store(false, std::memory_order_release);
+    for (auto &entry : classes) {
+        memdelete(const_cast<ClassDB_DispatchTable *>(entry.second.dispatch.table.exchange(nullptr)));
+    }
+    _free_dispatch_tables(waiting_dispatch_tables);
+    _free_dispatch_tables(retired_dispatch_tables);
     classes.clear();
     resource_base_extensions.clear();
     compat_classes.clear();
@@ -1337,11 +1558,13 @@ bool ClassDB::bind_helper(MethodBind *bind, const StringName &p_name) {
         memdelete(bind);
         ERR_FAIL_V_MSG(false,"can_bind_method==false");
     }
+    OBJTYPE_WLOCK
     auto iter = classes.find(StaticCString(bind->get_instance_class(), true));
     auto type = &iter->second;
     type->method_map[p_name] = bind;
 #ifdef DEBUG_METHODS_ENABLED
     type->method_order.push_back(p_name);
 #endif
+    invalidate_dispatch_tables();
     return true;
 }
@@ -40,6 +40,7 @@
 #include "core/os/rw_lock.h"
 #include "EASTL/vector.h"
 
+#include <atomic>
 #include <initializer_list>
 
 class MethodBind;
@@ -121,6 +122,25 @@ struct ClassDB_PropertySetGet {
     int index;
     VariantType type;
 };
+// Everything a class resolves through its inheritance chain, flattened into single lookups.
+// Built on first use for the current dispatch generation, never modified afterwards.
+struct ClassDB_DispatchTable {
+    HashMap<StringName, MethodBind *> methods;
+    HashMap<StringName, ClassDB_PropertySetGet> properties;
+    HashMap<StringName, int> constants; // only those not shadowed by a property of the same name
+    uint32_t generation = 0;
+};
+// Holds the table a class currently resolves through. Copies start empty, the table is rebuilt on demand.
+struct ClassDB_DispatchSlot {
+    mutable std::atomic<const ClassDB_DispatchTable *> table { nullptr };
+
+    ClassDB_DispatchSlot() = default;
+    ClassDB_DispatchSlot(const ClassDB_DispatchSlot &) {}
+    ClassDB_DispatchSlot &operator=(const ClassDB_DispatchSlot &) {
+        table.store(nullptr, std::memory_order_release);
+        return *this;
+    }
+};
 struct ClassDB_ClassInfo {
     ClassDB_APIType api = API_NONE;
     ClassDB_ClassInfo *inherits_ptr=nullptr;
@@ -138,6 +158,7 @@ struct ClassDB_ClassInfo {
     StringName category;
 #endif
     HashMap<StringName, ClassDB_PropertySetGet> property_setget;
+    ClassDB_DispatchSlot dispatch;
     String usage_header;
     Object *(*creation_func)() = nullptr;
 
@@ -152,6 +173,14 @@ struct ClassDB_ClassInfo {
     ~ClassDB_ClassInfo();
 };
 
+// Per call site cache of a resolved method, see ClassDB::get_method_cached.
+struct ClassDB_MethodCache {
+    StringName class_name;
+    StringName method_name;
+    MethodBind *method = nullptr;
+    uint32_t generation = 0;
+};
+
 class GODOT_EXPORT ClassDB final {
 public:
 
@@ -248,6 +277,7 @@ public:
     static bool is_parent_class(const StringName &p_class, const StringName &p_inherits);
     static bool can_instance(const StringName &p_class);
     static Object *instance(const StringName &p_class);
+    static const ClassDB_ClassInfo *get_instancing_info(const StringName &p_class);
     static ClassDB_APIType get_api_type(const StringName &p_class);
 
     static uint64_t get_api_hash(ClassDB_APIType p_api);
@@ -268,6 +298,7 @@ public:
     static int get_property_index(const StringName &p_class, const StringName &p_property, bool *r_is_valid = nullptr);
     static VariantType get_property_type(const StringName &p_class, const StringName &p_property, bool *r_is_valid = nullptr);
     static StringName get_property_setter(StringName p_class, const StringName &p_property);
+    static const ClassDB_PropertySetGet *get_property_setget(StringName p_class, const StringName &p_property);
     static StringName get_property_getter(StringName p_class, const StringName &p_property);
 
     static bool has_method(StringName p_class, StringName p_method, bool p_no_inheritance = false);
@@ -275,6 +306,7 @@ public:
 
     static void get_method_list(const StringName& p_class, Vector<MethodInfo> *p_methods, bool p_no_inheritance = false, bool p_exclude_from_properties = false);
     static MethodBind *get_method(StringName p_class, StringName p_name);
+    static MethodBind *get_method_cached(ClassDB_MethodCache &r_cache, const StringName &p_class, const StringName &p_name);
     static HashMap<StringName, MethodInfo> *get_signal_list(const StringName& p_class);
 
     static void add_virtual_method(const StringName &p_class, const MethodInfo &p_method);
@@ -306,6 +338,12 @@ public:
 
     static void set_current_api(ClassDB_APIType p_api);
     static ClassDB_APIType get_current_api();
+
+    static void build_dispatch_tables();
+    static void set_dispatch_tables_enabled(bool p_enabled);
+    static void invalidate_dispatch_tables();
+    static uint32_t get_dispatch_generation();
+
     static void cleanup_defaults();
     static void cleanup();
 };
@@ -24,6 +24,25 @@
 #define TRACE_FREE_N(p,n)
 #define TRACE_ALLOC_NS(p,sz,depth,n)
 #endif
+#elif defined(TRACE_PROFILER_ENABLE)
+#include "core/trace_profiler.h"
+
+#define TRACE_PROFILER_CONCAT_IMPL(a,b) a##b
+#define TRACE_PROFILER_CONCAT(a,b) TRACE_PROFILER_CONCAT_IMPL(a,b)
+#define SCOPE_PROFILE(name) TraceProfilerScope TRACE_PROFILER_CONCAT(trace_profiler_scope_,__LINE__)(#name);
+#define SCOPE_PROFILE_GPU(name) SCOPE_AUTONAMED
+#define SCOPE_AUTONAMED TraceProfilerScope TRACE_PROFILER_CONCAT(trace_profiler_scope_,__LINE__)(__FUNCTION__);
+#define PROFILER_FLIP()
+#define PROFILER_STARTFRAME(name) TraceProfiler::frame_start(name)
+#define PROFILER_ENDFRAME(name) TraceProfiler::frame_end(name)
+#define PROFILE_VALUE(name,value) TraceProfiler::record_value(name, double(value))
+#define PROFILE_VALUE_CFG(name,type)
+#define TRACE_ALLOC(p,sz)
+#define TRACE_ALLOC_S(p,sz,depth)
+#define TRACE_ALLOC_NS(p,sz,depth,n)
+#define TRACE_FREE(p)
+#define TRACE_ALLOC_N(p,sz,n)
+#define TRACE_FREE_N(p,n)
 #else
 #define SCOPE_PROFILE(name)
 #define SCOPE_PROFILE_GPU(name)
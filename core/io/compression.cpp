@@ -32,6 +32,9 @@
 
 #include "core/io/zip_io.h"
 #include "core/error_macros.h"
+#include "core/hash_map.h"
+#include "core/hashfuncs.h"
+#include "core/os/mutex.h"
 #include "core/vector.h"
 //#include "core/project_settings.h"
 
@@ -44,6 +47,7 @@ extern "C" {
 #include <zstd.h>
 
 #include <cstring>
+#include "EASTL/sort.h"
 
 int Compression::zlib_level = Z_DEFAULT_COMPRESSION;
 int Compression::gzip_level = Z_DEFAULT_COMPRESSION;
@@ -296,6 +300,130 @@ int Compression::decompress_dynamic(Vector<uint8_t> *p_dst, int p_max_dst_size,
     return Z_OK;
 }
 
+namespace {
+// Digested dictionaries, built on first use and kept until free_zstd_dictionaries(). Compression ones also depend
+// on the level, so they are keyed on both.
+Mutex zstd_dictionaries_mutex;
+HashMap<uint64_t, ZSTD_CDict *> zstd_cdicts;
+HashMap<uint32_t, ZSTD_DDict *> zstd_ddicts;
+
+// Each thread reuses its contexts, they only carry scratch memory from one call to the next.
+struct ZstdContexts {
+    ZSTD_CCtx *cctx = nullptr;
+    ZSTD_DCtx *dctx = nullptr;
+    ~ZstdContexts() {
+        ZSTD_freeCCtx(cctx);
+        ZSTD_freeDCtx(dctx);
+    }
+};
+thread_local ZstdContexts zstd_contexts;
+
+const ZSTD_CDict *get_zstd_cdict(uint32_t p_dict_id, const uint8_t *p_dict, int p_dict_size) {
+
+    const uint64_t key = (uint64_t(uint32_t(Compression::zstd_level)) << 32) | p_dict_id;
+    MutexGuard guard(zstd_dictionaries_mutex);
+    ZSTD_CDict *&cdict = zstd_cdicts[key];
+    if (!cdict)
+        cdict = ZSTD_createCDict(p_dict, p_dict_size, Compression::zstd_level);
+    return cdict;
+}
+
+const ZSTD_DDict *get_zstd_ddict(uint32_t p_dict_id, const uint8_t *p_dict, int p_dict_size) {
+
+    MutexGuard guard(zstd_dictionaries_mutex);
+    ZSTD_DDict *&ddict = zstd_ddicts[p_dict_id];
+    if (!ddict)
+        ddict = ZSTD_createDDict(p_dict, p_dict_size);
+    return ddict;
+}
+} // namespace
+
+int Compression::compress_zstd_dict(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, uint32_t p_dict_id, const uint8_t *p_dict, int p_dict_size) {
+
+    const ZSTD_CDict *cdict = get_zstd_cdict(p_dict_id, p_dict, p_dict_size);
+    ERR_FAIL_COND_V(!cdict, -1);
+    if (!zstd_contexts.cctx)
+        zstd_contexts.cctx = ZSTD_createCCtx();
+    size_t ret = ZSTD_compress_usingCDict(zstd_contexts.cctx, p_dst, get_max_compressed_buffer_size(p_src_size, MODE_ZSTD), p_src, p_src_size, cdict);
+    return ZSTD_isError(ret) ? -1 : int(ret);
+}
+
+int Compression::decompress_zstd_dict(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, uint32_t p_dict_id, const uint8_t *p_dict, int p_dict_size) {
+
+    const ZSTD_DDict *ddict = get_zstd_ddict(p_dict_id, p_dict, p_dict_size);
+    ERR_FAIL_COND_V(!ddict, -1);
+    if (!zstd_contexts.dctx)
+        zstd_contexts.dctx = ZSTD_createDCtx();
+    size_t ret = ZSTD_decompress_usingDDict(zstd_contexts.dctx, p_dst, p_dst_max_size, p_src, p_src_size, ddict);
+    return ZSTD_isError(ret) ? -1 : int(ret);
+}
+
+void Compression::free_zstd_dictionaries() {
+
+    MutexGuard guard(zstd_dictionaries_mutex);
+    for (auto &E : zstd_cdicts)
+        ZSTD_freeCDict(E.second);
+    for (auto &E : zstd_ddicts)
+        ZSTD_freeDDict(E.second);
+    zstd_cdicts.clear();
+    zstd_ddicts.clear();
+}
+
+/**
+    Builds a raw content dictionary out of the segments shared by the most samples. zstd takes anything without
+    the dictionary magic as raw content and matches against it like against earlier data, so the most common
+    segments are placed last, closest to the data being compressed.
+    This is a simple stand-in for zstd's dictionary trainer, which is not part of the bundled library.
+*/
+Vector<uint8_t> Compression::build_zstd_dictionary(const Vector<Vector<uint8_t> > &p_samples, int p_max_size) {
+
+    const int SEGMENT = 64;
+    const int STRIDE = 16;
+
+    struct Segment {
+        int samples = 0;
+        int last_sample = -1;
+        int sample = 0;
+        int offset = 0;
+    };
+    HashMap<uint32_t, Segment> segments;
+
+    for (int s = 0; s < int(p_samples.size()); s++) {
+        const Vector<uint8_t> &sample = p_samples[s];
+        for (int ofs = 0; ofs + SEGMENT <= int(sample.size()); ofs += STRIDE) {
+            Segment &seg = segments[hash_djb2_buffer(&sample[ofs], SEGMENT)];
+            if (seg.last_sample == s) {
+                continue; // only count each sample once
+            }
+            if (seg.samples == 0) {
+                seg.sample = s;
+                seg.offset = ofs;
+            }
+            seg.samples++;
+            seg.last_sample = s;
+        }
+    }
+
+    Vector<const Segment *> shared;
+    for (const auto &E : segments) {
+        if (E.second.samples > 1) {
+            shared.push_back(&E.second);
+        }
+    }
+    eastl::sort(shared.begin(), shared.end(), [](const Segment *a, const Segment *b) {
+        return a->samples > b->samples;
+    });
+
+    const int count = MIN(int(shared.size()), p_max_size / SEGMENT);
+    Vector<uint8_t> dict;
+    dict.resize(count * SEGMENT);
+    for (int i = 0; i < count; i++) {
+        const Segment *seg = shared[i];
+        memcpy(&dict[(count - 1 - i) * SEGMENT], &p_samples[seg->sample][seg->offset], SEGMENT);
+    }
+    return dict;
+}
+
 int Compression::compress_short_string(const char *in, int inlen, char *out, int outlen) {
     return smaz_compress(in, inlen, out, outlen);
 }
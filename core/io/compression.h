@@ -55,6 +55,13 @@ public:
     static int decompress(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, Mode p_mode = MODE_ZSTD);
     static int decompress_dynamic(Vector<uint8_t> *p_dst, int p_max_dst_size, const uint8_t *p_src, int p_src_size, Mode p_mode);
 
+    // MODE_ZSTD primed with a dictionary, either a zstd one or raw content resembling the data (see build_zstd_dictionary).
+    // p_dict_id must identify the dictionary contents: the digested dictionary is cached under it. Both return -1 on failure.
+    static int compress_zstd_dict(uint8_t *p_dst, const uint8_t *p_src, int p_src_size, uint32_t p_dict_id, const uint8_t *p_dict, int p_dict_size);
+    static int decompress_zstd_dict(uint8_t *p_dst, int p_dst_max_size, const uint8_t *p_src, int p_src_size, uint32_t p_dict_id, const uint8_t *p_dict, int p_dict_size);
+    static void free_zstd_dictionaries();
+    static Vector<uint8_t> build_zstd_dictionary(const Vector<Vector<uint8_t> > &p_samples, int p_max_size = 64 * 1024);
+
     static int compress_short_string(const char *in, int inlen, char *out, int outlen);
     static int decompress_short_string(const char *in, int inlen, char *out, int outlen);
     Compression() = delete; // not constructible
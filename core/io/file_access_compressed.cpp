@@ -30,9 +30,138 @@
 
 #include "file_access_compressed.h"
 
+#include "core/hash_map.h"
+#include "core/hashfuncs.h"
+#include "core/os/dir_access.h"
+#include "core/os/mutex.h"
+#include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
 #include "core/string.h"
+#include "core/string_formatter.h"
+#include "core/string_utils.h"
 #include "core/vector.h"
 
+#include <zlib.h>
+
+uint32_t FileAccessCompressed::default_block_size = 65536;
+int FileAccessCompressed::readahead_blocks = 4;
+String FileAccessCompressed::dictionary_path("res://.import/dictionaries");
+
+namespace {
+Mutex dictionaries_mutex;
+HashMap<uint32_t, Vector<uint8_t> > dictionaries;
+HashMap<String, uint32_t> type_dictionaries;
+
+// One pool for all compressed files. It runs one batch at a time: a file finding it busy reads its blocks
+// without read-ahead until the pool is released.
+Mutex readahead_pool_mutex;
+ThreadWorkPool *readahead_pool = nullptr;
+const FileAccessCompressed *readahead_pool_owner = nullptr;
+
+String dictionary_file(uint32_t p_id) {
+
+    return PathUtils::plus_file(FileAccessCompressed::dictionary_path, FormatVE("%08x.zdict", p_id));
+}
+
+// Looks the dictionary up in this session's ones first, then in dictionary_path. dictionaries_mutex must be held.
+bool find_dictionary(uint32_t p_id, Vector<uint8_t> &r_dictionary) {
+
+    auto E = dictionaries.find(p_id);
+    if (E != dictionaries.end()) {
+        r_dictionary = E->second;
+        return true;
+    }
+    if (FileAccessCompressed::dictionary_path.empty())
+        return false;
+
+    FileAccess *f = FileAccess::open(dictionary_file(p_id), FileAccess::READ);
+    if (!f)
+        return false;
+    Vector<uint8_t> loaded;
+    loaded.resize(f->get_len());
+    const bool ok = !loaded.empty() && f->get_buffer(loaded.data(), loaded.size()) == loaded.size();
+    memdelete(f);
+    if (!ok)
+        return false;
+    dictionaries[p_id] = loaded;
+    r_dictionary = eastl::move(loaded);
+    return true;
+}
+
+void store_dictionary(uint32_t p_id, const Vector<uint8_t> &p_dictionary) {
+
+    if (FileAccessCompressed::dictionary_path.empty())
+        return;
+
+    DirAccessRef da(DirAccess::create_for_path(FileAccessCompressed::dictionary_path));
+    da->make_dir_recursive(FileAccessCompressed::dictionary_path);
+    FileAccess *f = FileAccess::open(dictionary_file(p_id), FileAccess::WRITE);
+    ERR_FAIL_COND_MSG(!f, "Can't save compression dictionary to '" + FileAccessCompressed::dictionary_path + "', files using it can only be read in this session.");
+    f->store_buffer(p_dictionary.data(), p_dictionary.size());
+    memdelete(f);
+}
+
+uint32_t dictionary_crc(const Vector<uint8_t> &p_dictionary) {
+
+    return crc32(0, p_dictionary.data(), p_dictionary.size());
+}
+} // namespace
+
+uint32_t FileAccessCompressed::register_dictionary(const Vector<uint8_t> &p_dictionary) {
+
+    ERR_FAIL_COND_V(p_dictionary.empty(), 0);
+    uint32_t id = hash_djb2_buffer(p_dictionary.data(), p_dictionary.size());
+
+    MutexGuard guard(dictionaries_mutex);
+    Vector<uint8_t> existing;
+    for (;;) {
+        if (id == 0)
+            id = 1; // 0 means no dictionary
+        if (!find_dictionary(id, existing))
+            break;
+        if (existing == p_dictionary)
+            return id; // registered earlier, or saved by an earlier session
+        id++; // hash collision, probe the next id
+    }
+    dictionaries[id] = p_dictionary;
+    store_dictionary(id, p_dictionary);
+    return id;
+}
+
+bool FileAccessCompressed::get_registered_dictionary(uint32_t p_id, Vector<uint8_t> &r_dictionary) {
+
+    MutexGuard guard(dictionaries_mutex);
+    return find_dictionary(p_id, r_dictionary);
+}
+
+void FileAccessCompressed::finish_readahead_pool() {
+
+    MutexGuard guard(readahead_pool_mutex);
+    ERR_FAIL_COND_MSG(readahead_pool_owner, "A compressed file is still using the read-ahead pool.");
+    if (readahead_pool) {
+        readahead_pool->finish();
+        memdelete(readahead_pool);
+        readahead_pool = nullptr;
+    }
+}
+
+void FileAccessCompressed::set_type_dictionary(const StringName &p_type, const Vector<uint8_t> &p_dictionary) {
+
+    uint32_t id = p_dictionary.empty() ? 0 : register_dictionary(p_dictionary);
+    MutexGuard guard(dictionaries_mutex);
+    if (id)
+        type_dictionaries[String(p_type)] = id;
+    else
+        type_dictionaries.erase(String(p_type));
+}
+
+uint32_t FileAccessCompressed::get_type_dictionary(const StringName &p_type) {
+
+    MutexGuard guard(dictionaries_mutex);
+    auto E = type_dictionaries.find(String(p_type));
+    return E != type_dictionaries.end() ? E->second : 0;
+}
+
 void FileAccessCompressed::configure(StringView p_magic, Compression::Mode p_mode, uint32_t p_block_size) {
 
     if (p_magic.length() > 4)
@@ -44,7 +173,19 @@ void FileAccessCompressed::configure(StringView p_magic, Compression::Mode p_mod
     }
 
     cmode = p_mode;
-    block_size = p_block_size;
+    block_size = p_block_size ? p_block_size : default_block_size;
+}
+
+void FileAccessCompressed::set_dictionary_id(uint32_t p_id) {
+
+    if (p_id == 0) {
+        dictionary_id = 0;
+        dictionary.clear();
+        return;
+    }
+    ERR_FAIL_COND_MSG(cmode != Compression::MODE_ZSTD, "Dictionaries can only be used with zstd compression.");
+    ERR_FAIL_COND_MSG(!get_registered_dictionary(p_id, dictionary), "Compression dictionary was not registered.");
+    dictionary_id = p_id;
 }
 
 #define WRITE_FIT(m_bytes)                                  \
@@ -59,18 +200,173 @@ void FileAccessCompressed::configure(StringView p_magic, Compression::Mode p_mod
         }                                                   \
     }
 
+int FileAccessCompressed::_decompress_block(uint8_t *p_dst, uint32_t p_size, const uint8_t *p_src, uint32_t p_csize) const {
+
+    if (dictionary_id)
+        return Compression::decompress_zstd_dict(p_dst, p_size, p_src, p_csize, dictionary_id, dictionary.data(), dictionary.size());
+    return Compression::decompress(p_dst, p_size, p_src, p_csize, cmode);
+}
+
+void FileAccessCompressed::ReadAheadJob::process(uint32_t p_index, ReadAheadWindow *p_window) {
+
+    const Vector<uint8_t> &comp = p_window->comp[p_index];
+    p_window->sizes[p_index] = file->_decompress_block(p_window->data[p_index].data(), file->block_size, comp.data(), comp.size());
+}
+
+void FileAccessCompressed::_finish_readahead() const {
+
+    if (filling_window != -1) {
+        readahead_pool->end_work();
+        filling_window = -1;
+
+        MutexGuard guard(readahead_pool_mutex);
+        readahead_pool_owner = nullptr;
+    }
+}
+
+bool FileAccessCompressed::_take_readahead_block(int p_block) const {
+
+    for (int w = 0; w < 2; w++) {
+        ReadAheadWindow &win = windows[w];
+        if (p_block < win.first || p_block >= win.first + win.count)
+            continue;
+
+        if (filling_window == w)
+            _finish_readahead();
+        const int i = p_block - win.first;
+        if (win.sizes[i] < 0)
+            return false; // corrupt, let the caller report it
+        buffer.swap(win.data[i]);
+        win.sizes[i] = -1;
+        return true;
+    }
+    return false;
+}
+
+// Called after a sequential move to p_block: makes sure the blocks following the window being read are on their way.
+void FileAccessCompressed::_schedule_readahead(int p_block) const {
+
+    int current = -1;
+    int from = p_block + 1;
+    for (int w = 0; w < 2; w++) {
+        if (p_block >= windows[w].first && p_block < windows[w].first + windows[w].count) {
+            current = w;
+            from = windows[w].first + windows[w].count;
+        }
+    }
+    if (from >= read_block_count)
+        return;
+    for (int w = 0; w < 2; w++) {
+        if (windows[w].count && windows[w].first == from)
+            return; // already decompressed or on its way
+    }
+
+    _finish_readahead(); // the pool runs one batch at a time
+    {
+        MutexGuard guard(readahead_pool_mutex);
+        if (readahead_pool_owner)
+            return; // another file is reading ahead
+        if (!readahead_pool) {
+            readahead_pool = memnew(ThreadWorkPool);
+            readahead_pool->init(MIN(readahead_blocks, OS::get_singleton()->get_default_thread_pool_size()));
+        }
+        readahead_pool_owner = this;
+    }
+
+    ReadAheadWindow &win = windows[current == 0 ? 1 : 0];
+    win.first = from;
+    win.count = MIN(readahead_blocks, read_block_count - from);
+    win.data.resize(win.count);
+    win.comp.resize(win.count);
+    win.sizes.resize(win.count);
+
+    // the underlying file is only touched from the reading thread
+    f->seek(read_blocks[from].offset);
+    for (int i = 0; i < win.count; i++) {
+        win.comp[i].resize(read_blocks[from + i].csize);
+        f->get_buffer(win.comp[i].data(), win.comp[i].size());
+        win.data[i].resize(block_size);
+    }
+
+    readahead_job.file = this;
+    readahead_pool->begin_work(win.count, &readahead_job, &ReadAheadJob::process, &win);
+    filling_window = &win - windows;
+}
+
+bool FileAccessCompressed::_load_block(int p_block) const {
+
+    if (p_block == read_block)
+        return true;
+
+    const bool sequential = p_block == read_block + 1;
+
+    buffer.swap(prev_buffer);
+    if (p_block != prev_block && !_take_readahead_block(p_block)) {
+        const ReadBlock &rb = read_blocks[p_block];
+        buffer.resize(block_size);
+        f->seek(rb.offset);
+        f->get_buffer(comp_buffer.data(), rb.csize);
+        if (_decompress_block(buffer.data(), block_size, comp_buffer.data(), rb.csize) < 0) {
+            buffer.swap(prev_buffer);
+            prev_block = -1;
+            ERR_FAIL_V_MSG(false, "Compressed file is corrupt.");
+        }
+    }
+    prev_block = read_block;
+
+    read_block = p_block;
+    read_block_size = _get_block_size(p_block);
+    read_ptr = buffer.data();
+
+    if (sequential && readahead_blocks > 0 && read_block_count > 2)
+        _schedule_readahead(p_block);
+    return true;
+}
+
+// Moves to the start of the next block, or flags the end of the file after the last one.
+bool FileAccessCompressed::_next_block() const {
+
+    if (read_block + 1 < read_block_count) {
+        if (!_load_block(read_block + 1))
+            return false;
+        read_pos = 0;
+        return true;
+    }
+    at_end = true;
+    return false;
+}
+
 Error FileAccessCompressed::open_after_magic(FileAccess *p_base) {
 
     f = p_base;
-    cmode = (Compression::Mode)f->get_32();
+    const uint32_t mode = f->get_32();
+    cmode = (Compression::Mode)(mode & ~MODE_FLAG_DICTIONARY);
     block_size = f->get_32();
     if (block_size == 0) {
         f = nullptr; // Let the caller to handle the FileAccess object if failed to open as compressed file.
         ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't open compressed file '" + p_base->get_path() + "' with block size 0, it is corrupted.");
     }
     read_total = f->get_32();
+    if (mode & MODE_FLAG_DICTIONARY) {
+        dictionary_id = f->get_32();
+        const uint32_t dictionary_size = f->get_32();
+        const uint32_t crc = f->get_32();
+        if (!get_registered_dictionary(dictionary_id, dictionary)) {
+            f = nullptr;
+            ERR_FAIL_V_MSG(ERR_FILE_MISSING_DEPENDENCIES, "Can't open compressed file '" + p_base->get_path() + "', its compression dictionary was not registered.");
+        }
+        if (dictionary.size() != dictionary_size || dictionary_crc(dictionary) != crc) {
+            f = nullptr;
+            dictionary_id = 0;
+            dictionary.clear();
+            ERR_FAIL_V_MSG(ERR_FILE_CORRUPT, "Can't open compressed file '" + p_base->get_path() + "', the dictionary registered under its id is not the one it was compressed with.");
+        }
+    } else {
+        dictionary_id = 0;
+        dictionary.clear();
+    }
     int bc = (read_total / block_size) + 1;
-    int acc_ofs = f->get_position() + bc * 4;
+    uint64_t acc_ofs = f->get_position() + bc * 4;
     int max_bs = 0;
     for (int i = 0; i < bc; i++) {
 
@@ -84,18 +380,14 @@ Error FileAccessCompressed::open_after_magic(FileAccess *p_base) {
 
     comp_buffer.resize(max_bs);
     buffer.resize(block_size);
-    read_ptr = buffer.data();
-    f->get_buffer(comp_buffer.data(), read_blocks[0].csize);
     at_end = false;
     read_eof = false;
     read_block_count = bc;
-    read_block_size = read_blocks.size() == 1 ? read_total : block_size;
-
-    int ret = Compression::decompress(buffer.data(), read_block_size, comp_buffer.data(), read_blocks[0].csize, cmode);
-    read_block = 0;
+    read_block = -1;
+    prev_block = -1;
     read_pos = 0;
 
-    return ret == -1 ? ERR_FILE_CORRUPT : OK;
+    return _load_block(0) ? OK : ERR_FILE_CORRUPT;
 }
 
 Error FileAccessCompressed::_open(StringView p_path, int p_mode_flags) {
@@ -149,9 +441,15 @@ void FileAccessCompressed::close() {
         //save block table and all compressed blocks
 
         f->store_buffer((const uint8_t *)magic.data(), magic.length()); //write header 4
-        f->store_32(cmode); //write compression mode 4
+        f->store_32(dictionary_id ? (cmode | MODE_FLAG_DICTIONARY) : cmode); //write compression mode 4
         f->store_32(block_size); //write block size 4
         f->store_32(write_max); //max amount of data written 4
+        if (dictionary_id) {
+            f->store_32(dictionary_id); //dictionary used by all blocks 4
+            f->store_32(dictionary.size()); //so a different dictionary under the same id is caught 4
+            f->store_32(dictionary_crc(dictionary)); // 4
+        }
+        const uint64_t table_ofs = f->get_position();
         int bc = (write_max / block_size) + 1;
 
         for (int i = 0; i < bc; i++) {
@@ -159,20 +457,24 @@ void FileAccessCompressed::close() {
         }
 
         Vector<int> block_sizes;
+        Vector<uint8_t> cblock;
         for (int i = 0; i < bc; i++) {
 
             int bl = i == (bc - 1) ? write_max % block_size : block_size;
             uint8_t *bp = &write_ptr[i * block_size];
 
-            Vector<uint8_t> cblock;
             cblock.resize(Compression::get_max_compressed_buffer_size(bl, cmode));
-            int s = Compression::compress(cblock.data(), bp, bl, cmode);
+            int s;
+            if (dictionary_id)
+                s = Compression::compress_zstd_dict(cblock.data(), bp, bl, dictionary_id, dictionary.data(), dictionary.size());
+            else
+                s = Compression::compress(cblock.data(), bp, bl, cmode);
 
             f->store_buffer(cblock.data(), s);
             block_sizes.push_back(s);
         }
 
-        f->seek(16); //ok write block sizes
+        f->seek(table_ofs); //ok write block sizes
         for (int i = 0; i < bc; i++)
             f->store_32(block_sizes[i]);
         f->seek_end();
@@ -182,8 +484,14 @@ void FileAccessCompressed::close() {
 
     } else {
 
+        _finish_readahead();
+        for (ReadAheadWindow &win : windows) {
+            win = ReadAheadWindow();
+        }
+
         comp_buffer.clear();
         buffer.clear();
+        prev_buffer.clear();
         read_blocks.clear();
     }
 
@@ -215,16 +523,7 @@ void FileAccessCompressed::seek(size_t p_position) {
 
     at_end = false;
     read_eof = false;
-    int block_idx = p_position / block_size;
-    if (block_idx != read_block) {
-
-        read_block = block_idx;
-        f->seek(read_blocks[read_block].offset);
-        f->get_buffer(comp_buffer.data(), read_blocks[read_block].csize);
-        int res = Compression::decompress(buffer.data(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.data(), read_blocks[read_block].csize, cmode);
-        ERR_FAIL_COND_MSG(res == -1, "Compressed file is corrupt.");
-        read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-    }
+    ERR_FAIL_COND(!_load_block(p_position / block_size));
 
     read_pos = p_position % block_size;
 }
@@ -286,20 +585,7 @@ uint8_t FileAccessCompressed::get_8() const {
 
     read_pos++;
     if (read_pos >= read_block_size) {
-        read_block++;
-
-        if (read_block < read_block_count) {
-            //read another block of compressed data
-            f->get_buffer(comp_buffer.data(), read_blocks[read_block].csize);
-            int res = Compression::decompress(buffer.data(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.data(), read_blocks[read_block].csize, cmode);
-            ERR_FAIL_COND_V_MSG(res == -1, 0, "Compressed file is corrupt.");
-            read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-            read_pos = 0;
-
-        } else {
-            read_block--;
-            at_end = true;
-        }
+        _next_block();
     }
 
     return ret;
@@ -314,29 +600,20 @@ uint64_t FileAccessCompressed::get_buffer(uint8_t *p_dst, uint64_t p_length) con
         return 0;
     }
 
-    for (uint64_t i = 0; i < p_length; i++) {
-
-        p_dst[i] = read_ptr[read_pos];
-        read_pos++;
-        if (read_pos >= read_block_size) {
-            read_block++;
-
-            if (read_block < read_block_count) {
-                //read another block of compressed data
-                f->get_buffer(comp_buffer.data(), read_blocks[read_block].csize);
-                int res = Compression::decompress(buffer.data(), read_blocks.size() == 1 ? read_total : block_size, comp_buffer.data(), read_blocks[read_block].csize, cmode);
-                ERR_FAIL_COND_V_MSG(res == -1, -1, "Compressed file is corrupt.");
-                read_block_size = read_block == read_block_count - 1 ? read_total % block_size : block_size;
-                read_pos = 0;
-
-            } else {
-                read_block--;
-                at_end = true;
-                if (i + 1 < p_length) {
-                    read_eof = true;
-                }
-                return i+1;
+    uint64_t done = 0;
+    while (done < p_length) {
+        const uint64_t n = MIN(p_length - done, uint64_t(read_block_size - read_pos));
+        memcpy(p_dst + done, read_ptr + read_pos, n);
+        read_pos += n;
+        done += n;
+
+        if (read_pos >= read_block_size && !_next_block()) {
+            if (!at_end)
+                return -1; // corrupt block, already reported
+            if (done < p_length) {
+                read_eof = true;
             }
+            return done;
         }
     }
 
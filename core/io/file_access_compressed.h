@@ -35,7 +35,24 @@
 #include "core/string.h"
 #include "core/vector.h"
 
+class StringName;
+
 class FileAccessCompressed : public FileAccess {
+public:
+    // Block size used when configure() is not given one, compression/formats/compressed_file/block_size.
+    static uint32_t default_block_size;
+    // Blocks decompressed ahead of sequential reads on worker threads, 0 disables read-ahead.
+    // compression/formats/compressed_file/readahead_blocks.
+    static int readahead_blocks;
+    // Directory registered dictionaries are saved to and looked up in when a file needs one that was not
+    // registered in this session, compression/formats/compressed_file/dictionary_path. Empty keeps them in memory.
+    static String dictionary_path;
+
+private:
+    enum {
+        // Stored along the compression mode, the file header then has the dictionary id, size and crc32 after the total size.
+        MODE_FLAG_DICTIONARY = 1u << 31,
+    };
 
     Compression::Mode cmode=Compression::MODE_ZSTD;
     bool writing=false;
@@ -52,8 +69,22 @@ class FileAccessCompressed : public FileAccess {
         uint64_t offset;
     };
 
+    // Two windows of readahead_blocks blocks: the reader consumes one while the other is being filled.
+    struct ReadAheadWindow {
+        int first = 0;
+        int count = 0;
+        Vector<Vector<uint8_t> > data;
+        Vector<Vector<uint8_t> > comp;
+        Vector<int> sizes; // decompressed size, -1 once consumed or when corrupt
+    };
+
+    struct ReadAheadJob {
+        const FileAccessCompressed *file;
+        void process(uint32_t p_index, ReadAheadWindow *p_window);
+    };
+
     mutable Vector<uint8_t> comp_buffer;
-    uint8_t *read_ptr=nullptr;
+    mutable uint8_t *read_ptr=nullptr;
     mutable int read_block=0;
     int read_block_count=0;
     mutable uint32_t read_block_size=0;
@@ -61,12 +92,44 @@ class FileAccessCompressed : public FileAccess {
     Vector<ReadBlock> read_blocks;
     uint32_t read_total=0;
 
+    // Last block before the current one, so seeks going back and forth between two blocks don't decompress again.
+    mutable Vector<uint8_t> prev_buffer;
+    mutable int prev_block = -1;
+
+    mutable ReadAheadWindow windows[2];
+    mutable int filling_window = -1;
+    mutable ReadAheadJob readahead_job;
+
+    uint32_t dictionary_id = 0;
+    Vector<uint8_t> dictionary;
+
     String magic;
     mutable Vector<uint8_t> buffer;
     FileAccess *f = nullptr;
 
+    uint32_t _get_block_size(int p_block) const { return p_block == read_block_count - 1 ? read_total % block_size : block_size; }
+    int _decompress_block(uint8_t *p_dst, uint32_t p_size, const uint8_t *p_src, uint32_t p_csize) const;
+    bool _load_block(int p_block) const;
+    bool _take_readahead_block(int p_block) const;
+    void _schedule_readahead(int p_block) const;
+    void _finish_readahead() const;
+    bool _next_block() const;
+
 public:
-    void configure(StringView p_magic, Compression::Mode p_mode = Compression::MODE_ZSTD, uint32_t p_block_size = 4096);
+    void configure(StringView p_magic, Compression::Mode p_mode = Compression::MODE_ZSTD, uint32_t p_block_size = 0);
+    // Compress with a dictionary previously registered with register_dictionary(), MODE_ZSTD only. 0 disables it.
+    void set_dictionary_id(uint32_t p_id);
+    uint32_t get_dictionary_id() const { return dictionary_id; }
+
+    // Dictionaries are found by id when reading, either registered in this session or saved in dictionary_path.
+    // A dictionary whose id is taken by different contents gets the next free one.
+    static uint32_t register_dictionary(const Vector<uint8_t> &p_dictionary);
+    static bool get_registered_dictionary(uint32_t p_id, Vector<uint8_t> &r_dictionary);
+    // Dictionary used when saving compressed resources of the given type, see Compression::build_zstd_dictionary.
+    static void set_type_dictionary(const StringName &p_type, const Vector<uint8_t> &p_dictionary);
+    static uint32_t get_type_dictionary(const StringName &p_type);
+    // Stops the read-ahead threads shared by all compressed files.
+    static void finish_readahead_pool();
 
     Error open_after_magic(FileAccess *p_base);
 
@@ -47,7 +47,7 @@ Error PackedData::add_pack(StringView p_path, bool p_replace_files, StringView p
     return ERR_FILE_UNRECOGNIZED;
 }
 
-void PackedData::add_path(StringView pkg_path, StringView path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSourceInterface *p_src, bool p_replace_files) {
+void PackedData::add_path(StringView pkg_path, StringView path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSourceInterface *p_src, bool p_replace_files, uint32_t p_flags) {
 
     PathMD5 pmd5(StringUtils::md5_buffer(path));
     //printf("adding path %ls, %lli, %lli\n", path.c_str(), pmd5.a, pmd5.b);
@@ -60,6 +60,7 @@ void PackedData::add_path(StringView pkg_path, StringView path, uint64_t ofs, ui
     pf.size = size;
     for (int i = 0; i < 16; i++)
         pf.md5[i] = p_md5[i];
+    pf.flags = p_flags;
     pf.src = p_src;
 
     if (!exists || p_replace_files)
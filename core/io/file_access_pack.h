@@ -46,7 +46,19 @@
 // Godot's packed file magic header ("GDPC" in ASCII).
 #define PACK_HEADER_MAGIC 0x43504447
 // The current packed file format version number.
-#define PACK_FORMAT_VERSION 1
+#define PACK_FORMAT_VERSION 2
+// Oldest format version that can still be read, its file entries have no flags field.
+#define PACK_FORMAT_VERSION_MIN 1
+
+// Per file flags, stored after the md5 of each file entry since format version 2.
+enum PackFileFlags : uint32_t {
+    // Contents are split in PACK_COMPRESSED_BLOCK_SIZE blocks, each compressed on its own with
+    // Compression::MODE_ZSTD. The payload starts with the block size, the block count and the
+    // compressed size of every block (all 32 bits), followed by the blocks.
+    // The entry size and md5 are those of the uncompressed contents.
+    PACK_FILE_COMPRESSED = 1 << 0,
+};
+#define PACK_COMPRESSED_BLOCK_SIZE (64 * 1024)
 
 class PackSourceInterface;
 
@@ -56,6 +68,7 @@ struct PackedDataFile {
     uint64_t offset; //if offset is ZERO, the file was ERASED
     uint64_t size;
     uint8_t md5[16];
+    uint32_t flags = 0; // PackFileFlags
     PackSourceInterface *src;
 };
 
@@ -115,7 +128,7 @@ private:
 public:
     void add_pack_source(PackSourceInterface *p_source);
     void remove_pack_source(PackSourceInterface *p_source);
-    void add_path(StringView pkg_path, StringView path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSourceInterface *p_src, bool p_replace_files); // for PackSource
+    void add_path(StringView pkg_path, StringView path, uint64_t ofs, uint64_t size, const uint8_t *p_md5, PackSourceInterface *p_src, bool p_replace_files, uint32_t p_flags = 0); // for PackSource
 
     void set_disabled(bool p_disabled) { disabled = p_disabled; }
     _FORCE_INLINE_ bool is_disabled() const { return disabled; }
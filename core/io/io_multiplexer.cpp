@@ -0,0 +1,132 @@
+/*************************************************************************/
+/*  io_multiplexer.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "io_multiplexer.h"
+
+#include "core/os/memory.h"
+#include "core/os/os.h"
+
+IOMultiplexer *(*IOMultiplexer::_create)() = nullptr;
+
+namespace {
+
+// Used where the platform has no readiness API wired up: one NetSocket::poll() per registered socket.
+class IOMultiplexerGeneric : public IOMultiplexer {
+
+    struct Entry {
+        Ref<NetSocket> sock;
+        uint32_t events;
+        void *userdata;
+    };
+
+    Vector<Entry> entries;
+
+    int _find(const Ref<NetSocket> &p_sock) const {
+        for (int i = 0; i < entries.size(); i++) {
+            if (entries[i].sock == p_sock) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+public:
+    Error add(const Ref<NetSocket> &p_sock, uint32_t p_events, void *p_userdata) override {
+        ERR_FAIL_COND_V(!p_sock || !p_sock->is_open(), ERR_INVALID_PARAMETER);
+        ERR_FAIL_COND_V(_find(p_sock) != -1, ERR_ALREADY_EXISTS);
+        entries.push_back({ p_sock, p_events, p_userdata });
+        return OK;
+    }
+
+    Error modify(const Ref<NetSocket> &p_sock, uint32_t p_events, void *p_userdata) override {
+        int idx = _find(p_sock);
+        ERR_FAIL_COND_V(idx == -1, ERR_DOES_NOT_EXIST);
+        entries[idx].events = p_events;
+        entries[idx].userdata = p_userdata;
+        return OK;
+    }
+
+    void remove(const Ref<NetSocket> &p_sock) override {
+        int idx = _find(p_sock);
+        if (idx != -1) {
+            entries.erase_unsorted(entries.begin() + idx);
+        }
+    }
+
+    int get_socket_count() const override {
+        return entries.size();
+    }
+
+    Error wait(Vector<Ready> &r_ready, int p_timeout) override {
+        const uint64_t start = OS::get_singleton()->get_ticks_msec();
+        while (true) {
+            _poll_all(r_ready);
+            if (!r_ready.empty() || entries.empty()) {
+                break;
+            }
+            if (p_timeout >= 0 && OS::get_singleton()->get_ticks_msec() - start >= uint64_t(p_timeout)) {
+                break;
+            }
+            OS::get_singleton()->delay_usec(1000);
+        }
+        return r_ready.empty() ? ERR_BUSY : OK;
+    }
+
+    void _poll_all(Vector<Ready> &r_ready) const {
+        r_ready.clear();
+        for (const Entry &E : entries) {
+            if (!E.sock->is_open()) {
+                r_ready.push_back({ E.userdata, EVENT_ERROR });
+                continue;
+            }
+            uint32_t events = 0;
+            if ((E.events & EVENT_IN) && E.sock->poll(NetSocket::POLL_TYPE_IN, 0) == OK) {
+                events |= EVENT_IN;
+            }
+            if ((E.events & EVENT_OUT) && E.sock->poll(NetSocket::POLL_TYPE_OUT, 0) == OK) {
+                events |= EVENT_OUT;
+            }
+            if (events) {
+                r_ready.push_back({ E.userdata, events });
+            }
+        }
+    }
+};
+
+} // namespace
+
+IOMultiplexer *IOMultiplexer::create() {
+
+    if (_create) {
+        return _create();
+    }
+
+    return memnew(IOMultiplexerGeneric);
+}
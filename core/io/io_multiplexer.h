@@ -0,0 +1,67 @@
+/*************************************************************************/
+/*  io_multiplexer.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#pragma once
+
+#include "core/io/net_socket.h"
+#include "core/vector.h"
+
+// Readiness notification for many sockets at once. Sockets are registered with the events they are interested in
+// and an opaque userdata, then wait() returns only the ones that are ready, in a single call, instead of polling
+// every socket on its own.
+class GODOT_EXPORT IOMultiplexer : public RefCounted {
+
+protected:
+    static IOMultiplexer *(*_create)();
+
+public:
+    // Returns the platform implementation, or a portable one that polls each registered socket in turn.
+    static IOMultiplexer *create();
+
+    enum Event {
+        EVENT_IN = 1,
+        EVENT_OUT = 2,
+        EVENT_ERROR = 4, // error or hang up, always reported
+    };
+
+    struct Ready {
+        void *userdata;
+        uint32_t events;
+    };
+
+    virtual Error add(const Ref<NetSocket> &p_sock, uint32_t p_events, void *p_userdata) = 0;
+    virtual Error modify(const Ref<NetSocket> &p_sock, uint32_t p_events, void *p_userdata) = 0;
+    virtual void remove(const Ref<NetSocket> &p_sock) = 0;
+    virtual int get_socket_count() const = 0;
+
+    // Fills r_ready with the sockets that have pending events. p_timeout is in milliseconds, -1 waits indefinitely.
+    // Returns ERR_BUSY if nothing became ready in time.
+    virtual Error wait(Vector<Ready> &r_ready, int p_timeout) = 0;
+};
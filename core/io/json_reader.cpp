@@ -0,0 +1,450 @@
+/*************************************************************************/
+/*  json_reader.cpp                                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "json_reader.h"
+
+#include "core/fixed_string.h"
+#include "core/string_utils.inl"
+
+#include <cstdlib>
+
+const char *JSONReader::tk_name[TK_MAX] = {
+    "'{'",
+    "'}'",
+    "'['",
+    "']'",
+    "identifier",
+    "string",
+    "number",
+    "':'",
+    "','",
+    "EOF",
+};
+
+namespace {
+
+int hex_digit_value(char c) {
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+void append_utf8(String &r_dst, uint32_t p_code) {
+    if (p_code < 0x80) {
+        r_dst.push_back(char(p_code));
+    } else if (p_code < 0x800) {
+        r_dst.push_back(char(0xC0 | (p_code >> 6)));
+        r_dst.push_back(char(0x80 | (p_code & 0x3F)));
+    } else if (p_code < 0x10000) {
+        r_dst.push_back(char(0xE0 | (p_code >> 12)));
+        r_dst.push_back(char(0x80 | ((p_code >> 6) & 0x3F)));
+        r_dst.push_back(char(0x80 | (p_code & 0x3F)));
+    } else {
+        r_dst.push_back(char(0xF0 | (p_code >> 18)));
+        r_dst.push_back(char(0x80 | ((p_code >> 12) & 0x3F)));
+        r_dst.push_back(char(0x80 | ((p_code >> 6) & 0x3F)));
+        r_dst.push_back(char(0x80 | (p_code & 0x3F)));
+    }
+}
+
+bool is_number_char(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+} // end of anonymous namespace
+
+JSONReader::JSONReader(StringView p_source) :
+        src(p_source.data()),
+        src_end(p_source.data() + p_source.size()),
+        pos(p_source.data()) {
+}
+
+Error JSONReader::_error(StringView p_message) {
+    error_str = p_message;
+    expect = EXPECT_NOTHING;
+    return ERR_PARSE_ERROR;
+}
+
+JSONReader::TokenType JSONReader::_read_string() {
+
+    // Fast path: a string without escape sequences is returned as a view into the source.
+    const char *start = pos;
+    const char *c = pos;
+    while (c < src_end && *c != '"' && *c != '\\' && *c != 0) {
+        if (*c == '\n')
+            line++;
+        c++;
+    }
+    if (c < src_end && *c == '"') {
+        text = StringView(start, c - start);
+        pos = c + 1;
+        return TK_STRING;
+    }
+
+    scratch.assign(start, c - start);
+    while (true) {
+        if (c >= src_end || *c == 0) {
+            _error("Unterminated String");
+            return TK_MAX;
+        }
+        const char ch = *c++;
+        if (ch == '"') {
+            break;
+        }
+        if (ch != '\\') {
+            if (ch == '\n')
+                line++;
+            scratch.push_back(ch);
+            continue;
+        }
+        //escaped characters...
+        if (c >= src_end || *c == 0) {
+            _error("Unterminated String");
+            return TK_MAX;
+        }
+        const char next = *c++;
+        switch (next) {
+            case 'b': scratch.push_back(8); break;
+            case 't': scratch.push_back(9); break;
+            case 'n': scratch.push_back(10); break;
+            case 'f': scratch.push_back(12); break;
+            case 'r': scratch.push_back(13); break;
+            case 'u': {
+                //hexnumbarh - oct is deprecated
+                uint32_t code = 0;
+                for (int j = 0; j < 4; j++) {
+                    if (c >= src_end || *c == 0) {
+                        _error("Unterminated String");
+                        return TK_MAX;
+                    }
+                    const int v = hex_digit_value(*c++);
+                    if (v < 0) {
+                        _error("Malformed hex constant in string");
+                        return TK_MAX;
+                    }
+                    code = (code << 4) | uint32_t(v);
+                }
+                // Combine UTF-16 surrogate pairs into a single code point.
+                if (code >= 0xD800 && code <= 0xDBFF && src_end - c >= 6 && c[0] == '\\' && c[1] == 'u') {
+                    uint32_t low = 0;
+                    bool valid = true;
+                    for (int j = 2; j < 6 && valid; j++) {
+                        const int v = hex_digit_value(c[j]);
+                        valid = v >= 0;
+                        low = (low << 4) | uint32_t(v);
+                    }
+                    if (valid && low >= 0xDC00 && low <= 0xDFFF) {
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                        c += 6;
+                    }
+                }
+                append_utf8(scratch, code);
+            } break;
+            default: {
+                scratch.push_back(next);
+            } break;
+        }
+    }
+    pos = c;
+    text = scratch;
+    return TK_STRING;
+}
+
+JSONReader::TokenType JSONReader::_read_number() {
+
+    // strtod needs a terminated buffer, and the source span is not guaranteed to be one.
+    const char *end = pos;
+    while (end < src_end && is_number_char(*end)) {
+        end++;
+    }
+    TmpString<64> lexeme(pos, end - pos);
+    char *parsed_end = nullptr;
+    number = StringUtils::to_double(lexeme.c_str(), &parsed_end);
+    if (parsed_end == lexeme.c_str()) {
+        _error("Malformed number");
+        return TK_MAX;
+    }
+    pos += parsed_end - lexeme.c_str();
+    return TK_NUMBER;
+}
+
+JSONReader::TokenType JSONReader::_next_token() {
+
+    while (pos < src_end) {
+        switch (*pos) {
+
+            case '\n': {
+                line++;
+                pos++;
+                break;
+            }
+            case 0: {
+                return TK_EOF;
+            }
+            case '{': {
+                pos++;
+                return TK_CURLY_BRACKET_OPEN;
+            }
+            case '}': {
+                pos++;
+                return TK_CURLY_BRACKET_CLOSE;
+            }
+            case '[': {
+                pos++;
+                return TK_BRACKET_OPEN;
+            }
+            case ']': {
+                pos++;
+                return TK_BRACKET_CLOSE;
+            }
+            case ':': {
+                pos++;
+                return TK_COLON;
+            }
+            case ',': {
+                pos++;
+                return TK_COMMA;
+            }
+            case '"': {
+                pos++;
+                return _read_string();
+            }
+            default: {
+                const char c = *pos;
+                if (uint8_t(c) <= 32) {
+                    pos++;
+                    break;
+                }
+                if (c == '-' || (c >= '0' && c <= '9')) {
+                    return _read_number();
+                }
+                if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) {
+                    const char *start = pos;
+                    while (pos < src_end && ((*pos >= 'A' && *pos <= 'Z') || (*pos >= 'a' && *pos <= 'z'))) {
+                        pos++;
+                    }
+                    text = StringView(start, pos - start);
+                    return TK_IDENTIFIER;
+                }
+                _error("Unexpected character.");
+                return TK_MAX;
+            }
+        }
+    }
+    return TK_EOF;
+}
+
+Error JSONReader::_value_event(TokenType p_token, Expecting p_after, Event &r_event) {
+
+    switch (p_token) {
+        case TK_CURLY_BRACKET_OPEN:
+            stack.push_back(p_after);
+            expect = EXPECT_OBJECT_FIRST;
+            r_event = EVENT_OBJECT_BEGIN;
+            return OK;
+        case TK_BRACKET_OPEN:
+            stack.push_back(p_after);
+            expect = EXPECT_ARRAY_FIRST;
+            r_event = EVENT_ARRAY_BEGIN;
+            return OK;
+        case TK_STRING:
+            r_event = EVENT_STRING;
+            break;
+        case TK_NUMBER:
+            r_event = EVENT_NUMBER;
+            break;
+        case TK_IDENTIFIER:
+            if (text == "true" || text == "false") {
+                boolean = text[0] == 't';
+                r_event = EVENT_BOOL;
+            } else if (text == "null") {
+                r_event = EVENT_NULL;
+            } else {
+                return _error("Expected 'true','false' or 'null', got '" + String(text) + "'.");
+            }
+            break;
+        default:
+            return _error("Expected value, got " + String(tk_name[p_token]) + ".");
+    }
+    expect = p_after;
+    return OK;
+}
+
+Error JSONReader::_close(Event p_event, Event &r_event) {
+    expect = stack.back();
+    stack.pop_back();
+    r_event = p_event;
+    return OK;
+}
+
+Error JSONReader::read(Event &r_event) {
+
+    if (expect == EXPECT_NOTHING) {
+        if (!error_str.empty()) {
+            return ERR_PARSE_ERROR;
+        }
+        r_event = EVENT_EOF;
+        return OK;
+    }
+
+    TokenType token = _next_token();
+    if (token == TK_MAX) {
+        return ERR_PARSE_ERROR;
+    }
+
+    switch (expect) {
+        case EXPECT_ROOT_VALUE: {
+            return _value_event(token, EXPECT_EOF, r_event);
+        }
+        case EXPECT_EOF: {
+            if (token != TK_EOF) {
+                return _error("Expected 'EOF'");
+            }
+            expect = EXPECT_NOTHING;
+            r_event = EVENT_EOF;
+            return OK;
+        }
+        case EXPECT_ARRAY_NEXT: {
+            if (token == TK_BRACKET_CLOSE) {
+                return _close(EVENT_ARRAY_END, r_event);
+            }
+            if (token == TK_EOF) {
+                return _error("Expected ']'");
+            }
+            if (token != TK_COMMA) {
+                return _error("Expected ','");
+            }
+            token = _next_token();
+            if (token == TK_MAX) {
+                return ERR_PARSE_ERROR;
+            }
+            [[fallthrough]];
+        }
+        case EXPECT_ARRAY_FIRST: {
+            if (token == TK_BRACKET_CLOSE) {
+                return _close(EVENT_ARRAY_END, r_event);
+            }
+            if (token == TK_EOF) {
+                return _error("Expected ']'");
+            }
+            return _value_event(token, EXPECT_ARRAY_NEXT, r_event);
+        }
+        case EXPECT_OBJECT_NEXT: {
+            if (token == TK_CURLY_BRACKET_CLOSE) {
+                return _close(EVENT_OBJECT_END, r_event);
+            }
+            if (token == TK_EOF) {
+                return _error("Expected '}'");
+            }
+            if (token != TK_COMMA) {
+                return _error("Expected '}' or ','");
+            }
+            token = _next_token();
+            if (token == TK_MAX) {
+                return ERR_PARSE_ERROR;
+            }
+            [[fallthrough]];
+        }
+        case EXPECT_OBJECT_FIRST: {
+            if (token == TK_CURLY_BRACKET_CLOSE) {
+                return _close(EVENT_OBJECT_END, r_event);
+            }
+            if (token == TK_EOF) {
+                return _error("Expected '}'");
+            }
+            if (token != TK_STRING) {
+                return _error("Expected key");
+            }
+            // The key view has to survive the colon lookup, which never touches the scratch buffer.
+            const StringView key = text;
+            token = _next_token();
+            if (token == TK_MAX) {
+                return ERR_PARSE_ERROR;
+            }
+            if (token != TK_COLON) {
+                return _error("Expected ':'");
+            }
+            text = key;
+            expect = EXPECT_OBJECT_VALUE;
+            r_event = EVENT_KEY;
+            return OK;
+        }
+        case EXPECT_OBJECT_VALUE: {
+            return _value_event(token, EXPECT_OBJECT_NEXT, r_event);
+        }
+        case EXPECT_NOTHING:
+            break;
+    }
+    return ERR_BUG;
+}
+
+Error JSONReader::skip_value() {
+
+    ERR_FAIL_COND_V(expect != EXPECT_OBJECT_VALUE, ERR_INVALID_PARAMETER);
+    const int depth = stack.size();
+    Event event;
+    do {
+        Error err = read(event);
+        if (err != OK) {
+            return err;
+        }
+    } while (stack.size() > depth);
+    return OK;
+}
+
+Error JSONReader::parse(Handler &p_handler) {
+
+    while (true) {
+        Event event;
+        Error err = read(event);
+        if (err != OK) {
+            return err;
+        }
+        switch (event) {
+            case EVENT_OBJECT_BEGIN: err = p_handler.on_object_begin(); break;
+            case EVENT_OBJECT_END: err = p_handler.on_object_end(); break;
+            case EVENT_ARRAY_BEGIN: err = p_handler.on_array_begin(); break;
+            case EVENT_ARRAY_END: err = p_handler.on_array_end(); break;
+            case EVENT_KEY: err = p_handler.on_key(text); break;
+            case EVENT_STRING: err = p_handler.on_string(text); break;
+            case EVENT_NUMBER: err = p_handler.on_number(number); break;
+            case EVENT_BOOL: err = p_handler.on_bool(boolean); break;
+            case EVENT_NULL: err = p_handler.on_null(); break;
+            case EVENT_EOF: return OK;
+        }
+        if (err != OK) {
+            return err;
+        }
+    }
+}
@@ -0,0 +1,142 @@
+/*************************************************************************/
+/*  json_reader.h                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#pragma once
+
+#include "core/error_list.h"
+#include "core/forward_decls.h"
+#include "core/string.h"
+#include "core/vector.h"
+
+/**
+ * Pull-style (SAX) reader over an UTF-8 JSON document held in memory.
+ *
+ * Each call to read() returns the next structural event. Keys and string values are exposed as views: into the
+ * source buffer when the string contains no escape sequences, otherwise into an internal scratch buffer. Either way
+ * they stay valid only until the next call to read(). No Variant tree is built, callers that only need a few values
+ * can skip everything else without allocating.
+ *
+ * The accepted grammar matches JSON::parse, including tolerated trailing commas in arrays and objects.
+ */
+class GODOT_EXPORT JSONReader {
+public:
+    enum Event {
+        EVENT_OBJECT_BEGIN,
+        EVENT_OBJECT_END,
+        EVENT_ARRAY_BEGIN,
+        EVENT_ARRAY_END,
+        EVENT_KEY,
+        EVENT_STRING,
+        EVENT_NUMBER,
+        EVENT_BOOL,
+        EVENT_NULL,
+        EVENT_EOF,
+    };
+
+    /// Callback interface for push-style consumers, see parse().
+    struct Handler {
+        virtual Error on_object_begin() { return OK; }
+        virtual Error on_object_end() { return OK; }
+        virtual Error on_array_begin() { return OK; }
+        virtual Error on_array_end() { return OK; }
+        virtual Error on_key(StringView /*p_key*/) { return OK; }
+        virtual Error on_string(StringView /*p_value*/) { return OK; }
+        virtual Error on_number(double /*p_value*/) { return OK; }
+        virtual Error on_bool(bool /*p_value*/) { return OK; }
+        virtual Error on_null() { return OK; }
+        virtual ~Handler() = default;
+    };
+
+private:
+    enum TokenType {
+        TK_CURLY_BRACKET_OPEN,
+        TK_CURLY_BRACKET_CLOSE,
+        TK_BRACKET_OPEN,
+        TK_BRACKET_CLOSE,
+        TK_IDENTIFIER,
+        TK_STRING,
+        TK_NUMBER,
+        TK_COLON,
+        TK_COMMA,
+        TK_EOF,
+        TK_MAX
+    };
+
+    enum Expecting : uint8_t {
+        EXPECT_ROOT_VALUE,
+        EXPECT_ARRAY_FIRST,
+        EXPECT_ARRAY_NEXT,
+        EXPECT_OBJECT_FIRST,
+        EXPECT_OBJECT_NEXT,
+        EXPECT_OBJECT_VALUE,
+        EXPECT_EOF,
+        EXPECT_NOTHING, // EOF was reached or an error was reported.
+    };
+
+    static const char *tk_name[TK_MAX];
+
+    const char *src;
+    const char *src_end;
+    const char *pos;
+    //! Holds strings that needed unescaping.
+    String scratch;
+    //! Expectation to restore in the parent container once the current one is closed.
+    Vector<Expecting> stack;
+    String error_str;
+    StringView text;
+    double number = 0;
+    int line = 0;
+    Expecting expect = EXPECT_ROOT_VALUE;
+    bool boolean = false;
+
+    TokenType _next_token();
+    TokenType _read_string();
+    TokenType _read_number();
+    Error _error(StringView p_message);
+    Error _value_event(TokenType p_token, Expecting p_after, Event &r_event);
+    Error _close(Event p_event, Event &r_event);
+
+public:
+    Error read(Event &r_event);
+    /// Consumes the value introduced by the last EVENT_KEY, including all of its children.
+    Error skip_value();
+    /// Reads the whole document, forwarding every event to p_handler. Stops at the first error it or the handler reports.
+    Error parse(Handler &p_handler);
+
+    /// Key or string value of the last event.
+    StringView get_string() const { return text; }
+    double get_number() const { return number; }
+    bool get_bool() const { return boolean; }
+    int get_depth() const { return stack.size(); }
+    int get_line() const { return line; }
+    const String &get_error_text() const { return error_str; }
+
+    explicit JSONReader(StringView p_source);
+};
@@ -76,7 +76,7 @@ GameEntity EncodedObjectAsID::get_object_id() const {
 #define ENCODE_FLAG_64 1 << 16
 #define ENCODE_FLAG_OBJECT_AS_ID 1 << 16
 
-static Error _decode_string(const uint8_t *&buf, int &len, int *r_len, String &r_string) {
+static Error _decode_string_view(const uint8_t *&buf, int &len, int *r_len, StringView &r_string) {
     ERR_FAIL_COND_V(len < 4, ERR_INVALID_DATA);
 
     uint32_t strlen = decode_uint32(buf);
@@ -95,9 +95,7 @@ static Error _decode_string(const uint8_t *&buf, int &len, int *r_len, String &r
     ERR_FAIL_COND_V(strlen > (1<<24), ERR_INVALID_DATA);
     ERR_FAIL_COND_V(strlen + pad > uint32_t(len), ERR_FILE_EOF);
 
-    String str((const char *)buf, strlen);
-
-    r_string = str;
+    r_string = StringView((const char *)buf, strlen);
 
     // Add padding
     strlen += pad;
@@ -112,6 +110,15 @@ static Error _decode_string(const uint8_t *&buf, int &len, int *r_len, String &r
     return OK;
 }
 
+static Error _decode_string(const uint8_t *&buf, int &len, int *r_len, String &r_string) {
+    StringView view;
+    Error err = _decode_string_view(buf, len, r_len, view);
+    if (err)
+        return err;
+    r_string.assign(view.data(), view.size());
+    return OK;
+}
+
 Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len, bool p_allow_objects) {
 
     const uint8_t *buf = p_buffer;
@@ -342,8 +349,8 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 
         } break;
         case VariantType::STRING_NAME: {
-            String str;
-            Error err = _decode_string(buf, len, r_len, str);
+            StringView str;
+            Error err = _decode_string_view(buf, len, r_len, str);
             if (err) {
                 return err;
             }
@@ -376,10 +383,13 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
                 if (r_len)
                     (*r_len) += 12;
 
+                names.reserve(namecount);
+                subnames.reserve(subnamecount);
+
                 for (uint32_t i = 0; i < total; i++) {
 
-                    String str;
-                    Error err = _decode_string(buf, len, r_len, str);
+                    StringView str;
+                    Error err = _decode_string_view(buf, len, r_len, str);
                     if (err)
                         return err;
                     StringName sname(str);
@@ -423,8 +433,8 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
             } else {
                 ERR_FAIL_COND_V(!p_allow_objects, ERR_UNAUTHORIZED);
 
-                String str;
-                Error err = _decode_string(buf, len, r_len, str);
+                StringView str;
+                Error err = _decode_string_view(buf, len, r_len, str);
                 if (err)
                     return err;
 
@@ -446,8 +456,7 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 
                     for (int i = 0; i < count; i++) {
 
-                        str.clear();
-                        err = _decode_string(buf, len, r_len, str);
+                        err = _decode_string_view(buf, len, r_len, str);
                         if (err)
                             return err;
 
@@ -494,19 +503,22 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
 
             for (int i = 0; i < count; i++) {
 
-                Variant key, value;
-
-                int used;
-                Error err = decode_variant(key, buf, len, &used, p_allow_objects);
-                ERR_FAIL_COND_V_MSG(err != OK ||(key.get_type() != VariantType::STRING&& key.get_type() != VariantType::STRING_NAME), err, "Error when trying to decode Variant.");
-
-                buf += used;
-                len -= used;
+                // Keys are always strings, read them in place instead of going through a temporary Variant.
+                ERR_FAIL_COND_V(len < 4, ERR_INVALID_DATA);
+                VariantType key_type = VariantType(decode_uint32(buf) & ENCODE_MASK);
+                ERR_FAIL_COND_V_MSG(key_type != VariantType::STRING && key_type != VariantType::STRING_NAME, ERR_INVALID_DATA, "Error when trying to decode Variant.");
+                buf += 4;
+                len -= 4;
                 if (r_len) {
-                    (*r_len) += used;
+                    (*r_len) += 4;
                 }
 
-                err = decode_variant(value, buf, len, &used, p_allow_objects);
+                StringView key;
+                Error err = _decode_string_view(buf, len, r_len, key);
+                ERR_FAIL_COND_V_MSG(err != OK, err, "Error when trying to decode Variant.");
+
+                int used;
+                err = decode_variant(d[StringName(key)], buf, len, &used, p_allow_objects);
                 ERR_FAIL_COND_V_MSG(err != OK, err, "Error when trying to decode Variant.");
 
                 buf += used;
@@ -514,8 +526,6 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
                 if (r_len) {
                     (*r_len) += used;
                 }
-
-                d[key.as<StringName>()] = value;
             }
 
             r_variant = d;
@@ -535,17 +545,19 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
                 (*r_len) += 4;
             }
 
+            // Every element takes at least 4 bytes, reject counts the buffer can't hold before allocating.
+            ERR_FAIL_COND_V(count > len / 4, ERR_INVALID_DATA);
+
             Array varr;
+            varr.resize(count);
 
             for (int i = 0; i < count; i++) {
 
                 int used = 0;
-                Variant v;
-                Error err = decode_variant(v, buf, len, &used, p_allow_objects);
+                Error err = decode_variant(varr[i], buf, len, &used, p_allow_objects);
                 ERR_FAIL_COND_V_MSG(err != OK, err, "Error when trying to decode Variant.");
                 buf += used;
                 len -= used;
-                varr.push_back(v);
                 if (r_len) {
                     (*r_len) += used;
                 }
@@ -642,22 +654,23 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
             ERR_FAIL_COND_V(len < 4, ERR_INVALID_DATA);
             int32_t count = decode_uint32(buf);
 
-            PoolVector<String> strings;
             buf += 4;
             len -= 4;
+            ERR_FAIL_COND_V(count < 0 || count > len / 4, ERR_INVALID_DATA);
 
             if (r_len)
                 (*r_len) += 4;
-            //printf("string count: %i\n",count);
-
-            for (int32_t i = 0; i < count; i++) {
 
-                String str;
-                Error err = _decode_string(buf, len, r_len, str);
-                if (err)
-                    return err;
+            PoolVector<String> strings;
+            if (count) {
+                strings.resize(count);
+                PoolVector<String>::Write w = strings.write();
+                for (int32_t i = 0; i < count; i++) {
 
-                strings.push_back(str);
+                    Error err = _decode_string(buf, len, r_len, w[i]);
+                    if (err)
+                        return err;
+                }
             }
 
             r_variant = strings;
@@ -778,31 +791,365 @@ Error decode_variant(Variant &r_variant, const uint8_t *p_buffer, int p_len, int
     return OK;
 }
 
-static void _encode_string(StringView p_string, uint8_t *&buf, int &r_len) {
+static Error _decode_variant_view(EncodedVariantView &r_view, const uint8_t *p_buffer, int p_len, int *r_len, int p_depth) {
+    ERR_FAIL_COND_V_MSG(p_depth > Variant::MAX_RECURSION_DEPTH, ERR_OUT_OF_MEMORY, "Potential inifite recursion detected. Bailing.");
 
-    size_t len=p_string.size();
-    if (buf) {
-        encode_uint32(len, buf);
-        buf += 4;
-        memcpy(buf, p_string.data(), len);
-        buf += len;
+    const uint8_t *buf = p_buffer;
+    int len = p_len;
+
+    ERR_FAIL_COND_V(len < 4, ERR_INVALID_DATA);
+
+    uint32_t type = decode_uint32(buf);
+
+    ERR_FAIL_COND_V((type & ENCODE_MASK) >= int(VariantType::VARIANT_MAX), ERR_INVALID_DATA);
+
+    buf += 4;
+    len -= 4;
+
+    r_view.encoded = p_buffer;
+    r_view.type = VariantType(type & ENCODE_MASK);
+    r_view.flags = type & ~ENCODE_MASK;
+    r_view.data = buf;
+    r_view.size = 0;
+    r_view.count = 0;
+
+    // Size of the fixed-layout types, -1 for the variable sized ones handled below.
+    int fixed = -1;
+    switch (r_view.type) {
+        case VariantType::NIL:
+        case VariantType::_RID: fixed = 0; break;
+        case VariantType::BOOL: fixed = 4; break;
+        case VariantType::INT:
+        case VariantType::FLOAT: fixed = (type & ENCODE_FLAG_64) ? 8 : 4; break;
+        case VariantType::VECTOR2: fixed = 4 * 2; break;
+        case VariantType::VECTOR3: fixed = 4 * 3; break;
+        case VariantType::RECT2:
+        case VariantType::PLANE:
+        case VariantType::QUAT:
+        case VariantType::COLOR: fixed = 4 * 4; break;
+        case VariantType::TRANSFORM2D:
+        case VariantType::AABB: fixed = 4 * 6; break;
+        case VariantType::BASIS: fixed = 4 * 9; break;
+        case VariantType::TRANSFORM: fixed = 4 * 12; break;
+        case VariantType::OBJECT: {
+            if (type & ENCODE_FLAG_OBJECT_AS_ID) {
+                fixed = 8;
+            }
+        } break;
+        default: {
+        }
     }
 
-    r_len += 4 + len;
-    while (r_len % 4) {
-        r_len++; //pad
-        if (buf) {
-            *(buf++) = 0;
+    if (fixed >= 0) {
+        ERR_FAIL_COND_V(len < fixed, ERR_INVALID_DATA);
+        r_view.size = fixed;
+        buf += fixed;
+    } else {
+        switch (r_view.type) {
+            case VariantType::STRING:
+            case VariantType::STRING_NAME: {
+
+                StringView str;
+                Error err = _decode_string_view(buf, len, nullptr, str);
+                if (err)
+                    return err;
+                r_view.data = (const uint8_t *)str.data();
+                r_view.size = r_view.count = int(str.size());
+
+            } break;
+            case VariantType::NODE_PATH: {
+
+                ERR_FAIL_COND_V(len < 12, ERR_INVALID_DATA);
+                uint32_t namecount = decode_uint32(buf);
+                ERR_FAIL_COND_V(!(namecount & 0x80000000), ERR_INVALID_DATA);
+                uint32_t total = (namecount & 0x7FFFFFFF) + decode_uint32(buf + 4);
+                if (decode_uint32(buf + 8) & 2)
+                    total++;
+                buf += 12;
+                len -= 12;
+                ERR_FAIL_COND_V(total > uint32_t(len / 4), ERR_INVALID_DATA);
+
+                r_view.data = buf;
+                for (uint32_t i = 0; i < total; i++) {
+                    StringView str;
+                    Error err = _decode_string_view(buf, len, nullptr, str);
+                    if (err)
+                        return err;
+                }
+                r_view.count = int(total);
+                r_view.size = int(buf - r_view.data);
+
+            } break;
+            case VariantType::OBJECT: {
+
+                StringView class_name;
+                Error err = _decode_string_view(buf, len, nullptr, class_name);
+                if (err)
+                    return err;
+                if (!class_name.empty()) {
+                    ERR_FAIL_COND_V(len < 4, ERR_INVALID_DATA);
+                    int32_t count = decode_uint32(buf);
+                    buf += 4;
+                    len -= 4;
+                    ERR_FAIL_COND_V(count < 0 || count > len / 8, ERR_INVALID_DATA);
+                    for (int i = 0; i < count; i++) {
+                        StringView name;
+                        err = _decode_string_view(buf, len, nullptr, name);
+                        if (err)
+                            return err;
+                        EncodedVariantView value;
+                        int used;
+                        err = _decode_variant_view(value, buf, len, &used, p_depth + 1);
+                        if (err)
+                            return err;
+                        buf += used;
+                        len -= used;
+                    }
+                    r_view.count = count;
+                }
+                r_view.size = int(buf - r_view.data);
+
+            } break;
+            case VariantType::DICTIONARY:
+            case VariantType::ARRAY: {
+
+                ERR_FAIL_COND_V(len < 4, ERR_INVALID_DATA);
+                int32_t count = decode_uint32(buf) & 0x7FFFFFFF;
+                buf += 4;
+                len -= 4;
+                int elements = r_view.type == VariantType::DICTIONARY ? 2 : 1;
+                ERR_FAIL_COND_V(count > len / (4 * elements), ERR_INVALID_DATA);
+
+                r_view.data = buf;
+                for (int i = 0; i < count * elements; i++) {
+                    EncodedVariantView element;
+                    int used;
+                    Error err = _decode_variant_view(element, buf, len, &used, p_depth + 1);
+                    ERR_FAIL_COND_V_MSG(err != OK, err, "Error when trying to decode Variant.");
+                    buf += used;
+                    len -= used;
+                }
+                r_view.count = count;
+                r_view.size = int(buf - r_view.data);
+
+            } break;
+            case VariantType::POOL_BYTE_ARRAY: {
+
+                ERR_FAIL_COND_V(len < 4, ERR_INVALID_DATA);
+                int32_t count = decode_uint32(buf);
+                buf += 4;
+                len -= 4;
+                ERR_FAIL_COND_V(count < 0 || count > len, ERR_INVALID_DATA);
+                r_view.data = buf;
+                r_view.count = r_view.size = count;
+                // Padding is part of the encoded size even when a trailing array was sent without it.
+                buf += count + (4 - count % 4) % 4;
+
+            } break;
+            case VariantType::POOL_STRING_ARRAY: {
+
+                ERR_FAIL_COND_V(len < 4, ERR_INVALID_DATA);
+                int32_t count = decode_uint32(buf);
+                buf += 4;
+                len -= 4;
+                ERR_FAIL_COND_V(count < 0 || count > len / 4, ERR_INVALID_DATA);
+
+                r_view.data = buf;
+                for (int32_t i = 0; i < count; i++) {
+                    StringView str;
+                    Error err = _decode_string_view(buf, len, nullptr, str);
+                    if (err)
+                        return err;
+                }
+                r_view.count = count;
+                r_view.size = int(buf - r_view.data);
+
+            } break;
+            case VariantType::POOL_INT_ARRAY:
+            case VariantType::POOL_FLOAT32_ARRAY:
+            case VariantType::POOL_VECTOR2_ARRAY:
+            case VariantType::POOL_VECTOR3_ARRAY:
+            case VariantType::POOL_COLOR_ARRAY: {
+
+                int stride = 4;
+                if (r_view.type == VariantType::POOL_VECTOR2_ARRAY)
+                    stride = 4 * 2;
+                else if (r_view.type == VariantType::POOL_VECTOR3_ARRAY)
+                    stride = 4 * 3;
+                else if (r_view.type == VariantType::POOL_COLOR_ARRAY)
+                    stride = 4 * 4;
+
+                ERR_FAIL_COND_V(len < 4, ERR_INVALID_DATA);
+                int32_t count = decode_uint32(buf);
+                buf += 4;
+                len -= 4;
+                ERR_FAIL_COND_V(count < 0 || count > len / stride, ERR_INVALID_DATA);
+                r_view.data = buf;
+                r_view.count = count;
+                r_view.size = count * stride;
+                buf += r_view.size;
+
+            } break;
+            default: {
+                ERR_FAIL_V(ERR_BUG);
+            }
         }
     }
+
+    r_view.encoded_size = int(buf - p_buffer);
+    if (r_len)
+        *r_len = r_view.encoded_size;
+
+    return OK;
 }
 
-Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bool p_full_objects, int p_depth) {
-    ERR_FAIL_COND_V_MSG(p_depth > Variant::MAX_RECURSION_DEPTH, ERR_OUT_OF_MEMORY, "Potential inifite recursion detected. Bailing.");
+Error decode_variant_view(EncodedVariantView &r_view, const uint8_t *p_buffer, int p_len, int *r_len) {
+    return _decode_variant_view(r_view, p_buffer, p_len, r_len, 0);
+}
+
+StringView EncodedVariantView::get_string() const {
+    ERR_FAIL_COND_V(type != VariantType::STRING && type != VariantType::STRING_NAME, StringView());
+    return StringView((const char *)data, size);
+}
+
+Span<const uint8_t> EncodedVariantView::get_bytes() const {
+    ERR_FAIL_COND_V(type != VariantType::POOL_BYTE_ARRAY, Span<const uint8_t>());
+    return Span<const uint8_t>(data, size);
+}
+
+int32_t EncodedVariantView::get_int32(int p_index) const {
+    ERR_FAIL_COND_V(type != VariantType::POOL_INT_ARRAY, 0);
+    ERR_FAIL_INDEX_V(p_index, count, 0);
+    return decode_uint32(data + p_index * 4);
+}
+
+float EncodedVariantView::get_float(int p_index) const {
+    ERR_FAIL_COND_V(type != VariantType::POOL_FLOAT32_ARRAY, 0);
+    ERR_FAIL_INDEX_V(p_index, count, 0);
+    return decode_float(data + p_index * 4);
+}
+
+Vector2 EncodedVariantView::get_vector2(int p_index) const {
+    ERR_FAIL_COND_V(type != VariantType::POOL_VECTOR2_ARRAY, Vector2());
+    ERR_FAIL_INDEX_V(p_index, count, Vector2());
+    const uint8_t *buf = data + p_index * 4 * 2;
+    return Vector2(decode_float(buf), decode_float(buf + 4));
+}
+
+Vector3 EncodedVariantView::get_vector3(int p_index) const {
+    ERR_FAIL_COND_V(type != VariantType::POOL_VECTOR3_ARRAY, Vector3());
+    ERR_FAIL_INDEX_V(p_index, count, Vector3());
+    const uint8_t *buf = data + p_index * 4 * 3;
+    return Vector3(decode_float(buf), decode_float(buf + 4), decode_float(buf + 8));
+}
+
+Color EncodedVariantView::get_color(int p_index) const {
+    ERR_FAIL_COND_V(type != VariantType::POOL_COLOR_ARRAY, Color());
+    ERR_FAIL_INDEX_V(p_index, count, Color());
+    const uint8_t *buf = data + p_index * 4 * 4;
+    return Color(decode_float(buf), decode_float(buf + 4), decode_float(buf + 8), decode_float(buf + 12));
+}
+
+Error EncodedVariantView::get_element(int &r_offset, EncodedVariantView &r_element) const {
+    ERR_FAIL_COND_V(r_offset < 0, ERR_INVALID_PARAMETER);
+    if (r_offset >= size) {
+        return ERR_FILE_EOF;
+    }
+
+    switch (type) {
+        case VariantType::ARRAY:
+        case VariantType::DICTIONARY: {
+            int used;
+            Error err = decode_variant_view(r_element, data + r_offset, size - r_offset, &used);
+            if (err)
+                return err;
+            r_offset += used;
+        } break;
+        case VariantType::POOL_STRING_ARRAY:
+        case VariantType::NODE_PATH: {
+            // Bare strings without a type header, viewed as STRING (or STRING_NAME for path components).
+            const uint8_t *buf = data + r_offset;
+            int len = size - r_offset;
+            StringView str;
+            Error err = _decode_string_view(buf, len, nullptr, str);
+            if (err)
+                return err;
+            r_element = EncodedVariantView();
+            r_element.type = type == VariantType::NODE_PATH ? VariantType::STRING_NAME : VariantType::STRING;
+            r_element.data = (const uint8_t *)str.data();
+            r_element.size = r_element.count = int(str.size());
+            r_element.encoded_size = int(buf - (data + r_offset));
+            r_offset += r_element.encoded_size;
+        } break;
+        default: {
+            ERR_FAIL_V_MSG(ERR_INVALID_PARAMETER, "Only containers and string arrays have elements.");
+        }
+    }
+
+    return OK;
+}
+
+Error EncodedVariantView::to_variant(Variant &r_variant, bool p_allow_objects) const {
+    if (!encoded) {
+        // Element of a POOL_STRING_ARRAY or NODE_PATH, there's no header to hand to decode_variant.
+        if (type == VariantType::STRING_NAME) {
+            r_variant = StringName(get_string());
+        } else {
+            r_variant = String(get_string());
+        }
+        return OK;
+    }
+    return decode_variant(r_variant, encoded, encoded_size, nullptr, p_allow_objects);
+}
+
+namespace {
+// Encoding targets. grab(n) reserves the next n bytes of output and returns where to write them, or nullptr when
+// only the size is being computed, so the same encoder walk serves measuring, raw buffers and growable vectors.
+struct MeasureSink {
+    int len = 0;
+    uint8_t *grab(int p_bytes) {
+        len += p_bytes;
+        return nullptr;
+    }
+};
+
+struct BufferSink {
+    uint8_t *buffer;
+    int len = 0;
+    uint8_t *grab(int p_bytes) {
+        uint8_t *res = buffer + len;
+        len += p_bytes;
+        return res;
+    }
+};
+
+struct VectorSink {
+    Vector<uint8_t> &out;
+    int len = 0;
+    uint8_t *grab(int p_bytes) {
+        size_t ofs = out.size();
+        out.resize(ofs + p_bytes);
+        len += p_bytes;
+        return out.data() + ofs;
+    }
+};
+
+template <class Sink>
+void _encode_string(StringView p_string, Sink &r_sink) {
 
-    uint8_t *buf = r_buffer;
+    int len = int(p_string.size());
+    int pad = (4 - len % 4) % 4;
+    uint8_t *buf = r_sink.grab(4 + len + pad);
+    if (buf) {
+        encode_uint32(len, buf);
+        memcpy(buf + 4, p_string.data(), len);
+        memset(buf + 4 + len, 0, pad);
+    }
+}
 
-    r_len = 0;
+template <class Sink>
+Error _encode_variant(const Variant &p_variant, Sink &r_sink, bool p_full_objects, int p_depth) {
+    ERR_FAIL_COND_V_MSG(p_depth > Variant::MAX_RECURSION_DEPTH, ERR_OUT_OF_MEMORY, "Potential inifite recursion detected. Bailing.");
 
     uint32_t flags = 0;
 
@@ -827,10 +1174,10 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
             Object *obj = p_variant.as<Object *>();
             if (!obj) {
                 // Object is invalid, send a NULL instead.
+                uint8_t *buf = r_sink.grab(4);
                 if (buf) {
                     encode_uint32((uint32_t)VariantType::NIL, buf);
                 }
-                r_len += 4;
                 return OK;
             }
             if (!p_full_objects) {
@@ -841,11 +1188,10 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
         } // nothing to do at this stage
     }
 
+    uint8_t *buf = r_sink.grab(4);
     if (buf) {
         encode_uint32(uint32_t(p_variant.get_type()) | flags, buf);
-        buf += 4;
     }
-    r_len += 4;
 
     switch (p_variant.get_type()) {
 
@@ -855,52 +1201,46 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
         } break;
         case VariantType::BOOL: {
 
+            buf = r_sink.grab(4);
             if (buf) {
                 encode_uint32(p_variant.as<bool>(), buf);
             }
 
-            r_len += 4;
-
         } break;
         case VariantType::INT: {
 
             if (flags & ENCODE_FLAG_64) {
                 //64 bits
+                buf = r_sink.grab(8);
                 if (buf) {
                     encode_uint64(p_variant.as<int64_t>(), buf);
                 }
-
-                r_len += 8;
             } else {
+                buf = r_sink.grab(4);
                 if (buf) {
                     encode_uint32(p_variant.as<int32_t>(), buf);
                 }
-
-                r_len += 4;
             }
         } break;
         case VariantType::FLOAT: {
 
             if (flags & ENCODE_FLAG_64) {
+                buf = r_sink.grab(8);
                 if (buf) {
                     encode_double(p_variant.as<double>(), buf);
                 }
-
-                r_len += 8;
-
             } else {
-
+                buf = r_sink.grab(4);
                 if (buf) {
                     encode_float(p_variant.as<float>(), buf);
                 }
-
-                r_len += 4;
             }
 
         } break;
         case VariantType::NODE_PATH: {
 
             NodePath np = p_variant.as<NodePath>();
+            buf = r_sink.grab(12);
             if (buf) {
                 encode_uint32(uint32_t(np.get_name_count()) | 0x80000000, buf); //for compatibility with the old format
                 encode_uint32(np.get_subname_count(), buf + 4);
@@ -909,59 +1249,37 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
                     np_flags |= 1;
 
                 encode_uint32(np_flags, buf + 8);
-
-                buf += 12;
             }
 
-            r_len += 12;
-
-            int total = np.get_name_count() + np.get_subname_count();
-
-            for (int i = 0; i < total; i++) {
-
-                StringView str;
-
-                if (i < np.get_name_count())
-                    str = np.get_name(i);
-                else
-                    str = np.get_subname(i - np.get_name_count());
-
-                int pad = 0;
-
-                if (str.length() % 4)
-                    pad = 4 - str.length() % 4;
-
-                if (buf) {
-                    encode_uint32(str.length(), buf);
-                    buf += 4;
-                    memcpy(buf, str.data(), str.length());
-                    buf += pad + str.length();
-                }
-
-                r_len += 4 + str.length() + pad;
+            for (const StringName &name : np.get_names()) {
+                _encode_string(name, r_sink);
+            }
+            for (const StringName &name : np.get_subnames()) {
+                _encode_string(name, r_sink);
             }
 
         } break;
-        case VariantType::STRING: {
+        case VariantType::STRING:
+        case VariantType::STRING_NAME: {
 
-            _encode_string(p_variant.as<String>(), buf, r_len);
+            _encode_string(p_variant.as<StringView>(), r_sink);
 
         } break;
 
         // math types
         case VariantType::VECTOR2: {
 
+            buf = r_sink.grab(2 * 4);
             if (buf) {
                 Vector2 v2 = p_variant.as<Vector2>();
                 encode_float(v2.x, &buf[0]);
                 encode_float(v2.y, &buf[4]);
             }
 
-            r_len += 2 * 4;
-
         } break; // 5
         case VariantType::RECT2: {
 
+            buf = r_sink.grab(4 * 4);
             if (buf) {
                 Rect2 r2 = p_variant.as<Rect2>();
                 encode_float(r2.position.x, &buf[0]);
@@ -969,11 +1287,11 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
                 encode_float(r2.size.x, &buf[8]);
                 encode_float(r2.size.y, &buf[12]);
             }
-            r_len += 4 * 4;
 
         } break;
         case VariantType::VECTOR3: {
 
+            buf = r_sink.grab(3 * 4);
             if (buf) {
                 Vector3 v3 = p_variant.as<Vector3>();
                 encode_float(v3.x, &buf[0]);
@@ -981,11 +1299,10 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
                 encode_float(v3.z, &buf[8]);
             }
 
-            r_len += 3 * 4;
-
         } break;
         case VariantType::TRANSFORM2D: {
 
+            buf = r_sink.grab(6 * 4);
             if (buf) {
                 Transform2D val = p_variant.as<Transform2D>();
                 for (int i = 0; i < 3; i++) {
@@ -996,11 +1313,10 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
                 }
             }
 
-            r_len += 6 * 4;
-
         } break;
         case VariantType::PLANE: {
 
+            buf = r_sink.grab(4 * 4);
             if (buf) {
                 Plane p = p_variant.as<Plane>();
                 encode_float(p.normal.x, &buf[0]);
@@ -1009,11 +1325,10 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
                 encode_float(p.d, &buf[12]);
             }
 
-            r_len += 4 * 4;
-
         } break;
         case VariantType::QUAT: {
 
+            buf = r_sink.grab(4 * 4);
             if (buf) {
                 Quat q = p_variant.as<Quat>();
                 encode_float(q.x, &buf[0]);
@@ -1022,11 +1337,10 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
                 encode_float(q.w, &buf[12]);
             }
 
-            r_len += 4 * 4;
-
         } break;
         case VariantType::AABB: {
 
+            buf = r_sink.grab(6 * 4);
             if (buf) {
                 AABB aabb = p_variant.as<AABB>();
                 encode_float(aabb.position.x, &buf[0]);
@@ -1037,11 +1351,10 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
                 encode_float(aabb.size.z, &buf[20]);
             }
 
-            r_len += 6 * 4;
-
         } break;
         case VariantType::BASIS: {
 
+            buf = r_sink.grab(9 * 4);
             if (buf) {
                 Basis val = p_variant.as<Basis>();
                 for (int i = 0; i < 3; i++) {
@@ -1052,11 +1365,10 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
                 }
             }
 
-            r_len += 9 * 4;
-
         } break;
         case VariantType::TRANSFORM: {
 
+            buf = r_sink.grab(12 * 4);
             if (buf) {
                 Transform val = p_variant.as<Transform>();
                 for (int i = 0; i < 3; i++) {
@@ -1071,13 +1383,12 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
                 encode_float(val.origin.z, &buf[44]);
             }
 
-            r_len += 12 * 4;
-
         } break;
 
         // misc types
         case VariantType::COLOR: {
 
+            buf = r_sink.grab(4 * 4);
             if (buf) {
                 Color c = p_variant.as<Color>();
                 encode_float(c.r, &buf[0]);
@@ -1086,12 +1397,6 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
                 encode_float(c.a, &buf[12]);
             }
 
-            r_len += 4 * 4;
-
-        } break;
-        case VariantType::STRING_NAME: {
-            _encode_string((StringName)p_variant, buf, r_len);
-
         } break;
         case VariantType::_RID: {
 
@@ -1102,13 +1407,13 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
 
                 Object *obj = p_variant.as<Object *>();
                 if (!obj) {
+                    buf = r_sink.grab(4);
                     if (buf) {
                         encode_uint32(0, buf);
                     }
-                    r_len += 4;
 
                 } else {
-                    _encode_string(StringView(obj->get_class()), buf, r_len);
+                    _encode_string(StringView(obj->get_class()), r_sink);
 
                     Vector<PropertyInfo> props;
                     obj->get_property_list(&props);
@@ -1121,30 +1426,24 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
                         pc++;
                     }
 
+                    buf = r_sink.grab(4);
                     if (buf) {
                         encode_uint32(pc, buf);
-                        buf += 4;
                     }
 
-                    r_len += 4;
-
                     for(PropertyInfo &E : props ) {
 
                         if (!(E.usage & PROPERTY_USAGE_STORAGE))
                             continue;
 
-                        _encode_string(E.name, buf, r_len);
+                        _encode_string(E.name, r_sink);
 
-                        int len;
-                        Error err = encode_variant(obj->get(E.name), buf, len, p_full_objects, p_depth + 1);
+                        Error err = _encode_variant(obj->get(E.name), r_sink, p_full_objects, p_depth + 1);
                         ERR_FAIL_COND_V(err, err);
-                        ERR_FAIL_COND_V(len % 4, ERR_BUG);
-                        r_len += len;
-                        if (buf)
-                            buf += len;
                     }
                 }
             } else {
+                buf = r_sink.grab(8);
                 if (buf) {
 
                     Object *obj = p_variant.as<Object *>();
@@ -1155,43 +1454,29 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
 
                     encode_uint64(entt::to_integral(id), buf);
                 }
-
-                r_len += 8;
             }
 
         } break;
         case VariantType::DICTIONARY: {
 
-            Dictionary d = p_variant.as<Dictionary>();
+            const Dictionary d = p_variant.as<Dictionary>();
 
+            buf = r_sink.grab(4);
             if (buf) {
                 encode_uint32(uint32_t(d.size()), buf);
-                buf += 4;
             }
-            r_len += 4;
-
-            auto keys(d.get_key_list());
 
-            for(auto &E : keys ) {
-                Variant *v = d.getptr(E);
+            for (const StringName *key = d.next(); key; key = d.next(key)) {
 
-                int len;
-                Error err = encode_variant(v ? E : Variant("[Deleted Object]"), buf, len, p_full_objects, p_depth + 1);
-                ERR_FAIL_COND_V(err, err);
-                ERR_FAIL_COND_V(len % 4, ERR_BUG);
-
-                r_len += len;
+                // Keys are written as STRING_NAME variants, same as encoding Variant(*key) would.
+                buf = r_sink.grab(4);
                 if (buf) {
-                    buf += len;
+                    encode_uint32(uint32_t(VariantType::STRING_NAME), buf);
                 }
+                _encode_string(*key, r_sink);
 
-                err = encode_variant(v ? *v : Variant(), buf, len, p_full_objects, p_depth + 1);
+                Error err = _encode_variant(d[*key], r_sink, p_full_objects, p_depth + 1);
                 ERR_FAIL_COND_V(err, err);
-                ERR_FAIL_COND_V(len % 4, ERR_BUG);
-                r_len += len;
-                if (buf) {
-                    buf += len;
-                }
             }
 
         } break;
@@ -1199,22 +1484,15 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
 
             Array v = p_variant.as<Array>();
 
+            buf = r_sink.grab(4);
             if (buf) {
                 encode_uint32(uint32_t(v.size()), buf);
-                buf += 4;
             }
 
-            r_len += 4;
-
             for (int i = 0; i < v.size(); i++) {
 
-                int len;
-                Error err = encode_variant(v.get(i), buf, len, p_full_objects, p_depth + 1);
+                Error err = _encode_variant(v.get(i), r_sink, p_full_objects, p_depth + 1);
                 ERR_FAIL_COND_V(err, err);
-                ERR_FAIL_COND_V(len % 4, ERR_BUG);
-                r_len += len;
-                if (buf)
-                    buf += len;
             }
 
         } break;
@@ -1223,21 +1501,17 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
 
             PoolVector<uint8_t> data = p_variant.as<PoolVector<uint8_t>>();
             int datalen = data.size();
-            int datasize = sizeof(uint8_t);
+            int pad = (4 - datalen % 4) % 4;
 
+            buf = r_sink.grab(4 + datalen + pad);
             if (buf) {
                 encode_uint32(datalen, buf);
                 buf += 4;
-                PoolVector<uint8_t>::Read r = data.read();
-                memcpy(buf, &r[0], datalen * datasize);
-                buf += datalen * datasize;
-            }
-
-            r_len += 4 + datalen * datasize;
-            while (r_len % 4) {
-                r_len++;
-                if (buf)
-                    *(buf++) = 0;
+                if (datalen) {
+                    PoolVector<uint8_t>::Read r = data.read();
+                    memcpy(buf, r.ptr(), datalen);
+                }
+                memset(buf + datalen, 0, pad);
             }
 
         } break;
@@ -1247,6 +1521,7 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
             int datalen = data.size();
             int datasize = sizeof(int32_t);
 
+            buf = r_sink.grab(4 + datalen * datasize);
             if (buf) {
                 encode_uint32(datalen, buf);
                 buf += 4;
@@ -1255,8 +1530,6 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
                     encode_uint32(r[i], &buf[i * datasize]);
             }
 
-            r_len += 4 + datalen * datasize;
-
         } break;
         case VariantType::POOL_FLOAT32_ARRAY: {
 
@@ -1264,6 +1537,7 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
             int datalen = data.size();
             int datasize = sizeof(real_t);
 
+            buf = r_sink.grab(4 + datalen * datasize);
             if (buf) {
                 encode_uint32(datalen, buf);
                 buf += 4;
@@ -1272,38 +1546,20 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
                     encode_float(r[i], &buf[i * datasize]);
             }
 
-            r_len += 4 + datalen * datasize;
-
         } break;
         case VariantType::POOL_STRING_ARRAY: {
 
             PoolVector<String> data = p_variant.as<PoolVector<String>>();
             int len = data.size();
 
+            buf = r_sink.grab(4);
             if (buf) {
                 encode_uint32(len, buf);
-                buf += 4;
             }
 
-            r_len += 4;
-
+            PoolVector<String>::Read r = data.read();
             for (int i = 0; i < len; i++) {
-
-                String utf8(data.get(i));
-
-                if (buf) {
-                    encode_uint32(utf8.length(), buf);
-                    buf += 4;
-                    memcpy(buf, utf8.data(), utf8.length());
-                    buf += utf8.length();
-                }
-
-                r_len += 4 + utf8.length() + 1;
-                while (r_len % 4) {
-                    r_len++; //pad
-                    if (buf)
-                        *(buf++) = 0;
-                }
+                _encode_string(r[i], r_sink);
             }
 
         } break;
@@ -1312,18 +1568,15 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
             PoolVector<Vector2> data = p_variant.as<PoolVector<Vector2>>();
             int len = data.size();
 
+            buf = r_sink.grab(4 + 4 * 2 * len);
             if (buf) {
                 encode_uint32(len, buf);
                 buf += 4;
-            }
-
-            r_len += 4;
-
-            if (buf) {
 
+                PoolVector<Vector2>::Read r = data.read();
                 for (int i = 0; i < len; i++) {
 
-                    Vector2 v = data.get(i);
+                    const Vector2 &v = r[i];
 
                     encode_float(v.x, &buf[0]);
                     encode_float(v.y, &buf[4]);
@@ -1331,26 +1584,21 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
                 }
             }
 
-            r_len += 4 * 2 * len;
-
         } break;
         case VariantType::POOL_VECTOR3_ARRAY: {
 
             PoolVector<Vector3> data = p_variant.as<PoolVector<Vector3>>();
             int len = data.size();
 
+            buf = r_sink.grab(4 + 4 * 3 * len);
             if (buf) {
                 encode_uint32(len, buf);
                 buf += 4;
-            }
-
-            r_len += 4;
-
-            if (buf) {
 
+                PoolVector<Vector3>::Read r = data.read();
                 for (int i = 0; i < len; i++) {
 
-                    Vector3 v = data.get(i);
+                    const Vector3 &v = r[i];
 
                     encode_float(v.x, &buf[0]);
                     encode_float(v.y, &buf[4]);
@@ -1359,26 +1607,21 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
                 }
             }
 
-            r_len += 4 * 3 * len;
-
         } break;
         case VariantType::POOL_COLOR_ARRAY: {
 
             PoolVector<Color> data = p_variant.as<PoolVector<Color>>();
             int len = data.size();
 
+            buf = r_sink.grab(4 + 4 * 4 * len);
             if (buf) {
                 encode_uint32(len, buf);
                 buf += 4;
-            }
-
-            r_len += 4;
-
-            if (buf) {
 
+                PoolVector<Color>::Read r = data.read();
                 for (int i = 0; i < len; i++) {
 
-                    Color c = data.get(i);
+                    const Color &c = r[i];
 
                     encode_float(c.r, &buf[0]);
                     encode_float(c.g, &buf[4]);
@@ -1388,8 +1631,6 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
                 }
             }
 
-            r_len += 4 * 4 * len;
-
         } break;
         default: {
             ERR_FAIL_V(ERR_BUG);
@@ -1398,3 +1639,30 @@ Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bo
 
     return OK;
 }
+} // end of anonymous namespace
+
+Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bool p_full_objects, int p_depth) {
+
+    if (!r_buffer) {
+        MeasureSink sink;
+        Error err = _encode_variant(p_variant, sink, p_full_objects, p_depth);
+        r_len = sink.len;
+        return err;
+    }
+
+    BufferSink sink { r_buffer };
+    Error err = _encode_variant(p_variant, sink, p_full_objects, p_depth);
+    r_len = sink.len;
+    return err;
+}
+
+Error encode_variant(const Variant &p_variant, Vector<uint8_t> &r_buffer, bool p_full_objects) {
+
+    size_t start = r_buffer.size();
+    VectorSink sink { r_buffer };
+    Error err = _encode_variant(p_variant, sink, p_full_objects, 0);
+    if (err != OK) {
+        r_buffer.resize(start);
+    }
+    return err;
+}
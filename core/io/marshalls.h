@@ -30,9 +30,14 @@
 
 #pragma once
 #include "core/typedefs.h"
+#include "core/forward_decls.h"
 
 class Variant;
 enum Error : int;
+enum class VariantType : int8_t;
+struct Vector2;
+struct Vector3;
+struct Color;
 /**
  * Miscellaneous helpers for marshalling data types, and encoding
  * in an endian independent way
@@ -165,3 +170,52 @@ static inline double decode_double(const uint8_t *p_arr) {
 GODOT_EXPORT Error decode_variant(
         Variant &r_variant, const uint8_t *p_buffer, int p_len, int *r_len = nullptr, bool p_allow_objects = false);
 GODOT_EXPORT Error encode_variant(const Variant &p_variant, uint8_t *r_buffer, int &r_len, bool p_full_objects = false, int p_depth = 0);
+/**
+ * Appends the encoding of p_variant to r_buffer in a single pass over the variant.
+ * Keep the same buffer around (clearing it between packets) so its capacity is reused.
+ * On failure r_buffer is restored to its original size.
+ */
+GODOT_EXPORT Error encode_variant(const Variant &p_variant, Vector<uint8_t> &r_buffer, bool p_full_objects = false);
+
+/**
+ * Non-owning view of an encoded variant, pointing into the buffer it was decoded from.
+ * Strings, pool arrays and containers can be inspected without materializing a Variant;
+ * the view is only valid while that buffer is alive.
+ */
+struct GODOT_EXPORT EncodedVariantView {
+    const uint8_t *encoded = nullptr; ///< start of the encoding, including the type header
+    const uint8_t *data = nullptr; ///< first payload byte (string bytes, first element, ...)
+    int encoded_size = 0; ///< total encoded size in bytes
+    int size = 0; ///< payload bytes, excluding element count and padding
+    int count = 0; ///< string length, element count of arrays/pool arrays, entry count of dictionaries
+    uint32_t flags = 0;
+    VariantType type = VariantType(0); // NIL
+
+    //! STRING, STRING_NAME
+    StringView get_string() const;
+    //! POOL_BYTE_ARRAY
+    Span<const uint8_t> get_bytes() const;
+    //! POOL_INT_ARRAY
+    int32_t get_int32(int p_index) const;
+    //! POOL_FLOAT32_ARRAY
+    float get_float(int p_index) const;
+    //! POOL_VECTOR2_ARRAY
+    Vector2 get_vector2(int p_index) const;
+    //! POOL_VECTOR3_ARRAY
+    Vector3 get_vector3(int p_index) const;
+    //! POOL_COLOR_ARRAY
+    Color get_color(int p_index) const;
+    /**
+     * Iterates the elements of ARRAY, DICTIONARY (key, value, key, value...), POOL_STRING_ARRAY and NODE_PATH
+     * views. Start with r_offset = 0, returns ERR_FILE_EOF past the last element.
+     */
+    Error get_element(int &r_offset, EncodedVariantView &r_element) const;
+    //! Materializes the viewed value.
+    Error to_variant(Variant &r_variant, bool p_allow_objects = false) const;
+};
+
+/**
+ * Validates the encoding at p_buffer and fills r_view without allocating.
+ * r_len receives the encoded size, as with decode_variant.
+ */
+GODOT_EXPORT Error decode_variant_view(EncodedVariantView &r_view, const uint8_t *p_buffer, int p_len, int *r_len = nullptr);
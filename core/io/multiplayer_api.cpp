@@ -668,27 +668,24 @@ void MultiplayerAPI::_send_rpc(Node *p_from, int p_to, bool p_unreliable, bool p
     encode_cstring(name.data(), &packet_cache[ofs]);
     ofs += len;
 
+    // Arguments are appended right after the header, each one in a single pass over the Variant.
+    bool full_objects = allow_object_decoding || network_peer->is_object_decoding_allowed();
+    packet_cache.resize(ofs);
+
     if (p_set) {
         // Set argument.
-        Error err = encode_variant(*p_arg[0], nullptr, len, allow_object_decoding || network_peer->is_object_decoding_allowed());
+        Error err = encode_variant(*p_arg[0], packet_cache, full_objects);
         ERR_FAIL_COND_MSG(err != OK, "Unable to encode RSET value. THIS IS LIKELY A BUG IN THE ENGINE!");
-        MAKE_ROOM(ofs + len)
-        encode_variant(*p_arg[0], &packet_cache[ofs], len, allow_object_decoding || network_peer->is_object_decoding_allowed());
-        ofs += len;
 
     } else {
         // Call arguments.
-        MAKE_ROOM(ofs + 1)
-        packet_cache[ofs] = p_argcount;
-        ofs += 1;
+        packet_cache.push_back(uint8_t(p_argcount));
         for (int i = 0; i < p_argcount; i++) {
-            Error err = encode_variant(*p_arg[i], nullptr, len, allow_object_decoding || network_peer->is_object_decoding_allowed());
+            Error err = encode_variant(*p_arg[i], packet_cache, full_objects);
             ERR_FAIL_COND_MSG(err != OK, "Unable to encode RPC argument. THIS IS LIKELY A BUG IN THE ENGINE!");
-            MAKE_ROOM(ofs + len)
-            encode_variant(*p_arg[i], &packet_cache[ofs], len, allow_object_decoding || network_peer->is_object_decoding_allowed());
-            ofs += len;
         }
     }
+    ofs = packet_cache.size();
 
     m_debug_data->record_rpc_call(ofs);
 
@@ -40,3 +40,38 @@ NetSocket *NetSocket::create() {
     ERR_PRINT("Unable to create network socket, platform not supported");
     return nullptr;
 }
+
+Error NetSocket::recvfrom_batch(Datagram *r_datagrams, int p_count, int &r_count) {
+
+    r_count = 0;
+    while (r_count < p_count) {
+        Datagram &d = r_datagrams[r_count];
+        int read = 0;
+        const Error err = recvfrom(d.buffer, d.size, read, d.ip, d.port);
+        if (err != OK) {
+            if (err == ERR_BUSY && r_count > 0)
+                break;
+            return err;
+        }
+        d.size = read;
+        ++r_count;
+    }
+    return OK;
+}
+
+Error NetSocket::sendto_batch(const Datagram *p_datagrams, int p_count, int &r_count) {
+
+    r_count = 0;
+    while (r_count < p_count) {
+        const Datagram &d = p_datagrams[r_count];
+        int sent = 0;
+        const Error err = sendto(d.buffer, d.size, sent, d.ip, d.port);
+        if (err != OK) {
+            if (err == ERR_BUSY && r_count > 0)
+                break;
+            return err;
+        }
+        ++r_count;
+    }
+    return OK;
+}
@@ -53,6 +53,15 @@ public:
         TYPE_UDP,
     };
 
+    // One datagram of a batched transfer. When receiving, size is the capacity of buffer on input and the datagram
+    // length on output, ip and port are filled with the sender.
+    struct Datagram {
+        uint8_t *buffer;
+        int size;
+        IP_Address ip;
+        uint16_t port;
+    };
+
     virtual Error open(Type p_type, IP::Type &ip_type) = 0;
     virtual void close() = 0;
     virtual Error bind(IP_Address p_addr, uint16_t p_port) = 0;
@@ -64,6 +73,10 @@ public:
     virtual Error send(const uint8_t *p_buffer, int p_len, int &r_sent) = 0;
     virtual Error sendto(const uint8_t *p_buffer, int p_len, int &r_sent, IP_Address p_ip, uint16_t p_port) = 0;
     virtual Ref<NetSocket> accept(IP_Address &r_ip, uint16_t &r_port) = 0;
+    // Move up to p_count datagrams in as few system calls as the platform allows, r_count is how many were moved.
+    // Returns ERR_BUSY only if none could be moved without blocking. The defaults call recvfrom/sendto in a loop.
+    virtual Error recvfrom_batch(Datagram *r_datagrams, int p_count, int &r_count);
+    virtual Error sendto_batch(const Datagram *p_datagrams, int p_count, int &r_count);
 
     virtual bool is_open() const = 0;
     virtual int get_available_bytes() const = 0;
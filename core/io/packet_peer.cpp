@@ -106,10 +106,11 @@ Error PacketPeer::get_var(Variant &r_variant, bool p_allow_objects) {
 
 Error PacketPeer::put_var(const Variant &p_packet, bool p_full_objects) {
 
+    // Measure first, so an oversized variant is refused before anything gets allocated or encoded.
+    const bool full_objects = p_full_objects || allow_object_decoding;
     int len;
-    Error err = encode_variant(p_packet, nullptr, len, p_full_objects || allow_object_decoding); // compute len first
-    if (err)
-        return err;
+    Error err = encode_variant(p_packet, nullptr, len, full_objects);
+    ERR_FAIL_COND_V_MSG(err != OK, err, "Error when trying to encode Variant.");
 
     if (len == 0)
         return OK;
@@ -118,11 +119,11 @@ Error PacketPeer::put_var(const Variant &p_packet, bool p_full_objects) {
             "Failed to encode variant, encode size is bigger then encode_buffer_max_size. Consider raising it via "
             "'set_encode_buffer_max_size'.");
 
-    if (unlikely(encode_buffer.size() < len)) {
+    // The buffer only grows, later packets reuse it.
+    if (int(encode_buffer.size()) < len)
         encode_buffer.resize(next_power_of_2(len));
-    }
 
-    err = encode_variant(p_packet, encode_buffer.data(), len, p_full_objects || allow_object_decoding);
+    err = encode_variant(p_packet, encode_buffer.data(), len, full_objects);
     ERR_FAIL_COND_V_MSG(err != OK, err, "Error when trying to encode Variant.");
 
     return put_packet(encode_buffer.data(), len);
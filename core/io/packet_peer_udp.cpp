@@ -122,22 +122,29 @@ Error PacketPeerUDP::get_packet(const uint8_t **r_buffer, int &r_buffer_size) {
     return OK;
 }
 
+Error PacketPeerUDP::_open_for(const IP_Address &p_address) {
+
+    if (_sock->is_open())
+        return OK;
+
+    IP::Type ip_type = p_address.is_ipv4() ? IP::TYPE_IPV4 : IP::TYPE_IPV6;
+    Error err = _sock->open(NetSocket::TYPE_UDP, ip_type);
+    ERR_FAIL_COND_V(err != OK, err);
+    _sock->set_blocking_enabled(false);
+    _sock->set_broadcasting_enabled(broadcast);
+    return OK;
+}
+
 Error PacketPeerUDP::put_packet(const uint8_t *p_buffer, int p_buffer_size) {
 
     ERR_FAIL_COND_V(not _sock, ERR_UNAVAILABLE);
     ERR_FAIL_COND_V(!peer_addr.is_valid(), ERR_UNCONFIGURED);
 
-    Error err;
-    int sent = -1;
-
-    if (!_sock->is_open()) {
-        IP::Type ip_type = peer_addr.is_ipv4() ? IP::TYPE_IPV4 : IP::TYPE_IPV6;
-        err = _sock->open(NetSocket::TYPE_UDP, ip_type);
-        ERR_FAIL_COND_V(err != OK, err);
-        _sock->set_blocking_enabled(false);
-        _sock->set_broadcasting_enabled(broadcast);
-    }
+    Error err = _open_for(peer_addr);
+    if (err != OK)
+        return err;
 
+    int sent = -1;
     do {
         err = _sock->sendto(p_buffer, p_buffer_size, sent, peer_addr, peer_port);
         if (err != OK) {
@@ -155,6 +162,34 @@ Error PacketPeerUDP::put_packet(const uint8_t *p_buffer, int p_buffer_size) {
     return OK;
 }
 
+Error PacketPeerUDP::put_packets(const NetSocket::Datagram *p_packets, int p_count, int &r_sent) {
+
+    r_sent = 0;
+    ERR_FAIL_COND_V(not _sock, ERR_UNAVAILABLE);
+    if (p_count == 0)
+        return OK;
+
+    Error err = _open_for(p_packets[0].ip);
+    if (err != OK)
+        return err;
+
+    while (r_sent < p_count) {
+        int sent = 0;
+        err = _sock->sendto_batch(p_packets + r_sent, p_count - r_sent, sent);
+        if (err != OK) {
+            if (err != ERR_BUSY)
+                return FAILED;
+            else if (!blocking)
+                return ERR_BUSY;
+            continue;
+        }
+        r_sent += sent;
+        if (r_sent < p_count && !blocking)
+            return ERR_BUSY;
+    }
+    return OK;
+}
+
 int PacketPeerUDP::get_max_packet_size() const {
 
     return 512; // uhm maybe not
@@ -195,6 +230,9 @@ void PacketPeerUDP::close() {
         _sock->close();
     rb.resize(16);
     queue_count = 0;
+    recv_buffer.clear();
+    recv_buffer.shrink_to_fit();
+    recv_slots = 0;
 }
 
 Error PacketPeerUDP::wait() {
@@ -211,12 +249,20 @@ Error PacketPeerUDP::_poll() {
         return FAILED;
     }
 
-    int read;
-    IP_Address ip;
-    uint16_t port;
+    if (recv_slots == 0) {
+        recv_slots = 1;
+        recv_buffer.resize(PACKET_BUFFER_SIZE);
+    }
 
+    NetSocket::Datagram batch[RECV_BATCH];
     while (true) {
-        const Error err = _sock->recvfrom(recv_buffer, sizeof(recv_buffer), read, ip, port);
+        for (int i = 0; i < recv_slots; i++) {
+            batch[i].buffer = recv_buffer.data() + i * PACKET_BUFFER_SIZE;
+            batch[i].size = PACKET_BUFFER_SIZE;
+        }
+
+        int count = 0;
+        const Error err = _sock->recvfrom_batch(batch, recv_slots, count);
 
         if (err != OK) {
             if (err == ERR_BUSY)
@@ -224,17 +270,27 @@ Error PacketPeerUDP::_poll() {
             return FAILED;
         }
 
-        if (rb.space_left() < read + 24) {
-            WARN_PRINT_TOOLING("Buffer full, dropping packets!");
-            continue;
+        for (int i = 0; i < count; i++) {
+            const NetSocket::Datagram &d = batch[i];
+            if (rb.space_left() < d.size + 24) {
+                WARN_PRINT_TOOLING("Buffer full, dropping packets!");
+                continue;
+            }
+
+            uint32_t port32 = d.port;
+            rb.write(d.ip.get_ipv6(), 16);
+            rb.write((uint8_t *)&port32, 4);
+            rb.write((uint8_t *)&d.size, 4);
+            rb.write(d.buffer, d.size);
+            ++queue_count;
         }
 
-        uint32_t port32 = port;
-        rb.write(ip.get_ipv6(), 16);
-        rb.write((uint8_t *)&port32, 4);
-        rb.write((uint8_t *)&read, 4);
-        rb.write(recv_buffer, read);
-        ++queue_count;
+        if (count < recv_slots)
+            break; // Socket drained.
+        if (recv_slots < RECV_BATCH) {
+            recv_slots = MIN(recv_slots * 2, int(RECV_BATCH));
+            recv_buffer.resize(recv_slots * PACKET_BUFFER_SIZE);
+        }
     }
 
     return OK;
@@ -38,11 +38,15 @@ class GODOT_EXPORT PacketPeerUDP : public PacketPeer {
 
 protected:
     enum {
-        PACKET_BUFFER_SIZE = 65536
+        PACKET_BUFFER_SIZE = 65536,
+        RECV_BATCH = 16 // datagrams read per system call when the platform supports it
     };
 
     RingBuffer<uint8_t> rb;
-    uint8_t recv_buffer[PACKET_BUFFER_SIZE];
+    // recv_slots slots of PACKET_BUFFER_SIZE. Starts at one on first receive and doubles up to RECV_BATCH
+    // while reads keep filling every slot, so quiet sockets don't hold a full batch.
+    Vector<uint8_t> recv_buffer;
+    int recv_slots = 0;
     uint8_t packet_buffer[PACKET_BUFFER_SIZE];
     IP_Address packet_ip;
     int packet_port=0;
@@ -63,6 +67,7 @@ public:
 
     Error _set_dest_address(const String &p_address, int p_port);
     Error _poll();
+    Error _open_for(const IP_Address &p_address);
 
 public:
     void set_blocking_mode(bool p_enable);
@@ -77,10 +82,15 @@ public:
     void set_dest_address(const IP_Address &p_address, int p_port);
 
     Error put_packet(const uint8_t *p_buffer, int p_buffer_size) override;
+    // Sends many datagrams, each to its own address, in as few system calls as possible.
+    // r_sent is how many went out, in non-blocking mode ERR_BUSY is returned if that's not all of them.
+    Error put_packets(const NetSocket::Datagram *p_packets, int p_count, int &r_sent);
     Error get_packet(const uint8_t **r_buffer, int &r_buffer_size) override;
     int get_available_packet_count() const override;
     int get_max_packet_size() const override;
     void set_broadcast_enabled(bool p_enabled);
+    // Underlying socket, for registration with an IOMultiplexer once listening.
+    const Ref<NetSocket> &get_socket() const { return _sock; }
     Error join_multicast_group(IP_Address p_multi_address, StringView p_if_name);
     Error join_multicast_group(StringView p_multi_address, StringView p_if_name) {
         return join_multicast_group(IP_Address(p_multi_address), p_if_name);
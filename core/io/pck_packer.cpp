@@ -134,6 +134,8 @@ Error PCKPacker::flush(bool p_verbose) {
         file->store_32(0);
         file->store_32(0);
         file->store_32(0);
+
+        file->store_32(0); // flags, stored as is
     }
 
     uint64_t ofs = file->get_position();
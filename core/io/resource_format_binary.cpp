@@ -991,6 +991,7 @@ Error ResourceFormatLoaderBinary::rename_dependencies(StringView _path, const Ha
 
         FileAccessCompressed *facw = memnew(FileAccessCompressed);
         facw->configure("RSCC");
+        facw->set_dictionary_id(fac->get_dictionary_id());
         err = facw->_open(p_path + ".depren", FileAccess::WRITE);
         if (err) {
             memdelete(fac);
@@ -1672,6 +1673,7 @@ Error ResourceFormatSaverBinaryInstance::save(StringView p_path, const RES &p_re
     if (p_flags & ResourceManager::FLAG_COMPRESS) {
         FileAccessCompressed *fac = memnew(FileAccessCompressed);
         fac->configure("RSCC");
+        fac->set_dictionary_id(FileAccessCompressed::get_type_dictionary(p_resource->get_class_name()));
         f = fac;
         err = fac->_open(p_path, FileAccess::WRITE);
         if (err)
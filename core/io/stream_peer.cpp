@@ -187,12 +187,9 @@ void StreamPeer::put_utf8_string(StringView p_string) {
 }
 void StreamPeer::put_var(const Variant &p_variant, bool p_full_objects) {
 
-    int len = 0;
     Vector<uint8_t> buf;
-    encode_variant(p_variant, nullptr, len, p_full_objects);
-    buf.resize(len);
-    put_32(len);
-    encode_variant(p_variant, buf.data(), len, p_full_objects);
+    encode_variant(p_variant, buf, p_full_objects);
+    put_32(buf.size());
     put_data(buf.data(), buf.size());
 }
 
@@ -59,6 +59,8 @@ public:
     Ref<StreamPeerTCP> take_connection();
 
     void stop(); // Stop listening
+    // Listening socket, for registration with an IOMultiplexer.
+    const Ref<NetSocket> &get_socket() const { return _sock; }
 
     TCP_Server();
     ~TCP_Server() override;
@@ -35,7 +35,7 @@
 #include "core/external_profiler.h"
 #include "core/object_db.h"
 #include "core/object.h"
-#include "core/os/mutex.h"
+#include "core/os/os.h"
 #include "core/print_string.h"
 #include "core/project_settings.h"
 #include "core/script_language.h"
@@ -45,8 +45,39 @@
 
 namespace {
 SafeNumeric<int> null_object_calls {0};
+uint64_t last_instance_id = 0;
 }
 
+struct MessageQueue::Page {
+    Page *next = nullptr;
+    uint32_t size = 0; // capacity of the data following the header
+    uint32_t used = 0;
+
+    uint8_t *data() { return reinterpret_cast<uint8_t *>(this + 1); }
+};
+
+struct MessageQueue::Producer {
+    SpinLock lock; // taken by the owning thread while pushing, and by flush() while taking the pages
+    Page *first = nullptr;
+    Page *last = nullptr;
+    uint32_t bytes = 0;
+    bool orphaned = false; // owning thread exited, freed once drained
+};
+
+// Binds the calling thread to its producer. The destructor runs on thread exit.
+struct MessageQueue::ThreadSlot {
+    uint64_t queue_id = 0;
+    Producer *producer = nullptr;
+
+    ~ThreadSlot() {
+        MessageQueue *queue = MessageQueue::singleton;
+        if (producer && queue && queue->instance_id == queue_id) {
+            SpinGuard guard(producer->lock);
+            producer->orphaned = true;
+        }
+    }
+};
+
 MessageQueue *MessageQueue::singleton = nullptr;
 
 MessageQueue *MessageQueue::get_singleton() {
@@ -54,28 +85,92 @@ MessageQueue *MessageQueue::get_singleton() {
     return singleton;
 }
 
-Error MessageQueue::push_call(GameEntity p_id, eastl::function<void()> p_method) {
+MessageQueue::Producer *MessageQueue::_get_producer() {
+
+    static thread_local ThreadSlot slot;
+    if (slot.queue_id != instance_id) {
+        MutexLock lock(producers_mutex);
+        slot.producer = memnew(Producer);
+        slot.queue_id = instance_id;
+        producers.push_back(slot.producer);
+    }
+    return slot.producer;
+}
+
+MessageQueue::Page *MessageQueue::_alloc_page(uint32_t p_min_size) {
+
+    if (p_min_size <= QUEUE_PAGE_SIZE) {
+        SpinGuard guard(pages_lock);
+        if (free_pages) {
+            Page *page = free_pages;
+            free_pages = page->next;
+            free_page_count--;
+            page->next = nullptr;
+            page->used = 0;
+            return page;
+        }
+    }
+
+    const uint32_t size = M_MAX(p_min_size, uint32_t(QUEUE_PAGE_SIZE));
+    Page *page = memnew_placement(memalloc(sizeof(Page) + size), Page);
+    page->size = size;
+    return page;
+}
 
-    _THREAD_SAFE_METHOD_;
-    constexpr size_t room_needed = sizeof(Message);
+void MessageQueue::_free_page(Page *p_page) {
 
-    if ((buffer_end + room_needed) >= buffer_size) {
-        String type;
-        auto obj = object_for_entity(p_id);
-        if (obj) {
-            type = obj->get_class();
+    if (p_page->size == QUEUE_PAGE_SIZE) {
+        SpinGuard guard(pages_lock);
+        if (free_page_count < max_free_pages) {
+            p_page->next = free_pages;
+            free_pages = p_page;
+            free_page_count++;
+            return;
+        }
+    }
+    p_page->~Page();
+    memfree(p_page);
+}
+
+// Called with the producer locked.
+uint8_t *MessageQueue::_alloc(Producer *p_producer, uint32_t p_size) {
+
+    Page *page = p_producer->last;
+    if (!page || page->used + p_size > page->size) {
+        page = _alloc_page(p_size);
+        if (p_producer->last) {
+            p_producer->last->next = page;
+        } else {
+            p_producer->first = page;
         }
-        print_line(String("Failed ::function call: ") + type + ": target ID: " + ::to_string(entt::to_integral(p_id)));
-        statistics();
-        ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
+        p_producer->last = page;
     }
-    TRACE_ALLOC_NS(&buffer[buffer_end],room_needed,STACK_DEPTH,"MessageQueueAlloc");
-    Message *msg = memnew_placement(&buffer[buffer_end], Message);
-    msg->args = 0;
-    msg->callable = Callable(memnew_args(FunctorCallable,p_id,p_method));
-    msg->type = TYPE_CALL;
 
-    buffer_end += sizeof(Message);
+    uint8_t *res = page->data() + page->used;
+    page->used += p_size;
+    p_producer->bytes += p_size;
+    TRACE_ALLOC_NS(res, p_size, STACK_DEPTH, "MessageQueueAlloc");
+    return res;
+}
+
+void MessageQueue::_destroy_message(Message *p_message) {
+
+    Variant *args = (Variant *)(p_message + 1);
+    for (int i = 0; i < p_message->args; i++) {
+        args[i].~Variant();
+    }
+    p_message->~Message();
+    TRACE_FREE_N(p_message, "MessageQueueAlloc");
+}
+
+Error MessageQueue::push_call(GameEntity p_id, eastl::function<void()> p_method) {
+
+    Producer *producer = _get_producer();
+    Callable callable(memnew_args(FunctorCallable, p_id, eastl::move(p_method)));
+
+    SpinGuard guard(producer->lock);
+    uint8_t *ptr = _alloc(producer, sizeof(Message));
+    memnew_placement(ptr, Message(callable, sequence.fetch_add(1, std::memory_order_relaxed), TYPE_CALL, 0));
     return OK;
 }
 Error MessageQueue::push_call(GameEntity p_id, const StringName &p_method, const Variant **p_args, int p_argcount, bool p_show_error) {
@@ -100,32 +195,21 @@ Error MessageQueue::push_call(GameEntity p_id, const StringName &p_method, VARIA
 }
 
 Error MessageQueue::push_callable(const Callable& p_callable, const Variant** p_args, int p_argcount, bool p_show_error) {
-    _THREAD_SAFE_METHOD_;
 
-    int room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
-
-    if ((buffer_end + room_needed) >= buffer_size) {
-        print_line("Failed method: " + (String)p_callable);
-        statistics();
-        ERR_FAIL_V_MSG(ERR_OUT_OF_MEMORY, "Message queue out of memory. Try increasing 'memory/limits/message_queue/max_size_kb' in project settings.");
-    }
-
-    TRACE_ALLOC_NS(&buffer[buffer_end],room_needed,STACK_DEPTH,"MessageQueueAlloc");
-
-    Message* msg = memnew_placement(&buffer[buffer_end], Message);
-    msg->args = p_argcount;
-    msg->callable = p_callable;
-    msg->type = TYPE_CALL;
+    Producer *producer = _get_producer();
+    const uint32_t room_needed = sizeof(Message) + sizeof(Variant) * p_argcount;
+    int16_t type = TYPE_CALL;
     if (p_show_error) {
-        msg->type |= FLAG_SHOW_ERROR;
+        type |= FLAG_SHOW_ERROR;
     }
 
-    buffer_end += sizeof(Message);
-
+    SpinGuard guard(producer->lock);
+    uint8_t *ptr = _alloc(producer, room_needed);
+    // Constructed in place, the arguments are copied once straight into the buffer.
+    memnew_placement(ptr, Message(p_callable, sequence.fetch_add(1, std::memory_order_relaxed), type, p_argcount));
+    Variant *args = (Variant *)(ptr + sizeof(Message));
     for (int i = 0; i < p_argcount; i++) {
-        Variant* v = memnew_placement(&buffer[buffer_end], Variant);
-        buffer_end += sizeof(Variant);
-        *v = *p_args[i];
+        memnew_placement(&args[i], Variant(*p_args[i]));
     }
 
     return OK;
@@ -149,33 +233,42 @@ void MessageQueue::statistics() const {
     HashMap<Callable, int> call_count;
     int func_count = 0;
     int null_count = 0;
+    uint32_t total_bytes = 0;
 
-    uint32_t read_pos = 0;
-    while (read_pos < buffer_end) {
-        Message *message = (Message *)&buffer[read_pos];
+    MutexLock lock(producers_mutex);
+    for (Producer *producer : producers) {
+        SpinGuard guard(producer->lock);
+        total_bytes += producer->bytes;
+        for (Page *page = producer->first; page; page = page->next) {
+            uint32_t read_pos = 0;
+            while (read_pos < page->used) {
+                Message *message = (Message *)&page->data()[read_pos];
 
-        Object *target = object_for_entity(message->callable.get_object_id());
+                Object *target = object_for_entity(message->callable.get_object_id());
 
-        if (target != nullptr) {
+                if (target != nullptr) {
 
-            switch (message->type & FLAG_MASK) {
-                case TYPE_CALL: {
-                    call_count[message->callable]++;
-                } break;
-            }
+                    switch (message->type & FLAG_MASK) {
+                        case TYPE_CALL: {
+                            call_count[message->callable]++;
+                        } break;
+                    }
 
-        } else {
-            //object was deleted
-            print_line("Object was deleted while awaiting a callback");
+                } else {
+                    //object was deleted
+                    print_line("Object was deleted while awaiting a callback");
 
-            null_count++;
-        }
+                    null_count++;
+                }
 
-        read_pos += sizeof(Message);
-        read_pos += sizeof(Variant) * message->args;
+                read_pos += sizeof(Message);
+                read_pos += sizeof(Variant) * message->args;
+            }
+        }
     }
 
-    print_line("TOTAL BYTES: " + itos(buffer_end));
+    print_line("TOTAL BYTES: " + itos(total_bytes));
+    print_line("PRODUCERS: " + itos(producers.size()));
     print_line("NULL count: " + itos(null_count+null_object_calls.get()));
     print_line("FUNC count: " + itos(func_count));
 
@@ -208,73 +301,106 @@ void MessageQueue::_call_function(const Callable& p_callable, const Variant* p_a
 
 void MessageQueue::flush()
 {
-    if (buffer_end > buffer_max_used)
-    {
-        buffer_max_used = buffer_end;
-    }
+    // Read position in the pages taken from one producer.
+    struct Cursor {
+        Page *page;
+        uint32_t read_pos;
+    };
 
-    uint32_t read_pos = 0;
-
-    //using reverse locking strategy
-    _THREAD_SAFE_LOCK_
-
-    if (flushing)
     {
-        _THREAD_SAFE_UNLOCK_
+        MutexLock lock(producers_mutex);
         ERR_FAIL_COND(flushing); //already flushing, you did something odd
+        flushing = true;
     }
-    flushing = true;
-
-    while (read_pos < buffer_end)
-    {
-        //lock on each iteration, so a call can re-add itself to the message queue
-        TRACE_FREE_N(&buffer[read_pos],"MessageQueueAlloc");
 
-        Message *message = (Message*)&buffer[read_pos];
+    const uint64_t start = OS::get_singleton()->get_ticks_usec();
+    uint32_t flushed = 0;
+    Vector<Cursor> cursors;
 
-        uint32_t advance = sizeof(Message);
-        advance += sizeof(Variant) * message->args;
-
-        //pre-advance so this function is reentrant
-        read_pos += advance;
+    // Calls can push more messages, from this thread or others, so keep taking rounds until nothing is left.
+    while (true) {
+        uint32_t pending = 0;
+        {
+            MutexLock lock(producers_mutex);
+            for (size_t i = 0; i < producers.size(); i++) {
+                Producer *producer = producers[i];
+                producer->lock.lock();
+                if (producer->first) {
+                    cursors.push_back({ producer->first, 0 });
+                    pending += producer->bytes;
+                    producer->first = producer->last = nullptr;
+                    producer->bytes = 0;
+                } else if (producer->orphaned) {
+                    producer->lock.unlock();
+                    memdelete(producer);
+                    producers.erase_at(i--);
+                    continue;
+                }
+                producer->lock.unlock();
+            }
+        }
+        if (cursors.empty()) {
+            break;
+        }
+        buffer_max_used = M_MAX(buffer_max_used, pending);
+
+        // Merge this round back into push order, one producer is by far the common case. Producers are taken one at
+        // a time, so the order across threads holds within a round, not between rounds.
+        while (!cursors.empty()) {
+            size_t next = 0;
+            for (size_t i = 1; i < cursors.size(); i++) {
+                const Message *a = (const Message *)&cursors[i].page->data()[cursors[i].read_pos];
+                const Message *b = (const Message *)&cursors[next].page->data()[cursors[next].read_pos];
+                if (a->sequence < b->sequence) {
+                    next = i;
+                }
+            }
 
-        _THREAD_SAFE_UNLOCK_
+            Cursor &cursor = cursors[next];
+            Page *page = cursor.page;
+            Message *message = (Message *)&page->data()[cursor.read_pos];
+            cursor.read_pos += sizeof(Message) + sizeof(Variant) * message->args;
+            const bool page_done = cursor.read_pos >= page->used;
+            if (page_done) {
+                if (page->next) {
+                    cursor.page = page->next;
+                    cursor.read_pos = 0;
+                } else {
+                    cursors.erase_at(next);
+                }
+            }
 
-        Object *target = message->callable.get_object();
+            Object *target = message->callable.get_object();
 
-        if (target != nullptr)
-        {
-            switch (message->type & FLAG_MASK)
-            {
-            case TYPE_CALL:
-                {
-                    Variant *args = (Variant*)(message + 1);
+            if (target != nullptr) {
+                switch (message->type & FLAG_MASK) {
+                    case TYPE_CALL: {
+                        Variant *args = (Variant *)(message + 1);
 
-                    // messages don't expect a return value
+                        // messages don't expect a return value
 
-                    _call_function(message->callable, args, message->args, message->type & FLAG_SHOW_ERROR);
+                        _call_function(message->callable, args, message->args, message->type & FLAG_SHOW_ERROR);
+                    } break;
                 }
-                break;
+            } else {
+                null_object_calls.increment();
             }
-        }
-
-        else {
-            null_object_calls.increment();
-        }
-        Variant *args = (Variant*)(message + 1);
-        for (int i = 0; i < message->args; i++)
-        {
-            args[i].~Variant();
-        }
 
-        message->~Message();
+            _destroy_message(message);
+            flushed++;
 
-        _THREAD_SAFE_LOCK_
+            if (page_done) {
+                _free_page(page);
+            }
+        }
     }
 
-    buffer_end = 0; // reset buffer
+    last_flush_usec = OS::get_singleton()->get_ticks_usec() - start;
+    max_flush_usec = M_MAX(max_flush_usec, last_flush_usec);
+    last_flush_count = flushed;
+
+    MutexLock lock(producers_mutex);
     flushing = false;
-    _THREAD_SAFE_UNLOCK_
 }
 
 bool MessageQueue::is_flushing() const {
@@ -285,33 +411,42 @@ bool MessageQueue::is_flushing() const {
 MessageQueue::MessageQueue() {
     ERR_FAIL_COND_MSG(singleton != nullptr, "A MessageQueue singleton already exists.");
     singleton = this;
+    instance_id = ++last_instance_id;
     StringName prop_name("memory/limits/message_queue/max_size_kb");
-    buffer_size = GLOBAL_DEF_T_RST(prop_name, DEFAULT_QUEUE_SIZE_KB,uint32_t);
+    // The queue grows as needed, this is how much of it is kept around between flushes.
+    uint32_t buffer_size = GLOBAL_DEF_T_RST(prop_name, DEFAULT_QUEUE_SIZE_KB,uint32_t);
     ProjectSettings::get_singleton()->set_custom_property_info(
             prop_name, PropertyInfo(VariantType::INT, "memory/limits/message_queue/max_size_kb", PropertyHint::Range,
                                "1024,4096,1,or_greater"));
-    buffer_size *= 1024;
-    buffer = memnew_arr(uint8_t, buffer_size);
+    max_free_pages = M_MAX(buffer_size * 1024 / QUEUE_PAGE_SIZE, 1u);
 }
 
 MessageQueue::~MessageQueue() {
 
-    uint32_t read_pos = 0;
-
-    while (read_pos < buffer_end) {
-
-        Message *message = (Message *)&buffer[read_pos];
-        Variant *args = (Variant *)(message + 1);
-        int argc = message->args;
-        for (int i = 0; i < argc; i++)
-            args[i].~Variant();
-        message->~Message();
-        TRACE_FREE_N(message,"MessageQueueAlloc");
+    for (Producer *producer : producers) {
+        Page *page = producer->first;
+        while (page) {
+            uint32_t read_pos = 0;
+            while (read_pos < page->used) {
+                Message *message = (Message *)&page->data()[read_pos];
+                read_pos += sizeof(Message) + sizeof(Variant) * message->args;
+                _destroy_message(message);
+            }
+            Page *next = page->next;
+            page->~Page();
+            memfree(page);
+            page = next;
+        }
+        memdelete(producer);
+    }
+    producers.clear();
 
-        read_pos += sizeof(Message);
-        read_pos += sizeof(Variant) * message->args;
+    while (free_pages) {
+        Page *next = free_pages->next;
+        free_pages->~Page();
+        memfree(free_pages);
+        free_pages = next;
     }
 
     singleton = nullptr;
-    memdelete_arr(buffer);
 }
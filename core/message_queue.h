@@ -31,15 +31,19 @@
 #pragma once
 
 #include "core/object.h"
-#include "core/os/thread_safe.h"
+#include "core/os/mutex.h"
 
+// Deferred calls. Every thread that pushes gets its own chunked buffer, so producers only contend with flush(),
+// never with each other. Calls pushed from one thread always run in push order. flush() takes the buffers in
+// rounds and merges each round by a global sequence number, so calls from different threads only keep their
+// relative order when the same round takes them: a thread pushing while a round is being taken may land in the
+// next round behind calls that were pushed after it.
 class GODOT_EXPORT MessageQueue
 {
-    _THREAD_SAFE_CLASS_
-
     enum
     {
-        DEFAULT_QUEUE_SIZE_KB = 4096
+        DEFAULT_QUEUE_SIZE_KB = 4096,
+        QUEUE_PAGE_SIZE = 65536
     };
 
     enum
@@ -52,15 +56,38 @@ class GODOT_EXPORT MessageQueue
     struct Message
     {
         Callable callable;
+        uint64_t sequence;
         int16_t type;
         int16_t args;
+
+        Message(const Callable &p_callable, uint64_t p_sequence, int16_t p_type, int16_t p_args) :
+                callable(p_callable), sequence(p_sequence), type(p_type), args(p_args) {}
     };
 
-    uint8_t *buffer;
-    uint32_t buffer_end = 0;
-    uint32_t buffer_max_used = 0;
-    uint32_t buffer_size;
+    struct Page;
+    struct Producer;
+    struct ThreadSlot;
+    friend struct ThreadSlot;
 
+    Vector<Producer *> producers;
+    mutable Mutex producers_mutex;
+    Page *free_pages = nullptr;
+    uint32_t free_page_count = 0;
+    uint32_t max_free_pages;
+    SpinLock pages_lock;
+    std::atomic<uint64_t> sequence {0};
+    uint64_t instance_id;
+
+    uint32_t buffer_max_used = 0;
+    uint64_t last_flush_usec = 0;
+    uint64_t max_flush_usec = 0;
+    uint32_t last_flush_count = 0;
+
+    Producer *_get_producer();
+    uint8_t *_alloc(Producer *p_producer, uint32_t p_size);
+    Page *_alloc_page(uint32_t p_min_size);
+    void _free_page(Page *p_page);
+    static void _destroy_message(Message *p_message);
     void _call_function(const Callable &p_callable, const Variant *p_args, int p_argcount, bool p_show_error);
 
     static MessageQueue *singleton;
@@ -83,7 +110,11 @@ public:
 
     bool is_flushing() const;
 
+    // High-water mark of bytes waiting for a single flush.
     int get_max_buffer_usage() const;
+    uint64_t get_last_flush_usec() const { return last_flush_usec; }
+    uint64_t get_max_flush_usec() const { return max_flush_usec; }
+    uint32_t get_last_flush_message_count() const { return last_flush_count; }
 
     MessageQueue();
     ~MessageQueue();
@@ -0,0 +1,102 @@
+/*************************************************************************/
+/*  reader_epoch.h                                                       */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lets lock-free readers announce themselves, so that a writer knows when what it unlinked can't be reached any more
+// and can be freed. Readers are counted under the parity of the epoch they started in, in one of a few slots picked
+// per thread. Slots are cache-line sized to keep the reader threads from bouncing a single shared counter.
+//
+// A writer unlinks, ends the epoch with advance() and frees what it unlinked before that once previous_done() says
+// every reader counted under the previous epoch is gone. Readers counted under the current one started after the
+// unlinking and can't reach those items, so they don't hold them back.
+class ReaderEpoch {
+    enum {
+        SLOT_COUNT = 32
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<uint32_t> active[2] {};
+    };
+
+    Slot slots[SLOT_COUNT];
+    std::atomic<uint32_t> epoch { 0 };
+
+    static uint32_t _thread_slot() {
+        static std::atomic<uint32_t> next_slot { 0 };
+        static thread_local uint32_t slot = next_slot.fetch_add(1, std::memory_order_relaxed) % SLOT_COUNT;
+        return slot;
+    }
+
+public:
+    class Scope {
+        std::atomic<uint32_t> *active;
+
+    public:
+        explicit Scope(ReaderEpoch &p_readers) {
+            Slot &slot = p_readers.slots[_thread_slot()];
+            uint32_t epoch = p_readers.epoch.load();
+            while (true) {
+                active = &slot.active[epoch & 1];
+                active->fetch_add(1, std::memory_order_seq_cst);
+                // Counted under an epoch that already ended, writers may have stopped waiting for it.
+                const uint32_t current = p_readers.epoch.load();
+                if (current == epoch) {
+                    break;
+                }
+                active->fetch_sub(1, std::memory_order_release);
+                epoch = current;
+            }
+        }
+        ~Scope() {
+            active->fetch_sub(1, std::memory_order_release);
+        }
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+    // New readers count under the other parity from now on.
+    void advance() {
+        epoch.fetch_add(1);
+    }
+
+    bool previous_done() const {
+        const uint32_t previous = (epoch.load() - 1) & 1;
+        for (const Slot &slot : slots) {
+            if (slot.active[previous].load() != 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
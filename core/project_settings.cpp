@@ -33,6 +33,7 @@
 #include "core/bind/core_bind.h"
 #include "core/core_string_names.h"
 #include "core/input/input_event.h"
+#include "core/io/file_access_compressed.h"
 #include "core/io/file_access_network.h"
 #include "core/io/file_access_pack.h"
 #include "core/io/marshalls.h"
@@ -1268,6 +1269,14 @@ ProjectSettings::ProjectSettings() {
     custom_prop_info[StaticCString("compression/formats/gzip/compression_level")] =
             PropertyInfo(VariantType::INT, "compression/formats/gzip/compression_level", PropertyHint::Range, "-1,9,1");
 
+    FileAccessCompressed::default_block_size = T_GLOBAL_DEF<int>("compression/formats/compressed_file/block_size", 65536);
+    custom_prop_info[StaticCString("compression/formats/compressed_file/block_size")] =
+            PropertyInfo(VariantType::INT, "compression/formats/compressed_file/block_size", PropertyHint::Range, "4096,4194304,4096");
+    FileAccessCompressed::readahead_blocks = T_GLOBAL_DEF<int>("compression/formats/compressed_file/readahead_blocks", 4);
+    custom_prop_info[StaticCString("compression/formats/compressed_file/readahead_blocks")] =
+            PropertyInfo(VariantType::INT, "compression/formats/compressed_file/readahead_blocks", PropertyHint::Range, "0,64,1");
+    FileAccessCompressed::dictionary_path = T_GLOBAL_DEF<String>("compression/formats/compressed_file/dictionary_path", "res://.import/dictionaries");
+
     using_datapack = false;
 }
 
@@ -40,7 +40,9 @@
 //#include "core/func_ref.h"
 #include "core/image.h"
 #include "core/input/input_map.h"
+#include "core/io/compression.h"
 #include "core/io/config_file.h"
+#include "core/io/file_access_compressed.h"
 #include "core/io/http_client.h"
 #include "core/io/image_loader.h"
 #include "core/io/marshalls.h"
@@ -310,6 +312,9 @@ void unregister_core_types() {
 
     memdelete(_ip);
 
+    FileAccessCompressed::finish_readahead_pool();
+    Compression::free_zstd_dictionaries();
+
     gResourceManager().finalize();
     memdelete(_codec_store);
 
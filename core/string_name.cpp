@@ -32,16 +32,18 @@
 
 #include "core/os/os.h"
 #include "core/os/mutex.h"
+#include "core/os/reader_epoch.h"
 #include "core/print_string.h"
 #include "core/ustring.h"
 #include "core/vector.h"
 #include "core/string_utils.inl"
 
+#include <atomic>
+
 const Vector<StringName> g_null_stringname_vec; //!< Can be used wherever user needs to return/pass a const Vector<StringName> reference.
 
 namespace
 {
-static Mutex lock;
 
 template <typename L, typename R>
 _FORCE_INLINE_ bool is_str_less(const L *l_ptr, const R *r_ptr) {
@@ -61,21 +63,29 @@ _FORCE_INLINE_ bool is_str_less(const L *l_ptr, const R *r_ptr) {
         r_ptr++;
     }
 }
+
+enum {
+    INITIAL_TABLE_BITS = 12,
+};
+
+// Lock-free readers of the intern table, see StringName::_Table::reclaim().
+ReaderEpoch s_readers;
+
 } // end of anonymous namespace
 
 struct StringName::_Data {
-    _Data *prev = nullptr;
-    _Data *next = nullptr;
+    std::atomic<_Data *> next { nullptr };
+    //! Links entries that were unlinked from the table but may still be visible to in-flight readers.
+    _Data *retired_next = nullptr;
     const char *cname = nullptr;
     SafeRefCount refcount;
-    uint32_t idx:31;
-    //! if set to 1 then underlying char * array was allocated dynamically.
-    uint32_t mark:1;
-    uint32_t hash=0;
+    uint32_t hash = 0;
+    //! if set then underlying char * array was allocated dynamically.
+    bool mark = false;
 
     const char *get_name() const { return cname; }
     void set_static_name(const char *s) {
-        mark = 0;
+        mark = false;
         cname = s;
     }
     void set_dynamic_name(StringView s) {
@@ -84,11 +94,7 @@ struct StringName::_Data {
         memcpy(data,s.data(),s.size());
         data[s.size()]=0;
         cname =data;
-        mark = 1;
-    }
-    _Data() {
-        idx = 0;
-        hash = 0;
+        mark = true;
     }
     ~_Data() {
        if(mark)  // dynamic memory
@@ -99,42 +105,245 @@ struct StringName::_Data {
     }
 };
 
-StringName::_Data *StringName::_table[STRING_TABLE_LEN];
+/**
+ * Intern table for StringName entries.
+ *
+ * Lookups of existing names walk the bucket chains without taking any lock, and copying or releasing a StringName
+ * only touches the entry's reference count. The write lock is taken only to insert a new name, to unlink an entry
+ * whose last reference was released and to grow the bucket array, which doubles whenever the entry count exceeds
+ * the bucket count.
+ * Unlinked entries and outgrown bucket arrays are retired instead of freed, and released once every lock-free reader
+ * that started before they were unlinked is done.
+ */
+struct StringName::_Table {
+    struct Buckets {
+        uint32_t mask;
+        std::atomic<_Data *> *heads;
+        Buckets *retired_next = nullptr;
+
+        explicit Buckets(uint32_t p_count) : mask(p_count - 1) {
+            heads = memnew_arr(std::atomic<_Data *>, mask + 1);
+            for (uint32_t i = 0; i <= mask; ++i) {
+                heads[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+        ~Buckets() {
+            memdelete_arr(heads);
+        }
+    };
+
+    static std::atomic<Buckets *> buckets;
+    //! Incremented before and after every bucket array growth, odd while entries are being moved.
+    static std::atomic<uint32_t> resize_sequence;
+    static BinaryMutex write_lock;
+    // Members below are only accessed with write_lock held.
+    static uint32_t entry_count;
+    // Retired during the current epoch.
+    static _Data *retired_entries;
+    static Buckets *retired_buckets;
+    // Retired during the previous epoch, waiting for the readers counted under it.
+    static _Data *waiting_entries;
+    static Buckets *waiting_buckets;
+
+    template <class Matcher>
+    static _Data *acquire_in(const Buckets *p_buckets, uint32_t p_hash, Matcher p_matches) {
+        for (_Data *d = p_buckets->heads[p_hash & p_buckets->mask].load(); d; d = d->next.load()) {
+            // compare hash first, entries whose refcount already dropped to zero are being removed.
+            if (d->hash == p_hash && p_matches(d->get_name()) && d->refcount.ref()) {
+                return d;
+            }
+        }
+        return nullptr;
+    }
+
+    /**
+     * Lock-free lookup, returns a referenced entry or nullptr.
+     * A miss is only authoritative if p_sequence did not change, since entries are moved between chains while the
+     * bucket array grows.
+     */
+    template <class Matcher>
+    static _Data *try_acquire(uint32_t p_hash, Matcher p_matches, uint32_t &r_sequence) {
+        ReaderEpoch::Scope scope(s_readers);
+        r_sequence = resize_sequence.load();
+        return acquire_in(buckets.load(), p_hash, p_matches);
+    }
+
+    template <class Matcher>
+    static _Data *acquire(uint32_t p_hash, Matcher p_matches) {
+        uint32_t sequence;
+        _Data *d = try_acquire(p_hash, p_matches, sequence);
+        if (d || ((sequence & 1) == 0 && sequence == resize_sequence.load())) {
+            return d;
+        }
+        std::lock_guard<BinaryMutex> guard(write_lock);
+        return acquire_in(buckets.load(), p_hash, p_matches);
+    }
+
+    template <class Matcher, class Init>
+    static _Data *intern(uint32_t p_hash, Matcher p_matches, Init p_init) {
+        uint32_t sequence;
+        _Data *d = try_acquire(p_hash, p_matches, sequence);
+        if (d) {
+            return d;
+        }
+
+        std::lock_guard<BinaryMutex> guard(write_lock);
+        Buckets *b = buckets.load();
+        // another thread might have inserted it since the lock-free lookup.
+        d = acquire_in(b, p_hash, p_matches);
+        if (d) {
+            return d;
+        }
+
+        d = memnew(_Data);
+        p_init(d);
+        d->refcount.init();
+        d->hash = p_hash;
+        std::atomic<_Data *> &head = b->heads[p_hash & b->mask];
+        d->next.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        head.store(d);
+
+        if (++entry_count > b->mask) {
+            grow(b);
+        }
+        return d;
+    }
+
+    static void release(_Data *p_data) {
+        std::lock_guard<BinaryMutex> guard(write_lock);
+        Buckets *b = buckets.load();
+
+        std::atomic<_Data *> *link = &b->heads[p_data->hash & b->mask];
+        _Data *d = link->load();
+        while (d && d != p_data) {
+            link = &d->next;
+            d = link->load();
+        }
+        if (!d) {
+            ERR_PRINT("BUG!");
+            return;
+        }
+        // p_data->next is left intact, readers currently standing on p_data can still finish their walk.
+        link->store(p_data->next.load());
+        --entry_count;
+
+        p_data->retired_next = retired_entries;
+        retired_entries = p_data;
+        reclaim();
+    }
+
+    static void grow(Buckets *p_old) {
+        Buckets *grown = memnew(Buckets((p_old->mask + 1) * 2));
+
+        resize_sequence.fetch_add(1);
+        for (uint32_t i = 0; i <= p_old->mask; ++i) {
+            _Data *d = p_old->heads[i].load();
+            while (d) {
+                _Data *next = d->next.load();
+                std::atomic<_Data *> &head = grown->heads[d->hash & grown->mask];
+                d->next.store(head.load(std::memory_order_relaxed));
+                head.store(d);
+                d = next;
+            }
+        }
+        buckets.store(grown);
+        resize_sequence.fetch_add(1);
+
+        p_old->retired_next = retired_buckets;
+        retired_buckets = p_old;
+        reclaim();
+    }
+
+    static void reclaim() {
+        if (waiting_entries || waiting_buckets) {
+            if (!s_readers.previous_done()) {
+                return;
+            }
+            free_list(waiting_entries, waiting_buckets);
+        }
+        if (!retired_entries && !retired_buckets) {
+            return;
+        }
+        // Ending the epoch makes new readers count under the other parity, only the ones already in flight delay
+        // freeing what was retired so far.
+        waiting_entries = retired_entries;
+        waiting_buckets = retired_buckets;
+        retired_entries = nullptr;
+        retired_buckets = nullptr;
+        s_readers.advance();
+        if (s_readers.previous_done()) {
+            free_list(waiting_entries, waiting_buckets);
+        }
+    }
+
+    static void free_list(_Data *&r_entries, Buckets *&r_buckets) {
+        while (r_entries) {
+            _Data *d = r_entries;
+            r_entries = d->retired_next;
+            memdelete(d);
+        }
+        while (r_buckets) {
+            Buckets *b = r_buckets;
+            r_buckets = b->retired_next;
+            memdelete(b);
+        }
+    }
+
+    static void free_retired() {
+        free_list(waiting_entries, waiting_buckets);
+        free_list(retired_entries, retired_buckets);
+    }
+};
+
+std::atomic<StringName::_Table::Buckets *> StringName::_Table::buckets { nullptr };
+std::atomic<uint32_t> StringName::_Table::resize_sequence { 0 };
+BinaryMutex StringName::_Table::write_lock;
+uint32_t StringName::_Table::entry_count = 0;
+StringName::_Data *StringName::_Table::retired_entries = nullptr;
+StringName::_Table::Buckets *StringName::_Table::retired_buckets = nullptr;
+StringName::_Data *StringName::_Table::waiting_entries = nullptr;
+StringName::_Table::Buckets *StringName::_Table::waiting_buckets = nullptr;
+
 bool StringName::configured = false;
 
 
 void StringName::setup() {
 
     ERR_FAIL_COND(configured);
-    for (auto &entry : _table) {
-        entry = nullptr;
-    }
+    _Table::buckets.store(memnew(_Table::Buckets(1U << INITIAL_TABLE_BITS)));
+    _Table::entry_count = 0;
     configured = true;
 }
 
 void StringName::cleanup(bool log_orphans) {
 
     { // this block is done under lock, exiting the block will release the block automatically.
-        MutexLock mlocker(lock);
+        std::lock_guard<BinaryMutex> guard(_Table::write_lock);
 
+        _Table::Buckets *b = _Table::buckets.load();
         int lost_strings = 0;
-        for (auto &entry : _table) {
+        for (uint32_t i = 0; i <= b->mask; ++i) {
 
-            while (entry) {
+            _Data *d = b->heads[i].load();
+            while (d) {
 
-                _Data *d = entry;
                 lost_strings++;
                 if (log_orphans) {
                     print_line(String("Orphan StringName: ") + d->get_name());
                 }
 
-                entry = entry->next;
+                _Data *next = d->next.load();
                 memdelete(d);
+                d = next;
             }
         }
         if (lost_strings) {
             print_verbose("StringName: " + itos(lost_strings) + " unclaimed string names at exit.");
         }
+        _Table::free_retired();
+        memdelete(b);
+        _Table::buckets.store(nullptr);
+        _Table::entry_count = 0;
     }
 
     configured = false;
@@ -145,21 +354,7 @@ void StringName::unref() noexcept {
     ERR_FAIL_COND(!configured);
     assert(_data);
     if (_data->refcount.unref()) {
-        MutexLock mlocker(lock);
-
-        if (_data->prev) {
-            _data->prev->next = _data->next;
-        } else {
-            if (_table[_data->idx] != _data) {
-                ERR_PRINT("BUG!");
-            }
-            _table[_data->idx] = _data->next;
-        }
-
-        if (_data->next) {
-            _data->next->prev = _data->prev;
-        }
-        memdelete(_data);
+        _Table::release(_data);
     }
 
     _data = nullptr;
@@ -226,37 +421,9 @@ void StringName::setupFromCString(StaticCString p_static_string) {
 
 void StringName::setupFromCString(const char *ptr, uint32_t hash) {
 
-    const uint32_t idx = hash & STRING_TABLE_MASK;
-    MutexLock mlocker(lock);
-    _data = _table[idx];
-
-    while (_data) {
-
-        // compare hash first
-        if (_data->hash == hash && 0==strcmp(_data->get_name(),ptr))
-            break;
-        _data = _data->next;
-    }
-
-    if (_data) {
-        if (_data->refcount.ref()) {
-            // exists
-            return;
-        }
-    }
-
-    _data = memnew(_Data);
-
-    _data->refcount.init();
-    _data->set_static_name(ptr);
-    _data->idx = idx;
-    _data->hash = hash;
-    _data->next = _table[idx];
-    _data->prev = nullptr;
-    if (_table[idx])
-        _table[idx]->prev = _data;
-    _table[idx] = _data;
-
+    _data = _Table::intern(hash,
+            [ptr](const char *name) { return 0 == strcmp(name, ptr); },
+            [ptr](_Data *d) { d->set_static_name(ptr); });
 }
 
 StringName::StringName(StringView p_name) {
@@ -269,37 +436,10 @@ StringName::StringName(StringView p_name) {
         return;
 
     const uint32_t hash = StringUtils::hash(p_name);
-    const uint32_t idx = hash & STRING_TABLE_MASK;
-
-    MutexLock mlocker(lock);
-
-    _data = _table[idx];
-
-    while (_data) {
-
-        if (_data->hash == hash && p_name == StringView(_data->get_name()))
-            break;
-        _data = _data->next;
-    }
-
-    if (_data) {
-        if (_data->refcount.ref()) {
-            // exists
-            return;
-        }
-    }
-
-    _data = memnew(_Data);
-    _data->set_dynamic_name(p_name);
-    _data->refcount.init();
-    _data->hash = hash;
-    _data->idx = idx;
-    _data->next = _table[idx];
-    _data->prev = nullptr;
-    if (_table[idx])
-        _table[idx]->prev = _data;
-    _table[idx] = _data;
 
+    _data = _Table::intern(hash,
+            [p_name](const char *name) { return p_name == StringView(name); },
+            [p_name](_Data *d) { d->set_dynamic_name(p_name); });
 }
 
 
@@ -311,23 +451,11 @@ StringName StringName::search(const char *p_name) {
     if (!p_name[0])
         return StringName();
 
-    MutexLock mlocker(lock);
-
     uint32_t hash = StringUtils::hash(p_name);
 
-    uint32_t idx = hash & STRING_TABLE_MASK;
+    _Data *_data = _Table::acquire(hash, [p_name](const char *name) { return 0 == strcmp(name, p_name); });
 
-    _Data *_data = _table[idx];
-
-    while (_data) {
-
-        // compare hash first
-        if (_data->hash == hash && 0==strcmp(_data->get_name(),p_name))
-            break;
-        _data = _data->next;
-    }
-
-    if (_data && _data->refcount.ref()) {
+    if (_data) {
         return StringName(_data);
     }
 
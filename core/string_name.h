@@ -54,16 +54,9 @@ struct StaticCString {
 
 class GODOT_EXPORT StringName {
 
-    enum {
-
-        STRING_TABLE_BITS = 12,
-        STRING_TABLE_LEN = 1 << STRING_TABLE_BITS,
-        STRING_TABLE_MASK = STRING_TABLE_LEN - 1
-    };
-
     struct _Data;
+    struct _Table;
 
-    GODOT_NO_EXPORT static _Data *_table[STRING_TABLE_LEN];
     GODOT_NO_EXPORT static void setup();
     GODOT_NO_EXPORT static void cleanup(bool log_orphans);
     static bool configured;
@@ -0,0 +1,359 @@
+/*************************************************************************/
+/*  trace_profiler.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "trace_profiler.h"
+
+#include "core/os/file_access.h"
+#include "core/os/mutex.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/print_string.h"
+#include "core/string_formatter.h"
+#include "core/string_utils.h"
+#include "core/vector.h"
+
+#include <chrono>
+
+struct TraceProfiler::ThreadBuffer {
+    SpinLock lock;
+    Event *events;
+    uint32_t head = 0; // next slot to write
+    uint32_t count = 0;
+    int thread_index;
+    bool main_thread;
+    Vector<eastl::pair<const char *, uint64_t>> open_frames;
+
+    ThreadBuffer(int p_index, bool p_main) :
+            events(memnew_arr(Event, EVENTS_PER_THREAD)),
+            thread_index(p_index),
+            main_thread(p_main) {}
+    ~ThreadBuffer() { memdelete_arr(events); }
+};
+
+struct TraceProfiler::ThreadSlot {
+    uint64_t generation = 0;
+    ThreadBuffer *buffer = nullptr;
+};
+
+struct TraceProfiler::State {
+    Mutex mutex;
+    Vector<ThreadBuffer *> buffers;
+    // Bumped by cleanup(), so threads re-register instead of writing into freed buffers.
+    std::atomic<uint64_t> generation { 1 };
+    String output_path = "trace.json";
+    int frames_left = 0;
+    uint64_t spike_threshold_usec = 0;
+    bool in_spike = false;
+    int spike_dumps = 0;
+};
+
+namespace {
+
+// The macros stringize their argument, so names given as string literals still carry the quotes.
+StringView event_name(const char *p_name) {
+    StringView name(p_name);
+    if (name.size() >= 2 && name.front() == '"' && name.back() == '"') {
+        name = name.substr(1, name.size() - 2);
+    }
+    return name;
+}
+
+} // namespace
+
+std::atomic<bool> TraceProfiler::recording { false };
+
+TraceProfiler::State &TraceProfiler::_get_state() {
+
+    static State s;
+    return s;
+}
+
+TraceProfiler::ThreadBuffer *TraceProfiler::_get_thread_buffer() {
+
+    static thread_local ThreadSlot slot;
+    State &s = _get_state();
+    if (slot.generation != s.generation.load(std::memory_order_acquire)) {
+        // Buffers outlive their threads, a thread pool worker that exits still shows up in the next export.
+        MutexLock lock(s.mutex);
+        slot.buffer = memnew(ThreadBuffer(s.buffers.size(), Thread::get_caller_id() == Thread::get_main_id()));
+        slot.generation = s.generation.load(std::memory_order_relaxed);
+        s.buffers.push_back(slot.buffer);
+    }
+    return slot.buffer;
+}
+
+void TraceProfiler::_push_event(const Event &p_event) {
+
+    ThreadBuffer *buffer = _get_thread_buffer();
+    SpinGuard guard(buffer->lock);
+    buffer->events[buffer->head] = p_event;
+    buffer->head = (buffer->head + 1) % EVENTS_PER_THREAD;
+    if (buffer->count < EVENTS_PER_THREAD) {
+        buffer->count++;
+    }
+}
+
+uint64_t TraceProfiler::get_ticks_usec() {
+
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+void TraceProfiler::record_scope(const char *p_name, uint64_t p_start_usec, uint64_t p_end_usec) {
+
+    if (!is_recording()) {
+        return;
+    }
+    _push_event({ p_name, p_start_usec, p_end_usec - p_start_usec, 0.0, EVENT_SCOPE });
+}
+
+void TraceProfiler::record_value(const char *p_name, double p_value) {
+
+    if (!is_recording()) {
+        return;
+    }
+    _push_event({ p_name, get_ticks_usec(), 0, p_value, EVENT_COUNTER });
+}
+
+void TraceProfiler::frame_start(const char *p_name) {
+
+    if (!is_recording()) {
+        return;
+    }
+    ThreadBuffer *buffer = _get_thread_buffer();
+    SpinGuard guard(buffer->lock);
+    for (auto &open : buffer->open_frames) {
+        if (open.first == p_name) {
+            open.second = get_ticks_usec();
+            return;
+        }
+    }
+    buffer->open_frames.emplace_back(p_name, get_ticks_usec());
+}
+
+void TraceProfiler::frame_end(const char *p_name) {
+
+    if (!is_recording()) {
+        return;
+    }
+    ThreadBuffer *buffer = _get_thread_buffer();
+    uint64_t start_usec = 0;
+    {
+        SpinGuard guard(buffer->lock);
+        for (size_t i = 0; i < buffer->open_frames.size(); i++) {
+            if (buffer->open_frames[i].first == p_name) {
+                start_usec = buffer->open_frames[i].second;
+                buffer->open_frames.erase_unsorted(buffer->open_frames.begin() + i);
+                break;
+            }
+        }
+    }
+    // A frame that started before the capture did is dropped rather than drawn from time zero.
+    if (start_usec) {
+        uint64_t end_usec = get_ticks_usec();
+        _push_event({ p_name, start_usec, end_usec - start_usec, 0.0, EVENT_FRAME });
+    }
+}
+
+void TraceProfiler::start(int p_frames) {
+
+    State &s = _get_state();
+    {
+        MutexLock lock(s.mutex);
+        s.frames_left = p_frames;
+        s.in_spike = false;
+    }
+    recording.store(true, std::memory_order_release);
+}
+
+void TraceProfiler::stop() {
+
+    recording.store(false, std::memory_order_release);
+    MutexLock lock(_get_state().mutex);
+    _get_state().frames_left = 0;
+}
+
+void TraceProfiler::set_spike_threshold_usec(uint64_t p_usec) {
+
+    MutexLock lock(_get_state().mutex);
+    _get_state().spike_threshold_usec = p_usec;
+}
+
+void TraceProfiler::set_output_path(StringView p_path) {
+
+    MutexLock lock(_get_state().mutex);
+    _get_state().output_path = p_path;
+}
+
+const String &TraceProfiler::get_output_path() {
+
+    return _get_state().output_path;
+}
+
+void TraceProfiler::end_frame(uint64_t p_frame_usec) {
+
+    if (!is_recording()) {
+        return;
+    }
+
+    State &s = _get_state();
+    String spike_path;
+    bool finished = false;
+    {
+        MutexLock lock(s.mutex);
+        // Only the first of a run of slow frames is written, the following ones would mostly repeat it.
+        bool spike = s.spike_threshold_usec && p_frame_usec > s.spike_threshold_usec;
+        if (spike && !s.in_spike) {
+            spike_path = String(PathUtils::get_basename(s.output_path)) + FormatVE(".spike%d.json", s.spike_dumps++);
+        }
+        s.in_spike = spike;
+
+        if (s.frames_left > 0 && --s.frames_left == 0) {
+            finished = true;
+        }
+    }
+
+    if (!spike_path.empty()) {
+        if (dump(spike_path) == OK) {
+            print_line(FormatVE("Frame took %.2f ms, trace written to %s", p_frame_usec / 1000.0, spike_path.c_str()));
+        }
+        clear();
+    }
+    if (finished) {
+        recording.store(false, std::memory_order_release);
+        if (dump(s.output_path) == OK) {
+            print_line("Trace written to " + s.output_path);
+        }
+    }
+}
+
+void TraceProfiler::finish() {
+
+    if (!is_recording()) {
+        return;
+    }
+    bool pending;
+    {
+        MutexLock lock(_get_state().mutex);
+        pending = _get_state().frames_left > 0;
+    }
+    stop();
+    if (pending) {
+        dump(_get_state().output_path);
+    }
+}
+
+String TraceProfiler::export_json() {
+
+    State &s = _get_state();
+    MutexLock lock(s.mutex);
+
+    const int pid = OS::get_singleton() ? OS::get_singleton()->get_process_id() : 0;
+    String json = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&first, &json]() {
+        if (!first) {
+            json += ",\n";
+        }
+        first = false;
+    };
+
+    Vector<Event> events;
+    for (ThreadBuffer *buffer : s.buffers) {
+        {
+            SpinGuard guard(buffer->lock);
+            events.resize(buffer->count);
+            // Oldest first, the ring has wrapped once count reaches its capacity.
+            uint32_t begin = (buffer->head + EVENTS_PER_THREAD - buffer->count) % EVENTS_PER_THREAD;
+            for (uint32_t i = 0; i < buffer->count; i++) {
+                events[i] = buffer->events[(begin + i) % EVENTS_PER_THREAD];
+            }
+        }
+
+        const int tid = buffer->thread_index;
+        separator();
+        json += FormatVE("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", pid,
+                tid, buffer->main_thread ? "Main thread" : FormatVE("Thread %d", tid).c_str());
+
+        for (const Event &e : events) {
+            String name = StringUtils::json_escape(event_name(e.name));
+            separator();
+            switch (e.type) {
+                case EVENT_SCOPE:
+                case EVENT_FRAME:
+                    json += FormatVE("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%llu,\"dur\":%llu}",
+                            name.c_str(), e.type == EVENT_FRAME ? "frame" : "scope", pid, tid,
+                            (unsigned long long)e.start_usec, (unsigned long long)e.duration_usec);
+                    break;
+                case EVENT_COUNTER:
+                    json += FormatVE("{\"name\":\"%s\",\"ph\":\"C\",\"pid\":%d,\"tid\":%d,\"ts\":%llu,\"args\":{\"value\":%.17g}}",
+                            name.c_str(), pid, tid, (unsigned long long)e.start_usec, e.value);
+                    break;
+            }
+        }
+    }
+    json += "\n]}\n";
+    return json;
+}
+
+Error TraceProfiler::dump(StringView p_path) {
+
+    String json = export_json();
+    Error err;
+    FileAccess *f = FileAccess::open(p_path, FileAccess::WRITE, &err);
+    ERR_FAIL_COND_V_MSG(!f, err, "Can't write trace to '" + String(p_path) + "'.");
+    f->store_string(json);
+    f->close();
+    memdelete(f);
+    return OK;
+}
+
+void TraceProfiler::clear() {
+
+    State &s = _get_state();
+    MutexLock lock(s.mutex);
+    for (ThreadBuffer *buffer : s.buffers) {
+        SpinGuard guard(buffer->lock);
+        buffer->head = 0;
+        buffer->count = 0;
+    }
+}
+
+void TraceProfiler::cleanup() {
+
+    stop();
+    State &s = _get_state();
+    MutexLock lock(s.mutex);
+    for (ThreadBuffer *buffer : s.buffers) {
+        memdelete(buffer);
+    }
+    s.buffers.clear();
+    s.generation.fetch_add(1, std::memory_order_release);
+}
@@ -0,0 +1,117 @@
+/*************************************************************************/
+/*  trace_profiler.h                                                     */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#pragma once
+
+#include "core/error_list.h"
+#include "core/forward_decls.h"
+#include "core/godot_export.h"
+
+#include <atomic>
+#include <cstdint>
+
+// In-process backend for the profiling macros in external_profiler.h, used when no Tracy client is embedded.
+// Every thread records scopes, counters and frame marks into its own ring buffer while a capture is running; the
+// buffers can be written out as Chrome trace-event JSON, loadable in chrome://tracing or ui.perfetto.dev.
+class GODOT_EXPORT TraceProfiler {
+public:
+    enum {
+        EVENTS_PER_THREAD = 1 << 16
+    };
+
+    enum EventType : uint8_t {
+        EVENT_SCOPE,
+        EVENT_FRAME,
+        EVENT_COUNTER
+    };
+
+    struct Event {
+        const char *name; // Must outlive the capture, the macros only pass string literals.
+        uint64_t start_usec;
+        uint64_t duration_usec;
+        double value;
+        EventType type;
+    };
+
+private:
+    struct ThreadBuffer;
+    struct ThreadSlot;
+    struct State;
+
+    static std::atomic<bool> recording;
+
+    static State &_get_state();
+    static ThreadBuffer *_get_thread_buffer();
+    static void _push_event(const Event &p_event);
+
+public:
+    static bool is_recording() { return recording.load(std::memory_order_relaxed); }
+    static uint64_t get_ticks_usec();
+
+    static void record_scope(const char *p_name, uint64_t p_start_usec, uint64_t p_end_usec);
+    static void record_value(const char *p_name, double p_value);
+    static void frame_start(const char *p_name);
+    static void frame_end(const char *p_name);
+
+    // Records for p_frames calls to end_frame() and writes the trace to the output path afterwards, or until stop()
+    // when p_frames is 0.
+    static void start(int p_frames = 0);
+    static void stop();
+    // While recording, a frame slower than this writes everything recorded so far and starts over. 0 disables it.
+    static void set_spike_threshold_usec(uint64_t p_usec);
+    static void set_output_path(StringView p_path);
+    static const String &get_output_path();
+    // Called by the main loop once per frame.
+    static void end_frame(uint64_t p_frame_usec);
+    // Writes a pending frame-limited capture, called on shutdown.
+    static void finish();
+
+    static String export_json();
+    static Error dump(StringView p_path);
+    static void clear();
+    static void cleanup();
+};
+
+class TraceProfilerScope {
+    const char *name;
+    uint64_t start_usec;
+
+public:
+    explicit TraceProfilerScope(const char *p_name) :
+            name(p_name),
+            start_usec(TraceProfiler::is_recording() ? TraceProfiler::get_ticks_usec() : 0) {}
+    ~TraceProfilerScope() {
+        if (start_usec) {
+            TraceProfiler::record_scope(name, start_usec, TraceProfiler::get_ticks_usec());
+        }
+    }
+    TraceProfilerScope(const TraceProfilerScope &) = delete;
+    TraceProfilerScope &operator=(const TraceProfilerScope &) = delete;
+};
@@ -61,61 +61,71 @@
 
 struct StreamFile : public VariantParserStream {
 
+    enum {
+        READAHEAD_SIZE = 4096
+    };
+
     FileAccess *f;
+    bool readahead;
+    char buffer[READAHEAD_SIZE];
 
-    char get_char() override;
     bool is_utf8() const override;
-    bool is_eof() const override;
 
-    StreamFile(FileAccess *fl = nullptr) : f(fl) {}
+    StreamFile(FileAccess *fl = nullptr, bool p_readahead = true) : f(fl), readahead(p_readahead) {}
+
+protected:
+    bool _next_span(const char *&r_begin, const char *&r_end) override;
 };
 
 struct StreamString : public VariantParserStream {
 
     String s;
-    int pos=0;
+    bool consumed = false;
 
-    char get_char() override;
     bool is_utf8() const override;
-    bool is_eof() const override;
 
     StreamString(const String &str) : s(str) {}
     StreamString(String &&str) noexcept : s(eastl::move(str)) {}
+
+protected:
+    bool _next_span(const char *&r_begin, const char *&r_end) override;
 };
 
-char StreamFile::get_char() {
+bool StreamFile::_next_span(const char *&r_begin, const char *&r_end) {
 
-    return f->get_8();
+    uint64_t read;
+    if (readahead) {
+        read = f->get_buffer((uint8_t *)buffer, READAHEAD_SIZE);
+    } else {
+        // Keeps the file position in sync with the parser, for callers that seek around tags.
+        buffer[0] = f->get_8();
+        read = f->eof_reached() ? 0 : 1;
+    }
+    r_begin = buffer;
+    r_end = buffer + read;
+    return read != 0;
 }
 
 bool StreamFile::is_utf8() const {
 
     return true;
 }
-bool StreamFile::is_eof() const {
 
-    return f->eof_reached();
-}
+bool StreamString::_next_span(const char *&r_begin, const char *&r_end) {
 
-char StreamString::get_char() {
-    if (pos > s.length()) {
-        return 0;
-    } else if (pos == s.length()) {
-        // You need to try to read again when you have reached the end for EOF to be reported,
-        // so this works the same as files (like StreamFile does)
-        pos++;
-        return 0;
-    } else {
-        return s[pos++];
+    // The whole string is handed out as a single span, tokens are scanned in place.
+    if (consumed) {
+        return false;
     }
+    consumed = true;
+    r_begin = s.data();
+    r_end = s.data() + s.size();
+    return true;
 }
 
 bool StreamString::is_utf8() const {
     return false;
 }
-bool StreamString::is_eof() const {
-    return pos > s.length();
-}
 
 /////////////////////////////////////////////////////////////////////////////////////////////////
 
@@ -214,16 +224,20 @@ Error VariantParser::get_token(VariantParserStream *p_stream, Token &r_token, in
             }
             case ';': {
 
+                // skip the comment a span at a time.
                 while (true) {
-                    CharType ch = p_stream->get_char();
-                    if (p_stream->is_eof()) {
+                    StringView run = p_stream->peek_span();
+                    if (run.empty()) {
                         r_token.type = TK_EOF;
                         return OK;
                     }
-                    if (ch == '\n') {
+                    const size_t eol = run.find('\n');
+                    if (eol != StringView::npos) {
+                        p_stream->consume(eol + 1);
                         line++;
                         break;
                     }
+                    p_stream->consume(run.size());
                 }
 
                 break;
@@ -278,6 +292,17 @@ Error VariantParser::get_token(VariantParserStream *p_stream, Token &r_token, in
                 String str;
                 while (true) {
 
+                    // copy plain runs straight from the stream buffer, escapes and newlines are handled below.
+                    StringView run = p_stream->peek_span();
+                    size_t plain = 0;
+                    while (plain < run.size() && run[plain] != '"' && run[plain] != '\\' && run[plain] != '\n' && run[plain] != 0) {
+                        plain++;
+                    }
+                    if (plain) {
+                        str.append(run.data(), plain);
+                        p_stream->consume(plain);
+                    }
+
                     char ch = p_stream->get_char();
 
                     if (ch == 0) {
@@ -450,17 +475,22 @@ Error VariantParser::get_token(VariantParserStream *p_stream, Token &r_token, in
 
                 } else if ((cchar >= 'A' && cchar <= 'Z') || (cchar >= 'a' && cchar <= 'z') || cchar == '_') {
 
-                    tmp_str_buf = "";
-                    bool first = true;
+                    tmp_str_buf = cchar;
 
-                    while ((cchar >= 'A' && cchar <= 'Z') || (cchar >= 'a' && cchar <= 'z') || cchar == '_' || (!first && cchar >= '0' && cchar <= '9')) {
-
-                        tmp_str_buf += cchar;
-                        cchar = p_stream->get_char();
-                        first = false;
+                    while (true) {
+                        StringView run = p_stream->peek_span();
+                        size_t len = 0;
+                        while (len < run.size() && ((run[len] >= 'A' && run[len] <= 'Z') || (run[len] >= 'a' && run[len] <= 'z') || run[len] == '_' || (run[len] >= '0' && run[len] <= '9'))) {
+                            len++;
+                        }
+                        tmp_str_buf.append(run.data(), len);
+                        p_stream->consume(len);
+                        if (len < run.size() || run.empty()) {
+                            break;
+                        }
                     }
 
-                    p_stream->saved = cchar;
+                    p_stream->saved = p_stream->get_char();
 
                     r_token.type = TK_IDENTIFIER;
                     r_token.value = Variant::from(StringView(tmp_str_buf));
@@ -1463,9 +1493,9 @@ Error VariantParser::parse(VariantParserStream *p_stream, Variant &r_ret, String
     return parse_value(token, r_ret, p_stream, r_err_line, r_err_str, p_res_parser);
 }
 
-VariantParserStream *VariantParser::get_file_stream(FileAccess *f)
+VariantParserStream *VariantParser::get_file_stream(FileAccess *f, bool p_readahead)
 {
-    return memnew_args_basic(StreamFile,f);
+    return memnew_args_basic(StreamFile,f,p_readahead);
 }
 
 VariantParserStream *VariantParser::get_string_stream(const String &f)
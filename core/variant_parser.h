@@ -36,16 +36,55 @@
 #include "core/variant.h"
 #include "core/string.h"
 
+/**
+ * Character source of the VariantParser.
+ *
+ * Implementations hand out their contents as spans through _next_span(), so reading a character is an inlined
+ * pointer bump instead of a virtual call. The tokenizer also scans whole runs of the current span (see peek_span())
+ * to copy strings and identifiers in one go.
+ */
 struct VariantParserStream {
 
-    virtual char get_char() = 0;
+    _FORCE_INLINE_ char get_char() {
+        if (unlikely(read_pos == read_end) && !_refill()) {
+            return 0;
+        }
+        return *read_pos++;
+    }
+    //! Unconsumed characters of the current span, refilled when empty. Empty once the end of the stream is reached.
+    StringView peek_span() {
+        if (read_pos == read_end) {
+            _refill();
+        }
+        return StringView(read_pos, read_end - read_pos);
+    }
+    void consume(size_t p_count) { read_pos += p_count; }
+    //! True once a read past the end of the stream was attempted.
+    bool is_eof() const { return eof; }
     virtual bool is_utf8() const = 0;
-    virtual bool is_eof() const = 0;
 
     char saved = 0;
 
     VariantParserStream() {}
     virtual ~VariantParserStream() {}
+
+protected:
+    //! Points r_begin/r_end to the next run of characters, returns false when there are no more.
+    virtual bool _next_span(const char *&r_begin, const char *&r_end) = 0;
+
+private:
+    const char *read_pos = nullptr;
+    const char *read_end = nullptr;
+    bool eof = false;
+
+    bool _refill() {
+        if (!eof && _next_span(read_pos, read_end) && read_pos != read_end) {
+            return true;
+        }
+        read_pos = read_end = nullptr;
+        eof = true;
+        return false;
+    }
 };
 
 class GODOT_EXPORT VariantParser {
@@ -120,7 +159,8 @@ public:
     static Error get_token(VariantParserStream *p_stream, Token &r_token, int &line, String &r_err_str);
     static Error parse(VariantParserStream *p_stream, Variant &r_ret, String &r_err_str, int &r_err_line, ResourceParser *p_res_parser = nullptr);
 
-    static VariantParserStream *get_file_stream(FileAccess *f);
+    //! With p_readahead set, the stream reads the file in blocks and the file position runs ahead of the parser.
+    static VariantParserStream *get_file_stream(FileAccess *f, bool p_readahead = true);
     static VariantParserStream *get_string_stream(const String &f);
     static VariantParserStream *get_string_stream(String &&f);
     static void release_stream(VariantParserStream *s);
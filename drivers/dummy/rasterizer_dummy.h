@@ -470,6 +470,7 @@ public:
     int skeleton_get_bone_count(RenderingEntity p_skeleton) const { return 0; }
     void skeleton_bone_set_transform(RenderingEntity p_skeleton, int p_bone, const Transform &p_transform) {}
     Transform skeleton_bone_get_transform(RenderingEntity p_skeleton, int p_bone) const { return Transform(); }
+    void skeleton_set_bone_transforms(RenderingEntity p_skeleton, Span<const Transform> p_transforms) {}
     void skeleton_bone_set_transform_2d(RenderingEntity p_skeleton, int p_bone, const Transform2D &p_transform) {}
     Transform2D skeleton_bone_get_transform_2d(RenderingEntity p_skeleton, int p_bone) const { return Transform2D(); }
 
@@ -73,8 +73,20 @@ String RasterizerStorageGLES3::shader_get_code(RenderingEntity p_shader) const {
     return shader->code;
 }
 
-void _update_shader(RasterizerGLES3ShadersStorage &shaders, RasterizerShaderComponent *p_shader) {
-    using namespace eastl;
+namespace {
+// Everything one shader needs between setting up its compile and applying the result. The actions point into
+// the shader and into async_mode, so an update must stay where it is once begun.
+struct ShaderUpdate {
+    RasterizerShaderComponent *shader = nullptr;
+    ShaderCompilerGLES3::IdentifierActions actions;
+    ShaderCompilerGLES3::GeneratedCode gen_code;
+    int8_t async_mode = (int8_t)ShaderGLES3::ASYNC_MODE_VISIBLE;
+};
+} // namespace
+
+// Resets the shader and sets up its actions, returns false when there is nothing to compile.
+static bool _begin_shader_update(ShaderUpdate &r_update) {
+    RasterizerShaderComponent *p_shader = r_update.shader;
     VSG::ecs->registry.remove<ShaderDirtyMarker>(p_shader->self);
 
     p_shader->valid = false;
@@ -83,13 +95,12 @@ void _update_shader(RasterizerGLES3ShadersStorage &shaders, RasterizerShaderComp
     p_shader->uniforms.clear();
 
     if (p_shader->code.empty()) {
-        return; //just invalid, but no error
+        return false; //just invalid, but no error
     }
 
-    ShaderCompilerGLES3::GeneratedCode gen_code;
-    ShaderCompilerGLES3::IdentifierActions *actions = nullptr;
+    ShaderCompilerGLES3::IdentifierActions *actions = &r_update.actions;
+    int8_t &async_mode = r_update.async_mode;
 
-    int8_t async_mode = (int8_t)ShaderGLES3::ASYNC_MODE_VISIBLE;
     switch (p_shader->mode) {
         case RS::ShaderMode::CANVAS_ITEM: {
 
@@ -108,31 +119,30 @@ void _update_shader(RasterizerGLES3ShadersStorage &shaders, RasterizerShaderComp
             p_shader->canvas_item.uses_projection_matrix = false;
             p_shader->canvas_item.uses_instance_custom = false;
 
-            shaders.actions_canvas.render_mode_values[StringName("blend_add")] = Pair<int8_t *, int>((int8_t *)&p_shader->canvas_item.blend_mode, RasterizerShaderComponent::CanvasItem::BLEND_MODE_ADD);
-            shaders.actions_canvas.render_mode_values["blend_mix"] = Pair<int8_t *, int>((int8_t *)&p_shader->canvas_item.blend_mode, RasterizerShaderComponent::CanvasItem::BLEND_MODE_MIX);
-            shaders.actions_canvas.render_mode_values["blend_sub"] = Pair<int8_t *, int>((int8_t *)&p_shader->canvas_item.blend_mode, RasterizerShaderComponent::CanvasItem::BLEND_MODE_SUB);
-            shaders.actions_canvas.render_mode_values["blend_mul"] = Pair<int8_t *, int>((int8_t *)&p_shader->canvas_item.blend_mode, RasterizerShaderComponent::CanvasItem::BLEND_MODE_MUL);
-            shaders.actions_canvas.render_mode_values["blend_premul_alpha"] = Pair<int8_t *, int>((int8_t *)&p_shader->canvas_item.blend_mode, RasterizerShaderComponent::CanvasItem::BLEND_MODE_PMALPHA);
-            shaders.actions_canvas.render_mode_values["blend_disabled"] = Pair<int8_t *, int>((int8_t *)&p_shader->canvas_item.blend_mode, RasterizerShaderComponent::CanvasItem::BLEND_MODE_DISABLED);
+            actions->render_mode_values[StringName("blend_add")] = Pair<int8_t *, int>((int8_t *)&p_shader->canvas_item.blend_mode, RasterizerShaderComponent::CanvasItem::BLEND_MODE_ADD);
+            actions->render_mode_values["blend_mix"] = Pair<int8_t *, int>((int8_t *)&p_shader->canvas_item.blend_mode, RasterizerShaderComponent::CanvasItem::BLEND_MODE_MIX);
+            actions->render_mode_values["blend_sub"] = Pair<int8_t *, int>((int8_t *)&p_shader->canvas_item.blend_mode, RasterizerShaderComponent::CanvasItem::BLEND_MODE_SUB);
+            actions->render_mode_values["blend_mul"] = Pair<int8_t *, int>((int8_t *)&p_shader->canvas_item.blend_mode, RasterizerShaderComponent::CanvasItem::BLEND_MODE_MUL);
+            actions->render_mode_values["blend_premul_alpha"] = Pair<int8_t *, int>((int8_t *)&p_shader->canvas_item.blend_mode, RasterizerShaderComponent::CanvasItem::BLEND_MODE_PMALPHA);
+            actions->render_mode_values["blend_disabled"] = Pair<int8_t *, int>((int8_t *)&p_shader->canvas_item.blend_mode, RasterizerShaderComponent::CanvasItem::BLEND_MODE_DISABLED);
 
-            shaders.actions_canvas.render_mode_values["unshaded"] = Pair<int8_t *, int>((int8_t *)&p_shader->canvas_item.light_mode, RasterizerShaderComponent::CanvasItem::LIGHT_MODE_UNSHADED);
-            shaders.actions_canvas.render_mode_values["light_only"] = Pair<int8_t *, int>((int8_t *)&p_shader->canvas_item.light_mode, RasterizerShaderComponent::CanvasItem::LIGHT_MODE_LIGHT_ONLY);
+            actions->render_mode_values["unshaded"] = Pair<int8_t *, int>((int8_t *)&p_shader->canvas_item.light_mode, RasterizerShaderComponent::CanvasItem::LIGHT_MODE_UNSHADED);
+            actions->render_mode_values["light_only"] = Pair<int8_t *, int>((int8_t *)&p_shader->canvas_item.light_mode, RasterizerShaderComponent::CanvasItem::LIGHT_MODE_LIGHT_ONLY);
 
-            shaders.actions_canvas.usage_flag_pointers["SCREEN_UV"] = &p_shader->canvas_item.uses_screen_uv;
-            shaders.actions_canvas.usage_flag_pointers["SCREEN_PIXEL_SIZE"] = &p_shader->canvas_item.uses_screen_uv;
-            shaders.actions_canvas.usage_flag_pointers["SCREEN_TEXTURE"] = &p_shader->canvas_item.uses_screen_texture;
-            shaders.actions_canvas.usage_flag_pointers["TIME"] = &p_shader->canvas_item.uses_time;
+            actions->usage_flag_pointers["SCREEN_UV"] = &p_shader->canvas_item.uses_screen_uv;
+            actions->usage_flag_pointers["SCREEN_PIXEL_SIZE"] = &p_shader->canvas_item.uses_screen_uv;
+            actions->usage_flag_pointers["SCREEN_TEXTURE"] = &p_shader->canvas_item.uses_screen_texture;
+            actions->usage_flag_pointers["TIME"] = &p_shader->canvas_item.uses_time;
 
-            shaders.actions_canvas.usage_flag_pointers["MODULATE"] = &p_shader->canvas_item.uses_modulate;
-            shaders.actions_canvas.usage_flag_pointers["COLOR"] = &p_shader->canvas_item.uses_color;
-            shaders.actions_canvas.usage_flag_pointers["VERTEX"] = &p_shader->canvas_item.uses_vertex;
+            actions->usage_flag_pointers["MODULATE"] = &p_shader->canvas_item.uses_modulate;
+            actions->usage_flag_pointers["COLOR"] = &p_shader->canvas_item.uses_color;
+            actions->usage_flag_pointers["VERTEX"] = &p_shader->canvas_item.uses_vertex;
 
-            shaders.actions_canvas.usage_flag_pointers["WORLD_MATRIX"] = &p_shader->canvas_item.uses_world_matrix;
-            shaders.actions_canvas.usage_flag_pointers["EXTRA_MATRIX"] = &p_shader->canvas_item.uses_extra_matrix;
-            shaders.actions_canvas.usage_flag_pointers["PROJECTION_MATRIX"] = &p_shader->canvas_item.uses_projection_matrix;
-            shaders.actions_canvas.usage_flag_pointers["INSTANCE_CUSTOM"] = &p_shader->canvas_item.uses_instance_custom;
+            actions->usage_flag_pointers["WORLD_MATRIX"] = &p_shader->canvas_item.uses_world_matrix;
+            actions->usage_flag_pointers["EXTRA_MATRIX"] = &p_shader->canvas_item.uses_extra_matrix;
+            actions->usage_flag_pointers["PROJECTION_MATRIX"] = &p_shader->canvas_item.uses_projection_matrix;
+            actions->usage_flag_pointers["INSTANCE_CUSTOM"] = &p_shader->canvas_item.uses_instance_custom;
 
-            actions = &shaders.actions_canvas;
             actions->uniforms = &p_shader->uniforms;
 
         } break;
@@ -158,66 +168,69 @@ void _update_shader(RasterizerGLES3ShadersStorage &shaders, RasterizerShaderComp
             p_shader->spatial.writes_modelview_or_projection = false;
             p_shader->spatial.uses_world_coordinates = false;
 
-            shaders.actions_scene.render_mode_values["blend_add"] = Pair<int8_t *, int>(&p_shader->spatial.blend_mode, RasterizerShaderComponent::Node3D::BLEND_MODE_ADD);
-            shaders.actions_scene.render_mode_values["blend_mix"] = Pair<int8_t *, int>(&p_shader->spatial.blend_mode, RasterizerShaderComponent::Node3D::BLEND_MODE_MIX);
-            shaders.actions_scene.render_mode_values["blend_sub"] = Pair<int8_t *, int>(&p_shader->spatial.blend_mode, RasterizerShaderComponent::Node3D::BLEND_MODE_SUB);
-            shaders.actions_scene.render_mode_values["blend_mul"] = Pair<int8_t *, int>(&p_shader->spatial.blend_mode, RasterizerShaderComponent::Node3D::BLEND_MODE_MUL);
+            actions->render_mode_values["blend_add"] = Pair<int8_t *, int>(&p_shader->spatial.blend_mode, RasterizerShaderComponent::Node3D::BLEND_MODE_ADD);
+            actions->render_mode_values["blend_mix"] = Pair<int8_t *, int>(&p_shader->spatial.blend_mode, RasterizerShaderComponent::Node3D::BLEND_MODE_MIX);
+            actions->render_mode_values["blend_sub"] = Pair<int8_t *, int>(&p_shader->spatial.blend_mode, RasterizerShaderComponent::Node3D::BLEND_MODE_SUB);
+            actions->render_mode_values["blend_mul"] = Pair<int8_t *, int>(&p_shader->spatial.blend_mode, RasterizerShaderComponent::Node3D::BLEND_MODE_MUL);
 
-            shaders.actions_scene.render_mode_values["depth_draw_opaque"] = Pair<int8_t *, int>(&p_shader->spatial.depth_draw_mode, RasterizerShaderComponent::Node3D::DEPTH_DRAW_OPAQUE);
-            shaders.actions_scene.render_mode_values["depth_draw_always"] = Pair<int8_t *, int>(&p_shader->spatial.depth_draw_mode, RasterizerShaderComponent::Node3D::DEPTH_DRAW_ALWAYS);
-            shaders.actions_scene.render_mode_values["depth_draw_never"] = Pair<int8_t *, int>(&p_shader->spatial.depth_draw_mode, RasterizerShaderComponent::Node3D::DEPTH_DRAW_NEVER);
-            shaders.actions_scene.render_mode_values["depth_draw_alpha_prepass"] = Pair<int8_t *, int>(&p_shader->spatial.depth_draw_mode, RasterizerShaderComponent::Node3D::DEPTH_DRAW_ALPHA_PREPASS);
+            actions->render_mode_values["depth_draw_opaque"] = Pair<int8_t *, int>(&p_shader->spatial.depth_draw_mode, RasterizerShaderComponent::Node3D::DEPTH_DRAW_OPAQUE);
+            actions->render_mode_values["depth_draw_always"] = Pair<int8_t *, int>(&p_shader->spatial.depth_draw_mode, RasterizerShaderComponent::Node3D::DEPTH_DRAW_ALWAYS);
+            actions->render_mode_values["depth_draw_never"] = Pair<int8_t *, int>(&p_shader->spatial.depth_draw_mode, RasterizerShaderComponent::Node3D::DEPTH_DRAW_NEVER);
+            actions->render_mode_values["depth_draw_alpha_prepass"] = Pair<int8_t *, int>(&p_shader->spatial.depth_draw_mode, RasterizerShaderComponent::Node3D::DEPTH_DRAW_ALPHA_PREPASS);
 
-            shaders.actions_scene.render_mode_values["cull_front"] = Pair<int8_t *, int>(&p_shader->spatial.cull_mode, RasterizerShaderComponent::Node3D::CULL_MODE_FRONT);
-            shaders.actions_scene.render_mode_values["cull_back"] = Pair<int8_t *, int>(&p_shader->spatial.cull_mode, RasterizerShaderComponent::Node3D::CULL_MODE_BACK);
-            shaders.actions_scene.render_mode_values["cull_disabled"] = Pair<int8_t *, int>(&p_shader->spatial.cull_mode, RasterizerShaderComponent::Node3D::CULL_MODE_DISABLED);
+            actions->render_mode_values["cull_front"] = Pair<int8_t *, int>(&p_shader->spatial.cull_mode, RasterizerShaderComponent::Node3D::CULL_MODE_FRONT);
+            actions->render_mode_values["cull_back"] = Pair<int8_t *, int>(&p_shader->spatial.cull_mode, RasterizerShaderComponent::Node3D::CULL_MODE_BACK);
+            actions->render_mode_values["cull_disabled"] = Pair<int8_t *, int>(&p_shader->spatial.cull_mode, RasterizerShaderComponent::Node3D::CULL_MODE_DISABLED);
 
-            shaders.actions_scene.render_mode_values["async_visible"] = Pair<int8_t *, int>(&async_mode, (int)ShaderGLES3::ASYNC_MODE_VISIBLE);
-            shaders.actions_scene.render_mode_values["async_hidden"] = Pair<int8_t *, int>(&async_mode, (int)ShaderGLES3::ASYNC_MODE_HIDDEN);
-            shaders.actions_scene.render_mode_flags["unshaded"] = &p_shader->spatial.unshaded;
-            shaders.actions_scene.render_mode_flags["depth_test_disable"] = &p_shader->spatial.no_depth_test;
+            actions->render_mode_values["async_visible"] = Pair<int8_t *, int>(&async_mode, (int)ShaderGLES3::ASYNC_MODE_VISIBLE);
+            actions->render_mode_values["async_hidden"] = Pair<int8_t *, int>(&async_mode, (int)ShaderGLES3::ASYNC_MODE_HIDDEN);
+            actions->render_mode_flags["unshaded"] = &p_shader->spatial.unshaded;
+            actions->render_mode_flags["depth_test_disable"] = &p_shader->spatial.no_depth_test;
 
-            shaders.actions_scene.render_mode_flags["vertex_lighting"] = &p_shader->spatial.uses_vertex_lighting;
-            shaders.actions_scene.render_mode_flags["world_vertex_coords"] = &p_shader->spatial.uses_world_coordinates;
+            actions->render_mode_flags["vertex_lighting"] = &p_shader->spatial.uses_vertex_lighting;
+            actions->render_mode_flags["world_vertex_coords"] = &p_shader->spatial.uses_world_coordinates;
 
-            shaders.actions_scene.render_mode_flags["ensure_correct_normals"] = &p_shader->spatial.uses_ensure_correct_normals;
+            actions->render_mode_flags["ensure_correct_normals"] = &p_shader->spatial.uses_ensure_correct_normals;
 
 
-            shaders.actions_scene.usage_flag_pointers["ALPHA"] = &p_shader->spatial.uses_alpha;
-            shaders.actions_scene.usage_flag_pointers["ALPHA_SCISSOR"] = &p_shader->spatial.uses_alpha_scissor;
+            actions->usage_flag_pointers["ALPHA"] = &p_shader->spatial.uses_alpha;
+            actions->usage_flag_pointers["ALPHA_SCISSOR"] = &p_shader->spatial.uses_alpha_scissor;
 
-            shaders.actions_scene.usage_flag_pointers["SSS_STRENGTH"] = &p_shader->spatial.uses_sss;
-            shaders.actions_scene.usage_flag_pointers["DISCARD"] = &p_shader->spatial.uses_discard;
-            shaders.actions_scene.usage_flag_pointers["SCREEN_TEXTURE"] = &p_shader->spatial.uses_screen_texture;
-            shaders.actions_scene.usage_flag_pointers["DEPTH_TEXTURE"] = &p_shader->spatial.uses_depth_texture;
-            shaders.actions_scene.usage_flag_pointers["TIME"] = &p_shader->spatial.uses_time;
+            actions->usage_flag_pointers["SSS_STRENGTH"] = &p_shader->spatial.uses_sss;
+            actions->usage_flag_pointers["DISCARD"] = &p_shader->spatial.uses_discard;
+            actions->usage_flag_pointers["SCREEN_TEXTURE"] = &p_shader->spatial.uses_screen_texture;
+            actions->usage_flag_pointers["DEPTH_TEXTURE"] = &p_shader->spatial.uses_depth_texture;
+            actions->usage_flag_pointers["TIME"] = &p_shader->spatial.uses_time;
 
                  // Use of any of these BUILTINS indicate the need for transformed tangents.
                  // This is needed to know when to transform tangents in software skinning.
-            shaders.actions_scene.usage_flag_pointers["TANGENT"] = &p_shader->spatial.uses_tangent;
-            shaders.actions_scene.usage_flag_pointers["NORMALMAP"] = &p_shader->spatial.uses_tangent;
+            actions->usage_flag_pointers["TANGENT"] = &p_shader->spatial.uses_tangent;
+            actions->usage_flag_pointers["NORMALMAP"] = &p_shader->spatial.uses_tangent;
 
 
-            shaders.actions_scene.write_flag_pointers["MODELVIEW_MATRIX"] = &p_shader->spatial.writes_modelview_or_projection;
-            shaders.actions_scene.write_flag_pointers["PROJECTION_MATRIX"] = &p_shader->spatial.writes_modelview_or_projection;
-            shaders.actions_scene.write_flag_pointers["VERTEX"] = &p_shader->spatial.uses_vertex;
+            actions->write_flag_pointers["MODELVIEW_MATRIX"] = &p_shader->spatial.writes_modelview_or_projection;
+            actions->write_flag_pointers["PROJECTION_MATRIX"] = &p_shader->spatial.writes_modelview_or_projection;
+            actions->write_flag_pointers["VERTEX"] = &p_shader->spatial.uses_vertex;
 
-            actions = &shaders.actions_scene;
             actions->uniforms = &p_shader->uniforms;
 
         } break;
         case RS::ShaderMode::PARTICLES: {
 
-            actions = &shaders.actions_particles;
             actions->uniforms = &p_shader->uniforms;
         } break;
         case RS::ShaderMode::MAX:
             break; // Can't happen, but silences warning
     }
 
-    Error err = shaders.compiler.compile(p_shader->mode, p_shader->code, actions, p_shader->path, gen_code);
+    return true;
+}
+
+static void _finish_shader_update(ShaderUpdate &p_update, Error p_err) {
+    RasterizerShaderComponent *p_shader = p_update.shader;
+    ShaderCompilerGLES3::GeneratedCode &gen_code = p_update.gen_code;
 
-    if (err != OK) {
+    if (p_err != OK) {
         return;
     }
 
@@ -245,7 +258,7 @@ void _update_shader(RasterizerGLES3ShadersStorage &shaders, RasterizerShaderComp
 
     p_shader->shader->set_custom_shader_code(p_shader->custom_code_id, gen_code.vertex, gen_code.vertex_global,
             gen_code.fragment, gen_code.light, gen_code.fragment_global, gen_code.uniforms, gen_code.texture_uniforms,
-            gen_code.defines,(ShaderGLES3::AsyncMode)async_mode);
+            gen_code.defines,(ShaderGLES3::AsyncMode)p_update.async_mode);
          //all materials using this shader will have to be invalidated, unfortunately
 
     for (RenderingEntity E : p_shader->materials) {
@@ -257,11 +270,54 @@ void _update_shader(RasterizerGLES3ShadersStorage &shaders, RasterizerShaderComp
     p_shader->version++;
 }
 
+void _update_shader(RasterizerGLES3ShadersStorage &shaders, RasterizerShaderComponent *p_shader) {
+    ShaderUpdate update;
+    update.shader = p_shader;
+    if (!_begin_shader_update(update)) {
+        return;
+    }
+    Error err = shaders.compiler.compile(p_shader->mode, p_shader->code, &update.actions, p_shader->path, update.gen_code);
+    _finish_shader_update(update, err);
+}
+
 void RasterizerStorageGLES3::update_dirty_shaders() {
+    Vector<RasterizerShaderComponent *> dirty;
     auto vw = VSG::ecs->registry.view<ShaderDirtyMarker,RasterizerShaderComponent>();
     vw.each([&](auto entity, auto &shader) {
-        _update_shader(shaders,&shader);
+        dirty.push_back(&shader);
     });
+
+    if (dirty.size() < 2) {
+        for (RasterizerShaderComponent *shader : dirty) {
+            _update_shader(shaders, shader);
+        }
+        return;
+    }
+
+    // Parsing and translating to GLSL needs no GL context, so a level load's worth of shaders is compiled in
+    // parallel and only handed to GL here.
+    Vector<ShaderUpdate> updates;
+    updates.resize(dirty.size());
+    Vector<ShaderCompilerGLES3::BatchItem> batch;
+    batch.reserve(dirty.size());
+    for (size_t i = 0; i < dirty.size(); i++) {
+        ShaderUpdate &update = updates[i];
+        update.shader = dirty[i];
+        if (!_begin_shader_update(update)) {
+            update.shader = nullptr;
+            continue;
+        }
+        batch.push_back({ update.shader->mode, &update.shader->code, &update.actions, &update.shader->path, &update.gen_code, OK });
+    }
+
+    shaders.compiler.compile_batch(batch);
+
+    size_t item = 0;
+    for (ShaderUpdate &update : updates) {
+        if (update.shader) {
+            _finish_shader_update(update, batch[item++].err);
+        }
+    }
 }
 
 void RasterizerStorageGLES3::shader_get_param_list(RenderingEntity p_shader, Vector<PropertyInfo> *p_param_list) const {
@@ -146,6 +146,39 @@ void RasterizerStorageGLES3::skeleton_bone_set_transform(RenderingEntity p_skele
     VSG::ecs->registry.emplace_or_replace<RasterizerSkeletonDirty>(p_skeleton);
 }
 
+void RasterizerStorageGLES3::skeleton_set_bone_transforms(RenderingEntity p_skeleton, Span<const Transform> p_transforms) {
+
+    auto * skeleton = VSG::ecs->try_get<RasterizerSkeletonComponent>(p_skeleton);
+
+    ERR_FAIL_COND(!skeleton);
+    ERR_FAIL_COND(int(p_transforms.size()) > skeleton->size);
+    ERR_FAIL_COND(skeleton->use_2d);
+
+    float *texture = skeleton->skel_texture.data();
+
+    for (int i = 0; i < int(p_transforms.size()); i++) {
+        const Transform &xf = p_transforms[i];
+        float *row = texture + ((i / 256) * 256) * 3 * 4 + (i % 256) * 4;
+
+        row[0] = xf.basis[0].x;
+        row[1] = xf.basis[0].y;
+        row[2] = xf.basis[0].z;
+        row[3] = xf.origin.x;
+        row += 256 * 4;
+        row[0] = xf.basis[1].x;
+        row[1] = xf.basis[1].y;
+        row[2] = xf.basis[1].z;
+        row[3] = xf.origin.y;
+        row += 256 * 4;
+        row[0] = xf.basis[2].x;
+        row[1] = xf.basis[2].y;
+        row[2] = xf.basis[2].z;
+        row[3] = xf.origin.z;
+    }
+
+    VSG::ecs->registry.emplace_or_replace<RasterizerSkeletonDirty>(p_skeleton);
+}
+
 Transform RasterizerStorageGLES3::skeleton_bone_get_transform(RenderingEntity p_skeleton, int p_bone) const {
 
     const auto * skeleton = VSG::ecs->try_get<RasterizerSkeletonComponent>(p_skeleton);
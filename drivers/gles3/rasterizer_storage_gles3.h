@@ -79,9 +79,6 @@ struct RasterizerGLES3ShadersStorage {
     CubemapFilterShaderGLES3 cubemap_filter;
     BlendShapeShaderGLES3 blend_shapes;
     ParticlesShaderGLES3 particles;
-    ShaderCompilerGLES3::IdentifierActions actions_canvas;
-    ShaderCompilerGLES3::IdentifierActions actions_scene;
-    ShaderCompilerGLES3::IdentifierActions actions_particles;
 };
 
 struct RasterizerStorageInfo {
@@ -411,6 +408,7 @@ public:
     int skeleton_get_bone_count(RenderingEntity p_skeleton) const override;
     void skeleton_bone_set_transform(RenderingEntity p_skeleton, int p_bone, const Transform &p_transform) override;
     Transform skeleton_bone_get_transform(RenderingEntity p_skeleton, int p_bone) const override;
+    void skeleton_set_bone_transforms(RenderingEntity p_skeleton, Span<const Transform> p_transforms) override;
     void skeleton_bone_set_transform_2d(RenderingEntity p_skeleton, int p_bone, const Transform2D &p_transform) override;
     Transform2D skeleton_bone_get_transform_2d(RenderingEntity p_skeleton, int p_bone) const override;
     void skeleton_set_base_transform_2d(RenderingEntity p_skeleton, const Transform2D &p_base_transform) override;
@@ -31,6 +31,7 @@
 #include "shader_compiler_gles3.h"
 
 #include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
 #include "core/project_settings.h"
 #include "core/print_string.h"
 #include "core/string_utils.h"
@@ -1136,6 +1137,54 @@ Error ShaderCompilerGLES3::compile(RS::ShaderMode p_mode, const String &p_code,
     return OK;
 }
 
+void ShaderCompilerGLES3::_compile_batch_worker(uint32_t p_worker, Span<BatchItem> p_items) {
+
+    ShaderCompilerGLES3 *compiler = batch_workers[p_worker];
+    while (true) {
+        uint32_t index = batch_next.fetch_add(1, std::memory_order_relaxed);
+        if (index >= p_items.size()) {
+            break;
+        }
+        BatchItem &item = p_items[index];
+        item.err = compiler->compile(item.mode, *item.code, item.actions, *item.path, *item.gen_code);
+    }
+}
+
+void ShaderCompilerGLES3::compile_batch(Span<BatchItem> p_items) {
+
+    if (p_items.size() < 2) {
+        for (BatchItem &item : p_items) {
+            item.err = compile(item.mode, *item.code, item.actions, *item.path, *item.gen_code);
+        }
+        return;
+    }
+
+    if (!batch_pool) {
+        batch_pool = memnew(ThreadWorkPool);
+        batch_pool->init();
+    }
+
+    // Workers are created here rather than on their threads, their constructor reads the project settings.
+    const uint32_t worker_count = MIN(uint32_t(p_items.size()), uint32_t(batch_pool->get_thread_count()));
+    while (batch_workers.size() < worker_count) {
+        batch_workers.push_back(memnew(ShaderCompilerGLES3));
+    }
+
+    batch_next.store(0, std::memory_order_relaxed);
+    batch_pool->do_work(worker_count, this, &ShaderCompilerGLES3::_compile_batch_worker, p_items);
+}
+
+ShaderCompilerGLES3::~ShaderCompilerGLES3() {
+
+    for (ShaderCompilerGLES3 *worker : batch_workers) {
+        memdelete(worker);
+    }
+    if (batch_pool) {
+        batch_pool->finish();
+        memdelete(batch_pool);
+    }
+}
+
 ShaderCompilerGLES3::ShaderCompilerGLES3() {
 
     /** CANVAS ITEM SHADER **/
@@ -35,7 +35,11 @@
 #include "servers/rendering/shader_language.h"
 #include "servers/rendering/shader_types.h"
 #include "servers/rendering_server_enums.h"
- 
+
+#include <atomic>
+
+class ThreadWorkPool;
+
 class ShaderCompilerGLES3 {
 public:
     struct IdentifierActions {
@@ -68,6 +72,17 @@ public:
         bool uses_vertex_time;
     };
 
+    // One shader of a compile_batch() call. Items must not share their actions, the compiler writes the usage
+    // flags and uniforms of each shader through them.
+    struct BatchItem {
+        RS::ShaderMode mode;
+        const String *code;
+        IdentifierActions *actions;
+        const String *path;
+        GeneratedCode *gen_code;
+        Error err;
+    };
+
 private:
     ShaderLanguage parser;
 
@@ -97,8 +112,18 @@ private:
 
     DefaultIdentifierActions actions[int(RenderingServerEnums::ShaderMode::MAX)];
 
+    // batch compilation, every worker thread gets a compiler of its own
+    ThreadWorkPool *batch_pool = nullptr;
+    Vector<ShaderCompilerGLES3 *> batch_workers;
+    std::atomic<uint32_t> batch_next;
+
+    void _compile_batch_worker(uint32_t p_worker, Span<BatchItem> p_items);
+
 public:
     Error compile(RS::ShaderMode p_mode, const String &p_code, IdentifierActions *p_actions, const String &p_path, GeneratedCode &r_gen_code);
+    // Parses and translates every item as compile() would, spread over worker threads. Needs no GL context.
+    void compile_batch(Span<BatchItem> p_items);
 
     ShaderCompilerGLES3();
+    ~ShaderCompilerGLES3();
 };
@@ -0,0 +1,259 @@
+/*************************************************************************/
+/*  io_multiplexer_posix.cpp                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "io_multiplexer_posix.h"
+
+#if defined(UNIX_ENABLED)
+
+#include "net_socket_posix.h"
+
+#include "core/os/memory.h"
+#include "core/string_utils.h"
+
+#include <cerrno>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#else
+#include <poll.h>
+#endif
+
+namespace {
+
+int _get_fd(const Ref<NetSocket> &p_sock) {
+    return int(static_cast<const NetSocketPosix *>(p_sock.get())->get_native_handle());
+}
+
+#if defined(__linux__)
+uint32_t _to_native(uint32_t p_events) {
+    uint32_t native = EPOLLRDHUP;
+    if (p_events & IOMultiplexer::EVENT_IN) {
+        native |= EPOLLIN;
+    }
+    if (p_events & IOMultiplexer::EVENT_OUT) {
+        native |= EPOLLOUT;
+    }
+    return native;
+}
+
+uint32_t _from_native(uint32_t p_native) {
+    uint32_t events = 0;
+    // A peer closing its end is reported as readable, reading is what notices the disconnection.
+    if (p_native & (EPOLLIN | EPOLLRDHUP)) {
+        events |= IOMultiplexer::EVENT_IN;
+    }
+    if (p_native & EPOLLOUT) {
+        events |= IOMultiplexer::EVENT_OUT;
+    }
+    if (p_native & (EPOLLERR | EPOLLHUP)) {
+        events |= IOMultiplexer::EVENT_ERROR | IOMultiplexer::EVENT_IN;
+    }
+    return events;
+}
+#else
+short _to_native(uint32_t p_events) {
+    short native = 0;
+    if (p_events & IOMultiplexer::EVENT_IN) {
+        native |= POLLIN;
+    }
+    if (p_events & IOMultiplexer::EVENT_OUT) {
+        native |= POLLOUT;
+    }
+    return native;
+}
+
+uint32_t _from_native(short p_native) {
+    uint32_t events = 0;
+    if (p_native & POLLIN) {
+        events |= IOMultiplexer::EVENT_IN;
+    }
+    if (p_native & POLLOUT) {
+        events |= IOMultiplexer::EVENT_OUT;
+    }
+    if (p_native & (POLLERR | POLLHUP | POLLNVAL)) {
+        events |= IOMultiplexer::EVENT_ERROR | IOMultiplexer::EVENT_IN;
+    }
+    return events;
+}
+#endif
+
+} // namespace
+
+IOMultiplexer *IOMultiplexerPosix::_create_func() {
+    return memnew(IOMultiplexerPosix);
+}
+
+void IOMultiplexerPosix::make_default() {
+    _create = _create_func;
+}
+
+Error IOMultiplexerPosix::add(const Ref<NetSocket> &p_sock, uint32_t p_events, void *p_userdata) {
+
+    ERR_FAIL_COND_V(!p_sock || !p_sock->is_open(), ERR_INVALID_PARAMETER);
+    ERR_FAIL_COND_V(entries.contains(p_sock.get()), ERR_ALREADY_EXISTS);
+
+    Entry entry;
+    entry.sock = p_sock;
+    entry.fd = _get_fd(p_sock);
+    entry.events = p_events;
+    entry.userdata = p_userdata;
+    entry.index = -1;
+
+#if defined(__linux__)
+    ERR_FAIL_COND_V(epfd == -1, ERR_UNCONFIGURED);
+    epoll_event ev;
+    ev.events = _to_native(p_events);
+    ev.data.ptr = (void *)p_sock.get();
+    ERR_FAIL_COND_V_MSG(epoll_ctl(epfd, EPOLL_CTL_ADD, entry.fd, &ev) != 0, FAILED, "epoll_ctl(ADD) failed, errno: " + itos(errno) + ".");
+#else
+    pollfd pfd;
+    pfd.fd = entry.fd;
+    pfd.events = _to_native(p_events);
+    pfd.revents = 0;
+    entry.index = pfds.size();
+    pfds.push_back(pfd);
+    pfd_owners.push_back(p_sock.get());
+#endif
+
+    entries.emplace(p_sock.get(), eastl::move(entry));
+    return OK;
+}
+
+Error IOMultiplexerPosix::modify(const Ref<NetSocket> &p_sock, uint32_t p_events, void *p_userdata) {
+
+    auto iter = entries.find(p_sock.get());
+    ERR_FAIL_COND_V(iter == entries.end(), ERR_DOES_NOT_EXIST);
+    Entry &entry = iter->second;
+
+    if (entry.events != p_events) {
+#if defined(__linux__)
+        epoll_event ev;
+        ev.events = _to_native(p_events);
+        ev.data.ptr = (void *)p_sock.get();
+        ERR_FAIL_COND_V_MSG(epoll_ctl(epfd, EPOLL_CTL_MOD, entry.fd, &ev) != 0, FAILED, "epoll_ctl(MOD) failed, errno: " + itos(errno) + ".");
+#else
+        pfds[entry.index].events = _to_native(p_events);
+#endif
+    }
+    entry.events = p_events;
+    entry.userdata = p_userdata;
+    return OK;
+}
+
+void IOMultiplexerPosix::remove(const Ref<NetSocket> &p_sock) {
+
+    auto iter = entries.find(p_sock.get());
+    if (iter == entries.end()) {
+        return;
+    }
+
+#if defined(__linux__)
+    // A closed socket already left the epoll set, and its descriptor may belong to a newer socket by now.
+    if (p_sock->is_open()) {
+        epoll_event ev = {};
+        epoll_ctl(epfd, EPOLL_CTL_DEL, iter->second.fd, &ev);
+    }
+#else
+    const int idx = iter->second.index;
+    const int last = pfds.size() - 1;
+    if (idx != last) {
+        pfds[idx] = pfds[last];
+        pfd_owners[idx] = pfd_owners[last];
+        entries[pfd_owners[idx]].index = idx;
+    }
+    pfds.pop_back();
+    pfd_owners.pop_back();
+#endif
+
+    entries.erase(iter);
+}
+
+int IOMultiplexerPosix::get_socket_count() const {
+    return entries.size();
+}
+
+Error IOMultiplexerPosix::wait(Vector<Ready> &r_ready, int p_timeout) {
+
+    r_ready.clear();
+    if (entries.empty()) {
+        return ERR_BUSY;
+    }
+
+#if defined(__linux__)
+    // Level triggered: whatever is not consumed now is reported again by the next wait.
+    ready_events.resize(CLAMP(int(entries.size()), 16, 1024));
+    int count;
+    do {
+        count = epoll_wait(epfd, ready_events.data(), ready_events.size(), p_timeout);
+    } while (count < 0 && errno == EINTR);
+    ERR_FAIL_COND_V_MSG(count < 0, FAILED, "epoll_wait failed, errno: " + itos(errno) + ".");
+
+    for (int i = 0; i < count; i++) {
+        auto iter = entries.find((const NetSocket *)ready_events[i].data.ptr);
+        if (iter == entries.end()) {
+            continue;
+        }
+        r_ready.push_back({ iter->second.userdata, _from_native(ready_events[i].events) });
+    }
+#else
+    int count;
+    do {
+        count = ::poll(pfds.data(), pfds.size(), p_timeout);
+    } while (count < 0 && errno == EINTR);
+    ERR_FAIL_COND_V_MSG(count < 0, FAILED, "poll failed, errno: " + itos(errno) + ".");
+
+    for (int i = 0; i < pfds.size() && int(r_ready.size()) < count; i++) {
+        if (pfds[i].revents == 0) {
+            continue;
+        }
+        r_ready.push_back({ entries[pfd_owners[i]].userdata, _from_native(pfds[i].revents) });
+    }
+#endif
+
+    return r_ready.empty() ? ERR_BUSY : OK;
+}
+
+IOMultiplexerPosix::IOMultiplexerPosix() {
+#if defined(__linux__)
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    ERR_FAIL_COND_MSG(epfd == -1, "epoll_create1 failed, errno: " + itos(errno) + ".");
+#endif
+}
+
+IOMultiplexerPosix::~IOMultiplexerPosix() {
+#if defined(__linux__)
+    if (epfd != -1) {
+        ::close(epfd);
+    }
+#endif
+}
+
+#endif // UNIX_ENABLED
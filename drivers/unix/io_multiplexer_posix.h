@@ -0,0 +1,80 @@
+/*************************************************************************/
+/*  io_multiplexer_posix.h                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#pragma once
+
+#include "core/hash_map.h"
+#include "core/io/io_multiplexer.h"
+
+#if defined(UNIX_ENABLED)
+
+#if defined(__linux__)
+struct epoll_event;
+#else
+struct pollfd;
+#endif
+
+// epoll on Linux, a single poll() over all registered sockets on other unixes.
+class IOMultiplexerPosix : public IOMultiplexer {
+
+    struct Entry {
+        Ref<NetSocket> sock;
+        int fd;
+        uint32_t events;
+        void *userdata;
+        int index; // slot in pfds for the poll() backend
+    };
+
+    HashMap<const NetSocket *, Entry> entries;
+
+#if defined(__linux__)
+    int epfd;
+    Vector<epoll_event> ready_events;
+#else
+    Vector<pollfd> pfds;
+    Vector<const NetSocket *> pfd_owners;
+#endif
+
+    static IOMultiplexer *_create_func();
+
+public:
+    static void make_default();
+
+    Error add(const Ref<NetSocket> &p_sock, uint32_t p_events, void *p_userdata) override;
+    Error modify(const Ref<NetSocket> &p_sock, uint32_t p_events, void *p_userdata) override;
+    void remove(const Ref<NetSocket> &p_sock) override;
+    int get_socket_count() const override;
+    Error wait(Vector<Ready> &r_ready, int p_timeout) override;
+
+    IOMultiplexerPosix();
+    ~IOMultiplexerPosix() override;
+};
+
+#endif // UNIX_ENABLED
@@ -73,6 +73,11 @@ int sock;
 
 #include <netinet/tcp.h>
 
+// recvmmsg/sendmmsg move several datagrams per system call.
+#if defined(__linux__)
+#define NET_SOCKET_MMSG_ENABLED
+#endif
+
 // BSD calls this flag IPV6_JOIN_GROUP
 #if !defined(IPV6_ADD_MEMBERSHIP) && defined(IPV6_JOIN_GROUP)
 #define IPV6_ADD_MEMBERSHIP IPV6_JOIN_GROUP
@@ -641,6 +646,95 @@ Error NetSocketPosix::sendto(const uint8_t *p_buffer, int p_len, int &r_sent, IP
     return OK;
 }
 
+#ifdef NET_SOCKET_MMSG_ENABLED
+Error NetSocketPosix::recvfrom_batch(Datagram *r_datagrams, int p_count, int &r_count) {
+    ERR_FAIL_COND_V(!is_open(), ERR_UNCONFIGURED);
+
+    struct mmsghdr msgs[MMSG_BATCH];
+    struct iovec iovs[MMSG_BATCH];
+    struct sockaddr_storage addrs[MMSG_BATCH];
+
+    r_count = 0;
+    while (r_count < p_count) {
+        const int count = MIN(p_count - r_count, (int)MMSG_BATCH);
+        Datagram *batch = r_datagrams + r_count;
+        for (int i = 0; i < count; i++) {
+            iovs[i].iov_base = batch[i].buffer;
+            iovs[i].iov_len = batch[i].size;
+            memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        // MSG_WAITFORONE: a blocking socket only blocks for the first datagram.
+        const int received = ::recvmmsg(_sock->sock, msgs, count, MSG_WAITFORONE, nullptr);
+        if (received < 0) {
+            if (errno == ENOSYS)
+                return NetSocket::recvfrom_batch(r_datagrams, p_count, r_count);
+            if (r_count > 0)
+                break;
+            return _get_socket_error() == ERR_NET_WOULD_BLOCK ? ERR_BUSY : FAILED;
+        }
+
+        for (int i = 0; i < received; i++) {
+            batch[i].size = msgs[i].msg_len;
+            _set_ip_port(&addrs[i], batch[i].ip, batch[i].port);
+        }
+        r_count += received;
+        if (received < count)
+            break; // Drained.
+    }
+    return OK;
+}
+
+Error NetSocketPosix::sendto_batch(const Datagram *p_datagrams, int p_count, int &r_count) {
+    ERR_FAIL_COND_V(!is_open(), ERR_UNCONFIGURED);
+
+    struct mmsghdr msgs[MMSG_BATCH];
+    struct iovec iovs[MMSG_BATCH];
+    struct sockaddr_storage addrs[MMSG_BATCH];
+
+    r_count = 0;
+    while (r_count < p_count) {
+        const int count = MIN(p_count - r_count, (int)MMSG_BATCH);
+        const Datagram *batch = p_datagrams + r_count;
+        for (int i = 0; i < count; i++) {
+            iovs[i].iov_base = batch[i].buffer;
+            iovs[i].iov_len = batch[i].size;
+            memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+            msgs[i].msg_hdr.msg_name = &addrs[i];
+            msgs[i].msg_hdr.msg_namelen = _set_addr_storage(&addrs[i], batch[i].ip, batch[i].port, _ip_type);
+            msgs[i].msg_hdr.msg_iov = &iovs[i];
+            msgs[i].msg_hdr.msg_iovlen = 1;
+        }
+
+        const int sent = ::sendmmsg(_sock->sock, msgs, count, 0);
+        if (sent < 0) {
+            if (errno == ENOSYS)
+                return NetSocket::sendto_batch(p_datagrams, p_count, r_count);
+            if (r_count > 0)
+                break;
+            return _get_socket_error() == ERR_NET_WOULD_BLOCK ? ERR_BUSY : FAILED;
+        }
+
+        r_count += sent;
+        if (sent < count)
+            break; // Send buffer full.
+    }
+    return OK;
+}
+#else
+Error NetSocketPosix::recvfrom_batch(Datagram *r_datagrams, int p_count, int &r_count) {
+    return NetSocket::recvfrom_batch(r_datagrams, p_count, r_count);
+}
+
+Error NetSocketPosix::sendto_batch(const Datagram *p_datagrams, int p_count, int &r_count) {
+    return NetSocket::sendto_batch(p_datagrams, p_count, r_count);
+}
+#endif
+
 Error NetSocketPosix::set_broadcasting_enabled(bool p_enabled) {
     ERR_FAIL_COND_V(!is_open(), ERR_UNCONFIGURED);
     // IPv6 has no broadcast support.
@@ -726,6 +820,10 @@ bool NetSocketPosix::is_open() const {
     return _sock->sock != SOCK_EMPTY;
 }
 
+int64_t NetSocketPosix::get_native_handle() const {
+    return int64_t(_sock->sock);
+}
+
 int NetSocketPosix::get_available_bytes() const {
 
     ERR_FAIL_COND_V(!is_open(), -1);
@@ -41,6 +41,10 @@ private:
     IP::Type _ip_type;
     bool _is_stream;
 
+    enum {
+        MMSG_BATCH = 64 // datagrams per recvmmsg/sendmmsg call
+    };
+
     enum NetError {
         ERR_NET_WOULD_BLOCK,
         ERR_NET_IS_CONNECTED,
@@ -74,9 +78,12 @@ public:
     Error send(const uint8_t *p_buffer, int p_len, int &r_sent) override;
     Error sendto(const uint8_t *p_buffer, int p_len, int &r_sent, IP_Address p_ip, uint16_t p_port) override;
     Ref<NetSocket> accept(IP_Address &r_ip, uint16_t &r_port) override;
+    Error recvfrom_batch(Datagram *r_datagrams, int p_count, int &r_count) override;
+    Error sendto_batch(const Datagram *p_datagrams, int p_count, int &r_count) override;
 
     bool is_open() const override;
     int get_available_bytes() const override;
+    int64_t get_native_handle() const; // fd on unix, SOCKET on Windows
 
     Error set_broadcasting_enabled(bool p_enabled) override;
     void set_blocking_enabled(bool p_enabled) override;
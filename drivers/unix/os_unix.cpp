@@ -38,6 +38,7 @@
 #include "core/string_utils.inl"
 #include "drivers/unix/dir_access_unix.h"
 #include "drivers/unix/file_access_unix.h"
+#include "drivers/unix/io_multiplexer_posix.h"
 #include "drivers/unix/net_socket_posix.h"
 
 #include "drivers/unix/thread_posix.h"
@@ -133,6 +134,7 @@ void OS_Unix::initialize_core() {
 
 #ifndef NO_NETWORK
     NetSocketPosix::make_default();
+    IOMultiplexerPosix::make_default();
     IP_Unix::make_default();
 #endif
 
@@ -33,12 +33,16 @@
 #include "core/callable_method_pointer.h"
 #include "core/crypto/crypto_core.h"
 #include "core/io/config_file.h"
+#include "core/io/compression.h"
+#include "core/io/file_access_compressed.h"
 #include "core/io/file_access_pack.h" // PACK_HEADER_MAGIC, PACK_FORMAT_VERSION
+#include "core/io/marshalls.h"
 #include "core/io/zip_io.h"
 #include "core/method_bind.h"
 #include "core/object_tooling.h"
 #include "core/os/dir_access.h"
 #include "core/os/file_access.h"
+#include "core/os/thread_work_pool.h"
 #include "core/project_settings.h"
 #include "core/resource/resource_manager.h"
 #include "core/script_language.h"
@@ -60,6 +64,9 @@ IMPL_GDCLASS(EditorExportPlatform)
 IMPL_GDCLASS(EditorExportPlugin)
 IMPL_GDCLASS(EditorExport)
 IMPL_GDCLASS(EditorExportTextSceneToBinaryPlugin)
+
+#define PCK_PADDING 16
+
 namespace {
 
 struct SavedData {
@@ -67,17 +74,51 @@ struct SavedData {
     uint64_t size;
     Vector<uint8_t> md5;
     String path_utf8;
+    uint32_t flags = 0; // PackFileFlags
 
     bool operator<(const SavedData &p_data) const { return path_utf8 < p_data.path_utf8; }
 };
 
+// File waiting to be written to the pack, hashed and compressed on the worker threads.
+struct PackJob {
+    String path;
+    Vector<uint8_t> data;
+    Vector<uint8_t> compressed; // empty when the file is stored as is
+    uint8_t md5[16];
+};
+
+struct PackPayloadKey {
+    uint8_t md5[16];
+    uint64_t size;
+
+    bool operator<(const PackPayloadKey &p_key) const {
+        if (size != p_key.size) {
+            return size < p_key.size;
+        }
+        return memcmp(md5, p_key.md5, 16) < 0;
+    }
+};
+
 struct PackData {
     FileAccess *f;
     Vector<SavedData> file_ofs;
     EditorProgress *ep;
     Vector<SharedObject> *so_files;
+
+    // Files are queued and processed in parallel batches, then written in the order they came in.
+    ThreadWorkPool *pool = nullptr;
+    Vector<PackJob> jobs;
+    uint64_t jobs_size = 0;
+    bool compress = false;
+    // Index in file_ofs of the first file stored with a given content, later identical files point to it.
+    Map<PackPayloadKey, int> payloads;
 };
 
+const int PACK_JOB_BATCH_FILES = 256;
+const uint64_t PACK_JOB_BATCH_SIZE = 64 * 1024 * 1024;
+// Smaller files would not get past the block table and zstd frame overhead.
+const int PACK_COMPRESS_MIN_SIZE = 128;
+
 struct ZipData {
     void *zip;
     EditorProgress *ep;
@@ -92,9 +133,85 @@ int _get_pad(int p_alignment, int p_n) {
 
     return pad;
 }
-} // end of anonymous namespace
 
-#define PCK_PADDING 16
+// Lays p_data out as described for PACK_FILE_COMPRESSED. Leaves r_out empty when that would not make it smaller.
+void _compress_pack_payload(const Vector<uint8_t> &p_data, Vector<uint8_t> &r_out) {
+    const uint32_t block_count = (p_data.size() + PACK_COMPRESSED_BLOCK_SIZE - 1) / PACK_COMPRESSED_BLOCK_SIZE;
+    const uint64_t table_size = 8 + uint64_t(block_count) * 4;
+    const int max_block = Compression::get_max_compressed_buffer_size(PACK_COMPRESSED_BLOCK_SIZE, Compression::MODE_ZSTD);
+
+    r_out.resize(table_size + uint64_t(block_count) * max_block);
+    encode_uint32(PACK_COMPRESSED_BLOCK_SIZE, &r_out[0]);
+    encode_uint32(block_count, &r_out[4]);
+
+    uint64_t ofs = table_size;
+    for (uint32_t i = 0; i < block_count; i++) {
+        const uint64_t from = uint64_t(i) * PACK_COMPRESSED_BLOCK_SIZE;
+        const int size = eastl::min<uint64_t>(PACK_COMPRESSED_BLOCK_SIZE, p_data.size() - from);
+        const int csize = Compression::compress(&r_out[ofs], &p_data[from], size, Compression::MODE_ZSTD);
+        if (csize <= 0 || ofs + csize >= p_data.size()) {
+            r_out.clear();
+            return;
+        }
+        encode_uint32(csize, &r_out[8 + i * 4]);
+        ofs += csize;
+    }
+    r_out.resize(ofs);
+}
+
+struct PackJobProcessor {
+    void process(uint32_t p_index, PackData *p_pd) {
+        PackJob &job = p_pd->jobs[p_index];
+        CryptoCore::md5(job.data.data(), job.data.size(), job.md5);
+        if (p_pd->compress && job.data.size() >= PACK_COMPRESS_MIN_SIZE) {
+            _compress_pack_payload(job.data, job.compressed);
+        }
+    }
+};
+
+void _flush_pack_jobs(PackData *p_pd) {
+    if (p_pd->jobs.empty()) {
+        return;
+    }
+
+    PackJobProcessor processor;
+    p_pd->pool->do_work(p_pd->jobs.size(), &processor, &PackJobProcessor::process, p_pd);
+
+    for (const PackJob &job : p_pd->jobs) {
+        SavedData sd;
+        sd.path_utf8 = job.path;
+        sd.size = job.data.size();
+        sd.md5.assign(job.md5, job.md5 + 16);
+
+        PackPayloadKey key;
+        memcpy(key.md5, job.md5, 16);
+        key.size = sd.size;
+
+        auto E = p_pd->payloads.find(key);
+        if (E != p_pd->payloads.end()) {
+            const SavedData &stored = p_pd->file_ofs[E->second];
+            sd.ofs = stored.ofs;
+            sd.flags = stored.flags;
+        } else {
+            const Vector<uint8_t> &payload = job.compressed.empty() ? job.data : job.compressed;
+            sd.ofs = p_pd->f->get_position();
+            sd.flags = job.compressed.empty() ? 0 : PACK_FILE_COMPRESSED;
+
+            p_pd->f->store_buffer(payload.data(), payload.size());
+            int pad = _get_pad(PCK_PADDING, payload.size());
+            for (int i = 0; i < pad; i++) {
+                p_pd->f->store_8(0);
+            }
+            p_pd->payloads[key] = p_pd->file_ofs.size();
+        }
+
+        p_pd->file_ofs.push_back(sd);
+    }
+
+    p_pd->jobs.clear();
+    p_pd->jobs_size = 0;
+}
+} // end of anonymous namespace
 
 bool EditorExportPreset::_set(const StringName &p_name, const Variant &p_value) {
     if (values.contains(p_name)) {
@@ -398,28 +515,15 @@ Error EditorExportPlatform::_save_pack_file(
         void *p_userdata, StringView p_path, const Vector<uint8_t> &p_data, int p_file, int p_total) {
     PackData *pd = (PackData *)p_userdata;
 
-    SavedData sd;
-    sd.path_utf8 = p_path;
-    sd.ofs = pd->f->get_position();
-    sd.size = p_data.size();
+    PackJob &job = pd->jobs.emplace_back();
+    job.path = p_path;
+    job.data = p_data;
+    pd->jobs_size += p_data.size();
 
-    pd->f->store_buffer(p_data.data(), p_data.size());
-    int pad = _get_pad(PCK_PADDING, sd.size);
-    for (int i = 0; i < pad; i++) {
-        pd->f->store_8(0);
+    if (pd->jobs.size() >= PACK_JOB_BATCH_FILES || pd->jobs_size >= PACK_JOB_BATCH_SIZE) {
+        _flush_pack_jobs(pd);
     }
 
-    {
-        unsigned char hash[16];
-        CryptoCore::md5(p_data.data(), p_data.size(), hash);
-        sd.md5.resize(16);
-        for (int i = 0; i < 16; i++) {
-            sd.md5[i] = hash[i];
-        }
-    }
-
-    pd->file_ofs.push_back(sd);
-
     if (pd->ep->step(TTR("Storing File:") + " " + p_path, 2 + p_file * 100 / p_total, false)) {
         return ERR_SKIP;
     }
@@ -955,6 +1059,24 @@ Error EditorExportPlatform::export_project_files(const Ref<EditorExportPreset> &
         p_func(p_udata, splash, array, idx, total);
     }
 
+    // Compressed resources name their zstd dictionary by id, the game looks it up in the same directory.
+    const String &dictionary_path = FileAccessCompressed::dictionary_path;
+    if (StringUtils::begins_with(dictionary_path, "res://")) {
+        DirAccessRef da(DirAccess::open(dictionary_path));
+        if (da) {
+            da->list_dir_begin();
+            String f;
+            while (!(f = da->get_next()).empty()) {
+                if (!da->current_is_dir() && PathUtils::get_extension(f) == "zdict") {
+                    const String path = PathUtils::plus_file(dictionary_path, f);
+                    Vector<uint8_t> array = FileAccess::get_file_as_array(path);
+                    p_func(p_udata, path, array, idx, total);
+                }
+            }
+            da->list_dir_end();
+        }
+    }
+
     String config_file("project.binary");
     String engine_cfb = PathUtils::plus_file(EditorSettings::get_singleton()->get_cache_dir(), "tmp" + config_file);
     ProjectSettings::get_singleton()->save_custom(engine_cfb, custom_map, custom_list);
@@ -988,13 +1110,22 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, S
         add_message(EXPORT_MESSAGE_ERROR, TTR("Save PCK").asCString(), FormatVE(TTR("Cannot create file \"%s\".").asCString(), tmppath.c_str()));
         return ERR_CANT_CREATE;
     }
+    ThreadWorkPool pool;
+    pool.init();
+
     PackData pd;
     pd.ep = &ep;
     pd.f = ftmp;
     pd.so_files = p_so_files;
+    pd.pool = &pool;
+    pd.compress = GLOBAL_GET("editor/export/compress_pck").as<bool>();
 
     Error err = export_project_files(p_preset, _save_pack_file, &pd, _add_shared_object);
+    if (err == OK) {
+        _flush_pack_jobs(&pd);
+    }
 
+    pool.finish();
     memdelete(ftmp); // close tmp file
 
     if (err != OK) {
@@ -1062,6 +1193,7 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, S
         header_size += 8; // offset to file _with_ header size included
         header_size += 8; // size of file
         header_size += 16; // md5
+        header_size += 4; // flags
     }
 
     int header_padding = _get_pad(PCK_PADDING, header_size);
@@ -1079,6 +1211,7 @@ Error EditorExportPlatform::save_pack(const Ref<EditorExportPreset> &p_preset, S
         f->store_64(pd.file_ofs[i].ofs + header_padding + header_size);
         f->store_64(pd.file_ofs[i].size); // pay attention here, this is where file is
         f->store_buffer(pd.file_ofs[i].md5.data(), 16); // also save md5 for file
+        f->store_32(pd.file_ofs[i].flags);
     }
 
     for (int i = 0; i < header_padding; i++) {
@@ -1484,6 +1617,8 @@ EditorExport::EditorExport() {
 
     singleton = this;
     set_process(true);
+
+    GLOBAL_DEF("editor/export/compress_pck", true);
 }
 
 EditorExport::~EditorExport() {}
@@ -190,6 +190,11 @@ static int frame_delay = 0;
 static bool disable_render_loop = false;
 static int fixed_fps = -1;
 static bool print_fps = false;
+static String metrics_export;
+#ifdef TRACE_PROFILER_ENABLE
+static int trace_frames = 0;
+static float trace_spike_msec = 0;
+#endif
 
 /* Helper methods */
 
@@ -348,6 +353,12 @@ static void print_help(const String &p_binary) {
     OS::get_singleton()->print("  --disable-crash-handler          Disable crash handler when supported by the platform code.\n");
     OS::get_singleton()->print("  --fixed-fps <fps>                Force a fixed number of frames per second. This setting disables real-time synchronization.\n");
     OS::get_singleton()->print("  --print-fps                      Print the frames per second to the stdout.\n");
+    OS::get_singleton()->print("  --metrics-export <target>        Periodically write performance metrics as JSON lines to a file or to udp://<host>:<port>.\n");
+#ifdef TRACE_PROFILER_ENABLE
+    OS::get_singleton()->print("  --trace-frames <n>               Record profiling scopes for <n> frames, then write them as a Chrome trace.\n");
+    OS::get_singleton()->print("  --trace-spike <ms>               Keep recording profiling scopes and write a trace whenever a frame takes longer than <ms> milliseconds.\n");
+    OS::get_singleton()->print("  --trace-file <path>              Path of the written trace (default 'trace.json').\n");
+#endif
     OS::get_singleton()->print("\n");
 
     OS::get_singleton()->print("Standalone tools:\n");
@@ -1018,6 +1029,40 @@ Error Main::setup(bool p_second_phase) {
             }
         } else if (*I == "--print-fps") {
             print_fps = true;
+        } else if (*I == "--metrics-export") {
+            if (N != args.end()) {
+                metrics_export = *N;
+                ++N;
+            } else {
+                os->print("Missing metrics-export argument, aborting.\n");
+                goto error;
+            }
+#ifdef TRACE_PROFILER_ENABLE
+        } else if (*I == "--trace-frames") {
+            if (N != args.end()) {
+                trace_frames = StringUtils::to_int(*N);
+                ++N;
+            } else {
+                os->print("Missing trace-frames argument, aborting.\n");
+                goto error;
+            }
+        } else if (*I == "--trace-spike") {
+            if (N != args.end()) {
+                trace_spike_msec = StringUtils::to_float(*N);
+                ++N;
+            } else {
+                os->print("Missing trace-spike argument, aborting.\n");
+                goto error;
+            }
+        } else if (*I == "--trace-file") {
+            if (N != args.end()) {
+                TraceProfiler::set_output_path(*N);
+                ++N;
+            } else {
+                os->print("Missing trace-file argument, aborting.\n");
+                goto error;
+            }
+#endif
         } else if (*I == "--disable-crash-handler") {
             os->disable_crash_handler();
         } else if (*I == "--skip-breakpoints") {
@@ -1028,6 +1073,12 @@ Error Main::setup(bool p_second_phase) {
 
         I = N;
     }
+#ifdef TRACE_PROFILER_ENABLE
+    if (trace_frames > 0 || trace_spike_msec > 0) {
+        TraceProfiler::set_spike_threshold_usec(uint64_t(trace_spike_msec * 1000));
+        TraceProfiler::start(trace_frames);
+    }
+#endif
 #ifdef TOOLS_ENABLED
     if (editor && project_manager) {
         os->print("Error: Command line arguments implied opening both editor and project manager, which is not possible. Aborting.\n");
@@ -1332,6 +1383,15 @@ Error Main::setup(bool p_second_phase) {
     GLOBAL_DEF("physics/common/enable_pause_aware_picking", false);
 
     T_GLOBAL_DEF("debug/settings/stdout/print_fps", false);
+    T_GLOBAL_DEF<String>("debug/settings/metrics/export_target", "");
+    T_GLOBAL_DEF<float>("debug/settings/metrics/export_interval_sec", 1.0f);
+    project_settings->set_custom_property_info("debug/settings/metrics/export_interval_sec", PropertyInfo(VariantType::FLOAT, "debug/settings/metrics/export_interval_sec", PropertyHint::Range, "0.05,60,0.05,or_greater"));
+    if (metrics_export.empty()) {
+        metrics_export = T_GLOBAL_GET<String>("debug/settings/metrics/export_target");
+    }
+    if (!metrics_export.empty()) {
+        s_state.performance->set_metrics_export(metrics_export, T_GLOBAL_GET<float>("debug/settings/metrics/export_interval_sec"));
+    }
     T_GLOBAL_DEF("debug/settings/stdout/verbose_stdout", false);
 
     if (!OS::get_singleton()->_verbose_stdout) { // Not manually overridden.
@@ -1579,6 +1639,8 @@ Error Main::setup2() {
     register_server_singletons();
 
     register_driver_types();
+    // All engine classes are in, from here on method and property lookups go through flattened tables.
+    ClassDB::build_dispatch_tables();
     const Vector<String> & args(OS::get_singleton()->get_cmdline_args());
     const auto refl_idx = args.index_of("--gen-reflection");
     bool reflection_requested = refl_idx != args.size();
@@ -2229,7 +2291,9 @@ bool perform_physic_steps(float scaled_frame_slice, MainFrameTime advance, uint6
         message_queue->flush();
 
         physicsServer3D->step(scaled_frame_slice);
+        uint64_t navigation_begin = OS::get_singleton()->get_ticks_usec();
         NavigationServer::get_singleton_mut()->process(scaled_frame_slice);
+        s_state.performance->record_metric(Performance::METRIC_NAVIGATION_PROCESS_TIME, USEC_TO_SEC(OS::get_singleton()->get_ticks_usec() - navigation_begin));
 
         physicsServer2D->end_sync();
         physicsServer2D->step(scaled_frame_slice);
@@ -2238,6 +2302,7 @@ bool perform_physic_steps(float scaled_frame_slice, MainFrameTime advance, uint6
 
         physics_process_ticks = M_MAX(physics_process_ticks, OS::get_singleton()->get_ticks_usec() - physics_begin); // keep the largest one for reference
         physics_process_max = M_MAX(OS::get_singleton()->get_ticks_usec() - physics_begin, physics_process_max);
+        s_state.performance->record_metric(Performance::METRIC_PHYSICS_STEP_TIME, USEC_TO_SEC(OS::get_singleton()->get_ticks_usec() - physics_begin));
         Engine::get_singleton()->end_physics_frame();
     }
     return false;
@@ -2319,6 +2384,7 @@ bool Main::iteration() {
     }
     rendering_server_callbacks->flush();
     message_queue->flush();
+    s_state.performance->record_metric(Performance::METRIC_MESSAGE_QUEUE_FLUSH_TIME, USEC_TO_SEC(message_queue->get_last_flush_usec()));
 
     RenderingServer::sync_thread(); //sync if still drawing from previous frames.
 
@@ -2346,6 +2412,10 @@ bool Main::iteration() {
     idle_process_ticks = OS::get_singleton()->get_ticks_usec() - idle_begin;
     idle_process_max = M_MAX(idle_process_ticks, idle_process_max);
     uint64_t frame_time = OS::get_singleton()->get_ticks_usec() - raw_ticks_at_start;
+    s_state.performance->process_frame(frame_time);
+#ifdef TRACE_PROFILER_ENABLE
+    TraceProfiler::end_frame(frame_time);
+#endif
 
     for (int i = 0; i < ScriptServer::get_language_count(); i++) {
         ScriptServer::get_language(i)->frame();
@@ -2440,6 +2510,11 @@ void Main::cleanup(bool p_force) {
     memdelete(message_queue);
     memdelete(rendering_server_callbacks);
 
+#ifdef TRACE_PROFILER_ENABLE
+    TraceProfiler::finish();
+    TraceProfiler::cleanup();
+#endif
+
     if (script_debugger) {
         if (use_debug_profiler) {
             script_debugger->profiling_end();
@@ -31,24 +31,90 @@
 #include "performance.h"
 
 #include "core/ecs_registry.h"
+#include "core/io/ip.h"
+#include "core/io/packet_peer_udp.h"
 #include "core/message_queue.h"
 #include "core/method_bind.h"
 #include "core/method_enum_caster.h"
 #include "core/object_db.h"
+#include "core/os/file_access.h"
 #include "core/os/os.h"
+#include "core/string_formatter.h"
+#include "core/string_utils.h"
 #include "scene/main/node.h"
 #include "scene/main/scene_tree.h"
 #include "servers/audio_server.h"
 #include "servers/physics_server_2d.h"
 #include "servers/physics_server_3d.h"
 #include "servers/rendering_server.h"
-#include "core/method_enum_caster.h"
+
+#include <cmath>
 
 Performance *Performance::singleton = nullptr;
 
 IMPL_GDCLASS(Performance)
 
 VARIANT_ENUM_CAST(Performance::Monitor);
+VARIANT_ENUM_CAST(Performance::MetricType);
+VARIANT_ENUM_CAST(Performance::BuiltinMetric);
+
+struct Performance::Metric {
+    StringName name;
+    MetricType type;
+    std::atomic<int64_t> counter { 0 };
+    std::atomic<double> value { 0 };
+    // Histograms only.
+    std::atomic<uint32_t> *buckets = nullptr;
+    std::atomic<uint64_t> samples { 0 };
+    std::atomic<double> max { 0 };
+};
+
+struct Performance::HistogramSnapshot {
+    uint32_t buckets[HISTOGRAM_BUCKETS];
+    uint64_t samples;
+    double sum;
+    double max;
+
+    static int bucket(double p_value) {
+        if (!(p_value > 0)) {
+            return 0;
+        }
+        const double index = std::floor((std::log2(p_value) - HISTOGRAM_MIN_EXPONENT) * HISTOGRAM_BUCKETS_PER_OCTAVE);
+        return int(CLAMP(index, 0.0, double(HISTOGRAM_BUCKETS - 1)));
+    }
+
+    double percentile(float p_percentile) const {
+        if (samples == 0) {
+            return 0;
+        }
+        const uint64_t rank = M_MAX(uint64_t(1), uint64_t(std::ceil(CLAMP(p_percentile, 0.0f, 1.0f) * samples)));
+        uint64_t seen = 0;
+        for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                // Upper edge of the bucket, never above the largest value actually seen.
+                return MIN(max, std::exp2(double(i + 1) / HISTOGRAM_BUCKETS_PER_OCTAVE + HISTOGRAM_MIN_EXPONENT));
+            }
+        }
+        return max;
+    }
+};
+
+namespace {
+
+void atomic_add(std::atomic<double> &r_target, double p_value) {
+    double current = r_target.load(std::memory_order_relaxed);
+    while (!r_target.compare_exchange_weak(current, current + p_value, std::memory_order_relaxed)) {
+    }
+}
+
+void atomic_max(std::atomic<double> &r_target, double p_value) {
+    double current = r_target.load(std::memory_order_relaxed);
+    while (current < p_value && !r_target.compare_exchange_weak(current, p_value, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
 
 void Performance::_bind_methods() {
 
@@ -83,8 +149,33 @@ void Performance::_bind_methods() {
     BIND_ENUM_CONSTANT(PHYSICS_3D_COLLISION_PAIRS);
     BIND_ENUM_CONSTANT(PHYSICS_3D_ISLAND_COUNT);
     BIND_ENUM_CONSTANT(AUDIO_OUTPUT_LATENCY);
+    BIND_ENUM_CONSTANT(TIME_MESSAGE_QUEUE_FLUSH);
 
     BIND_ENUM_CONSTANT(MONITOR_MAX);
+
+    SE_BIND_METHOD(Performance,register_metric);
+    SE_BIND_METHOD(Performance,find_metric);
+    SE_BIND_METHOD(Performance,get_metric_name);
+    SE_BIND_METHOD(Performance,get_metric_type);
+    SE_BIND_METHOD(Performance,get_metric_count);
+    MethodBinder::bind_method(D_METHOD("get_metric_names"), &Performance::_get_metric_names);
+    MethodBinder::bind_method(D_METHOD("increment_metric", {"id", "amount"}), &Performance::increment_metric, {DEFVAL(1)});
+    SE_BIND_METHOD(Performance,set_metric);
+    SE_BIND_METHOD(Performance,record_metric);
+    SE_BIND_METHOD(Performance,get_metric);
+    SE_BIND_METHOD(Performance,get_metric_percentile);
+    MethodBinder::bind_method(D_METHOD("get_metrics_json", {"include_monitors"}), &Performance::get_metrics_json, {DEFVAL(true)});
+    MethodBinder::bind_method(D_METHOD("set_metrics_export", {"target", "interval_sec"}), &Performance::set_metrics_export, {DEFVAL(1.0f)});
+    SE_BIND_METHOD(Performance,get_metrics_export);
+
+    BIND_ENUM_CONSTANT(METRIC_COUNTER);
+    BIND_ENUM_CONSTANT(METRIC_GAUGE);
+    BIND_ENUM_CONSTANT(METRIC_HISTOGRAM);
+
+    BIND_ENUM_CONSTANT(METRIC_FRAME_TIME);
+    BIND_ENUM_CONSTANT(METRIC_PHYSICS_STEP_TIME);
+    BIND_ENUM_CONSTANT(METRIC_NAVIGATION_PROCESS_TIME);
+    BIND_ENUM_CONSTANT(METRIC_MESSAGE_QUEUE_FLUSH_TIME);
 }
 
 float Performance::_get_node_count() const {
@@ -130,6 +221,7 @@ StringView Performance::get_monitor_name(Monitor p_monitor) const {
         "physics_3d/collision_pairs",
         "physics_3d/islands",
         "audio/output_latency",
+        "time/message_queue_flush",
 
     };
 
@@ -201,6 +293,8 @@ float Performance::get_monitor(Monitor p_monitor) const {
             return PhysicsServer3D::get_singleton()->get_process_info(PhysicsServer3D::INFO_ISLAND_COUNT);
         case AUDIO_OUTPUT_LATENCY:
             return AudioServer::get_singleton()->get_output_latency();
+        case TIME_MESSAGE_QUEUE_FLUSH:
+            return MessageQueue::get_singleton()->get_last_flush_usec() / 1000000.0f;
 
         default: {
         }
@@ -245,6 +339,7 @@ Performance::MonitorType Performance::get_monitor_type(Monitor p_monitor) const
         MONITOR_TYPE_QUANTITY,
         MONITOR_TYPE_QUANTITY,
         MONITOR_TYPE_TIME,
+        MONITOR_TYPE_TIME,
 
     };
 
@@ -261,9 +356,284 @@ void Performance::set_physics_process_time(float p_pt) {
     _physics_process_time = p_pt;
 }
 
+int Performance::register_metric(const StringName &p_name, MetricType p_type) {
+
+    ERR_FAIL_COND_V(p_name.empty(), -1);
+    MutexLock lock(metrics_mutex);
+
+    auto existing = metric_ids.find(p_name);
+    if (existing != metric_ids.end()) {
+        ERR_FAIL_COND_V_MSG(metrics[existing->second].type != p_type, -1,
+                "Metric '" + String(p_name) + "' is already registered with a different type.");
+        return existing->second;
+    }
+
+    const int id = metric_count.load(std::memory_order_relaxed);
+    ERR_FAIL_COND_V_MSG(id >= MAX_METRICS, -1, "Too many metrics registered, can't add '" + String(p_name) + "'.");
+
+    Metric &metric = metrics[id];
+    metric.name = p_name;
+    metric.type = p_type;
+    if (p_type == METRIC_HISTOGRAM) {
+        metric.buckets = memnew_arr(std::atomic<uint32_t>, HISTOGRAM_BUCKETS);
+        for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+            metric.buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+    metric_ids[p_name] = id;
+    metric_count.store(id + 1, std::memory_order_release);
+    return id;
+}
+
+int Performance::find_metric(const StringName &p_name) const {
+
+    MutexLock lock(metrics_mutex);
+    auto iter = metric_ids.find(p_name);
+    return iter != metric_ids.end() ? iter->second : -1;
+}
+
+StringName Performance::get_metric_name(int p_id) const {
+
+    ERR_FAIL_INDEX_V(p_id, get_metric_count(), StringName());
+    return metrics[p_id].name;
+}
+
+Performance::MetricType Performance::get_metric_type(int p_id) const {
+
+    ERR_FAIL_INDEX_V(p_id, get_metric_count(), METRIC_GAUGE);
+    return metrics[p_id].type;
+}
+
+Array Performance::_get_metric_names() const {
+
+    Array names;
+    const int count = get_metric_count();
+    for (int i = 0; i < count; i++) {
+        names.push_back(metrics[i].name);
+    }
+    return names;
+}
+
+Performance::Metric *Performance::_get_metric(int p_id, MetricType p_type) const {
+
+    ERR_FAIL_INDEX_V(p_id, get_metric_count(), nullptr);
+    ERR_FAIL_COND_V_MSG(metrics[p_id].type != p_type, nullptr, "Metric '" + String(metrics[p_id].name) + "' has a different type.");
+    return &metrics[p_id];
+}
+
+void Performance::increment_metric(int p_id, int64_t p_amount) {
+
+    Metric *metric = _get_metric(p_id, METRIC_COUNTER);
+    if (metric) {
+        metric->counter.fetch_add(p_amount, std::memory_order_relaxed);
+    }
+}
+
+void Performance::set_metric(int p_id, double p_value) {
+
+    Metric *metric = _get_metric(p_id, METRIC_GAUGE);
+    if (metric) {
+        metric->value.store(p_value, std::memory_order_relaxed);
+    }
+}
+
+void Performance::record_metric(int p_id, double p_value) {
+
+    Metric *metric = _get_metric(p_id, METRIC_HISTOGRAM);
+    if (!metric) {
+        return;
+    }
+    metric->buckets[HistogramSnapshot::bucket(p_value)].fetch_add(1, std::memory_order_relaxed);
+    metric->samples.fetch_add(1, std::memory_order_relaxed);
+    atomic_add(metric->value, p_value);
+    atomic_max(metric->max, p_value);
+}
+
+void Performance::_take_histogram(Metric &r_metric, HistogramSnapshot &r_snapshot, bool p_reset) const {
+
+    // Samples recorded while this runs may land in either window, none are lost.
+    r_snapshot.samples = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        r_snapshot.buckets[i] = p_reset ? r_metric.buckets[i].exchange(0, std::memory_order_relaxed) : r_metric.buckets[i].load(std::memory_order_relaxed);
+        r_snapshot.samples += r_snapshot.buckets[i];
+    }
+    if (p_reset) {
+        r_metric.samples.store(0, std::memory_order_relaxed);
+        r_snapshot.sum = r_metric.value.exchange(0, std::memory_order_relaxed);
+        r_snapshot.max = r_metric.max.exchange(0, std::memory_order_relaxed);
+    } else {
+        r_snapshot.sum = r_metric.value.load(std::memory_order_relaxed);
+        r_snapshot.max = r_metric.max.load(std::memory_order_relaxed);
+    }
+}
+
+double Performance::get_metric(int p_id) const {
+
+    ERR_FAIL_INDEX_V(p_id, get_metric_count(), 0);
+    const Metric &metric = metrics[p_id];
+    switch (metric.type) {
+        case METRIC_COUNTER:
+            return double(metric.counter.load(std::memory_order_relaxed));
+        case METRIC_GAUGE:
+            return metric.value.load(std::memory_order_relaxed);
+        case METRIC_HISTOGRAM: {
+            const uint64_t samples = metric.samples.load(std::memory_order_relaxed);
+            return samples ? metric.value.load(std::memory_order_relaxed) / samples : 0.0;
+        }
+    }
+    return 0;
+}
+
+double Performance::get_metric_percentile(int p_id, float p_percentile) const {
+
+    Metric *metric = _get_metric(p_id, METRIC_HISTOGRAM);
+    if (!metric) {
+        return 0;
+    }
+    HistogramSnapshot snapshot;
+    _take_histogram(*metric, snapshot, false);
+    return snapshot.percentile(p_percentile);
+}
+
+String Performance::get_metrics_json(bool p_include_monitors) const {
+
+    return _metrics_json(p_include_monitors, false);
+}
+
+// Only the exporter resets histograms, so that every exported line covers the samples since the previous one.
+String Performance::_metrics_json(bool p_include_monitors, bool p_reset_histograms) const {
+
+    String json = FormatVE("{\"time\":%.3f,\"frame\":%llu", OS::get_singleton()->get_subsecond_unix_time(),
+            (unsigned long long)Engine::get_singleton()->get_idle_frames());
+
+    if (p_include_monitors) {
+        json += ",\"monitors\":{";
+        for (int i = 0; i < MONITOR_MAX; i++) {
+            json += FormatVE("%s\"%s\":%.9g", i ? "," : "", get_monitor_name(Monitor(i)).data(), get_monitor(Monitor(i)));
+        }
+        json += "}";
+    }
+
+    json += ",\"metrics\":{";
+    const int count = get_metric_count();
+    HistogramSnapshot snapshot;
+    for (int i = 0; i < count; i++) {
+        Metric &metric = metrics[i];
+        json += FormatVE("%s\"%s\":", i ? "," : "", StringUtils::json_escape(metric.name.asCString()).c_str());
+        switch (metric.type) {
+            case METRIC_COUNTER:
+                json += FormatVE("%lld", (long long)metric.counter.load(std::memory_order_relaxed));
+                break;
+            case METRIC_GAUGE:
+                json += FormatVE("%.9g", metric.value.load(std::memory_order_relaxed));
+                break;
+            case METRIC_HISTOGRAM:
+                _take_histogram(metric, snapshot, p_reset_histograms);
+                json += FormatVE("{\"count\":%llu,\"mean\":%.9g,\"p50\":%.9g,\"p95\":%.9g,\"p99\":%.9g,\"max\":%.9g}",
+                        (unsigned long long)snapshot.samples, snapshot.samples ? snapshot.sum / snapshot.samples : 0.0,
+                        snapshot.percentile(0.5f), snapshot.percentile(0.95f), snapshot.percentile(0.99f), snapshot.max);
+                break;
+        }
+    }
+    json += "}}";
+    return json;
+}
+
+void Performance::_close_metrics_export() {
+
+    if (export_file) {
+        memdelete(export_file);
+        export_file = nullptr;
+    }
+    export_peer.unref();
+    export_target.clear();
+}
+
+Error Performance::set_metrics_export(StringView p_target, float p_interval_sec) {
+
+    _close_metrics_export();
+    if (p_target.empty()) {
+        return OK;
+    }
+    ERR_FAIL_COND_V(p_interval_sec <= 0, ERR_INVALID_PARAMETER);
+
+    if (StringUtils::begins_with(p_target, "udp://")) {
+        StringView address = p_target.substr(6);
+        auto colon = address.rfind(':');
+        ERR_FAIL_COND_V_MSG(colon == StringView::npos, ERR_INVALID_PARAMETER, "Metrics export target '" + String(p_target) + "' has no port.");
+        const int port = StringUtils::to_int(address.substr(colon + 1));
+        IP_Address ip = IP::get_singleton()->resolve_hostname(address.substr(0, colon));
+        ERR_FAIL_COND_V_MSG(!ip.is_valid() || port <= 0, ERR_CANT_RESOLVE, "Can't resolve metrics export target '" + String(p_target) + "'.");
+        export_peer = make_ref_counted<PacketPeerUDP>();
+        export_peer->set_dest_address(ip, port);
+    } else {
+        Error err;
+        // Appended to, so restarts keep the history of a long-running server.
+        if (FileAccess::exists(p_target)) {
+            export_file = FileAccess::open(p_target, FileAccess::READ_WRITE, &err);
+            if (export_file) {
+                export_file->seek_end();
+            }
+        } else {
+            export_file = FileAccess::open(p_target, FileAccess::WRITE, &err);
+        }
+        ERR_FAIL_COND_V_MSG(!export_file, err, "Can't open metrics export file '" + String(p_target) + "'.");
+    }
+
+    export_target = p_target;
+    export_interval_usec = uint64_t(p_interval_sec * 1000000.0f);
+    last_export_usec = OS::get_singleton()->get_ticks_usec();
+    return OK;
+}
+
+void Performance::_export_metrics() {
+
+    String line = _metrics_json(true, true) + "\n";
+    if (export_file) {
+        export_file->store_string(line);
+        export_file->flush();
+    } else if (export_peer) {
+        export_peer->put_packet((const uint8_t *)line.data(), line.size());
+    }
+}
+
+void Performance::process_frame(uint64_t p_frame_usec) {
+
+    record_metric(METRIC_FRAME_TIME, USEC_TO_SEC(p_frame_usec));
+
+    if (export_target.empty()) {
+        return;
+    }
+    const uint64_t now = OS::get_singleton()->get_ticks_usec();
+    if (now - last_export_usec >= export_interval_usec) {
+        last_export_usec = now;
+        _export_metrics();
+    }
+}
+
 Performance::Performance() {
 
     _process_time = 0;
     _physics_process_time = 0;
+    metrics = memnew_arr(Metric, MAX_METRICS);
     singleton = this;
+
+    register_metric("time/frame", METRIC_HISTOGRAM);
+    register_metric("time/physics_step", METRIC_HISTOGRAM);
+    register_metric("time/navigation_process", METRIC_HISTOGRAM);
+    register_metric("time/message_queue_flush", METRIC_HISTOGRAM);
+}
+
+Performance::~Performance() {
+
+    _close_metrics_export();
+    for (int i = 0; i < MAX_METRICS; i++) {
+        if (metrics[i].buckets) {
+            memdelete_arr(metrics[i].buckets);
+        }
+    }
+    memdelete_arr(metrics);
+    if (singleton == this) {
+        singleton = nullptr;
+    }
 }
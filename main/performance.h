@@ -30,7 +30,14 @@
 
 #pragma once
 
+#include "core/hash_map.h"
 #include "core/object.h"
+#include "core/os/mutex.h"
+#include "core/reference.h"
+#include "core/string.h"
+
+class FileAccess;
+class PacketPeerUDP;
 
 #define PERF_WARN_OFFLINE_FUNCTION
 #define PERF_WARN_PROCESS_SYNC
@@ -46,6 +53,54 @@ class GODOT_EXPORT Performance : public Object {
     float _process_time;
     float _physics_process_time;
 
+public:
+    enum MetricType {
+        METRIC_COUNTER,
+        METRIC_GAUGE,
+        METRIC_HISTOGRAM
+    };
+
+    // Registered by the constructor, in this order.
+    enum BuiltinMetric {
+        METRIC_FRAME_TIME,
+        METRIC_PHYSICS_STEP_TIME,
+        METRIC_NAVIGATION_PROCESS_TIME,
+        METRIC_MESSAGE_QUEUE_FLUSH_TIME,
+        METRIC_BUILTIN_MAX
+    };
+
+private:
+    enum {
+        MAX_METRICS = 256,
+        // Histograms use log-spaced buckets, four per power of two starting at 2^-20 (about a microsecond when the
+        // values are seconds), so percentiles are within 19% of the recorded values.
+        HISTOGRAM_BUCKETS = 256,
+        HISTOGRAM_BUCKETS_PER_OCTAVE = 4,
+        HISTOGRAM_MIN_EXPONENT = -20
+    };
+
+    struct Metric;
+    struct HistogramSnapshot;
+
+    // Slots never move and are published through metric_count, so updates need no lock.
+    Metric *metrics;
+    std::atomic<int> metric_count { 0 };
+    HashMap<StringName, int> metric_ids;
+    mutable Mutex metrics_mutex;
+
+    String export_target;
+    uint64_t export_interval_usec = 1000000;
+    uint64_t last_export_usec = 0;
+    FileAccess *export_file = nullptr;
+    Ref<PacketPeerUDP> export_peer;
+
+    Metric *_get_metric(int p_id, MetricType p_type) const;
+    void _take_histogram(Metric &r_metric, HistogramSnapshot &r_snapshot, bool p_reset) const;
+    String _metrics_json(bool p_include_monitors, bool p_reset_histograms) const;
+    void _close_metrics_export();
+    void _export_metrics();
+    Array _get_metric_names() const;
+
 public:
     enum Monitor {
 
@@ -81,6 +136,7 @@ public:
         PHYSICS_3D_ISLAND_COUNT,
         //physics
         AUDIO_OUTPUT_LATENCY,
+        TIME_MESSAGE_QUEUE_FLUSH,
         MONITOR_MAX
     };
 
@@ -98,8 +154,33 @@ public:
     void set_process_time(float p_pt);
     void set_physics_process_time(float p_pt);
 
+    // Custom metrics. Registering takes a lock, updating a registered metric by id is lock-free from any thread.
+    int register_metric(const StringName &p_name, MetricType p_type);
+    int find_metric(const StringName &p_name) const;
+    StringName get_metric_name(int p_id) const;
+    MetricType get_metric_type(int p_id) const;
+    int get_metric_count() const { return metric_count.load(std::memory_order_acquire); }
+
+    void increment_metric(int p_id, int64_t p_amount = 1);
+    void set_metric(int p_id, double p_value);
+    void record_metric(int p_id, double p_value);
+
+    // Counter total, gauge value, or the mean of a histogram's samples since the last export.
+    double get_metric(int p_id) const;
+    double get_metric_percentile(int p_id, float p_percentile) const;
+
+    // One JSON object with every metric, histograms as of the last export.
+    String get_metrics_json(bool p_include_monitors = true) const;
+    // p_target is a file path, appended to, or udp://<host>:<port>. An empty target stops exporting.
+    Error set_metrics_export(StringView p_target, float p_interval_sec = 1.0f);
+    const String &get_metrics_export() const { return export_target; }
+
+    // Called by the main loop once per frame.
+    void process_frame(uint64_t p_frame_usec);
+
     static Performance *get_singleton() { return singleton; }
 
     Performance();
+    ~Performance() override;
 };
 
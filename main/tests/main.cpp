@@ -1193,6 +1193,8 @@ Error Main::setup2(Thread::ID p_main_tid_override) {
     register_server_singletons();
 
     register_driver_types();
+    // All engine classes are in, from here on method and property lookups go through flattened tables.
+    ClassDB::build_dispatch_tables();
 
     // This loads global classes, so it must happen before custom loaders and savers are registered
     ScriptServer::init_languages();
@@ -0,0 +1,217 @@
+/*************************************************************************/
+/*  test_canvas_cull.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_canvas_cull.h"
+
+#include "core/math/random_pcg.h"
+#include "core/os/os.h"
+#include "core/string_formatter.h"
+#include "servers/rendering/rendering_server_canvas.h"
+#include "servers/rendering/rendering_server_globals.h"
+
+namespace TestCanvasCull {
+
+// A large 2D map seen through a small viewport: cost of walking the canvas per frame, with a handful of sprites
+// moving every frame, and whether exactly the sprites on screen reach the rasterizer.
+
+namespace {
+
+const int GRID_W = 400;
+const int GRID_H = 250;
+const real_t SPACING = 32;
+const Rect2 SPRITE_RECT(-8, -8, 16, 16);
+
+// Stands in for the canvas rasterizer, counts what it is given and checks it arrives sorted by y.
+class CountingCanvas : public RasterizerCanvas {
+public:
+    int drawn = 0;
+    bool y_ordered = true;
+
+    RenderingEntity light_internal_create() override { return entt::null; }
+    void light_internal_update(RenderingEntity p_rid, RasterizerCanvasLight3DComponent *p_light) override {}
+    void light_internal_free(RenderingEntity p_rid) override {}
+
+    void canvas_begin() override {}
+    void canvas_end() override {}
+
+    void canvas_render_items(Dequeue<Item *> &p_item_list, int p_z, const Color &p_modulate,
+            Span<RasterizerCanvasLight3DComponent *> p_light, const Transform2D &p_base_transform) override {
+        drawn += p_item_list.size();
+        real_t last_y = -1e20f;
+        for (const Item *item : p_item_list) {
+            const real_t y = item->final_transform.elements[2].y;
+            // Nearly equal y values keep their draw index order.
+            y_ordered = y_ordered && y >= last_y - 0.1f;
+            last_y = y;
+        }
+    }
+    void canvas_debug_viewport_shadows(Span<RasterizerCanvasLight3DComponent *> p_lights_with_shadow) override {}
+    void canvas_light_shadow_buffer_update(RenderingEntity p_buffer, const Transform2D &p_light_xform,
+            int p_light_mask, float p_near, float p_far, RenderingEntity p_occluders,
+            CameraMatrix *p_xform_cache) override {}
+    void reset_canvas() override {}
+    void draw_window_margins(int *p_margins, RenderingEntity *p_margin_textures) override {}
+};
+
+struct Map {
+    RenderingEntity canvas;
+    RenderingEntity root;
+    Vector<RenderingEntity> sprites;
+    Vector<Vector2> positions;
+};
+
+Map build(bool p_sort_y) {
+
+    RenderingServerCanvas *rs = VSG::canvas;
+    Map map;
+    map.canvas = rs->canvas_create();
+    map.root = rs->canvas_item_create();
+    rs->canvas_item_set_parent(map.root, map.canvas);
+    rs->canvas_item_set_sort_children_by_y(map.root, p_sort_y);
+
+    for (int y = 0; y < GRID_H; y++) {
+        for (int x = 0; x < GRID_W; x++) {
+            const Vector2 pos(x * SPACING, y * SPACING);
+            RenderingEntity sprite = rs->canvas_item_create();
+            rs->canvas_item_set_parent(sprite, map.root);
+            rs->canvas_item_set_custom_rect(sprite, true, SPRITE_RECT);
+            rs->canvas_item_add_rect(sprite, SPRITE_RECT, Color(1, 1, 1));
+            rs->canvas_item_set_transform(sprite, Transform2D(0, pos));
+            map.sprites.push_back(sprite);
+            map.positions.push_back(pos);
+        }
+    }
+    return map;
+}
+
+void destroy(Map &p_map) {
+
+    for (RenderingEntity sprite : p_map.sprites) {
+        VSG::canvas->free(sprite);
+    }
+    VSG::canvas->free(p_map.root);
+    VSG::canvas->free(p_map.canvas);
+}
+
+// Sprites wander a few pixels, which keeps a y-sorted order nearly sorted.
+void move_some(Map &p_map, RandomPCG &p_rng, int p_count) {
+
+    for (int i = 0; i < p_count; i++) {
+        const int idx = p_rng.rand() % p_map.sprites.size();
+        p_map.positions[idx] += Vector2(p_rng.random(-4.0f, 4.0f), p_rng.random(-4.0f, 4.0f));
+        VSG::canvas->canvas_item_set_transform(p_map.sprites[idx], Transform2D(0, p_map.positions[idx]));
+    }
+}
+
+int render(CountingCanvas &p_counter, const Map &p_map, const Transform2D &p_view, const Size2 &p_size) {
+
+    p_counter.drawn = 0;
+    p_counter.y_ordered = true;
+    VSG::canvas->render_canvas(VSG::ecs->try_get<RenderingCanvasComponent>(p_map.canvas), p_view, {}, {},
+            Rect2(Point2(), p_size));
+    return p_counter.drawn;
+}
+
+// Same test the canvas server applies to each item, without any index.
+int expected_visible(const Map &p_map, const Transform2D &p_view, const Size2 &p_size) {
+
+    int count = 0;
+    for (const Vector2 &pos : p_map.positions) {
+        if (Rect2(Point2(), p_size).intersects((p_view * Transform2D(0, pos)).xform(SPRITE_RECT), true)) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool run(CountingCanvas &p_counter, bool p_sort_y, const Size2 &p_size, int p_frames) {
+
+    RandomPCG rng(1234);
+
+    Map map = build(p_sort_y);
+    bool ok = true;
+
+    auto view_at = [](int p_frame) {
+        return Transform2D(0, -Vector2(1000 + p_frame * 7, 600 + p_frame * 3));
+    };
+
+    // The first frame builds the index and the initial y order.
+    ok = ok && render(p_counter, map, view_at(0), p_size) == expected_visible(map, view_at(0), p_size);
+
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    for (int f = 1; f <= p_frames; f++) {
+        move_some(map, rng, 100);
+        render(p_counter, map, view_at(f), p_size);
+    }
+    const uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - start;
+
+    // Sprites queued for an index update and freed before the next frame must not be touched by it.
+    for (int i = 0; i < 10; i++) {
+        const int idx = rng.rand() % map.sprites.size();
+        VSG::canvas->canvas_item_set_transform(map.sprites[idx], Transform2D(0, map.positions[idx] + Vector2(1, 1)));
+        VSG::canvas->free(map.sprites[idx]);
+        map.sprites.erase_at(idx);
+        map.positions.erase_at(idx);
+    }
+
+    const int drawn = render(p_counter, map, view_at(p_frames), p_size);
+    ok = ok && drawn == expected_visible(map, view_at(p_frames), p_size);
+    ok = ok && (!p_sort_y || p_counter.y_ordered);
+
+    OS::get_singleton()->print(FormatVE("\t%6d sprites%s, %5dx%-5d view: %6d drawn, %8.3f ms per frame\n",
+            GRID_W * GRID_H, p_sort_y ? " y-sorted" : "         ", int(p_size.x), int(p_size.y), drawn,
+            elapsed / 1000.0 / p_frames));
+
+    destroy(map);
+    return ok;
+}
+
+} // namespace
+
+MainLoop *test() {
+
+    CountingCanvas counter;
+    RasterizerCanvas *canvas_render = VSG::canvas_render;
+    VSG::canvas_render = &counter;
+
+    bool ok = true;
+    for (bool sort_y : { false, true }) {
+        ok = run(counter, sort_y, Size2(1280, 720), 60) && ok;
+        // Everything on screen, the old cost of walking the whole canvas.
+        ok = run(counter, sort_y, Size2(GRID_W * SPACING, GRID_H * SPACING), 10) && ok;
+    }
+
+    VSG::canvas_render = canvas_render;
+
+    OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+    return nullptr;
+}
+
+} // namespace TestCanvasCull
@@ -0,0 +1,194 @@
+/*************************************************************************/
+/*  test_dynamic_font.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_dynamic_font.h"
+
+#include "core/dictionary.h"
+#include "core/math/vector3.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/string_formatter.h"
+#include "core/string_utils.h"
+#include "scene/resources/dynamic_font.h"
+
+namespace TestDynamicFont {
+
+// Measures glyph rasterization into the shared atlas of one font file, first with a single size, then with two
+// sizes being used from two threads at once, and with threaded precaching. All three must measure the same glyphs.
+
+namespace {
+
+const int FIRST_CHAR = 0x20;
+const int LAST_CHAR = 0x24F; // Basic Latin up to Latin Extended-B
+const int SIZES[2] = { 16, 24 };
+
+String find_font() {
+    for (const String &arg : OS::get_singleton()->get_cmdline_args()) {
+        if (StringUtils::ends_with(arg, ".ttf") || StringUtils::ends_with(arg, ".otf")) {
+            return arg;
+        }
+    }
+    const char *candidates[] = {
+        "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",
+        "/usr/share/fonts/dejavu/DejaVuSans.ttf",
+        "/usr/share/fonts/TTF/DejaVuSans.ttf",
+        "/System/Library/Fonts/Supplemental/Arial.ttf",
+        "C:/Windows/Fonts/arial.ttf",
+    };
+    for (const char *path : candidates) {
+        if (FileAccess::exists(path)) {
+            return path;
+        }
+    }
+    return String();
+}
+
+struct Run {
+    Ref<DynamicFont> font;
+    Vector<Size2> sizes;
+};
+
+Ref<DynamicFont> make_font(const Ref<DynamicFontData> &p_data, int p_size) {
+    Ref<DynamicFont> font(make_ref_counted<DynamicFont>());
+    font->set_font_data(p_data);
+    font->set_size(p_size);
+    return font;
+}
+
+void measure(void *p_run) {
+    Run *run = static_cast<Run *>(p_run);
+    run->sizes.clear();
+    for (int c = FIRST_CHAR; c <= LAST_CHAR; c++) {
+        run->sizes.push_back(run->font->get_char_size(CharType(c)));
+    }
+}
+
+// UTF-8 of every measured character, for DynamicFont::precache.
+String all_chars() {
+    String chars;
+    for (int c = FIRST_CHAR; c <= LAST_CHAR; c++) {
+        if (c < 0x80) {
+            chars.push_back(char(c));
+        } else {
+            chars.push_back(char(0xC0 | (c >> 6)));
+            chars.push_back(char(0x80 | (c & 0x3F)));
+        }
+    }
+    return chars;
+}
+
+bool same_sizes(const Run *p_a, const Run *p_b) {
+    if (p_a->sizes.size() != p_b->sizes.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < p_a->sizes.size(); i++) {
+        if (!p_a->sizes[i].is_equal_approx(p_b->sizes[i])) {
+            OS::get_singleton()->print(FormatVE("\tU+%04X measures differently\n", int(FIRST_CHAR + i)));
+            return false;
+        }
+    }
+    return true;
+}
+
+void print_stats(const char *p_label, uint64_t p_usec, const Ref<DynamicFontData> &p_data) {
+    const Dictionary stats = p_data->get_atlas_stats();
+    OS::get_singleton()->print(FormatVE("\t%-26s %8.3f ms  %3d glyphs on %d pages, %.0f%% occupied\n", p_label,
+            p_usec / 1000.0, stats["glyphs"].as<int>(), stats["pages"].as<int>(), stats["occupancy"].as<float>() * 100.0f));
+}
+
+} // namespace
+
+MainLoop *test() {
+
+    const String path = find_font();
+    if (path.empty()) {
+        OS::get_singleton()->print("\tNo font file found, pass a .ttf or .otf on the command line. SKIPPED\n");
+        return nullptr;
+    }
+    OS::get_singleton()->print(FormatVE("%s, U+%04X..U+%04X at sizes %d and %d:\n", path.c_str(), FIRST_CHAR, LAST_CHAR, SIZES[0], SIZES[1]));
+
+    bool ok = true;
+
+    // Reference: both sizes one after the other on this thread.
+    Run serial[2];
+    {
+        Ref<DynamicFontData> data(make_ref_counted<DynamicFontData>());
+        data->set_font_path(path);
+        const uint64_t from = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < 2; i++) {
+            serial[i].font = make_font(data, SIZES[i]);
+            measure(&serial[i]);
+        }
+        print_stats("serial", OS::get_singleton()->get_ticks_usec() - from, data);
+        ok = ok && data->get_atlas_stats()["glyphs"].as<int>() > 0;
+    }
+
+    // Both sizes pack into the same atlas pages from two threads at once.
+    {
+        Ref<DynamicFontData> data(make_ref_counted<DynamicFontData>());
+        data->set_font_path(path);
+        Run concurrent[2];
+        Thread threads[2];
+        const uint64_t from = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < 2; i++) {
+            concurrent[i].font = make_font(data, SIZES[i]);
+            threads[i].start(measure, &concurrent[i]);
+        }
+        for (int i = 0; i < 2; i++) {
+            threads[i].wait_to_finish();
+        }
+        print_stats("two threads, shared atlas", OS::get_singleton()->get_ticks_usec() - from, data);
+        ok = same_sizes(&serial[0], &concurrent[0]) && same_sizes(&serial[1], &concurrent[1]) && ok;
+    }
+
+    // Rasterization moved to the precache threads, the main thread only packs the finished bitmaps.
+    {
+        Ref<DynamicFontData> data(make_ref_counted<DynamicFontData>());
+        data->set_font_path(path);
+        Run precached[2];
+        const String chars = all_chars();
+        const uint64_t from = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < 2; i++) {
+            precached[i].font = make_font(data, SIZES[i]);
+            precached[i].font->precache(chars, true);
+        }
+        for (int i = 0; i < 2; i++) {
+            measure(&precached[i]);
+        }
+        print_stats("threaded precache", OS::get_singleton()->get_ticks_usec() - from, data);
+        ok = same_sizes(&serial[0], &precached[0]) && same_sizes(&serial[1], &precached[1]) && ok;
+    }
+
+    OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+    return nullptr;
+}
+
+} // namespace TestDynamicFont
@@ -0,0 +1,314 @@
+/*************************************************************************/
+/*  test_file_access_compressed.cpp                                      */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_file_access_compressed.h"
+
+#include "core/io/compression.h"
+#include "core/io/file_access_compressed.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/string_formatter.h"
+#include "core/string_utils.h"
+
+namespace TestFileAccessCompressed {
+
+// Sequential and random reads of a large compressed file for a few block sizes, with and without read-ahead,
+// then small files compressed with and without a dictionary built from similar samples.
+
+namespace {
+
+const int DATA_SIZE = 32 * 1024 * 1024;
+const int CHUNK_SIZE = 16 * 1024;
+const int RANDOM_READS = 2000;
+const int RANDOM_READ_SIZE = 4096;
+const int DICTIONARY_SAMPLES = 200;
+
+uint32_t next_random(uint32_t &r_state) {
+    r_state ^= r_state << 13;
+    r_state ^= r_state >> 17;
+    r_state ^= r_state << 5;
+    return r_state;
+}
+
+// Text-like content, compresses roughly like scenes and resources do.
+Vector<uint8_t> make_data(int p_size) {
+    static const char *words[] = { "node", "transform", "Vector3", "material", "mesh", "resource", "script", "0.0",
+        "1.0", "path", "instance", "[", "]", "=", "(", ")", "\n", "parent", "name", "type" };
+    const int word_count = sizeof(words) / sizeof(words[0]);
+
+    Vector<uint8_t> data;
+    data.resize(p_size);
+    uint32_t state = 0x9E3779B9;
+    int pos = 0;
+    while (pos < p_size) {
+        const char *w = words[next_random(state) % word_count];
+        for (; *w && pos < p_size; w++)
+            data[pos++] = *w;
+        if (pos < p_size)
+            data[pos++] = ' ';
+    }
+    return data;
+}
+
+FileAccessCompressed *open_compressed(StringView p_path, int p_mode, uint32_t p_block_size = 0, uint32_t p_dictionary = 0) {
+    FileAccessCompressed *fac = memnew(FileAccessCompressed);
+    fac->configure("TFAC", Compression::MODE_ZSTD, p_block_size);
+    fac->set_dictionary_id(p_dictionary);
+    if (fac->_open(p_path, p_mode) != OK) {
+        memdelete(fac);
+        return nullptr;
+    }
+    return fac;
+}
+
+bool write_compressed(StringView p_path, const Vector<uint8_t> &p_data, uint32_t p_block_size, uint32_t p_dictionary = 0) {
+    FileAccessCompressed *fac = open_compressed(p_path, FileAccess::WRITE, p_block_size, p_dictionary);
+    if (!fac)
+        return false;
+    fac->store_buffer(p_data.data(), p_data.size());
+    fac->close();
+    memdelete(fac);
+    return true;
+}
+
+bool read_sequential(StringView p_path, const Vector<uint8_t> &p_expected, uint64_t &r_usec) {
+    FileAccessCompressed *fac = open_compressed(p_path, FileAccess::READ);
+    if (!fac)
+        return false;
+
+    Vector<uint8_t> chunk;
+    chunk.resize(CHUNK_SIZE);
+    bool ok = true;
+    size_t offset = 0;
+    const uint64_t from = OS::get_singleton()->get_ticks_usec();
+    while (true) {
+        const uint64_t read = fac->get_buffer(chunk.data(), CHUNK_SIZE);
+        if (read > CHUNK_SIZE || offset + read > p_expected.size() || memcmp(chunk.data(), p_expected.data() + offset, read) != 0) {
+            ok = false;
+            break;
+        }
+        offset += read;
+        if (read < CHUNK_SIZE)
+            break;
+    }
+    r_usec = OS::get_singleton()->get_ticks_usec() - from;
+    memdelete(fac);
+    return ok && offset == p_expected.size();
+}
+
+bool read_random(StringView p_path, const Vector<uint8_t> &p_expected, uint64_t &r_usec) {
+    FileAccessCompressed *fac = open_compressed(p_path, FileAccess::READ);
+    if (!fac)
+        return false;
+
+    Vector<uint8_t> chunk;
+    chunk.resize(RANDOM_READ_SIZE);
+    bool ok = true;
+    uint32_t state = 0x2545F491;
+    const uint64_t from = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < RANDOM_READS && ok; i++) {
+        const size_t pos = next_random(state) % (p_expected.size() - RANDOM_READ_SIZE);
+        fac->seek(pos);
+        ok = fac->get_buffer(chunk.data(), RANDOM_READ_SIZE) == RANDOM_READ_SIZE &&
+             memcmp(chunk.data(), p_expected.data() + pos, RANDOM_READ_SIZE) == 0;
+    }
+    r_usec = OS::get_singleton()->get_ticks_usec() - from;
+    memdelete(fac);
+    return ok;
+}
+
+Vector<uint8_t> make_sample(uint32_t &r_state) {
+    String text = "[gd_resource type=\"SpatialMaterial\" format=2]\n\n[resource]\n";
+    text += FormatVE("albedo_color = Color( %.3f, %.3f, %.3f, 1 )\n", (next_random(r_state) % 1000) / 1000.0,
+            (next_random(r_state) % 1000) / 1000.0, (next_random(r_state) % 1000) / 1000.0);
+    text += FormatVE("metallic = %.2f\nroughness = %.2f\n", (next_random(r_state) % 100) / 100.0, (next_random(r_state) % 100) / 100.0);
+    text += "flags_transparent = false\nflags_unshaded = false\nparams_diffuse_mode = 0\nparams_specular_mode = 0\n";
+    text += FormatVE("uv1_scale = Vector3( %d, %d, 1 )\n", int(next_random(r_state) % 8 + 1), int(next_random(r_state) % 8 + 1));
+
+    Vector<uint8_t> sample;
+    sample.resize(text.length());
+    memcpy(sample.data(), text.data(), text.length());
+    return sample;
+}
+
+// Two files read at once share the read-ahead pool: whichever finds it busy reads without read-ahead.
+bool read_interleaved(StringView p_path, const Vector<uint8_t> &p_expected) {
+    FileAccessCompressed *a = open_compressed(p_path, FileAccess::READ);
+    FileAccessCompressed *b = open_compressed(p_path, FileAccess::READ);
+    bool ok = a && b;
+
+    Vector<uint8_t> chunk;
+    chunk.resize(CHUNK_SIZE);
+    for (size_t offset = 0; ok && offset < p_expected.size(); offset += CHUNK_SIZE) {
+        const uint64_t len = eastl::min<uint64_t>(CHUNK_SIZE, p_expected.size() - offset);
+        for (FileAccessCompressed *fac : { a, b }) {
+            ok = ok && fac->get_buffer(chunk.data(), len) == len && memcmp(chunk.data(), p_expected.data() + offset, len) == 0;
+        }
+    }
+    if (a)
+        memdelete(a);
+    if (b)
+        memdelete(b);
+    return ok;
+}
+
+size_t file_size(StringView p_path) {
+    FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
+    if (!f)
+        return 0;
+    const size_t len = f->get_len();
+    memdelete(f);
+    return len;
+}
+
+bool test_dictionary(StringView p_path) {
+    uint32_t state = 0x1234567;
+    Vector<Vector<uint8_t> > training;
+    for (int i = 0; i < DICTIONARY_SAMPLES; i++)
+        training.emplace_back(make_sample(state));
+
+    const Vector<uint8_t> dictionary = Compression::build_zstd_dictionary(training);
+    if (dictionary.empty())
+        return false;
+    FileAccessCompressed::set_type_dictionary("SpatialMaterial", dictionary);
+    const uint32_t id = FileAccessCompressed::get_type_dictionary("SpatialMaterial");
+    if (id == 0)
+        return false;
+
+    size_t plain_total = 0, dict_total = 0, raw_total = 0;
+    bool ok = true;
+    for (int i = 0; i < DICTIONARY_SAMPLES && ok; i++) {
+        const Vector<uint8_t> sample = make_sample(state);
+        raw_total += sample.size();
+
+        ok = write_compressed(p_path, sample, 0);
+        plain_total += file_size(p_path);
+
+        ok = ok && write_compressed(p_path, sample, 0, id);
+        dict_total += file_size(p_path);
+
+        FileAccessCompressed *fac = open_compressed(p_path, FileAccess::READ);
+        ok = ok && fac && fac->get_dictionary_id() == id;
+        if (fac) {
+            Vector<uint8_t> read;
+            read.resize(sample.size());
+            ok = ok && fac->get_buffer(read.data(), read.size()) == sample.size() && read == sample;
+            memdelete(fac);
+        }
+    }
+
+    OS::get_singleton()->print(FormatVE("\t%d files, %zu bytes: %zu compressed, %zu with a %zu byte dictionary\n",
+            DICTIONARY_SAMPLES, raw_total, plain_total, dict_total, dictionary.size()));
+
+    // the dictionary outlives this session, and a file only opens with the very dictionary it was written with
+    Vector<uint8_t> saved;
+    FileAccess *df = FileAccess::open(PathUtils::plus_file(FileAccessCompressed::dictionary_path, FormatVE("%08x.zdict", id)), FileAccess::READ);
+    if (df) {
+        saved.resize(df->get_len());
+        df->get_buffer(saved.data(), saved.size());
+        memdelete(df);
+    }
+    const bool persisted = saved == dictionary;
+
+    bool mismatch_caught = false;
+    FileAccess *raw = FileAccess::open(p_path, FileAccess::READ_WRITE);
+    if (raw) {
+        raw->seek(24); // magic, mode, block size, total size, dictionary id, dictionary size, then its crc32
+        const uint32_t crc = raw->get_32();
+        raw->seek(24);
+        raw->store_32(~crc);
+        memdelete(raw);
+        FileAccessCompressed *fac = open_compressed(p_path, FileAccess::READ);
+        mismatch_caught = fac == nullptr;
+        if (fac)
+            memdelete(fac);
+    }
+    OS::get_singleton()->print(FormatVE("\tdictionary saved: %s, mismatched dictionary rejected: %s\n", persisted ? "yes" : "NO", mismatch_caught ? "yes" : "NO"));
+    ok = ok && persisted && mismatch_caught;
+
+    FileAccessCompressed::set_type_dictionary("SpatialMaterial", Vector<uint8_t>());
+    return ok && dict_total < plain_total;
+}
+
+} // namespace
+
+MainLoop *test() {
+
+    const String path = PathUtils::plus_file(OS::get_singleton()->get_cache_path(), "test_file_access_compressed.bin");
+    const Vector<uint8_t> data = make_data(DATA_SIZE);
+    const int saved_readahead = FileAccessCompressed::readahead_blocks;
+    bool ok = true;
+
+    static const uint32_t block_sizes[] = { 16 * 1024, 64 * 1024, 256 * 1024 };
+    for (uint32_t block_size : block_sizes) {
+        if (!write_compressed(path, data, block_size)) {
+            ok = false;
+            break;
+        }
+        OS::get_singleton()->print(FormatVE("block size %u, %zu bytes compressed to %zu\n", block_size, data.size(), file_size(path)));
+
+        for (int readahead : { 0, saved_readahead > 0 ? saved_readahead : 4 }) {
+            FileAccessCompressed::readahead_blocks = readahead;
+            uint64_t seq_usec = 0, rnd_usec = 0;
+            const bool seq_ok = read_sequential(path, data, seq_usec);
+            const bool rnd_ok = read_random(path, data, rnd_usec);
+            ok = ok && seq_ok && rnd_ok;
+            OS::get_singleton()->print(FormatVE("\tread-ahead %2d: sequential %8.2f ms (%7.1f MiB/s) %s, %d random reads %8.2f ms %s\n",
+                    readahead, seq_usec / 1000.0, DATA_SIZE / (1024.0 * 1024.0) / (seq_usec / 1000000.0 + 1e-9),
+                    seq_ok ? "ok" : "MISMATCH", RANDOM_READS, rnd_usec / 1000.0, rnd_ok ? "ok" : "MISMATCH"));
+        }
+    }
+    FileAccessCompressed::readahead_blocks = saved_readahead > 0 ? saved_readahead : 4;
+    const bool interleaved_ok = read_interleaved(path, data);
+    OS::get_singleton()->print(FormatVE("two files read at once: %s\n", interleaved_ok ? "ok" : "MISMATCH"));
+    ok = ok && interleaved_ok;
+    FileAccessCompressed::readahead_blocks = saved_readahead;
+
+    OS::get_singleton()->print("dictionary\n");
+    const String saved_dictionary_path = FileAccessCompressed::dictionary_path;
+    FileAccessCompressed::dictionary_path = PathUtils::plus_file(OS::get_singleton()->get_cache_path(), "test_file_access_compressed_dictionaries");
+    ok = test_dictionary(path) && ok;
+    {
+        DirAccessRef da(DirAccess::open(FileAccessCompressed::dictionary_path));
+        if (da) {
+            da->erase_contents_recursive();
+            da->remove(FileAccessCompressed::dictionary_path);
+        }
+    }
+    FileAccessCompressed::dictionary_path = saved_dictionary_path;
+
+    DirAccess::remove_file_or_error(path);
+    OS::get_singleton()->print(ok ? "PASS\n" : "FAILED\n");
+    return nullptr;
+}
+
+} // namespace TestFileAccessCompressed
@@ -0,0 +1,220 @@
+/*************************************************************************/
+/*  test_io_multiplexer.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_io_multiplexer.h"
+
+#include "core/io/io_multiplexer.h"
+#include "core/io/packet_peer_udp.h"
+#include "core/io/stream_peer_tcp.h"
+#include "core/io/tcp_server.h"
+#include "core/os/os.h"
+#include "core/string_formatter.h"
+
+namespace TestIOMultiplexer {
+
+// Many idle connections and a few active ones: polling each socket costs one syscall per connection per frame,
+// the multiplexer only returns the sockets that have data. UDP peers register the same way.
+
+namespace {
+
+const int MAX_CONNECTIONS = 10000;
+const int ACTIVE_EVERY = 100; // 1% of the connections send something each round
+const int ROUNDS = 200;
+const int UDP_PEERS = 64;
+
+void report(const char *p_what, uint64_t p_usec, int p_bytes) {
+    OS::get_singleton()->print(FormatVE("\t%-28s %9.2f ms, %d bytes\n", p_what, p_usec / 1000.0, p_bytes));
+}
+
+void send_active(const Vector<Ref<StreamPeerTCP> > &p_clients) {
+    const uint8_t byte = 0x2A;
+    int sent = 0;
+    for (size_t i = 0; i < p_clients.size(); i += ACTIVE_EVERY) {
+        p_clients[i]->put_partial_data(&byte, 1, sent);
+    }
+}
+
+int drain(const Ref<StreamPeerTCP> &p_peer) {
+    uint8_t buf[64];
+    int read = 0;
+    if (p_peer->get_partial_data(buf, sizeof(buf), read) != OK)
+        return 0;
+    return read;
+}
+
+// Datagrams sent to every eighth of a few listening UDP peers, only those must be reported ready.
+bool test_udp(IOMultiplexer *p_mux) {
+
+    Vector<Ref<PacketPeerUDP> > peers;
+    Vector<int> ports;
+    for (uint16_t p = 27200; p < 27600 && peers.size() < UDP_PEERS; p++) {
+        Ref<PacketPeerUDP> peer(make_ref_counted<PacketPeerUDP>());
+        if (peer->listen(p, IP_Address("127.0.0.1")) != OK)
+            continue;
+        p_mux->add(peer->get_socket(), IOMultiplexer::EVENT_IN, (void *)(intptr_t)peers.size());
+        peers.push_back(peer);
+        ports.push_back(p);
+    }
+    ERR_FAIL_COND_V_MSG(peers.size() < UDP_PEERS, false, "Could not listen on enough loopback UDP ports.");
+
+    Ref<PacketPeerUDP> sender(make_ref_counted<PacketPeerUDP>());
+    const uint8_t byte = 0x2A;
+    int sent = 0;
+    for (int i = 0; i < UDP_PEERS; i += UDP_PEERS / 8) {
+        sender->set_dest_address(IP_Address("127.0.0.1"), ports[i]);
+        sender->put_packet(&byte, 1);
+        sent++;
+    }
+
+    int received = 0;
+    bool only_senders = true;
+    Vector<IOMultiplexer::Ready> ready;
+    const uint64_t deadline = OS::get_singleton()->get_ticks_msec() + 1000;
+    while (received < sent && OS::get_singleton()->get_ticks_msec() < deadline) {
+        ready.clear();
+        if (p_mux->wait(ready, 10) != OK)
+            continue;
+        for (const IOMultiplexer::Ready &e : ready) {
+            const int idx = (intptr_t)e.userdata;
+            only_senders = only_senders && idx % (UDP_PEERS / 8) == 0;
+            const uint8_t *packet;
+            int size;
+            while (peers[idx]->get_available_packet_count() > 0 && peers[idx]->get_packet(&packet, size) == OK) {
+                received++;
+            }
+        }
+    }
+
+    for (const Ref<PacketPeerUDP> &peer : peers) {
+        p_mux->remove(peer->get_socket());
+        peer->close();
+    }
+    OS::get_singleton()->print(FormatVE("	%d UDP peers, %d datagrams: %d received through the multiplexer\n",
+            UDP_PEERS, sent, received));
+    return only_senders && received == sent && p_mux->get_socket_count() == 0;
+}
+
+} // namespace
+
+MainLoop *test() {
+
+    Ref<TCP_Server> server(make_ref_counted<TCP_Server>());
+    uint16_t port = 0;
+    for (uint16_t p = 27015; p < 27115 && !server->is_listening(); p++) {
+        if (server->listen(p, IP_Address("127.0.0.1")) == OK)
+            port = p;
+    }
+    ERR_FAIL_COND_V_MSG(!server->is_listening(), nullptr, "Could not listen on a loopback port.");
+
+    Vector<Ref<StreamPeerTCP> > clients;
+    Vector<Ref<StreamPeerTCP> > accepted;
+    clients.reserve(MAX_CONNECTIONS);
+    accepted.reserve(MAX_CONNECTIONS);
+    // Stops early when the process runs out of file descriptors, each connection needs two.
+    while (accepted.size() < MAX_CONNECTIONS) {
+        Ref<StreamPeerTCP> client(make_ref_counted<StreamPeerTCP>());
+        if (client->connect_to_host(IP_Address("127.0.0.1"), port) != OK)
+            break;
+        const uint64_t deadline = OS::get_singleton()->get_ticks_msec() + 1000;
+        while (!server->is_connection_available() && OS::get_singleton()->get_ticks_msec() < deadline) {
+            OS::get_singleton()->delay_usec(10);
+        }
+        if (!server->is_connection_available())
+            break;
+        Ref<StreamPeerTCP> conn = server->take_connection();
+        if (not conn)
+            break;
+        clients.push_back(client);
+        accepted.push_back(conn);
+    }
+    for (const Ref<StreamPeerTCP> &client : clients) {
+        client->get_status(); // Finish the non-blocking connect.
+    }
+
+    const int active = (accepted.size() + ACTIVE_EVERY - 1) / ACTIVE_EVERY;
+    const int expected = active * ROUNDS;
+    OS::get_singleton()->print(FormatVE("%d connections, %d active, %d rounds:\n", (int)accepted.size(), active, ROUNDS));
+
+    // Every connection is asked in turn, like WSLServer used to.
+    int got_poll = 0;
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    for (int r = 0; r < ROUNDS; r++) {
+        send_active(clients);
+        int round = 0;
+        const uint64_t deadline = OS::get_singleton()->get_ticks_msec() + 1000;
+        while (round < active && OS::get_singleton()->get_ticks_msec() < deadline) {
+            for (const Ref<StreamPeerTCP> &peer : accepted) {
+                if (peer->get_socket()->poll(NetSocket::POLL_TYPE_IN, 0) == OK)
+                    round += drain(peer);
+            }
+        }
+        got_poll += round;
+    }
+    report("poll each socket", OS::get_singleton()->get_ticks_usec() - start, got_poll);
+
+    Ref<IOMultiplexer> mux(IOMultiplexer::create(), DoNotAddRef);
+    for (size_t i = 0; i < accepted.size(); i++) {
+        mux->add(accepted[i]->get_socket(), IOMultiplexer::EVENT_IN, (void *)(intptr_t)i);
+    }
+    Vector<IOMultiplexer::Ready> ready;
+    int got_mux = 0;
+    start = OS::get_singleton()->get_ticks_usec();
+    for (int r = 0; r < ROUNDS; r++) {
+        send_active(clients);
+        int round = 0;
+        const uint64_t deadline = OS::get_singleton()->get_ticks_msec() + 1000;
+        while (round < active && OS::get_singleton()->get_ticks_msec() < deadline) {
+            ready.clear();
+            if (mux->wait(ready, 0) != OK)
+                continue;
+            for (const IOMultiplexer::Ready &e : ready) {
+                round += drain(accepted[(intptr_t)e.userdata]);
+            }
+        }
+        got_mux += round;
+    }
+    report("multiplexer wait", OS::get_singleton()->get_ticks_usec() - start, got_mux);
+
+    for (const Ref<StreamPeerTCP> &peer : accepted) {
+        mux->remove(peer->get_socket());
+    }
+    bool ok = got_poll == expected && got_mux == expected && mux->get_socket_count() == 0;
+    ok = test_udp(mux.get()) && ok;
+    OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+
+    for (const Ref<StreamPeerTCP> &client : clients) {
+        client->disconnect_from_host();
+    }
+    server->stop();
+
+    return nullptr;
+}
+
+} // namespace TestIOMultiplexer
@@ -0,0 +1,277 @@
+/*************************************************************************/
+/*  test_lightmapper.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_lightmapper.h"
+
+#include "core/dictionary.h"
+#include "core/image.h"
+#include "core/math/basis.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/project_settings.h"
+#include "core/string_formatter.h"
+#include "core/string_utils.h"
+#include "scene/3d/lightmapper.h"
+
+namespace TestLightmapper {
+
+// Headless bake of a reference room: a floor, three walls and a row of boxes, lit by a soft sun and an omni light.
+// Bakes once in a single pass, then progressively with a checkpoint, then resumes from that checkpoint, from one
+// left by an aborted bake, and from one made with a different environment, which must not be used.
+
+namespace {
+
+// Axis aligned box, each face gets its own cell of a 3x2 grid in UV2.
+Lightmapper::MeshData make_box(const Vector3 &p_center, const Vector3 &p_extents, const Color &p_albedo, StringView p_name) {
+    static const Vector3 normals[6] = { Vector3(1, 0, 0), Vector3(-1, 0, 0), Vector3(0, 1, 0), Vector3(0, -1, 0), Vector3(0, 0, 1), Vector3(0, 0, -1) };
+
+    Lightmapper::MeshData md;
+    for (int face = 0; face < 6; face++) {
+        const Vector3 n = normals[face];
+        const Vector3 u = Math::abs(n.y) > 0.5f ? Vector3(1, 0, 0) : Vector3(0, 1, 0);
+        const Vector3 v = n.cross(u);
+        const Vector3 c = p_center + n * p_extents;
+        const Vector3 du = u * p_extents;
+        const Vector3 dv = v * p_extents;
+        const Vector3 corners[4] = { c - du - dv, c + du - dv, c + du + dv, c - du + dv };
+
+        const Vector2 cell(face % 3 / 3.0f, face / 3 / 2.0f);
+        const Vector2 pad(0.01f, 0.01f);
+        const Vector2 cell_size = Vector2(1.0f / 3.0f, 0.5f) - pad * 2;
+        const Vector2 uvs[4] = { cell + pad, cell + pad + Vector2(cell_size.x, 0), cell + pad + cell_size, cell + pad + Vector2(0, cell_size.y) };
+
+        static const int order[6] = { 0, 1, 2, 0, 2, 3 };
+        for (int i : order) {
+            md.points.push_back(corners[i]);
+            md.normal.push_back(n);
+            md.uv2.push_back(uvs[i]);
+        }
+    }
+
+    Lightmapper::MeshData::TextureDef albedo;
+    albedo.tex_rid = entt::null;
+    albedo.mul = Color(1, 1, 1);
+    albedo.add = p_albedo;
+    Lightmapper::MeshData::TextureDef emission;
+    emission.tex_rid = entt::null;
+    emission.mul = Color(1, 1, 1);
+    emission.add = Color(0, 0, 0);
+    md.albedo.push_back(albedo);
+    md.emission.push_back(emission);
+    md.surface_facecounts.push_back(md.points.size() / 3);
+
+    Dictionary userdata;
+    userdata["node_name"] = String(p_name);
+    md.userdata = userdata;
+    return md;
+}
+
+Ref<Lightmapper> make_scene() {
+    ERR_FAIL_COND_V_MSG(!Lightmapper::create_cpu, Ref<Lightmapper>(), "The CPU lightmapper module is not available.");
+    Ref<Lightmapper> lm(Lightmapper::create_cpu(), DoNotAddRef);
+
+    lm->add_mesh(make_box(Vector3(0, -0.5f, 0), Vector3(10, 0.5f, 10), Color(0.8f, 0.8f, 0.8f), "Floor"), Vector2i(512, 512));
+    lm->add_mesh(make_box(Vector3(-10.5f, 5, 0), Vector3(0.5f, 5, 10), Color(0.8f, 0.2f, 0.2f), "WallLeft"), Vector2i(256, 256));
+    lm->add_mesh(make_box(Vector3(10.5f, 5, 0), Vector3(0.5f, 5, 10), Color(0.2f, 0.8f, 0.2f), "WallRight"), Vector2i(256, 256));
+    lm->add_mesh(make_box(Vector3(0, 5, -10.5f), Vector3(10, 5, 0.5f), Color(0.8f, 0.8f, 0.8f), "WallBack"), Vector2i(256, 256));
+    for (int i = 0; i < 6; i++) {
+        const float height = 0.5f + i * 0.5f;
+        lm->add_mesh(make_box(Vector3(-7.5f + i * 3, height, (i % 2) * 3 - 1.5f), Vector3(1, height, 1), Color(0.7f, 0.7f, 0.9f), FormatVE("Box%d", i)), Vector2i(96, 96));
+    }
+
+    lm->add_directional_light(true, Vector3(-0.4f, -1, -0.3f).normalized(), Color(1, 0.95f, 0.9f), 1.0f, 1.0f, 0.05f);
+    lm->add_omni_light(true, Vector3(0, 6, 2), Color(1, 0.8f, 0.6f), 2.0f, 1.0f, 15.0f, 1.0f, 0.0f);
+    return lm;
+}
+
+// Only indirect passes report progress without forcing a refresh, one call before each pass.
+struct PassCounter {
+    int passes = 0;
+    int cancel_at = -1; // pass to abort the bake at, -1 to let it finish
+
+    int run() const { return cancel_at >= 0 && passes > cancel_at ? cancel_at : passes; }
+};
+
+bool count_passes(float p_progress, StringView p_description, void *p_userdata, bool p_refresh) {
+    PassCounter *counter = (PassCounter *)p_userdata;
+    if (p_refresh) {
+        return false;
+    }
+    return counter->passes++ == counter->cancel_at;
+}
+
+Lightmapper::BakeError bake(const char *p_what, const Ref<Image> &p_panorama, PassCounter &r_counter, Vector<Ref<Image> > &r_images) {
+    Ref<Lightmapper> lm = make_scene();
+    if (!lm) {
+        return Lightmapper::BAKE_ERROR_NO_MESHES; // nothing to bake with
+    }
+    const uint64_t start = OS::get_singleton()->get_ticks_usec();
+    const Lightmapper::BakeError err = lm->bake(Lightmapper::BAKE_QUALITY_LOW, false, 3, 1.0f, 0.005f, false, 4096, p_panorama, Basis(), &count_passes, &r_counter);
+    const uint64_t usec = OS::get_singleton()->get_ticks_usec() - start;
+
+    r_images.clear();
+    if (err == Lightmapper::BAKE_OK) {
+        for (int i = 0; i < lm->get_bake_texture_count(); i++) {
+            r_images.push_back(lm->get_bake_texture(i));
+        }
+    }
+    OS::get_singleton()->print(FormatVE("\t%-36s %9.2f ms, %d indirect passes run\n", p_what, usec / 1000.0, r_counter.run()));
+    return err;
+}
+
+Ref<Image> make_panorama(const Color &p_sky) {
+    Ref<Image> panorama(make_ref_counted<Image>(64, 32, false, ImageData::FORMAT_RGBF));
+    panorama->fill(p_sky);
+    return panorama;
+}
+
+int checkpoint_passes(StringView p_path) {
+    FileAccessRef f(FileAccess::open(p_path, FileAccess::READ));
+    if (!f) {
+        return -1;
+    }
+    f->get_64(); // fingerprint
+    return f->get_32();
+}
+
+// Resumed bakes draw different random samples, so they are compared by average light only.
+bool similar_images(const Vector<Ref<Image> > &p_a, const Vector<Ref<Image> > &p_b) {
+    if (p_a.size() != p_b.size() || p_a.empty()) {
+        return false;
+    }
+    for (size_t i = 0; i < p_a.size(); i++) {
+        if (not p_a[i] || not p_b[i] || p_a[i]->get_width() != p_b[i]->get_width() || p_a[i]->get_height() != p_b[i]->get_height()) {
+            return false;
+        }
+        float sum_a = 0, sum_b = 0;
+        p_a[i]->lock();
+        p_b[i]->lock();
+        for (int y = 0; y < p_a[i]->get_height(); y++) {
+            for (int x = 0; x < p_a[i]->get_width(); x++) {
+                sum_a += p_a[i]->get_pixel(x, y).get_v();
+                sum_b += p_b[i]->get_pixel(x, y).get_v();
+            }
+        }
+        p_a[i]->unlock();
+        p_b[i]->unlock();
+        if (Math::abs(sum_a - sum_b) > 0.05f * M_MAX(sum_a, sum_b)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool same_images(const Vector<Ref<Image> > &p_a, const Vector<Ref<Image> > &p_b) {
+    if (p_a.size() != p_b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < p_a.size(); i++) {
+        if (not p_a[i] || not p_b[i]) {
+            if (p_a[i] != p_b[i]) {
+                return false;
+            }
+            continue;
+        }
+        const PoolVector<uint8_t> a = p_a[i]->get_data();
+        const PoolVector<uint8_t> b = p_b[i]->get_data();
+        if (a.size() != b.size() || memcmp(a.read().ptr(), b.read().ptr(), a.size()) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+MainLoop *test() {
+
+    const StringName passes_setting("rendering/cpu_lightmapper/progressive/passes");
+    const StringName checkpoint_setting("rendering/cpu_lightmapper/progressive/checkpoint_path");
+    ProjectSettings *ps = ProjectSettings::get_singleton();
+    const Variant old_passes = ps->get(passes_setting);
+    const Variant old_checkpoint = ps->get(checkpoint_setting);
+    const String checkpoint = PathUtils::plus_file(OS::get_singleton()->get_user_data_dir(), "lightmapper_test.ckpt");
+    const Ref<Image> sky = make_panorama(Color(0.3f, 0.5f, 0.9f));
+    const Ref<Image> dusk = make_panorama(Color(0.9f, 0.4f, 0.2f));
+
+    OS::get_singleton()->print(FormatVE("Reference room, 10 meshes, %d cores:\n", OS::get_singleton()->get_processor_count()));
+
+    Vector<Ref<Image> > single;
+    Vector<Ref<Image> > progressive;
+    Vector<Ref<Image> > resumed;
+    Vector<Ref<Image> > interrupted;
+
+    ps->set(passes_setting, 1);
+    ps->set(checkpoint_setting, "");
+    PassCounter single_passes;
+    bool ok = bake("single pass", sky, single_passes, single) == Lightmapper::BAKE_OK;
+
+    // Resuming the finished checkpoint only post-processes, it must reproduce the previous bake exactly.
+    DirAccess::remove_file_or_error(checkpoint);
+    ps->set(passes_setting, 4);
+    ps->set(checkpoint_setting, checkpoint);
+    PassCounter progressive_passes;
+    ok = ok && bake("4 passes with checkpoint", sky, progressive_passes, progressive) == Lightmapper::BAKE_OK;
+    PassCounter finished_passes;
+    ok = ok && bake("resumed from finished checkpoint", sky, finished_passes, resumed) == Lightmapper::BAKE_OK;
+    ok = ok && progressive_passes.passes == 4 && finished_passes.passes == 0 && same_images(progressive, resumed);
+
+    // Aborted before the third pass, then resumed: only the last two passes run again.
+    DirAccess::remove_file_or_error(checkpoint);
+    PassCounter aborted_passes;
+    aborted_passes.cancel_at = 2;
+    ok = ok && bake("aborted before pass 3", sky, aborted_passes, interrupted) == Lightmapper::BAKE_ERROR_USER_ABORTED;
+    ok = ok && checkpoint_passes(checkpoint) == 2;
+    PassCounter remaining_passes;
+    ok = ok && bake("resumed after abort", sky, remaining_passes, interrupted) == Lightmapper::BAKE_OK;
+    ok = ok && remaining_passes.passes == 2 && similar_images(progressive, interrupted);
+
+    // A different environment invalidates the checkpoint.
+    PassCounter dusk_passes;
+    ok = ok && bake("other environment", dusk, dusk_passes, resumed) == Lightmapper::BAKE_OK;
+    ok = ok && dusk_passes.passes == 4;
+
+    DirAccess::remove_file_or_error(checkpoint);
+    const String intermediate_base(PathUtils::get_basename(checkpoint));
+    for (int i = 0; i < 10; i++) {
+        const String exr = intermediate_base + "_" + itos(i) + ".exr";
+        if (FileAccess::exists(exr)) {
+            DirAccess::remove_file_or_error(exr);
+        }
+    }
+    ps->set(passes_setting, old_passes);
+    ps->set(checkpoint_setting, old_checkpoint);
+
+    OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+    return nullptr;
+}
+
+} // namespace TestLightmapper
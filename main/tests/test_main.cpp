@@ -35,13 +35,37 @@
 #ifdef DEBUG_ENABLED
 
 #include "test_astar.h"
+#include "test_canvas_cull.h"
+#include "test_dynamic_font.h"
+#include "test_file_access_compressed.h"
 #include "test_gui.h"
+#include "test_io_multiplexer.h"
+#include "test_lightmapper.h"
+#include "test_marshalls.h"
 #include "test_math.h"
+#include "test_message_queue.h"
+#include "test_navmesh_bake.h"
+#include "test_node_children.h"
 #include "test_oa_hash_map.h"
+#include "test_object_dispatch.h"
+#include "test_packed_scene.h"
+#include "test_packet_peer_udp.h"
+#include "test_pck_compressed.h"
+#include "test_performance_metrics.h"
 #include "test_physics.h"
 #include "test_physics_2d.h"
+#include "test_physics_queries.h"
+#include "test_physics_stress.h"
 #include "test_render.h"
+#include "test_rich_text_label.h"
+#include "test_shader_compile.h"
 #include "test_shader_lang.h"
+#include "test_skeleton.h"
+#include "test_string_name.h"
+#include "test_text_edit.h"
+#include "test_text_parsers.h"
+#include "test_trace_profiler.h"
+#include "test_tree.h"
 //#include "test_string.h"
 
 const char **tests_get_names() {
@@ -61,6 +85,30 @@ const char **tests_get_names() {
         "gd_bytecode",
         "ordered_hash_map",
         "astar",
+        "string_name",
+        "text_parsers",
+        "marshalls",
+        "text_edit",
+        "rich_text_label",
+        "io_multiplexer",
+        "packet_peer_udp",
+        "lightmapper",
+        "packed_scene",
+        "file_access_compressed",
+        "physics_stress",
+        "physics_queries",
+        "object_dispatch",
+        "tree",
+        "skeleton",
+        "shader_compile",
+        "canvas_cull",
+        "message_queue",
+        "node_children",
+        "trace_profiler",
+        "performance_metrics",
+        "navmesh_bake",
+        "dynamic_font",
+        "pck_compressed",
         nullptr
     };
 
@@ -116,6 +164,128 @@ MainLoop *test_main(const String& p_test, const Vector<String> &p_args) {
         return TestAStar::test();
     }
 
+    if (p_test == "string_name") {
+
+        return TestStringName::test();
+    }
+
+    if (p_test == "text_parsers") {
+
+        return TestTextParsers::test(p_args);
+    }
+
+    if (p_test == "marshalls") {
+
+        return TestMarshalls::test();
+    }
+
+    if (p_test == "text_edit") {
+
+        return TestTextEdit::test();
+    }
+
+    if (p_test == "rich_text_label") {
+
+        return TestRichTextLabel::test();
+    }
+
+    if (p_test == "io_multiplexer") {
+
+        return TestIOMultiplexer::test();
+    }
+
+    if (p_test == "packet_peer_udp") {
+
+        return TestPacketPeerUDP::test();
+    }
+
+#ifndef _3D_DISABLED
+    if (p_test == "lightmapper") {
+
+        return TestLightmapper::test();
+    }
+#endif
+
+    if (p_test == "packed_scene") {
+
+        return TestPackedScene::test();
+    }
+
+    if (p_test == "file_access_compressed") {
+
+        return TestFileAccessCompressed::test();
+    }
+
+    if (p_test == "physics_stress") {
+
+        return TestPhysicsStress::test();
+    }
+
+    if (p_test == "physics_queries") {
+
+        return TestPhysicsQueries::test();
+    }
+
+    if (p_test == "object_dispatch") {
+
+        return TestObjectDispatch::test();
+    }
+
+    if (p_test == "tree") {
+
+        return TestTree::test();
+    }
+
+    if (p_test == "skeleton") {
+
+        return TestSkeleton::test();
+    }
+
+    if (p_test == "shader_compile") {
+
+        return TestShaderCompile::test();
+    }
+
+    if (p_test == "canvas_cull") {
+
+        return TestCanvasCull::test();
+    }
+
+    if (p_test == "message_queue") {
+
+        return TestMessageQueue::test();
+    }
+
+    if (p_test == "node_children") {
+
+        return TestNodeChildren::test();
+    }
+
+    if (p_test == "trace_profiler") {
+
+        return TestTraceProfiler::test();
+    }
+
+    if (p_test == "performance_metrics") {
+
+        return TestPerformanceMetrics::test();
+    }
+
+    if (p_test == "navmesh_bake") {
+
+        return TestNavmeshBake::test();
+    }
+
+    if (p_test == "dynamic_font") {
+
+        return TestDynamicFont::test();
+    }
+
+    if (p_test == "pck_compressed") {
+
+        return TestPckCompressed::test();
+    }
+
     print_line("Unknown test: " + p_test);
     return nullptr;
 }
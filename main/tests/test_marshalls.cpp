@@ -0,0 +1,209 @@
+/*************************************************************************/
+/*  test_marshalls.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_marshalls.h"
+
+#include "core/array.h"
+#include "core/color.h"
+#include "core/dictionary.h"
+#include "core/io/marshalls.h"
+#include "core/math/vector3.h"
+#include "core/os/os.h"
+#include "core/pool_vector.h"
+#include "core/string_formatter.h"
+#include "core/variant.h"
+
+namespace TestMarshalls {
+
+// Payloads shaped like what the multiplayer API sends: rpc argument lists, state dictionaries and bulk snapshots.
+
+static Variant make_rpc_args() {
+
+    Array args;
+    args.push_back(Vector3(12.5f, 0.25f, -3.0f));
+    args.push_back(0.016f);
+    args.push_back(42);
+    args.push_back(Variant(String("player_name")));
+    args.push_back(true);
+    return args;
+}
+
+static Variant make_state() {
+
+    Dictionary state;
+    state["position"] = Vector3(1, 2, 3);
+    state["velocity"] = Vector3(0.5f, 0, -0.5f);
+    state["health"] = 87;
+    state["name"] = Variant(String("Some player name"));
+    Array inventory;
+    for (int i = 0; i < 16; i++) {
+        inventory.push_back(Variant(String("item_") + char('a' + i)));
+    }
+    state["inventory"] = inventory;
+    return state;
+}
+
+static Variant make_snapshot() {
+
+    PoolVector<Vector3> positions;
+    positions.resize(1024);
+    {
+        PoolVector<Vector3>::Write w = positions.write();
+        for (int i = 0; i < 1024; i++) {
+            w[i] = Vector3(i, i * 0.5f, -i);
+        }
+    }
+    PoolVector<uint8_t> bytes;
+    bytes.resize(4093);
+    {
+        PoolVector<uint8_t>::Write w = bytes.write();
+        for (int i = 0; i < bytes.size(); i++) {
+            w[i] = uint8_t(i);
+        }
+    }
+    PoolVector<String> names;
+    for (int i = 0; i < 64; i++) {
+        names.push_back(String("entity_") + char('A' + i % 26));
+    }
+    Array snapshot;
+    snapshot.push_back(positions);
+    snapshot.push_back(bytes);
+    snapshot.push_back(names);
+    return snapshot;
+}
+
+static void report(const char *p_what, int p_iterations, uint64_t p_usec) {
+
+    OS::get_singleton()->print(FormatVE("\t%-32s %8.2f ms, %8.3f us/op\n", p_what, p_usec / 1000.0, double(p_usec) / p_iterations));
+}
+
+// Walks the view the way a packet handler would, touching every leaf without materializing Variants.
+static int walk_view(const EncodedVariantView &p_view) {
+
+    int leaves = 0;
+    switch (p_view.type) {
+        case VariantType::ARRAY:
+        case VariantType::DICTIONARY:
+        case VariantType::POOL_STRING_ARRAY: {
+            int ofs = 0;
+            EncodedVariantView element;
+            while (p_view.get_element(ofs, element) == OK) {
+                leaves += walk_view(element);
+            }
+        } break;
+        case VariantType::POOL_VECTOR3_ARRAY: {
+            for (int i = 0; i < p_view.count; i++) {
+                leaves += p_view.get_vector3(i).x >= 0;
+            }
+        } break;
+        case VariantType::POOL_BYTE_ARRAY: {
+            leaves += int(p_view.get_bytes().size());
+        } break;
+        default: {
+            leaves++;
+        }
+    }
+    return leaves;
+}
+
+static bool bench_payload(const char *p_name, const Variant &p_payload, int p_iterations) {
+
+    OS::get_singleton()->print(FormatVE("%s:\n", p_name));
+
+    // Round trip through every path first.
+    Vector<uint8_t> single;
+    bool ok = encode_variant(p_payload, single) == OK;
+    int len = 0;
+    ok = ok && encode_variant(p_payload, nullptr, len) == OK && len == int(single.size());
+    Vector<uint8_t> two_pass;
+    two_pass.resize(len);
+    ok = ok && encode_variant(p_payload, two_pass.data(), len) == OK && two_pass == single;
+
+    Variant decoded;
+    int used = 0;
+    ok = ok && decode_variant(decoded, single.data(), single.size(), &used) == OK && used == int(single.size());
+    ok = ok && decoded.deep_equal(p_payload);
+
+    EncodedVariantView view;
+    ok = ok && decode_variant_view(view, single.data(), single.size(), &used) == OK && used == int(single.size());
+    Variant from_view;
+    ok = ok && view.to_variant(from_view) == OK && from_view.deep_equal(p_payload);
+
+    OS::get_singleton()->print(FormatVE("\t%d bytes, round trip %s\n", int(single.size()), ok ? "ok" : "FAILED"));
+    if (!ok) {
+        return false;
+    }
+
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < p_iterations; i++) {
+        encode_variant(p_payload, nullptr, len);
+        Vector<uint8_t> buf;
+        buf.resize(len);
+        encode_variant(p_payload, buf.data(), len);
+    }
+    report("encode, measure + write", p_iterations, OS::get_singleton()->get_ticks_usec() - start);
+
+    Vector<uint8_t> buf;
+    start = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < p_iterations; i++) {
+        buf.clear();
+        encode_variant(p_payload, buf);
+    }
+    report("encode, single pass reused", p_iterations, OS::get_singleton()->get_ticks_usec() - start);
+
+    start = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < p_iterations; i++) {
+        decode_variant(decoded, single.data(), single.size());
+    }
+    report("decode_variant", p_iterations, OS::get_singleton()->get_ticks_usec() - start);
+
+    int leaves = 0;
+    start = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < p_iterations; i++) {
+        decode_variant_view(view, single.data(), single.size());
+        leaves += walk_view(view);
+    }
+    report("decode_variant_view + walk", p_iterations, OS::get_singleton()->get_ticks_usec() - start);
+
+    return leaves > 0;
+}
+
+MainLoop *test() {
+
+    bool ok = true;
+    ok = bench_payload("RPC arguments", make_rpc_args(), 200000) && ok;
+    ok = bench_payload("State dictionary", make_state(), 50000) && ok;
+    ok = bench_payload("Snapshot pool arrays", make_snapshot(), 5000) && ok;
+
+    OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+    return nullptr;
+}
+
+} // namespace TestMarshalls
@@ -0,0 +1,157 @@
+/*************************************************************************/
+/*  test_message_queue.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_message_queue.h"
+
+#include "core/message_queue.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/string_formatter.h"
+
+namespace TestMessageQueue {
+
+// Deferred calls pushed from several threads at once, merged back in push order on flush, and a queue growing well
+// past its configured size.
+
+namespace {
+
+const int THREAD_COUNT = 4;
+const int CALLS_PER_THREAD = 50000;
+
+struct Producer {
+    GameEntity target;
+    Vector<uint32_t> *calls;
+    int thread_index;
+};
+
+void push_calls(void *p_userdata) {
+
+    const Producer *producer = static_cast<const Producer *>(p_userdata);
+    Vector<uint32_t> *calls = producer->calls;
+    const uint32_t base = (producer->thread_index + 1) * CALLS_PER_THREAD;
+    for (int i = 0; i < CALLS_PER_THREAD; i++) {
+        MessageQueue::get_singleton()->push_call(producer->target, [calls, base, i]() { calls->push_back(base + i); });
+    }
+}
+
+bool test_producers(Object *p_target) {
+
+    MessageQueue *queue = MessageQueue::get_singleton();
+    Vector<uint32_t> calls;
+    calls.reserve((THREAD_COUNT + 1) * CALLS_PER_THREAD);
+
+    // Pushed before any other thread starts, so these must be called first.
+    for (int i = 0; i < CALLS_PER_THREAD; i++) {
+        queue->push_call(p_target->get_instance_id(), [&calls, i]() { calls.push_back(i); });
+    }
+
+    const uint64_t start = OS::get_singleton()->get_ticks_usec();
+    Producer producers[THREAD_COUNT];
+    Thread threads[THREAD_COUNT];
+    for (int t = 0; t < THREAD_COUNT; t++) {
+        producers[t] = { p_target->get_instance_id(), &calls, t };
+        threads[t].start(push_calls, &producers[t]);
+    }
+    for (Thread &thread : threads) {
+        thread.wait_to_finish();
+    }
+    const uint64_t pushed = OS::get_singleton()->get_ticks_usec() - start;
+
+    queue->flush();
+
+    bool ok = calls.size() == size_t((THREAD_COUNT + 1) * CALLS_PER_THREAD);
+    int last[THREAD_COUNT + 1];
+    for (int &l : last) {
+        l = -1;
+    }
+    for (size_t i = 0; i < calls.size() && ok; i++) {
+        const int producer = calls[i] / CALLS_PER_THREAD;
+        const int index = calls[i] % CALLS_PER_THREAD;
+        // Each producer keeps its own order, and the main thread calls all come first.
+        ok = index == last[producer] + 1 && (i >= CALLS_PER_THREAD || producer == 0);
+        last[producer] = index;
+    }
+
+    OS::get_singleton()->print(FormatVE("\t%d threads x %d calls: %8.2f ms pushing, %8.2f ms flushing, %d KiB peak\n",
+            THREAD_COUNT, CALLS_PER_THREAD, pushed / 1000.0, queue->get_last_flush_usec() / 1000.0,
+            queue->get_max_buffer_usage() / 1024));
+    return ok && queue->get_last_flush_message_count() == calls.size();
+}
+
+// Calls made during a flush are still run by that flush, after everything already queued.
+bool test_reentrant(Object *p_target) {
+
+    MessageQueue *queue = MessageQueue::get_singleton();
+    const GameEntity target = p_target->get_instance_id();
+    Vector<int> calls;
+
+    queue->push_call(target, [&calls, queue, target]() {
+        calls.push_back(0);
+        queue->push_call(target, [&calls]() { calls.push_back(2); });
+    });
+    queue->push_call(target, [&calls]() { calls.push_back(1); });
+    queue->flush();
+
+    return calls.size() == 3 && calls[0] == 0 && calls[1] == 1 && calls[2] == 2;
+}
+
+// Far more than the default 4 MiB the queue used to be limited to.
+bool test_growth(Object *p_target) {
+
+    MessageQueue *queue = MessageQueue::get_singleton();
+    const int count = 200000;
+    const StringName meta("count");
+    for (int i = 0; i < count; i++) {
+        queue->push_call(p_target->get_instance_id(), "set_meta", meta, i);
+    }
+    queue->flush();
+
+    OS::get_singleton()->print(FormatVE("\t%d calls with arguments: %8.2f ms flushing, %d KiB peak\n", count,
+            queue->get_last_flush_usec() / 1000.0, queue->get_max_buffer_usage() / 1024));
+    return queue->get_last_flush_message_count() == count && p_target->get_meta(meta).as<int>() == count - 1;
+}
+
+} // namespace
+
+MainLoop *test() {
+
+    Object *target = memnew(Object);
+
+    bool ok = test_producers(target);
+    ok = test_reentrant(target) && ok;
+    ok = test_growth(target) && ok;
+
+    memdelete(target);
+
+    OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+    return nullptr;
+}
+
+} // namespace TestMessageQueue
@@ -0,0 +1,219 @@
+/*************************************************************************/
+/*  test_navmesh_bake.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_navmesh_bake.h"
+
+#include "core/dictionary.h"
+#include "core/engine.h"
+#include "core/hash_map.h"
+#include "core/math/math_funcs.h"
+#include "core/os/os.h"
+#include "core/string_formatter.h"
+#include "scene/3d/collision_shape_3d.h"
+#include "scene/3d/physics_body_3d.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+#include "scene/resources/box_shape_3d.h"
+#include "scene/resources/concave_polygon_shape_3d.h"
+#include "scene/resources/navigation_mesh.h"
+
+namespace TestNavmeshBake {
+
+// Bake time of a large rolling terrain in one piece, in parallel tiles, and after moving a single obstacle.
+
+class TestMainLoop : public SceneTree {
+
+    Object *generator = nullptr;
+    Node3D *terrain = nullptr;
+    Vector<CollisionShape3D *> obstacles;
+    bool ok = true;
+
+    void build(int p_size) {
+
+        terrain = memnew(Node3D);
+        get_root()->add_child(terrain);
+
+        StaticBody3D *body = memnew(StaticBody3D);
+        terrain->add_child(body);
+
+        PoolVector<Vector3> faces;
+        auto height = [](int x, int z) {
+            return 2.0f * Math::sin(x * 0.11f) * Math::cos(z * 0.07f);
+        };
+        for (int z = 0; z < p_size; z++) {
+            for (int x = 0; x < p_size; x++) {
+                const Vector3 a(x, height(x, z), z);
+                const Vector3 b(x + 1, height(x + 1, z), z);
+                const Vector3 c(x, height(x, z + 1), z + 1);
+                const Vector3 d(x + 1, height(x + 1, z + 1), z + 1);
+                faces.push_back(a);
+                faces.push_back(b);
+                faces.push_back(c);
+                faces.push_back(b);
+                faces.push_back(d);
+                faces.push_back(c);
+            }
+        }
+        Ref<ConcavePolygonShape3D> ground(make_ref_counted<ConcavePolygonShape3D>());
+        ground->set_faces(faces);
+        CollisionShape3D *ground_shape = memnew(CollisionShape3D);
+        ground_shape->set_shape(ground);
+        body->add_child(ground_shape);
+
+        Ref<BoxShape3D> box(make_ref_counted<BoxShape3D>());
+        box->set_extents(Vector3(2, 4, 2));
+        for (int i = 8; i < p_size; i += 16) {
+            CollisionShape3D *obstacle = memnew(CollisionShape3D);
+            obstacle->set_shape(box);
+            obstacle->set_transform(Transform(Basis(), Vector3(i, height(i, i), i)));
+            body->add_child(obstacle);
+            obstacles.push_back(obstacle);
+        }
+    }
+
+    void clear() {
+
+        obstacles.clear();
+        get_root()->remove_child(terrain);
+        memdelete(terrain);
+        terrain = nullptr;
+    }
+
+    Ref<NavigationMesh> make_navmesh(int p_tile_size) {
+
+        Ref<NavigationMesh> navmesh(make_ref_counted<NavigationMesh>());
+        navmesh->set_parsed_geometry_type(NavigationMesh::PARSED_GEOMETRY_STATIC_COLLIDERS);
+        navmesh->set_tile_size(p_tile_size);
+        return navmesh;
+    }
+
+    // Polygons on both sides of every interior tile seam have to share vertices there, otherwise agents cannot walk
+    // from one tile into the next.
+    static bool seams_connected(const Ref<NavigationMesh> &p_navmesh, int p_size) {
+
+        const float tile = p_navmesh->get_tile_size() * p_navmesh->get_cell_size();
+        const float epsilon = p_navmesh->get_cell_size() * 0.01f;
+        const Vector<Vector3> &vertices = p_navmesh->get_vertices();
+        for (int axis : { 0, 2 }) {
+            for (float seam = tile; seam < p_size; seam += tile) {
+                // vertex on the seam -> sides it is used from, 1 below and 2 above
+                HashMap<int, int> sides;
+                for (int i = 0; i < p_navmesh->get_polygon_count(); i++) {
+                    const Vector<int> &polygon = p_navmesh->get_polygon(i);
+                    float centre = 0;
+                    for (int index : polygon) {
+                        centre += vertices[index][axis];
+                    }
+                    centre /= polygon.size();
+                    for (int index : polygon) {
+                        if (Math::abs(vertices[index][axis] - seam) < epsilon) {
+                            sides[index] |= centre < seam ? 1 : 2;
+                        }
+                    }
+                }
+                bool shared = false;
+                for (const auto &E : sides) {
+                    shared = shared || E.second == 3;
+                }
+                if (!shared) {
+                    OS::get_singleton()->print(FormatVE("\tnothing connects across the seam at %c = %.2f\n", axis == 0 ? 'x' : 'z', seam));
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    Dictionary bake(const Ref<NavigationMesh> &p_navmesh) {
+
+        generator->call_va("bake", Variant(p_navmesh), Variant(terrain));
+        return generator->call_va("get_last_bake_stats").as<Dictionary>();
+    }
+
+    void run(int p_size, int p_tile_size) {
+
+        build(p_size);
+
+        Ref<NavigationMesh> monolithic = make_navmesh(0);
+        const Dictionary single = bake(monolithic);
+
+        Ref<NavigationMesh> tiled = make_navmesh(p_tile_size);
+        const Dictionary full = bake(tiled);
+        ok = seams_connected(tiled, p_size) && ok;
+
+        // Nothing changed, nothing is rebuilt.
+        const Dictionary again = bake(tiled);
+        ok = ok && again["built_tiles"].as<int>() == 0;
+
+        CollisionShape3D *moved = obstacles[obstacles.size() / 2];
+        moved->set_transform(moved->get_transform().translated(Vector3(3, 0, 1)));
+        const Dictionary incremental = bake(tiled);
+        ok = seams_connected(tiled, p_size) && ok;
+
+        const int tiles = full["tiles"].as<int>();
+        ok = ok && monolithic->get_polygon_count() > 0 && tiled->get_polygon_count() > 0;
+        ok = ok && full["built_tiles"].as<int>() == tiles;
+        ok = ok && incremental["built_tiles"].as<int>() > 0 && incremental["built_tiles"].as<int>() < tiles;
+
+        OS::get_singleton()->print(FormatVE("\t%4dm terrain, %3d tiles: %9.2f ms monolithic, %9.2f ms tiled, %9.2f ms after moving one obstacle (%d tiles)\n",
+                p_size, tiles, single["time_usec"].as<uint64_t>() / 1000.0, full["time_usec"].as<uint64_t>() / 1000.0,
+                incremental["time_usec"].as<uint64_t>() / 1000.0, incremental["built_tiles"].as<int>()));
+
+        clear();
+    }
+
+public:
+    void init() override {
+
+        SceneTree::init();
+
+        generator = Engine::get_singleton()->get_named_singleton("NavigationMeshGenerator");
+        if (!generator) {
+            OS::get_singleton()->print("\tNavigationMeshGenerator is not available\n");
+            quit();
+            return;
+        }
+
+        for (int size : { 128, 256, 512 }) {
+            run(size, 64);
+        }
+
+        OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+
+        quit();
+    }
+};
+
+MainLoop *test() {
+
+    return memnew(TestMainLoop);
+}
+
+} // namespace TestNavmeshBake
@@ -0,0 +1,156 @@
+/*************************************************************************/
+/*  test_node_children.cpp                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_node_children.h"
+
+#include "core/node_path.h"
+#include "core/os/os.h"
+#include "core/string_formatter.h"
+#include "scene/main/node.h"
+
+namespace TestNodeChildren {
+
+// Parents with a very large number of children: adding them with generated or explicit names, looking them up by
+// path and removing them again.
+
+namespace {
+
+const int CHILD_COUNT = 100000;
+
+double elapsed_ms(uint64_t p_start) {
+    return (OS::get_singleton()->get_ticks_usec() - p_start) / 1000.0;
+}
+
+void remove_all(Node *p_parent) {
+    while (p_parent->get_child_count()) {
+        Node *child = p_parent->get_child(p_parent->get_child_count() - 1);
+        p_parent->remove_child(child);
+        memdelete(child);
+    }
+}
+
+// Every child asks for the same name, so each one needs the next free serial.
+bool test_serial_names(Node *p_parent) {
+
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < CHILD_COUNT; i++) {
+        Node *child = memnew(Node);
+        child->set_name("Bullet");
+        p_parent->add_child(child, true);
+    }
+    const double added = elapsed_ms(start);
+
+    bool ok = p_parent->get_child(0)->get_name() == StringName("Bullet") &&
+              p_parent->get_child(1)->get_name() == StringName("Bullet2") &&
+              p_parent->get_child(CHILD_COUNT - 1)->get_name() == StringName(FormatVE("Bullet%d", CHILD_COUNT));
+
+    // Renaming onto a taken name gets decorated, the old name becomes free again.
+    Node *renamed = p_parent->get_child(10);
+    renamed->set_name("Bullet2");
+    ok = ok && renamed->get_name() != StringName("Bullet2");
+    ok = ok && p_parent->get_node_or_null(NodePath("Bullet2")) == p_parent->get_child(1);
+    ok = ok && p_parent->get_node_or_null(NodePath("Bullet11")) == nullptr;
+    ok = ok && p_parent->get_node_or_null(NodePath(String(renamed->get_name()))) == renamed;
+
+    start = OS::get_singleton()->get_ticks_usec();
+    remove_all(p_parent);
+    const double removed = elapsed_ms(start);
+
+    OS::get_singleton()->print(FormatVE("\t%d children with serial names: %9.2f ms adding, %9.2f ms removing\n",
+            CHILD_COUNT, added, removed));
+    return ok;
+}
+
+// Explicit names, then a lookup by path for each of them.
+bool test_lookup(Node *p_parent) {
+
+    Node *group = memnew(Node);
+    group->set_name("Group");
+    p_parent->add_child(group);
+
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < CHILD_COUNT; i++) {
+        Node *child = memnew(Node);
+        child->set_name(FormatVE("Tile%d", i));
+        group->add_child(child);
+    }
+    const double added = elapsed_ms(start);
+
+    Vector<NodePath> paths;
+    paths.reserve(CHILD_COUNT);
+    for (int i = 0; i < CHILD_COUNT; i++) {
+        paths.emplace_back(FormatVE("Group/Tile%d", (i * 7919) % CHILD_COUNT));
+    }
+
+    bool ok = true;
+    start = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < CHILD_COUNT; i++) {
+        Node *found = p_parent->get_node_or_null(paths[i]);
+        ok = ok && found && found->get_position_in_parent() == (i * 7919) % CHILD_COUNT;
+    }
+    const double looked_up = elapsed_ms(start);
+
+    // A name used by a removed child resolves to nothing, and can be taken again without decoration.
+    Node *last = group->get_child(CHILD_COUNT - 1);
+    group->remove_child(last);
+    ok = ok && p_parent->get_node_or_null(NodePath(FormatVE("Group/Tile%d", CHILD_COUNT - 1))) == nullptr;
+    group->add_child(last);
+    ok = ok && last->get_name() == StringName(FormatVE("Tile%d", CHILD_COUNT - 1));
+
+    start = OS::get_singleton()->get_ticks_usec();
+    remove_all(group);
+    const double removed = elapsed_ms(start);
+
+    p_parent->remove_child(group);
+    memdelete(group);
+
+    OS::get_singleton()->print(FormatVE(
+            "\t%d children with explicit names: %9.2f ms adding, %9.2f ms looking up, %9.2f ms removing\n",
+            CHILD_COUNT, added, looked_up, removed));
+    return ok;
+}
+
+} // namespace
+
+MainLoop *test() {
+
+    Node *root = memnew(Node);
+    root->set_name("Root");
+
+    bool ok = test_serial_names(root);
+    ok = test_lookup(root) && ok;
+
+    memdelete(root);
+
+    OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+    return nullptr;
+}
+
+} // namespace TestNodeChildren
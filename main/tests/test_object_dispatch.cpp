@@ -0,0 +1,151 @@
+/*************************************************************************/
+/*  test_object_dispatch.cpp                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_object_dispatch.h"
+
+#include "core/class_db.h"
+#include "core/method_bind_interface.h"
+#include "core/object.h"
+#include "core/os/os.h"
+#include "core/string_formatter.h"
+#include "scene/2d/node_2d.h"
+
+namespace TestObjectDispatch {
+
+// Measures Object::call/set/get throughput on a class a few levels below Object, once walking the inheritance
+// chain and once through the flattened ClassDB dispatch tables. Both must give the same answers.
+
+namespace {
+
+const int ITERATIONS = 200000;
+
+struct Sample {
+    uint64_t instance_id = 0;
+    Vector2 position;
+    int constant = 0;
+    bool valid = true;
+};
+
+uint64_t run(Node2D *p_node, Sample &r_sample) {
+    const StringName get_instance_id("get_instance_id");
+    const StringName position("position");
+    const StringName notification_ready("NOTIFICATION_READY");
+
+    const uint64_t from = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < ITERATIONS; i++) {
+        Callable::CallError ce;
+        r_sample.instance_id = p_node->call(get_instance_id, nullptr, 0, ce).as<uint64_t>();
+        r_sample.valid = r_sample.valid && ce.error == Callable::CallError::CALL_OK;
+
+        bool valid = false;
+        p_node->set(position, Vector2(i, -i), &valid);
+        r_sample.valid = r_sample.valid && valid;
+        r_sample.position = p_node->get(position, &valid).as<Vector2>();
+        r_sample.valid = r_sample.valid && valid;
+        r_sample.constant = p_node->get(notification_ready, &valid).as<int>();
+        r_sample.valid = r_sample.valid && valid;
+    }
+    return OS::get_singleton()->get_ticks_usec() - from;
+}
+
+bool test_call_set_get() {
+    Node2D *node = memnew(Node2D);
+
+    Sample walked;
+    ClassDB::set_dispatch_tables_enabled(false);
+    const uint64_t walk_usec = run(node, walked);
+
+    Sample flat;
+    ClassDB::build_dispatch_tables();
+    const uint64_t flat_usec = run(node, flat);
+
+    memdelete(node);
+
+    const bool match = walked.valid && flat.valid && walked.instance_id == flat.instance_id &&
+                       walked.position == flat.position && walked.constant == flat.constant &&
+                       flat.constant == Node::NOTIFICATION_READY;
+    OS::get_singleton()->print(FormatVE("\tcall/set/get x%d  chain walk: %8.3f ms  flattened: %8.3f ms  (x%.2f) %s\n",
+            ITERATIONS, walk_usec / 1000.0, flat_usec / 1000.0, double(walk_usec) / M_MAX(flat_usec, uint64_t(1)),
+            match ? "" : "(results differ)"));
+    return match;
+}
+
+bool test_method_cache() {
+    const StringName cls("Node2D");
+    const StringName method("get_instance_id");
+    MethodBind *expected = ClassDB::get_method(cls, method);
+    if (!expected) {
+        OS::get_singleton()->print("\tNode2D.get_instance_id not found\n");
+        return false;
+    }
+
+    bool ok = true;
+    uint64_t from = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < ITERATIONS; i++) {
+        ok = ClassDB::get_method(cls, method) == expected && ok;
+    }
+    const uint64_t lookup_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+    ClassDB_MethodCache cache;
+    from = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < ITERATIONS; i++) {
+        ok = ClassDB::get_method_cached(cache, cls, method) == expected && ok;
+    }
+    const uint64_t cached_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+    // one call site asking for two names must not get the first answer back
+    MethodBind *other = ClassDB::get_method(cls, StringName("get_position"));
+    ok = other && other != expected && ClassDB::get_method_cached(cache, cls, StringName("get_position")) == other && ok;
+    ok = ClassDB::get_method_cached(cache, cls, method) == expected && ok;
+
+    // a registration change has to drop whatever the call site remembered, the tables are rebuilt on the next lookup
+    const uint32_t generation = cache.generation;
+    ClassDB::invalidate_dispatch_tables();
+    ok = ClassDB::get_method_cached(cache, cls, method) == expected && cache.generation != generation && ok;
+    ok = ClassDB::has_method(cls, StringName("get_position")) && ok;
+
+    OS::get_singleton()->print(FormatVE("\tget_method x%d  lookup: %8.3f ms  cached: %8.3f ms  (x%.2f) %s\n",
+            ITERATIONS, lookup_usec / 1000.0, cached_usec / 1000.0,
+            double(lookup_usec) / M_MAX(cached_usec, uint64_t(1)), ok ? "" : "(results differ)"));
+    return ok;
+}
+
+} // namespace
+
+MainLoop *test() {
+
+    bool ok = test_call_set_get();
+    ok = test_method_cache() && ok;
+
+    OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+    return nullptr;
+}
+
+} // namespace TestObjectDispatch
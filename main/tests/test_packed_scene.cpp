@@ -0,0 +1,178 @@
+/*************************************************************************/
+/*  test_packed_scene.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_packed_scene.h"
+
+#include "core/os/os.h"
+#include "core/string_formatter.h"
+#include "scene/2d/node_2d.h"
+#include "scene/main/timer.h"
+#include "scene/resources/packed_scene.h"
+
+namespace TestPackedScene {
+
+// Spawn rate of a small "enemy" scene: a Node2D root with a few children, properties, a group and a connection.
+// Instances through the generic SceneState walk, through the precompiled plan, and in bulk, and checks that the
+// plan produces the same tree.
+
+namespace {
+
+const int SPAWNS = 20000;
+const int CHILDREN = 6;
+
+Ref<PackedScene> make_scene() {
+    Node2D *root = memnew(Node2D);
+    root->set_name("Enemy");
+    root->set_position(Vector2(10, 20));
+    root->set_rotation(0.5f);
+    root->set_z_index(3);
+    root->add_to_group("enemies", true);
+
+    for (int i = 0; i < CHILDREN; i++) {
+        Node2D *part = memnew(Node2D);
+        part->set_name(StringName(FormatVE("Part%d", i)));
+        part->set_position(Vector2(i * 4.0f, -i * 2.0f));
+        part->set_scale(Vector2(0.5f + i, 1.5f));
+        root->add_child(part);
+        part->set_owner(root);
+    }
+
+    Timer *timer = memnew(Timer);
+    timer->set_name("Lifetime");
+    timer->set_wait_time(3.5f);
+    timer->set_one_shot(true);
+    root->add_child(timer);
+    timer->set_owner(root);
+    timer->connect("timeout", Callable(root, "queue_free"), ObjectNS::CONNECT_PERSIST);
+
+    Ref<PackedScene> scene(make_ref_counted<PackedScene>());
+    Error err = scene->pack(root);
+    memdelete(root);
+    ERR_FAIL_COND_V(err != OK, Ref<PackedScene>());
+    return scene;
+}
+
+bool same_tree(Node *p_a, Node *p_b) {
+    if (p_a->get_name() != p_b->get_name() || p_a->get_class_name() != p_b->get_class_name())
+        return false;
+    if (p_a->get_child_count() != p_b->get_child_count())
+        return false;
+    if (p_a->is_in_group("enemies") != p_b->is_in_group("enemies"))
+        return false;
+    if ((p_a->get_owner() == nullptr) != (p_b->get_owner() == nullptr))
+        return false;
+
+    Node2D *a2d = object_cast<Node2D>(p_a);
+    Node2D *b2d = object_cast<Node2D>(p_b);
+    if (a2d && b2d) {
+        if (a2d->get_position() != b2d->get_position() || a2d->get_rotation() != b2d->get_rotation() ||
+                a2d->get_scale() != b2d->get_scale() || a2d->get_z_index() != b2d->get_z_index())
+            return false;
+    }
+    Timer *at = object_cast<Timer>(p_a);
+    Timer *bt = object_cast<Timer>(p_b);
+    if (at && bt) {
+        if (at->get_wait_time() != bt->get_wait_time() || at->is_one_shot() != bt->is_one_shot())
+            return false;
+        if (!at->is_connected("timeout", Callable(at->get_owner(), "queue_free")) ||
+                !bt->is_connected("timeout", Callable(bt->get_owner(), "queue_free")))
+            return false;
+    }
+
+    for (int i = 0; i < p_a->get_child_count(); i++) {
+        if (!same_tree(p_a->get_child(i), p_b->get_child(i)))
+            return false;
+    }
+    return true;
+}
+
+void free_all(Vector<Node *> &r_nodes) {
+    for (Node *n : r_nodes) {
+        memdelete(n);
+    }
+    r_nodes.clear();
+}
+
+void report(const char *p_what, uint64_t p_usec, int p_count) {
+    const double per_sec = p_usec ? p_count * 1000000.0 / p_usec : 0.0;
+    OS::get_singleton()->print(FormatVE("\t%-22s %9.2f ms, %10.0f instances/s\n", p_what, p_usec / 1000.0, per_sec));
+}
+
+} // namespace
+
+MainLoop *test() {
+
+    Ref<PackedScene> scene = make_scene();
+    ERR_FAIL_COND_V(not scene, nullptr);
+
+    const bool was_using_plans = SceneState::is_using_instance_plans();
+    Vector<Node *> spawned;
+    spawned.reserve(SPAWNS);
+
+    OS::get_singleton()->print(FormatVE("%d spawns of a %d node scene:\n", SPAWNS, CHILDREN + 2));
+
+    SceneState::set_use_instance_plans(false);
+    Node *reference = scene->instance();
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < SPAWNS; i++) {
+        spawned.push_back(scene->instance());
+    }
+    report("generic instance()", OS::get_singleton()->get_ticks_usec() - start, SPAWNS);
+    free_all(spawned);
+
+    SceneState::set_use_instance_plans(true);
+    Node *planned = scene->instance(); // also builds the plan, kept out of the timing
+    start = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < SPAWNS; i++) {
+        spawned.push_back(scene->instance());
+    }
+    report("planned instance()", OS::get_singleton()->get_ticks_usec() - start, SPAWNS);
+    free_all(spawned);
+
+    start = OS::get_singleton()->get_ticks_usec();
+    spawned = scene->instance_multiple(SPAWNS);
+    report("instance_multiple()", OS::get_singleton()->get_ticks_usec() - start, SPAWNS);
+
+    bool ok = reference && planned && same_tree(reference, planned) && spawned.size() == SPAWNS;
+    ok = ok && same_tree(reference, spawned.back());
+    free_all(spawned);
+    if (reference)
+        memdelete(reference);
+    if (planned)
+        memdelete(planned);
+
+    SceneState::set_use_instance_plans(was_using_plans);
+    OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+
+    return nullptr;
+}
+
+} // namespace TestPackedScene
@@ -0,0 +1,190 @@
+/*************************************************************************/
+/*  test_packet_peer_udp.cpp                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_packet_peer_udp.h"
+
+#include "core/io/net_socket.h"
+#include "core/io/packet_peer_udp.h"
+#include "core/os/os.h"
+#include "core/string_formatter.h"
+
+namespace TestPacketPeerUDP {
+
+// Loopback datagram throughput, one system call per datagram against recvmmsg/sendmmsg style batches.
+
+namespace {
+
+const int PACKETS = 500000;
+const int BURST = 64; // small enough to never overflow the default socket receive buffer
+const int PAYLOAD = 100;
+
+void report(const char *p_what, uint64_t p_usec, int p_packets) {
+    const double pps = p_usec ? p_packets * 1000000.0 / p_usec : 0.0;
+    OS::get_singleton()->print(FormatVE("\t%-24s %9.2f ms, %10.0f packets/s, %d received\n", p_what, p_usec / 1000.0, pps, p_packets));
+}
+
+Ref<NetSocket> open_socket(uint16_t &r_port) {
+    Ref<NetSocket> sock(NetSocket::create(), DoNotAddRef);
+    IP::Type type = IP::TYPE_IPV4;
+    if (sock->open(NetSocket::TYPE_UDP, type) != OK)
+        return Ref<NetSocket>();
+    sock->set_blocking_enabled(false);
+    for (uint16_t p = 27200; p < 27300; p++) {
+        if (sock->bind(IP_Address("127.0.0.1"), p) == OK) {
+            r_port = p;
+            return sock;
+        }
+    }
+    return Ref<NetSocket>();
+}
+
+// Receives until p_expected datagrams arrived or nothing shows up for a while.
+int receive_single(const Ref<NetSocket> &p_sock, uint8_t *p_buffer, int p_expected) {
+    int got = 0;
+    int idle = 0;
+    IP_Address ip;
+    uint16_t port;
+    while (got < p_expected && idle < 1000) {
+        int read = 0;
+        if (p_sock->recvfrom(p_buffer, 2048, read, ip, port) == OK) {
+            ++got;
+            idle = 0;
+        } else {
+            ++idle;
+        }
+    }
+    return got;
+}
+
+int receive_batch(const Ref<NetSocket> &p_sock, uint8_t *p_buffer, int p_expected) {
+    NetSocket::Datagram batch[BURST];
+    int got = 0;
+    int idle = 0;
+    while (got < p_expected && idle < 1000) {
+        for (int i = 0; i < BURST; i++) {
+            batch[i].buffer = p_buffer + i * 2048;
+            batch[i].size = 2048;
+        }
+        int count = 0;
+        if (p_sock->recvfrom_batch(batch, BURST, count) == OK) {
+            got += count;
+            idle = 0;
+        } else {
+            ++idle;
+        }
+    }
+    return got;
+}
+
+} // namespace
+
+MainLoop *test() {
+
+    uint16_t recv_port = 0;
+    uint16_t send_port = 0;
+    Ref<NetSocket> receiver = open_socket(recv_port);
+    Ref<NetSocket> sender = open_socket(send_port);
+    ERR_FAIL_COND_V_MSG(not receiver || not sender, nullptr, "Could not bind loopback UDP sockets.");
+
+    Vector<uint8_t> payload;
+    payload.resize(PAYLOAD, 0x2A);
+    Vector<uint8_t> buffer;
+    buffer.resize(BURST * 2048);
+    const IP_Address loopback("127.0.0.1");
+
+    NetSocket::Datagram out[BURST];
+    for (int i = 0; i < BURST; i++) {
+        out[i].buffer = payload.data();
+        out[i].size = PAYLOAD;
+        out[i].ip = loopback;
+        out[i].port = recv_port;
+    }
+
+    OS::get_singleton()->print(FormatVE("%d datagrams of %d bytes, bursts of %d:\n", PACKETS, PAYLOAD, BURST));
+
+    int got_single = 0;
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < PACKETS; i += BURST) {
+        int sent = 0;
+        for (int j = 0; j < BURST; j++) {
+            sender->sendto(payload.data(), PAYLOAD, sent, loopback, recv_port);
+        }
+        got_single += receive_single(receiver, buffer.data(), BURST);
+    }
+    report("sendto/recvfrom", OS::get_singleton()->get_ticks_usec() - start, got_single);
+
+    int got_batch = 0;
+    start = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < PACKETS; i += BURST) {
+        int sent = 0;
+        sender->sendto_batch(out, BURST, sent);
+        got_batch += receive_batch(receiver, buffer.data(), sent);
+    }
+    report("batched", OS::get_singleton()->get_ticks_usec() - start, got_batch);
+
+    // Same batches through PacketPeerUDP, which drains the socket into its packet ring.
+    receiver->close();
+    sender->close();
+    Ref<PacketPeerUDP> server(make_ref_counted<PacketPeerUDP>());
+    Ref<PacketPeerUDP> client(make_ref_counted<PacketPeerUDP>());
+    ERR_FAIL_COND_V(server->listen(recv_port, loopback, 1 << 20) != OK, nullptr);
+    client->set_blocking_mode(false);
+
+    int got_peer = 0;
+    start = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < PACKETS; i += BURST) {
+        int sent = 0;
+        client->put_packets(out, BURST, sent);
+        int idle = 0;
+        int round = 0;
+        while (round < sent && idle < 1000) {
+            const uint8_t *packet;
+            int size;
+            if (server->get_packet(&packet, size) == OK) {
+                ++round;
+                idle = 0;
+            } else {
+                ++idle;
+            }
+        }
+        got_peer += round;
+    }
+    report("PacketPeerUDP", OS::get_singleton()->get_ticks_usec() - start, got_peer);
+
+    const int expected = ((PACKETS + BURST - 1) / BURST) * BURST;
+    OS::get_singleton()->print(FormatVE("\t%s\n", got_single == expected && got_batch == expected && got_peer == expected ? "PASS" : "FAILED"));
+
+    server->close();
+    client->close();
+
+    return nullptr;
+}
+
+} // namespace TestPacketPeerUDP
@@ -0,0 +1,199 @@
+/*************************************************************************/
+/*  test_pck_compressed.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_pck_compressed.h"
+
+#include "core/crypto/crypto_core.h"
+#include "core/io/compression.h"
+#include "core/io/file_access_pack.h"
+#include "core/io/marshalls.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/string_formatter.h"
+#include "core/string_utils.h"
+#include "core/version.h"
+#include "core/version_generated.gen.h"
+
+namespace TestPckCompressed {
+
+// Writes a version 2 pack holding a file compressed in PACK_COMPRESSED_BLOCK_SIZE blocks, laid out like the
+// exporter does, and reads it back through the pack source: sequentially, across block boundaries and through
+// the final partial block.
+
+namespace {
+
+const char *PACKED_PATH = "res://test_pck_compressed/blocks.bin";
+// three full blocks and a partial one
+const int DATA_SIZE = 3 * PACK_COMPRESSED_BLOCK_SIZE + 12345;
+
+Vector<uint8_t> make_data(int p_size) {
+    static const char *words[] = { "node", "transform", "Vector3", "material", "mesh", "resource", "0.0", "1.0", "\n" };
+    const int word_count = sizeof(words) / sizeof(words[0]);
+
+    Vector<uint8_t> data;
+    data.resize(p_size);
+    uint32_t state = 0x9E3779B9;
+    int pos = 0;
+    while (pos < p_size) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        for (const char *w = words[state % word_count]; *w && pos < p_size; w++)
+            data[pos++] = *w;
+    }
+    return data;
+}
+
+// Block size, block count, compressed size of every block, then the blocks, see PACK_FILE_COMPRESSED.
+Vector<uint8_t> compress_payload(const Vector<uint8_t> &p_data) {
+    const uint32_t block_count = (p_data.size() + PACK_COMPRESSED_BLOCK_SIZE - 1) / PACK_COMPRESSED_BLOCK_SIZE;
+    const uint64_t table_size = 8 + uint64_t(block_count) * 4;
+
+    Vector<uint8_t> out;
+    out.resize(table_size + uint64_t(block_count) * Compression::get_max_compressed_buffer_size(PACK_COMPRESSED_BLOCK_SIZE, Compression::MODE_ZSTD));
+    encode_uint32(PACK_COMPRESSED_BLOCK_SIZE, &out[0]);
+    encode_uint32(block_count, &out[4]);
+    uint64_t ofs = table_size;
+    for (uint32_t i = 0; i < block_count; i++) {
+        const uint64_t from = uint64_t(i) * PACK_COMPRESSED_BLOCK_SIZE;
+        const int size = eastl::min<uint64_t>(PACK_COMPRESSED_BLOCK_SIZE, p_data.size() - from);
+        const int csize = Compression::compress(&out[ofs], &p_data[from], size, Compression::MODE_ZSTD);
+        encode_uint32(csize, &out[8 + i * 4]);
+        ofs += csize;
+    }
+    out.resize(ofs);
+    return out;
+}
+
+bool write_pack(StringView p_path, const Vector<uint8_t> &p_data) {
+    FileAccess *f = FileAccess::open(p_path, FileAccess::WRITE);
+    if (!f)
+        return false;
+
+    const Vector<uint8_t> payload = compress_payload(p_data);
+    uint8_t md5[16];
+    CryptoCore::md5(p_data.data(), p_data.size(), md5);
+
+    f->store_32(PACK_HEADER_MAGIC);
+    f->store_32(PACK_FORMAT_VERSION);
+    f->store_32(VERSION_MAJOR);
+    f->store_32(VERSION_MINOR);
+    f->store_32(VERSION_PATCH);
+    for (int i = 0; i < 16; i++)
+        f->store_32(0); // reserved
+    f->store_32(1); // file count
+
+    const int path_len = strlen(PACKED_PATH);
+    f->store_32(path_len);
+    f->store_buffer((const uint8_t *)PACKED_PATH, path_len);
+    f->store_64(f->get_position() + 8 + 8 + 16 + 4); // the payload follows this entry
+    f->store_64(p_data.size());
+    f->store_buffer(md5, 16);
+    f->store_32(PACK_FILE_COMPRESSED);
+    f->store_buffer(payload.data(), payload.size());
+
+    memdelete(f);
+    return true;
+}
+
+bool read_at(FileAccess *p_file, const Vector<uint8_t> &p_expected, uint64_t p_pos, uint64_t p_length) {
+    Vector<uint8_t> chunk;
+    chunk.resize(p_length);
+    p_file->seek(p_pos);
+    const uint64_t expected = eastl::min<uint64_t>(p_length, p_expected.size() - p_pos);
+    return p_file->get_buffer(chunk.data(), p_length) == expected && memcmp(chunk.data(), p_expected.data() + p_pos, expected) == 0 &&
+           (expected < p_length || p_file->get_position() == p_pos + p_length);
+}
+
+bool check(const char *p_what, bool p_ok) {
+    OS::get_singleton()->print(FormatVE("\t%-40s %s\n", p_what, p_ok ? "ok" : "FAILED"));
+    return p_ok;
+}
+
+} // namespace
+
+MainLoop *test() {
+
+    PackedData *packed = PackedData::get_singleton();
+    if (!packed) {
+        OS::get_singleton()->print("no packed data, SKIPPED\n");
+        return nullptr;
+    }
+
+    const String path = PathUtils::plus_file(OS::get_singleton()->get_cache_path(), "test_pck_compressed.pck");
+    const Vector<uint8_t> data = make_data(DATA_SIZE);
+    if (!write_pack(path, data) || packed->add_pack(path, true) != OK) {
+        DirAccess::remove_file_or_error(path);
+        OS::get_singleton()->print("can't load the test pack, is the pck pack source available? FAILED\n");
+        return nullptr;
+    }
+
+    FileAccess *f = packed->try_open_path(PACKED_PATH);
+    bool ok = check("open", f != nullptr);
+    if (f) {
+        ok = check("length", f->get_len() == uint64_t(DATA_SIZE)) && ok;
+
+        bool seq_ok = true;
+        Vector<uint8_t> chunk;
+        chunk.resize(10000); // not a divisor of the block size, reads straddle block boundaries
+        uint64_t offset = 0;
+        while (seq_ok && offset < data.size()) {
+            const uint64_t read = f->get_buffer(chunk.data(), chunk.size());
+            seq_ok = read == eastl::min<uint64_t>(chunk.size(), data.size() - offset) && memcmp(chunk.data(), data.data() + offset, read) == 0;
+            offset += read;
+        }
+        ok = check("sequential read", seq_ok && offset == data.size()) && ok;
+
+        bool seek_ok = true;
+        for (int b = 1; b < DATA_SIZE / PACK_COMPRESSED_BLOCK_SIZE + 1; b++) {
+            const uint64_t boundary = uint64_t(b) * PACK_COMPRESSED_BLOCK_SIZE;
+            seek_ok = seek_ok && read_at(f, data, boundary - 100, 200);
+            // back to an earlier block, then forward across the same boundary byte by byte
+            seek_ok = seek_ok && read_at(f, data, 10, 100);
+            f->seek(boundary - 1);
+            seek_ok = seek_ok && f->get_8() == data[boundary - 1] && f->get_8() == data[boundary];
+        }
+        ok = check("seek across block boundaries", seek_ok) && ok;
+
+        const uint64_t last_block = uint64_t(DATA_SIZE / PACK_COMPRESSED_BLOCK_SIZE) * PACK_COMPRESSED_BLOCK_SIZE;
+        bool tail_ok = read_at(f, data, last_block, DATA_SIZE - last_block);
+        tail_ok = tail_ok && read_at(f, data, DATA_SIZE - 500, 1000) && f->eof_reached();
+        ok = check("final partial block", tail_ok) && ok;
+
+        memdelete(f);
+    }
+
+    DirAccess::remove_file_or_error(path);
+    OS::get_singleton()->print(ok ? "PASS\n" : "FAILED\n");
+    return nullptr;
+}
+
+} // namespace TestPckCompressed
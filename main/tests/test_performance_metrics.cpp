@@ -0,0 +1,189 @@
+/*************************************************************************/
+/*  test_performance_metrics.cpp                                         */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_performance_metrics.h"
+
+#include "core/dictionary.h"
+#include "core/io/json.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/string_formatter.h"
+#include "core/variant.h"
+#include "main/performance.h"
+
+namespace TestPerformanceMetrics {
+
+// Custom counters, gauges and histograms updated from several threads at once, their percentiles, and the JSON
+// lines written by the exporter.
+
+namespace {
+
+const int THREAD_COUNT = 4;
+const int UPDATES_PER_THREAD = 250000;
+
+struct Ids {
+    int counter;
+    int histogram;
+};
+
+void update_metrics(void *p_userdata) {
+
+    const Ids *ids = static_cast<const Ids *>(p_userdata);
+    Performance *performance = Performance::get_singleton();
+    for (int i = 0; i < UPDATES_PER_THREAD; i++) {
+        performance->increment_metric(ids->counter);
+        // 1 to 1000 milliseconds, evenly spread.
+        performance->record_metric(ids->histogram, ((i % 1000) + 1) / 1000.0);
+    }
+}
+
+bool close_to(double p_value, double p_expected) {
+    // Histogram buckets are a quarter octave wide.
+    return p_value >= p_expected * 0.99 && p_value <= p_expected * 1.2;
+}
+
+bool test_threads() {
+
+    Performance *performance = Performance::get_singleton();
+    Ids ids = { performance->register_metric("test/updates", Performance::METRIC_COUNTER),
+        performance->register_metric("test/latency", Performance::METRIC_HISTOGRAM) };
+    const int64_t counter_start = int64_t(performance->get_metric(ids.counter));
+
+    const uint64_t start = OS::get_singleton()->get_ticks_usec();
+    Thread threads[THREAD_COUNT];
+    for (Thread &thread : threads) {
+        thread.start(update_metrics, &ids);
+    }
+    for (Thread &thread : threads) {
+        thread.wait_to_finish();
+    }
+    const double elapsed = OS::get_singleton()->get_ticks_usec() - start;
+
+    bool ok = int64_t(performance->get_metric(ids.counter)) - counter_start == THREAD_COUNT * UPDATES_PER_THREAD;
+    ok = ok && close_to(performance->get_metric(ids.histogram), 0.5005);
+    const double p50 = performance->get_metric_percentile(ids.histogram, 0.5f);
+    const double p95 = performance->get_metric_percentile(ids.histogram, 0.95f);
+    const double p99 = performance->get_metric_percentile(ids.histogram, 0.99f);
+    ok = ok && close_to(p50, 0.5) && close_to(p95, 0.95) && close_to(p99, 0.99);
+
+    OS::get_singleton()->print(FormatVE("\t%d threads, %.1f ns per update; p50 %.3f p95 %.3f p99 %.3f: %s\n", THREAD_COUNT,
+            elapsed * 1000.0 / (THREAD_COUNT * UPDATES_PER_THREAD * 2), p50, p95, p99, ok ? "ok" : "wrong"));
+    return ok;
+}
+
+bool test_json() {
+
+    Performance *performance = Performance::get_singleton();
+    const int gauge = performance->register_metric("test/players", Performance::METRIC_GAUGE);
+    const int histogram = performance->register_metric("test/json_latency", Performance::METRIC_HISTOGRAM);
+    performance->set_metric(gauge, 12);
+    performance->record_metric(histogram, 0.25);
+
+    bool ok = performance->register_metric("test/players", Performance::METRIC_COUNTER) == -1;
+    ok = ok && performance->find_metric("test/players") == gauge;
+
+    Variant parsed;
+    String err_str;
+    int err_line;
+    ok = ok && JSON::parse(performance->get_metrics_json(false), parsed, err_str, err_line) == OK;
+    Dictionary metrics = parsed.as<Dictionary>()["metrics"].as<Dictionary>();
+    ok = ok && metrics["test/players"].as<double>() == 12.0;
+    Dictionary latency = metrics["test/json_latency"].as<Dictionary>();
+    ok = ok && latency["count"].as<int>() == 1 && latency["max"].as<double>() == 0.25;
+    // Only exporting starts a new histogram window, taking a snapshot leaves it alone.
+    ok = ok && performance->get_metric(histogram) == 0.25;
+
+    OS::get_singleton()->print(FormatVE("\tJSON snapshot: %s\n", ok ? "ok" : "wrong"));
+    return ok;
+}
+
+bool test_export() {
+
+    Performance *performance = Performance::get_singleton();
+    const String path = OS::get_singleton()->get_cache_path() + "/test_performance_metrics.jsonl";
+    if (FileAccess::exists(path)) {
+        DirAccess::remove_file_or_error(path);
+    }
+    const String old_target = performance->get_metrics_export();
+
+    const int histogram = performance->register_metric("test/export_latency", Performance::METRIC_HISTOGRAM);
+    performance->record_metric(histogram, 0.5);
+
+    bool ok = performance->set_metrics_export(path, 0.001f) == OK;
+    int frames = 0;
+    const uint64_t start = OS::get_singleton()->get_ticks_usec();
+    while (OS::get_singleton()->get_ticks_usec() - start < 20000) {
+        OS::get_singleton()->delay_usec(2000);
+        performance->process_frame(2000);
+        frames++;
+    }
+    performance->set_metrics_export(old_target);
+    // Exporting starts a new histogram window.
+    ok = ok && performance->get_metric(histogram) == 0.0;
+
+    int lines = 0;
+    FileAccess *f = FileAccess::open(path, FileAccess::READ);
+    ok = ok && f;
+    if (f) {
+        while (!f->eof_reached()) {
+            String line = f->get_line();
+            if (line.empty()) {
+                continue;
+            }
+            Variant parsed;
+            String err_str;
+            int err_line;
+            ok = ok && JSON::parse(line, parsed, err_str, err_line) == OK;
+            lines++;
+        }
+        memdelete(f);
+        DirAccess::remove_file_or_error(path);
+    }
+    ok = ok && lines > 0 && lines <= frames;
+
+    OS::get_singleton()->print(FormatVE("\t%d lines exported over %d frames: %s\n", lines, frames, ok ? "ok" : "wrong"));
+    return ok;
+}
+
+} // namespace
+
+MainLoop *test() {
+
+    bool ok = test_threads();
+    ok = test_json() && ok;
+    ok = test_export() && ok;
+
+    OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+    return nullptr;
+}
+
+} // namespace TestPerformanceMetrics
@@ -0,0 +1,332 @@
+/*************************************************************************/
+/*  test_physics_queries.cpp                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_physics_queries.h"
+
+#include "core/math/math_funcs.h"
+#include "core/math/transform.h"
+#include "core/math/transform_2d.h"
+#include "core/os/os.h"
+#include "core/string_formatter.h"
+#include "servers/physics_server_2d.h"
+#include "servers/physics_server_3d.h"
+
+namespace TestPhysicsQueries {
+
+// A field of static boxes queried by many random rays, overlap tests and shape casts, once through the
+// single query API and once through the batched one. The answers must match, reports the time of both.
+
+namespace {
+
+const int FIELD_SIDE = 40; // FIELD_SIDE^2 boxes
+const float SPACING = 4.0f;
+const int RAY_COUNT = 20000;
+const int SHAPE_COUNT = 5000;
+const int RESULT_MAX = 8;
+
+float field_extent() {
+    return FIELD_SIDE * SPACING;
+}
+
+bool report(const char *p_label, uint64_t p_single_usec, uint64_t p_batch_usec, bool p_match) {
+    OS::get_singleton()->print(FormatVE("\t%-20s single: %8.3f ms  batched: %8.3f ms  (x%.2f) %s\n", p_label,
+            p_single_usec / 1000.0, p_batch_usec / 1000.0, double(p_single_usec) / M_MAX(p_batch_usec, uint64_t(1)),
+            p_match ? "" : "(results differ)"));
+    return p_match;
+}
+
+bool test_3d() {
+    PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+    if (!ps) {
+        OS::get_singleton()->print("\tno 3D physics server, skipped\n");
+        return true;
+    }
+    OS::get_singleton()->print(FormatVE("%s, %d boxes:\n", ps->get_class(), FIELD_SIDE * FIELD_SIDE));
+
+    RID box = ps->shape_create(PhysicsServer3D::SHAPE_BOX);
+    ps->shape_set_data(box, Vector3(1, 1, 1));
+    RID sphere = ps->shape_create(PhysicsServer3D::SHAPE_SPHERE);
+    ps->shape_set_data(sphere, 1.5f);
+
+    RID space = ps->space_create();
+    ps->space_set_active(space, true);
+    Vector<RID> bodies;
+    for (int i = 0; i < FIELD_SIDE * FIELD_SIDE; i++) {
+        RID body = ps->body_create(PhysicsServer3D::BODY_MODE_STATIC);
+        ps->body_add_shape(body, box);
+        const Vector3 origin((i % FIELD_SIDE) * SPACING, Math::random(-1.0f, 1.0f), (i / FIELD_SIDE) * SPACING);
+        ps->body_set_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform(Basis(), origin));
+        ps->body_set_space(body, space);
+        bodies.push_back(body);
+    }
+    ps->step(1.0f / 60.0f);
+    ps->flush_queries();
+
+    PhysicsDirectSpaceState3D *state = ps->space_get_direct_state(space);
+    bool ok = true;
+
+    {
+        Vector<PhysicsDirectSpaceState3D::RayQuery> queries;
+        queries.resize(RAY_COUNT);
+        for (PhysicsDirectSpaceState3D::RayQuery &q : queries) {
+            q.from = Vector3(Math::random(0.0f, field_extent()), 10, Math::random(0.0f, field_extent()));
+            q.to = q.from + Vector3(Math::random(-20.0f, 20.0f), -20, Math::random(-20.0f, 20.0f));
+        }
+        Vector<PhysicsDirectSpaceState3D::RayResult> single(RAY_COUNT), batched(RAY_COUNT);
+        Vector<bool> single_hits(RAY_COUNT, false), batched_hits(RAY_COUNT, false);
+
+        uint64_t from = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < RAY_COUNT; i++) {
+            single_hits[i] = state->intersect_ray(queries[i].from, queries[i].to, single[i]);
+        }
+        const uint64_t single_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+        from = OS::get_singleton()->get_ticks_usec();
+        state->intersect_rays(queries.data(), RAY_COUNT, batched.data(), batched_hits.data());
+        const uint64_t batch_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+        bool match = true;
+        for (int i = 0; i < RAY_COUNT && match; i++) {
+            match = single_hits[i] == batched_hits[i] &&
+                    (!single_hits[i] || (single[i].rid == batched[i].rid &&
+                                                single[i].position.is_equal_approx(batched[i].position)));
+        }
+        ok = report("rays", single_usec, batch_usec, match) && ok;
+    }
+
+    Vector<PhysicsDirectSpaceState3D::ShapeQuery> shape_queries;
+    shape_queries.resize(SHAPE_COUNT);
+    for (PhysicsDirectSpaceState3D::ShapeQuery &q : shape_queries) {
+        q.shape = sphere;
+        q.transform.origin = Vector3(Math::random(0.0f, field_extent()), Math::random(-2.0f, 4.0f),
+                Math::random(0.0f, field_extent()));
+        q.motion = Vector3(Math::random(-10.0f, 10.0f), -5, Math::random(-10.0f, 10.0f));
+    }
+
+    {
+        Vector<PhysicsDirectSpaceState3D::ShapeResult> single(SHAPE_COUNT * RESULT_MAX);
+        Vector<PhysicsDirectSpaceState3D::ShapeResult> batched(SHAPE_COUNT * RESULT_MAX);
+        Vector<int> single_counts(SHAPE_COUNT, 0), batched_counts(SHAPE_COUNT, 0);
+
+        uint64_t from = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < SHAPE_COUNT; i++) {
+            const PhysicsDirectSpaceState3D::ShapeQuery &q = shape_queries[i];
+            single_counts[i] =
+                    state->intersect_shape(q.shape, q.transform, q.margin, &single[i * RESULT_MAX], RESULT_MAX);
+        }
+        const uint64_t single_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+        from = OS::get_singleton()->get_ticks_usec();
+        state->intersect_shapes(shape_queries.data(), SHAPE_COUNT, batched.data(), RESULT_MAX, batched_counts.data());
+        const uint64_t batch_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+        bool match = single_counts == batched_counts;
+        for (int i = 0; i < SHAPE_COUNT * RESULT_MAX && match; i++) {
+            match = i % RESULT_MAX >= single_counts[i / RESULT_MAX] || single[i].rid == batched[i].rid;
+        }
+        ok = report("overlaps", single_usec, batch_usec, match) && ok;
+    }
+
+    {
+        Vector<PhysicsDirectSpaceState3D::CastMotionResult> single(SHAPE_COUNT), batched(SHAPE_COUNT);
+
+        uint64_t from = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < SHAPE_COUNT; i++) {
+            const PhysicsDirectSpaceState3D::ShapeQuery &q = shape_queries[i];
+            single[i].closest_safe = 1;
+            single[i].closest_unsafe = 1;
+            state->cast_motion(
+                    q.shape, q.transform, q.motion, q.margin, single[i].closest_safe, single[i].closest_unsafe);
+        }
+        const uint64_t single_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+        from = OS::get_singleton()->get_ticks_usec();
+        state->cast_motions(shape_queries.data(), SHAPE_COUNT, batched.data());
+        const uint64_t batch_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+        bool match = true;
+        for (int i = 0; i < SHAPE_COUNT && match; i++) {
+            match = Math::is_equal_approx(single[i].closest_safe, batched[i].closest_safe) &&
+                    Math::is_equal_approx(single[i].closest_unsafe, batched[i].closest_unsafe);
+        }
+        ok = report("shape casts", single_usec, batch_usec, match) && ok;
+    }
+
+    for (RID body : bodies)
+        ps->free_rid(body);
+    ps->free_rid(space);
+    ps->free_rid(box);
+    ps->free_rid(sphere);
+    return ok;
+}
+
+bool test_2d() {
+    PhysicsServer2D *ps = PhysicsServer2D::get_singleton();
+    if (!ps) {
+        OS::get_singleton()->print("\tno 2D physics server, skipped\n");
+        return true;
+    }
+    OS::get_singleton()->print(FormatVE("%s, %d boxes:\n", ps->get_class(), FIELD_SIDE * FIELD_SIDE));
+
+    RID box = ps->rectangle_shape_create();
+    ps->shape_set_data(box, Vector2(16, 16));
+    RID circle = ps->circle_shape_create();
+    ps->shape_set_data(circle, 24.0f);
+
+    // 2D units are pixels
+    const float scale = 16.0f;
+
+    RID space = ps->space_create();
+    ps->space_set_active(space, true);
+    Vector<RID> bodies;
+    for (int i = 0; i < FIELD_SIDE * FIELD_SIDE; i++) {
+        RID body = ps->body_create();
+        ps->body_set_mode(body, PhysicsServer2D::BODY_MODE_STATIC);
+        ps->body_add_shape(body, box);
+        const Vector2 origin(
+                (i % FIELD_SIDE) * SPACING * scale + Math::random(-8.0f, 8.0f), (i / FIELD_SIDE) * SPACING * scale);
+        ps->body_set_state(body, PhysicsServer2D::BODY_STATE_TRANSFORM, Transform2D(0, origin));
+        ps->body_set_space(body, space);
+        bodies.push_back(body);
+    }
+    ps->step(1.0f / 60.0f);
+    ps->flush_queries();
+
+    PhysicsDirectSpaceState2D *state = ps->space_get_direct_state(space);
+    const float extent = field_extent() * scale;
+    bool ok = true;
+
+    {
+        Vector<PhysicsDirectSpaceState2D::RayQuery> queries;
+        queries.resize(RAY_COUNT);
+        for (PhysicsDirectSpaceState2D::RayQuery &q : queries) {
+            q.from = Vector2(Math::random(0.0f, extent), Math::random(0.0f, extent));
+            q.to = q.from + Vector2(Math::random(-320.0f, 320.0f), Math::random(-320.0f, 320.0f));
+        }
+        Vector<PhysicsDirectSpaceState2D::RayResult> single(RAY_COUNT), batched(RAY_COUNT);
+        Vector<bool> single_hits(RAY_COUNT, false), batched_hits(RAY_COUNT, false);
+
+        uint64_t from = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < RAY_COUNT; i++) {
+            single_hits[i] = state->intersect_ray(queries[i].from, queries[i].to, single[i]);
+        }
+        const uint64_t single_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+        from = OS::get_singleton()->get_ticks_usec();
+        state->intersect_rays(queries.data(), RAY_COUNT, batched.data(), batched_hits.data());
+        const uint64_t batch_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+        bool match = true;
+        for (int i = 0; i < RAY_COUNT && match; i++) {
+            match = single_hits[i] == batched_hits[i] &&
+                    (!single_hits[i] || (single[i].rid == batched[i].rid &&
+                                                single[i].position.is_equal_approx(batched[i].position)));
+        }
+        ok = report("rays", single_usec, batch_usec, match) && ok;
+    }
+
+    Vector<PhysicsDirectSpaceState2D::ShapeQuery> shape_queries;
+    shape_queries.resize(SHAPE_COUNT);
+    for (PhysicsDirectSpaceState2D::ShapeQuery &q : shape_queries) {
+        q.shape = circle;
+        q.transform = Transform2D(0, Vector2(Math::random(0.0f, extent), Math::random(0.0f, extent)));
+        q.motion = Vector2(Math::random(-160.0f, 160.0f), Math::random(-160.0f, 160.0f));
+    }
+
+    {
+        Vector<PhysicsDirectSpaceState2D::ShapeResult> single(SHAPE_COUNT * RESULT_MAX);
+        Vector<PhysicsDirectSpaceState2D::ShapeResult> batched(SHAPE_COUNT * RESULT_MAX);
+        Vector<int> single_counts(SHAPE_COUNT, 0), batched_counts(SHAPE_COUNT, 0);
+
+        uint64_t from = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < SHAPE_COUNT; i++) {
+            const PhysicsDirectSpaceState2D::ShapeQuery &q = shape_queries[i];
+            single_counts[i] = state->intersect_shape(
+                    q.shape, q.transform, q.motion, q.margin, &single[i * RESULT_MAX], RESULT_MAX);
+        }
+        const uint64_t single_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+        from = OS::get_singleton()->get_ticks_usec();
+        state->intersect_shapes(shape_queries.data(), SHAPE_COUNT, batched.data(), RESULT_MAX, batched_counts.data());
+        const uint64_t batch_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+        bool match = single_counts == batched_counts;
+        for (int i = 0; i < SHAPE_COUNT * RESULT_MAX && match; i++) {
+            match = i % RESULT_MAX >= single_counts[i / RESULT_MAX] || single[i].rid == batched[i].rid;
+        }
+        ok = report("overlaps", single_usec, batch_usec, match) && ok;
+    }
+
+    {
+        Vector<PhysicsDirectSpaceState2D::CastMotionResult> single(SHAPE_COUNT), batched(SHAPE_COUNT);
+
+        uint64_t from = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < SHAPE_COUNT; i++) {
+            const PhysicsDirectSpaceState2D::ShapeQuery &q = shape_queries[i];
+            single[i].closest_safe = 1;
+            single[i].closest_unsafe = 1;
+            state->cast_motion(
+                    q.shape, q.transform, q.motion, q.margin, single[i].closest_safe, single[i].closest_unsafe);
+        }
+        const uint64_t single_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+        from = OS::get_singleton()->get_ticks_usec();
+        state->cast_motions(shape_queries.data(), SHAPE_COUNT, batched.data());
+        const uint64_t batch_usec = OS::get_singleton()->get_ticks_usec() - from;
+
+        bool match = true;
+        for (int i = 0; i < SHAPE_COUNT && match; i++) {
+            match = Math::is_equal_approx(single[i].closest_safe, batched[i].closest_safe) &&
+                    Math::is_equal_approx(single[i].closest_unsafe, batched[i].closest_unsafe);
+        }
+        ok = report("shape casts", single_usec, batch_usec, match) && ok;
+    }
+
+    for (RID body : bodies)
+        ps->free_rid(body);
+    ps->free_rid(space);
+    ps->free_rid(box);
+    ps->free_rid(circle);
+    return ok;
+}
+
+} // namespace
+
+MainLoop *test() {
+
+    bool ok = test_3d();
+    ok = test_2d() && ok;
+
+    OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+    return nullptr;
+}
+
+} // namespace TestPhysicsQueries
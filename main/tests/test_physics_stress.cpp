@@ -0,0 +1,221 @@
+/*************************************************************************/
+/*  test_physics_stress.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_physics_stress.h"
+
+#include "core/math/transform.h"
+#include "core/os/os.h"
+#include "core/project_settings.h"
+#include "core/string_formatter.h"
+#include "servers/physics_server_3d.h"
+
+namespace TestPhysicsStress {
+
+// Piles of boxes falling on a floor in a few independent spaces, stepped with the Bullet threading options
+// for an increasing number of threads. Reports the average step time of each configuration.
+
+namespace {
+
+const int SPACE_COUNT = 4;
+const int PILE_SIDE = 10; // PILE_SIDE^3 boxes per space
+const int WARMUP_STEPS = 10;
+const int STEPS = 240;
+const float STEP_TIME = 1.0f / 60.0f;
+
+struct Scene {
+    RID box;
+    RID floor;
+    Vector<RID> spaces;
+    Vector<RID> bodies;
+};
+
+void build_scene(Scene &r_scene) {
+    PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+
+    r_scene.box = ps->shape_create(PhysicsServer3D::SHAPE_BOX);
+    ps->shape_set_data(r_scene.box, Vector3(0.5f, 0.5f, 0.5f));
+    r_scene.floor = ps->shape_create(PhysicsServer3D::SHAPE_PLANE);
+    ps->shape_set_data(r_scene.floor, Plane(Vector3(0, 1, 0), 0));
+
+    for (int s = 0; s < SPACE_COUNT; s++) {
+        RID space = ps->space_create();
+        ps->space_set_active(space, true);
+        r_scene.spaces.push_back(space);
+
+        RID ground = ps->body_create(PhysicsServer3D::BODY_MODE_STATIC);
+        ps->body_add_shape(ground, r_scene.floor);
+        ps->body_set_space(ground, space);
+        r_scene.bodies.push_back(ground);
+
+        for (int i = 0; i < PILE_SIDE * PILE_SIDE * PILE_SIDE; i++) {
+            const int x = i % PILE_SIDE;
+            const int y = i / (PILE_SIDE * PILE_SIDE);
+            const int z = (i / PILE_SIDE) % PILE_SIDE;
+            // slightly staggered layers so the pile collapses instead of resting
+            const Vector3 origin(x * 1.1f + (y & 1) * 0.3f, 0.6f + y * 1.2f, z * 1.1f + (y & 1) * 0.2f);
+
+            RID body = ps->body_create(PhysicsServer3D::BODY_MODE_RIGID);
+            ps->body_add_shape(body, r_scene.box);
+            ps->body_set_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM, Transform(Basis(), origin));
+            ps->body_set_space(body, space);
+            r_scene.bodies.push_back(body);
+        }
+    }
+}
+
+void free_scene(Scene &r_scene) {
+    PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+    for (RID body : r_scene.bodies)
+        ps->free_rid(body);
+    for (RID space : r_scene.spaces)
+        ps->free_rid(space);
+    ps->free_rid(r_scene.box);
+    ps->free_rid(r_scene.floor);
+    r_scene = Scene();
+}
+
+// The boxes must have stayed above the floor, with sane positions.
+bool check_scene(const Scene &p_scene) {
+    PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+    for (RID body : p_scene.bodies) {
+        const Transform t = ps->body_get_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM).as<Transform>();
+        const Vector3 &o = t.origin;
+        if (!(o.y > -1.0f && o.y < PILE_SIDE * 2.0f && Math::abs(o.x) < 1000.0f && Math::abs(o.z) < 1000.0f))
+            return false;
+    }
+    return true;
+}
+
+// Where every body ended up, in creation order.
+Vector<Vector3> body_positions(const Scene &p_scene) {
+    PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+    Vector<Vector3> positions;
+    for (RID body : p_scene.bodies) {
+        positions.push_back(ps->body_get_state(body, PhysicsServer3D::BODY_STATE_TRANSFORM).as<Transform>().origin);
+    }
+    return positions;
+}
+
+bool run(const char *p_label, int p_threads, Vector<Vector3> *r_positions = nullptr) {
+    PhysicsServer3D *ps = PhysicsServer3D::get_singleton();
+
+    Scene scene;
+    build_scene(scene);
+    for (int i = 0; i < WARMUP_STEPS; i++) {
+        ps->step(STEP_TIME);
+        ps->flush_queries();
+    }
+
+    const uint64_t from = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < STEPS; i++) {
+        ps->step(STEP_TIME);
+        ps->flush_queries();
+    }
+    const uint64_t usec = OS::get_singleton()->get_ticks_usec() - from;
+
+    const bool ok = check_scene(scene);
+    if (r_positions) {
+        *r_positions = body_positions(scene);
+    }
+    free_scene(scene);
+
+    OS::get_singleton()->print(FormatVE("\t%-28s %2d threads: %8.3f ms/step %s\n", p_label, p_threads,
+            usec / 1000.0 / STEPS, ok ? "" : "(bodies out of bounds)"));
+    return ok;
+}
+
+} // namespace
+
+MainLoop *test() {
+
+    PhysicsServer3D *physics = PhysicsServer3D::get_singleton();
+    ERR_FAIL_COND_V(!physics, nullptr);
+
+    const StringName soft_world_setting("physics/3d/active_soft_world");
+    const StringName mt_world_setting("physics/3d/bullet/multithreaded_world");
+    const StringName parallel_spaces_setting("physics/3d/bullet/parallel_spaces");
+    const StringName thread_count_setting("physics/3d/bullet/thread_count");
+    ProjectSettings *ps = ProjectSettings::get_singleton();
+    const Variant old_soft_world = ps->get(soft_world_setting);
+    const Variant old_mt_world = ps->get(mt_world_setting);
+    const Variant old_parallel_spaces = ps->get(parallel_spaces_setting);
+    const Variant old_thread_count = ps->get(thread_count_setting);
+
+    OS::get_singleton()->print(FormatVE("%s, %d spaces of %d boxes, %d cores:\n", physics->get_class(), SPACE_COUNT,
+            PILE_SIDE * PILE_SIDE * PILE_SIDE, OS::get_singleton()->get_processor_count()));
+
+    // The threading options are read when the server starts
+    auto configure = [&](bool p_mt_world, bool p_parallel_spaces, int p_threads) {
+        ps->set(soft_world_setting, false);
+        ps->set(mt_world_setting, p_mt_world);
+        ps->set(parallel_spaces_setting, p_parallel_spaces);
+        ps->set(thread_count_setting, p_threads);
+        physics->finish();
+        physics->init();
+    };
+
+    configure(false, false, 1);
+    Vector<Vector3> serial;
+    bool ok = run("single threaded", 1, &serial);
+
+    const int max_threads = OS::get_singleton()->get_default_thread_pool_size();
+    for (int threads = 2; threads <= max_threads; threads *= 2) {
+        configure(true, false, threads);
+        ok = run("multithreaded world", threads) && ok;
+        // Each space still steps on one thread and dispatches its callbacks at the same point, so the result must
+        // not depend on the spaces being stepped together.
+        configure(false, true, threads);
+        Vector<Vector3> parallel;
+        ok = run("parallel spaces", threads, &parallel) && ok;
+        bool same = parallel.size() == serial.size();
+        for (size_t i = 0; same && i < serial.size(); i++) {
+            same = serial[i].is_equal_approx(parallel[i]);
+        }
+        if (!same) {
+            OS::get_singleton()->print("	parallel spaces ended up somewhere else than the serial step\n");
+        }
+        ok = same && ok;
+        configure(true, true, threads);
+        ok = run("both", threads) && ok;
+    }
+
+    ps->set(soft_world_setting, old_soft_world);
+    ps->set(mt_world_setting, old_mt_world);
+    ps->set(parallel_spaces_setting, old_parallel_spaces);
+    ps->set(thread_count_setting, old_thread_count);
+    physics->finish();
+    physics->init();
+
+    OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+    return nullptr;
+}
+
+} // namespace TestPhysicsStress
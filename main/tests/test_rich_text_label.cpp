@@ -0,0 +1,141 @@
+/*************************************************************************/
+/*  test_rich_text_label.cpp                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "test_rich_text_label.h"
+
+#include "core/os/os.h"
+#include "core/string_formatter.h"
+#include "scene/gui/rich_text_label.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+
+namespace TestRichTextLabel {
+
+// Cost of growing a log-style label line by line: each append should only lay out the new line, and scrolling or
+// hit-testing should not depend on how much text is already there.
+
+class TestMainLoop : public SceneTree {
+
+    RichTextLabel *label = nullptr;
+
+    void append_line(int p_idx) {
+        label->push_color(Color(0.5f + (p_idx % 5) * 0.1f, 1, 1));
+        label->add_text(FormatVE("[%06d] ", p_idx));
+        label->pop();
+        label->add_text(FormatVE("Log message number %d with enough words in it to wrap at narrow widths.", p_idx));
+        label->add_newline();
+    }
+
+    void report(const char *p_what, uint64_t p_usec) {
+        OS::get_singleton()->print(FormatVE("\t%-36s %9.2f ms\n", p_what, p_usec / 1000.0));
+    }
+
+public:
+    void init() override {
+
+        SceneTree::init();
+
+        const int lines = 100000;
+        const int batch = 1000;
+
+        label = memnew(RichTextLabel);
+        get_root()->add_child(label);
+        label->set_size(Size2(800, 600));
+        label->set_scroll_follow(true);
+
+        OS::get_singleton()->print(FormatVE("%d lines, laid out every %d:\n", lines, batch));
+
+        // get_content_height() validates the line caches, like the draw that follows an append would.
+        uint64_t first_batch = 0;
+        uint64_t last_batch = 0;
+        const uint64_t start_all = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < lines; i += batch) {
+            const uint64_t start = OS::get_singleton()->get_ticks_usec();
+            for (int j = i; j < i + batch; j++) {
+                append_line(j);
+            }
+            label->get_content_height();
+            const uint64_t elapsed = OS::get_singleton()->get_ticks_usec() - start;
+            if (i == 0) {
+                first_batch = elapsed;
+            }
+            last_batch = elapsed;
+        }
+        report("append all", OS::get_singleton()->get_ticks_usec() - start_all);
+        report("first batch", first_batch);
+        report("last batch", last_batch);
+
+        const int content_height = label->get_content_height();
+        const int total_chars = label->get_total_character_count();
+
+        uint64_t start = OS::get_singleton()->get_ticks_usec();
+        int pointer = 0;
+        for (int i = 0; i < 10000; i++) {
+            label->scroll_to_line((i * 7919) % label->get_line_count());
+            pointer += label->get_cursor_shape(Point2(100, 300)) == Control::CURSOR_ARROW;
+        }
+        report("scroll + hit test x10000", OS::get_singleton()->get_ticks_usec() - start);
+
+        // Changing only the height keeps every line break.
+        start = OS::get_singleton()->get_ticks_usec();
+        label->set_size(Size2(800, 400));
+        label->get_content_height();
+        report("height-only resize", OS::get_singleton()->get_ticks_usec() - start);
+
+        start = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < 1000; i++) {
+            label->remove_line(0);
+            append_line(lines + i);
+            label->get_content_height();
+        }
+        report("trim first + append x1000", OS::get_singleton()->get_ticks_usec() - start);
+
+        // A full relayout must agree with the incrementally maintained caches.
+        const int incremental_height = label->get_content_height();
+        const int incremental_chars = label->get_total_character_count();
+        start = OS::get_singleton()->get_ticks_usec();
+        label->set_tab_size(label->get_tab_size());
+        const bool ok = label->get_line_count() == lines + 1 && label->get_content_height() == incremental_height &&
+                        label->get_total_character_count() == incremental_chars;
+        report("full relayout", OS::get_singleton()->get_ticks_usec() - start);
+
+        OS::get_singleton()->print(FormatVE("\theight %d, %d chars, %d pointer hits\n\t%s\n", content_height, total_chars, pointer, ok ? "PASS" : "FAILED"));
+
+        quit();
+    }
+};
+
+MainLoop *test() {
+
+    return memnew(TestMainLoop);
+}
+
+} // namespace TestRichTextLabel
@@ -0,0 +1,189 @@
+/*************************************************************************/
+/*  test_shader_compile.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_shader_compile.h"
+
+#include "core/os/os.h"
+#include "core/string_formatter.h"
+#include "drivers/gles3/shader_compiler_gles3.h"
+#include "servers/rendering/shader_language.h"
+#include "servers/rendering/shader_types.h"
+
+namespace TestShaderCompile {
+
+// CPU side of loading a level full of materials: parsing and translating a corpus of shaders to GLSL, one at a
+// time and as a batch. No GL context is involved, the batch must produce exactly the serial output.
+
+namespace {
+
+const int SHADER_COUNT = 400;
+
+struct Source {
+    RS::ShaderMode mode;
+    String code;
+    String path;
+};
+
+Source make_shader(int p_index) {
+
+    Source res;
+    res.path = FormatVE("res://corpus/shader_%d.shader", p_index);
+
+    if (p_index % 4 == 3) {
+        res.mode = RS::ShaderMode::CANVAS_ITEM;
+        res.code = FormatVE(
+                "shader_type canvas_item;\n"
+                "uniform vec4 tint_%d : hint_color = vec4(1.0);\n"
+                "uniform float strength : hint_range(0, 1) = 0.5;\n"
+                "void fragment() {\n"
+                "\tvec4 c = texture(TEXTURE, UV) * tint_%d;\n"
+                "\tCOLOR = mix(c, vec4(c.rgb * strength, c.a), 0.5);\n"
+                "}\n",
+                p_index, p_index);
+        return res;
+    }
+
+    res.mode = RS::ShaderMode::SPATIAL;
+    res.code = FormatVE(
+            "shader_type spatial;\n"
+            "render_mode blend_mix, cull_back;\n"
+            "uniform vec4 albedo_%d : hint_color = vec4(1.0);\n"
+            "uniform sampler2D albedo_texture : hint_albedo;\n"
+            "uniform float roughness : hint_range(0, 1) = 0.5;\n"
+            "varying vec3 world_pos;\n"
+            "float wave(float x) {\n"
+            "\tfloat y = x * x;\n",
+            p_index);
+    // vary the size of the shaders a bit
+    for (int i = 0; i < 4 + p_index % 12; i++) {
+        res.code += FormatVE("\ty += sin(x * %d.0) * %d.0;\n", i + 1, i % 3);
+    }
+    res.code += FormatVE(
+            "\treturn y;\n"
+            "}\n"
+            "void vertex() {\n"
+            "\tworld_pos = (WORLD_MATRIX * vec4(VERTEX, 1.0)).xyz;\n"
+            "\tVERTEX += NORMAL * wave(TIME + world_pos.x) * 0.01;\n"
+            "}\n"
+            "void fragment() {\n"
+            "\tvec4 c = texture(albedo_texture, UV) * albedo_%d;\n"
+            "\tALBEDO = c.rgb;\n"
+            "\tROUGHNESS = roughness;\n"
+            "\tfor (int i = 0; i < 3; i++) {\n"
+            "\t\tEMISSION += vec3(wave(float(i) + UV.x)) * 0.1;\n"
+            "\t}\n"
+            "\tif (c.a < 0.5) {\n"
+            "\t\tALPHA = c.a;\n"
+            "\t}\n"
+            "}\n",
+            p_index);
+    return res;
+}
+
+struct Output {
+    HashMap<StringName, ShaderLanguage::ShaderNode::Uniform> uniforms;
+    ShaderCompilerGLES3::IdentifierActions actions;
+    ShaderCompilerGLES3::GeneratedCode gen_code;
+    Error err = ERR_UNAVAILABLE;
+
+    Output() {
+        actions.uniforms = &uniforms;
+    }
+};
+
+bool same_code(const ShaderCompilerGLES3::GeneratedCode &a, const ShaderCompilerGLES3::GeneratedCode &b) {
+
+    return a.vertex == b.vertex && a.vertex_global == b.vertex_global && a.fragment == b.fragment &&
+           a.fragment_global == b.fragment_global && a.light == b.light && a.uniforms == b.uniforms &&
+           a.defines == b.defines && a.texture_uniforms == b.texture_uniforms && a.uniform_offsets == b.uniform_offsets;
+}
+
+void report(const char *p_what, uint64_t p_usec) {
+    OS::get_singleton()->print(FormatVE("\t%-30s %9.2f ms (%.1f us per shader)\n", p_what, p_usec / 1000.0, double(p_usec) / SHADER_COUNT));
+}
+
+} // namespace
+
+MainLoop *test() {
+
+    ShaderTypes *types = ShaderTypes::get_singleton();
+
+    Vector<Source> corpus;
+    for (int i = 0; i < SHADER_COUNT; i++) {
+        corpus.push_back(make_shader(i));
+    }
+
+    OS::get_singleton()->print(FormatVE("%d shaders:\n", SHADER_COUNT));
+
+    bool ok = true;
+
+    // parse only, the same parser for every shader reuses its node arena
+    ShaderLanguage parser;
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    for (const Source &source : corpus) {
+        ok = parser.compile(source.code, types->get_functions(source.mode), types->get_modes(source.mode), types->get_types()) == OK && ok;
+    }
+    report("parse", OS::get_singleton()->get_ticks_usec() - start);
+
+    ShaderCompilerGLES3 compiler;
+
+    Vector<Output> serial;
+    serial.resize(corpus.size());
+    start = OS::get_singleton()->get_ticks_usec();
+    for (size_t i = 0; i < corpus.size(); i++) {
+        Output &out = serial[i];
+        out.err = compiler.compile(corpus[i].mode, corpus[i].code, &out.actions, corpus[i].path, out.gen_code);
+    }
+    report("compile one by one", OS::get_singleton()->get_ticks_usec() - start);
+
+    Vector<Output> batched;
+    batched.resize(corpus.size());
+    Vector<ShaderCompilerGLES3::BatchItem> batch;
+    for (size_t i = 0; i < corpus.size(); i++) {
+        Output &out = batched[i];
+        batch.push_back({ corpus[i].mode, &corpus[i].code, &out.actions, &corpus[i].path, &out.gen_code, OK });
+    }
+    start = OS::get_singleton()->get_ticks_usec();
+    compiler.compile_batch(batch);
+    report("compile_batch", OS::get_singleton()->get_ticks_usec() - start);
+
+    for (size_t i = 0; i < corpus.size(); i++) {
+        if (serial[i].err != OK || batch[i].err != OK || !same_code(serial[i].gen_code, batched[i].gen_code) ||
+                serial[i].uniforms.size() != batched[i].uniforms.size()) {
+            OS::get_singleton()->print(FormatVE("\t%s differs\n", corpus[i].path.c_str()));
+            ok = false;
+        }
+    }
+
+    OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+    return nullptr;
+}
+
+} // namespace TestShaderCompile
@@ -177,7 +177,7 @@ static String dump_node_code(SL::Node *p_node, int p_level) {
 
             //variables
             code += _mktab(p_level - 1) + "{\n";
-            for (eastl::pair<const StringName,SL::BlockNode::Variable> &E : bnode->variables) {
+            for (const eastl::pair<StringName,SL::BlockNode::Variable> &E : bnode->variables) {
 
                 code += _mktab(p_level) + _prestr(E.second.precision) + String(_typestr(E.second.type)) + " " + E.first.asCString() + ";\n";
             }
@@ -0,0 +1,193 @@
+/*************************************************************************/
+/*  test_skeleton.cpp                                                    */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_skeleton.h"
+
+#include "core/callable_method_pointer.h"
+#include "core/math/math_funcs.h"
+#include "core/os/os.h"
+#include "core/string_formatter.h"
+#include "scene/3d/skeleton_3d.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+#include "scene/resources/skin.h"
+
+namespace TestSkeleton {
+
+// Cost of updating many animated skeletons one notification at a time versus one batched flush, and whether both give
+// the same poses.
+
+class TestMainLoop : public SceneTree {
+
+    Vector<Skeleton *> skeletons;
+    Vector<Ref<SkinReference>> skins;
+    Skeleton *chained = nullptr;
+    bool ok = true;
+
+    // Connected to skeleton_updated of the first skeleton, poses one further down the same batch.
+    void pose_chained() {
+
+        chained->set_bone_pose(0, Transform(Basis(Vector3(0, 0, 1), 0.5f), Vector3()));
+    }
+
+    Vector<Transform> global_poses() {
+
+        Vector<Transform> poses;
+        for (Skeleton *skeleton : skeletons) {
+            for (int j = 0; j < skeleton->get_bone_count(); j++) {
+                poses.push_back(skeleton->get_bone_global_pose(j));
+            }
+        }
+        return poses;
+    }
+
+    void build(int p_skeletons, int p_bones) {
+
+        for (int i = 0; i < p_skeletons; i++) {
+            Skeleton *skeleton = memnew(Skeleton);
+            get_root()->add_child(skeleton);
+
+            Ref<Skin> skin(make_ref_counted<Skin>());
+            for (int j = 0; j < p_bones; j++) {
+                skeleton->add_bone(FormatVE("bone_%d", j));
+                // A few branching chains, parents always come first.
+                skeleton->set_bone_parent(j, j < 4 ? -1 : j - 4 + (j % 3 == 0 ? 1 : 0));
+                skeleton->set_bone_rest(j, Transform(Basis(Vector3(0, 1, 0), 0.01f * j), Vector3(0, 0.1f, 0)));
+                skin->add_bind(j, Transform(Basis(), Vector3(0, -0.1f * j, 0)));
+            }
+            skins.push_back(skeleton->register_skin(skin));
+            skeletons.push_back(skeleton);
+        }
+    }
+
+    void clear() {
+
+        skins.clear();
+        for (Skeleton *skeleton : skeletons) {
+            get_root()->remove_child(skeleton);
+            memdelete(skeleton);
+        }
+        skeletons.clear();
+    }
+
+    // What an animation player does every frame.
+    void animate(int p_frame) {
+
+        for (size_t i = 0; i < skeletons.size(); i++) {
+            Skeleton *skeleton = skeletons[i];
+            for (int j = 0; j < skeleton->get_bone_count(); j++) {
+                const float angle = Math::sin(0.1f * (p_frame + i + j));
+                skeleton->set_bone_pose(j, Transform(Basis(Vector3(1, 0, 0), angle), Vector3()));
+            }
+        }
+    }
+
+    // Walks the parents by hand rather than trusting the process order.
+    bool verify() {
+
+        for (Skeleton *skeleton : skeletons) {
+            Vector<Transform> expected;
+            for (int j = 0; j < skeleton->get_bone_count(); j++) {
+                const Transform local = skeleton->get_bone_rest(j) * skeleton->get_bone_pose(j);
+                const int parent = skeleton->get_bone_parent(j);
+                expected.push_back(parent >= 0 ? expected[parent] * local : local);
+                const Transform global = skeleton->get_bone_global_pose(j);
+                if (!global.is_equal_approx(expected[j])) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    void run(int p_skeletons, int p_bones, int p_frames) {
+
+        build(p_skeletons, p_bones);
+
+        uint64_t start = OS::get_singleton()->get_ticks_usec();
+        for (int f = 0; f < p_frames; f++) {
+            animate(f);
+            for (Skeleton *skeleton : skeletons) {
+                skeleton->notification(Skeleton::NOTIFICATION_UPDATE_SKELETON);
+            }
+        }
+        const uint64_t single = OS::get_singleton()->get_ticks_usec() - start;
+        const Vector<Transform> single_poses = global_poses();
+
+        start = OS::get_singleton()->get_ticks_usec();
+        for (int f = 0; f < p_frames; f++) {
+            animate(f);
+            Skeleton::flush_pose_updates();
+        }
+        const uint64_t batched = OS::get_singleton()->get_ticks_usec() - start;
+
+        ok = ok && global_poses() == single_poses && verify();
+
+        // A pose change made while the batch is being applied must survive it.
+        if (skeletons.size() > 1) {
+            animate(p_frames);
+            chained = skeletons.back();
+            Callable listener = callable_mp(this, &TestMainLoop::pose_chained);
+            skeletons.front()->connect("skeleton_updated", listener);
+            Skeleton::flush_pose_updates();
+            skeletons.front()->disconnect("skeleton_updated", listener);
+            // The chained skeleton was queued again, its pose must not have been reported as up to date.
+            Skeleton::flush_pose_updates();
+            ok = ok && verify();
+        }
+        OS::get_singleton()->print(FormatVE("\t%4d skeletons x %3d bones: %9.2f ms one by one, %9.2f ms batched\n",
+                p_skeletons, p_bones, single / 1000.0, batched / 1000.0));
+
+        clear();
+    }
+
+public:
+    void init() override {
+
+        SceneTree::init();
+
+        for (int bones : { 32, 128 }) {
+            for (int count : { 1, 16, 128, 512 }) {
+                run(count, bones, 20);
+            }
+        }
+
+        OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+
+        quit();
+    }
+};
+
+MainLoop *test() {
+
+    return memnew(TestMainLoop);
+}
+
+} // namespace TestSkeleton
@@ -0,0 +1,173 @@
+/*************************************************************************/
+/*  test_string_name.cpp                                                 */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_string_name.h"
+
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/safe_refcount.h"
+#include "core/string_formatter.h"
+#include "core/string_name.h"
+#include "core/vector.h"
+
+namespace TestStringName {
+
+enum {
+    NAME_POOL_SIZE = 20000,
+    ROUNDS = 25,
+};
+
+struct InternWork {
+    const Vector<String> *pool;
+    int thread_index;
+    SafeNumeric<uint32_t> *mismatches;
+};
+
+static void intern_thread(void *p_ud) {
+
+    InternWork &work = *(InternWork *)p_ud;
+    const Vector<String> &pool = *work.pool;
+
+    for (int round = 0; round < ROUNDS; round++) {
+        // Keep every third name alive until the end of the round, so that the table sees a mix of hits, first
+        // insertions and last-reference releases.
+        Vector<StringName> kept;
+        kept.reserve(pool.size() / 3 + 1);
+        for (size_t i = 0; i < pool.size(); i++) {
+            const String &src = pool[(i * 7 + work.thread_index * 131 + round) % pool.size()];
+            StringName a(src);
+            StringName b(src);
+            if (a != b || src != a.asCString() || StringName::search(src.c_str()) != a) {
+                work.mismatches->increment();
+            }
+            if (i % 3 == 0) {
+                kept.emplace_back(eastl::move(a));
+            }
+        }
+    }
+}
+
+static uint64_t run_interning(int p_threads, const Vector<String> &p_pool, uint32_t &r_mismatches) {
+
+    SafeNumeric<uint32_t> mismatches;
+    Vector<InternWork> work;
+    work.resize(p_threads);
+    Vector<Thread> threads;
+    threads.resize(p_threads);
+
+    const uint64_t start = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < p_threads; i++) {
+        work[i] = { &p_pool, i, &mismatches };
+        threads[i].start(intern_thread, &work[i]);
+    }
+    for (int i = 0; i < p_threads; i++) {
+        threads[i].wait_to_finish();
+    }
+    r_mismatches = mismatches.get();
+    return OS::get_singleton()->get_ticks_usec() - start;
+}
+
+bool test_identity() {
+
+    String dynamic("test_string_name_identity");
+    StringName from_static("test_string_name_identity");
+    StringName from_dynamic(dynamic);
+    StringName found = StringName::search("test_string_name_identity");
+    bool ok = from_static == from_dynamic && found == from_static;
+    ok = ok && StringName::search("test_string_name_never_interned").empty();
+    return ok;
+}
+
+bool test_growth() {
+
+    // Far more names than the initial bucket count, the table has to grow while they are alive.
+    Vector<StringName> names;
+    for (int i = 0; i < 100000; i++) {
+        names.emplace_back(StringName(FormatVE("test_string_name_growth_%d", i)));
+    }
+    for (int i = 0; i < 100000; i += 97) {
+        if (StringName::search(FormatVE("test_string_name_growth_%d", i).c_str()) != names[i]) {
+            return false;
+        }
+    }
+    names.clear();
+    return StringName::search("test_string_name_growth_0").empty();
+}
+
+bool test_contention() {
+
+    Vector<String> pool;
+    pool.reserve(NAME_POOL_SIZE);
+    for (int i = 0; i < NAME_POOL_SIZE; i++) {
+        pool.emplace_back(FormatVE("test_string_name_contention_%d", i));
+    }
+
+    const int max_threads = OS::get_singleton()->get_processor_count();
+    const uint64_t interned = uint64_t(NAME_POOL_SIZE) * ROUNDS;
+    bool ok = true;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        uint32_t mismatches = 0;
+        const uint64_t usec = run_interning(threads, pool, mismatches);
+        OS::get_singleton()->print(FormatVE("\t%2d threads: %8.2f ms, %8.2f M interns/s, %u mismatches\n", threads,
+                usec / 1000.0, double(interned * threads) / (usec ? usec : 1), mismatches));
+        ok = ok && mismatches == 0;
+    }
+    return ok;
+}
+
+using TestFunc = bool (*)();
+
+TestFunc test_funcs[] = {
+    test_identity,
+    test_growth,
+    test_contention,
+    nullptr
+};
+
+MainLoop *test() {
+    int count = 0;
+    int passed = 0;
+
+    while (true) {
+        if (!test_funcs[count])
+            break;
+        bool pass = test_funcs[count]();
+        if (pass)
+            passed++;
+        OS::get_singleton()->print(FormatVE("\t%s\n", pass ? "PASS" : "FAILED"));
+
+        count++;
+    }
+    OS::get_singleton()->print("\n");
+    OS::get_singleton()->print(FormatVE("Passed %i of %i tests\n", passed, count));
+    return nullptr;
+}
+
+} // namespace TestStringName
@@ -0,0 +1,177 @@
+/*************************************************************************/
+/*  test_text_edit.cpp                                                   */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_text_edit.h"
+
+#include "core/os/os.h"
+#include "core/string_formatter.h"
+#include "scene/gui/text_edit.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+
+namespace TestTextEdit {
+
+// Highlighting cost of redrawing and scrolling a large script, and of the invalidation done by typical edits.
+
+static String make_script(int p_lines) {
+
+    String res;
+    for (int i = 0; i < p_lines; i++) {
+        switch (i % 8) {
+            case 0: res += FormatVE("func method_%d(arg, other = 0.5):\n", i); break;
+            case 1: res += "\t# Line comment with \"quotes\" inside.\n"; break;
+            case 2: res += FormatVE("\tvar value = self.member_%d + arg * 0x%x\n", i, i); break;
+            case 3: res += "\tif value > 10 and not other:\n"; break;
+            case 4: res += "\t\treturn \"some string with a # in it\"\n"; break;
+            case 5: res += "\t/* block comment */ value += 1\n"; break;
+            case 6: res += FormatVE("\tprint(\"line %d\", value)\n", i); break;
+            default: res += "\n"; break;
+        }
+    }
+    return res;
+}
+
+class TestMainLoop : public SceneTree {
+
+    TextEdit *text_edit = nullptr;
+    int rehighlighted = 0;
+
+    // What a redraw asks for: the highlight of every line in the visible page.
+    void draw_page(int p_first, int p_rows) {
+        const int last = MIN(p_first + p_rows, text_edit->get_line_count());
+        for (int i = p_first; i < last; i++) {
+            rehighlighted += text_edit->_get_line_syntax_highlighting(i).size();
+        }
+    }
+
+    void report(const char *p_what, uint64_t p_usec) {
+        OS::get_singleton()->print(FormatVE("\t%-36s %9.2f ms\n", p_what, p_usec / 1000.0));
+    }
+
+    // Compares cached spans against a full rehighlight.
+    bool verify() {
+        Vector<Vector<TextEdit::HighlightSpan>> cached;
+        for (int i = 0; i < text_edit->get_line_count(); i++) {
+            cached.push_back(text_edit->_get_line_syntax_highlighting(i));
+        }
+        text_edit->_clear_syntax_highlighting_cache();
+        for (int i = 0; i < text_edit->get_line_count(); i++) {
+            const Vector<TextEdit::HighlightSpan> &fresh = text_edit->_get_line_syntax_highlighting(i);
+            if (fresh.size() != cached[i].size()) {
+                return false;
+            }
+            for (size_t j = 0; j < fresh.size(); j++) {
+                if (fresh[j].column != cached[i][j].column || fresh[j].color != cached[i][j].color) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+public:
+    void init() override {
+
+        SceneTree::init();
+
+        const int lines = 20000;
+        const int rows = 60;
+
+        text_edit = memnew(TextEdit);
+        get_root()->add_child(text_edit);
+        text_edit->set_syntax_coloring(true);
+        for (const char *keyword : { "func", "var", "if", "and", "not", "return", "self" }) {
+            text_edit->add_keyword_color(keyword, Color(1, 0.5, 0.5));
+        }
+        text_edit->add_member_keyword("print", Color(0.5, 1, 0.5));
+        text_edit->add_color_region("#", "", Color(0.5, 0.5, 0.5), true);
+        text_edit->add_color_region("\"", "\"", Color(1, 1, 0.5));
+        text_edit->add_color_region("/*", "*/", Color(0.5, 0.5, 1));
+        text_edit->set_text(make_script(lines));
+
+        OS::get_singleton()->print(FormatVE("%d lines:\n", text_edit->get_line_count()));
+
+        uint64_t start = OS::get_singleton()->get_ticks_usec();
+        draw_page(0, rows);
+        report("first page", OS::get_singleton()->get_ticks_usec() - start);
+
+        start = OS::get_singleton()->get_ticks_usec();
+        for (int first = 0; first < lines; first += rows) {
+            draw_page(first, rows);
+        }
+        report("scroll through file, cold", OS::get_singleton()->get_ticks_usec() - start);
+
+        start = OS::get_singleton()->get_ticks_usec();
+        for (int pass = 0; pass < 10; pass++) {
+            for (int first = 0; first < lines; first += rows) {
+                draw_page(first, rows);
+            }
+        }
+        report("scroll through file x10, cached", OS::get_singleton()->get_ticks_usec() - start);
+
+        start = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < 1000; i++) {
+            draw_page(lines / 2, rows);
+        }
+        report("redraw page x1000", OS::get_singleton()->get_ticks_usec() - start);
+
+        // Typing in the middle of the file only touches the edited line.
+        const int edited = lines / 2 + 2;
+        start = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < 1000; i++) {
+            text_edit->set_line(edited, text_edit->get_line(edited) + "x");
+            draw_page(lines / 2, rows);
+        }
+        report("type in line + redraw x1000", OS::get_singleton()->get_ticks_usec() - start);
+
+        // Opening a block comment changes the region of every following line, closing it restores them.
+        start = OS::get_singleton()->get_ticks_usec();
+        text_edit->set_line(0, "/* " + text_edit->get_line(0));
+        draw_page(lines - rows, rows);
+        report("open block comment, redraw end", OS::get_singleton()->get_ticks_usec() - start);
+
+        start = OS::get_singleton()->get_ticks_usec();
+        text_edit->set_line(0, text_edit->get_line(0).substr(3));
+        draw_page(lines - rows, rows);
+        report("close block comment, redraw end", OS::get_singleton()->get_ticks_usec() - start);
+
+        const bool ok = verify();
+        OS::get_singleton()->print(FormatVE("\t%d spans fetched\n\t%s\n", rehighlighted, ok ? "PASS" : "FAILED"));
+
+        quit();
+    }
+};
+
+MainLoop *test() {
+
+    return memnew(TestMainLoop);
+}
+
+} // namespace TestTextEdit
@@ -0,0 +1,305 @@
+/*************************************************************************/
+/*  test_text_parsers.cpp                                                */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_text_parsers.h"
+
+#include "core/array.h"
+#include "core/dictionary.h"
+#include "core/io/json.h"
+#include "core/io/json_reader.h"
+#include "core/math/transform.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/pool_vector.h"
+#include "core/string_formatter.h"
+#include "core/string_utils.h"
+#include "core/variant_parser.h"
+#include "core/vector.h"
+
+namespace TestTextParsers {
+
+// Synthetic inputs are used unless files are passed on the command line, .json files go through the JSON readers,
+// everything else is parsed as text resource/scene tags.
+
+static String make_json(int p_records) {
+
+    String res("{\"records\": [\n");
+    for (int i = 0; i < p_records; i++) {
+        res += FormatVE("  {\"id\": %d, \"name\": \"record_%d\", \"path\": \"res://some/long/path/\\u00e9_%d.tres\", "
+                        "\"enabled\": %s, \"weight\": %f, \"tags\": [\"a\", \"b\", \"c\"], \"parent\": null}%s\n",
+                i, i, i, i % 2 ? "true" : "false", i * 0.25, i + 1 < p_records ? "," : "");
+    }
+    res += "]}\n";
+    return res;
+}
+
+static String make_scene(int p_nodes) {
+
+    String res("[gd_scene format=2]\n\n");
+    for (int i = 0; i < p_nodes; i++) {
+        res += FormatVE("[node name=\"Node%d\" type=\"Spatial\" parent=\".\"]\n"
+                        "; a comment line\n"
+                        "transform = Transform( 1, 0, 0, 0, 1, 0, 0, 0, 1, %d.5, 0, -%d )\n"
+                        "visible = %s\n"
+                        "editor_description = \"Node number %d with an \\\"escaped\\\" quote\"\n"
+                        "points = PoolVector3Array( 0, 1, 2, 3, 4, 5, 6, 7, 8 )\n"
+                        "meta = { \"key\": \"value\", \"count\": %d }\n\n",
+                i, i, i, i % 2 ? "true" : "false", i, i);
+    }
+    return res;
+}
+
+static void report(const char *p_what, size_t p_bytes, uint64_t p_usec, bool p_ok) {
+
+    const double mb = p_bytes / (1024.0 * 1024.0);
+    OS::get_singleton()->print(FormatVE("\t%-28s %8.2f MB in %8.2f ms: %8.2f MB/s%s\n", p_what, mb, p_usec / 1000.0,
+            p_usec ? mb / (p_usec / 1000000.0) : 0.0, p_ok ? "" : " (FAILED)"));
+}
+
+static String record_path(int p_index) {
+
+    return FormatVE("res://some/long/path/\xc3\xa9_%d.tres", p_index); // é decoded to UTF-8
+}
+
+// Values the records of make_json() must decode to, checked on a few of them.
+static bool check_json_tree(const Variant &p_tree, int p_records) {
+
+    if (p_tree.get_type() != VariantType::DICTIONARY) {
+        return false;
+    }
+    const Dictionary root = p_tree.as<Dictionary>();
+    if (!root.has("records")) {
+        return false;
+    }
+    const Array records = root["records"].as<Array>();
+    if (records.size() != p_records) {
+        return false;
+    }
+    for (int i : { 0, 1, p_records / 2, p_records - 1 }) {
+        const Dictionary r = records[i].as<Dictionary>();
+        const Array tags = r["tags"].as<Array>();
+        const bool ok = r["id"].as<int>() == i && r["name"].as<String>() == FormatVE("record_%d", i) &&
+                        r["path"].as<String>() == record_path(i) && r["enabled"].as<bool>() == (i % 2 == 1) &&
+                        Math::abs(r["weight"].as<double>() - i * 0.25) < 1e-6 && tags.size() == 3 && tags[0].as<String>() == "a" &&
+                        tags[2].as<String>() == "c" && r["parent"].get_type() == VariantType::NIL;
+        if (!ok) {
+            OS::get_singleton()->print(FormatVE("\trecord %d decoded to unexpected values\n", i));
+            return false;
+        }
+    }
+    return true;
+}
+
+// p_records is the number of make_json() records in p_source, or -1 when it comes from a file and can't be checked.
+static bool bench_json(StringView p_source, int p_records) {
+
+    bool ok = true;
+
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    Variant tree;
+    String err_str;
+    int err_line;
+    ok = ok && JSON::parse(p_source, tree, err_str, err_line) == OK;
+    report("JSON::parse (tree)", p_source.size(), OS::get_singleton()->get_ticks_usec() - start, ok);
+    if (p_records >= 0) {
+        ok = ok && check_json_tree(tree, p_records);
+    }
+
+    // Checks the values in the stream as they go by: each record's name, path and weight follow their key.
+    start = OS::get_singleton()->get_ticks_usec();
+    JSONReader reader(p_source);
+    JSONReader::Event event;
+    int events = 0;
+    int names = 0, paths = 0, weights = 0;
+    bool values_ok = true;
+    String key;
+    do {
+        ok = ok && reader.read(event) == OK;
+        events++;
+        if (p_records < 0 || !ok) {
+            continue;
+        }
+        if (event == JSONReader::EVENT_KEY) {
+            key = reader.get_string();
+            continue;
+        }
+        if (key == "name" && event == JSONReader::EVENT_STRING) {
+            values_ok = values_ok && reader.get_string() == StringView(FormatVE("record_%d", names++));
+        } else if (key == "path" && event == JSONReader::EVENT_STRING) {
+            values_ok = values_ok && reader.get_string() == StringView(record_path(paths++));
+        } else if (key == "weight" && event == JSONReader::EVENT_NUMBER) {
+            values_ok = values_ok && Math::abs(reader.get_number() - weights++ * 0.25) < 1e-6;
+        }
+        key.clear();
+    } while (ok && event != JSONReader::EVENT_EOF);
+    report("JSONReader (events only)", p_source.size(), OS::get_singleton()->get_ticks_usec() - start, ok);
+    OS::get_singleton()->print(FormatVE("\t%d events\n", events));
+
+    if (p_records >= 0) {
+        // Per record: its object, 7 keys, 6 scalar values and a 3 string array. Then the root object, its key,
+        // the records array and EOF.
+        values_ok = values_ok && events == p_records * 20 + 6 && names == p_records && paths == p_records && weights == p_records;
+        if (!values_ok) {
+            OS::get_singleton()->print("\tJSONReader events don't match the document\n");
+        }
+        ok = ok && values_ok;
+    }
+    return ok;
+}
+
+// Values make_scene() gives the properties of node p_node.
+static bool check_scene_value(int p_node, const String &p_assign, const Variant &p_value) {
+
+    if (p_assign == "transform") {
+        const Transform t = p_value.as<Transform>();
+        return t.origin.is_equal_approx(Vector3(p_node + 0.5f, 0, -p_node)) && t.basis == Basis();
+    }
+    if (p_assign == "visible") {
+        return p_value.get_type() == VariantType::BOOL && p_value.as<bool>() == (p_node % 2 == 1);
+    }
+    if (p_assign == "editor_description") {
+        return p_value.as<String>() == FormatVE("Node number %d with an \"escaped\" quote", p_node);
+    }
+    if (p_assign == "points") {
+        const PoolVector3Array points = p_value.as<PoolVector3Array>();
+        return points.size() == 3 && points[0] == Vector3(0, 1, 2) && points[2] == Vector3(6, 7, 8);
+    }
+    if (p_assign == "meta") {
+        const Dictionary meta = p_value.as<Dictionary>();
+        return meta.size() == 2 && meta["key"].as<String>() == "value" && meta["count"].as<int>() == p_node;
+    }
+    return false;
+}
+
+// With p_check, the stream must hold make_scene() output and every value is checked against it.
+static bool parse_tags(VariantParserStream *p_stream, int &r_tags, bool p_check) {
+
+    VariantParser::Tag tag;
+    String assign;
+    Variant value;
+    String error_text;
+    int lines = 0;
+    int assigns = 0;
+    while (true) {
+        Error err = VariantParser::parse_tag_assign_eof(p_stream, lines, error_text, tag, assign, value, nullptr, true);
+        if (err == ERR_FILE_EOF) {
+            // 5 properties per node
+            return !p_check || assigns == (r_tags - 1) * 5;
+        }
+        if (err != OK) {
+            OS::get_singleton()->print(FormatVE("\tparse error at line %d: %s\n", lines, error_text.c_str()));
+            return false;
+        }
+        if (assign.empty()) {
+            r_tags++;
+            if (p_check && r_tags > 1) {
+                const int node = r_tags - 2; // after the gd_scene header
+                auto name = tag.fields.find("name");
+                if (tag.name != "node" || name == tag.fields.end() || name->second.as<String>() != FormatVE("Node%d", node)) {
+                    OS::get_singleton()->print(FormatVE("\tunexpected tag at line %d\n", lines));
+                    return false;
+                }
+            }
+        } else if (p_check) {
+            assigns++;
+            if (r_tags < 2 || !check_scene_value(r_tags - 2, assign, value)) {
+                OS::get_singleton()->print(FormatVE("\tunexpected value for '%s' at line %d\n", assign.c_str(), lines));
+                return false;
+            }
+        }
+    }
+}
+
+// p_nodes is the number of make_scene() nodes in p_source, or -1 when it comes from a file and can't be checked.
+static bool bench_variant_parser(const String &p_source, StringView p_path, int p_nodes) {
+
+    int tags = 0;
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    VariantParserStream *stream = VariantParser::get_string_stream(p_source);
+    bool ok = parse_tags(stream, tags, p_nodes >= 0);
+    VariantParser::release_stream(stream);
+    report("VariantParser (string)", p_source.size(), OS::get_singleton()->get_ticks_usec() - start, ok);
+
+    if (p_path.empty()) {
+        OS::get_singleton()->print(FormatVE("\t%d tags\n", tags));
+        return ok && (p_nodes < 0 || tags == p_nodes + 1);
+    }
+
+    FileAccess *f = FileAccess::open(p_path, FileAccess::READ);
+    if (!f) {
+        return false;
+    }
+    for (bool readahead : { true, false }) {
+        f->seek(0);
+        tags = 0;
+        start = OS::get_singleton()->get_ticks_usec();
+        stream = VariantParser::get_file_stream(f, readahead);
+        const bool file_ok = parse_tags(stream, tags, false);
+        VariantParser::release_stream(stream);
+        report(readahead ? "VariantParser (file)" : "VariantParser (file, unbuffered)", p_source.size(),
+                OS::get_singleton()->get_ticks_usec() - start, file_ok);
+        ok = ok && file_ok;
+    }
+    memdelete(f);
+    OS::get_singleton()->print(FormatVE("\t%d tags\n", tags));
+    return ok;
+}
+
+MainLoop *test(const Vector<String> &p_args) {
+
+    bool ok = true;
+    if (p_args.empty()) {
+        OS::get_singleton()->print("Synthetic JSON document:\n");
+        ok = bench_json(make_json(200000), 200000) && ok;
+        OS::get_singleton()->print("Synthetic text scene:\n");
+        ok = bench_variant_parser(make_scene(50000), StringView(), 50000) && ok;
+    }
+
+    for (const String &path : p_args) {
+        Error err;
+        String source = FileAccess::get_file_as_string(path, &err);
+        if (err != OK) {
+            OS::get_singleton()->print(FormatVE("Can't open %s\n", path.c_str()));
+            ok = false;
+            continue;
+        }
+        OS::get_singleton()->print(FormatVE("%s:\n", path.c_str()));
+        if (StringUtils::ends_with(path, ".json")) {
+            ok = bench_json(source, -1) && ok;
+        } else {
+            ok = bench_variant_parser(source, path, -1) && ok;
+        }
+    }
+
+    OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+    return nullptr;
+}
+
+} // namespace TestTextParsers
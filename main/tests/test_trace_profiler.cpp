@@ -0,0 +1,199 @@
+/*************************************************************************/
+/*  test_trace_profiler.cpp                                              */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_trace_profiler.h"
+
+#include "core/array.h"
+#include "core/dictionary.h"
+#include "core/io/json.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
+#include "core/os/os.h"
+#include "core/os/thread.h"
+#include "core/string_formatter.h"
+#include "core/trace_profiler.h"
+#include "core/variant.h"
+
+namespace TestTraceProfiler {
+
+// Scopes, counters and frame marks recorded from several threads and exported as Chrome trace JSON, the per-thread
+// ring buffers wrapping around, and frame-limited captures writing their trace.
+
+namespace {
+
+const int THREAD_COUNT = 3;
+const int SCOPES_PER_THREAD = 1000;
+const int OVERHEAD_SCOPES = 1000000;
+
+void record_scopes(void *) {
+
+    for (int i = 0; i < SCOPES_PER_THREAD; i++) {
+        TraceProfilerScope scope("worker");
+        TraceProfiler::record_value("worker_value", i);
+    }
+}
+
+bool parse_events(Array &r_events) {
+
+    Variant parsed;
+    String err_str;
+    int err_line;
+    if (JSON::parse(TraceProfiler::export_json(), parsed, err_str, err_line) != OK) {
+        OS::get_singleton()->print(FormatVE("\tExported trace is not valid JSON, line %d: %s\n", err_line, err_str.c_str()));
+        return false;
+    }
+    r_events = parsed.as<Dictionary>()["traceEvents"].as<Array>();
+    return true;
+}
+
+int count_events(const Array &p_events, StringView p_name, StringView p_phase) {
+
+    int count = 0;
+    for (int i = 0; i < p_events.size(); i++) {
+        Dictionary event = p_events[i].as<Dictionary>();
+        if (event["name"].as<String>() == p_name && event["ph"].as<String>() == p_phase) {
+            count++;
+        }
+    }
+    return count;
+}
+
+bool test_threads() {
+
+    TraceProfiler::clear();
+    TraceProfiler::start();
+
+    Thread threads[THREAD_COUNT];
+    for (Thread &thread : threads) {
+        thread.start(record_scopes, nullptr);
+    }
+    TraceProfiler::frame_start("test_frame");
+    {
+        // Names coming from SCOPE_PROFILE("...") are stringized with their quotes.
+        TraceProfilerScope scope("\"main scope\"");
+    }
+    TraceProfiler::frame_end("test_frame");
+    for (Thread &thread : threads) {
+        thread.wait_to_finish();
+    }
+    TraceProfiler::stop();
+
+    Array events;
+    if (!parse_events(events)) {
+        return false;
+    }
+    bool ok = count_events(events, "worker", "X") == THREAD_COUNT * SCOPES_PER_THREAD;
+    ok = ok && count_events(events, "worker_value", "C") == THREAD_COUNT * SCOPES_PER_THREAD;
+    ok = ok && count_events(events, "main scope", "X") == 1;
+    ok = ok && count_events(events, "test_frame", "X") == 1;
+    ok = ok && count_events(events, "thread_name", "M") >= THREAD_COUNT + 1;
+
+    OS::get_singleton()->print(FormatVE("\t%d events from %d threads: %s\n", events.size(), THREAD_COUNT + 1, ok ? "ok" : "wrong"));
+    return ok;
+}
+
+bool test_wrap() {
+
+    TraceProfiler::clear();
+    TraceProfiler::start();
+    for (int i = 0; i < TraceProfiler::EVENTS_PER_THREAD + 100; i++) {
+        TraceProfilerScope scope("wrap");
+    }
+    TraceProfiler::stop();
+
+    Array events;
+    if (!parse_events(events)) {
+        return false;
+    }
+    bool ok = count_events(events, "wrap", "X") == TraceProfiler::EVENTS_PER_THREAD;
+    OS::get_singleton()->print(FormatVE("\tring buffer keeps the last %d events: %s\n", TraceProfiler::EVENTS_PER_THREAD, ok ? "ok" : "wrong"));
+    return ok;
+}
+
+void test_overhead() {
+
+    TraceProfiler::clear();
+    uint64_t start = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < OVERHEAD_SCOPES; i++) {
+        TraceProfilerScope scope("idle");
+    }
+    const double idle = OS::get_singleton()->get_ticks_usec() - start;
+
+    TraceProfiler::start();
+    start = OS::get_singleton()->get_ticks_usec();
+    for (int i = 0; i < OVERHEAD_SCOPES; i++) {
+        TraceProfilerScope scope("recording");
+    }
+    const double recording = OS::get_singleton()->get_ticks_usec() - start;
+    TraceProfiler::stop();
+    TraceProfiler::clear();
+
+    OS::get_singleton()->print(FormatVE("\tscope cost: %.1f ns idle, %.1f ns recording\n",
+            idle * 1000.0 / OVERHEAD_SCOPES, recording * 1000.0 / OVERHEAD_SCOPES));
+}
+
+bool test_frame_capture() {
+
+    const String path = OS::get_singleton()->get_cache_path() + "/test_trace_profiler.json";
+    const String old_path = TraceProfiler::get_output_path();
+    TraceProfiler::set_output_path(path);
+
+    TraceProfiler::clear();
+    TraceProfiler::start(3);
+    bool ok = true;
+    for (int i = 0; i < 3; i++) {
+        ok = ok && TraceProfiler::is_recording();
+        TraceProfilerScope scope("frame work");
+        TraceProfiler::end_frame(1000);
+    }
+    ok = ok && !TraceProfiler::is_recording() && FileAccess::exists(path);
+    if (FileAccess::exists(path)) {
+        DirAccess::remove_file_or_error(path);
+    }
+
+    TraceProfiler::set_output_path(old_path);
+    OS::get_singleton()->print(FormatVE("\tcapture stops and writes after 3 frames: %s\n", ok ? "ok" : "wrong"));
+    return ok;
+}
+
+} // namespace
+
+MainLoop *test() {
+
+    bool ok = test_threads();
+    ok = test_wrap() && ok;
+    ok = test_frame_capture() && ok;
+    test_overhead();
+
+    OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+    return nullptr;
+}
+
+} // namespace TestTraceProfiler
@@ -0,0 +1,242 @@
+/*************************************************************************/
+/*  test_tree.cpp                                                        */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+#include "test_tree.h"
+
+#include "core/callable_method_pointer.h"
+#include "core/math/random_number_generator.h"
+#include "core/os/os.h"
+#include "core/string_formatter.h"
+#include "scene/gui/tree.h"
+#include "scene/main/scene_tree.h"
+#include "scene/main/viewport.h"
+#include "scene/resources/style_box.h"
+#include "servers/rendering_server.h"
+
+namespace TestTree {
+
+// Scroll, redraw and hit testing cost on a tree of a million rows, and of the layout invalidation done by
+// collapsing and inserting. Offsets, hit tests and the rows a redraw draws are checked against a plain walk of the
+// visible rows after every change.
+
+static const int FANOUT = 100; // three levels below the hidden root, FANOUT^3 leaves
+
+class TestMainLoop : public SceneTree {
+
+    Tree *tree = nullptr;
+    Vector<TreeItem *> rows;
+    Vector<int> offsets;
+    Vector<TreeItem *> drawn; // rows the last redraw drew, in order
+
+    void report(const char *p_what, uint64_t p_usec) {
+        OS::get_singleton()->print(FormatVE("\t%-36s %9.2f ms\n", p_what, p_usec / 1000.0));
+    }
+
+    // Every row draws its first cell through here.
+    void row_drawn(Object *p_item, Rect2 p_rect) {
+        drawn.push_back(object_cast<TreeItem>(p_item));
+    }
+
+    TreeItem *add_row(TreeItem *p_parent, const String &p_text, int p_idx = -1) {
+        TreeItem *row = tree->create_item(p_parent, p_idx);
+        row->set_cell_mode(0, TreeItem::CELL_MODE_CUSTOM);
+        row->set_custom_draw(0, callable_mp(this, &TestMainLoop::row_drawn));
+        row->set_text(0, StringName(p_text));
+        return row;
+    }
+
+    void redraw() {
+        drawn.clear();
+        RenderingServer::get_singleton()->canvas_item_clear(tree->get_canvas_item());
+        tree->notification(CanvasItem::NOTIFICATION_DRAW);
+    }
+
+    // Offsets of all visible rows, the way the tree laid them out before it cached anything.
+    void walk_rows() {
+        rows.clear();
+        offsets.clear();
+        const int vsep = tree->get_theme_constant("vseparation");
+        int ofs = 0;
+        TreeItem *it = tree->get_root();
+        while (it) {
+            rows.push_back(it);
+            offsets.push_back(ofs);
+            if (it != tree->get_root() || !tree->is_root_hidden()) {
+                ofs += tree->get_item_rect(it).size.height + vsep;
+            }
+            if (it->get_children() && !it->is_collapsed()) {
+                it = it->get_children();
+            } else {
+                while (it && !it->get_next()) {
+                    it = it->get_parent();
+                }
+                if (it) {
+                    it = it->get_next();
+                }
+            }
+        }
+    }
+
+    bool verify() {
+        walk_rows();
+        const Point2 bg_ofs = tree->get_theme_stylebox("bg")->get_offset();
+        tree->get_vscroll_bar()->set_value(0);
+        for (size_t i = 1; i < rows.size(); i += 997) {
+            if (tree->get_item_offset(rows[i]) != offsets[i]) {
+                return false;
+            }
+            if (tree->get_item_at_position(bg_ofs + Point2(1, offsets[i] + 1)) != rows[i]) {
+                return false;
+            }
+        }
+        if (tree->get_item_offset(rows.back()) != offsets.back()) {
+            return false;
+        }
+
+        // A redraw has to draw exactly the rows reaching into the visible area, from the top of the tree to the end.
+        VScrollBar *scroll = tree->get_vscroll_bar();
+        const int draw_h = tree->get_size().height - tree->get_theme_stylebox("bg")->get_minimum_size().height;
+        for (int i = 0; i <= 8; i++) {
+            scroll->set_value(offsets.back() * i / 8);
+            redraw();
+            const int top = int(scroll->get_value());
+            // The hidden root has no row, the rows start at index 1.
+            const int first = M_MAX(1, int(eastl::upper_bound(offsets.begin(), offsets.end(), top) - offsets.begin()) - 1);
+            const int last = int(eastl::upper_bound(offsets.begin(), offsets.end(), top + draw_h) - offsets.begin()) - 1;
+            if (drawn.size() != size_t(last - first + 1)) {
+                return false;
+            }
+            for (size_t j = 0; j < drawn.size(); j++) {
+                if (drawn[j] != rows[first + j]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+public:
+    void init() override {
+
+        SceneTree::init();
+
+        tree = memnew(Tree);
+        get_root()->add_child(tree);
+        tree->set_size(Size2(400, 600));
+        tree->set_hide_root(true);
+
+        uint64_t start = OS::get_singleton()->get_ticks_usec();
+        TreeItem *root = tree->create_item();
+        for (int i = 0; i < FANOUT; i++) {
+            TreeItem *group = add_row(root, FormatVE("group %d", i));
+            for (int j = 0; j < FANOUT; j++) {
+                TreeItem *sub = add_row(group, FormatVE("sub %d", j));
+                for (int k = 0; k < FANOUT; k++) {
+                    add_row(sub, FormatVE("leaf %d", k));
+                }
+            }
+        }
+        report("build", OS::get_singleton()->get_ticks_usec() - start);
+
+        start = OS::get_singleton()->get_ticks_usec();
+        redraw();
+        report("first layout + redraw", OS::get_singleton()->get_ticks_usec() - start);
+
+        bool ok = verify();
+        OS::get_singleton()->print(FormatVE("%d visible rows:\n", int(rows.size()) - 1));
+
+        VScrollBar *scroll = tree->get_vscroll_bar();
+        const int total_h = offsets.back();
+        Ref<RandomNumberGenerator> rng(make_ref_counted<RandomNumberGenerator>());
+        rng->set_seed(42);
+
+        start = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < 1000; i++) {
+            scroll->set_value(rng->randi_range(0, total_h));
+            redraw();
+        }
+        report("scroll + redraw x1000", OS::get_singleton()->get_ticks_usec() - start);
+
+        start = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < 100000; i++) {
+            tree->get_item_offset(rows[rng->randi_range(1, rows.size() - 1)]);
+        }
+        report("item offset x100000", OS::get_singleton()->get_ticks_usec() - start);
+
+        start = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < 100000; i++) {
+            scroll->set_value(rng->randi_range(0, total_h));
+            tree->get_item_at_position(Point2(10, rng->randi_range(0, 600)));
+        }
+        report("item at position x100000", OS::get_singleton()->get_ticks_usec() - start);
+
+        TreeItem *group = root->get_children();
+        for (int i = 0; i < FANOUT / 2; i++) {
+            group = group->get_next();
+        }
+        scroll->set_value(total_h / 2);
+        start = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < 100; i++) {
+            group->set_collapsed(true);
+            redraw();
+            group->set_collapsed(false);
+            redraw();
+        }
+        report("collapse/expand + redraw x100", OS::get_singleton()->get_ticks_usec() - start);
+
+        group->get_children()->set_collapsed(true);
+        ok = verify() && ok;
+        group->get_children()->set_collapsed(false);
+
+        TreeItem *sub = group->get_children()->get_next();
+        start = OS::get_singleton()->get_ticks_usec();
+        for (int i = 0; i < 100; i++) {
+            TreeItem *added = add_row(sub, "added", FANOUT / 2);
+            redraw();
+            memdelete(added);
+            redraw();
+        }
+        report("insert/remove + redraw x100", OS::get_singleton()->get_ticks_usec() - start);
+
+        add_row(sub, "tall", 0)->set_custom_minimum_height(64);
+        ok = verify() && ok;
+
+        OS::get_singleton()->print(FormatVE("\t%s\n", ok ? "PASS" : "FAILED"));
+
+        quit();
+    }
+};
+
+MainLoop *test() {
+
+    return memnew(TestMainLoop);
+}
+
+} // namespace TestTree
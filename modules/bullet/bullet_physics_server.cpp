@@ -33,6 +33,7 @@
 #include "bullet_utilities.h"
 #include "cone_twist_joint_bullet.h"
 #include "generic_6dof_joint_bullet.h"
+#include "godot_task_scheduler.h"
 #include "hinge_joint_bullet.h"
 #include "pin_joint_bullet.h"
 #include "shape_bullet.h"
@@ -47,6 +48,9 @@
 #include "core/external_profiler.h"
 #include "core/class_db.h"
 #include "core/error_macros.h"
+#include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
+#include "core/project_settings.h"
 #include "core/property_info.h"
 #include "core/ustring.h"
 
@@ -93,7 +97,11 @@ void BulletPhysicsServer::_bind_methods() {
 
 BulletPhysicsServer::BulletPhysicsServer() :
         active(true),
-        active_spaces_count(0) {}
+        active_spaces_count(0),
+        task_scheduler(nullptr),
+        space_pool(nullptr),
+        query_pool(nullptr),
+        query_thread_count(0) {}
 
 BulletPhysicsServer::~BulletPhysicsServer() {}
 
@@ -185,7 +193,7 @@ real_t BulletPhysicsServer::shape_get_custom_solver_bias(RID p_shape) const {
 }
 
 RID BulletPhysicsServer::space_create() {
-    SpaceBullet *space = bulletnew(SpaceBullet);
+    SpaceBullet *space = bulletnew(SpaceBullet(task_scheduler ? task_scheduler->get_worker_count() : 0));
     CreateThenReturnRID(space_owner, space);
 }
 
@@ -1563,6 +1571,46 @@ void BulletPhysicsServer::free_rid(RID p_rid) {
 
 void BulletPhysicsServer::init() {
     BulletPhysicsDirectBodyState::initialize_class();
+
+    // Bullet hands a thread index to every thread running its code, a third of them for each pool
+    int thread_count = T_GLOBAL_GET<int>("physics/3d/bullet/thread_count");
+    if (thread_count <= 0) {
+        thread_count = OS::get_singleton()->get_default_thread_pool_size();
+    }
+    thread_count = CLAMP(thread_count, 1, GodotTaskScheduler::MAX_POOL_THREADS);
+
+    if (T_GLOBAL_GET<bool>("physics/3d/bullet/multithreaded_world")) {
+        task_scheduler = bulletnew(GodotTaskScheduler(thread_count));
+        btSetTaskScheduler(task_scheduler);
+    }
+    if (T_GLOBAL_GET<bool>("physics/3d/bullet/parallel_spaces")) {
+        space_pool = memnew(ThreadWorkPool);
+        space_pool->init(thread_count);
+    }
+    query_thread_count = T_GLOBAL_GET<bool>("physics/3d/bullet/parallel_queries") ? thread_count : 0;
+}
+
+ThreadWorkPool *BulletPhysicsServer::acquire_query_pool() {
+
+    if (query_thread_count < 2)
+        return nullptr;
+    bool expected = false;
+    if (!query_pool_busy.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        return nullptr;
+
+    if (!query_pool) {
+        query_pool = memnew(ThreadWorkPool);
+        query_pool->init(query_thread_count);
+    }
+    return query_pool;
+}
+
+void BulletPhysicsServer::release_query_pool() {
+    query_pool_busy.store(false, std::memory_order_release);
+}
+
+void BulletPhysicsServer::_step_space(uint32_t p_index, float p_delta_time) {
+    active_spaces[step_group_from + p_index]->step(p_delta_time);
 }
 
 void BulletPhysicsServer::step(float p_deltaTime) {
@@ -1571,6 +1619,38 @@ void BulletPhysicsServer::step(float p_deltaTime) {
     if (!active)
         return;
 
+    if (space_pool && active_spaces_count > 1) {
+        // Each space of a group runs on its own pool thread and parks once Bullet applied gravity, where a serial
+        // step would dispatch the callbacks. Callbacks can run scripts, so they run here in space order while no
+        // space of the group is stepping. The spaces don't share anything else while stepping.
+        const int group_size = space_pool->get_thread_count();
+        for (int from = 0; from < active_spaces_count; from += group_size) {
+            const int count = MIN(group_size, active_spaces_count - from);
+            for (int i = 0; i < count; ++i) {
+                active_spaces[from + i]->set_step_barrier(&spaces_parked);
+            }
+            step_group_from = from;
+            space_pool->begin_work(count, this, &BulletPhysicsServer::_step_space, p_deltaTime);
+            for (int i = 0; i < count; ++i) {
+                spaces_parked.wait();
+            }
+            for (int i = 0; i < count; ++i) {
+                if (active_spaces[from + i]->is_step_parked()) {
+                    active_spaces[from + i]->flush_queries();
+                }
+            }
+            for (int i = 0; i < count; ++i) {
+                if (active_spaces[from + i]->is_step_parked()) {
+                    active_spaces[from + i]->resume_step();
+                }
+            }
+            space_pool->end_work();
+            for (int i = 0; i < count; ++i) {
+                active_spaces[from + i]->set_step_barrier(nullptr);
+            }
+        }
+        return;
+    }
 
     for (int i = 0; i < active_spaces_count; ++i) {
 
@@ -1582,6 +1662,23 @@ void BulletPhysicsServer::flush_queries() {
 }
 
 void BulletPhysicsServer::finish() {
+    if (space_pool) {
+        space_pool->finish();
+        memdelete(space_pool);
+        space_pool = nullptr;
+    }
+    if (query_pool) {
+        query_pool->finish();
+        memdelete(query_pool);
+        query_pool = nullptr;
+    }
+    if (task_scheduler) {
+        btSetTaskScheduler(btGetSequentialTaskScheduler());
+        bulletdelete(task_scheduler);
+        task_scheduler = nullptr;
+    }
+    // The pool threads are gone, a later init() hands out their thread indexes again.
+    btResetThreadIndexCounter();
 }
 
 int BulletPhysicsServer::get_process_info(ProcessInfo p_info) {
@@ -30,9 +30,12 @@
 
 #pragma once
 
+#include "core/os/semaphore.h"
 #include "core/rid.h"
 #include "servers/physics_server_3d.h"
 
+#include <atomic>
+
 /**
     @author AndreaCatania
 */
@@ -44,6 +47,8 @@ class SoftBodyBullet;
 class JointBullet;
 class CollisionObjectBullet;
 class RigidCollisionObjectBullet;
+class GodotTaskScheduler;
+class ThreadWorkPool;
 
 class GODOT_EXPORT BulletPhysicsServer : public PhysicsServer3D {
     GDCLASS(BulletPhysicsServer,PhysicsServer3D)
@@ -54,6 +59,20 @@ class GODOT_EXPORT BulletPhysicsServer : public PhysicsServer3D {
     char active_spaces_count;
     Vector<SpaceBullet *> active_spaces;
 
+    /// Set by physics/3d/bullet/multithreaded_world, new spaces use multithreaded worlds.
+    GodotTaskScheduler *task_scheduler;
+    /// Set by physics/3d/bullet/parallel_spaces, steps the active spaces concurrently.
+    ThreadWorkPool *space_pool;
+    /// Posted once by every space of the group being stepped, see SpaceBullet::set_step_barrier.
+    Semaphore spaces_parked;
+    int step_group_from = 0;
+    /// Runs batched space queries, created by the first batch when physics/3d/bullet/parallel_queries is set.
+    ThreadWorkPool *query_pool;
+    int query_thread_count;
+    std::atomic<bool> query_pool_busy { false };
+
+    void _step_space(uint32_t p_index, float p_delta_time);
+
     mutable RID_Owner<SpaceBullet> space_owner;
     mutable RID_Owner<ShapeBullet> shape_owner;
     mutable RID_Owner<AreaBullet> area_owner;
@@ -68,6 +87,11 @@ public:
     BulletPhysicsServer();
     ~BulletPhysicsServer() override;
 
+    /// Returns nullptr when batched queries have to run on the calling thread: parallel queries are
+    /// disabled or another batch holds the pool. A non null pool is given back with release_query_pool().
+    ThreadWorkPool *acquire_query_pool();
+    void release_query_pool();
+
     _FORCE_INLINE_ RID_Owner<SpaceBullet> *get_space_owner() {
         return &space_owner;
     }
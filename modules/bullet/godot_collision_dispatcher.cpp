@@ -56,3 +56,22 @@ bool GodotCollisionDispatcher::needsResponse(const btCollisionObject *body0, con
     }
     return btCollisionDispatcher::needsResponse(body0, body1);
 }
+
+GodotCollisionDispatcherMt::GodotCollisionDispatcherMt(btCollisionConfiguration *collisionConfiguration) :
+        btCollisionDispatcherMt(collisionConfiguration) {}
+
+bool GodotCollisionDispatcherMt::needsCollision(const btCollisionObject *body0, const btCollisionObject *body1) {
+    if (body0->getUserIndex() == GodotCollisionDispatcher::CASTED_TYPE_AREA || body1->getUserIndex() == GodotCollisionDispatcher::CASTED_TYPE_AREA) {
+        // Avoide area narrow phase
+        return false;
+    }
+    return btCollisionDispatcherMt::needsCollision(body0, body1);
+}
+
+bool GodotCollisionDispatcherMt::needsResponse(const btCollisionObject *body0, const btCollisionObject *body1) {
+    if (body0->getUserIndex() == GodotCollisionDispatcher::CASTED_TYPE_AREA || body1->getUserIndex() == GodotCollisionDispatcher::CASTED_TYPE_AREA) {
+        // Avoide area narrow phase
+        return false;
+    }
+    return btCollisionDispatcherMt::needsResponse(body0, body1);
+}
@@ -32,6 +32,7 @@
 
 #include <stdint.h>
 
+#include <BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
 #include <btBulletDynamicsCommon.h>
 
 /**
@@ -40,6 +41,8 @@
 
 /// This class is required to implement custom collision behaviour in the narrowphase
 class GodotCollisionDispatcher : public btCollisionDispatcher {
+    friend class GodotCollisionDispatcherMt;
+
 private:
     static const int CASTED_TYPE_AREA;
 
@@ -48,3 +51,11 @@ public:
     bool needsCollision(const btCollisionObject *body0, const btCollisionObject *body1) override;
     bool needsResponse(const btCollisionObject *body0, const btCollisionObject *body1) override;
 };
+
+/// Same behaviour on top of Bullet's multithreaded narrowphase, used by multithreaded worlds
+class GodotCollisionDispatcherMt : public btCollisionDispatcherMt {
+public:
+    GodotCollisionDispatcherMt(btCollisionConfiguration *collisionConfiguration);
+    bool needsCollision(const btCollisionObject *body0, const btCollisionObject *body1) override;
+    bool needsResponse(const btCollisionObject *body0, const btCollisionObject *body1) override;
+};
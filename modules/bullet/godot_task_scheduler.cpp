@@ -0,0 +1,140 @@
+/*************************************************************************/
+/*  godot_task_scheduler.cpp                                             */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#include "godot_task_scheduler.h"
+
+#include "core/os/os.h"
+
+#include <LinearMath/btMinMax.h>
+#include <LinearMath/btQuickprof.h>
+
+int GodotTaskScheduler::getMaxNumThreads() const {
+    return BT_MAX_THREAD_COUNT;
+}
+
+int GodotTaskScheduler::getNumThreads() const {
+    // Bullet sizes its per thread containers (e.g. btCollisionDispatcherMt batches) with this and indexes them
+    // with btGetCurrentThreadIndex(). Indexes are handed out to any thread that runs Bullet code, the workers
+    // of the space stepping and query pools included, so the containers must cover all of them and not only
+    // our workers.
+    return BT_MAX_THREAD_COUNT;
+}
+
+void GodotTaskScheduler::setNumThreads(int p_num_threads) {
+
+    ERR_FAIL_COND_MSG(busy.load(), "Can't resize the Bullet task scheduler while it is running.");
+
+    if (p_num_threads <= 0)
+        p_num_threads = OS::get_singleton()->get_default_thread_pool_size();
+    worker_count = CLAMP(p_num_threads, 1, MAX_POOL_THREADS);
+
+    pool.finish();
+    pool.init(worker_count);
+
+    // all previous workers are gone, their thread indexes can be reused
+    m_savedThreadCounter = 0;
+    if (m_isActive) {
+        btResetThreadIndexCounter();
+    }
+}
+
+bool GodotTaskScheduler::_begin_loop(int p_begin, int p_end, int p_grain_size) {
+
+    if (worker_count < 2 || p_end - p_begin <= p_grain_size)
+        return false;
+    bool expected = false;
+    return busy.compare_exchange_strong(expected, true, std::memory_order_acquire);
+}
+
+void GodotTaskScheduler::_run_for(uint32_t p_task, Loop *p_loop) {
+
+    const int begin = p_loop->begin + p_task * p_loop->grain_size;
+    p_loop->for_body->forLoop(begin, btMin(begin + p_loop->grain_size, p_loop->end));
+}
+
+void GodotTaskScheduler::_run_sum(uint32_t p_task, Loop *p_loop) {
+
+    const int begin = p_loop->begin + p_task * p_loop->grain_size;
+    p_loop->sums[p_task] = p_loop->sum_body->sumLoop(begin, btMin(begin + p_loop->grain_size, p_loop->end));
+}
+
+void GodotTaskScheduler::parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody &body) {
+
+    BT_PROFILE("parallelFor_Godot");
+    grainSize = btMax(grainSize, 1);
+    if (!_begin_loop(iBegin, iEnd, grainSize)) {
+        body.forLoop(iBegin, iEnd);
+        return;
+    }
+
+    Loop loop;
+    loop.for_body = &body;
+    loop.begin = iBegin;
+    loop.end = iEnd;
+    loop.grain_size = grainSize;
+    pool.do_work((iEnd - iBegin + grainSize - 1) / grainSize, this, &GodotTaskScheduler::_run_for, &loop);
+
+    busy.store(false, std::memory_order_release);
+}
+
+btScalar GodotTaskScheduler::parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody &body) {
+
+    BT_PROFILE("parallelSum_Godot");
+    grainSize = btMax(grainSize, 1);
+    if (!_begin_loop(iBegin, iEnd, grainSize)) {
+        return body.sumLoop(iBegin, iEnd);
+    }
+
+    Loop loop;
+    loop.sum_body = &body;
+    loop.begin = iBegin;
+    loop.end = iEnd;
+    loop.grain_size = grainSize;
+    loop.sums.resize((iEnd - iBegin + grainSize - 1) / grainSize, btScalar(0));
+    pool.do_work(loop.sums.size(), this, &GodotTaskScheduler::_run_sum, &loop);
+
+    busy.store(false, std::memory_order_release);
+
+    // summed in task order so the result doesn't depend on scheduling
+    btScalar sum = 0;
+    for (btScalar s : loop.sums)
+        sum += s;
+    return sum;
+}
+
+GodotTaskScheduler::GodotTaskScheduler(int p_worker_count) :
+        btITaskScheduler("Godot") {
+    setNumThreads(p_worker_count);
+}
+
+GodotTaskScheduler::~GodotTaskScheduler() {
+    pool.finish();
+}
@@ -0,0 +1,80 @@
+/*************************************************************************/
+/*  godot_task_scheduler.h                                               */
+/*************************************************************************/
+/*                       This file is part of:                           */
+/*                           GODOT ENGINE                                */
+/*                      https://godotengine.org                          */
+/*************************************************************************/
+/* Copyright (c) 2007-2019 Juan Linietsky, Ariel Manzur.                 */
+/* Copyright (c) 2014-2019 Godot Engine contributors (cf. AUTHORS.md).   */
+/*                                                                       */
+/* Permission is hereby granted, free of charge, to any person obtaining */
+/* a copy of this software and associated documentation files (the       */
+/* "Software"), to deal in the Software without restriction, including   */
+/* without limitation the rights to use, copy, modify, merge, publish,   */
+/* distribute, sublicense, and/or sell copies of the Software, and to    */
+/* permit persons to whom the Software is furnished to do so, subject to */
+/* the following conditions:                                             */
+/*                                                                       */
+/* The above copyright notice and this permission notice shall be        */
+/* included in all copies or substantial portions of the Software.       */
+/*                                                                       */
+/* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,       */
+/* EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF    */
+/* MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.*/
+/* IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY  */
+/* CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,  */
+/* TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE     */
+/* SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.                */
+/*************************************************************************/
+
+
+#pragma once
+
+#include "core/os/thread_work_pool.h"
+#include "core/vector.h"
+
+#include <LinearMath/btThreads.h>
+
+#include <atomic>
+
+/// Runs Bullet's parallel loops on a ThreadWorkPool, it is installed with
+/// btSetTaskScheduler when the multithreaded dynamics world is enabled.
+class GodotTaskScheduler : public btITaskScheduler {
+
+    struct Loop {
+        const btIParallelForBody *for_body = nullptr;
+        const btIParallelSumBody *sum_body = nullptr;
+        int begin = 0;
+        int end = 0;
+        int grain_size = 1;
+        Vector<btScalar> sums;
+    };
+
+    ThreadWorkPool pool;
+    int worker_count = 0;
+    /// ThreadWorkPool runs one batch at a time: loops started while it is busy,
+    /// e.g. by spaces stepping in parallel, run on the calling thread.
+    std::atomic<bool> busy { false };
+
+    void _run_for(uint32_t p_task, Loop *p_loop);
+    void _run_sum(uint32_t p_task, Loop *p_loop);
+    bool _begin_loop(int p_begin, int p_end, int p_grain_size);
+
+public:
+    /// Bullet has BT_MAX_THREAD_COUNT thread indexes for the main thread and the workers of the task
+    /// scheduler, the parallel space stepping and the batched query pools.
+    static constexpr int MAX_POOL_THREADS = (int(BT_MAX_THREAD_COUNT) - 1) / 3;
+
+    int getMaxNumThreads() const override;
+    int getNumThreads() const override;
+    void setNumThreads(int p_num_threads) override;
+    void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody &body) override;
+    btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody &body) override;
+
+    int get_worker_count() const { return worker_count; }
+
+    /// Worker threads, <= 0 uses the default thread pool size.
+    explicit GodotTaskScheduler(int p_worker_count);
+    ~GodotTaskScheduler() override;
+};
@@ -55,6 +55,12 @@ void register_bullet_types() {
 
     GLOBAL_DEF("physics/3d/active_soft_world", true);
     ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/active_soft_world", PropertyInfo(VariantType::BOOL, "physics/3d/active_soft_world"));
+
+    GLOBAL_DEF("physics/3d/bullet/multithreaded_world", false);
+    GLOBAL_DEF("physics/3d/bullet/parallel_spaces", false);
+    GLOBAL_DEF("physics/3d/bullet/parallel_queries", true);
+    GLOBAL_DEF("physics/3d/bullet/thread_count", 0);
+    ProjectSettings::get_singleton()->set_custom_property_info("physics/3d/bullet/thread_count", PropertyInfo(VariantType::INT, "physics/3d/bullet/thread_count", PropertyHint::Range, "0,21,1"));
 #endif
 }
 
@@ -41,6 +41,7 @@
 #include "shape_bullet.h"
 #include "area_bullet.h"
 #include "core/class_db.h"
+#include "core/os/thread_work_pool.h"
 #include "core/object_db.h"
 #include "core/project_settings.h"
 #include "core/ustring.h"
@@ -53,6 +54,7 @@
 #include <BulletCollision/NarrowPhaseCollision/btGjkPairDetector.h>
 #include <BulletCollision/NarrowPhaseCollision/btPointCollector.h>
 #include <BulletSoftBody/btSoftBodyRigidBodyCollisionConfiguration.h>
+#include <BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
 #include <BulletSoftBody/btSoftRigidDynamicsWorld.h>
 #include <btBulletDynamicsCommon.h>
 
@@ -125,6 +127,10 @@ bool BulletPhysicsDirectSpaceState::intersect_ray(const Vector3 &p_from, const V
 }
 
 int BulletPhysicsDirectSpaceState::intersect_shape(const RID &p_shape, const Transform &p_xform, float p_margin, ShapeResult *r_results, int p_result_max, const HashSet<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
+    return _intersect_shape(space->dynamicsWorld, p_shape, p_xform, p_margin, r_results, p_result_max, p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas);
+}
+
+int BulletPhysicsDirectSpaceState::_intersect_shape(btCollisionWorld *p_world, const RID &p_shape, const Transform &p_xform, float p_margin, ShapeResult *r_results, int p_result_max, const HashSet<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
     if (p_result_max <= 0)
         return 0;
 
@@ -150,7 +156,7 @@ int BulletPhysicsDirectSpaceState::intersect_shape(const RID &p_shape, const Tra
     btQuery.m_collisionFilterGroup = 0;
     btQuery.m_collisionFilterMask = p_collision_mask;
     btQuery.m_closestDistanceThreshold = 0;
-    space->dynamicsWorld->contactTest(&collision_object, btQuery);
+    p_world->contactTest(&collision_object, btQuery);
 
     bulletdelete(btConvex)
 
@@ -344,7 +350,113 @@ Vector3 BulletPhysicsDirectSpaceState::get_closest_point_to_object_volume(RID p_
     }
 }
 
-SpaceBullet::SpaceBullet() :
+// Queries handed to a pool task at once, large enough to pay for the view world of an overlap task.
+static constexpr int QUERY_BATCH_GRAIN = 32;
+static const HashSet<RID> no_exclude;
+
+struct BulletPhysicsDirectSpaceState::QueryBatch {
+    int count = 0;
+    const RayQuery *rays = nullptr;
+    const ShapeQuery *shapes = nullptr;
+    RayResult *ray_results = nullptr;
+    bool *ray_hits = nullptr;
+    ShapeResult *shape_results = nullptr;
+    int result_max = 0;
+    int *result_counts = nullptr;
+    CastMotionResult *motion_results = nullptr;
+};
+
+void BulletPhysicsDirectSpaceState::_run_batch(QueryBatch *p_batch, void (BulletPhysicsDirectSpaceState::*p_chunk_method)(uint32_t, QueryBatch *)) {
+
+    const uint32_t chunks = (p_batch->count + QUERY_BATCH_GRAIN - 1) / QUERY_BATCH_GRAIN;
+    BulletPhysicsServer *server = space->get_physics_server();
+    ThreadWorkPool *pool = chunks > 1 ? server->acquire_query_pool() : nullptr;
+    if (!pool) {
+        for (uint32_t i = 0; i < chunks; ++i) {
+            (this->*p_chunk_method)(i, p_batch);
+        }
+        return;
+    }
+    pool->do_work(chunks, this, p_chunk_method, p_batch);
+    server->release_query_pool();
+}
+
+void BulletPhysicsDirectSpaceState::_intersect_rays_chunk(uint32_t p_chunk, QueryBatch *p_batch) {
+
+    // Broadphase ray tests only read the tree, every thread walks it with its own stack.
+    const int end = btMin<int>((p_chunk + 1) * QUERY_BATCH_GRAIN, p_batch->count);
+    for (int i = p_chunk * QUERY_BATCH_GRAIN; i < end; ++i) {
+        const RayQuery &q = p_batch->rays[i];
+        p_batch->ray_hits[i] = intersect_ray(q.from, q.to, p_batch->ray_results[i], q.exclude ? *q.exclude : no_exclude, q.collision_mask, q.collide_with_bodies, q.collide_with_areas);
+    }
+}
+
+void BulletPhysicsDirectSpaceState::_intersect_shapes_chunk(uint32_t p_chunk, QueryBatch *p_batch) {
+
+    // contactTest creates and frees manifolds through the world dispatcher, which can't be shared between
+    // threads. Each task tests against the space's broadphase through a world with a dispatcher of its own.
+    GodotCollisionDispatcher dispatcher(space->collisionConfiguration);
+    btCollisionWorld view(&dispatcher, space->broadphase, space->collisionConfiguration);
+    view.getDispatchInfo() = space->dynamicsWorld->getDispatchInfo();
+
+    const int end = btMin<int>((p_chunk + 1) * QUERY_BATCH_GRAIN, p_batch->count);
+    for (int i = p_chunk * QUERY_BATCH_GRAIN; i < end; ++i) {
+        const ShapeQuery &q = p_batch->shapes[i];
+        p_batch->result_counts[i] = _intersect_shape(&view, q.shape, q.transform, q.margin, p_batch->shape_results + i * p_batch->result_max, p_batch->result_max, q.exclude ? *q.exclude : no_exclude, q.collision_mask, q.collide_with_bodies, q.collide_with_areas);
+    }
+}
+
+void BulletPhysicsDirectSpaceState::_cast_motions_chunk(uint32_t p_chunk, QueryBatch *p_batch) {
+
+    // Sweeps only read the broadphase, their narrowphase solvers are local.
+    const int end = btMin<int>((p_chunk + 1) * QUERY_BATCH_GRAIN, p_batch->count);
+    for (int i = p_chunk * QUERY_BATCH_GRAIN; i < end; ++i) {
+        const ShapeQuery &q = p_batch->shapes[i];
+        CastMotionResult &r = p_batch->motion_results[i];
+        r.closest_safe = 1;
+        r.closest_unsafe = 1;
+        cast_motion(q.shape, q.transform, q.motion, q.margin, r.closest_safe, r.closest_unsafe, q.exclude ? *q.exclude : no_exclude, q.collision_mask, q.collide_with_bodies, q.collide_with_areas);
+    }
+}
+
+void BulletPhysicsDirectSpaceState::intersect_rays(const RayQuery *p_queries, int p_count, RayResult *r_results, bool *r_hits) {
+
+    QueryBatch batch;
+    batch.count = p_count;
+    batch.rays = p_queries;
+    batch.ray_results = r_results;
+    batch.ray_hits = r_hits;
+    _run_batch(&batch, &BulletPhysicsDirectSpaceState::_intersect_rays_chunk);
+}
+
+void BulletPhysicsDirectSpaceState::intersect_shapes(const ShapeQuery *p_queries, int p_count, ShapeResult *r_results, int p_result_max, int *r_counts) {
+
+    if (p_result_max <= 0) {
+        for (int i = 0; i < p_count; ++i) {
+            r_counts[i] = 0;
+        }
+        return;
+    }
+
+    QueryBatch batch;
+    batch.count = p_count;
+    batch.shapes = p_queries;
+    batch.shape_results = r_results;
+    batch.result_max = p_result_max;
+    batch.result_counts = r_counts;
+    _run_batch(&batch, &BulletPhysicsDirectSpaceState::_intersect_shapes_chunk);
+}
+
+void BulletPhysicsDirectSpaceState::cast_motions(const ShapeQuery *p_queries, int p_count, CastMotionResult *r_results) {
+
+    QueryBatch batch;
+    batch.count = p_count;
+    batch.shapes = p_queries;
+    batch.motion_results = r_results;
+    _run_batch(&batch, &BulletPhysicsDirectSpaceState::_cast_motions_chunk);
+}
+
+SpaceBullet::SpaceBullet(int p_threads) :
         broadphase(nullptr),
         collisionConfiguration(nullptr),
         dispatcher(nullptr),
@@ -360,7 +472,12 @@ SpaceBullet::SpaceBullet() :
         contactDebugCount(0),
         delta_time(0.) {
 
-    create_empty_world(T_GLOBAL_DEF("physics/3d/active_soft_world", true));
+    const bool soft_world = T_GLOBAL_DEF("physics/3d/active_soft_world", true);
+    if (soft_world && p_threads > 0) {
+        WARN_PRINT_ONCE("Bullet has no multithreaded soft body world, disable physics/3d/active_soft_world to use physics/3d/bullet/multithreaded_world.");
+        p_threads = 0;
+    }
+    create_empty_world(soft_world, p_threads);
     direct_access = memnew(BulletPhysicsDirectSpaceState(this));
 }
 
@@ -378,7 +495,11 @@ void SpaceBullet::flush_queries() {
 
 void SpaceBullet::step(real_t p_delta_time) {
     delta_time = p_delta_time;
+    step_parked = false;
     dynamicsWorld->stepSimulation(p_delta_time, 0, 0);
+    if (step_barrier && !step_parked) {
+        step_barrier->post();
+    }
 }
 
 void SpaceBullet::set_param(PhysicsServer3D::AreaParameter p_param, const Variant &p_value) {
@@ -577,7 +698,15 @@ void SpaceBullet::remove_all_collision_objects() {
 }
 
 void onBulletPreTickCallback(btDynamicsWorld *p_dynamicsWorld, btScalar timeStep) {
-    static_cast<SpaceBullet *>(p_dynamicsWorld->getWorldUserInfo())->flush_queries();
+    SpaceBullet *sb = static_cast<SpaceBullet *>(p_dynamicsWorld->getWorldUserInfo());
+    if (sb->step_barrier && !sb->step_parked) {
+        // stepped on a pool thread, the server dispatches the callbacks now
+        sb->step_parked = true;
+        sb->step_barrier->post();
+        sb->step_resume.wait();
+        return;
+    }
+    sb->flush_queries();
 }
 
 void onBulletTickCallback(btDynamicsWorld *p_dynamicsWorld, btScalar timeStep) {
@@ -612,7 +741,7 @@ btScalar calculateGodotCombinedFriction(const btCollisionObject *body0, const bt
     return ABS(MIN(body0->getFriction(), body1->getFriction()));
 }
 
-void SpaceBullet::create_empty_world(bool p_create_soft_world) {
+void SpaceBullet::create_empty_world(bool p_create_soft_world, int p_threads) {
 
     gjk_epa_pen_solver = bulletnew(btGjkEpaPenetrationDepthSolver);
     gjk_simplex_solver = bulletnew(btVoronoiSimplexSolver);
@@ -620,6 +749,8 @@ void SpaceBullet::create_empty_world(bool p_create_soft_world) {
     void *world_mem;
     if (p_create_soft_world) {
         world_mem = malloc(sizeof(btSoftRigidDynamicsWorld));
+    } else if (p_threads > 0) {
+        world_mem = malloc(sizeof(btDiscreteDynamicsWorldMt));
     } else {
         world_mem = malloc(sizeof(btDiscreteDynamicsWorld));
     }
@@ -632,14 +763,22 @@ void SpaceBullet::create_empty_world(bool p_create_soft_world) {
         collisionConfiguration = bulletnew(GodotCollisionConfiguration(static_cast<btDiscreteDynamicsWorld *>(world_mem)));
     }
 
-    dispatcher = bulletnew(GodotCollisionDispatcher(collisionConfiguration));
     broadphase = bulletnew(btDbvtBroadphase);
-    solver = bulletnew(btSequentialImpulseConstraintSolver);
 
     if (p_create_soft_world) {
+        dispatcher = bulletnew(GodotCollisionDispatcher(collisionConfiguration));
+        solver = bulletnew(btSequentialImpulseConstraintSolver);
         dynamicsWorld = new (world_mem) btSoftRigidDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
         soft_body_world_info = bulletnew(btSoftBodyWorldInfo);
+    } else if (p_threads > 0) {
+        // one solver per island solved at the same time, plus the stepping thread
+        btConstraintSolverPoolMt *solver_pool = bulletnew(btConstraintSolverPoolMt(p_threads + 1));
+        dispatcher = bulletnew(GodotCollisionDispatcherMt(collisionConfiguration));
+        solver = solver_pool;
+        dynamicsWorld = new (world_mem) btDiscreteDynamicsWorldMt(dispatcher, broadphase, solver_pool, nullptr, collisionConfiguration);
     } else {
+        dispatcher = bulletnew(GodotCollisionDispatcher(collisionConfiguration));
+        solver = bulletnew(btSequentialImpulseConstraintSolver);
         dynamicsWorld = new (world_mem) btDiscreteDynamicsWorld(dispatcher, broadphase, solver, collisionConfiguration);
     }
 
@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include "core/os/semaphore.h"
 #include "core/variant.h"
 #include "core/vector.h"
 #include "godot_result_callbacks.h"
@@ -49,6 +50,7 @@
 class AreaBullet;
 class btBroadphaseInterface;
 class btCollisionDispatcher;
+class btCollisionWorld;
 class btConstraintSolver;
 class btDefaultCollisionConfiguration;
 class btDynamicsWorld;
@@ -73,6 +75,14 @@ class BulletPhysicsDirectSpaceState : public PhysicsDirectSpaceState3D {
 private:
     SpaceBullet *space;
 
+    struct QueryBatch;
+
+    int _intersect_shape(btCollisionWorld *p_world, const RID &p_shape, const Transform &p_xform, float p_margin, ShapeResult *r_results, int p_result_max, const HashSet<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas);
+    void _run_batch(QueryBatch *p_batch, void (BulletPhysicsDirectSpaceState::*p_chunk_method)(uint32_t, QueryBatch *));
+    void _intersect_rays_chunk(uint32_t p_chunk, QueryBatch *p_batch);
+    void _intersect_shapes_chunk(uint32_t p_chunk, QueryBatch *p_batch);
+    void _cast_motions_chunk(uint32_t p_chunk, QueryBatch *p_batch);
+
 public:
     BulletPhysicsDirectSpaceState(SpaceBullet *p_space);
 
@@ -84,11 +94,16 @@ public:
     bool collide_shape(RID p_shape, const Transform &p_shape_xform, float p_margin, Vector3 *r_results, int p_result_max, int &r_result_count, const HashSet<RID> &p_exclude = HashSet<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false) override;
     bool rest_info(RID p_shape, const Transform &p_shape_xform, float p_margin, ShapeRestInfo *r_info, const HashSet<RID> &p_exclude = HashSet<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false) override;
     Vector3 get_closest_point_to_object_volume(RID p_object, const Vector3 p_point) const override;
+
+    void intersect_rays(const RayQuery *p_queries, int p_count, RayResult *r_results, bool *r_hits) override;
+    void intersect_shapes(const ShapeQuery *p_queries, int p_count, ShapeResult *r_results, int p_result_max, int *r_counts) override;
+    void cast_motions(const ShapeQuery *p_queries, int p_count, CastMotionResult *r_results) override;
 };
 
 class SpaceBullet : public RIDBullet {
 
     friend class AreaBullet;
+    friend void onBulletPreTickCallback(btDynamicsWorld *world, btScalar timeStep);
     friend void onBulletTickCallback(btDynamicsWorld *world, btScalar timeStep);
     friend class BulletPhysicsDirectSpaceState;
 public:
@@ -143,14 +158,25 @@ public:
     Vector<Vector3> contactDebug;
     int contactDebugCount;
     real_t delta_time;
+    Semaphore *step_barrier = nullptr;
+    Semaphore step_resume;
+    bool step_parked = false;
 
 public:
-    SpaceBullet();
+    /// p_threads > 0 creates a multithreaded world, that many islands can be solved at once.
+    /// It needs btSetTaskScheduler to be called first and isn't available for soft worlds.
+    explicit SpaceBullet(int p_threads = 0);
     ~SpaceBullet() override;
 
     void flush_queries();
     real_t get_delta_time() { return delta_time; }
     void step(real_t p_delta_time);
+    /// While set, step() doesn't dispatch the Godot callbacks itself. Right after Bullet applied gravity it posts
+    /// p_barrier and waits for resume_step(), so another thread can call flush_queries() in between. A step without
+    /// substeps posts p_barrier when it returns instead.
+    void set_step_barrier(Semaphore *p_barrier) { step_barrier = p_barrier; }
+    bool is_step_parked() const { return step_parked; }
+    void resume_step() { step_resume.post(); }
 
     _FORCE_INLINE_ btBroadphaseInterface *get_broadphase() { return broadphase; }
     _FORCE_INLINE_ btCollisionDispatcher *get_dispatcher() { return dispatcher; }
@@ -217,7 +243,7 @@ public:
     int test_ray_separation(RigidBodyBullet *p_body, const Transform &p_transform, bool p_infinite_inertia, Vector3 &r_recover_motion, PhysicsServer3D::SeparationResult *r_results, int p_result_max, float p_margin);
 
 private:
-    void create_empty_world(bool p_create_soft_world);
+    void create_empty_world(bool p_create_soft_world, int p_threads);
     void destroy_world();
     void check_ghost_overlaps();
     void check_body_collision();
@@ -32,10 +32,13 @@
 
 #include "core/math/geometry.h"
 #include "core/math/math_funcs.h"
+#include "core/os/dir_access.h"
+#include "core/os/file_access.h"
 #include "core/os/os.h"
 #include "core/class_db.h"
 #include "core/translation_helpers.h"
 #include "core/os/threaded_array_processor.h"
+#include "core/print_string.h"
 #include "core/string_formatter.h"
 #include "core/string_utils.h"
 #include "core/project_settings.h"
@@ -218,14 +221,52 @@ Error LightmapperCPU::_layout_atlas(int p_max_size, Vector2i *r_atlas_size, int
     return OK;
 }
 
-void LightmapperCPU::_thread_func_callback(void *p_thread_data) {
-    ThreadData *thread_data = reinterpret_cast<ThreadData *>(p_thread_data);
+int LightmapperCPU::_get_thread_count() {
+    int num_threads = 0;
 #ifdef TOOLS_ENABLED
-    const int num_threads = EDITOR_GET_T<int>("editors/3d/lightmap_baking_number_of_cpu_threads");
-#else
-    const int num_threads = 0;
+    if (EditorSettings::get_singleton()) {
+        num_threads = EDITOR_GET_T<int>("editors/3d/lightmap_baking_number_of_cpu_threads");
+    }
 #endif
-    thread_process_array(thread_data->count, thread_data->instance, &LightmapperCPU::_thread_func_wrapper, thread_data, num_threads);
+    // 0 uses every logical core, negative values leave that many cores free.
+    if (num_threads <= 0) {
+        num_threads = eastl::max(1, OS::get_singleton()->get_processor_count() + num_threads);
+    }
+    return num_threads;
+}
+
+void LightmapperCPU::_thread_func_callback(void *p_thread_data) {
+    ThreadData *thread_data = reinterpret_cast<ThreadData *>(p_thread_data);
+
+    if (!thread_data->tile_run) {
+        thread_process_array(thread_data->count, thread_data->instance, &LightmapperCPU::_thread_func_wrapper, thread_data, _get_thread_count());
+        return;
+    }
+
+    // Not thread_process_array, it runs the first item on the calling thread, which here would be a whole share of tiles.
+    TileRun *run = thread_data->tile_run;
+    struct Worker {
+        LightmapperCPU *instance;
+        TileRun *run;
+        uint32_t index;
+
+        static void callback(void *p_worker) {
+            Worker *w = reinterpret_cast<Worker *>(p_worker);
+            w->instance->_tile_worker(w->index, w->run);
+        }
+    };
+
+    Vector<Worker> workers;
+    workers.resize(run->worker_count);
+    Thread *threads = memnew_arr(Thread, run->worker_count);
+    for (uint32_t i = 0; i < run->worker_count; i++) {
+        workers[i] = { thread_data->instance, run, i };
+        threads[i].start(&Worker::callback, &workers[i]);
+    }
+    for (uint32_t i = 0; i < run->worker_count; i++) {
+        threads[i].wait_to_finish();
+    }
+    memdelete_arr(threads);
 }
 
 void LightmapperCPU::_thread_func_wrapper(uint32_t p_idx, ThreadData *p_thread_data) {
@@ -239,34 +280,46 @@ void LightmapperCPU::_thread_func_wrapper(uint32_t p_idx, ThreadData *p_thread_d
     thread_progress++;
 }
 
-bool LightmapperCPU::_parallel_run(int p_count, const String &p_description, BakeThreadFunc p_thread_func, void *p_userdata, BakeStepFunc p_substep_func) {
+void LightmapperCPU::_tile_worker(uint32_t p_worker, TileRun *p_run) {
+
+    // Own share first, for locality, then help whoever still has tiles left.
+    for (uint32_t i = 0; i < p_run->worker_count; i++) {
+        TileQueue &queue = p_run->queues[(p_worker + i) % p_run->worker_count];
+        while (!thread_cancelled) {
+            const uint32_t tile = queue.next.fetch_add(1, std::memory_order_relaxed);
+            if (tile >= queue.end) {
+                break;
+            }
+            (this->*p_run->func)(bake_tiles[tile]);
+            thread_progress++;
+        }
+    }
+}
 
+bool LightmapperCPU::_run_threaded(ThreadData &p_data, const String &p_description, BakeStepFunc p_substep_func) {
+
+    const int count = p_data.count;
     bool cancelled = false;
     if (p_substep_func) {
-        cancelled = p_substep_func(0.0f, FormatVE("%s (%d/%d)", p_description.c_str(), 0, p_count), nullptr, false);
+        cancelled = p_substep_func(0.0f, FormatVE("%s (%d/%d)", p_description.c_str(), 0, count), nullptr, false);
     }
 
     thread_progress = 0;
     thread_cancelled = false;
 
-    if (p_count == 0) {
+    if (count == 0) {
         return cancelled;
     }
 
-    ThreadData td;
-    td.instance = this;
-    td.count = p_count;
-    td.thread_func = p_thread_func;
-    td.userdata = p_userdata;
     Thread runner_thread;
-    runner_thread.start(_thread_func_callback, &td);
+    runner_thread.start(_thread_func_callback, &p_data);
 
     int progress = thread_progress;
 
-    while (!cancelled && progress < p_count) {
-        float p = float(progress) / p_count;
+    while (!cancelled && progress < count) {
+        float p = float(progress) / count;
         if (p_substep_func) {
-            cancelled = p_substep_func(p, FormatVE("%s (%d/%d)", p_description.c_str(), progress + 1, p_count), nullptr, false);
+            cancelled = p_substep_func(p, FormatVE("%s (%d/%d)", p_description.c_str(), progress + 1, count), nullptr, false);
         }
         progress = thread_progress;
     }
@@ -278,6 +331,60 @@ bool LightmapperCPU::_parallel_run(int p_count, const String &p_description, Bak
     return cancelled;
 }
 
+bool LightmapperCPU::_parallel_run(int p_count, const String &p_description, BakeThreadFunc p_thread_func, void *p_userdata, BakeStepFunc p_substep_func) {
+
+    ThreadData td;
+    td.instance = this;
+    td.count = p_count;
+    td.thread_func = p_thread_func;
+    td.userdata = p_userdata;
+    td.tile_run = nullptr;
+    return _run_threaded(td, p_description, p_substep_func);
+}
+
+void LightmapperCPU::_build_tiles(bool p_lit_only) {
+
+    bake_tiles.clear();
+    for (uint32_t i = 0; i < mesh_instances.size(); i++) {
+        if (p_lit_only && !mesh_instances[i].generate_lightmap) {
+            continue;
+        }
+        const uint32_t texel_count = scene_lightmaps[i].size();
+        for (uint32_t begin = 0; begin < texel_count; begin += TILE_TEXELS) {
+            bake_tiles.push_back({ i, begin, eastl::min<uint32_t>(begin + TILE_TEXELS, texel_count) });
+        }
+    }
+}
+
+bool LightmapperCPU::_parallel_run_tiles(const String &p_description, TileFunc p_tile_func, BakeStepFunc p_substep_func) {
+
+    // All meshes go in one run, small meshes no longer leave cores idle at the end of each one.
+    const uint32_t tile_count = bake_tiles.size();
+    const uint32_t worker_count = eastl::max<uint32_t>(1, eastl::min<uint32_t>(_get_thread_count(), tile_count));
+
+    TileQueue *queues = memnew_arr(TileQueue, worker_count);
+    for (uint32_t i = 0; i < worker_count; i++) {
+        queues[i].next = uint64_t(tile_count) * i / worker_count;
+        queues[i].end = uint64_t(tile_count) * (i + 1) / worker_count;
+    }
+
+    TileRun run;
+    run.func = p_tile_func;
+    run.queues = queues;
+    run.worker_count = worker_count;
+
+    ThreadData td;
+    td.instance = this;
+    td.count = tile_count;
+    td.thread_func = nullptr;
+    td.userdata = nullptr;
+    td.tile_run = &run;
+    const bool cancelled = _run_threaded(td, p_description, p_substep_func);
+
+    memdelete_arr(queues);
+    return cancelled;
+}
+
 void LightmapperCPU::_generate_buffer(uint32_t p_idx, void *p_unused) {
 
     const Size2i &size = mesh_instances[p_idx].size;
@@ -715,237 +822,304 @@ float LightmapperCPU::_get_omni_attenuation(float distance, float inv_range, flo
     return nd * powf(eastl::max(distance, 0.0001f), -decay);
 }
 
-void LightmapperCPU::_compute_direct_light(uint32_t p_idx, void *r_lightmap) {
-    LightmapTexel *lightmap = (LightmapTexel *)r_lightmap;
-    for (unsigned int i = 0; i < lights.size(); ++i) {
-        const Light &light = lights[i];
-        Vector3 normal = lightmap[p_idx].normal;
-        Vector3 position = lightmap[p_idx].pos;
-        Color c = light.color;
-        Vector3 light_energy = Vector3(c.r, c.g, c.b) * light.energy;
+bool LightmapperCPU::_get_light_falloff(const Light &p_light, const Vector3 &p_position, const Vector3 &p_normal, Vector3 &r_light_to_point, float &r_dist, float &r_attenuation, float &r_disk_size) const {
 
-        Vector3 light_to_point = light.direction;
-        if (light.type == LIGHT_TYPE_OMNI || light.type == LIGHT_TYPE_SPOT) {
-            light_to_point = (position - light.position).normalized();
-        }
+    r_light_to_point = p_light.direction;
+    if (p_light.type == LIGHT_TYPE_OMNI || p_light.type == LIGHT_TYPE_SPOT) {
+        r_light_to_point = (p_position - p_light.position).normalized();
+    }
 
-        if (normal.dot(light_to_point) >= 0.0) {
-            continue;
-        }
+    if (p_normal.dot(r_light_to_point) >= 0.0) {
+        return false;
+    }
 
-        float dist;
-        float attenuation;
-        float soft_shadowing_disk_size;
+    if (p_light.type == LIGHT_TYPE_OMNI || p_light.type == LIGHT_TYPE_SPOT) {
+        r_dist = p_position.distance_to(p_light.position);
+        if (r_dist > p_light.range) {
+            return false;
+        }
+        r_disk_size = p_light.size / r_dist;
 
-        if (light.type == LIGHT_TYPE_OMNI || light.type == LIGHT_TYPE_SPOT) {
-            dist = position.distance_to(light.position);
-            if (dist > light.range) {
-                continue;
+        if (p_light.type == LIGHT_TYPE_OMNI) {
+            if (parameters.use_physical_light_attenuation) {
+                r_attenuation = _get_omni_attenuation(r_dist, 1.0f / p_light.range, p_light.attenuation);
+            } else {
+                r_attenuation = powf(1.0 - r_dist / p_light.range, p_light.attenuation);
             }
-            soft_shadowing_disk_size = light.size / dist;
+        } else /* (p_light.type == LIGHT_TYPE_SPOT) */ {
+            float angle = Math::acos(p_light.direction.dot(r_light_to_point));
 
-            if (light.type == LIGHT_TYPE_OMNI) {
-                if (parameters.use_physical_light_attenuation) {
-                    attenuation = _get_omni_attenuation(dist, 1.0f / light.range, light.attenuation);
-                } else {
-                    attenuation = powf(1.0 - dist / light.range, light.attenuation);
-                }
-            } else /* (light.type == LIGHT_TYPE_SPOT) */ {
-                float angle = Math::acos(light.direction.dot(light_to_point));
+            if (angle > p_light.spot_angle) {
+                return false;
+            }
 
-                if (angle > light.spot_angle) {
-                    continue;
-                }
+            float normalized_dist = r_dist * (1.0f / M_MAX(0.001f, p_light.range));
+            float norm_light_attenuation;
+            if (parameters.use_physical_light_attenuation) {
+                norm_light_attenuation = _get_omni_attenuation(r_dist, 1.0f / p_light.range, p_light.attenuation);
+            } else {
+                norm_light_attenuation = Math::pow(M_MAX(1.0f - normalized_dist, 0.001f), p_light.attenuation);
+            }
 
-                float normalized_dist = dist * (1.0f / M_MAX(0.001f, light.range));
-                float norm_light_attenuation;
-                if (parameters.use_physical_light_attenuation) {
-                    norm_light_attenuation = _get_omni_attenuation(dist, 1.0f / light.range, light.attenuation);
-                } else {
-                    norm_light_attenuation = Math::pow(M_MAX(1.0f - normalized_dist, 0.001f), light.attenuation);
-                }
+            float spot_cutoff = Math::cos(p_light.spot_angle);
+            float scos = M_MAX(r_light_to_point.dot(p_light.direction), spot_cutoff);
+            float spot_rim = (1.0f - scos) / (1.0f - spot_cutoff);
+            r_attenuation = norm_light_attenuation * (1.0f - pow(M_MAX(spot_rim, 0.001f), p_light.spot_attenuation));
+        }
+    } else /*if (p_light.type == LIGHT_TYPE_DIRECTIONAL)*/ {
+        r_dist = INFINITY;
+        r_attenuation = 1.0f;
+        r_disk_size = p_light.size;
+    }
+    return true;
+}
 
-                float spot_cutoff = Math::cos(light.spot_angle);
-                float scos = M_MAX(light_to_point.dot(light.direction), spot_cutoff);
-                float spot_rim = (1.0f - scos) / (1.0f - spot_cutoff);
-                attenuation = norm_light_attenuation * (1.0f - pow(M_MAX(spot_rim, 0.001f), light.spot_attenuation));
-            }
-        } else /*if (light.type == LIGHT_TYPE_DIRECTIONAL)*/ {
-            dist = INFINITY;
-            attenuation = 1.0f;
-            soft_shadowing_disk_size = light.size;
-        }
-
-        float penumbra = 0.0f;
-        if (light.size > 0.0) {
-            Vector3 light_to_point_tan;
-            Vector3 light_to_point_bitan;
-
-            if (light.type == LIGHT_TYPE_OMNI || light.type == LIGHT_TYPE_SPOT) {
-                light_to_point = (position - light.position).normalized();
-                Vector3 aux = light_to_point.y < 0.777 ? Vector3(0, 1, 0) : Vector3(1, 0, 0);
-                light_to_point_tan = light_to_point.cross(aux).normalized();
-                light_to_point_bitan = light_to_point.cross(light_to_point_tan).normalized();
-            } else /*if (light.type == LIGHT_TYPE_DIRECTIONAL)*/ {
-                Vector3 aux = light_to_point.y < 0.777 ? Vector3(0, 1, 0) : Vector3(1, 0, 0);
-                light_to_point_tan = light_to_point.cross(aux).normalized();
-                light_to_point_bitan = light_to_point.cross(light_to_point_tan).normalized();
+float LightmapperCPU::_trace_soft_shadow(const Light &p_light, const Vector3 &p_position, const Vector3 &p_light_to_point, float p_dist, float p_disk_size) {
+
+    thread_local Vector<LightmapRaycaster::Ray> rays;
+
+    Vector3 aux = p_light_to_point.y < 0.777 ? Vector3(0, 1, 0) : Vector3(1, 0, 0);
+    Vector3 light_to_point_tan = p_light_to_point.cross(aux).normalized();
+    Vector3 light_to_point_bitan = p_light_to_point.cross(light_to_point_tan).normalized();
+
+    // Optimization:
+    // Once already casted an important proportion of rays, if all are hits or misses,
+    // assume we're not in the penumbra so we can infer the rest would have the same result.
+    // All rays share an origin, so each half is traced as one coherent batch.
+    const int shadowing_ray_count = parameters.samples;
+    const int first_half = shadowing_ray_count / 2;
+
+    int hits = 0;
+    int cast = 0;
+    for (int half = 0; half < 2; half++) {
+        const int count = half == 0 ? first_half : shadowing_ray_count - first_half;
+        rays.clear();
+        for (int j = 0; j < count; j++) {
+            float r = uniform_rand();
+            float a = uniform_rand() * Math_TAU;
+            Vector2 disk_sample = (r * Vector2(Math::cos(a), Math::sin(a))) * p_disk_size;
+            Vector3 light_disk_to_point = (p_light_to_point + disk_sample.x * light_to_point_tan + disk_sample.y * light_to_point_bitan).normalized();
+            rays.emplace_back(p_position, -light_disk_to_point, parameters.bias, p_dist);
+        }
+        raycaster->intersect(rays);
+        for (const LightmapRaycaster::Ray &ray : rays) {
+            if (!ray) {
+                hits++;
             }
+        }
+        cast += count;
 
-            const static int shadowing_rays_check_penumbra_denom = 2;
-            int shadowing_ray_count = parameters.samples;
-
-            int hits = 0;
-            Vector3 light_disk_to_point = light_to_point;
-            for (int j = 0; j < shadowing_ray_count; j++) {
-                // Optimization:
-                // Once already casted an important proportion of rays, if all are hits or misses,
-                // assume we're not in the penumbra so we can infer the rest would have the same result
-                if (j == shadowing_ray_count / shadowing_rays_check_penumbra_denom) {
-                    if (hits == j) {
-                        // Assume totally lit
-                        hits = shadowing_ray_count;
-                        break;
-                    } else if (hits == 0) {
-                        // Assume totally dark
-                        hits = 0;
-                        break;
-                    }
-                }
+        if (half == 0) {
+            if (hits == cast) {
+                return 1.0f; // Assume totally lit
+            } else if (hits == 0) {
+                return 0.0f; // Assume totally dark
+            }
+        }
+    }
+    return (float)hits / shadowing_ray_count;
+}
 
-                float r = uniform_rand();
-                float a = uniform_rand() * Math_TAU;
-                Vector2 disk_sample = (r * Vector2(Math::cos(a), Math::sin(a))) * soft_shadowing_disk_size;
-                light_disk_to_point = (light_to_point + disk_sample.x * light_to_point_tan + disk_sample.y * light_to_point_bitan).normalized();
+void LightmapperCPU::_compute_direct_light(const BakeTile &p_tile) {
 
-                LightmapRaycaster::Ray ray = LightmapRaycaster::Ray(position, -light_disk_to_point, parameters.bias, dist);
-                if (raycaster->intersect(ray)) {
-                    continue;
-                }
+    struct HardShadow {
+        uint32_t texel;
+        float attenuation;
+        Vector3 light_to_point;
+    };
+    thread_local Vector<HardShadow> hard_shadows;
+    thread_local Vector<LightmapRaycaster::Ray> hard_rays;
+
+    LightmapTexel *lightmap = scene_lightmaps[p_tile.mesh].data();
+
+    auto add_light = [&](LightmapTexel &r_texel, const Light &p_light, float p_attenuation, const Vector3 &p_light_to_point) {
+        Color c = p_light.color;
+        Vector3 light_energy = Vector3(c.r, c.g, c.b) * p_light.energy;
+        Vector3 final_energy = p_attenuation * light_energy * M_MAX(0, r_texel.normal.dot(-p_light_to_point));
+        r_texel.direct_light += final_energy * p_light.indirect_multiplier;
+        if (p_light.bake_direct) {
+            r_texel.output_light += final_energy;
+        }
+    };
 
-                hits++;
+    for (unsigned int i = 0; i < lights.size(); ++i) {
+        const Light &light = lights[i];
+        hard_shadows.clear();
+        hard_rays.clear();
+
+        for (uint32_t t = p_tile.begin; t < p_tile.end; t++) {
+            const Vector3 position = lightmap[t].pos;
+            Vector3 light_to_point;
+            float dist;
+            float attenuation;
+            float soft_shadowing_disk_size;
+            if (!_get_light_falloff(light, position, lightmap[t].normal, light_to_point, dist, attenuation, soft_shadowing_disk_size)) {
+                continue;
             }
-            penumbra = (float)hits / shadowing_ray_count;
-        } else {
-            LightmapRaycaster::Ray ray = LightmapRaycaster::Ray(position, -light_to_point, parameters.bias, dist);
-            if (!raycaster->intersect(ray)) {
-                penumbra = 1.0f;
+
+            if (light.size > 0.0) {
+                const float penumbra = _trace_soft_shadow(light, position, light_to_point, dist, soft_shadowing_disk_size);
+                add_light(lightmap[t], light, attenuation * penumbra, light_to_point);
+            } else {
+                // A single ray per texel, batched over the whole tile.
+                hard_shadows.push_back({ t, attenuation, light_to_point });
+                hard_rays.emplace_back(position, -light_to_point, parameters.bias, dist);
             }
         }
 
-        Vector3 final_energy = attenuation * penumbra * light_energy * M_MAX(0, normal.dot(-light_to_point));
-        lightmap[p_idx].direct_light += final_energy * light.indirect_multiplier;
-        if (light.bake_direct) {
-            lightmap[p_idx].output_light += final_energy;
+        if (hard_rays.empty()) {
+            continue;
+        }
+        raycaster->intersect(hard_rays);
+        for (size_t j = 0; j < hard_rays.size(); j++) {
+            if (!hard_rays[j]) {
+                const HardShadow &shadow = hard_shadows[j];
+                add_light(lightmap[shadow.texel], light, shadow.attenuation, shadow.light_to_point);
+            }
         }
     }
 }
 
-void LightmapperCPU::_compute_indirect_light(uint32_t p_idx, void *r_lightmap) {
+bool LightmapperCPU::_continue_path(IndirectPath &r_path, const LightmapRaycaster::Ray &p_ray) {
 
-    LightmapTexel *lightmap = (LightmapTexel *)r_lightmap;
-    LightmapTexel &texel = lightmap[p_idx];
+    if (!p_ray) {
+        if (parameters.environment_panorama) {
+            Vector3 direction = parameters.environment_transform.xform_inv(p_ray.dir);
+            Vector2 st = Vector2(Math::atan2(direction.z, direction.x), Math::acos(direction.y));
 
-    Vector3 accum;
+            if (Math::is_nan(st.y)) {
+                st.y = direction.y > 0.0 ? 0.0 : Math_PI;
+            }
 
-    const Vector3 const_forward = Vector3(0, 0, 1);
-    const Vector3 const_up = Vector3(0, 1, 0);
+            st.x += Math_PI;
+            st /= Vector2(Math_TAU, Math_PI);
+            st.x = Math::fmod(st.x + 0.75, 1.0);
+            Color c = _bilinear_sample(parameters.environment_panorama, st, false, true);
+            r_path.color += r_path.throughput * Vector3(c.r, c.g, c.b) * c.a;
+        }
+        return false;
+    }
 
-    for (int i = 0; i < parameters.samples; i++) {
+    unsigned int hit_mesh_id = p_ray.geomID;
+    const Vector2i &size = mesh_instances[hit_mesh_id].size;
 
-        Vector3 color;
-        Vector3 throughput = Vector3(1.0f, 1.0f, 1.0f);
+    int x = CLAMP<int>(p_ray.u * size.x, 0, size.x - 1);
+    int y = CLAMP<int>(p_ray.v * size.y, 0, size.y - 1);
 
-        Vector3 position = texel.pos;
-        Vector3 normal = texel.normal;
-        Vector3 direction;
+    const int idx = scene_lightmap_indices[hit_mesh_id][y * size.x + x];
 
-        for (int depth = 0; depth < parameters.bounces; depth++) {
+    if (idx < 0) {
+        return false;
+    }
 
-            Vector3 tangent = const_forward.cross(normal);
-            if (unlikely(tangent.length_squared() < 0.005f)) {
-                tangent = const_up.cross(normal);
-            }
-            tangent.normalize();
-            Vector3 bitangent = tangent.cross(normal);
-            bitangent.normalize();
+    const LightmapTexel &sample = scene_lightmaps[hit_mesh_id][idx];
 
-            Basis normal_xform = Basis(tangent, bitangent, normal);
-            normal_xform.transpose();
+    if (sample.normal.dot(p_ray.dir) > 0.0 && !no_shadow_meshes.contains(hit_mesh_id)) {
+        // We hit a back-face
+        return false;
+    }
+
+    r_path.color += r_path.throughput * sample.emission;
+    r_path.throughput *= sample.albedo;
+    r_path.color += r_path.throughput * sample.direct_light * parameters.bounce_indirect_energy;
 
-            float u1 = uniform_rand();
-            float u2 = uniform_rand();
+    // Russian Roulette
+    // https://computergraphics.stackexchange.com/questions/2316/is-russian-roulette-really-the-answer
+    const float p = r_path.throughput[r_path.throughput.max_axis()];
+    if (uniform_rand() > p) {
+        return false;
+    }
+    r_path.throughput *= 1.0f / p;
 
-            float radius = Math::sqrt(u1);
-            float theta = Math_TAU * u2;
+    r_path.position = sample.pos;
+    r_path.normal = sample.normal;
+    return true;
+}
 
-            Vector3 axis = Vector3(radius * Math::cos(theta), radius * Math::sin(theta), Math::sqrt(eastl::max(0.0f, 1.0f - u1)));
+void LightmapperCPU::_compute_indirect_light(const BakeTile &p_tile) {
 
-            direction = normal_xform.xform(axis);
+    thread_local Vector<IndirectPath> paths;
+    thread_local Vector<LightmapRaycaster::Ray> rays;
+    thread_local Vector<Vector3> accum;
 
-            // We can skip multiplying throughput by cos(theta) because de sampling PDF is also cos(theta) and they cancel each other
-            //float pdf = normal.dot(direction);
-            //throughput *= normal.dot(direction)/pdf;
+    LightmapTexel *lightmap = scene_lightmaps[p_tile.mesh].data();
+    const uint32_t texel_count = p_tile.end - p_tile.begin;
+    const uint32_t samples = pass_samples;
 
-            LightmapRaycaster::Ray ray(position, direction, parameters.bias);
-            bool hit = raycaster->intersect(ray);
+    accum.assign(texel_count, Vector3());
 
-            if (!hit) {
-                if (parameters.environment_panorama) {
-                    direction = parameters.environment_transform.xform_inv(direction);
-                    Vector2 st = Vector2(Math::atan2(direction.z, direction.x), Math::acos(direction.y));
+    const Vector3 const_forward = Vector3(0, 0, 1);
+    const Vector3 const_up = Vector3(0, 1, 0);
 
-                    if (Math::is_nan(st.y)) {
-                        st.y = direction.y > 0.0 ? 0.0 : Math_PI;
-                    }
+    // Paths advance one bounce at a time over a batch, so every bounce is traced as ray packets. The samples of
+    // a texel are adjacent in the batch and share their first origin.
+    const uint32_t path_count = texel_count * samples;
+    for (uint32_t first = 0; first < path_count; first += PATH_BATCH) {
+        const uint32_t batch = eastl::min<uint32_t>(PATH_BATCH, path_count - first);
+        paths.resize(batch);
+        for (uint32_t i = 0; i < batch; i++) {
+            IndirectPath &path = paths[i];
+            path.texel = (first + i) / samples;
+            path.color = Vector3();
+            path.throughput = Vector3(1.0f, 1.0f, 1.0f);
+            path.position = lightmap[p_tile.begin + path.texel].pos;
+            path.normal = lightmap[p_tile.begin + path.texel].normal;
+        }
+
+        for (int depth = 0; depth < parameters.bounces && !paths.empty(); depth++) {
+
+            rays.resize(paths.size());
+            for (size_t i = 0; i < paths.size(); i++) {
+                const Vector3 &normal = paths[i].normal;
 
-                    st.x += Math_PI;
-                    st /= Vector2(Math_TAU, Math_PI);
-                    st.x = Math::fmod(st.x + 0.75, 1.0);
-                    Color c = _bilinear_sample(parameters.environment_panorama, st, false, true);
-                    color += throughput * Vector3(c.r, c.g, c.b) * c.a;
+                Vector3 tangent = const_forward.cross(normal);
+                if (unlikely(tangent.length_squared() < 0.005f)) {
+                    tangent = const_up.cross(normal);
                 }
-                break;
-            }
+                tangent.normalize();
+                Vector3 bitangent = tangent.cross(normal);
+                bitangent.normalize();
 
-            unsigned int hit_mesh_id = ray.geomID;
-            const Vector2i &size = mesh_instances[hit_mesh_id].size;
+                Basis normal_xform = Basis(tangent, bitangent, normal);
+                normal_xform.transpose();
 
-            int x = CLAMP<int>(ray.u * size.x, 0, size.x - 1);
-            int y = CLAMP<int>(ray.v * size.y, 0, size.y - 1);
+                float u1 = uniform_rand();
+                float u2 = uniform_rand();
 
-            const int idx = scene_lightmap_indices[hit_mesh_id][y * size.x + x];
+                float radius = Math::sqrt(u1);
+                float theta = Math_TAU * u2;
 
-            if (idx < 0) {
-                break;
-            }
+                Vector3 axis = Vector3(radius * Math::cos(theta), radius * Math::sin(theta), Math::sqrt(eastl::max(0.0f, 1.0f - u1)));
 
-            const LightmapTexel &sample = scene_lightmaps[hit_mesh_id][idx];
+                // We can skip multiplying throughput by cos(theta) because de sampling PDF is also cos(theta) and they cancel each other
+                //float pdf = normal.dot(direction);
+                //throughput *= normal.dot(direction)/pdf;
 
-            if (sample.normal.dot(ray.dir) > 0.0 && !no_shadow_meshes.contains(hit_mesh_id)) {
-                // We hit a back-face
-                break;
+                rays[i] = LightmapRaycaster::Ray(paths[i].position, normal_xform.xform(axis), parameters.bias);
             }
 
-            color += throughput * sample.emission;
-            throughput *= sample.albedo;
-            color += throughput * sample.direct_light * parameters.bounce_indirect_energy;
+            raycaster->intersect(rays);
 
-            // Russian Roulette
-            // https://computergraphics.stackexchange.com/questions/2316/is-russian-roulette-really-the-answer
-            const float p = throughput[throughput.max_axis()];
-            if (uniform_rand() > p) {
-                break;
+            size_t alive = 0;
+            for (size_t i = 0; i < paths.size(); i++) {
+                if (_continue_path(paths[i], rays[i])) {
+                    paths[alive++] = paths[i];
+                } else {
+                    accum[paths[i].texel] += paths[i].color;
+                }
             }
-            throughput *= 1.0f / p;
+            paths.resize(alive);
+        }
 
-            position = sample.pos;
-            normal = sample.normal;
+        for (const IndirectPath &path : paths) {
+            accum[path.texel] += path.color;
         }
-        accum += color;
     }
 
-    texel.output_light += accum / parameters.samples;
+    // Divided by the full sample count, progressive passes each add their share of the estimate.
+    for (uint32_t i = 0; i < texel_count; i++) {
+        lightmap[p_tile.begin + i].output_light += accum[i] / parameters.samples;
+    }
 }
 
 void LightmapperCPU::_post_process(uint32_t p_idx, void *r_output) {
@@ -1282,6 +1456,164 @@ void LightmapperCPU::_blit_lightmap(const Vector<Vector3> &p_src, const Vector2i
     p_dst->unlock();
 }
 
+uint64_t LightmapperCPU::_get_checkpoint_fingerprint() const {
+
+    // Anything that changes the stored light: settings, lights, the environment and the rasterized texels.
+    uint64_t h = hash_djb2_one_64(CHECKPOINT_VERSION);
+    auto hash_float = [&h](float p_value) { h = hash_djb2_one_64(hash_djb2_one_float(p_value), h); };
+    auto hash_vector = [&hash_float](const Vector3 &p_value) {
+        hash_float(p_value.x);
+        hash_float(p_value.y);
+        hash_float(p_value.z);
+    };
+
+    h = hash_djb2_one_64(parameters.samples, h);
+    h = hash_djb2_one_64(parameters.bounces, h);
+    h = hash_djb2_one_64(parameters.passes, h);
+    h = hash_djb2_one_64(parameters.use_physical_light_attenuation, h);
+    hash_float(parameters.bias);
+    hash_float(parameters.bounce_indirect_energy);
+
+    for (const Light &light : lights) {
+        h = hash_djb2_one_64(light.type, h);
+        h = hash_djb2_one_64(light.bake_direct, h);
+        hash_vector(light.position);
+        hash_vector(light.direction);
+        hash_vector(Vector3(light.color.r, light.color.g, light.color.b));
+        hash_float(light.energy);
+        hash_float(light.indirect_multiplier);
+        hash_float(light.range);
+        hash_float(light.attenuation);
+        hash_float(light.spot_angle);
+        hash_float(light.spot_attenuation);
+        hash_float(light.size);
+    }
+
+    h = hash_djb2_one_64(bool(parameters.environment_panorama), h);
+    if (parameters.environment_panorama) {
+        const Ref<Image> &panorama = parameters.environment_panorama;
+        h = hash_djb2_one_64(panorama->get_width(), h);
+        h = hash_djb2_one_64(panorama->get_height(), h);
+        h = hash_djb2_one_64(uint64_t(panorama->get_format()), h);
+        const PoolVector<uint8_t> data = panorama->get_data();
+        h = hash_djb2_one_64(hash_djb2_buffer64(data.read().ptr(), data.size()), h);
+        for (int i = 0; i < 3; i++) {
+            hash_vector(parameters.environment_transform.elements[i]);
+        }
+    }
+
+    // Texel alpha is what the raycaster's alpha textures are made of.
+    for (size_t i = 0; i < scene_lightmaps.size(); i++) {
+        h = hash_djb2_one_64(scene_lightmaps[i].size(), h);
+        for (const LightmapTexel &texel : scene_lightmaps[i]) {
+            hash_vector(texel.pos);
+            hash_vector(texel.normal);
+            hash_vector(texel.albedo);
+            hash_float(texel.alpha);
+            hash_vector(texel.emission);
+        }
+    }
+    return h;
+}
+
+bool LightmapperCPU::_load_checkpoint(uint64_t p_fingerprint, int &r_passes_done) {
+
+    if (!FileAccess::exists(parameters.checkpoint_path)) {
+        return false;
+    }
+    FileAccessRef f(FileAccess::open(parameters.checkpoint_path, FileAccess::READ));
+    ERR_FAIL_COND_V_MSG(!f, false, "Can't open lightmap checkpoint '" + parameters.checkpoint_path + "'.");
+
+    if (f->get_64() != p_fingerprint) {
+        return false; // Scene or settings changed since, bake from scratch.
+    }
+    const int passes_done = f->get_32();
+    ERR_FAIL_COND_V(passes_done > parameters.passes, false);
+
+    // Validate the whole file before touching any texel.
+    const uint64_t texel_bytes = sizeof(float) * 6;
+    uint64_t expected = f->get_position();
+    for (const Vector<LightmapTexel> &lightmap : scene_lightmaps) {
+        expected += texel_bytes * lightmap.size();
+    }
+    if (f->get_len() != expected) {
+        WARN_PRINT("Lightmap checkpoint '" + parameters.checkpoint_path + "' is truncated, baking from scratch.");
+        return false;
+    }
+
+    for (Vector<LightmapTexel> &lightmap : scene_lightmaps) {
+        for (LightmapTexel &texel : lightmap) {
+            texel.direct_light.x = f->get_float();
+            texel.direct_light.y = f->get_float();
+            texel.direct_light.z = f->get_float();
+            texel.output_light.x = f->get_float();
+            texel.output_light.y = f->get_float();
+            texel.output_light.z = f->get_float();
+        }
+    }
+    r_passes_done = passes_done;
+    return true;
+}
+
+void LightmapperCPU::_save_checkpoint(uint64_t p_fingerprint, int p_passes_done) {
+
+    // Written aside and renamed over, an interrupted write leaves the previous checkpoint intact.
+    const String tmp_path = parameters.checkpoint_path + ".tmp";
+    {
+        Error err;
+        FileAccessRef f(FileAccess::open(tmp_path, FileAccess::WRITE, &err));
+        ERR_FAIL_COND_MSG(err != OK, "Can't write lightmap checkpoint '" + tmp_path + "'.");
+
+        f->store_64(p_fingerprint);
+        f->store_32(p_passes_done);
+        for (const Vector<LightmapTexel> &lightmap : scene_lightmaps) {
+            for (const LightmapTexel &texel : lightmap) {
+                f->store_float(texel.direct_light.x);
+                f->store_float(texel.direct_light.y);
+                f->store_float(texel.direct_light.z);
+                f->store_float(texel.output_light.x);
+                f->store_float(texel.output_light.y);
+                f->store_float(texel.output_light.z);
+            }
+        }
+    }
+
+    DirAccessRef da(DirAccess::create_for_path(parameters.checkpoint_path));
+    if (da->rename(tmp_path, parameters.checkpoint_path) != OK) {
+        // Platforms where rename doesn't replace an existing file.
+        da->remove(parameters.checkpoint_path);
+        ERR_FAIL_COND_MSG(da->rename(tmp_path, parameters.checkpoint_path) != OK, "Can't write lightmap checkpoint '" + parameters.checkpoint_path + "'.");
+    }
+}
+
+void LightmapperCPU::_save_intermediate_lightmaps() {
+
+    // Raw accumulated light, before denoising and seam fixing, next to the checkpoint as <checkpoint>_<mesh>.exr.
+    const StringView base = PathUtils::get_basename(parameters.checkpoint_path);
+    for (size_t i = 0; i < mesh_instances.size(); i++) {
+        if (!mesh_instances[i].generate_lightmap) {
+            continue;
+        }
+        const Vector2i size = mesh_instances[i].size;
+        Ref<Image> image(make_ref_counted<Image>(size.x, size.y, false, ImageData::FORMAT_RGBH));
+        image->lock();
+        for (int y = 0; y < size.y; y++) {
+            for (int x = 0; x < size.x; x++) {
+                const int idx = scene_lightmap_indices[i][y * size.x + x];
+                if (idx >= 0) {
+                    const Vector3 &light = scene_lightmaps[i][idx].output_light;
+                    image->set_pixel(x, y, Color(light.x, light.y, light.z));
+                }
+            }
+        }
+        image->unlock();
+        if (image->save_exr(String(base) + "_" + itos(i) + ".exr", false) != OK) {
+            WARN_PRINT_ONCE("Can't save intermediate lightmaps, EXR export is not available.");
+            return;
+        }
+    }
+}
+
 LightmapperCPU::BakeError LightmapperCPU::bake(BakeQuality p_quality, bool p_use_denoiser, int p_bounces, float p_bounce_indirect_energy, float p_bias, bool p_generate_atlas, int p_max_texture_size, const Ref<Image> &p_environment_panorama, const Basis &p_environment_transform, BakeStepFunc p_step_function, void *p_bake_userdata, BakeStepFunc p_substep_function) {
 
     if (p_step_function) {
@@ -1303,6 +1635,8 @@ LightmapperCPU::BakeError LightmapperCPU::bake(BakeQuality p_quality, bool p_use
     parameters.bounce_indirect_energy = p_bounce_indirect_energy;
     parameters.environment_transform = p_environment_transform;
     parameters.environment_panorama = p_environment_panorama;
+    parameters.passes = eastl::max(1, T_GLOBAL_GET<int>("rendering/cpu_lightmapper/progressive/passes"));
+    parameters.checkpoint_path = T_GLOBAL_GET<String>("rendering/cpu_lightmapper/progressive/checkpoint_path");
 
     switch (p_quality) {
         case BAKE_QUALITY_LOW: {
@@ -1402,52 +1736,62 @@ LightmapperCPU::BakeError LightmapperCPU::bake(BakeQuality p_quality, bool p_use
     albedo_textures.clear();
     emission_textures.clear();
 
-    for (unsigned int i = 0; i < mesh_instances.size(); i++) {
+    // -1 until direct light is done, then the number of finished indirect passes.
+    int passes_done = -1;
+    const uint64_t fingerprint = _get_checkpoint_fingerprint();
+    if (!parameters.checkpoint_path.empty() && _load_checkpoint(fingerprint, passes_done)) {
+        print_line(FormatVE("Lightmapper: resuming from checkpoint '%s', %d of %d passes done.", parameters.checkpoint_path.c_str(), passes_done, parameters.passes));
+    }
+
+    if (passes_done < 0) {
         if (p_step_function) {
-            float p = float(i) / mesh_instances.size();
-            bool cancelled = p_step_function(0.2 + p * 0.2, FormatVE("%s (%d/%lu)", TTR("Direct lighting").asCString(), i, mesh_instances.size()), p_bake_userdata, false);
+            bool cancelled = p_step_function(0.2f, TTR("Direct lighting"), p_bake_userdata, true);
             if (cancelled) {
                 return BAKE_ERROR_USER_ABORTED;
             }
         }
 
-        if (_parallel_run(scene_lightmaps[i].size(), "Computing direct light", &LightmapperCPU::_compute_direct_light, scene_lightmaps[i].data(), p_substep_function)) {
+        _build_tiles(false);
+        if (_parallel_run_tiles("Computing direct light", &LightmapperCPU::_compute_direct_light, p_substep_function)) {
             return BAKE_ERROR_USER_ABORTED;
         }
-    }
-    raycaster->clear_mesh_filter();
 
-    int n_lit_meshes = 0;
-    for (unsigned int i = 0; i < mesh_instances.size(); i++) {
-        if (mesh_instances[i].generate_lightmap) {
-            n_lit_meshes++;
+        passes_done = 0;
+        if (!parameters.checkpoint_path.empty()) {
+            _save_checkpoint(fingerprint, passes_done);
         }
     }
+    raycaster->clear_mesh_filter();
 
     if (parameters.environment_panorama) {
         parameters.environment_panorama->lock();
     }
     if (parameters.bounces > 0) {
-        for (unsigned int i = 0; i < mesh_instances.size(); i++) {
-            if (!mesh_instances[i].generate_lightmap) {
-                continue;
-            }
+        _build_tiles(true);
 
+        for (int pass = passes_done; pass < parameters.passes; pass++) {
+            bool cancelled = false;
             if (p_step_function) {
-                float p = float(i) / n_lit_meshes;
-                bool cancelled = p_step_function(0.4 + p * 0.4,
-                        FormatVE("%s (%d/%d)", TTR("Indirect lighting").asCString(), i, mesh_instances.size()),
+                float p = float(pass) / parameters.passes;
+                cancelled = p_step_function(0.4 + p * 0.4,
+                        FormatVE("%s (%d/%d)", TTR("Indirect lighting").asCString(), pass + 1, parameters.passes),
                         p_bake_userdata, false);
-                if (cancelled) {
-                    return BAKE_ERROR_USER_ABORTED;
-                }
             }
 
-            if (!scene_lightmaps[i].empty()) {
-                if (_parallel_run(scene_lightmaps[i].size(), "Computing indirect light",
-                            &LightmapperCPU::_compute_indirect_light, scene_lightmaps[i].data(), p_substep_function)) {
-                    return BAKE_ERROR_USER_ABORTED;
+            pass_samples = parameters.samples * (pass + 1) / parameters.passes - parameters.samples * pass / parameters.passes;
+            if (!cancelled && pass_samples > 0) {
+                cancelled = _parallel_run_tiles("Computing indirect light", &LightmapperCPU::_compute_indirect_light, p_substep_function);
+            }
+            if (cancelled) {
+                if (parameters.environment_panorama) {
+                    parameters.environment_panorama->unlock();
                 }
+                return BAKE_ERROR_USER_ABORTED;
+            }
+
+            if (!parameters.checkpoint_path.empty()) {
+                _save_checkpoint(fingerprint, pass + 1);
+                _save_intermediate_lightmaps();
             }
         }
     }
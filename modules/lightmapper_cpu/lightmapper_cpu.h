@@ -88,6 +88,8 @@ class LightmapperCPU : public Lightmapper {
         bool use_physical_light_attenuation = false;
         Ref<Image> environment_panorama;
         Basis environment_transform;
+        int passes = 1; // indirect samples are split over this many progressive passes
+        String checkpoint_path; // progress is saved here after every pass, and resumed from if it matches the scene
     };
 
     struct UVSeam {
@@ -111,6 +113,41 @@ class LightmapperCPU : public Lightmapper {
         int y;
     };
 
+    enum {
+        CHECKPOINT_VERSION = 2,
+        TILE_TEXELS = 256, // texels per scheduling unit
+        PATH_BATCH = 1024, // indirect paths traced together, one bounce at a time
+    };
+
+    // A range of one mesh's texels, texels are stored in rasterization order so a range is spatially coherent.
+    struct BakeTile {
+        uint32_t mesh;
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    // One worker's contiguous share of the tiles. Workers that run out take tiles from the others' shares.
+    struct TileQueue {
+        std::atomic<uint32_t> next;
+        uint32_t end;
+    };
+
+    typedef void (LightmapperCPU::*TileFunc)(const BakeTile &);
+
+    struct TileRun {
+        TileFunc func;
+        TileQueue *queues;
+        uint32_t worker_count;
+    };
+
+    struct IndirectPath {
+        Vector3 color;
+        Vector3 throughput;
+        Vector3 position;
+        Vector3 normal;
+        uint32_t texel; // relative to the tile
+    };
+
     struct ThreadData;
 
     typedef void (LightmapperCPU::*BakeThreadFunc)(uint32_t, void *);
@@ -120,6 +157,7 @@ class LightmapperCPU : public Lightmapper {
         uint32_t count;
         BakeThreadFunc thread_func;
         void *userdata;
+        TileRun *tile_run; // runs tiles instead of thread_func when set
     };
 
     BakeParams parameters;
@@ -138,13 +176,21 @@ class LightmapperCPU : public Lightmapper {
     std::atomic<uint32_t> thread_progress;
     std::atomic<bool> thread_cancelled;
 
+    Vector<BakeTile> bake_tiles;
+    int pass_samples = 0; // indirect samples per texel in the current pass
+
     Ref<LightmapRaycaster> raycaster;
 
     Error _layout_atlas(int p_max_size, Vector2i *r_atlas_size, int *r_atlas_slices);
 
+    static int _get_thread_count();
     static void _thread_func_callback(void *p_thread_data);
     void _thread_func_wrapper(uint32_t p_idx, ThreadData *p_thread_data);
+    void _tile_worker(uint32_t p_worker, TileRun *p_run);
+    bool _run_threaded(ThreadData &p_data, const String &p_description, BakeStepFunc p_substep_func);
     bool _parallel_run(int p_count, const String &p_description, BakeThreadFunc p_thread_func, void *p_userdata, BakeStepFunc p_substep_func = nullptr);
+    void _build_tiles(bool p_lit_only);
+    bool _parallel_run_tiles(const String &p_description, TileFunc p_tile_func, BakeStepFunc p_substep_func = nullptr);
 
     void _generate_buffer(uint32_t p_idx, void *p_unused);
     Ref<Image> _init_bake_texture(const MeshData::TextureDef &p_texture_def, const HashMap<RenderingEntity, Ref<Image> > &p_tex_cache, ImageData::Format p_default_format);
@@ -154,9 +200,17 @@ class LightmapperCPU : public Lightmapper {
 
     float _get_omni_attenuation(float distance, float inv_range, float decay) const;
 
-    void _compute_direct_light(uint32_t p_idx, void *r_lightmap);
+    bool _get_light_falloff(const Light &p_light, const Vector3 &p_position, const Vector3 &p_normal, Vector3 &r_light_to_point, float &r_dist, float &r_attenuation, float &r_disk_size) const;
+    float _trace_soft_shadow(const Light &p_light, const Vector3 &p_position, const Vector3 &p_light_to_point, float p_dist, float p_disk_size);
+    void _compute_direct_light(const BakeTile &p_tile);
+
+    bool _continue_path(IndirectPath &r_path, const LightmapRaycaster::Ray &p_ray);
+    void _compute_indirect_light(const BakeTile &p_tile);
 
-    void _compute_indirect_light(uint32_t p_idx, void *r_lightmap);
+    uint64_t _get_checkpoint_fingerprint() const;
+    bool _load_checkpoint(uint64_t p_fingerprint, int &r_passes_done);
+    void _save_checkpoint(uint64_t p_fingerprint, int p_passes_done);
+    void _save_intermediate_lightmaps();
 
     void _post_process(uint32_t p_idx, void *r_output);
     void _compute_seams(const MeshInstance &p_mesh, Vector<UVSeam> &r_seams);
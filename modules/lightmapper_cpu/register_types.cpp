@@ -45,6 +45,9 @@ void register_lightmapper_cpu_types() {
     GLOBAL_DEF("rendering/cpu_lightmapper/quality/medium_quality_ray_count", 256);
     GLOBAL_DEF("rendering/cpu_lightmapper/quality/high_quality_ray_count", 512);
     GLOBAL_DEF("rendering/cpu_lightmapper/quality/ultra_quality_ray_count", 1024);
+    GLOBAL_DEF("rendering/cpu_lightmapper/progressive/passes", 1);
+    ProjectSettings::get_singleton()->set_custom_property_info("rendering/cpu_lightmapper/progressive/passes", PropertyInfo(VariantType::INT, "rendering/cpu_lightmapper/progressive/passes", PropertyHint::Range, "1,64,1"));
+    GLOBAL_DEF("rendering/cpu_lightmapper/progressive/checkpoint_path", "");
 #ifndef _3D_DISABLED
     LightmapperCPU::initialize_class();
     Lightmapper::create_cpu = create_lightmapper_cpu;
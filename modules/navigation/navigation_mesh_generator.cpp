@@ -39,6 +39,11 @@
 #include "core/method_bind_interface.h"
 #include "core/method_bind.h"
 #include "core/math/convex_hull.h"
+#include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
+#include "core/dictionary.h"
+#include "core/hashfuncs.h"
+#include "core/string_formatter.h"
 #include "scene/3d/collision_shape_3d.h"
 #include "scene/3d/mesh_instance_3d.h"
 #include "scene/3d/multimesh_instance_3d.h"
@@ -70,8 +75,10 @@
 #include <Recast.h>
 
 #include "EASTL/deque.h"
+#include "EASTL/sort.h"
 
 IMPL_GDCLASS(NavigationMeshGenerator)
+IMPL_GDCLASS(NavigationMeshTileCache)
 
 NavigationMeshGenerator *NavigationMeshGenerator::singleton = nullptr;
 
@@ -395,6 +402,24 @@ void NavigationMeshGenerator::_convert_detail_mesh_to_native_navigation_mesh(con
     }
 }
 
+void NavigationMeshGenerator::_init_recast_config(const Ref<NavigationMesh> &p_nav_mesh, rcConfig &r_cfg) {
+    memset(&r_cfg, 0, sizeof(r_cfg));
+
+    r_cfg.cs = p_nav_mesh->get_cell_size();
+    r_cfg.ch = p_nav_mesh->get_cell_height();
+    r_cfg.walkableSlopeAngle = p_nav_mesh->get_agent_max_slope();
+    r_cfg.walkableHeight = (int)Math::ceil(p_nav_mesh->get_agent_height() / r_cfg.ch);
+    r_cfg.walkableClimb = (int)Math::floor(p_nav_mesh->get_agent_max_climb() / r_cfg.ch);
+    r_cfg.walkableRadius = (int)Math::ceil(p_nav_mesh->get_agent_radius() / r_cfg.cs);
+    r_cfg.maxEdgeLen = (int)(p_nav_mesh->get_edge_max_length() / p_nav_mesh->get_cell_size());
+    r_cfg.maxSimplificationError = p_nav_mesh->get_edge_max_error();
+    r_cfg.minRegionArea = (int)(p_nav_mesh->get_region_min_size() * p_nav_mesh->get_region_min_size());
+    r_cfg.mergeRegionArea = (int)(p_nav_mesh->get_region_merge_size() * p_nav_mesh->get_region_merge_size());
+    r_cfg.maxVertsPerPoly = (int)p_nav_mesh->get_verts_per_poly();
+    r_cfg.detailSampleDist = p_nav_mesh->get_detail_sample_distance() < 0.9f ? 0 : p_nav_mesh->get_cell_size() * p_nav_mesh->get_detail_sample_distance();
+    r_cfg.detailSampleMaxError = p_nav_mesh->get_cell_height() * p_nav_mesh->get_detail_sample_max_error();
+}
+
 void NavigationMeshGenerator::_build_recast_navigation_mesh(
         Ref<NavigationMesh> p_nav_mesh,
 #ifdef TOOLS_ENABLED
@@ -423,21 +448,7 @@ void NavigationMeshGenerator::_build_recast_navigation_mesh(
     rcCalcBounds(verts, nverts, bmin, bmax);
 
     rcConfig cfg;
-    memset(&cfg, 0, sizeof(cfg));
-
-    cfg.cs = p_nav_mesh->get_cell_size();
-    cfg.ch = p_nav_mesh->get_cell_height();
-    cfg.walkableSlopeAngle = p_nav_mesh->get_agent_max_slope();
-    cfg.walkableHeight = (int)Math::ceil(p_nav_mesh->get_agent_height() / cfg.ch);
-    cfg.walkableClimb = (int)Math::floor(p_nav_mesh->get_agent_max_climb() / cfg.ch);
-    cfg.walkableRadius = (int)Math::ceil(p_nav_mesh->get_agent_radius() / cfg.cs);
-    cfg.maxEdgeLen = (int)(p_nav_mesh->get_edge_max_length() / p_nav_mesh->get_cell_size());
-    cfg.maxSimplificationError = p_nav_mesh->get_edge_max_error();
-    cfg.minRegionArea = (int)(p_nav_mesh->get_region_min_size() * p_nav_mesh->get_region_min_size());
-    cfg.mergeRegionArea = (int)(p_nav_mesh->get_region_merge_size() * p_nav_mesh->get_region_merge_size());
-    cfg.maxVertsPerPoly = (int)p_nav_mesh->get_verts_per_poly();
-    cfg.detailSampleDist = p_nav_mesh->get_detail_sample_distance() < 0.9f ? 0 : p_nav_mesh->get_cell_size() * p_nav_mesh->get_detail_sample_distance();
-    cfg.detailSampleMaxError = p_nav_mesh->get_cell_height() * p_nav_mesh->get_detail_sample_max_error();
+    _init_recast_config(p_nav_mesh, cfg);
 
     cfg.bmin[0] = bmin[0];
     cfg.bmin[1] = bmin[1];
@@ -562,6 +573,351 @@ void NavigationMeshGenerator::_build_recast_navigation_mesh(
     detail_mesh = nullptr;
 }
 
+namespace {
+
+uint64_t tile_key(int p_x, int p_z) {
+    return (uint64_t(uint32_t(p_x)) << 32) | uint32_t(p_z);
+}
+
+uint64_t hash_floats(const float *p_values, int p_count, uint64_t p_hash) {
+    for (int i = 0; i < p_count; i++) {
+        uint32_t bits;
+        memcpy(&bits, &p_values[i], sizeof(bits));
+        p_hash = hash_djb2_one_64(bits, p_hash);
+    }
+    return p_hash;
+}
+
+// Frees whatever a tile build allocated, on success and on every early return.
+struct RecastTileData {
+    rcHeightfield *hf = nullptr;
+    rcCompactHeightfield *chf = nullptr;
+    rcContourSet *cset = nullptr;
+    rcPolyMesh *poly_mesh = nullptr;
+    rcPolyMeshDetail *detail_mesh = nullptr;
+
+    ~RecastTileData() {
+        rcFreeHeightField(hf);
+        rcFreeCompactHeightfield(chf);
+        rcFreeContourSet(cset);
+        rcFreePolyMesh(poly_mesh);
+        rcFreePolyMeshDetail(detail_mesh);
+    }
+};
+
+// Position of a seam vertex on the weld grid.
+struct WeldKey {
+    int64_t x;
+    int64_t y;
+    int64_t z;
+
+    bool operator==(const WeldKey &p_other) const {
+        return x == p_other.x && y == p_other.y && z == p_other.z;
+    }
+    uint32_t hash() const {
+        return uint32_t(hash_djb2_one_64(z, hash_djb2_one_64(y, hash_djb2_one_64(x))));
+    }
+};
+
+struct TiledBake {
+    struct Job {
+        int x;
+        int z;
+        Vector<int> indices;
+        NavigationMeshTileCache::Tile *tile;
+    };
+
+    rcConfig base_cfg;
+    int partition_type;
+    bool filter_low_hanging_obstacles;
+    bool filter_ledge_spans;
+    bool filter_walkable_low_height_spans;
+    const Vector<float> *vertices;
+    float tile_world_size;
+    Vector<Job> jobs;
+    std::atomic<int> failed { 0 };
+
+    bool _build(const Job &p_job, RecastTileData &data) const {
+        rcContext ctx(false);
+        rcConfig cfg = base_cfg;
+
+        // The heightfield covers the tile plus a border, so regions and contours near the edge see their neighbours.
+        const float border = cfg.borderSize * cfg.cs;
+        cfg.bmin[0] = p_job.x * tile_world_size - border;
+        cfg.bmin[2] = p_job.z * tile_world_size - border;
+        cfg.bmax[0] = (p_job.x + 1) * tile_world_size + border;
+        cfg.bmax[2] = (p_job.z + 1) * tile_world_size + border;
+
+        const float *verts = vertices->data();
+        const int nverts = vertices->size() / 3;
+        const int *tris = p_job.indices.data();
+        const int ntris = p_job.indices.size() / 3;
+
+        data.hf = rcAllocHeightfield();
+        if (!data.hf || !rcCreateHeightfield(&ctx, *data.hf, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs, cfg.ch)) {
+            return false;
+        }
+
+        Vector<uint8_t> tri_areas;
+        tri_areas.resize(ntris, 0);
+        rcMarkWalkableTriangles(&ctx, cfg.walkableSlopeAngle, verts, nverts, tris, ntris, tri_areas.data());
+        if (!rcRasterizeTriangles(&ctx, verts, nverts, tris, tri_areas.data(), ntris, *data.hf, cfg.walkableClimb)) {
+            return false;
+        }
+
+        if (filter_low_hanging_obstacles) {
+            rcFilterLowHangingWalkableObstacles(&ctx, cfg.walkableClimb, *data.hf);
+        }
+        if (filter_ledge_spans) {
+            rcFilterLedgeSpans(&ctx, cfg.walkableHeight, cfg.walkableClimb, *data.hf);
+        }
+        if (filter_walkable_low_height_spans) {
+            rcFilterWalkableLowHeightSpans(&ctx, cfg.walkableHeight, *data.hf);
+        }
+
+        data.chf = rcAllocCompactHeightfield();
+        if (!data.chf || !rcBuildCompactHeightfield(&ctx, cfg.walkableHeight, cfg.walkableClimb, *data.hf, *data.chf)) {
+            return false;
+        }
+        if (!rcErodeWalkableArea(&ctx, cfg.walkableRadius, *data.chf)) {
+            return false;
+        }
+
+        if (partition_type == NavigationMesh::SAMPLE_PARTITION_WATERSHED) {
+            if (!rcBuildDistanceField(&ctx, *data.chf) || !rcBuildRegions(&ctx, *data.chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea)) {
+                return false;
+            }
+        } else if (partition_type == NavigationMesh::SAMPLE_PARTITION_MONOTONE) {
+            if (!rcBuildRegionsMonotone(&ctx, *data.chf, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea)) {
+                return false;
+            }
+        } else if (!rcBuildLayerRegions(&ctx, *data.chf, cfg.borderSize, cfg.minRegionArea)) {
+            return false;
+        }
+
+        data.cset = rcAllocContourSet();
+        if (!data.cset || !rcBuildContours(&ctx, *data.chf, cfg.maxSimplificationError, cfg.maxEdgeLen, *data.cset)) {
+            return false;
+        }
+        data.poly_mesh = rcAllocPolyMesh();
+        if (!data.poly_mesh || !rcBuildPolyMesh(&ctx, *data.cset, cfg.maxVertsPerPoly, *data.poly_mesh)) {
+            return false;
+        }
+        data.detail_mesh = rcAllocPolyMeshDetail();
+        return data.detail_mesh && rcBuildPolyMeshDetail(&ctx, *data.poly_mesh, *data.chf, cfg.detailSampleDist, cfg.detailSampleMaxError, *data.detail_mesh);
+    }
+
+    void build_tile(uint32_t p_index, void *) {
+        const Job &job = jobs[p_index];
+        NavigationMeshTileCache::Tile &tile = *job.tile;
+        tile.vertices.clear();
+        tile.polygons.clear();
+
+        RecastTileData data;
+        if (!_build(job, data)) {
+            // Leaves the tile empty and forgets its hash, so the next bake tries it again.
+            tile.input_hash = 0;
+            failed.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        const rcPolyMeshDetail *detail_mesh = data.detail_mesh;
+        tile.vertices.reserve(detail_mesh->nverts);
+        for (int i = 0; i < detail_mesh->nverts; i++) {
+            const float *v = &detail_mesh->verts[i * 3];
+            tile.vertices.emplace_back(v[0], v[1], v[2]);
+        }
+        for (int i = 0; i < detail_mesh->nmeshes; i++) {
+            const unsigned int *m = &detail_mesh->meshes[i * 4];
+            const unsigned int bverts = m[0];
+            const unsigned int btris = m[2];
+            const unsigned int ntris = m[3];
+            const unsigned char *detail_tris = &detail_mesh->tris[btris * 4];
+            for (unsigned int j = 0; j < ntris; j++) {
+                // Polygon order in recast is opposite than godot's
+                tile.polygons.push_back({
+                        (int)(bverts + detail_tris[j * 4 + 0]),
+                        (int)(bverts + detail_tris[j * 4 + 2]),
+                        (int)(bverts + detail_tris[j * 4 + 1]),
+                });
+            }
+        }
+    }
+};
+
+} // namespace
+
+void NavigationMeshGenerator::_build_tiled_navigation_mesh(Ref<NavigationMesh> p_nav_mesh, const Vector<float> &p_vertices, const Vector<int> &p_indices, int &r_tiles, int &r_built_tiles) {
+
+    TiledBake bake;
+    rcConfig &cfg = bake.base_cfg;
+    _init_recast_config(p_nav_mesh, cfg);
+    cfg.tileSize = p_nav_mesh->get_tile_size();
+    cfg.borderSize = cfg.walkableRadius + 3;
+    cfg.width = cfg.tileSize + cfg.borderSize * 2;
+    cfg.height = cfg.tileSize + cfg.borderSize * 2;
+    rcCalcBounds(p_vertices.data(), p_vertices.size() / 3, cfg.bmin, cfg.bmax);
+
+    bake.partition_type = p_nav_mesh->get_sample_partition_type();
+    bake.filter_low_hanging_obstacles = p_nav_mesh->get_filter_low_hanging_obstacles();
+    bake.filter_ledge_spans = p_nav_mesh->get_filter_ledge_spans();
+    bake.filter_walkable_low_height_spans = p_nav_mesh->get_filter_walkable_low_height_spans();
+    bake.vertices = &p_vertices;
+    // Tiles sit on a grid anchored at the origin, so they keep their coordinates when the geometry grows.
+    bake.tile_world_size = cfg.tileSize * cfg.cs;
+
+    // Everything except the vertical bounds is the same for every tile, a change there invalidates all of them.
+    uint64_t settings_hash = hash_floats(&cfg.bmin[1], 1, 5381);
+    settings_hash = hash_floats(&cfg.bmax[1], 1, settings_hash);
+    {
+        rcConfig hashed = cfg;
+        memset(hashed.bmin, 0, sizeof(hashed.bmin));
+        memset(hashed.bmax, 0, sizeof(hashed.bmax));
+        settings_hash = hash_djb2_one_64(hash_djb2_buffer64((const uint8_t *)&hashed, sizeof(hashed)), settings_hash);
+    }
+    settings_hash = hash_djb2_one_64(uint64_t(bake.partition_type) | uint64_t(bake.filter_low_hanging_obstacles) << 8 |
+                    uint64_t(bake.filter_ledge_spans) << 9 | uint64_t(bake.filter_walkable_low_height_spans) << 10,
+            settings_hash);
+
+    Ref<NavigationMeshTileCache> cache(object_cast<NavigationMeshTileCache>(p_nav_mesh->get_bake_cache().get()));
+    if (!cache || cache->settings_hash != settings_hash) {
+        cache = make_ref_counted<NavigationMeshTileCache>();
+        cache->settings_hash = settings_hash;
+    }
+
+    // Hand every triangle to each tile its bounds overlap, border included.
+    HashMap<uint64_t, int> job_for_tile;
+    const float border = cfg.borderSize * cfg.cs;
+    const float *verts = p_vertices.data();
+    for (size_t t = 0; t + 2 < p_indices.size(); t += 3) {
+        float min_x = verts[p_indices[t] * 3], max_x = min_x;
+        float min_z = verts[p_indices[t] * 3 + 2], max_z = min_z;
+        for (int k = 1; k < 3; k++) {
+            const float *v = &verts[p_indices[t + k] * 3];
+            min_x = MIN(min_x, v[0]);
+            max_x = M_MAX(max_x, v[0]);
+            min_z = MIN(min_z, v[2]);
+            max_z = M_MAX(max_z, v[2]);
+        }
+        const int x0 = (int)Math::floor((min_x - border) / bake.tile_world_size);
+        const int x1 = (int)Math::floor((max_x + border) / bake.tile_world_size);
+        const int z0 = (int)Math::floor((min_z - border) / bake.tile_world_size);
+        const int z1 = (int)Math::floor((max_z + border) / bake.tile_world_size);
+        for (int z = z0; z <= z1; z++) {
+            for (int x = x0; x <= x1; x++) {
+                auto iter = job_for_tile.find(tile_key(x, z));
+                int job;
+                if (iter == job_for_tile.end()) {
+                    job = bake.jobs.size();
+                    job_for_tile[tile_key(x, z)] = job;
+                    bake.jobs.push_back({ x, z, {}, nullptr });
+                } else {
+                    job = iter->second;
+                }
+                Vector<int> &tile_indices = bake.jobs[job].indices;
+                tile_indices.push_back(p_indices[t]);
+                tile_indices.push_back(p_indices[t + 1]);
+                tile_indices.push_back(p_indices[t + 2]);
+            }
+        }
+    }
+
+    // Tiles whose triangles did not change keep their polygons, tiles without triangles are gone.
+    HashMap<uint64_t, NavigationMeshTileCache::Tile> tiles;
+    Vector<TiledBake::Job> to_build;
+    for (TiledBake::Job &job : bake.jobs) {
+        uint64_t input_hash = 5381;
+        for (int index : job.indices) {
+            input_hash = hash_floats(&verts[index * 3], 3, input_hash);
+        }
+        const uint64_t key = tile_key(job.x, job.z);
+        auto cached = cache->tiles.find(key);
+        if (cached != cache->tiles.end() && cached->second.input_hash == input_hash) {
+            tiles[key] = eastl::move(cached->second);
+        } else {
+            tiles[key].input_hash = input_hash;
+            to_build.emplace_back(eastl::move(job));
+        }
+    }
+    // The map does not move its nodes once all tiles are in.
+    for (TiledBake::Job &job : to_build) {
+        job.tile = &tiles[tile_key(job.x, job.z)];
+    }
+    bake.jobs = eastl::move(to_build);
+
+    if (bake.jobs.size() > 1) {
+        ThreadWorkPool pool;
+        pool.init();
+        pool.do_work(bake.jobs.size(), &bake, &TiledBake::build_tile, nullptr);
+        pool.finish();
+    } else if (!bake.jobs.empty()) {
+        bake.build_tile(0, nullptr);
+    }
+    if (bake.failed.load() > 0) {
+        WARN_PRINT(FormatVE("Navigation mesh bake failed for %d tile(s).", bake.failed.load()));
+    }
+    r_tiles = tiles.size();
+    r_built_tiles = bake.jobs.size();
+
+    // NavRegion takes a single mesh, so the tiles are stitched back together in a stable order.
+    // Vertices on tile edges are welded; the edge connection margin of the map bridges what the
+    // detail meshes of two neighbours do not share exactly.
+    Vector<uint64_t> keys;
+    keys.reserve(tiles.size());
+    for (const auto &E : tiles) {
+        keys.push_back(E.first);
+    }
+    eastl::sort(keys.begin(), keys.end());
+
+    const float weld_epsilon = cfg.cs * 0.01f;
+    HashMap<WeldKey, int, Hasher<WeldKey>> welded;
+    Vector<Vector3> nav_vertices;
+    p_nav_mesh->clear_polygons();
+    for (uint64_t key : keys) {
+        NavigationMeshTileCache::Tile &tile = tiles[key];
+        Vector<int> remap;
+        remap.resize(tile.vertices.size());
+        for (size_t i = 0; i < tile.vertices.size(); i++) {
+            const Vector3 &v = tile.vertices[i];
+            const float fx = v.x / bake.tile_world_size;
+            const float fz = v.z / bake.tile_world_size;
+            const bool on_edge = Math::abs(fx - Math::round(fx)) * bake.tile_world_size < weld_epsilon ||
+                                 Math::abs(fz - Math::round(fz)) * bake.tile_world_size < weld_epsilon;
+            if (!on_edge) {
+                remap[i] = nav_vertices.size();
+                nav_vertices.push_back(v);
+                continue;
+            }
+            const WeldKey weld_key { int64_t(Math::round(v.x / weld_epsilon)), int64_t(Math::round(v.y / cfg.ch)),
+                int64_t(Math::round(v.z / weld_epsilon)) };
+            auto iter = welded.find(weld_key);
+            if (iter != welded.end()) {
+                remap[i] = iter->second;
+            } else {
+                remap[i] = nav_vertices.size();
+                welded[weld_key] = remap[i];
+                nav_vertices.push_back(v);
+            }
+        }
+        for (const Vector<int> &polygon : tile.polygons) {
+            Vector<int> nav_polygon;
+            nav_polygon.reserve(polygon.size());
+            for (int index : polygon) {
+                nav_polygon.push_back(remap[index]);
+            }
+            // Welding can collapse a sliver triangle on the tile edge.
+            if (nav_polygon[0] == nav_polygon[1] || nav_polygon[1] == nav_polygon[2] || nav_polygon[0] == nav_polygon[2]) {
+                continue;
+            }
+            p_nav_mesh->add_polygon(eastl::move(nav_polygon));
+        }
+    }
+    p_nav_mesh->set_vertices(eastl::move(nav_vertices));
+
+    cache->tiles = eastl::move(tiles);
+    p_nav_mesh->set_bake_cache(cache);
+}
+
 NavigationMeshGenerator *NavigationMeshGenerator::get_singleton() {
     return singleton;
 }
@@ -606,7 +962,21 @@ void NavigationMeshGenerator::bake(Ref<NavigationMesh> p_nav_mesh, Node *p_node)
         _parse_geometry(navmesh_xform, E, vertices, indices, geometry_type, collision_mask, recurse_children);
     }
 
-    if (vertices.size() > 0 && indices.size() > 0) {
+    const uint64_t bake_start = OS::get_singleton()->get_ticks_usec();
+    int bake_tiles = 0;
+    int bake_built_tiles = 0;
+
+    if (vertices.size() > 0 && indices.size() > 0 && p_nav_mesh->get_tile_size() > 0) {
+
+#ifdef TOOLS_ENABLED
+        if (ep)
+            ep->step(TTR("Building Tiles..."), 1);
+#endif
+        _build_tiled_navigation_mesh(p_nav_mesh, vertices, indices, bake_tiles, bake_built_tiles);
+
+    } else if (vertices.size() > 0 && indices.size() > 0) {
+
+        p_nav_mesh->set_bake_cache({});
 
         rcHeightfield *hf = nullptr;
         rcCompactHeightfield *chf = nullptr;
@@ -642,6 +1012,13 @@ void NavigationMeshGenerator::bake(Ref<NavigationMesh> p_nav_mesh, Node *p_node)
         rcFreePolyMeshDetail(detail_mesh);
         detail_mesh = nullptr;
     }
+    {
+        // bake() also runs on the NavigationMeshInstance bake thread.
+        MutexLock stats_lock(last_bake_mutex);
+        last_bake_tiles = bake_tiles;
+        last_bake_built_tiles = bake_built_tiles;
+        last_bake_usec = OS::get_singleton()->get_ticks_usec() - bake_start;
+    }
 
 #ifdef TOOLS_ENABLED
     if (ep)
@@ -656,12 +1033,23 @@ void NavigationMeshGenerator::clear(Ref<NavigationMesh> p_nav_mesh) {
     if (p_nav_mesh) {
         p_nav_mesh->clear_polygons();
         p_nav_mesh->set_vertices({});
+        p_nav_mesh->set_bake_cache({});
     }
 }
 
+Dictionary NavigationMeshGenerator::get_last_bake_stats() const {
+    MutexLock stats_lock(last_bake_mutex);
+    Dictionary stats;
+    stats["tiles"] = last_bake_tiles;
+    stats["built_tiles"] = last_bake_built_tiles;
+    stats["time_usec"] = last_bake_usec;
+    return stats;
+}
+
 void NavigationMeshGenerator::_bind_methods() {
     SE_BIND_METHOD(NavigationMeshGenerator,bake);
     SE_BIND_METHOD(NavigationMeshGenerator,clear);
+    SE_BIND_METHOD(NavigationMeshGenerator,get_last_bake_stats);
 }
 
 #endif
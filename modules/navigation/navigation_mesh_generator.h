@@ -32,6 +32,9 @@
 
 #ifndef _3D_DISABLED
 
+#include "core/hash_map.h"
+#include "core/os/mutex.h"
+#include "core/reference.h"
 #include "scene/3d/navigation_mesh_instance.h"
 
 
@@ -39,12 +42,29 @@
 struct EditorProgress;
 #endif
 
+struct rcConfig;
 struct rcHeightfield;
 struct rcCompactHeightfield;
 struct rcContourSet;
 struct rcPolyMesh;
 struct rcPolyMeshDetail;
 
+// Result of the last tiled bake of a NavigationMesh, kept in NavigationMesh::get_bake_cache(). A tile is only built
+// again when the source triangles overlapping it or the bake settings change.
+class NavigationMeshTileCache : public RefCounted {
+    GDCLASS(NavigationMeshTileCache, RefCounted)
+
+public:
+    struct Tile {
+        uint64_t input_hash = 0;
+        Vector<Vector3> vertices;
+        Vector<Vector<int>> polygons;
+    };
+
+    uint64_t settings_hash = 0;
+    HashMap<uint64_t, Tile> tiles;
+};
+
 class GODOT_EXPORT NavigationMeshGenerator : public Object {
     GDCLASS(NavigationMeshGenerator, Object)
 
@@ -57,6 +77,7 @@ protected:
     static void _add_faces(const PoolVector3Array &p_faces, const Transform &p_xform, Vector<float> &p_verticies, Vector<int> &p_indices);
     static void _parse_geometry(const Transform &p_accumulated_transform, Node *p_node, Vector<float> &p_verticies, Vector<int> &p_indices, int p_generate_from, uint32_t p_collision_mask, bool p_recurse_children);
 
+    static void _init_recast_config(const Ref<NavigationMesh> &p_nav_mesh, rcConfig &r_cfg);
     static void _convert_detail_mesh_to_native_navigation_mesh(const rcPolyMeshDetail *p_detail_mesh, Ref<NavigationMesh> p_nav_mesh);
     static void _build_recast_navigation_mesh(
             Ref<NavigationMesh> p_nav_mesh,
@@ -70,6 +91,12 @@ protected:
             rcPolyMeshDetail *detail_mesh,
             Vector<float> &vertices,
             Vector<int> &indices);
+    static void _build_tiled_navigation_mesh(Ref<NavigationMesh> p_nav_mesh, const Vector<float> &p_vertices, const Vector<int> &p_indices, int &r_tiles, int &r_built_tiles);
+
+    mutable Mutex last_bake_mutex;
+    int last_bake_tiles = 0;
+    int last_bake_built_tiles = 0;
+    uint64_t last_bake_usec = 0;
 
 public:
     static NavigationMeshGenerator *get_singleton();
@@ -79,6 +106,8 @@ public:
 
     void bake(Ref<NavigationMesh> p_nav_mesh, Node *p_node);
     void clear(Ref<NavigationMesh> p_nav_mesh);
+    // Tile count, tiles actually built and time taken by the last bake.
+    Dictionary get_last_bake_stats() const;
 };
 
 #endif
@@ -57,6 +57,7 @@ void register_navigation_types() {
 
 #ifndef _3D_DISABLED
     NavigationMeshGenerator::initialize_class();
+    NavigationMeshTileCache::initialize_class();
     _nav_mesh_generator = memnew(NavigationMeshGenerator);
     ClassDB::register_class<NavigationMeshGenerator>();
     Engine::get_singleton()->add_singleton(Engine::Singleton("NavigationMeshGenerator", NavigationMeshGenerator::get_singleton()));
@@ -53,27 +53,40 @@ void LightmapRaycasterEmbree::make_default_raycaster() {
 
 void LightmapRaycasterEmbree::filter_function(const struct RTCFilterFunctionNArguments *p_args) {
 
-    RTCHit *hit = (RTCHit *)p_args->hit;
-
-    unsigned int geomID = hit->geomID;
-    float u = hit->u;
-    float v = hit->v;
-
+    // Called with N > 1 for packets, every lane is handled through the RTCHitN accessors.
+    RTCHitN *hit = p_args->hit;
+    const unsigned int n = p_args->N;
     LightmapRaycasterEmbree *scene = (LightmapRaycasterEmbree *)p_args->geometryUserPtr;
-    RTCGeometry geom = rtcGetGeometry(scene->embree_scene, geomID);
 
-    rtcInterpolate0(geom, hit->primID, hit->u, hit->v, RTC_BUFFER_TYPE_VERTEX_ATTRIBUTE, 0, &hit->u, 2);
+    for (unsigned int i = 0; i < n; i++) {
+        if (p_args->valid[i] == 0) {
+            continue;
+        }
+
+        const unsigned int geomID = RTCHitN_geomID(hit, n, i);
+        const unsigned int primID = RTCHitN_primID(hit, n, i);
+        const float u = RTCHitN_u(hit, n, i);
+        const float v = RTCHitN_v(hit, n, i);
+        RTCGeometry geom = rtcGetGeometry(scene->embree_scene, geomID);
 
-    if (scene->alpha_textures.contains(geomID)) {
-        const AlphaTextureData &alpha_texture = scene->alpha_textures[geomID];
+        float uv[2];
+        rtcInterpolate0(geom, primID, u, v, RTC_BUFFER_TYPE_VERTEX_ATTRIBUTE, 0, uv, 2);
 
-        if (alpha_texture.sample(hit->u, hit->v) < 128) {
-            p_args->valid[0] = 0;
-            return;
+        auto alpha = scene->alpha_textures.find(geomID);
+        if (alpha != scene->alpha_textures.end() && alpha->second.sample(uv[0], uv[1]) < 128) {
+            p_args->valid[i] = 0;
+            continue;
         }
-    }
 
-    rtcInterpolate0(geom, hit->primID, u, v, RTC_BUFFER_TYPE_VERTEX_ATTRIBUTE, 1, &hit->Ng_x, 3);
+        float normal[3];
+        rtcInterpolate0(geom, primID, u, v, RTC_BUFFER_TYPE_VERTEX_ATTRIBUTE, 1, normal, 3);
+
+        RTCHitN_u(hit, n, i) = uv[0];
+        RTCHitN_v(hit, n, i) = uv[1];
+        RTCHitN_Ng_x(hit, n, i) = normal[0];
+        RTCHitN_Ng_y(hit, n, i) = normal[1];
+        RTCHitN_Ng_z(hit, n, i) = normal[2];
+    }
 }
 
 bool LightmapRaycasterEmbree::intersect(Ray &r_ray) {
@@ -85,9 +98,69 @@ bool LightmapRaycasterEmbree::intersect(Ray &r_ray) {
     return r_ray.geomID != RTC_INVALID_GEOMETRY_ID;
 }
 
+template <int N, class RayHitN>
+void LightmapRaycasterEmbree::_intersect_packet(Ray *r_rays, int p_count, void (*p_intersect)(const int *, RTCScene, RTCIntersectContext *, RayHitN *)) {
+    RTCIntersectContext context;
+    rtcInitIntersectContext(&context);
+
+    for (int base = 0; base < p_count; base += N) {
+        const int lanes = MIN(N, p_count - base);
+        alignas(32) int valid[N];
+        RayHitN packet;
+
+        for (int i = 0; i < N; i++) {
+            if (i >= lanes) {
+                valid[i] = 0;
+                continue;
+            }
+            const Ray &r = r_rays[base + i];
+            valid[i] = -1;
+            packet.ray.org_x[i] = r.org.x;
+            packet.ray.org_y[i] = r.org.y;
+            packet.ray.org_z[i] = r.org.z;
+            packet.ray.tnear[i] = r.tnear;
+            packet.ray.dir_x[i] = r.dir.x;
+            packet.ray.dir_y[i] = r.dir.y;
+            packet.ray.dir_z[i] = r.dir.z;
+            packet.ray.time[i] = r.time;
+            packet.ray.tfar[i] = r.tfar;
+            packet.ray.mask[i] = r.mask;
+            packet.ray.id[i] = base + i;
+            packet.ray.flags[i] = 0;
+            packet.hit.geomID[i] = RTC_INVALID_GEOMETRY_ID;
+            packet.hit.instID[0][i] = RTC_INVALID_GEOMETRY_ID;
+        }
+
+        p_intersect(valid, embree_scene, &context, &packet);
+
+        for (int i = 0; i < lanes; i++) {
+            Ray &r = r_rays[base + i];
+            r.geomID = packet.hit.geomID[i];
+            if (r.geomID == RTC_INVALID_GEOMETRY_ID) {
+                continue;
+            }
+            r.tfar = packet.ray.tfar[i];
+            r.normal = Vector3(packet.hit.Ng_x[i], packet.hit.Ng_y[i], packet.hit.Ng_z[i]);
+            r.u = packet.hit.u[i];
+            r.v = packet.hit.v[i];
+            r.primID = packet.hit.primID[i];
+            r.instID = packet.hit.instID[0][i];
+        }
+    }
+}
+
 void LightmapRaycasterEmbree::intersect(Vector<Ray> &r_rays) {
-    for (Ray &r : r_rays) {
-        intersect(r);
+    switch (packet_width) {
+        case 8:
+            _intersect_packet<8, RTCRayHit8>(r_rays.data(), r_rays.size(), rtcIntersect8);
+            break;
+        case 4:
+            _intersect_packet<4, RTCRayHit4>(r_rays.data(), r_rays.size(), rtcIntersect4);
+            break;
+        default:
+            for (Ray &r : r_rays) {
+                intersect(r);
+            }
     }
 }
 
@@ -198,6 +271,13 @@ LightmapRaycasterEmbree::LightmapRaycasterEmbree() {
     embree_device = rtcNewDevice(nullptr);
     rtcSetDeviceErrorFunction(embree_device, &embree_error_handler, nullptr);
     embree_scene = rtcNewScene(embree_device);
+
+    // Widest packet the Embree build traverses natively, wider packets would be split internally.
+    if (rtcGetDeviceProperty(embree_device, RTC_DEVICE_PROPERTY_NATIVE_RAY8_SUPPORTED)) {
+        packet_width = 8;
+    } else if (rtcGetDeviceProperty(embree_device, RTC_DEVICE_PROPERTY_NATIVE_RAY4_SUPPORTED)) {
+        packet_width = 4;
+    }
 }
 
 LightmapRaycasterEmbree::~LightmapRaycasterEmbree() {
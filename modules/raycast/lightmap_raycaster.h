@@ -49,8 +49,11 @@ private:
 
     RTCDevice embree_device;
     RTCScene embree_scene;
+    int packet_width = 1; // 4 or 8 when the device traverses ray packets natively
 
     static void filter_function(const struct RTCFilterFunctionNArguments *p_args);
+    template <int N, class RayHitN>
+    void _intersect_packet(Ray *r_rays, int p_count, void (*p_intersect)(const int *, RTCScene, RTCIntersectContext *, RayHitN *));
 
     Map<unsigned int, AlphaTextureData> alpha_textures;
     Set<int> filter_meshes;
@@ -58,6 +61,7 @@ private:
 public:
     bool intersect(Ray &p_ray) override;
 
+    // Traces in packets of 4 or 8 rays, keep neighbouring rays coherent for best results.
     void intersect(Vector<Ray> &r_rays) override;
 
     void add_mesh(const Vector<Vector3> &p_vertices, const Vector<Vector3> &p_normals, const Vector<Vector2> &p_uv2s, unsigned int p_id) override;
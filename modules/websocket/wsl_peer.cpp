@@ -235,6 +235,15 @@ void WSLPeer::poll() {
     }
 }
 
+bool WSLPeer::needs_poll() const {
+    if (!_data)
+        return false;
+    // SSL may hold decrypted records the socket no longer reports as readable, so it can't rely on readiness.
+    if (_data->closing || _data->conn != _data->tcp)
+        return true;
+    return wslay_event_want_write(_data->ctx) != 0;
+}
+
 Error WSLPeer::put_packet(const uint8_t *p_buffer, int p_buffer_size) {
 
     ERR_FAIL_COND_V(!is_connected_to_host(), FAILED);
@@ -94,6 +94,7 @@ public:
     int close_code;
     String close_reason;
     void poll(); // Used by client and server.
+    bool needs_poll() const; // Pending output, closing handshake or SSL buffering.
 
     int get_available_packet_count() const override;
     Error get_packet(const uint8_t **r_buffer, int &r_buffer_size) override;
@@ -172,15 +172,49 @@ Error WSLServer::listen(int p_port, const PoolVector<String> &p_protocols, bool
 
     _protocols.append_array(p_protocols);
 
-    return _server->listen(p_port, bind_ip);
+    Error err = _server->listen(p_port, bind_ip);
+    if (err != OK)
+        return err;
+    // The listening socket is registered with a null userdata, peer ids are never 0.
+    err = _mux->add(_server->get_socket(), IOMultiplexer::EVENT_IN, nullptr);
+    if (err != OK) {
+        _server->stop();
+        ERR_FAIL_V_MSG(err, "Can't watch the listening socket for connections.");
+    }
+    return OK;
+}
+
+void WSLServer::_remove_peer_socket(int p_id) {
+    auto iter = _peer_sockets.find(p_id);
+    if (iter == _peer_sockets.end())
+        return;
+    _mux->remove(iter->second);
+    _peer_sockets.erase(iter);
 }
 
 void WSLServer::poll() {
 
+    bool accept_ready = false;
+    _ready.clear();
+    _mux->wait(_ready, 0);
+    for (const IOMultiplexer::Ready &r : _ready) {
+        if (!r.userdata) {
+            accept_ready = true;
+            continue;
+        }
+        auto iter = _peer_map.find((int)(intptr_t)r.userdata);
+        if (iter != _peer_map.end())
+            static_cast<WSLPeer *>(iter->second.get())->poll();
+    }
+
+    // Idle peers cost no syscall here, only those with queued output or a closing handshake are polled blindly,
+    // along with the ones the multiplexer could not take.
     for (auto iter=_peer_map.begin(); iter!=_peer_map.end(); ) {
         Ref<WSLPeer> peer((WSLPeer *)iter->second.get());
-        peer->poll();
+        if (peer->needs_poll() || _peer_sockets.find(iter->first) == _peer_sockets.end())
+            peer->poll();
         if (!peer->is_connected_to_host()) {
+            _remove_peer_socket(iter->first);
             _on_disconnect(iter->first, peer->close_code != -1);
             iter=_peer_map.erase(iter);
         }
@@ -192,6 +226,7 @@ void WSLServer::poll() {
         Ref<PendingPeer> ppeer = *iter;
         Error err = ppeer->do_handshake(_protocols);
         if (err == ERR_BUSY) {
+            ++iter;
             continue;
         }
         if (err != OK) {
@@ -213,11 +248,14 @@ void WSLServer::poll() {
         ws_peer->set_no_delay(true);
 
         _peer_map[id] = ws_peer;
+        const Ref<NetSocket> &sock = ppeer->tcp->get_socket();
+        if (_mux->add(sock, IOMultiplexer::EVENT_IN, (void *)(intptr_t)id) == OK)
+            _peer_sockets[id] = sock;
         iter = _pending.erase(iter);
         _on_connect(id, ppeer->protocol);
     }
 
-    if (!_server->is_listening())
+    if (!_server->is_listening() || !accept_ready)
         return;
 
     while (_server->is_connection_available()) {
@@ -250,6 +288,12 @@ int WSLServer::get_max_packet_size() const {
 }
 
 void WSLServer::stop() {
+    if (_server->is_listening())
+        _mux->remove(_server->get_socket());
+    for (eastl::pair<const int, Ref<NetSocket> > &E : _peer_sockets) {
+        _mux->remove(E.second);
+    }
+    _peer_sockets.clear();
     _server->stop();
     for (eastl::pair<const int,Ref<WebSocketPeer> > &E : _peer_map) {
         Ref<WSLPeer> peer((WSLPeer *)E.second.get());
@@ -303,6 +347,7 @@ WSLServer::WSLServer() {
     _out_buf_size = nearest_shift(GLOBAL_GET(WSS_OUT_BUF).as<int>() - 1) + 10;
     _out_pkt_size = nearest_shift(GLOBAL_GET(WSS_OUT_PKT).as<int>() - 1);
     _server = make_ref_counted<TCP_Server>();
+    _mux = Ref<IOMultiplexer>(IOMultiplexer::create(), DoNotAddRef);
 }
 
 WSLServer::~WSLServer() {
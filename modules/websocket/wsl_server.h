@@ -35,6 +35,7 @@
 #include "websocket_server.h"
 #include "wsl_peer.h"
 
+#include "core/io/io_multiplexer.h"
 #include "core/io/stream_peer_ssl.h"
 #include "core/io/stream_peer_tcp.h"
 #include "core/io/tcp_server.h"
@@ -79,6 +80,13 @@ private:
     Ref<TCP_Server> _server;
     PoolVector<String> _protocols;
 
+    // Connected peers are only serviced when their socket is ready, or when they have something to flush.
+    Ref<IOMultiplexer> _mux;
+    Vector<IOMultiplexer::Ready> _ready;
+    HashMap<int, Ref<NetSocket> > _peer_sockets;
+
+    void _remove_peer_socket(int p_id);
+
 public:
     Error set_buffers(int p_in_buffer, int p_in_packets, int p_out_buffer, int p_out_packets) override;
     Error listen(int p_port, const PoolVector<String> &p_protocols = PoolVector<String>(), bool gd_mp_api = false) override;
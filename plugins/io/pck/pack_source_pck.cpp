@@ -3,6 +3,7 @@
 #include "core/print_string.h"
 #include "core/os/file_access.h"
 #include "core/string_formatter.h"
+#include "core/io/compression.h"
 #include "core/io/file_access_pack.h"
 #include "core/version.h"
 #include "core/os/os.h"
@@ -17,6 +18,18 @@ class FileAccessPack : public FileAccess {
     mutable bool eof;
 
     FileAccess *f;
+
+    // PACK_FILE_COMPRESSED: block_offsets has one entry per block plus the end of the last one,
+    // only the block under the read position is kept decompressed.
+    uint32_t block_size = 0;
+    Vector<uint64_t> block_offsets;
+    mutable Vector<uint8_t> block_data;
+    mutable Vector<uint8_t> comp_buffer;
+    mutable int current_block = -1;
+
+    bool _read_block_index();
+    bool _load_block(int p_block) const;
+    uint64_t _get_compressed_buffer(uint8_t *p_dst, uint64_t p_length) const;
     Error _open(StringView p_path, int p_mode_flags) override;
     uint64_t _get_modified_time(StringView p_file) override { return 0; }
     uint32_t _get_unix_permissions(StringView p_file) override { return 0; }
@@ -77,7 +90,9 @@ void FileAccessPack::seek(size_t p_position) {
         eof = false;
     }
 
-    f->seek(pf.offset + p_position);
+    // compressed blocks seek the underlying file when they are loaded
+    if (!(pf.flags & PACK_FILE_COMPRESSED))
+        f->seek(pf.offset + p_position);
     pos = p_position;
 }
 void FileAccessPack::seek_end(int64_t p_position) {
@@ -104,6 +119,12 @@ uint8_t FileAccessPack::get_8() const {
         return 0;
     }
 
+    if (pf.flags & PACK_FILE_COMPRESSED) {
+        uint8_t b = 0;
+        _get_compressed_buffer(&b, 1);
+        return b;
+    }
+
     pos++;
     return f->get_8();
 }
@@ -120,15 +141,79 @@ uint64_t FileAccessPack::get_buffer(uint8_t *p_dst, uint64_t p_length) const {
         to_read = int64_t(pf.size) - int64_t(pos);
     }
 
-    pos += p_length;
-
-    if (to_read <= 0)
+    if (to_read <= 0) {
+        pos += p_length;
         return 0;
+    }
+
+    if (pf.flags & PACK_FILE_COMPRESSED) {
+        uint64_t read = _get_compressed_buffer(p_dst, to_read);
+        pos += p_length - read;
+        return read;
+    }
+
+    pos += p_length;
     f->get_buffer(p_dst, to_read);
 
     return to_read;
 }
 
+bool FileAccessPack::_read_block_index() {
+
+    f->seek(pf.offset);
+    block_size = f->get_32();
+    uint32_t block_count = f->get_32();
+    ERR_FAIL_COND_V_MSG(block_size == 0 || uint64_t(block_count) * block_size < pf.size || uint64_t(block_count - 1) * block_size >= pf.size, false,
+            "Corrupted block index in pack-referenced file '" + pf.pack + "'.");
+
+    block_offsets.resize(block_count + 1);
+    uint64_t ofs = pf.offset + 8 + uint64_t(block_count) * 4;
+    for (uint32_t i = 0; i < block_count; i++) {
+        block_offsets[i] = ofs;
+        ofs += f->get_32();
+    }
+    block_offsets[block_count] = ofs;
+    return true;
+}
+
+bool FileAccessPack::_load_block(int p_block) const {
+
+    if (p_block == current_block)
+        return true;
+
+    const uint32_t csize = block_offsets[p_block + 1] - block_offsets[p_block];
+    const uint32_t size = eastl::min<uint64_t>(block_size, pf.size - uint64_t(p_block) * block_size);
+    comp_buffer.resize(csize);
+    block_data.resize(size);
+
+    f->seek(block_offsets[p_block]);
+    ERR_FAIL_COND_V(f->get_buffer(comp_buffer.data(), csize) != csize, false);
+    int ret = Compression::decompress(block_data.data(), size, comp_buffer.data(), csize, Compression::MODE_ZSTD);
+    ERR_FAIL_COND_V_MSG(ret != int(size), false, "Corrupted compressed block in pack-referenced file '" + pf.pack + "'.");
+
+    current_block = p_block;
+    return true;
+}
+
+// Reads from the current position, which the caller has checked against the file size. Advances pos by what was read.
+uint64_t FileAccessPack::_get_compressed_buffer(uint8_t *p_dst, uint64_t p_length) const {
+
+    uint64_t done = 0;
+    while (done < p_length) {
+        const int block = pos / block_size;
+        if (!_load_block(block)) {
+            eof = true;
+            break;
+        }
+        const uint64_t in_block = pos - uint64_t(block) * block_size;
+        const uint64_t n = eastl::min<uint64_t>(p_length - done, block_data.size() - in_block);
+        memcpy(p_dst + done, block_data.data() + in_block, n);
+        done += n;
+        pos += n;
+    }
+    return done;
+}
+
 void FileAccessPack::set_endian_swap(bool p_swap) {
     FileAccess::set_endian_swap(p_swap);
     f->set_endian_swap(p_swap);
@@ -165,11 +250,19 @@ FileAccessPack::FileAccessPack(StringView p_path, const PackedDataFile &p_file)
         pf(p_file),
         f(FileAccess::open(pf.pack, FileAccess::READ)) {
 
+    pos = 0;
+    eof = false;
+
     ERR_FAIL_COND_MSG(!f, "Can't open pack-referenced file '" + pf.pack + "'.");
 
+    if (pf.flags & PACK_FILE_COMPRESSED) {
+        if (!_read_block_index()) {
+            // leave an empty file behind rather than one returning garbage
+            pf.flags &= ~PACK_FILE_COMPRESSED;
+            pf.size = 0;
+        }
+    }
     f->seek(pf.offset);
-    pos = 0;
-    eof = false;
 }
 
 FileAccessPack::~FileAccessPack() {
@@ -265,7 +358,7 @@ bool PackedSourcePCK::try_open_pack(StringView p_path, bool p_replace_files, Str
     uint32_t major,minor,patch;
     getCoreInterface()->fillVersion(major,minor,patch);
 
-    if (version != PACK_FORMAT_VERSION) {
+    if (version < PACK_FORMAT_VERSION_MIN || version > PACK_FORMAT_VERSION) {
         f->close();
         memdelete(f);
         ERR_FAIL_V_MSG(false, "Pack version unsupported: " + itos(version) + ".");
@@ -313,7 +406,8 @@ bool PackedSourcePCK::try_open_pack(StringView p_path, bool p_replace_files, Str
         uint64_t size = f->get_64();
         uint8_t md5[16];
         f->get_buffer(md5, 16);
-        PackedData::get_singleton()->add_path(p_path, path, ofs, size, md5, this, p_replace_files);
+        uint32_t flags = version >= 2 ? f->get_32() : 0;
+        PackedData::get_singleton()->add_path(p_path, path, ofs, size, md5, this, p_replace_files, flags);
     }
 
     f->close();
@@ -31,6 +31,7 @@
 #include "skeleton_3d.h"
 
 #include "core/message_queue.h"
+#include "core/os/thread_work_pool.h"
 
 #include "core/callable_method_pointer.h"
 #include "core/object_db.h"
@@ -38,6 +39,7 @@
 #include "core/project_settings.h"
 #include "core/node_path.h"
 #include "scene/3d/physics_body_3d.h"
+#include "scene/main/scene_tree.h"
 #include "scene/resources/surface_tool.h"
 #include "scene/resources/material.h"
 #include "servers/rendering_server.h"
@@ -216,6 +218,15 @@ void Skeleton::_update_process_order() {
         ERR_PRINT("Skeleton parenthood graph is cyclic");
     }
 
+    process_parent.resize(len);
+    for (int i = 0; i < len; i++) {
+        const int parent_idx = bonesptr[order[i]].parent;
+        process_parent[i] = parent_idx >= 0 ? bonesptr[parent_idx].sort_index : -1;
+    }
+    slot_pose_local.resize(len);
+    slot_pose_global.resize(len);
+    slot_pose_global_no_override.resize(len);
+
     process_order_dirty = false;
 }
 
@@ -225,158 +236,239 @@ void Skeleton::_notification(int p_what) {
 
         case NOTIFICATION_UPDATE_SKELETON: {
 
-            RenderingServer *vs = RenderingServer::get_singleton();
-            Bone *bonesptr = bones.data();
-            int len = bones.size();
+            _prepare_pose_update();
+            _compute_pose();
+            _finish_pose_update();
+        } break;
+    }
+}
 
+// Everything that may print, allocate on the rendering server or look at other objects, on the main thread.
+void Skeleton::_prepare_pose_update() {
 
-            _update_process_order();
+    _update_process_order();
 
-            const int *order = process_order.data();
+    const Bone *bonesptr = bones.data();
+    const int len = bones.size();
 
+    for (SkinReference *E : skin_bindings) {
+        const Skin *skin = E->skin.get();
+        RenderingEntity skeleton = E->skeleton;
+        uint32_t bind_count = skin->get_bind_count();
+
+        if (E->bind_count != bind_count) {
+            RenderingServer::get_singleton()->skeleton_allocate(skeleton, bind_count);
+            E->bind_count = bind_count;
+            E->skin_bone_indices.resize(bind_count);
+            E->skin_bone_indices_ptrs = E->skin_bone_indices.data();
+            E->skin_transforms.resize(bind_count);
+        }
 
-            for (int i = 0; i < len; i++) {
+        if (E->skeleton_version != version) {
 
-                Bone &b = bonesptr[order[i]];
+            for (uint32_t i = 0; i < bind_count; i++) {
+                StringName bind_name = skin->get_bind_name(i);
 
-                if (b.disable_rest) {
-                    if (b.enabled) {
+                if (bind_name != StringName()) {
+                    //bind name used, use this
+                    bool found = false;
+                    for (int j = 0; j < len; j++) {
+                        if (bonesptr[j].name == bind_name) {
+                            E->skin_bone_indices_ptrs[i] = j;
+                            found = true;
+                            break;
+                        }
+                    }
 
-                        Transform pose = b.pose;
+                    if (!found) {
+                        ERR_PRINT("Skin bind #" + itos(i) + " contains named bind '" + String(bind_name) + "' but Skeleton has no bone by that name.");
+                        E->skin_bone_indices_ptrs[i] = 0;
+                    }
+                } else if (skin->get_bind_bone(i) >= 0) {
+                    int bind_index = skin->get_bind_bone(i);
+                    if (bind_index >= len) {
+                        ERR_PRINT("Skin bind #" + itos(i) + " contains bone index bind: " + itos(bind_index) + " , which is greater than the skeleton bone count: " + itos(len) + ".");
+                        E->skin_bone_indices_ptrs[i] = 0;
+                    } else {
+                        E->skin_bone_indices_ptrs[i] = bind_index;
+                    }
+                } else {
+                    ERR_PRINT("Skin bind #" + itos(i) + " does not contain a name nor a bone index.");
+                    E->skin_bone_indices_ptrs[i] = 0;
+                }
+            }
 
-                            if (b.custom_pose_enable) {
-                                pose = b.custom_pose * pose;
-                            }
-                        if (b.parent >= 0) {
+            E->skeleton_version = version;
+        }
+    }
+}
 
-                            b.pose_global = bonesptr[b.parent].pose_global * pose;
-                            b.pose_global_no_override = bonesptr[b.parent].pose_global_no_override * pose;
-                        } else {
+// Pose and skinning math only, touches nothing but this skeleton and its skin bindings so several skeletons can
+// run it at once.
+void Skeleton::_compute_pose() {
 
-                            b.pose_global = pose;
-                            b.pose_global_no_override = pose;
-                        }
-                    } else {
+    Bone *bonesptr = bones.data();
+    const int len = bones.size();
+    const int *order = process_order.data();
+    const int *parent = process_parent.data();
+    Transform *local = slot_pose_local.data();
+    Transform *global = slot_pose_global.data();
+    Transform *global_no_override = slot_pose_global_no_override.data();
+
+    // Local poses do not depend on each other.
+    for (int i = 0; i < len; i++) {
 
-                        if (b.parent >= 0) {
+        const Bone &b = bonesptr[order[i]];
+        if (b.enabled) {
+            const Transform pose = b.custom_pose_enable ? b.custom_pose * b.pose : b.pose;
+            local[i] = b.disable_rest ? pose : b.rest * pose;
+        } else {
+            local[i] = b.disable_rest ? Transform() : b.rest;
+        }
+    }
 
-                            b.pose_global = bonesptr[b.parent].pose_global;
-                            b.pose_global_no_override = bonesptr[b.parent].pose_global_no_override;
-                        } else {
+    // Parents come before their children in process order.
+    for (int i = 0; i < len; i++) {
 
-                            b.pose_global = Transform();
-                            b.pose_global_no_override = Transform();
-                        }
-                    }
+        const int p = parent[i];
+        if (p >= 0) {
+            global[i] = global[p] * local[i];
+            global_no_override[i] = global_no_override[p] * local[i];
+        } else {
+            global[i] = local[i];
+            global_no_override[i] = local[i];
+        }
 
-                } else {
-                    if (b.enabled) {
+        Bone &b = bonesptr[order[i]];
+        if (b.global_pose_override_amount >= CMP_EPSILON) {
+            global[i] = global[i].interpolate_with(b.global_pose_override, b.global_pose_override_amount);
+        }
+        if (b.global_pose_override_reset) {
+            b.global_pose_override_amount = 0.0;
+        }
+        b.pose_global = global[i];
+        b.pose_global_no_override = global_no_override[i];
+    }
 
-                        Transform pose = b.pose;
+    for (SkinReference *E : skin_bindings) {
+        const Skin *skin = E->skin.get();
+        Transform *skin_transforms = E->skin_transforms.data();
+        for (uint32_t i = 0; i < E->bind_count; i++) {
+            uint32_t bone_index = E->skin_bone_indices_ptrs[i];
+            ERR_CONTINUE(bone_index >= (uint32_t)len);
+            skin_transforms[i] = bonesptr[bone_index].pose_global * skin->get_bind_pose(i);
+        }
+    }
 
-                            if (b.custom_pose_enable) {
-                                pose = b.custom_pose * pose;
-                            }
-                        if (b.parent >= 0) {
+    // A pose change from here on, even one made while the result is being applied, needs another update.
+    dirty = false;
+    pose_unfinished = true;
+}
 
-                            b.pose_global = bonesptr[b.parent].pose_global * (b.rest * pose);
-                            b.pose_global_no_override = bonesptr[b.parent].pose_global_no_override * (b.rest * pose);
-                        } else {
+void Skeleton::_finish_pose_update() {
 
-                            b.pose_global = b.rest * pose;
-                            b.pose_global_no_override = b.rest * pose;
-                        }
-                    } else {
+    RenderingServer *vs = RenderingServer::get_singleton();
+    const Bone *bonesptr = bones.data();
+    const int *order = process_order.data();
 
-                        if (b.parent >= 0) {
+    for (int i = 0; i < bones.size(); i++) {
 
-                            b.pose_global = bonesptr[b.parent].pose_global * b.rest;
-                            b.pose_global_no_override = bonesptr[b.parent].pose_global_no_override * b.rest;
-                        } else {
+        const Bone &b = bonesptr[order[i]];
+        for (GameEntity E : b.nodes_bound) {
 
-                            b.pose_global = b.rest;
-                            b.pose_global_no_override = b.rest;
-                        }
-                    }
-                }
+            Object *obj = object_for_entity(E);
+            ERR_CONTINUE(!obj);
+            Node3D *sp = object_cast<Node3D>(obj);
+            ERR_CONTINUE(!sp);
+            sp->set_transform(b.pose_global);
+        }
+    }
 
-                    if (b.global_pose_override_amount >= CMP_EPSILON) {
-                        b.pose_global = b.pose_global.interpolate_with(b.global_pose_override, b.global_pose_override_amount);
-                    }
+    //update skins
+    for (SkinReference *E : skin_bindings) {
+        vs->skeleton_set_bone_transforms(E->skeleton, E->skin_transforms);
+    }
 
-                if (b.global_pose_override_reset) {
-                    b.global_pose_override_amount = 0.0;
-                }
+    pose_unfinished = false;
+    emit_signal("skeleton_updated");
+}
 
-                for (GameEntity E : b.nodes_bound) {
+// Skeletons made dirty during a frame are updated together by a single deferred flush.
+static Vector<Skeleton *> dirty_skeletons;
+static bool pose_flush_queued = false;
+static ThreadWorkPool *pose_pool = nullptr;
 
-                    Object *obj = object_for_entity(E);
-                    ERR_CONTINUE(!obj);
-                    Node3D *sp = object_cast<Node3D>(obj);
-                    ERR_CONTINUE(!sp);
-                    sp->set_transform(b.pose_global);
-                }
-            }
+// Below this many bones in a batch the threads cost more than they save.
+static const int PARALLEL_POSE_MIN_BONES = 512;
 
-            //update skins
-            for (SkinReference *E : skin_bindings) {
-                const Skin *skin = E->skin.get();
-                RenderingEntity skeleton = E->skeleton;
-                uint32_t bind_count = skin->get_bind_count();
-
-                if (E->bind_count != bind_count) {
-                    RenderingServer::get_singleton()->skeleton_allocate(skeleton, bind_count);
-                    E->bind_count = bind_count;
-                    E->skin_bone_indices.resize(bind_count);
-                    E->skin_bone_indices_ptrs = E->skin_bone_indices.data();
-                }
+struct SkeletonPoseBatch {
+    Skeleton *const *skeletons;
 
-                if (E->skeleton_version != version) {
-
-                    for (uint32_t i = 0; i < bind_count; i++) {
-                        StringName bind_name = skin->get_bind_name(i);
-
-                        if (bind_name != StringName()) {
-                            //bind name used, use this
-                            bool found = false;
-                            for (int j = 0; j < len; j++) {
-                                if (bonesptr[j].name == bind_name) {
-                                    E->skin_bone_indices_ptrs[i] = j;
-                                    found = true;
-                                    break;
-                                }
-                            }
-
-                            if (!found) {
-                                ERR_PRINT("Skin bind #" + itos(i) + " contains named bind '" + String(bind_name) + "' but Skeleton has no bone by that name.");
-                                E->skin_bone_indices_ptrs[i] = 0;
-                            }
-                        } else if (skin->get_bind_bone(i) >= 0) {
-                            int bind_index = skin->get_bind_bone(i);
-                            if (bind_index >= len) {
-                                ERR_PRINT("Skin bind #" + itos(i) + " contains bone index bind: " + itos(bind_index) + " , which is greater than the skeleton bone count: " + itos(len) + ".");
-                                E->skin_bone_indices_ptrs[i] = 0;
-                            } else {
-                                E->skin_bone_indices_ptrs[i] = bind_index;
-                            }
-                        } else {
-                            ERR_PRINT("Skin bind #" + itos(i) + " does not contain a name nor a bone index.");
-                            E->skin_bone_indices_ptrs[i] = 0;
-                        }
-                    }
+    void compute(uint32_t p_index, void *) {
+        skeletons[p_index]->_compute_pose();
+    }
+};
 
-                    E->skeleton_version = version;
-                }
-                for (uint32_t i = 0; i < bind_count; i++) {
-                    uint32_t bone_index = E->skin_bone_indices_ptrs[i];
-                    ERR_CONTINUE(bone_index >= (uint32_t)len);
-                    vs->skeleton_bone_set_transform(skeleton, i, bonesptr[bone_index].pose_global * skin->get_bind_pose(i));
-                }
+void Skeleton::flush_pose_updates() {
 
-            }
-            dirty = false;
-            emit_signal("skeleton_updated");
-        } break;
+    pose_flush_queued = false;
+
+    Vector<Skeleton *> batch;
+    batch.swap(dirty_skeletons);
+
+    Vector<GameEntity> ids;
+    ids.reserve(batch.size());
+    int bone_count = 0;
+    int count = 0;
+    for (Skeleton *skeleton : batch) {
+        skeleton->update_queued = false;
+        if (!skeleton->dirty) {
+            continue; // already updated on demand
+        }
+        batch[count++] = skeleton;
+        ids.push_back(skeleton->get_instance_id());
+        bone_count += skeleton->bones.size();
+    }
+    batch.resize(count);
+
+    for (Skeleton *skeleton : batch) {
+        skeleton->_prepare_pose_update();
+    }
+
+    if (count > 1 && bone_count >= PARALLEL_POSE_MIN_BONES) {
+        if (!pose_pool) {
+            pose_pool = memnew(ThreadWorkPool);
+            pose_pool->init();
+        }
+        SkeletonPoseBatch work { batch.data() };
+        pose_pool->do_work(count, &work, &SkeletonPoseBatch::compute, nullptr);
+    } else {
+        for (Skeleton *skeleton : batch) {
+            skeleton->_compute_pose();
+        }
+    }
+
+    // Bound nodes and skeleton_updated listeners may free other skeletons of the batch, update them on demand, or
+    // pose them again. Those posed again are queued for the next flush and skip the outdated result.
+    for (GameEntity id : ids) {
+        Skeleton *skeleton = object_cast<Skeleton>(object_for_entity(id));
+        if (skeleton && skeleton->pose_unfinished && !skeleton->dirty) {
+            skeleton->_finish_pose_update();
+        }
+    }
+}
+
+void Skeleton::finish_pose_updates() {
+
+    for (Skeleton *skeleton : dirty_skeletons) {
+        skeleton->update_queued = false;
+    }
+    dirty_skeletons.clear();
+    pose_flush_queued = false;
+    if (pose_pool) {
+        pose_pool->finish();
+        memdelete(pose_pool);
+        pose_pool = nullptr;
     }
 }
 
@@ -640,9 +732,21 @@ void Skeleton::_make_dirty() {
     if (dirty) {
         return;
     }
-
-    call_deferred([this] { notification(NOTIFICATION_UPDATE_SKELETON);   });
     dirty = true;
+
+    if (!is_inside_tree()) {
+        call_deferred([this] { notification(NOTIFICATION_UPDATE_SKELETON);   });
+        return;
+    }
+
+    if (!update_queued) {
+        dirty_skeletons.push_back(this);
+        update_queued = true;
+    }
+    if (!pose_flush_queued) {
+        pose_flush_queued = true;
+        MessageQueue::get_singleton()->push_call(get_tree()->get_instance_id(), [] { Skeleton::flush_pose_updates(); });
+    }
 }
 
 int Skeleton::get_process_order(int p_idx) {
@@ -938,6 +1042,9 @@ Skeleton::Skeleton() {
 }
 
 Skeleton::~Skeleton() {
+    if (update_queued) {
+        dirty_skeletons.erase_first(this);
+    }
     //some skins may remain bound
     for (SkinReference *E : skin_bindings) {
         E->skeleton_node = nullptr;
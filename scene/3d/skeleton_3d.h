@@ -48,6 +48,7 @@ class GODOT_EXPORT SkinReference : public RefCounted {
     friend class Skeleton;
 
     Vector<uint32_t> skin_bone_indices;
+    Vector<Transform> skin_transforms; // bone poses times bind poses, uploaded in one go
     Skeleton *skeleton_node = nullptr;
     RenderingEntity skeleton;
     Ref<Skin> skin;
@@ -70,6 +71,7 @@ class GODOT_EXPORT Skeleton : public Node3D {
     GDCLASS(Skeleton,Node3D)
 private:
     friend class SkinReference;
+    friend struct SkeletonPoseBatch;
     struct Bone {
 
         String name;
@@ -117,13 +119,23 @@ private:
     HashSet<SkinReference *> skin_bindings;
     Vector<Bone> bones;
     Vector<int> process_order;
+    // Pose evaluation works on dense arrays indexed by process order slot instead of on the bones.
+    Vector<int> process_parent; // slot of each slot's parent, -1 for roots
+    Vector<Transform> slot_pose_local;
+    Vector<Transform> slot_pose_global;
+    Vector<Transform> slot_pose_global_no_override;
     bool process_order_dirty;
     bool dirty;
+    bool update_queued = false; // waiting in the batch of dirty skeletons
+    bool pose_unfinished = false; // computed, not yet applied to bound nodes and skins
 
     uint64_t version;
 
     void _skin_changed();
     void _make_dirty();
+    void _prepare_pose_update();
+    void _compute_pose();
+    void _finish_pose_update();
 public:
     // bind helpers
     Array _get_bound_child_nodes_to_bone(int p_bone) const {
@@ -200,6 +212,10 @@ public:
     void localize_rests(); // used for loaders and tools
     int get_process_order(int p_idx);
 
+    // Updates every skeleton dirtied since the last flush, evaluating their poses in parallel.
+    static void flush_pose_updates();
+    static void finish_pose_updates();
+
     Ref<SkinReference> register_skin(const Ref<Skin> &p_skin);
 
 #ifndef _3D_DISABLED
@@ -92,12 +92,14 @@ struct Line {
     int height_cache;
     int height_accum_cache;
     int char_count;
+    int char_accum_cache;
     int minimum_width;
     int maximum_width;
 
     Line() {
         from = nullptr;
         char_count = 0;
+        char_accum_cache = 0;
     }
 };
 }
@@ -129,6 +131,26 @@ struct ItemStrikethrough : public RichTextItem {
 
     ItemStrikethrough() { type = RichTextLabel::ITEM_STRIKETHROUGH; }
 };
+
+// Rebuilds the running height and character sums of lines [p_from, p_to), assuming the lines before p_from are valid.
+void _accumulate_line_caches(RichTextItemFrame *p_frame, int p_from, int p_to) {
+    int height = p_from > 0 ? p_frame->lines[p_from - 1].height_accum_cache : 0;
+    int chars = p_from > 0 ? p_frame->lines[p_from - 1].char_accum_cache : 0;
+    for (int i = p_from; i < p_to; i++) {
+        Line &l = p_frame->lines[i];
+        height += l.height_cache;
+        chars += l.char_count;
+        l.height_accum_cache = height;
+        l.char_accum_cache = chars;
+    }
+}
+
+// Binary search over the height prefix sums: first line whose bottom edge reaches p_ofs.
+int _find_line_at_offset(const RichTextItemFrame *p_frame, int p_ofs) {
+    auto iter = eastl::lower_bound(p_frame->lines.begin(), p_frame->lines.end(), p_ofs,
+            [](const Line &l, int ofs) { return l.height_accum_cache < ofs; });
+    return int(iter - p_frame->lines.begin());
+}
 } // end of anonymous namespace block
 
 struct RichTextItemMeta : public RichTextItem {
@@ -1321,7 +1343,11 @@ void RichTextLabel::_notification(int p_what) {
             }
         } break;
         case NOTIFICATION_RESIZED: {
-            main->first_invalid_line = 0; //invalidate ALL
+            if (_get_layout_width() != layout_width) {
+                main->first_invalid_line = 0; //invalidate ALL
+            } else {
+                _update_scroll_range(); //line breaks are unchanged, only the page size moved
+            }
             update();
 
         } break;
@@ -1355,21 +1381,11 @@ void RichTextLabel::_notification(int p_what) {
 
             int ofs = vscroll->get_value();
 
-            //todo, change to binary search
-
-            int from_line = 0;
-            int total_chars = 0;
-            while (from_line < main->lines.size()) {
-                if (main->lines[from_line].height_accum_cache + _get_text_rect().get_position().y >= ofs) {
-                    break;
-                }
-                total_chars += main->lines[from_line].char_count;
-                from_line++;
-            }
-
+            int from_line = _find_line_at_offset(main, ofs - text_rect.get_position().y);
             if (from_line >= main->lines.size()) {
                 break; //nothing to draw
             }
+            int total_chars = main->lines[from_line].char_accum_cache - main->lines[from_line].char_count;
             int y = (main->lines[from_line].height_accum_cache - main->lines[from_line].height_cache) - ofs;
             Ref<Font> base_font = get_theme_font("normal_font");
             Color base_color = get_theme_color("default_color");
@@ -1415,16 +1431,7 @@ void RichTextLabel::_find_click(RichTextItemFrame *p_frame, const Point2i &p_cli
     bool use_outline = get_theme_constant("shadow_as_outline");
     Point2 shadow_ofs(get_theme_constant("shadow_offset_x"), get_theme_constant("shadow_offset_y"));
 
-    //todo, change to binary search
-    int from_line = 0;
-
-    while (from_line < p_frame->lines.size()) {
-        if (p_frame->lines[from_line].height_accum_cache >= ofs) {
-            break;
-        }
-        from_line++;
-    }
-
+    int from_line = _find_line_at_offset(p_frame, ofs);
     if (from_line >= p_frame->lines.size()) {
         return;
     }
@@ -1898,16 +1905,37 @@ bool RichTextLabel::_find_layout_subitem(RichTextItem *from, RichTextItem *to) {
     return false;
 }
 
+int RichTextLabel::_get_layout_width() {
+    return _get_text_rect().get_size().width - scroll_w;
+}
+
+void RichTextLabel::_update_scroll_range() {
+    int total_height = 0;
+    if (!main->lines.empty()) {
+        total_height = main->lines[main->lines.size() - 1].height_accum_cache + get_theme_stylebox("normal")->get_minimum_size().height;
+    }
+
+    updating_scroll = true;
+    vscroll->set_max(total_height);
+    vscroll->set_page(get_size().height);
+    if (scroll_follow && scroll_following) {
+        vscroll->set_value(total_height - get_size().height);
+    }
+
+    updating_scroll = false;
+}
+
 void RichTextLabel::_validate_line_caches(RichTextItemFrame *p_frame) {
+    if (p_frame == main && _get_layout_width() != layout_width) {
+        layout_width = _get_layout_width();
+        p_frame->first_invalid_line = 0; //line breaks depend on the width
+    }
+
     if (p_frame->first_invalid_line == p_frame->lines.size()) {
         return;
     }
 
-    //validate invalid lines
-    Size2 size = get_size();
-    if (fixed_width != -1) {
-        size.width = fixed_width;
-    }
+    //validate invalid lines, lines above first_invalid_line keep their layout
     Rect2 text_rect = _get_text_rect();
     Color font_color_shadow = get_theme_color("font_color_shadow");
     bool use_outline = get_theme_constant("shadow_as_outline");
@@ -1920,28 +1948,12 @@ void RichTextLabel::_validate_line_caches(RichTextItemFrame *p_frame) {
         int y = 0;
         _process_line(p_frame, text_rect.get_position(), y, text_rect.get_size().width - scroll_w, i, PROCESS_CACHE, base_font, Color(), font_color_shadow, use_outline, shadow_ofs);
         p_frame->lines[i].height_cache = y;
-        p_frame->lines[i].height_accum_cache = y;
-
-        if (i > 0) {
-            p_frame->lines[i].height_accum_cache += p_frame->lines[i - 1].height_accum_cache;
-        }
     }
+    _accumulate_line_caches(p_frame, p_frame->first_invalid_line, p_frame->lines.size());
 
-    int total_height = 0;
-    if (!p_frame->lines.empty()) {
-        total_height = p_frame->lines[p_frame->lines.size() - 1].height_accum_cache + get_theme_stylebox("normal")->get_minimum_size().height;
-    }
+    p_frame->first_invalid_line = p_frame->lines.size();
 
-    main->first_invalid_line = p_frame->lines.size();
-
-    updating_scroll = true;
-    vscroll->set_max(total_height);
-    vscroll->set_page(size.height);
-    if (scroll_follow && scroll_following) {
-        vscroll->set_value(total_height - size.height);
-    }
-
-    updating_scroll = false;
+    _update_scroll_range();
 
     if (fit_content_height) {
         minimum_size_changed();
@@ -2047,12 +2059,9 @@ void RichTextLabel::_remove_item(RichTextItem *p_item, const int p_line, const i
         parent_subs.erase(eastl::find(parent_subs.begin(),parent_subs.end(),p_item));
         if (p_item->type == ITEM_NEWLINE) {
             current_frame->lines.erase_at(p_line);
-            List<RichTextItem *>::iterator iter=current->subitems.begin();
-            eastl::advance(iter,p_subitem_line);
-            for (int i = 0; i < current->subitems.size(); i++) {
-                if ((*iter)->line > p_subitem_line)
-                    (*iter)->line--;
-                ++iter;
+            for (RichTextItem *E : current->subitems) {
+                if (E->line > p_subitem_line)
+                    E->line--;
             }
         }
     } else {
@@ -2149,7 +2158,13 @@ bool RichTextLabel::remove_line(const int p_line) {
         main->lines[0].from = main;
     }
 
-    main->first_invalid_line = 0;
+    // The remaining lines keep their layout, only the running sums past the removed line need rebuilding.
+    if (current_frame == main && main->first_invalid_line > p_line && main->lines[0].from) {
+        main->first_invalid_line = MIN(main->first_invalid_line - 1, main->lines.size());
+        _accumulate_line_caches(main, p_line, main->first_invalid_line);
+    } else {
+        main->first_invalid_line = MIN(main->first_invalid_line, p_line);
+    }
     update();
 
     return true;
@@ -3318,6 +3333,10 @@ int RichTextLabel::get_visible_characters() const {
 }
 int RichTextLabel::get_total_character_count() const {
 
+    if (current_frame == main && main->first_invalid_line == main->lines.size()) {
+        return main->lines[main->lines.size() - 1].char_accum_cache;
+    }
+
     int tc = 0;
     for (int i = 0; i < current_frame->lines.size(); i++) {
         tc += current_frame->lines[i].char_count;
@@ -3416,6 +3435,7 @@ RichTextLabel::RichTextLabel() {
     main->lines[0].from = main;
     main->first_invalid_line = 0;
     current_frame = main;
+    layout_width = -1;
     tab_size = 4;
     default_align = ALIGN_LEFT;
     underline_meta = true;
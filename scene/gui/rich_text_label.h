@@ -106,6 +106,7 @@ private:
     bool scroll_following;
     bool scroll_active;
     int scroll_w;
+    int layout_width; // width the main frame lines were last broken at
     bool scroll_updated;
     bool updating_scroll;
     int current_idx;
@@ -124,6 +125,8 @@ private:
 
     void _invalidate_current_line(RichTextItemFrame *p_frame);
     void _validate_line_caches(RichTextItemFrame *p_frame);
+    int _get_layout_width();
+    void _update_scroll_range();
 
     void _add_item(RichTextItem *p_item, bool p_enter = false, bool p_ensure_newline = false);
     void _remove_item(RichTextItem *p_item, const int p_line, const int p_subitem_line);
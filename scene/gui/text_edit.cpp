@@ -128,6 +128,17 @@ static int _find_first_non_whitespace_column_of_line(const UIString &line) {
         left++;
     return left;
 }
+
+// Moves r_idx past all spans starting at or before p_column, returns true when r_color was changed.
+static bool _advance_highlight(const Vector<TextEdit::HighlightSpan> &p_spans, int &r_idx, int p_column, Color &r_color) {
+    bool changed = false;
+    while (r_idx < p_spans.size() && p_spans[r_idx].column <= p_column) {
+        r_color = p_spans[r_idx].color;
+        r_idx++;
+        changed = true;
+    }
+    return changed;
+}
 struct TextColorRegion {
 
     Color color;
@@ -154,8 +165,12 @@ public:
         bool hidden : 1;
         bool safe : 1;
         bool has_info : 1;
+        bool highlight_valid : 1;
         int wrap_amount_cache : 24;
-        Map<int, TextColorRegionInfo> region_info;
+        // Color region open at the start of the line, kept up to date for lines below region_valid_lines.
+        int region_in = -1;
+        Vector<TextColorRegionInfo> region_info;
+        Vector<TextEdit::HighlightSpan> highlight;
         Ref<Texture> info_icon;
         StringName info;
         UIString data;
@@ -168,6 +183,7 @@ public:
             hidden = false;
             safe = false;
             has_info = false;
+            highlight_valid = false;
             wrap_amount_cache = 0;
         }
     };
@@ -177,8 +193,11 @@ private:
     mutable Vector<Line> text;
     Ref<Font> font;
     int indent_size;
+    // Lines [0, region_valid_lines) have an up to date region_in, edits lower it to the first affected line.
+    mutable int region_valid_lines = 0;
 
     void _update_line_cache(uint32_t p_line) const;
+    int _get_region_out(int p_line) const;
 
 public:
     void set_indent_size(int p_indent_size);
@@ -189,7 +208,13 @@ public:
     int get_char_width(CharType c, CharType next_c, int px) const;
     void set_line_wrap_amount(int p_line, int p_wrap_amount) const;
     int get_line_wrap_amount(int p_line) const;
-    const Map<int, TextColorRegionInfo> &get_color_region_info(int p_line) const;
+    const Vector<TextColorRegionInfo> &get_color_region_info(int p_line) const;
+    const TextColorRegionInfo *get_color_region_at(int p_line, int p_column) const;
+    int get_region_in(int p_line) const;
+    bool is_highlight_valid(uint32_t p_line) const { return text[p_line].highlight_valid; }
+    void set_highlight_valid(uint32_t p_line) { text[p_line].highlight_valid = true; }
+    Vector<TextEdit::HighlightSpan> &get_highlight(uint32_t p_line) const { return text[p_line].highlight; }
+    void clear_highlight_cache(bool p_regions_changed);
     void set(int p_line, const UIString &p_text);
     void set_marked(uint32_t p_line, bool p_marked) { text[p_line].marked = p_marked; }
     bool is_marked(uint32_t p_line) const { return text[p_line].marked; }
@@ -354,14 +379,12 @@ struct PrivateData {
     TextEdit *m_owner;
     Timer *click_select_held;
 
-    Map<int, int> color_region_cache;
     //syntax coloring
     SyntaxHighlighter *syntax_highlighter;
     Vector<TextColorRegion> color_regions;
 
     eastl::unordered_map<UIString, Color> keywords;
     eastl::unordered_map<UIString, Color> member_keywords;
-    Map<int, Map<int, TextEdit::HighlighterInfo> > syntax_highlighting_cache;
 
     TextOperation current_op;
 
@@ -420,7 +443,8 @@ struct PrivateData {
         cursor.last_fit_x = 0;
         selection.active = false;
     }
-    Map<int, TextEdit::HighlighterInfo> _get_line_syntax_highlighting(TextEdit *te,int p_line);
+    const Vector<TextEdit::HighlightSpan> &_get_line_syntax_highlighting(int p_line);
+    void _highlight_line(int p_line, int p_in_region, Vector<TextEdit::HighlightSpan> &r_spans);
     void _update_caches(TextEdit *te) {
 
         cache.style_normal = te->get_theme_stylebox("normal");
@@ -487,66 +511,10 @@ struct PrivateData {
 
         return totalsize; // Omit last \n.
     }
-    void _line_edited_from(int p_line) {
-        size_t cache_size = color_region_cache.size();
-        for (int i = p_line; i < cache_size; i++) {
-            color_region_cache.erase(i);
-        }
-
-        if (!syntax_highlighting_cache.empty()) {
-            cache_size = syntax_highlighting_cache.rbegin()->first;
-            for (int i = p_line - 1; i <= cache_size; i++) {
-                if (syntax_highlighting_cache.contains(i)) {
-                    syntax_highlighting_cache.erase(i);
-                }
-            }
-        }
-    }
-    int _is_line_in_region(int p_line){
-        // Do we have in cache?
-        if (color_region_cache.contains(p_line)) {
-            return color_region_cache[p_line];
-        }
-
-        // If not find the closest line we have.
-        int previous_line = p_line - 1;
-        for (; previous_line > -1; previous_line--) {
-            if (color_region_cache.contains(p_line)) {
-                break;
-            }
-        }
-
-        // Calculate up to line we need and update the cache along the way.
-        int in_region = color_region_cache[previous_line];
-        if (previous_line == -1) {
-            in_region = -1;
-        }
-        for (int i = previous_line; i < p_line; i++) {
-            const Map<int, TextColorRegionInfo> &cri_map = _get_line_color_region_info(i);
-            for (const eastl::pair<const int,TextColorRegionInfo> &E : cri_map) {
-                const TextColorRegionInfo &cri = E.second;
-                if (in_region == -1) {
-                    if (!cri.end) {
-                        in_region = cri.region;
-                    }
-                } else if (in_region == cri.region && !_get_color_region(cri.region).line_only) {
-                    if (cri.end || _get_color_region(cri.region).eq) {
-                        in_region = -1;
-                    }
-                }
-            }
-
-            if (in_region >= 0 && _get_color_region(in_region).line_only) {
-                in_region = -1;
-            }
-
-            color_region_cache[i + 1] = in_region;
-        }
-        return in_region;
-    }
-    Map<int, TextColorRegionInfo> _get_line_color_region_info(int p_line) const {
+    const Vector<TextColorRegionInfo> &_get_line_color_region_info(int p_line) const {
+        static const Vector<TextColorRegionInfo> empty;
         if (p_line < 0 || p_line > text.size() - 1) {
-            return Map<int, TextColorRegionInfo>();
+            return empty;
         }
         return text.get_color_region_info(p_line);
     }
@@ -554,8 +522,7 @@ struct PrivateData {
         keywords.clear();
         member_keywords.clear();
         color_regions.clear();
-        color_region_cache.clear();
-        syntax_highlighting_cache.clear();
+        text.clear_highlight_cache(true);
         text.clear_width_cache();
 
     }
@@ -828,7 +795,6 @@ struct PrivateData {
             }
             text_changed_dirty = true;
         }
-        _line_edited_from(p_line);
     }
 
     UIString _base_get_text(int p_from_line, int p_from_column, int p_to_line, int p_to_column) const {
@@ -891,7 +857,6 @@ struct PrivateData {
             }
             text_changed_dirty = true;
         }
-        _line_edited_from(p_from_line);
     }
     void _insert_text(
             int p_line, int p_char, const UIString &p_text, int *r_end_line = nullptr, int *r_end_char = nullptr) {
@@ -1739,9 +1704,10 @@ void Text::_update_line_cache(uint32_t p_line) const {
                 if (match) {
 
                     TextColorRegionInfo cri;
+                    cri.column = i;
                     cri.end = false;
                     cri.region = j;
-                    text[p_line].region_info[i] = cri;
+                    text[p_line].region_info.push_back(cri);
                     i += lr - 1;
 
                     break;
@@ -1766,9 +1732,10 @@ void Text::_update_line_cache(uint32_t p_line) const {
                 if (match) {
 
                     TextColorRegionInfo cri;
+                    cri.column = i;
                     cri.end = true;
                     cri.region = j;
-                    text[p_line].region_info[i] = cri;
+                    text[p_line].region_info.push_back(cri);
                     i += lr - 1;
 
                     break;
@@ -1778,9 +1745,9 @@ void Text::_update_line_cache(uint32_t p_line) const {
     }
 }
 
-const Map<int, TextColorRegionInfo> &Text::get_color_region_info(int p_line) const {
+const Vector<TextColorRegionInfo> &Text::get_color_region_info(int p_line) const {
 
-    static Map<int, TextColorRegionInfo> cri;
+    static Vector<TextColorRegionInfo> cri;
     ERR_FAIL_INDEX_V(p_line, text.size(), cri);
 
     if (text[p_line].width_cache == -1) {
@@ -1790,6 +1757,75 @@ const Map<int, TextColorRegionInfo> &Text::get_color_region_info(int p_line) con
     return text[p_line].region_info;
 }
 
+const TextColorRegionInfo *Text::get_color_region_at(int p_line, int p_column) const {
+
+    const Vector<TextColorRegionInfo> &cri_list = get_color_region_info(p_line);
+    auto iter = eastl::lower_bound(cri_list.begin(), cri_list.end(), p_column,
+            [](const TextColorRegionInfo &cri, int p_col) { return cri.column < p_col; });
+    if (iter == cri_list.end() || iter->column != p_column) {
+        return nullptr;
+    }
+    return iter;
+}
+
+int Text::_get_region_out(int p_line) const {
+
+    int in_region = text[p_line].region_in;
+    for (const TextColorRegionInfo &cri : get_color_region_info(p_line)) {
+        const TextColorRegion &cr = (*color_regions)[cri.region];
+        if (in_region == -1) {
+            if (!cri.end) {
+                in_region = cri.region;
+            }
+        } else if (in_region == cri.region && !cr.line_only) {
+            if (cri.end || cr.eq) {
+                in_region = -1;
+            }
+        }
+    }
+
+    if (in_region >= 0 && (*color_regions)[in_region].line_only) {
+        in_region = -1;
+    }
+    return in_region;
+}
+
+int Text::get_region_in(int p_line) const {
+
+    ERR_FAIL_INDEX_V(p_line, text.size(), -1);
+
+    if (region_valid_lines == 0) {
+        if (text[0].region_in != -1) {
+            text[0].region_in = -1;
+            text[0].highlight_valid = false;
+        }
+        region_valid_lines = 1;
+    }
+
+    // Propagate region state down from the last known line. Lines keep their highlight when the state they
+    // start in did not change, so an edit only rehighlights the lines it actually affects.
+    for (; region_valid_lines <= p_line; region_valid_lines++) {
+        Line &line = text[region_valid_lines];
+        int in_region = _get_region_out(region_valid_lines - 1);
+        if (line.region_in != in_region) {
+            line.region_in = in_region;
+            line.highlight_valid = false;
+        }
+    }
+
+    return text[p_line].region_in;
+}
+
+void Text::clear_highlight_cache(bool p_regions_changed) {
+
+    for (Line &line : text) {
+        line.highlight_valid = false;
+    }
+    if (p_regions_changed) {
+        region_valid_lines = 0;
+    }
+}
+
 int Text::get_line_width(int p_line) const {
 
     ERR_FAIL_INDEX_V(p_line, text.size(), -1);
@@ -1832,6 +1868,7 @@ void Text::clear_wrap_cache() {
 void Text::clear() {
 
     text.clear();
+    region_valid_lines = 0;
     insert(0, UIString());
 }
 
@@ -1852,7 +1889,10 @@ void Text::set(int p_line, const UIString &p_text) {
 
     text[p_line].width_cache = -1;
     text[p_line].wrap_amount_cache = -1;
+    text[p_line].highlight_valid = false;
     text[p_line].data = p_text;
+    // The line's own starting region is unchanged, the ones after it may differ.
+    region_valid_lines = MIN(region_valid_lines, p_line + 1);
 }
 
 void Text::insert(int p_at, const UIString &p_text) {
@@ -1867,11 +1907,13 @@ void Text::insert(int p_at, const UIString &p_text) {
     line.width_cache = -1;
     line.wrap_amount_cache = -1;
     line.data = p_text;
-    text.insert(text.begin() + p_at, line);
+    text.insert(text.begin() + p_at, eastl::move(line));
+    region_valid_lines = MIN(region_valid_lines, p_at);
 }
 void Text::remove(int p_at) {
 
     text.erase(text.begin() + p_at);
+    region_valid_lines = MIN(region_valid_lines, p_at);
 }
 
 int Text::get_char_width(CharType c, CharType next_c, int px) const {
@@ -2108,7 +2150,7 @@ void TextEdit::_notification(int p_what) {
 
             _update_caches();
             _update_wrap_at();
-            D()->syntax_highlighting_cache.clear();
+            D()->text.clear_highlight_cache(false);
         } break;
         case MainLoop::NOTIFICATION_WM_FOCUS_IN: {
             window_has_focus = true;
@@ -2476,9 +2518,10 @@ void TextEdit::_notification(int p_what) {
                     if (minimap_line < 0 || minimap_line >= (int)D()->text.size()) {
                         break;
                     }
-                    Map<int, HighlighterInfo> color_map;
+                    const Vector<HighlightSpan> *spans = nullptr;
+                    int span_idx = 0;
                     if (syntax_coloring) {
-                        color_map = D()->_get_line_syntax_highlighting(this,minimap_line);
+                        spans = &D()->_get_line_syntax_highlighting(minimap_line);
                     }
 
                     Color current_color = D()->cache.font_color;
@@ -2520,8 +2563,7 @@ void TextEdit::_notification(int p_what) {
                         int tabs = 0;
                         for (int j = 0; j < str.length(); j++) {
                             if (syntax_coloring) {
-                                if (color_map.contains(last_wrap_column + j)) {
-                                    current_color = color_map[last_wrap_column + j].color;
+                                if (_advance_highlight(*spans, span_idx, last_wrap_column + j, current_color)) {
                                     if (readonly) {
                                         current_color.a = D()->cache.font_color_readonly.a;
                                     }
@@ -2623,9 +2665,10 @@ void TextEdit::_notification(int p_what) {
                 const UIString &fullstr = D()->text[line];
                 PrivateData::LineDrawingCache cache_entry;
 
-                Map<int, HighlighterInfo> color_map;
+                const Vector<HighlightSpan> *spans = nullptr;
+                int span_idx = 0;
                 if (syntax_coloring) {
-                    color_map = D()->_get_line_syntax_highlighting(this,line);
+                    spans = &D()->_get_line_syntax_highlighting(line);
                 }
                 // Ensure we at least use the font color.
                 Color current_color = readonly ? D()->cache.font_color_readonly : D()->cache.font_color;
@@ -2889,8 +2932,7 @@ void TextEdit::_notification(int p_what) {
                         CharType next_c = (j+1)<str.length() ? str[j + 1] : CharType(0);
 
                         if (syntax_coloring) {
-                            if (color_map.contains(last_wrap_column + j)) {
-                                current_color = color_map[last_wrap_column + j].color;
+                            if (_advance_highlight(*spans, span_idx, last_wrap_column + j, current_color)) {
                                 if (readonly && current_color.a > D()->cache.font_color_readonly.a) {
                                     current_color.a = D()->cache.font_color_readonly.a;
                                 }
@@ -4688,8 +4730,6 @@ void TextEdit::_gui_input(const Ref<InputEvent> &p_gui_input) {
                     // Indent once again if previous line will end with ':','{','[','(' and the line is not a comment
                     // (i.e. colon/brace precedes current cursor position).
                     if (D()->cursor.column > 0) {
-                        const Map<int, TextColorRegionInfo> &cri_map =
-                                D()->text.get_color_region_info(D()->cursor.line);
                         bool indent_char_found = false;
                         bool should_indent = false;
                         CharType indent_char = ':';
@@ -4709,9 +4749,10 @@ void TextEdit::_gui_input(const Ref<InputEvent> &p_gui_input) {
                                     continue;
                             }
 
-                            if (indent_char_found && cri_map.contains(i) &&
-                                    (D()->color_regions[cri_map.at(i).region].begin_key == "#" ||
-                                            D()->color_regions[cri_map.at(i).region].begin_key == "//")) {
+                            const TextColorRegionInfo *cri =
+                                    indent_char_found ? D()->text.get_color_region_at(D()->cursor.line, i) : nullptr;
+                            if (cri && (D()->color_regions[cri->region].begin_key == "#" ||
+                                               D()->color_regions[cri->region].begin_key == "//")) {
 
                                 should_indent = true;
                                 break;
@@ -6676,12 +6717,12 @@ void TextEdit::_set_syntax_highlighting(SyntaxHighlighter *p_syntax_highlighter)
         D()->syntax_highlighter->set_text_editor(this);
         D()->syntax_highlighter->_update_cache();
     }
-    D()->syntax_highlighting_cache.clear();
+    D()->text.clear_highlight_cache(false);
     update();
 }
 
 int TextEdit::_is_line_in_region(int p_line) {
-    return D()->_is_line_in_region(p_line);
+    return D()->text.get_region_in(p_line);
 }
 
 TextEdit::ColorRegionData TextEdit::_get_color_region(int p_region) const {
@@ -6695,10 +6736,21 @@ TextEdit::ColorRegionData TextEdit::_get_color_region(int p_region) const {
     return crd;
 }
 
-Map<int, TextColorRegionInfo> TextEdit::_get_line_color_region_info(int p_line) const {
+const Vector<TextColorRegionInfo> &TextEdit::_get_line_color_region_info(int p_line) const {
     return D()->_get_line_color_region_info(p_line);
 }
 
+const Vector<TextEdit::HighlightSpan> &TextEdit::_get_line_syntax_highlighting(int p_line) {
+    static const Vector<HighlightSpan> empty;
+    ERR_FAIL_INDEX_V(p_line, D()->text.size(), empty);
+    return D()->_get_line_syntax_highlighting(p_line);
+}
+
+void TextEdit::_clear_syntax_highlighting_cache() {
+    D()->text.clear_highlight_cache(false);
+    update();
+}
+
 void TextEdit::clear_colors() {
 
     D()->clear_colors();
@@ -6708,7 +6760,7 @@ void TextEdit::clear_colors() {
 void TextEdit::add_keyword_color(StringView p_keyword, const Color &p_color) {
 
     D()->keywords[StringUtils::from_utf8(p_keyword)] = p_color;
-    D()->syntax_highlighting_cache.clear();
+    D()->text.clear_highlight_cache(false);
     update();
 }
 
@@ -6735,14 +6787,14 @@ void TextEdit::add_color_region(StringView p_begin_key, StringView p_end_key, co
 
     D()->color_regions.emplace_back(
             StringUtils::from_utf8(p_begin_key), StringUtils::from_utf8(p_end_key), p_color, p_line_only);
-    D()->syntax_highlighting_cache.clear();
+    D()->text.clear_highlight_cache(true);
     D()->text.clear_width_cache();
     update();
 }
 
 void TextEdit::add_member_keyword(StringView p_keyword, const Color &p_color) {
     D()->member_keywords[StringUtils::from_utf8(p_keyword)] = p_color;
-    D()->syntax_highlighting_cache.clear();
+    D()->text.clear_highlight_cache(false);
     update();
 }
 
@@ -6756,7 +6808,7 @@ Color TextEdit::get_member_color(const UIString& p_member) const {
 
 void TextEdit::clear_member_keywords() {
     D()->member_keywords.clear();
-    D()->syntax_highlighting_cache.clear();
+    D()->text.clear_highlight_cache(false);
     update();
 }
 
@@ -7304,13 +7356,11 @@ bool TextEdit::is_line_comment(int p_line) const {
     // Checks to see if this line is the start of a comment.
     ERR_FAIL_INDEX_V(p_line, D()->text.size(), false);
 
-    const Map<int, TextColorRegionInfo> &cri_map = D()->text.get_color_region_info(p_line);
-
     int line_length = D()->text[p_line].size();
     for (int i = 0; i < line_length - 1; i++) {
-        if (_is_symbol(D()->text[p_line][i]) && cri_map.contains(i)) {
-            const TextColorRegionInfo &cri = cri_map.at(i);
-            return D()->color_regions[cri.region].begin_key == "#" || D()->color_regions[cri.region].begin_key == "//";
+        const TextColorRegionInfo *cri = _is_symbol(D()->text[p_line][i]) ? D()->text.get_color_region_at(p_line, i) : nullptr;
+        if (cri) {
+            return D()->color_regions[cri->region].begin_key == "#" || D()->color_regions[cri->region].begin_key == "//";
         } else if (_is_whitespace(D()->text[p_line][i])) {
             continue;
         } else {
@@ -8670,18 +8720,26 @@ TextEdit::~TextEdit() {
 
 ///////////////////////////////////////////////////////////////////////////////
 
-Map<int, TextEdit::HighlighterInfo> PrivateData::_get_line_syntax_highlighting(TextEdit *te,int p_line) {
-    if (syntax_highlighting_cache.contains(p_line)) {
-        return syntax_highlighting_cache[p_line];
+const Vector<TextEdit::HighlightSpan> &PrivateData::_get_line_syntax_highlighting(int p_line) {
+    // Brings the line's starting region up to date first, this drops the cached spans if it changed.
+    int in_region = text.get_region_in(p_line);
+
+    Vector<TextEdit::HighlightSpan> &spans = text.get_highlight(p_line);
+    if (text.is_highlight_valid(p_line)) {
+        return spans;
     }
 
+    spans.clear();
     if (syntax_highlighter != nullptr) {
-        Map<int, TextEdit::HighlighterInfo> color_map = syntax_highlighter->_get_line_syntax_highlighting(p_line);
-        syntax_highlighting_cache[p_line] = color_map;
-        return color_map;
+        syntax_highlighter->_get_line_syntax_highlighting(p_line, spans);
+    } else {
+        _highlight_line(p_line, in_region, spans);
     }
+    text.set_highlight_valid(p_line);
+    return spans;
+}
 
-    Map<int, TextEdit::HighlighterInfo> color_map;
+void PrivateData::_highlight_line(int p_line, int p_in_region, Vector<TextEdit::HighlightSpan> &r_spans) {
 
     bool prev_is_char = false;
     bool prev_is_number = false;
@@ -8693,14 +8751,14 @@ Map<int, TextEdit::HighlighterInfo> PrivateData::_get_line_syntax_highlighting(T
     Color keyword_color;
     Color color;
 
-    int in_region = te->_is_line_in_region(p_line);
+    int in_region = p_in_region;
     int deregion = 0;
 
-    const Map<int, TextColorRegionInfo> cri_map = text.get_color_region_info(p_line);
+    const Vector<TextColorRegionInfo> &cri_list = text.get_color_region_info(p_line);
+    int cri_idx = 0;
     const UIString &str = text[p_line];
     Color prev_color;
     for (int j = 0; j < str.length(); j++) {
-        TextEdit::HighlighterInfo highlighter_info;
 
         if (deregion > 0) {
             deregion--;
@@ -8712,8 +8770,7 @@ Map<int, TextEdit::HighlighterInfo> PrivateData::_get_line_syntax_highlighting(T
         if (deregion != 0) {
             if (color != prev_color) {
                 prev_color = color;
-                highlighter_info.color = color;
-                color_map[j] = highlighter_info;
+                r_spans.push_back({ j, color });
             }
             continue;
         }
@@ -8755,8 +8812,12 @@ Map<int, TextEdit::HighlighterInfo> PrivateData::_get_line_syntax_highlighting(T
             in_word = false;
         }
 
-        if (is_symbol && cri_map.contains(j)) {
-            const TextColorRegionInfo &cri = cri_map.at(j);
+        // Region keys are sorted by column, skip the ones inside text we already passed.
+        while (cri_idx < cri_list.size() && cri_list[cri_idx].column < j) {
+            cri_idx++;
+        }
+        if (is_symbol && cri_idx < cri_list.size() && cri_list[cri_idx].column == j) {
+            const TextColorRegionInfo &cri = cri_list[cri_idx];
 
             if (in_region == -1) {
                 if (!cri.end) {
@@ -8859,13 +8920,9 @@ Map<int, TextEdit::HighlighterInfo> PrivateData::_get_line_syntax_highlighting(T
 
         if (color != prev_color) {
             prev_color = color;
-            highlighter_info.color = color;
-            color_map[j] = highlighter_info;
+            r_spans.push_back({ j, color });
         }
     }
-
-    syntax_highlighting_cache[p_line] = color_map;
-    return color_map;
 }
 
 void SyntaxHighlighter::set_text_editor(TextEdit *p_text_editor) {
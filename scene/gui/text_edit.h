@@ -44,6 +44,7 @@ class SyntaxHighlighter;
 
 struct TextColorRegionInfo {
 
+    int column=0;
     int region=0;
     bool end=false;
 };
@@ -52,7 +53,9 @@ class GODOT_EXPORT TextEdit : public Control {
     GDCLASS(TextEdit,Control)
 
 public:
-    struct HighlighterInfo {
+    // Start of a run of text drawn with one color, the run extends up to the next span's column.
+    struct HighlightSpan {
+        int column;
         Color color;
     };
 
@@ -237,7 +240,12 @@ public:
 
     int _is_line_in_region(int p_line);
     ColorRegionData _get_color_region(int p_region) const;
-    Map<int, TextColorRegionInfo> _get_line_color_region_info(int p_line) const;
+    // Region keys found in the line, sorted by column.
+    const Vector<TextColorRegionInfo> &_get_line_color_region_info(int p_line) const;
+    // Cached color spans of the line, sorted by column. Only edited lines and lines whose starting color region
+    // changed are highlighted again.
+    const Vector<HighlightSpan> &_get_line_syntax_highlighting(int p_line);
+    void _clear_syntax_highlighting_cache();
 
     enum MenuItems {
         MENU_CUT,
@@ -548,7 +556,9 @@ protected:
 public:
     virtual ~SyntaxHighlighter() = default;
     virtual void _update_cache() = 0;
-    virtual Map<int, TextEdit::HighlighterInfo> _get_line_syntax_highlighting(int p_line) = 0;
+    // Appends the color spans of p_line, sorted by column. TextEdit caches the result until the line or its
+    // starting color region changes, call TextEdit::_clear_syntax_highlighting_cache when other inputs change.
+    virtual void _get_line_syntax_highlighting(int p_line, Vector<TextEdit::HighlightSpan> &r_spans) = 0;
 
     virtual String get_name() const = 0;
     virtual Vector<String> get_supported_languages() = 0;
@@ -92,6 +92,8 @@ void TreeItem::move_to_top() {
     prev->next = next;
     next = parent->children;
     parent->children = this;
+    if (tree)
+        tree->_item_layout_changed(parent);
 }
 
 void TreeItem::move_to_bottom() {
@@ -110,6 +112,8 @@ void TreeItem::move_to_bottom() {
     }
     last->next = this;
     next = nullptr;
+    if (tree)
+        tree->_item_layout_changed(parent);
 }
 
 Size2 TreeItem::Cell::get_icon_size() const {
@@ -387,6 +391,7 @@ void TreeItem::set_collapsed(bool p_collapsed) {
         }
     }
 
+    tree->_item_layout_changed(this);
     _changed_notify();
     tree->emit_signal("item_collapsed", Variant(this));
 }
@@ -515,6 +520,9 @@ void TreeItem::remove_child(TreeItem *p_item) {
             *c = (*c)->next;
 
             aux->parent = nullptr;
+            if (tree) {
+                tree->_item_layout_changed(this);
+            }
             return;
         }
 
@@ -738,6 +746,7 @@ void TreeItem::set_custom_as_button(int p_column, bool p_button) {
 
     ERR_FAIL_INDEX(p_column, cells.size());
     cells[p_column].custom_button = p_button;
+    _changed_notify(p_column);
 }
 
 bool TreeItem::is_custom_set_as_button(int p_column) const {
@@ -968,6 +977,9 @@ void TreeItem::clear_children() {
     }
 
     children = nullptr;
+    if (tree) {
+        tree->_item_layout_changed(this);
+    }
 }
 
 TreeItem::TreeItem(Tree *p_tree) {
@@ -1071,9 +1083,22 @@ void Tree::update_cache() {
     cache.title_button_color = get_theme_color("title_button_color");
 
     v_scroll->set_custom_step(cache.font->get_height());
+
+    // This runs on every draw, only a change in what row heights are made of invalidates them.
+    const int font_h = cache.font->get_height();
+    const int check_h = cache.checked ? cache.checked->get_height() : 0;
+    const int custom_button_h = cache.custom_button ? cache.custom_button->get_minimum_size().height : 0;
+    if (font_h != height_font || check_h != height_check || custom_button_h != height_custom_button ||
+            cache.vseparation != height_vseparation) {
+        height_font = font_h;
+        height_check = check_h;
+        height_custom_button = custom_button_h;
+        height_vseparation = cache.vseparation;
+        height_version++;
+    }
 }
 
-int Tree::compute_item_height(TreeItem *p_item) const {
+int Tree::_compute_item_height(TreeItem *p_item) const {
 
     if (p_item == root && hide_root)
         return 0;
@@ -1132,26 +1157,129 @@ int Tree::compute_item_height(TreeItem *p_item) const {
     return height;
 }
 
+int Tree::compute_item_height(TreeItem *p_item) const {
+
+    if (p_item->height_version != height_version) {
+        p_item->cached_height = _compute_item_height(p_item);
+        p_item->height_version = height_version;
+    }
+    return p_item->cached_height;
+}
+
+// child_sums is a Fenwick tree over the children's subtree heights. Where a child starts, the child at a given offset
+// and a change in one child's height all take O(log(children)), so a change deep in the tree costs little per ancestor.
+static void _child_sums_build(Vector<int> &r_sums) {
+
+    const int count = r_sums.size();
+    for (int i = 1; i <= count; i++) {
+        const int parent = i + (i & -i);
+        if (parent <= count) {
+            r_sums[parent - 1] += r_sums[i - 1];
+        }
+    }
+}
+
+static void _child_sums_add(Vector<int> &r_sums, int p_index, int p_delta) {
+
+    for (int i = p_index + 1; i <= int(r_sums.size()); i += i & -i) {
+        r_sums[i - 1] += p_delta;
+    }
+}
+
+// Height of the first p_count children.
+static int _child_sums_prefix(const Vector<int> &p_sums, int p_count) {
+
+    int sum = 0;
+    for (int i = p_count; i > 0; i -= i & -i) {
+        sum += p_sums[i - 1];
+    }
+    return sum;
+}
+
 int Tree::get_item_height(TreeItem *p_item) const {
 
+    if (p_item->subtree_version == height_version)
+        return p_item->cached_subtree_height;
+
     int height = compute_item_height(p_item);
     height += cache.vseparation;
 
+    p_item->child_rows.clear();
+    p_item->child_sums.clear();
+
     if (!p_item->collapsed) { /* if not collapsed, check the children */
 
         TreeItem *c = p_item->children;
 
         while (c) {
 
-            height += get_item_height(c);
+            const int child_h = get_item_height(c);
+            height += child_h;
+            c->index_in_parent = p_item->child_rows.size();
+            p_item->child_rows.push_back(c);
+            p_item->child_sums.push_back(child_h);
 
             c = c->next;
         }
+        _child_sums_build(p_item->child_sums);
     }
 
+    p_item->cached_subtree_height = height;
+    p_item->subtree_version = height_version;
     return height;
 }
 
+void Tree::_item_layout_changed(TreeItem *p_item) {
+
+    // Only this item collects its children again, the ancestors keep theirs and move by the change in its height.
+    const bool cached = p_item->subtree_version == height_version;
+    const int old_height = p_item->cached_subtree_height;
+    p_item->subtree_version = 0;
+    if (cached) {
+        _item_height_changed(p_item, get_item_height(p_item) - old_height);
+    }
+}
+
+void Tree::_item_height_changed(TreeItem *p_item, int p_delta) {
+
+    // Cached items only have cached children, so nothing above the first uncached ancestor is cached either.
+    for (TreeItem *it = p_item; p_delta != 0 && it->parent; it = it->parent) {
+
+        TreeItem *parent = it->parent;
+        if (parent->subtree_version != height_version || parent->collapsed)
+            break;
+        _child_sums_add(parent->child_sums, it->index_in_parent, p_delta);
+        parent->cached_subtree_height += p_delta;
+    }
+}
+
+// Index of the first child of a non collapsed item whose subtree reaches below p_y (relative to where the children
+// start), or -1 if none does. r_start is where that child starts.
+int Tree::_find_first_child_below(TreeItem *p_item, int p_y, int &r_start) const {
+
+    r_start = 0;
+    get_item_height(p_item);
+    const Vector<int> &sums = p_item->child_sums;
+    const int count = sums.size();
+    if (p_y < 0) {
+        return count > 0 ? 0 : -1;
+    }
+    // Walk down the Fenwick tree, counting the children that end at or above p_y.
+    int idx = 0;
+    int remaining = p_y;
+    for (int step = next_power_of_2(count); step > 0; step >>= 1) {
+        if (idx + step <= count && sums[idx + step - 1] <= remaining) {
+            idx += step;
+            remaining -= sums[idx - 1];
+        }
+    }
+    if (idx == count) {
+        return -1;
+    }
+    r_start = p_y - remaining;
+    return idx;
+}
+
 void Tree::draw_item_rect(
         const TreeItem::Cell &p_cell, const Rect2i &p_rect, const Color &p_color, const Color &p_icon_color) {
 
@@ -1599,12 +1727,26 @@ int Tree::draw_item(const Point2i &p_pos, const Point2 &p_draw_ofs, const Size2
         children_pos.y += htotal;
     }
 
-    if (!p_item->collapsed) { /* if not collapsed, check the children */
-
-        TreeItem *c = p_item->children;
+    if (!p_item->collapsed && p_item->children) { /* if not collapsed, check the children */
 
         int prev_ofs = children_pos.y - cache.offset.y + p_draw_ofs.y;
 
+        // Skip the children that end above the visible area (with a row to spare for their relationship lines),
+        // their heights are cached.
+        int skipped_h;
+        const int first = _find_first_child_below(p_item, cache.offset.y - children_pos.y - label_h, skipped_h);
+        if (first < 0) {
+            return htotal + get_item_height(p_item) - compute_item_height(p_item) - cache.vseparation;
+        }
+        if (first > 0) {
+            const int prev_start = _child_sums_prefix(p_item->child_sums, first - 1);
+            prev_ofs = children_pos.y + prev_start + label_h / 2 - cache.offset.y + p_draw_ofs.y;
+            htotal += skipped_h;
+            children_pos.y += skipped_h;
+        }
+
+        TreeItem *c = p_item->child_rows[first];
+
         while (c) {
             if (htotal >= 0) {
                 int child_h = draw_item(children_pos, p_draw_ofs, p_draw_size, c);
@@ -2164,9 +2306,20 @@ int Tree::propagate_mouse_event(const Point2i &p_pos, int x_ofs, int y_ofs, bool
             new_pos.y -= item_h;
         }
 
-        if (!p_item->collapsed) { /* if not collapsed, check the children */
-
-            TreeItem *c = p_item->children;
+        if (!p_item->collapsed && p_item->children) { /* if not collapsed, check the children */
+
+            // children ending above the event can't receive it
+            int skipped_h;
+            const int first = _find_first_child_below(p_item, new_pos.y, skipped_h);
+            TreeItem *c = nullptr;
+            if (first >= 0) {
+                c = p_item->child_rows[first];
+                new_pos.y -= skipped_h;
+                y_ofs += skipped_h;
+                item_h += skipped_h;
+            } else {
+                item_h += get_item_height(p_item) - compute_item_height(p_item) - cache.vseparation;
+            }
 
             while (c) {
 
@@ -3297,6 +3450,7 @@ TreeItem *Tree::create_item(TreeItem *p_parent, int p_idx) {
         else
             p_parent->children = ti;
         ti->parent = p_parent;
+        _item_layout_changed(p_parent);
 
     } else {
 
@@ -3350,6 +3504,19 @@ void Tree::item_edited(int p_column, TreeItem *p_item, bool p_lmb) {
 
 void Tree::item_changed(int p_column, TreeItem *p_item) {
 
+    // Most changes leave the row height alone, then the cached layout stays valid.
+    if (p_item->height_version == height_version) {
+        const int old_height = p_item->cached_height;
+        p_item->height_version = 0;
+        const int delta = compute_item_height(p_item) - old_height;
+        if (delta != 0 && p_item->subtree_version == height_version) {
+            // The children stay where they are relative to this row.
+            p_item->cached_subtree_height += delta;
+            _item_height_changed(p_item, delta);
+        }
+    } else {
+        _item_layout_changed(p_item);
+    }
     update();
 }
 
@@ -3445,6 +3612,7 @@ void Tree::clear() {
 void Tree::set_hide_root(bool p_enabled) {
 
     hide_root = p_enabled;
+    height_version++;
     update();
 }
 
@@ -3592,6 +3760,7 @@ void Tree::set_columns(int p_columns) {
         propagate_set_columns(root);
     if (selected_col >= p_columns)
         selected_col = p_columns - 1;
+    height_version++;
     update();
 }
 
@@ -3612,42 +3781,29 @@ Rect2 Tree::get_custom_popup_rect() const {
 
 int Tree::get_item_offset(TreeItem *p_item) const {
 
-    TreeItem *it = root;
     int ofs = _get_title_button_height();
-    if (!it)
+    if (!root || !p_item)
         return 0;
 
-    while (true) {
+    // Sum the rows of the ancestors and the cached subtrees of the siblings before each of them.
+    TreeItem *it = p_item;
+    while (it->parent) {
 
-        if (it == p_item)
-            return ofs;
+        TreeItem *parent = it->parent;
+        if (parent->collapsed)
+            return 0; // not visible
 
-        ofs += compute_item_height(it);
-        if (it != root || !hide_root) {
+        get_item_height(parent);
+        const int idx = it->index_in_parent;
+        ofs += compute_item_height(parent);
+        if (parent != root || !hide_root) {
             ofs += cache.vseparation;
         }
-
-        if (it->children && !it->collapsed) {
-
-            it = it->children;
-
-        } else if (it->next) {
-
-            it = it->next;
-        } else {
-
-            while (!it->next) {
-
-                it = it->parent;
-                if (it == nullptr)
-                    return 0;
-            }
-
-            it = it->next;
-        }
+        ofs += _child_sums_prefix(parent->child_sums, idx);
+        it = parent;
     }
 
-    return -1; //not found
+    return it == root ? ofs : 0;
 }
 
 void Tree::ensure_cursor_is_visible() {
@@ -3902,10 +4058,19 @@ TreeItem *Tree::_find_item_at_pos(TreeItem *p_item, const Point2 &p_pos, int &r_
         h = 0;
     }
 
-    if (p_item->is_collapsed())
+    if (p_item->is_collapsed() || !p_item->children)
         return nullptr; // do not try children, it's collapsed
 
-    TreeItem *n = p_item->get_children();
+    int skipped_h;
+    const int first = _find_first_child_below(p_item, pos.y, skipped_h);
+    if (first < 0) {
+        h += get_item_height(p_item) - compute_item_height(p_item) - cache.vseparation;
+        return nullptr;
+    }
+    pos.y -= skipped_h;
+    h += skipped_h;
+
+    TreeItem *n = p_item->child_rows[first];
     while (n) {
 
         int ch;
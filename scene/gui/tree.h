@@ -114,6 +114,15 @@ private:
     TreeItem *children; //child items
     Tree *tree; //tree (for reference)
 
+    // Layout caches, valid while their version matches Tree::height_version.
+    Vector<TreeItem *> child_rows; // children in order, filled while not collapsed
+    Vector<int> child_sums; // Fenwick tree over the children's subtree heights
+    int cached_height = 0; // compute_item_height()
+    int cached_subtree_height = 0; // get_item_height()
+    int index_in_parent = 0; // into parent->child_rows
+    uint32_t height_version = 0;
+    uint32_t subtree_version = 0;
+
     TreeItem(Tree *p_tree);
 
     void _changed_notify(int p_cell);
@@ -395,9 +404,20 @@ private:
     bool updating_value_editor;
     bool range_up_last;
 
+    // Bumped when something every row height depends on changes, dropping all cached item heights.
+    uint32_t height_version = 1;
+    int height_font = 0;
+    int height_check = 0;
+    int height_custom_button = 0;
+    int height_vseparation = 0;
+
     void _range_click_timeout();
+    int _compute_item_height(TreeItem *p_item) const;
     int compute_item_height(TreeItem *p_item) const;
     int get_item_height(TreeItem *p_item) const;
+    void _item_layout_changed(TreeItem *p_item);
+    void _item_height_changed(TreeItem *p_item, int p_delta);
+    int _find_first_child_below(TreeItem *p_item, int p_y, int &r_start) const;
     //void draw_item_text(String p_text,const Ref<Texture>& p_icon,int p_icon_max_w,bool p_tool,Rect2i p_rect,const Color& p_color);
     void draw_item_rect(const TreeItem::Cell &p_cell, const Rect2i &p_rect, const Color &p_color, const Color &p_icon_color);
     int draw_item(const Point2i &p_pos, const Point2 &p_draw_ofs, const Size2 &p_draw_size, TreeItem *p_item);
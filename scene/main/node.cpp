@@ -93,11 +93,21 @@ struct Node::PrivData {
         StringName name;
         MultiplayerAPI_RPCMode mode;
     };
+    // Lookup by name for nodes with many children, see index_child().
+    struct ChildIndex {
+        enum {
+            MIN_CHILDREN = 32
+        };
+        HashMap<StringName, Node *> by_name;
+        HashMap<String, int> serials; // last serial number handed out per base name (separator included)
+        int duplicates = 0; // siblings sharing a name, only possible through _add_child_nocheck()
+    };
     HashMap<StringName, GroupData> grouped;
     Vector<Node *> owned;
     Vector<Node *> children; // list of children
     Vector<NetData> rpc_methods;
     Vector<NetData> rpc_properties;
+    ChildIndex *child_index = nullptr;
     Ref<SceneState> instance_state;
     Ref<SceneState> inherited_state;
 #ifdef TOOLS_ENABLED
@@ -146,6 +156,82 @@ struct Node::PrivData {
     bool ready_notified : 1; // this is a small hack, so if a node is added during _ready() to the tree, it correctly
                              // gets the _ready() notification
     bool ready_first : 1;
+
+    ~PrivData() {
+        if (child_index) {
+            memdelete(child_index);
+        }
+    }
+
+    // Call after p_child got added to children, or after its name changed.
+    void index_child(Node *p_child) {
+        if (!child_index) {
+            if (children.size() < ChildIndex::MIN_CHILDREN) {
+                return;
+            }
+            child_index = memnew(ChildIndex);
+            for (Node *child : children) {
+                if (!child_index->by_name.emplace(child->priv_data->name, child).second) {
+                    child_index->duplicates++;
+                }
+            }
+            return;
+        }
+        if (!child_index->by_name.emplace(p_child->priv_data->name, p_child).second) {
+            child_index->duplicates++;
+        }
+    }
+    // Call before p_child gets removed from children, or before its name changes.
+    void unindex_child(Node *p_child) {
+        if (!child_index) {
+            return;
+        }
+        auto iter = child_index->by_name.find(p_child->priv_data->name);
+        if (iter == child_index->by_name.end() || iter->second != p_child) {
+            if (child_index->duplicates > 0) {
+                child_index->duplicates--;
+            }
+            return;
+        }
+        child_index->by_name.erase(iter);
+        if (child_index->duplicates == 0) {
+            return;
+        }
+        for (Node *child : children) {
+            if (child != p_child && child->priv_data->name == p_child->priv_data->name) {
+                child_index->by_name.emplace(child->priv_data->name, child);
+                child_index->duplicates--;
+                break;
+            }
+        }
+    }
+    // With duplicate names the index may not hold the first of them in child order, which is the one returned.
+    Node *find_child(const StringName &p_name) const {
+        if (child_index && child_index->duplicates == 0) {
+            auto iter = child_index->by_name.find(p_name);
+            return iter != child_index->by_name.end() ? iter->second : nullptr;
+        }
+        for (Node *child : children) {
+            if (child->priv_data->name == p_name) {
+                return child;
+            }
+        }
+        return nullptr;
+    }
+    // Whether a child other than p_except is called p_name.
+    bool child_name_taken(const StringName &p_name, const Node *p_except) const {
+        if (child_index && child_index->duplicates == 0) {
+            auto iter = child_index->by_name.find(p_name);
+            return iter != child_index->by_name.end() && iter->second != p_except;
+        }
+        for (const Node *child : children) {
+            if (child != p_except && child->priv_data->name == p_name) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     uint16_t get_node_rset_property_id(const StringName &p_property) const {
         for (int i = 0; i < rpc_properties.size(); i++) {
             if (rpc_properties[i].name == p_property) {
@@ -1092,7 +1178,13 @@ StringName Node::get_name() const {
 
 void Node::_set_name_nocheck(const StringName &p_name) {
 
+    if (priv_data->parent) {
+        priv_data->parent->priv_data->unindex_child(this);
+    }
     priv_data->name = p_name;
+    if (priv_data->parent) {
+        priv_data->parent->priv_data->index_child(this);
+    }
 }
 
 const char *Node::invalid_character(". : @ / \"");
@@ -1114,11 +1206,15 @@ void Node::set_name(StringView p_name) {
     _validate_node_name(name);
 
     ERR_FAIL_COND(name.empty());
+    if (priv_data->parent) {
+        priv_data->parent->priv_data->unindex_child(this);
+    }
     priv_data->name = StringName(name);
 
     if (priv_data->parent) {
 
         priv_data->parent->_validate_child_name(this);
+        priv_data->parent->priv_data->index_child(this);
     }
 
     propagate_notification(NOTIFICATION_PATH_CHANGED);
@@ -1176,17 +1272,7 @@ void Node::_validate_child_name(Node *p_child, bool p_force_human_readable) {
             unique = false;
         } else {
             //check if exists
-            Node **children = priv_data->children.data();
-            int cc = priv_data->children.size();
-
-            for (int i = 0; i < cc; i++) {
-                if (children[i] == p_child)
-                    continue;
-                if (children[i]->priv_data->name == p_child->priv_data->name) {
-                    unique = false;
-                    break;
-                }
-            }
+            unique = !priv_data->child_name_taken(p_child->priv_data->name, p_child);
         }
 
         if (!unique) {
@@ -1246,26 +1332,9 @@ void Node::_generate_serial_child_name(const Node *p_child, StringName &name) co
         }
     }
 
-    //quickly test if proposed name exists
-    int cc = priv_data->children.size(); //children count
-    const Node *const *children_ptr = priv_data->children.data();
-
-    {
-
-        bool exists = false;
-
-        for (int i = 0; i < cc; i++) {
-            if (children_ptr[i] == p_child) { //exclude self in renaming if its already a child
-                continue;
-            }
-            if (children_ptr[i]->priv_data->name == name) {
-                exists = true;
-            }
-        }
-
-        if (!exists) {
-            return; //if it does not exist, it does not need validation
-        }
+    //quickly test if proposed name exists, excluding self in renaming if its already a child
+    if (!priv_data->child_name_taken(name, p_child)) {
+        return; //if it does not exist, it does not need validation
     }
 
     // Extract trailing number
@@ -1290,21 +1359,19 @@ void Node::_generate_serial_child_name(const Node *p_child, StringName &name) co
         nums = "";
     }
 
+    // Serials are only tracked for plain numbers, zero padded ones keep their width when increased.
+    PrivData::ChildIndex *index = priv_data->child_index;
+    auto is_plain_number = [](const String &p_nums) { return !p_nums.empty() && p_nums[0] != '0' && p_nums.length() < 9; };
+
     for (;;) {
         StringName attempt(name_string + nums);
-        bool exists = false;
 
-        for (int i = 0; i < cc; i++) {
-            if (children_ptr[i] == p_child) {
-                continue;
-            }
-            if (children_ptr[i]->priv_data->name == attempt) {
-                exists = true;
-            }
-        }
-
-        if (!exists) {
+        if (!priv_data->child_name_taken(attempt, p_child)) {
             name = attempt;
+            if (index && is_plain_number(nums)) {
+                int &serial = index->serials[name_string];
+                serial = M_MAX(serial, StringUtils::to_int(nums));
+            }
             return;
         } else {
             if (nums.length() == 0) {
@@ -1314,6 +1381,13 @@ void Node::_generate_serial_child_name(const Node *p_child, StringName &name) co
             } else {
                 nums = increase_numeric_string(nums);
             }
+            // Skip past the last serial handed out for this base name instead of probing every taken one.
+            if (index && is_plain_number(nums)) {
+                auto iter = index->serials.find(name_string);
+                if (iter != index->serials.end() && iter->second >= StringUtils::to_int(nums)) {
+                    nums = itos(iter->second + 1);
+                }
+            }
         }
     }
 }
@@ -1324,6 +1398,7 @@ void Node::_add_child_nocheck(Node *p_child, const StringName &p_name) {
     p_child->priv_data->name = p_name;
     p_child->priv_data->pos = priv_data->children.size();
     priv_data->children.push_back(p_child);
+    priv_data->index_child(p_child);
     p_child->priv_data->parent = this;
     p_child->notification(NOTIFICATION_PARENTED);
 
@@ -1409,6 +1484,7 @@ void Node::remove_child(Node *p_child) {
     remove_child_notify(p_child);
     p_child->notification(NOTIFICATION_UNPARENTED);
 
+    priv_data->unindex_child(p_child);
     priv_data->children.erase_at(idx);
 
     //update pointer and size
@@ -1445,15 +1521,7 @@ const Vector<Node *> &Node::children() const
 
 Node *Node::_get_child_by_name(const StringName &p_name) const {
 
-    int cc = priv_data->children.size();
-    Node *const *cd = priv_data->children.data();
-
-    for (int i = 0; i < cc; i++) {
-        if (cd[i]->priv_data->name == p_name)
-            return cd[i];
-    }
-
-    return nullptr;
+    return priv_data->find_child(p_name);
 }
 
 static Node *get_by_name(Node *from,StringView name) {
@@ -1516,18 +1584,7 @@ Node *Node::get_node_or_null(const NodePath &p_path) const {
 
         } else {
 
-            next = nullptr;
-
-            for (int j = 0; j < current->priv_data->children.size(); j++) {
-
-                Node *child = current->priv_data->children[j];
-
-                if (child->priv_data->name == name) {
-
-                    next = child;
-                    break;
-                }
-            }
+            next = current->priv_data->find_child(name);
             if (next == nullptr) {
                 return nullptr;
             }
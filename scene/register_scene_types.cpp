@@ -1183,6 +1183,7 @@ void unregister_scene_types() {
     resource_loader_stream_texture.unref();
 
     DynamicFont::finish_dynamic_fonts();
+    Skeleton::finish_pose_updates();
 
     gResourceManager().remove_resource_format_saver(resource_saver_text);
     resource_saver_text.unref();
@@ -32,10 +32,14 @@
 #include "dynamic_font.h"
 #include "font_serializers.h"
 
+#include "core/dictionary.h"
+#include "core/engine.h"
+#include "core/message_queue.h"
 #include "core/object_tooling.h"
 #include "core/os/file_access.h"
 #include "core/os/mutex.h"
 #include "core/os/os.h"
+#include "core/os/thread.h"
 #include "scene/resources/texture.h"
 #include "core/method_bind.h"
 #include "core/ustring.h"
@@ -48,6 +52,13 @@
 
 #include FT_STROKER_H
 
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "thirdparty/stb_rect_pack/stb_rect_pack.h"
+
+#include "EASTL/sort.h"
+
+#include <atomic>
 #include <cstdint>
 
 IMPL_GDCLASS(DynamicFontData)
@@ -59,21 +70,307 @@ VARIANT_ENUM_CAST(DynamicFont::SpacingType);
 
 static Vector<DynamicFont *> dynamic_fonts;
 
-struct DynamicFontAtSize::ImplData
-{
-    struct CharTexture {
+namespace {
+
+// Pages of one format and flag combination that are filled before the least recently used one gets recycled.
+constexpr int ATLAS_PAGE_BUDGET = 4;
+constexpr int ATLAS_PAGE_SIZE = 1024;
+constexpr int ATLAS_PAGE_MAX_SIZE = 4096;
+
+// Copy of everything rasterization reads, so precache threads never touch the font resources.
+struct RasterSettings {
+    int32_t load_flags = 0;
+    int outline_size = 0;
+    float oversampling = 1.0f;
+    bool antialiased = true;
+    bool force_autohinter = false;
+};
+
+// A glyph bitmap already converted to the atlas pixel layout (LA8 or RGBA8).
+struct RasterizedGlyph {
+    Vector<uint8_t> pixels;
+    int32_t code = 0;
+    int width = 0;
+    int height = 0;
+    int color_size = 2;
+    int top = 0;
+    int left = 0;
+    float advance = 0;
+    bool found = false;
+};
+
+void _convert_bitmap(const FT_Bitmap &p_bitmap, int p_top, int p_left, float p_advance, RasterizedGlyph &r_glyph) {
+
+    const int w = p_bitmap.width;
+    const int h = p_bitmap.rows;
+    const int color_size = p_bitmap.pixel_mode == FT_PIXEL_MODE_BGRA ? 4 : 2;
+
+    r_glyph.pixels.resize(w * h * color_size);
+    uint8_t *wr = r_glyph.pixels.data();
+
+    for (int i = 0; i < h; i++) {
+        for (int j = 0; j < w; j++) {
+
+            int ofs = (i * w + j) * color_size;
+            switch (p_bitmap.pixel_mode) {
+                case FT_PIXEL_MODE_MONO: {
+                    int byte = i * p_bitmap.pitch + (j >> 3);
+                    int bit = 1 << (7 - (j % 8));
+                    wr[ofs + 0] = 255; //grayscale as 1
+                    wr[ofs + 1] = (p_bitmap.buffer[byte] & bit) ? 255 : 0;
+                } break;
+                case FT_PIXEL_MODE_GRAY:
+                    wr[ofs + 0] = 255; //grayscale as 1
+                    wr[ofs + 1] = p_bitmap.buffer[i * p_bitmap.pitch + j];
+                    break;
+                case FT_PIXEL_MODE_BGRA: {
+                    int ofs_color = i * p_bitmap.pitch + (j << 2);
+                    wr[ofs + 2] = p_bitmap.buffer[ofs_color + 0];
+                    wr[ofs + 1] = p_bitmap.buffer[ofs_color + 1];
+                    wr[ofs + 0] = p_bitmap.buffer[ofs_color + 2];
+                    wr[ofs + 3] = p_bitmap.buffer[ofs_color + 3];
+                } break;
+                    // TODO: FT_PIXEL_MODE_LCD
+                default:
+                    ERR_FAIL_MSG("Font uses unsupported pixel format: " + itos(p_bitmap.pixel_mode) + ".");
+            }
+        }
+    }
+
+    r_glyph.width = w;
+    r_glyph.height = h;
+    r_glyph.color_size = color_size;
+    r_glyph.top = p_top;
+    r_glyph.left = p_left;
+    r_glyph.advance = p_advance;
+    r_glyph.found = true;
+}
+
+// Loads and renders one glyph. Only p_face is used, so this runs on whichever thread owns the face.
+void _rasterize_glyph(FT_Library p_library, FT_Face p_face, const RasterSettings &p_settings, int32_t p_char, RasterizedGlyph &r_glyph) {
+
+    r_glyph.code = p_char;
+    r_glyph.found = false;
+
+    if (FT_Get_Char_Index(p_face, p_char) == 0) {
+        return;
+    }
+
+    if (FT_Load_Char(p_face, p_char, p_settings.load_flags) != 0) {
+        return;
+    }
+
+    if (p_settings.outline_size <= 0) {
+        FT_GlyphSlot slot = p_face->glyph;
+        if (FT_Render_Glyph(slot, p_settings.antialiased ? FT_RENDER_MODE_NORMAL : FT_RENDER_MODE_MONO) == 0) {
+            _convert_bitmap(slot->bitmap, slot->bitmap_top, slot->bitmap_left, slot->advance.x / 64.0f, r_glyph);
+        }
+        return;
+    }
+
+    if (FT_Load_Char(p_face, p_char, FT_LOAD_NO_BITMAP | (p_settings.force_autohinter ? FT_LOAD_FORCE_AUTOHINT : 0)) != 0) {
+        return;
+    }
+
+    FT_Stroker stroker;
+    if (FT_Stroker_New(p_library, &stroker) != 0) {
+        return;
+    }
+
+    FT_Stroker_Set(stroker, (int)(p_settings.outline_size * p_settings.oversampling * 64.0f), FT_STROKER_LINECAP_BUTT, FT_STROKER_LINEJOIN_ROUND, 0);
+    FT_Glyph glyph;
+    FT_BitmapGlyph glyph_bitmap;
 
+    if (FT_Get_Glyph(p_face->glyph, &glyph) != 0)
+        goto cleanup_stroker;
+    if (FT_Glyph_Stroke(&glyph, stroker, 1) != 0)
+        goto cleanup_glyph;
+    if (FT_Glyph_To_Bitmap(&glyph, FT_RENDER_MODE_NORMAL, nullptr, 1) != 0)
+        goto cleanup_glyph;
+
+    glyph_bitmap = (FT_BitmapGlyph)glyph;
+    _convert_bitmap(glyph_bitmap->bitmap, glyph_bitmap->top, glyph_bitmap->left, glyph->advance.x / 65536.0f, r_glyph);
+
+cleanup_glyph:
+    FT_Done_Glyph(glyph);
+cleanup_stroker:
+    FT_Stroker_Done(stroker);
+}
+
+} // end of anonymous namespace
+
+// Glyph pages shared by every size, outline and filter variant of one font file. Pages are packed with stb_rect_pack
+// and only uploaded once per frame, from a deferred flush, no matter how many glyphs were added to them.
+// Sizes lock only themselves, so everything touching the pages takes mutex.
+struct DynamicFontData::GlyphAtlas {
+
+    struct Page {
         PoolVector<uint8_t> imgdata;
-        Vector<int> offsets;
         Ref<ImageTexture> texture;
-        int texture_size;
+        Vector<stbrp_node> nodes;
+        stbrp_context packer;
+        Image::Format format;
+        uint32_t texture_flags;
+        int color_size;
+        int size;
+        int glyph_count = 0;
+        int64_t used_area = 0;
+        uint64_t last_used_frame = 0;
+        uint32_t generation = 0; // bumped whenever the page is recycled, invalidating the glyphs packed into it
+        bool dirty = false;
+    };
+
+    struct Allocation {
+        int page = -1;
+        int x = 0;
+        int y = 0;
     };
 
+    Mutex mutex;
+    Vector<Page *> pages;
+    std::atomic<uint64_t> glyphs_rasterized { 0 };
+    std::atomic<uint64_t> rasterize_usec { 0 };
+    uint64_t uploads = 0;
+    uint64_t evictions = 0;
+    bool flush_queued = false;
+    bool evicted = false;
+
+    static void _clear_page(Page *p_page) {
+
+        PoolVector<uint8_t>::Write w = p_page->imgdata.write();
+        const int bytes = p_page->size * p_page->size * p_page->color_size;
+        // Initialize the texture to all-white pixels to prevent artifacts when the
+        // font is displayed at a non-default scale with filtering enabled.
+        if (p_page->color_size == 2) {
+            for (int i = 0; i < bytes; i += 2) {
+                w[i + 0] = 255;
+                w[i + 1] = 0;
+            }
+        } else {
+            for (int i = 0; i < bytes; i += 4) {
+                w[i + 0] = 255;
+                w[i + 1] = 255;
+                w[i + 2] = 255;
+                w[i + 3] = 0;
+            }
+        }
+
+        stbrp_init_target(&p_page->packer, p_page->size, p_page->size, p_page->nodes.data(), p_page->nodes.size());
+        p_page->glyph_count = 0;
+        p_page->used_area = 0;
+        p_page->dirty = true;
+    }
+
+    Page *_create_page(Image::Format p_format, int p_color_size, uint32_t p_flags, int p_size) {
+
+        Page *page = memnew(Page);
+        page->format = p_format;
+        page->color_size = p_color_size;
+        page->texture_flags = p_flags;
+        page->size = p_size;
+        page->imgdata.resize(p_size * p_size * p_color_size);
+        page->nodes.resize(p_size);
+        _clear_page(page);
+
+        // The texture exists right away so glyphs can be drawn with it, its contents follow with the next flush.
+        page->texture = make_ref_counted<ImageTexture>();
+        page->texture->create_from_image(make_ref_counted<Image>(p_size, p_size, false, p_format, page->imgdata), Texture::FLAG_VIDEO_SURFACE | p_flags);
+        page->dirty = false;
+        return page;
+    }
+
+    bool _pack(Page *p_page, int p_width, int p_height, Allocation &r_alloc) {
+
+        if (p_width > p_page->size || p_height > p_page->size) {
+            return false;
+        }
+
+        stbrp_rect rect;
+        rect.id = 0;
+        rect.w = p_width;
+        rect.h = p_height;
+        rect.was_packed = 0;
+        stbrp_pack_rects(&p_page->packer, &rect, 1);
+        if (!rect.was_packed) {
+            return false;
+        }
+
+        r_alloc.x = rect.x;
+        r_alloc.y = rect.y;
+        p_page->glyph_count++;
+        p_page->used_area += p_width * p_height;
+        p_page->dirty = true;
+        p_page->last_used_frame = Engine::get_singleton()->get_frames_drawn();
+        return true;
+    }
+
+    Allocation allocate(Image::Format p_format, int p_color_size, uint32_t p_flags, int p_width, int p_height) {
+
+        Allocation ret;
+
+        const uint64_t frame = Engine::get_singleton()->get_frames_drawn();
+        int group_pages = 0;
+        int lru = -1;
+
+        for (int i = 0; i < pages.size(); i++) {
+
+            Page *page = pages[i];
+            if (page->format != p_format || page->texture_flags != p_flags) {
+                continue;
+            }
+
+            group_pages++;
+            if (_pack(page, p_width, p_height, ret)) {
+                ret.page = i;
+                return ret;
+            }
+
+            // Pages drawn from this frame are never recycled, canvas items may still be referencing their contents.
+            if (page->last_used_frame < frame && page->size >= M_MAX(p_width, p_height) && (lru == -1 || page->last_used_frame < pages[lru]->last_used_frame)) {
+                lru = i;
+            }
+        }
+
+        int idx;
+        if (group_pages >= ATLAS_PAGE_BUDGET && lru != -1) {
+            idx = lru;
+            _clear_page(pages[idx]);
+            pages[idx]->generation++;
+            evictions++;
+            evicted = true;
+        } else {
+            int size = next_power_of_2(M_MAX(M_MAX(p_width, p_height), ATLAS_PAGE_SIZE));
+            ERR_FAIL_COND_V(size > ATLAS_PAGE_MAX_SIZE, ret);
+            idx = pages.size();
+            pages.push_back(_create_page(p_format, p_color_size, p_flags, size));
+        }
+
+        if (_pack(pages[idx], p_width, p_height, ret)) {
+            ret.page = idx;
+        }
+        return ret;
+    }
+
+    void touch(int p_page) {
+        MutexGuard guard(mutex);
+        pages[p_page]->last_used_frame = Engine::get_singleton()->get_frames_drawn();
+    }
+
+    ~GlyphAtlas() {
+        for (Page *page : pages) {
+            memdelete(page);
+        }
+    }
+};
+
+struct DynamicFontAtSize::ImplData
+{
     struct Character {
 
         Rect2 rect={};
         Rect2 rect_uv={};
         int texture_idx=0;
+        uint32_t generation=0;
         float v_align=0;
         float h_align=0;
         float advance=0;
@@ -88,15 +385,9 @@ struct DynamicFontAtSize::ImplData
         }
     };
 
-    struct TexturePosition {
-        int index;
-        int x;
-        int y;
-    };
     _THREAD_SAFE_CLASS_
     Vector<uint8_t> s_df_fontdata;
     HashMap<int32_t, Character> char_map;
-    Vector<CharTexture> textures;
     FT_Library library; /* handle to library     */
     FT_Face face; /* handle to face object */
     FT_StreamRec stream;
@@ -112,94 +403,113 @@ struct DynamicFontAtSize::ImplData
     uint32_t texture_flags;
     bool valid;
 
-    Character _bitmap_to_character(DynamicFontAtSize::ImplData *fa, FT_Bitmap bitmap, int yofs, int xofs, float advance) {
-        int w = bitmap.width;
-        int h = bitmap.rows;
-
-        int mw = w + fa->rect_margin * 2;
-        int mh = h + fa->rect_margin * 2;
-
-        ERR_FAIL_COND_V(mw > 4096, Character::not_found());
-            ERR_FAIL_COND_V(mh > 4096, Character::not_found());
+    // Background rasterization: the precache thread opens its own face and hands finished bitmaps over in
+    // precached, which is drained into the atlas by the thread using the font.
+    Thread precache_thread;
+    Mutex precache_mutex;
+    Vector<int32_t> precache_chars;
+    Vector<RasterizedGlyph> precached;
+    RasterSettings precache_settings;
+    std::atomic<bool> precache_ready { false };
+    std::atomic<bool> precache_abort { false };
 
-            int color_size = bitmap.pixel_mode == FT_PIXEL_MODE_BGRA ? 4 : 2;
-        Image::Format require_format = color_size == 4 ? ImageData::FORMAT_RGBA8 : ImageData::FORMAT_LA8;
+    const Ref<ImageTexture> &_get_texture(int p_idx) const {
+        // pages are never freed before the atlas, and a recycled page keeps its texture
+        MutexGuard guard(font->atlas->mutex);
+        return font->atlas->pages[p_idx]->texture;
+    }
 
-        TexturePosition tex_pos = fa->_find_texture_pos_for_glyph(color_size, require_format, mw, mh);
-        ERR_FAIL_COND_V(tex_pos.index < 0, Character::not_found());
+    int _get_texture_count() const {
+        MutexGuard guard(font->atlas->mutex);
+        return font->atlas->pages.size();
+    }
 
-            //fit character in char texture
+    RasterSettings _get_raster_settings() const {
 
-            CharTexture &tex = fa->textures[tex_pos.index];
+        int ft_hinting;
 
-        {
-            PoolVector<uint8_t>::Write wr = tex.imgdata.write();
-
-            for (int i = 0; i < h; i++) {
-                for (int j = 0; j < w; j++) {
-
-                    int ofs = ((i + tex_pos.y + fa->rect_margin) * tex.texture_size + j + tex_pos.x + fa->rect_margin) * color_size;
-                    ERR_FAIL_COND_V(ofs >= tex.imgdata.size(), Character::not_found());
-                        switch (bitmap.pixel_mode) {
-                        case FT_PIXEL_MODE_MONO: {
-                            int byte = i * bitmap.pitch + (j >> 3);
-                            int bit = 1 << (7 - (j % 8));
-                            wr[ofs + 0] = 255; //grayscale as 1
-                            wr[ofs + 1] = (bitmap.buffer[byte] & bit) ? 255 : 0;
-                        } break;
-                        case FT_PIXEL_MODE_GRAY:
-                            wr[ofs + 0] = 255; //grayscale as 1
-                            wr[ofs + 1] = bitmap.buffer[i * bitmap.pitch + j];
-                            break;
-                        case FT_PIXEL_MODE_BGRA: {
-                            int ofs_color = i * bitmap.pitch + (j << 2);
-                            wr[ofs + 2] = bitmap.buffer[ofs_color + 0];
-                            wr[ofs + 1] = bitmap.buffer[ofs_color + 1];
-                            wr[ofs + 0] = bitmap.buffer[ofs_color + 2];
-                            wr[ofs + 3] = bitmap.buffer[ofs_color + 3];
-                        } break;
-                            // TODO: FT_PIXEL_MODE_LCD
-                        default:
-                            ERR_FAIL_V_MSG(Character::not_found(), "Font uses unsupported pixel format: " + itos(bitmap.pixel_mode) + ".");
-                            break;
-                        }
-                }
-            }
+        switch (font->hinting) {
+            case DynamicFontData::HINTING_NONE:
+                ft_hinting = FT_LOAD_NO_HINTING;
+                break;
+            case DynamicFontData::HINTING_LIGHT:
+                ft_hinting = FT_LOAD_TARGET_LIGHT;
+                break;
+            default:
+                ft_hinting = FT_LOAD_TARGET_NORMAL;
+                break;
         }
 
-        //blit to image and texture
-        {
+        RasterSettings settings;
+        settings.load_flags = FT_HAS_COLOR(face) ? FT_LOAD_COLOR : FT_LOAD_DEFAULT | (font->force_autohinter ? FT_LOAD_FORCE_AUTOHINT : 0) | ft_hinting;
+        settings.outline_size = id.outline_size;
+        settings.oversampling = oversampling;
+        settings.antialiased = font->antialiased;
+        settings.force_autohinter = font->force_autohinter;
+        return settings;
+    }
 
-            Ref<Image> img(make_ref_counted<Image>(tex.texture_size, tex.texture_size, 0, require_format, tex.imgdata));
+    Character _commit_glyph(const RasterizedGlyph &p_glyph) {
 
-            if (not tex.texture) {
-                tex.texture = make_ref_counted<ImageTexture>();
-                tex.texture->create_from_image(img, Texture::FLAG_VIDEO_SURFACE | fa->texture_flags);
-            }
-            else {
-                tex.texture->set_data(img); //update
-            }
+        if (!p_glyph.found) {
+            return Character::not_found();
         }
 
-        // update height array
+        Character chr;
+        chr.h_align = p_glyph.left * scale_color_font / oversampling;
+        chr.v_align = ascent - (p_glyph.top * scale_color_font / oversampling); // + ascent - descent;
+        chr.advance = p_glyph.advance * scale_color_font / oversampling;
+        chr.found = true;
 
-        for (int k = tex_pos.x; k < tex_pos.x + mw; k++) {
-            tex.offsets[k] = tex_pos.y + mh;
+        if (p_glyph.width == 0 || p_glyph.height == 0) {
+            chr.texture_idx = -1; // nothing to draw, e.g. whitespace
+            return chr;
         }
 
-        Character chr;
-        chr.h_align = xofs * fa->scale_color_font / fa->oversampling;
-        chr.v_align = fa->ascent - (yofs * fa->scale_color_font / fa->oversampling); // + ascent - descent;
-        chr.advance = advance * fa->scale_color_font / fa->oversampling;
-        chr.texture_idx = tex_pos.index;
-        chr.found = true;
+        const int margin = rect_margin;
+        const int mw = p_glyph.width + margin * 2;
+        const int mh = p_glyph.height + margin * 2;
 
-        chr.rect_uv = Rect2(tex_pos.x + fa->rect_margin, tex_pos.y + fa->rect_margin, w, h);
+        ERR_FAIL_COND_V(mw > ATLAS_PAGE_MAX_SIZE, Character::not_found());
+        ERR_FAIL_COND_V(mh > ATLAS_PAGE_MAX_SIZE, Character::not_found());
+
+        const int color_size = p_glyph.color_size;
+        Image::Format require_format = color_size == 4 ? ImageData::FORMAT_RGBA8 : ImageData::FORMAT_LA8;
+
+        DynamicFontData::GlyphAtlas *atlas = font->atlas;
+        DynamicFontData::GlyphAtlas::Allocation alloc;
+        {
+            MutexGuard atlas_guard(atlas->mutex);
+            alloc = atlas->allocate(require_format, color_size, texture_flags, mw, mh);
+            ERR_FAIL_COND_V(alloc.page < 0, Character::not_found());
+
+            //fit character in its atlas page
+            DynamicFontData::GlyphAtlas::Page *page = atlas->pages[alloc.page];
+            PoolVector<uint8_t>::Write wr = page->imgdata.write();
+            const int row_bytes = p_glyph.width * color_size;
+            for (int i = 0; i < p_glyph.height; i++) {
+                int ofs = ((i + alloc.y + margin) * page->size + alloc.x + margin) * color_size;
+                memcpy(&wr[ofs], &p_glyph.pixels[i * row_bytes], row_bytes);
+            }
+            chr.generation = page->generation;
+        }
+        font->_queue_atlas_flush();
+
+        chr.texture_idx = alloc.page;
+        chr.rect_uv = Rect2(alloc.x + margin, alloc.y + margin, p_glyph.width, p_glyph.height);
         chr.rect = chr.rect_uv;
-        chr.rect.position /= fa->oversampling;
-        chr.rect.size = chr.rect.size * fa->scale_color_font / fa->oversampling;
+        chr.rect.position /= oversampling;
+        chr.rect.size = chr.rect.size * scale_color_font / oversampling;
         return chr;
     }
+
+    const Character *_touch(const Character *p_chr) const {
+        if (p_chr->texture_idx >= 0) {
+            font->atlas->touch(p_chr->texture_idx);
+        }
+        return p_chr;
+    }
+
     const Pair<const Character *, ImplData *> _find_char_with_font(int32_t p_char, const Vector<Ref<DynamicFontAtSize> > &p_fallbacks) const {
         auto chr = char_map.find(p_char);
         ERR_FAIL_COND_V(chr== char_map.end(), (Pair<const Character *, ImplData *>(nullptr, nullptr)));
@@ -220,7 +530,7 @@ struct DynamicFontAtSize::ImplData
 
                 if (!fallback_chr->second.found)
                     continue;
-                return Pair<const Character *, ImplData *>(&fallback_chr->second, fb->m_impl);
+                return Pair<const Character *, ImplData *>(fb->m_impl->_touch(&fallback_chr->second), fb->m_impl);
             }
 
             //not found, try 0xFFFD to display 'not found'.
@@ -229,53 +539,38 @@ struct DynamicFontAtSize::ImplData
             ERR_FAIL_COND_V(chr == char_map.end(), (Pair<const Character *, ImplData *>(nullptr, nullptr)));
         }
 
-        return Pair<const Character *, ImplData *>(&chr->second, const_cast<ImplData *>(this));
+        return Pair<const Character *, ImplData *>(_touch(&chr->second), const_cast<ImplData *>(this));
     }
     void _update_char(int32_t p_char) {
 
-        if (char_map.contains(p_char))
-            return;
-
+        // Threads drawing with the same size share char_map, every change to it happens under this lock.
         _THREAD_SAFE_METHOD_;
 
-        Character character = Character::not_found();
-
-        FT_GlyphSlot slot = face->glyph;
-
-        if (FT_Get_Char_Index(face, p_char) == 0) {
-            char_map[p_char] = character;
-            return;
+        if (precache_ready.load(std::memory_order_acquire)) {
+            _commit_precached();
         }
 
-        int ft_hinting;
-
-        switch (font->hinting) {
-            case DynamicFontData::HINTING_NONE:
-                ft_hinting = FT_LOAD_NO_HINTING;
-                break;
-            case DynamicFontData::HINTING_LIGHT:
-                ft_hinting = FT_LOAD_TARGET_LIGHT;
-                break;
-            default:
-                ft_hinting = FT_LOAD_TARGET_NORMAL;
-                break;
-        }
-
-        int error = FT_Load_Char(face, p_char, FT_HAS_COLOR(face) ? FT_LOAD_COLOR : FT_LOAD_DEFAULT | (font->force_autohinter ? FT_LOAD_FORCE_AUTOHINT : 0) | ft_hinting);
-        if (error) {
-            char_map[p_char] = character;
-            return;
+        auto iter = char_map.find(p_char);
+        if (iter != char_map.end()) {
+            const Character &chr = iter->second;
+            if (chr.texture_idx < 0) {
+                return;
+            }
+            {
+                MutexGuard atlas_guard(font->atlas->mutex);
+                if (font->atlas->pages[chr.texture_idx]->generation == chr.generation)
+                    return;
+            }
+            char_map.erase(iter); // its atlas page was recycled, rasterize it again
         }
 
-        if (id.outline_size > 0) {
-            character = _make_outline_char(p_char);
-        } else {
-            error = FT_Render_Glyph(face->glyph, font->antialiased ? FT_RENDER_MODE_NORMAL : FT_RENDER_MODE_MONO);
-            if (!error)
-                character = _bitmap_to_character(this,slot->bitmap, slot->bitmap_top, slot->bitmap_left, slot->advance.x / 64.0f);
-        }
+        RasterizedGlyph glyph;
+        const uint64_t start = OS::get_singleton()->get_ticks_usec();
+        _rasterize_glyph(library, face, _get_raster_settings(), p_char, glyph);
+        font->atlas->rasterize_usec += OS::get_singleton()->get_ticks_usec() - start;
+        font->atlas->glyphs_rasterized++;
 
-        char_map[p_char] = character;
+        char_map[p_char] = _commit_glyph(glyph);
     }
     float _get_kerning_advance(int32_t p_char, int32_t p_next) const
     {
@@ -289,129 +584,149 @@ struct DynamicFontAtSize::ImplData
 
         return advance;
     }
-    Character _make_outline_char(int32_t p_char) {
-        Character ret = Character::not_found();
 
-        if (FT_Load_Char(face, p_char, FT_LOAD_NO_BITMAP | (font->force_autohinter ? FT_LOAD_FORCE_AUTOHINT : 0)) != 0)
-            return ret;
+    static void _precache_thread_func(void *p_userdata) {
 
-        FT_Stroker stroker;
-        if (FT_Stroker_New(library, &stroker) != 0)
-            return ret;
+        ImplData *self = static_cast<ImplData *>(p_userdata);
+        DynamicFontData::GlyphAtlas *atlas = self->font->atlas;
 
-        FT_Stroker_Set(stroker, (int)(id.outline_size * oversampling * 64.0f), FT_STROKER_LINECAP_BUTT, FT_STROKER_LINEJOIN_ROUND, 0);
-        FT_Glyph glyph;
-        FT_BitmapGlyph glyph_bitmap;
+        FT_Library thread_library;
+        FT_Face thread_face;
+        FT_StreamRec thread_stream;
+        float scale_color_font;
+        if (FT_Init_FreeType(&thread_library) != 0) {
+            return;
+        }
+        if (self->_open_face(thread_library, thread_stream, thread_face, scale_color_font) != 0) {
+            FT_Done_FreeType(thread_library);
+            return;
+        }
 
-        if (FT_Get_Glyph(face->glyph, &glyph) != 0)
-            goto cleanup_stroker;
-        if (FT_Glyph_Stroke(&glyph, stroker, 1) != 0)
-            goto cleanup_glyph;
-        if (FT_Glyph_To_Bitmap(&glyph, FT_RENDER_MODE_NORMAL, nullptr, 1) != 0)
-            goto cleanup_glyph;
+        for (int32_t c : self->precache_chars) {
 
-        glyph_bitmap = (FT_BitmapGlyph)glyph;
-        ret = _bitmap_to_character(this,glyph_bitmap->bitmap, glyph_bitmap->top, glyph_bitmap->left, glyph->advance.x / 65536.0f);
+            if (self->precache_abort.load(std::memory_order_relaxed)) {
+                break;
+            }
 
-    cleanup_glyph:
-        FT_Done_Glyph(glyph);
-    cleanup_stroker:
-        FT_Stroker_Done(stroker);
-        return ret;
-    }
+            RasterizedGlyph glyph;
+            const uint64_t start = OS::get_singleton()->get_ticks_usec();
+            _rasterize_glyph(thread_library, thread_face, self->precache_settings, c, glyph);
+            atlas->rasterize_usec += OS::get_singleton()->get_ticks_usec() - start;
+            atlas->glyphs_rasterized++;
 
-    TexturePosition _find_texture_pos_for_glyph(int p_color_size, Image::Format p_image_format, int p_width, int p_height) {
-        TexturePosition ret;
-        ret.index = -1;
-        ret.x = 0;
-        ret.y = 0;
+            MutexGuard guard(self->precache_mutex);
+            self->precached.emplace_back(eastl::move(glyph));
+            self->precache_ready.store(true, std::memory_order_release);
+        }
 
-        int mw = p_width;
-        int mh = p_height;
+        FT_Done_FreeType(thread_library); // also releases thread_face
+    }
 
-        for (int i = 0; i < textures.size(); i++) {
+    void _commit_precached() {
 
-            const CharTexture &ct = textures[i];
+        _THREAD_SAFE_METHOD_;
 
-            if (ct.texture->get_format() != p_image_format)
-                continue;
+        Vector<RasterizedGlyph> glyphs;
+        {
+            MutexGuard guard(precache_mutex);
+            glyphs.swap(precached);
+            precache_ready.store(false, std::memory_order_relaxed);
+        }
 
-            if (mw > ct.texture_size || mh > ct.texture_size) //too big for this texture
-                continue;
+        for (const RasterizedGlyph &glyph : glyphs) {
+            if (!char_map.contains(glyph.code)) {
+                char_map[glyph.code] = _commit_glyph(glyph);
+            }
+        }
+    }
 
-            ret.y = 0x7FFFFFFF;
-            ret.x = 0;
+    void _finish_precache(bool p_discard) {
 
-            for (int j = 0; j < ct.texture_size - mw; j++) {
+        if (precache_thread.is_started()) {
+            precache_abort.store(p_discard);
+            precache_thread.wait_to_finish();
+            precache_chars.clear();
+        }
 
-                int max_y = 0;
+        if (p_discard) {
+            MutexGuard guard(precache_mutex);
+            precached.clear();
+            precache_ready.store(false);
+        } else if (precache_ready.load(std::memory_order_acquire)) {
+            _commit_precached();
+        }
+    }
 
-                for (int k = j; k < j + mw; k++) {
+    void precache(const Vector<int32_t> &p_chars, bool p_threaded) {
 
-                    int y = ct.offsets[k];
-                    if (y > max_y)
-                        max_y = y;
-                }
+        if (!valid) {
+            return;
+        }
 
-                if (max_y < ret.y) {
-                    ret.y = max_y;
-                    ret.x = j;
-                }
-            }
+        _finish_precache(false);
 
-            if (ret.y == 0x7FFFFFFF || ret.y + mh > ct.texture_size)
-                continue; //fail, could not fit it here
+        Vector<int32_t> missing;
+        for (int32_t c : p_chars) {
+            if (!char_map.contains(c)) {
+                missing.push_back(c);
+            }
+        }
+        eastl::sort(missing.begin(), missing.end());
+        missing.erase(eastl::unique(missing.begin(), missing.end()), missing.end());
 
-            ret.index = i;
-            break;
+        if (missing.empty()) {
+            return;
         }
 
-        if (ret.index == -1) {
-            //could not find texture to fit, create one
-            ret.x = 0;
-            ret.y = 0;
+        if (!p_threaded) {
+            for (int32_t c : missing) {
+                _update_char(c);
+            }
+            return;
+        }
 
-            int texsize = M_MAX(id.size * oversampling * 8, 256);
-            if (mw > texsize)
-                texsize = mw; //special case, adapt to it?
-            if (mh > texsize)
-                texsize = mh; //special case, adapt to it?
+        precache_chars = eastl::move(missing);
+        precache_settings = _get_raster_settings();
+        precache_abort.store(false);
+        precache_thread.start(_precache_thread_func, this);
+    }
 
-            texsize = next_power_of_2(texsize);
+    // Opens the font data on p_library and selects the pixel size, both for the main face and for precache threads.
+    int _open_face(FT_Library p_library, FT_StreamRec &r_stream, FT_Face &r_face, float &r_scale_color_font) const {
 
-            texsize = MIN(texsize, 4096);
+        memset(&r_stream, 0, sizeof(FT_StreamRec));
+        r_stream.base = (unsigned char *)font->font_mem;
+        r_stream.size = font->font_mem_size;
+        r_stream.pos = 0;
 
-            CharTexture tex;
-            tex.texture_size = texsize;
-            tex.imgdata.resize(texsize * texsize * p_color_size); //grayscale alpha
+        FT_Open_Args fargs;
+        memset(&fargs, 0, sizeof(FT_Open_Args));
+        fargs.memory_base = (unsigned char *)font->font_mem;
+        fargs.memory_size = font->font_mem_size;
+        fargs.flags = FT_OPEN_MEMORY;
+        fargs.stream = &r_stream;
+        int error = FT_Open_Face(p_library, &fargs, 0, &r_face);
+        if (error) {
+            return error;
+        }
 
-            {
-                // zero texture
-                PoolVector<uint8_t>::Write w = tex.imgdata.write();
-                ERR_FAIL_COND_V(texsize * texsize * p_color_size > tex.imgdata.size(), ret);
-                // Initialize the texture to all-white pixels to prevent artifacts when the
-                // font is displayed at a non-default scale with filtering enabled.
-                if (p_color_size == 2) {
-                    for (int i = 0; i < texsize * texsize * p_color_size; i += 2) {
-                        w[i + 0] = 255;
-                        w[i + 1] = 0;
-                    }
-                } else {
-                    for (int i = 0; i < texsize * texsize * p_color_size; i += 4) {
-                        w[i + 0] = 255;
-                        w[i + 1] = 255;
-                        w[i + 2] = 255;
-                        w[i + 3] = 0;
-                    }
+        if (FT_HAS_COLOR(r_face) && r_face->num_fixed_sizes > 0) {
+            int best_match = 0;
+            int diff = ABS(id.size - ((int64_t)r_face->available_sizes[0].width));
+            r_scale_color_font = float(id.size * oversampling) / r_face->available_sizes[0].width;
+            for (int i = 1; i < r_face->num_fixed_sizes; i++) {
+                int ndiff = ABS(id.size - ((int64_t)r_face->available_sizes[i].width));
+                if (ndiff < diff) {
+                    best_match = i;
+                    diff = ndiff;
+                    r_scale_color_font = float(id.size * oversampling) / r_face->available_sizes[i].width;
                 }
             }
-            tex.offsets.resize(texsize,0); //zero offsets
-
-            textures.push_back(tex);
-            ret.index = textures.size() - 1;
+            FT_Select_Size(r_face, best_match);
+        } else {
+            FT_Set_Pixel_Sizes(r_face, 0, id.size * oversampling);
         }
-
-        return ret;
+        return 0;
     }
 
     Error load() {
@@ -435,19 +750,7 @@ struct DynamicFontAtSize::ImplData
         }
 
         if (font->font_mem) {
-            memset(&stream, 0, sizeof(FT_StreamRec));
-            stream.base = (unsigned char *)font->font_mem;
-            stream.size = font->font_mem_size;
-            stream.pos = 0;
-
-            FT_Open_Args fargs;
-            memset(&fargs, 0, sizeof(FT_Open_Args));
-            fargs.memory_base = (unsigned char *)font->font_mem;
-            fargs.memory_size = font->font_mem_size;
-            fargs.flags = FT_OPEN_MEMORY;
-            fargs.stream = &stream;
-            error = FT_Open_Face(library, &fargs, 0, &face);
-
+            error = _open_face(library, stream, face, scale_color_font);
         } else {
             FT_Done_FreeType(library);
             ERR_FAIL_V_MSG(ERR_UNCONFIGURED, "DynamicFont uninitialized.");
@@ -466,23 +769,6 @@ struct DynamicFontAtSize::ImplData
 
         ERR_FAIL_COND_V(error, ERR_FILE_CANT_OPEN);
 
-        if (FT_HAS_COLOR(face) && face->num_fixed_sizes > 0) {
-            int best_match = 0;
-            int diff = ABS(id.size - ((int64_t)face->available_sizes[0].width));
-            scale_color_font = float(id.size * oversampling) / face->available_sizes[0].width;
-            for (int i = 1; i < face->num_fixed_sizes; i++) {
-                int ndiff = ABS(id.size - ((int64_t)face->available_sizes[i].width));
-                if (ndiff < diff) {
-                    best_match = i;
-                    diff = ndiff;
-                    scale_color_font = float(id.size * oversampling) / face->available_sizes[i].width;
-                }
-            }
-            FT_Select_Size(face, best_match);
-        } else {
-            FT_Set_Pixel_Sizes(face, 0, id.size * oversampling);
-        }
-
         ascent = (face->size->metrics.ascender / 64.0f) / oversampling * scale_color_font;
         descent = (-face->size->metrics.descender / 64.0f) / oversampling * scale_color_font;
         linegap = 0;
@@ -495,6 +781,11 @@ struct DynamicFontAtSize::ImplData
         valid = true;
         return OK;
     }
+    void clear_chars(uint32_t p_texture_flags) {
+        _THREAD_SAFE_METHOD_;
+        texture_flags = p_texture_flags;
+        char_map.clear();
+    }
     void update_oversampling() {
         if (!valid) {
             return;
@@ -504,9 +795,12 @@ struct DynamicFontAtSize::ImplData
             return;
         }
 
+        _finish_precache(true);
         FT_Done_FreeType(library);
-        textures.clear();
-        char_map.clear();
+        {
+            _THREAD_SAFE_METHOD_;
+            char_map.clear();
+        }
         oversampling = new_oversampling;
         valid = false;
         load();
@@ -523,6 +817,7 @@ struct DynamicFontAtSize::ImplData
         scale_color_font = 1;
     }
     ~ImplData() {
+        _finish_precache(true);
         if (valid) {
             FT_Done_FreeType(library);
         }
@@ -549,6 +844,73 @@ Ref<DynamicFontAtSize> DynamicFontData::_get_dynamic_font_at_size(CacheID p_cach
     return dfas;
 }
 
+void DynamicFontData::_queue_atlas_flush() {
+
+    {
+        MutexGuard guard(atlas->mutex);
+        if (atlas->flush_queued) {
+            return;
+        }
+        atlas->flush_queued = true;
+        if (MessageQueue::get_singleton()) {
+            MessageQueue::get_singleton()->push_call(get_instance_id(), [this]() { _flush_atlas(); });
+            return;
+        }
+    }
+    _flush_atlas();
+}
+
+void DynamicFontData::_flush_atlas() {
+
+    bool evicted;
+    {
+        MutexGuard guard(atlas->mutex);
+        atlas->flush_queued = false;
+        for (GlyphAtlas::Page *page : atlas->pages) {
+            if (!page->dirty) {
+                continue;
+            }
+            page->texture->set_data(make_ref_counted<Image>(page->size, page->size, false, page->format, page->imgdata));
+            page->dirty = false;
+            atlas->uploads++;
+        }
+        evicted = atlas->evicted;
+        atlas->evicted = false;
+    }
+
+    if (evicted) {
+        // Canvas items still drawing glyphs from a recycled page have to redraw to pick up their new location.
+        // Called without the atlas lock, redrawing takes the locks of the sizes.
+        DynamicFont::_font_data_changed(this);
+    }
+}
+
+Dictionary DynamicFontData::get_atlas_stats() const {
+
+    int glyphs = 0;
+    int64_t used_area = 0;
+    int64_t total_area = 0;
+    int64_t texture_bytes = 0;
+    MutexGuard guard(atlas->mutex);
+    for (const GlyphAtlas::Page *page : atlas->pages) {
+        glyphs += page->glyph_count;
+        used_area += page->used_area;
+        total_area += int64_t(page->size) * page->size;
+        texture_bytes += page->imgdata.size();
+    }
+
+    Dictionary stats;
+    stats["pages"] = atlas->pages.size();
+    stats["glyphs"] = glyphs;
+    stats["occupancy"] = total_area ? float(double(used_area) / total_area) : 0.0f;
+    stats["texture_bytes"] = texture_bytes;
+    stats["uploads"] = int64_t(atlas->uploads);
+    stats["evictions"] = int64_t(atlas->evictions);
+    stats["rasterized_glyphs"] = int64_t(atlas->glyphs_rasterized.load());
+    stats["rasterize_msec"] = atlas->rasterize_usec.load() / 1000.0;
+    return stats;
+}
+
 void DynamicFontData::set_font_ptr(const uint8_t *p_font_mem, int p_font_mem_size) {
 
     font_mem = p_font_mem;
@@ -591,6 +953,7 @@ void DynamicFontData::_bind_methods() {
 
     SE_BIND_METHOD(DynamicFontData,get_override_oversampling);
     SE_BIND_METHOD(DynamicFontData,set_override_oversampling);
+    SE_BIND_METHOD(DynamicFontData,get_atlas_stats);
     ADD_PROPERTY(PropertyInfo(VariantType::BOOL, "antialiased"), "set_antialiased", "is_antialiased");
     ADD_PROPERTY(PropertyInfo(VariantType::INT, "hinting", PropertyHint::Enum, "None,Light,Normal"), "set_hinting", "get_hinting");
     ADD_PROPERTY(PropertyInfo(VariantType::FLOAT, "override_oversampling"), "set_override_oversampling", "get_override_oversampling");
@@ -610,9 +973,11 @@ DynamicFontData::DynamicFontData() {
     hinting = DynamicFontData::HINTING_NORMAL;
     font_mem = nullptr;
     font_mem_size = 0;
+    atlas = memnew(GlyphAtlas);
 }
 
 DynamicFontData::~DynamicFontData() {
+    memdelete(atlas);
 }
 
 ////////////////////
@@ -691,12 +1056,12 @@ UIString DynamicFontAtSize::get_available_chars() const {
 
 void DynamicFontAtSize::set_texture_flags(uint32_t p_flags) {
 
-    m_impl->texture_flags = p_flags;
-    for (size_t i = 0; i < m_impl->textures.size(); i++) {
-        Ref<ImageTexture> &tex = m_impl->textures[i].texture;
-        if (tex)
-            tex->set_flags(p_flags);
+    if (m_impl->texture_flags == p_flags) {
+        return;
     }
+    // Atlas pages are shared per flag combination, so glyphs move to matching pages as they are requested again.
+    m_impl->_finish_precache(true);
+    m_impl->clear_chars(p_flags);
 }
 
 float DynamicFontAtSize::draw_char(RenderingEntity p_canvas_item, const Point2 &p_pos, CharType p_char, CharType p_next,
@@ -726,20 +1091,14 @@ float DynamicFontAtSize::draw_char(RenderingEntity p_canvas_item, const Point2 &
     float advance = 0.0;
     // use normal character size if there's no outline charater
     if (p_outline && !ch->found) {
-        FT_GlyphSlot slot = m_impl->face->glyph;
-        int error = FT_Load_Char(
-                m_impl->face, c, FT_HAS_COLOR(m_impl->face) ? FT_LOAD_COLOR : FT_LOAD_DEFAULT);
+        // Only the advance is needed, so the glyph is loaded but not rendered into the atlas.
+        int error = FT_Load_Char(m_impl->face, c, FT_HAS_COLOR(m_impl->face) ? FT_LOAD_COLOR : FT_LOAD_DEFAULT);
         if (!error) {
-            error = FT_Render_Glyph(m_impl->face->glyph, FT_RENDER_MODE_NORMAL);
-            if (!error) {
-                ImplData::Character character = m_impl->_bitmap_to_character(const_cast<ImplData *>(m_impl),
-                        slot->bitmap, slot->bitmap_top, slot->bitmap_left, slot->advance.x / 64.0f);
-                advance = character.advance;
-            }
+            advance = (m_impl->face->glyph->advance.x / 64.0f) * m_impl->scale_color_font / m_impl->oversampling;
         }
     }
     if (ch->found) {
-        ERR_FAIL_COND_V(ch->texture_idx < -1 || ch->texture_idx >= font->textures.size(), 0);
+        ERR_FAIL_COND_V(ch->texture_idx < -1 || ch->texture_idx >= font->_get_texture_count(), 0);
 
         if (!p_advance_only && ch->texture_idx != -1) {
             Point2 cpos = p_pos;
@@ -750,7 +1109,7 @@ float DynamicFontAtSize::draw_char(RenderingEntity p_canvas_item, const Point2 &
             if (FT_HAS_COLOR(m_impl->face)) {
                 modulate.r = modulate.g = modulate.b = 1.0f;
             }
-            RenderingEntity texture = font->textures[ch->texture_idx].texture->get_rid();
+            RenderingEntity texture = font->_get_texture(ch->texture_idx)->get_rid();
             RenderingServer::get_singleton()->canvas_item_add_texture_rect_region(p_canvas_item,
                     Rect2(cpos, ch->rect.size), texture, ch->rect_uv, modulate, false, entt::null, false);
         }
@@ -785,10 +1144,10 @@ RenderingEntity DynamicFontAtSize::get_char_texture(CharType p_char, CharType p_
 
     ERR_FAIL_COND_V(!ch, entt::null);
     if (ch->found) {
-        ERR_FAIL_COND_V(ch->texture_idx < -1 || ch->texture_idx >= font->textures.size(), entt::null);
+        ERR_FAIL_COND_V(ch->texture_idx < -1 || ch->texture_idx >= font->_get_texture_count(), entt::null);
 
         if (ch->texture_idx != -1) {
-            return font->textures[ch->texture_idx].texture->get_rid();
+            return font->_get_texture(ch->texture_idx)->get_rid();
         }
     }
     return entt::null;
@@ -816,10 +1175,10 @@ Size2 DynamicFontAtSize::get_char_texture_size(CharType p_char, CharType p_next,
 
     ERR_FAIL_COND_V(!ch, Size2());
     if (ch->found) {
-        ERR_FAIL_COND_V(ch->texture_idx < -1 || ch->texture_idx >= font->textures.size(), Size2());
+        ERR_FAIL_COND_V(ch->texture_idx < -1 || ch->texture_idx >= font->_get_texture_count(), Size2());
 
         if (ch->texture_idx != -1) {
-            return font->textures[ch->texture_idx].texture->get_size();
+            return font->_get_texture(ch->texture_idx)->get_size();
         }
     }
     return Size2();
@@ -908,6 +1267,10 @@ Rect2 DynamicFontAtSize::get_char_tx_uv_rect(CharType p_char, CharType p_next, c
     return Rect2();
 }
 
+void DynamicFontAtSize::precache(const Vector<int32_t> &p_chars, bool p_threaded) {
+    m_impl->precache(p_chars, p_threaded);
+}
+
 void DynamicFontAtSize::update_oversampling() {
     m_impl->update_oversampling();
 }
@@ -1289,6 +1652,23 @@ CharContour DynamicFontAtSize::get_char_contours(CharType p_char, CharType p_nex
     }
 }
 
+void DynamicFont::precache(StringView p_chars, bool p_threaded) {
+
+    if (!data_at_size) {
+        return;
+    }
+
+    Vector<int32_t> chars;
+    for (uint c : StringUtils::from_utf8(p_chars).toUcs4()) {
+        chars.push_back(c);
+    }
+
+    data_at_size->precache(chars, p_threaded);
+    if (outline_data_at_size) {
+        outline_data_at_size->precache(chars, p_threaded);
+    }
+}
+
 CharContour DynamicFont::get_char_contours(CharType p_char, CharType p_next) const {
     if (!data_at_size) {
         return CharContour();
@@ -1392,6 +1772,7 @@ void DynamicFont::_bind_methods() {
     SE_BIND_METHOD(DynamicFont,get_font_data);
 
     SE_BIND_METHOD(DynamicFont,get_available_chars);
+    MethodBinder::bind_method(D_METHOD("precache", {"chars", "threaded"}), &DynamicFont::precache, {DEFVAL(true)});
 
     SE_BIND_METHOD(DynamicFont,set_size);
     SE_BIND_METHOD(DynamicFont,get_size);
@@ -1465,6 +1846,29 @@ void DynamicFont::finish_dynamic_fonts() {
     dynamic_fonts.clear();
 }
 
+void DynamicFont::_font_data_changed(const DynamicFontData *p_data) {
+
+    Vector<Ref<DynamicFont> > changed;
+
+    {
+        MutexGuard guard(dynamic_font_mutex);
+
+        for (DynamicFont *fnt : dynamic_fonts) {
+            bool uses_data = fnt->data.get() == p_data;
+            for (const Ref<DynamicFontData> &fallback : fnt->fallbacks) {
+                uses_data = uses_data || fallback.get() == p_data;
+            }
+            if (uses_data) {
+                changed.emplace_back(Ref<DynamicFont>(fnt));
+            }
+        }
+    }
+
+    for (const Ref<DynamicFont> &c : changed) {
+        c->emit_changed();
+    }
+}
+
 void DynamicFont::update_oversampling() {
 
     Vector<Ref<DynamicFont> > changed;
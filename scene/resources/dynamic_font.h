@@ -42,6 +42,7 @@
 class DynamicFontAtSize;
 class DynamicFont;
 class ImageTexture;
+class Dictionary;
 
 class GODOT_EXPORT DynamicFontData : public Resource {
 
@@ -96,11 +97,16 @@ private:
     String font_path;
     HashMap<CacheID, DynamicFontAtSize *> size_cache;
 
+    struct GlyphAtlas;
+    GlyphAtlas *atlas;
+
     friend class DynamicFontAtSize;
 
     friend class DynamicFont;
 
     Ref<DynamicFontAtSize> _get_dynamic_font_at_size(CacheID p_cache_id);
+    void _queue_atlas_flush();
+    void _flush_atlas();
 
 protected:
     static void _bind_methods();
@@ -113,6 +119,9 @@ public:
 
     float get_override_oversampling() const;
     void set_override_oversampling(float p_oversampling);
+
+    Dictionary get_atlas_stats() const;
+
     DynamicFontData();
     ~DynamicFontData() override;
 };
@@ -152,6 +161,7 @@ public:
 
 
     void set_texture_flags(uint32_t p_flags);
+    void precache(const Vector<int32_t> &p_chars, bool p_threaded);
     void update_oversampling();
 
     CharContour get_char_contours(CharType p_char, CharType p_next, const Vector<Ref<DynamicFontAtSize>> &p_fallbacks) const;
@@ -193,6 +203,9 @@ private:
 
     Color outline_color;
 
+    friend class DynamicFontData;
+    static void _font_data_changed(const DynamicFontData *p_data);
+
 protected:
     void _reload_cache(const char *p_triggering_property = "");
 
@@ -238,6 +251,8 @@ public:
     Size2 get_char_size(CharType p_char, CharType p_next = 0) const override;
     String get_available_chars() const;
 
+    void precache(StringView p_chars, bool p_threaded = true);
+
     bool is_distance_field_hint() const override;
 
     bool has_outline() const override;
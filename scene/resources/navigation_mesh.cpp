@@ -277,6 +277,15 @@ bool NavigationMesh::get_filter_walkable_low_height_spans() const {
     return filter_walkable_low_height_spans;
 }
 
+void NavigationMesh::set_tile_size(int p_value) {
+    ERR_FAIL_COND(p_value < 0);
+    tile_size = p_value;
+}
+
+int NavigationMesh::get_tile_size() const {
+    return tile_size;
+}
+
 void NavigationMesh::set_vertices(Vector<Vector3> &&p_vertices) {
 
     vertices = eastl::move(p_vertices);
@@ -471,6 +480,9 @@ void NavigationMesh::_bind_methods() {
     SE_BIND_METHOD(NavigationMesh,set_filter_walkable_low_height_spans);
     SE_BIND_METHOD(NavigationMesh,get_filter_walkable_low_height_spans);
 
+    SE_BIND_METHOD(NavigationMesh,set_tile_size);
+    SE_BIND_METHOD(NavigationMesh,get_tile_size);
+
     SE_BIND_METHOD(NavigationMesh,set_vertices);
     SE_BIND_METHOD(NavigationMesh,get_vertices);
 
@@ -511,6 +523,7 @@ void NavigationMesh::_bind_methods() {
     ADD_PROPERTY(PropertyInfo(VariantType::BOOL, "filter/low_hanging_obstacles"), "set_filter_low_hanging_obstacles", "get_filter_low_hanging_obstacles");
     ADD_PROPERTY(PropertyInfo(VariantType::BOOL, "filter/ledge_spans"), "set_filter_ledge_spans", "get_filter_ledge_spans");
     ADD_PROPERTY(PropertyInfo(VariantType::BOOL, "filter/filter_walkable_low_height_spans"), "set_filter_walkable_low_height_spans", "get_filter_walkable_low_height_spans");
+    ADD_PROPERTY(PropertyInfo(VariantType::INT, "tile/size", PropertyHint::Range, "0,1024,1,or_greater"), "set_tile_size", "get_tile_size");
     BIND_ENUM_CONSTANT(SAMPLE_PARTITION_WATERSHED);
     BIND_ENUM_CONSTANT(SAMPLE_PARTITION_MONOTONE);
     BIND_ENUM_CONSTANT(SAMPLE_PARTITION_LAYERS);
@@ -557,6 +570,7 @@ NavigationMesh::NavigationMesh() {
     verts_per_poly = 6.0f;
     detail_sample_distance = 6.0f;
     detail_sample_max_error = 5.0f;
+    tile_size = 0;
 
     partition_type = SAMPLE_PARTITION_WATERSHED;
     parsed_geometry_type = PARSED_GEOMETRY_MESH_INSTANCES;
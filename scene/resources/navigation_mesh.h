@@ -45,6 +45,8 @@ class GODOT_EXPORT NavigationMesh : public Resource {
     };
     Vector<Polygon> polygons;
     Ref<ArrayMesh> debug_mesh;
+    // Tiles of the last tiled bake, owned by the generator and kept so unchanged tiles are not built again.
+    Ref<RefCounted> bake_cache;
 
     struct _EdgeKey {
 
@@ -99,6 +101,7 @@ protected:
     float verts_per_poly;
     float detail_sample_distance;
     float detail_sample_max_error;
+    int tile_size;
 
     uint32_t collision_mask;
 
@@ -178,6 +181,12 @@ public:
     void set_filter_walkable_low_height_spans(bool p_value);
     bool get_filter_walkable_low_height_spans() const;
 
+    void set_tile_size(int p_value);
+    int get_tile_size() const;
+
+    void set_bake_cache(const Ref<RefCounted> &p_cache) { bake_cache = p_cache; }
+    const Ref<RefCounted> &get_bake_cache() const { return bake_cache; }
+
     void create_from_mesh(const Ref<Mesh> &p_mesh);
 
     void set_vertices(Vector<Vector3> &&p_vertices);
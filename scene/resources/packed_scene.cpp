@@ -35,6 +35,7 @@
 #include "core/core_string_names.h"
 #include "core/engine.h"
 #include "core/method_bind.h"
+#include "core/object_tooling.h"
 #include "core/pair.h"
 #include "core/pool_vector.h"
 #include "core/project_settings.h"
@@ -137,6 +138,83 @@ bool SceneState::can_instance() const {
 
     return !nodes.empty();
 }
+
+// Swaps a local_to_scene resource for the copy owned by the scene being instanced, creating it on first use.
+static void _resolve_local_to_scene(Variant &r_value, PackedGenEditState p_edit_state, Node *p_base, Map<Ref<Resource>, Ref<Resource> > &resources_local_to_scene) {
+
+    Ref<Resource> res(r_value);
+    if (!res || !res->is_local_to_scene())
+        return;
+
+    Map<Ref<Resource>, Ref<Resource> >::const_iterator E = resources_local_to_scene.find(res);
+    if (E != resources_local_to_scene.end()) {
+        r_value = E->second;
+        return;
+    }
+
+    if (p_edit_state == GEN_EDIT_STATE_MAIN || p_edit_state == GEN_EDIT_STATE_MAIN_INHERITED) {
+        //for the main scene, use the resource as is
+        res->configure_for_local_scene(p_base, resources_local_to_scene);
+        resources_local_to_scene[res] = res;
+    } else {
+        //for instances, a copy must be made
+        Ref<Resource> local_dupe = res->duplicate_for_local_scene(p_base, resources_local_to_scene);
+        resources_local_to_scene[res] = local_dupe;
+        r_value = local_dupe;
+    }
+}
+
+static void _set_script_keeping_state(Node *node, const StringName &p_name, const Variant &p_script) {
+    //work around to avoid old script variables from disappearing, should be the proper fix to:
+    //https://github.com/godotengine/godot/issues/2958
+
+    //store old state
+    Vector<Pair<StringName, Variant> > old_state;
+    if (node->get_script_instance()) {
+        node->get_script_instance()->get_property_state(old_state);
+    }
+
+    node->set(p_name, p_script);
+
+    //restore old state for new script, if exists
+    for (const Pair<StringName, Variant>& E : old_state) {
+        node->set(E.first, E.second);
+    }
+}
+
+static Node *_create_missing_type_placeholder(const StringName &p_name, const StringName &p_type, Node *p_parent) {
+
+    WARN_PRINT(FormatSN("Node %s of type %s cannot be created. A placeholder will be created instead.", p_name.asCString(), p_type.asCString()));
+    if (p_parent) {
+        if (object_cast<Node3D>(p_parent)) {
+            return memnew(Node3D);
+        } else if (object_cast<Control>(p_parent)) {
+            return memnew(Control);
+        } else if (object_cast<Node2D>(p_parent)) {
+            return memnew(Node2D);
+        }
+    }
+    return memnew(Node);
+}
+
+static Node *_instance_placeholder(const String &p_path, PackedGenEditState p_edit_state, bool p_disable_placeholders) {
+
+    Node *node;
+    if (p_disable_placeholders) {
+
+        Ref<PackedScene> sdata = dynamic_ref_cast<PackedScene>(gResourceManager().load(p_path, "PackedScene"));
+        ERR_FAIL_COND_V(not sdata, nullptr);
+        node = sdata->instance(p_edit_state == GEN_EDIT_STATE_DISABLED ? GEN_EDIT_STATE_DISABLED : GEN_EDIT_STATE_INSTANCE);
+        ERR_FAIL_COND_V(!node, nullptr);
+    } else {
+        InstancePlaceholder *ip = memnew(InstancePlaceholder);
+        ip->set_instance_path(p_path);
+        node = ip;
+    }
+    node->set_scene_instance_load_placeholder(true);
+    return node;
+}
+
 bool SceneState::handleProperties(PackedGenEditState p_edit_state, Node *node,Span<Node *> ret_nodes, const SceneState::NodeData &n, Map<Ref<Resource>, Ref<Resource> > & resources_local_to_scene) const {
     int nprop_count = n.properties.size();
     if (!nprop_count)
@@ -156,55 +234,14 @@ bool SceneState::handleProperties(PackedGenEditState p_edit_state, Node *node,Sp
         ERR_FAIL_INDEX_V(property.value, prop_count, false);
 
         if (names[property.name] == CoreStringNames::get_singleton()->_script) {
-            //work around to avoid old script variables from disappearing, should be the proper fix to:
-            //https://github.com/godotengine/godot/issues/2958
-
-            //store old state
-            Vector<Pair<StringName, Variant> > old_state;
-            if (node->get_script_instance()) {
-                node->get_script_instance()->get_property_state(old_state);
-            }
-
-            node->set(names[property.name], props[property.value], &valid);
-
-            //restore old state for new script, if exists
-            for (const Pair<StringName, Variant>& E : old_state) {
-                node->set(E.first, E.second);
-            }
+            _set_script_keeping_state(node, names[property.name], props[property.value]);
             continue;
         }
         Variant value = props[property.value];
 
         if (value.get_type() == VariantType::OBJECT) {
             //handle resources that are local to scene by duplicating them if needed
-            Ref<Resource> res(value);
-            if (res && res->is_local_to_scene()) {
-                Map<Ref<Resource>, Ref<Resource> >::const_iterator E = resources_local_to_scene.find(res);
-
-                if (E != resources_local_to_scene.end()) {
-                    value = E->second;
-                }
-                else {
-
-                    Node* base = i == 0 ? node : ret_nodes[0];
-
-                    if (p_edit_state == GEN_EDIT_STATE_MAIN || p_edit_state == GEN_EDIT_STATE_MAIN_INHERITED) {
-                        //for the main scene, use the resource as is
-                        res->configure_for_local_scene(base, resources_local_to_scene);
-                        resources_local_to_scene[res] = res;
-
-                    }
-                    else {
-                        //for instances, a copy must be made
-                        Node* base2 = i == 0 ? node : ret_nodes[0];
-                        Ref<Resource> local_dupe = res->duplicate_for_local_scene(base2, resources_local_to_scene);
-                        resources_local_to_scene[res] = local_dupe;
-                        res = local_dupe;
-                        value = local_dupe;
-                    }
-                }
-                //must make a copy, because this res is local to scene
-            }
+            _resolve_local_to_scene(value, p_edit_state, i == 0 ? node : ret_nodes[0], resources_local_to_scene);
         }
         else if (p_edit_state == GEN_EDIT_STATE_INSTANCE) {
             value = value.duplicate(true); // Duplicate arrays and dictionaries for the editor
@@ -228,8 +265,369 @@ void SceneState::handleConnections(int nc, Span<Node*> ret_nodes) const {
     }
 }
 
+struct SceneState::InstancePlan {
+
+    enum NodeKind : uint8_t {
+        NODE_CREATE, // belongs to this scene, built through a prebound creation_func
+        NODE_SUB_SCENE, // instance of another scene, replays that scene's own plan
+        NODE_INHERITED_ROOT, // root of an inherited scene
+        NODE_PLACEHOLDER, // InstancePlaceholder, or the real scene when placeholders are disabled
+        NODE_EXISTING, // created by a sub-scene, only modified here
+    };
+
+    enum PropertyKind : uint8_t {
+        PROPERTY_SETTER, // ClassDB setter resolved when the plan was built
+        PROPERTY_GENERIC, // Object::set, for scripted nodes and properties not known to ClassDB
+        PROPERTY_SCRIPT, // script assignment, keeps the previous script state around
+    };
+
+    struct Property {
+        const StringName *name;
+        const Variant *value;
+        MethodBind *setter;
+        int index;
+        PropertyKind kind;
+        bool resource; // may be local_to_scene, resolved per instance
+    };
+
+    struct PlanNode {
+        const ClassDB_ClassInfo *class_info;
+        const PackedScene *scene;
+        const Variant *placeholder_path;
+        const StringName *name;
+        const StringName *type;
+        int parent;
+        int owner;
+        int index;
+        int properties_begin;
+        int properties_end;
+        int groups_begin;
+        int groups_end;
+        NodeKind kind;
+        bool attach; // name, parent and index come from this scene
+    };
+
+    struct Connection {
+        int from;
+        int to;
+        const StringName *signal;
+        const StringName *method;
+        uint32_t flags;
+    };
+
+    Vector<PlanNode> nodes;
+    Vector<Property> properties;
+    Vector<const StringName *> groups;
+    Vector<Connection> connections;
+};
+
+bool SceneState::_build_instance_plan(InstancePlan &r_plan) const {
+
+    const int nc = nodes.size();
+    const int sname_count = names.size();
+    const int variant_count = variants.size();
+    if (nc == 0)
+        return false;
+
+    const StringName &script_name = CoreStringNames::get_singleton()->_script;
+    r_plan.nodes.reserve(nc);
+
+    for (int i = 0; i < nc; ++i) {
+        const NodeData &n = nodes[i];
+        InstancePlan::PlanNode pn;
+        pn.class_info = nullptr;
+        pn.scene = nullptr;
+        pn.placeholder_path = nullptr;
+        pn.type = nullptr;
+        pn.parent = n.parent;
+        pn.owner = n.owner;
+        pn.index = n.index;
+
+        // anything instance() would reject is left to it, so the error is reported the usual way
+        if (n.name < 0 || n.name >= sname_count)
+            return false;
+        if ((i == 0) != (n.parent == -1))
+            return false;
+        pn.name = &names[n.name];
+
+        if (i == 0 && base_scene_idx >= 0) {
+            if (base_scene_idx >= variant_count)
+                return false;
+            pn.kind = InstancePlan::NODE_INHERITED_ROOT;
+            Ref<PackedScene> sdata(variants[base_scene_idx]);
+            pn.scene = sdata.get();
+            if (!pn.scene)
+                return false;
+        } else if (n.instance >= 0) {
+            if ((n.instance & FLAG_MASK) >= variant_count)
+                return false;
+            if (n.instance & FLAG_INSTANCE_IS_PLACEHOLDER) {
+                pn.kind = InstancePlan::NODE_PLACEHOLDER;
+                pn.placeholder_path = &variants[n.instance & FLAG_MASK];
+            } else {
+                pn.kind = InstancePlan::NODE_SUB_SCENE;
+                Ref<PackedScene> sdata(variants[n.instance & FLAG_MASK]);
+                pn.scene = sdata.get();
+                if (!pn.scene)
+                    return false;
+            }
+        } else if (n.type == TYPE_INSTANCED) {
+            if (i == 0)
+                return false;
+            pn.kind = InstancePlan::NODE_EXISTING;
+        } else {
+            if (n.type < 0 || n.type >= sname_count)
+                return false;
+            pn.kind = InstancePlan::NODE_CREATE;
+            pn.type = &names[n.type];
+            pn.class_info = ClassDB::get_instancing_info(names[n.type]);
+            // missing or non-Node classes get a placeholder node and a warning on every instance, keep that behavior
+            if (!pn.class_info || !ClassDB::is_parent_class(pn.class_info->name, Node::get_class_static_name()))
+                return false;
+        }
+        pn.attach = n.instance >= 0 || n.type != TYPE_INSTANCED || i == 0;
+
+        pn.properties_begin = r_plan.properties.size();
+        // nodes coming from other scenes may carry scripts, and a script assigned here takes over
+        // every property after it, so only fresh nodes without a script get setters resolved up front
+        bool resolve_setters = pn.kind == InstancePlan::NODE_CREATE;
+        for (const NodeData::Property &property : n.properties) {
+            if (property.name < 0 || property.name >= sname_count || property.value < 0 || property.value >= variant_count)
+                return false;
+
+            InstancePlan::Property prop;
+            prop.name = &names[property.name];
+            prop.value = &variants[property.value];
+            prop.setter = nullptr;
+            prop.index = -1;
+            prop.kind = InstancePlan::PROPERTY_GENERIC;
+            prop.resource = prop.value->get_type() == VariantType::OBJECT;
+
+            if (*prop.name == script_name) {
+                prop.kind = InstancePlan::PROPERTY_SCRIPT;
+                resolve_setters = false;
+            } else if (resolve_setters) {
+                const ClassDB_PropertySetGet *psg = ClassDB::get_property_setget(pn.class_info->name, *prop.name);
+                if (psg && !psg->setter)
+                    continue; // read-only, Object::set would ignore it too
+                if (psg && psg->_setptr) {
+                    prop.kind = InstancePlan::PROPERTY_SETTER;
+                    prop.setter = psg->_setptr;
+                    prop.index = psg->index;
+                }
+            }
+            r_plan.properties.push_back(prop);
+        }
+        pn.properties_end = r_plan.properties.size();
+
+        pn.groups_begin = r_plan.groups.size();
+        for (int grp : n.groups) {
+            if (grp < 0 || grp >= sname_count)
+                return false;
+            r_plan.groups.push_back(&names[grp]);
+        }
+        pn.groups_end = r_plan.groups.size();
+
+        r_plan.nodes.push_back(pn);
+    }
+
+    r_plan.connections.reserve(connections.size());
+    for (const ConnectionData &c : connections) {
+        if (c.signal < 0 || c.signal >= sname_count || c.method < 0 || c.method >= sname_count)
+            return false;
+        r_plan.connections.push_back({ c.from, c.to, &names[c.signal], &names[c.method], uint32_t(ObjectNS::CONNECT_PERSIST | c.flags) });
+    }
+
+    return true;
+}
+
+const SceneState::InstancePlan *SceneState::_get_instance_plan() const {
+
+    MutexGuard guard(instance_plan_mutex);
+    if (instance_plan || instance_plan_failed)
+        return instance_plan;
+
+    InstancePlan *plan = memnew(InstancePlan);
+    if (!_build_instance_plan(*plan)) {
+        memdelete(plan);
+        instance_plan_failed = true;
+        return nullptr;
+    }
+    instance_plan = plan;
+    return instance_plan;
+}
+
+void SceneState::_clear_instance_plan() {
+
+    MutexGuard guard(instance_plan_mutex);
+    if (instance_plan) {
+        memdelete(instance_plan);
+        instance_plan = nullptr;
+    }
+    instance_plan_failed = false;
+}
+
+Node *SceneState::_instance_from_plan(const InstancePlan &p_plan) const {
+
+    const int nc = p_plan.nodes.size();
+    FixedVector<Node *, 1024, true> ret_nodes(nc);
+    Vector<Node *> stray_instances;
+    Map<Ref<Resource>, Ref<Resource> > resources_local_to_scene;
+
+    for (int i = 0; i < nc; ++i) {
+        const InstancePlan::PlanNode &pn = p_plan.nodes[i];
+
+        Node *parent = i != 0 ? nodeFromId(node_paths, ret_nodes, nc, pn.parent) : nullptr;
+#ifdef DEBUG_ENABLED
+        if (!parent && i != 0 && pn.parent & FLAG_ID_IS_PATH) {
+            WARN_PRINT("Parent path '" + (String)node_paths[pn.parent & FLAG_MASK] + "' for node '" + *pn.name + "' has vanished when instancing: '" + (String)get_path() + "'.");
+        }
+#endif
+        Node *node = nullptr;
+
+        switch (pn.kind) {
+            case InstancePlan::NODE_CREATE: {
+                Object *obj = pn.class_info->disabled ? nullptr : pn.class_info->creation_func();
+                node = object_cast<Node>(obj);
+                if (!node) {
+                    if (obj)
+                        memdelete(obj);
+                    node = _create_missing_type_placeholder(*pn.name, *pn.type, pn.parent >= 0 && pn.parent < nc ? ret_nodes[pn.parent] : nullptr);
+                }
+            } break;
+            case InstancePlan::NODE_SUB_SCENE:
+            case InstancePlan::NODE_INHERITED_ROOT: {
+                node = pn.scene->instance(GEN_EDIT_STATE_DISABLED);
+                ERR_FAIL_COND_V(!node, nullptr);
+            } break;
+            case InstancePlan::NODE_PLACEHOLDER: {
+                node = _instance_placeholder(pn.placeholder_path->as<String>(), GEN_EDIT_STATE_DISABLED, disable_placeholders);
+                ERR_FAIL_COND_V(!node, nullptr);
+            } break;
+            case InstancePlan::NODE_EXISTING: {
+                if (parent) {
+                    node = parent->_get_child_by_name(*pn.name);
+#ifdef DEBUG_ENABLED
+                    if (!node) {
+                        WARN_PRINT("Node '" + ret_nodes.front()->get_path_to(parent).asString() + "/" + *pn.name + "' was modified from inside an instance, but it has vanished.");
+                    }
+#endif
+                }
+            } break;
+        }
+
+        if (node) {
+            Node *base = i == 0 ? node : ret_nodes[0];
+
+            //properties
+            bool set_by_setter = false;
+            for (int p = pn.properties_begin; p < pn.properties_end; ++p) {
+                const InstancePlan::Property &prop = p_plan.properties[p];
+                if (prop.kind == InstancePlan::PROPERTY_SCRIPT) {
+                    _set_script_keeping_state(node, *prop.name, *prop.value);
+                    continue;
+                }
+
+                const Variant *value = prop.value;
+                Variant local_value;
+                if (prop.resource) {
+                    local_value = *prop.value;
+                    _resolve_local_to_scene(local_value, GEN_EDIT_STATE_DISABLED, base, resources_local_to_scene);
+                    value = &local_value;
+                }
+
+                if (prop.kind == InstancePlan::PROPERTY_GENERIC) {
+                    node->set(*prop.name, *value);
+                    continue;
+                }
+
+                Callable::CallError ce;
+                if (prop.index >= 0) {
+                    Variant index = prop.index;
+                    const Variant *args[2] = { &index, value };
+                    prop.setter->call(node, args, 2, ce);
+                } else {
+                    const Variant *args[1] = { value };
+                    prop.setter->call(node, args, 1, ce);
+                }
+                set_by_setter = true;
+            }
+            if (set_by_setter) {
+                Object_set_edited(node, true, false);
+            }
+
+            //groups
+            for (int g = pn.groups_begin; g < pn.groups_end; ++g) {
+                node->add_to_group(*p_plan.groups[g], true);
+            }
+
+            if (pn.attach) {
+                if (i != 0) {
+                    if (parent) {
+                        parent->_add_child_nocheck(node, *pn.name);
+                        if (pn.index >= 0 && pn.index < parent->get_child_count() - 1)
+                            parent->move_child(node, pn.index);
+                    } else {
+                        stray_instances.push_back(node); //can't be added, go to stray list
+                    }
+                } else {
+                    if (Engine::get_singleton()->is_editor_hint()) {
+                        node->set_name(*pn.name);
+                    } else {
+                        node->_set_name_nocheck(*pn.name);
+                    }
+                }
+            }
+
+            if (pn.owner >= 0) {
+                Node *owner = nodeFromId(node_paths, ret_nodes, nc, pn.owner);
+                if (owner)
+                    node->_set_owner_nocheck(owner);
+            }
+            node->remove_meta("_edit_pinned_properties_");
+        }
+
+        ret_nodes[i] = node;
+    }
+
+    for (eastl::pair<const Ref<Resource>, Ref<Resource> > &E : resources_local_to_scene) {
+
+        E.second->setup_local_to_scene();
+    }
+
+    for (const InstancePlan::Connection &c : p_plan.connections) {
+        Node *cfrom = nodeFromId(node_paths, ret_nodes, nc, c.from);
+        Node *cto = nodeFromId(node_paths, ret_nodes, nc, c.to);
+
+        if (!cfrom || !cto)
+            continue;
+
+        cfrom->connect(*c.signal, Callable(cto, *c.method), c.flags);
+    }
+
+    for (Node *n : stray_instances) {
+        memdelete(n);
+    }
+
+    for (const auto &editable_instance : editable_instances) {
+        Node *ei = ret_nodes[0]->get_node_or_null(editable_instance);
+        if (ei) {
+            ret_nodes[0]->set_editable_instance(ei, true);
+        }
+    }
+
+    return ret_nodes[0];
+}
+
 Node *SceneState::instance(PackedGenEditState p_edit_state) const {
 
+    if (p_edit_state == GEN_EDIT_STATE_DISABLED && use_instance_plans) {
+        const InstancePlan *plan = _get_instance_plan();
+        if (plan) {
+            return _instance_from_plan(*plan);
+        }
+    }
+
     // nodes where instancing failed (because something is missing)
     Vector<Node *> stray_instances;
 
@@ -286,19 +684,8 @@ Node *SceneState::instance(PackedGenEditState p_edit_state) const {
             //instance a scene into this node
             if (n.instance & FLAG_INSTANCE_IS_PLACEHOLDER) {
 
-                String path = variants[n.instance & FLAG_MASK].as<String>();
-                if (disable_placeholders) {
-
-                    Ref<PackedScene> sdata = dynamic_ref_cast<PackedScene>(gResourceManager().load(path, "PackedScene"));
-                    ERR_FAIL_COND_V(not sdata, nullptr);
-                    node = sdata->instance(p_edit_state == GEN_EDIT_STATE_DISABLED ? GEN_EDIT_STATE_DISABLED : GEN_EDIT_STATE_INSTANCE);
-                    ERR_FAIL_COND_V(!node, nullptr);
-                } else {
-                    InstancePlaceholder *ip = memnew(InstancePlaceholder);
-                    ip->set_instance_path(path);
-                    node = ip;
-                }
-                node->set_scene_instance_load_placeholder(true);
+                node = _instance_placeholder(variants[n.instance & FLAG_MASK].as<String>(), p_edit_state, disable_placeholders);
+                ERR_FAIL_COND_V(!node, nullptr);
             } else {
                 Ref<PackedScene> sdata(variants[n.instance & FLAG_MASK]);
                 ERR_FAIL_COND_V(not sdata, nullptr);
@@ -322,27 +709,10 @@ Node *SceneState::instance(PackedGenEditState p_edit_state) const {
             node = object_cast<Node>(obj);
             if (!node) {
 
-                memdelete(obj);
-                obj = nullptr;
-
-                WARN_PRINT(FormatSN("Node %s of type %s cannot be created. A placeholder will be created instead.", snames[n.name].asCString(), snames[n.type].asCString()));
-                if (n.parent >= 0 && n.parent < nc && ret_nodes[n.parent]) {
-                    if (object_cast<Node3D>(ret_nodes[n.parent])) {
-                        obj = memnew(Node3D);
-                    } else if (object_cast<Control>(ret_nodes[n.parent])) {
-                        obj = memnew(Control);
-                    } else if (object_cast<Node2D>(ret_nodes[n.parent])) {
-                        obj = memnew(Node2D);
-                    }
-                }
-
-                if (!obj) {
-                    obj = memnew(Node);
-                }
+                if (obj)
+                    memdelete(obj);
+                node = _create_missing_type_placeholder(snames[n.name], snames[n.type], n.parent >= 0 && n.parent < nc ? ret_nodes[n.parent] : nullptr);
             }
-
-            node = object_cast<Node>(obj);
-
         }
 
         if (node) {
@@ -431,6 +801,24 @@ Node *SceneState::instance(PackedGenEditState p_edit_state) const {
     return ret_nodes[0];
 }
 
+int SceneState::instance_multiple(int p_count, Vector<Node *> &r_nodes) const {
+
+    ERR_FAIL_COND_V(p_count < 0, 0);
+    ERR_FAIL_COND_V(nodes.empty(), 0);
+
+    const InstancePlan *plan = use_instance_plans ? _get_instance_plan() : nullptr;
+    r_nodes.reserve(r_nodes.size() + p_count);
+
+    int created = 0;
+    for (; created < p_count; ++created) {
+        Node *node = plan ? _instance_from_plan(*plan) : instance(GEN_EDIT_STATE_DISABLED);
+        if (!node)
+            break;
+        r_nodes.push_back(node);
+    }
+    return created;
+}
+
 Error SceneState::_parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Map<StringName, int> &name_map, HashMap<Variant, int, Hasher<Variant>, VariantComparator> &variant_map, HashMap<Node *, int> &node_map, HashMap<Node *, int> &nodepath_map) {
 
     // this function handles all the work related to properly packing scenes, be it
@@ -896,6 +1284,7 @@ const String &SceneState::get_path() const {
 
 void SceneState::clear() {
 
+    _clear_instance_plan();
     names.clear();
     variants.clear();
     nodes.clear();
@@ -1017,6 +1406,18 @@ void SceneState::set_disable_placeholders(bool p_disable) {
     disable_placeholders = p_disable;
 }
 
+bool SceneState::use_instance_plans = true;
+
+void SceneState::set_use_instance_plans(bool p_enable) {
+
+    use_instance_plans = p_enable;
+}
+
+bool SceneState::is_using_instance_plans() {
+
+    return use_instance_plans;
+}
+
 bool SceneState::is_connection(int p_node, const StringName &p_signal, int p_to_node, const StringName &p_to_method) const {
 
     ERR_FAIL_COND_V(p_node < 0, false);
@@ -1071,6 +1472,8 @@ void SceneState::set_bundled_scene(const Dictionary &p_dictionary) {
 
     ERR_FAIL_COND_MSG(version > PACKED_SCENE_VERSION, "Save format version too new.");
 
+    _clear_instance_plan();
+
     const int node_count = p_dictionary["node_count"].as<int>();
     const PoolVector<int> snodes = p_dictionary["nodes"].as<PoolVector<int>>();
     ERR_FAIL_COND(snodes.size() < node_count);
@@ -1480,6 +1883,7 @@ const Vector<NodePath> &SceneState::get_editable_instances() const {
 //add
 
 int SceneState::add_name(const StringName &p_name) {
+    _clear_instance_plan();
     int idx = names.size();
     names.push_back(p_name);
     return idx;
@@ -1497,17 +1901,20 @@ int SceneState::find_name(const StringName &p_name) const {
 
 int SceneState::add_value(const Variant &p_value) {
 
+    _clear_instance_plan();
     variants.push_back(p_value);
     return variants.size() - 1;
 }
 
 int SceneState::add_node_path(const NodePath &p_path) {
 
+    _clear_instance_plan();
     node_paths.push_back(p_path);
     return (node_paths.size() - 1) | FLAG_ID_IS_PATH;
 }
 int SceneState::add_node(int p_parent, int p_owner, int p_type, int p_name, int p_instance, int p_index) {
 
+    _clear_instance_plan();
     NodeData nd;
     nd.parent = p_parent;
     nd.owner = p_owner;
@@ -1522,6 +1929,7 @@ int SceneState::add_node(int p_parent, int p_owner, int p_type, int p_name, int
 }
 void SceneState::add_node_property(int p_node, int p_name, int p_value) {
 
+    _clear_instance_plan();
     ERR_FAIL_INDEX(p_node, nodes.size());
     ERR_FAIL_INDEX(p_name, names.size());
     ERR_FAIL_INDEX(p_value, variants.size());
@@ -1531,17 +1939,20 @@ void SceneState::add_node_property(int p_node, int p_name, int p_value) {
 }
 void SceneState::add_node_group(int p_node, int p_group) {
 
+    _clear_instance_plan();
     ERR_FAIL_INDEX(p_node, nodes.size());
     ERR_FAIL_INDEX(p_group, names.size());
     nodes[p_node].groups.push_back(p_group);
 }
 void SceneState::set_base_scene(int p_idx) {
 
+    _clear_instance_plan();
     ERR_FAIL_INDEX(p_idx, variants.size());
     base_scene_idx = p_idx;
 }
 void SceneState::add_connection(int p_from, int p_to, int p_signal, int p_method, int p_flags) {
 
+    _clear_instance_plan();
     ERR_FAIL_INDEX(p_signal, names.size());
     ERR_FAIL_INDEX(p_method, names.size());
 
@@ -1555,6 +1966,7 @@ void SceneState::add_connection(int p_from, int p_to, int p_signal, int p_method
 }
 void SceneState::add_editable_instance(const NodePath &p_path) {
 
+    _clear_instance_plan();
     editable_instances.emplace_back(p_path);
 }
 
@@ -1599,6 +2011,13 @@ SceneState::SceneState() {
 
 }
 
+SceneState::~SceneState() {
+
+    if (instance_plan) {
+        memdelete(instance_plan);
+    }
+}
+
 ////////////////
 
 void PackedScene::_set_bundled_scene(const Dictionary &p_scene) {
@@ -1649,6 +2068,33 @@ Node *PackedScene::instance(PackedGenEditState p_edit_state) const {
     return s;
 }
 
+Vector<Node *> PackedScene::instance_multiple(int p_count) const {
+
+    Vector<Node *> ret;
+    if (!PackedSceneTooling::can_instance_state(GEN_EDIT_STATE_DISABLED)) {
+        return ret;
+    }
+
+    state->instance_multiple(p_count, ret);
+
+    const bool set_filename = !get_path().empty() && !StringUtils::contains(get_path(), "::");
+    for (Node *s : ret) {
+        if (set_filename)
+            s->set_filename(get_path());
+        s->notification(Node::NOTIFICATION_INSTANCED);
+    }
+    return ret;
+}
+
+Array PackedScene::_instance_multiple(int p_count) const {
+
+    Array ret;
+    for (Node *s : instance_multiple(p_count)) {
+        ret.push_back(Variant(s));
+    }
+    return ret;
+}
+
 void PackedScene::replace_state(Ref<SceneState> p_by) {
 
     state = eastl::move(p_by);
@@ -1673,6 +2119,7 @@ void PackedScene::_bind_methods() {
 
     SE_BIND_METHOD(PackedScene,pack);
     MethodBinder::bind_method(D_METHOD("instance", {"edit_state"}), &PackedScene::instance, {DEFVAL(GEN_EDIT_STATE_DISABLED)});
+    MethodBinder::bind_method(D_METHOD("instance_multiple", {"count"}), &PackedScene::_instance_multiple);
     SE_BIND_METHOD(PackedScene,can_instance);
     SE_BIND_METHOD(PackedScene,_set_bundled_scene);
     SE_BIND_METHOD(PackedScene,_get_bundled_scene);
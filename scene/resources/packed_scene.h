@@ -36,6 +36,7 @@
 #include "core/node_path.h"
 #include "core/map.h"
 #include "core/hash_map.h"
+#include "core/os/mutex.h"
 #include "scene/main/node.h"
 
 class PackedScene;
@@ -97,6 +98,18 @@ class GODOT_EXPORT SceneState : public RefCounted {
 
     Vector<ConnectionData> connections;
 
+    // Flattened, pre-resolved form of nodes/connections used to replay GEN_EDIT_STATE_DISABLED instancing.
+    // Built on first use and dropped whenever the state is modified.
+    struct InstancePlan;
+    mutable InstancePlan *instance_plan = nullptr;
+    mutable bool instance_plan_failed = false;
+    mutable Mutex instance_plan_mutex;
+
+    const InstancePlan *_get_instance_plan() const;
+    bool _build_instance_plan(InstancePlan &r_plan) const;
+    void _clear_instance_plan();
+    Node *_instance_from_plan(const InstancePlan &p_plan) const;
+
     Error _parse_node(Node *p_owner, Node *p_node, int p_parent_idx, Map<StringName, int> &name_map, HashMap<Variant, int, Hasher<Variant>, VariantComparator> &variant_map, HashMap<Node *, int> &node_map, HashMap<Node *, int> &nodepath_map);
     Error _parse_connections(Node *p_owner, Node *p_node, Map<StringName, int> &name_map, HashMap<Variant, int, Hasher<Variant>, VariantComparator> &variant_map, HashMap<Node *, int> &node_map, HashMap<Node *, int> &nodepath_map);
 
@@ -105,6 +118,7 @@ class GODOT_EXPORT SceneState : public RefCounted {
     uint64_t last_modified_time = 0;
 
     static bool disable_placeholders;
+    static bool use_instance_plans;
 public:
     enum {
         FLAG_ID_IS_PATH = (1 << 30),
@@ -130,6 +144,8 @@ public:
     };
 
     static void set_disable_placeholders(bool p_disable);
+    static void set_use_instance_plans(bool p_enable);
+    static bool is_using_instance_plans();
 
     int find_node_by_path(const NodePath &p_node) const;
     Variant get_property_value(int p_node, const StringName &p_property, bool &found) const;
@@ -148,6 +164,7 @@ public:
 
     bool can_instance() const;
     Node *instance(PackedGenEditState p_edit_state) const;
+    int instance_multiple(int p_count, Vector<Node *> &r_nodes) const;
 
     Ref<SceneState> get_base_scene_state() const;
 
@@ -196,6 +213,7 @@ public:
     uint64_t get_last_modified_time() const { return last_modified_time; }
 
     SceneState();
+    ~SceneState() override;
 };
 
 
@@ -206,6 +224,8 @@ class GODOT_EXPORT PackedScene : public Resource {
     RES_BASE_EXTENSION("scn")
 
     Ref<SceneState> state;
+
+    Array _instance_multiple(int p_count) const;
 public:
     void _set_bundled_scene(const Dictionary &p_scene);
     Dictionary _get_bundled_scene() const;
@@ -222,6 +242,7 @@ public:
 
     bool can_instance() const;
     Node *instance(PackedGenEditState p_edit_state = GEN_EDIT_STATE_DISABLED) const;
+    Vector<Node *> instance_multiple(int p_count) const;
 
     void recreate_state();
     void replace_state(Ref<SceneState> p_by);
@@ -785,7 +785,8 @@ void ResourceInteractiveLoaderText::get_dependencies(FileAccess *p_f, Vector<Str
 
 Error ResourceInteractiveLoaderText::rename_dependencies(FileAccess *p_f, StringView p_path, const HashMap<String, String> &p_map) {
 
-    open(p_f, true);
+    // tag_end below is taken from the file position, so the parser must not read ahead of it.
+    open(p_f, true, false);
     ERR_FAIL_COND_V(error != OK, error);
     ignore_resource_parsing = true;
     //FileAccess
@@ -887,7 +888,7 @@ Error ResourceInteractiveLoaderText::rename_dependencies(FileAccess *p_f, String
     return OK;
 }
 
-void ResourceInteractiveLoaderText::open(FileAccess *p_f, bool p_skip_first_tag) {
+void ResourceInteractiveLoaderText::open(FileAccess *p_f, bool p_skip_first_tag, bool p_readahead) {
 
     error = OK;
 
@@ -895,7 +896,7 @@ void ResourceInteractiveLoaderText::open(FileAccess *p_f, bool p_skip_first_tag)
     f = p_f;
     if(stream)
         VariantParser::release_stream(stream);
-    stream = VariantParser::get_file_stream(f);
+    stream = VariantParser::get_file_stream(f, p_readahead);
     is_scene = false;
     ignore_resource_parsing = false;
     resource_current = 0;
@@ -126,7 +126,7 @@ public:
     int get_stage_count() const override;
     void set_translation_remapped(bool p_remapped) override;
 
-    void open(FileAccess *p_f, bool p_skip_first_tag = false);
+    void open(FileAccess *p_f, bool p_skip_first_tag = false, bool p_readahead = true);
     String recognize(FileAccess *p_f);
     void get_dependencies(FileAccess *p_f, Vector<String> &p_dependencies, bool p_add_types);
     Error rename_dependencies(FileAccess *p_f, StringView p_path, const HashMap<String, String> &p_map);
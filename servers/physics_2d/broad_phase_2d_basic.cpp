@@ -78,10 +78,10 @@ int BroadPhase2DBasic::get_subindex(ID p_id) const {
 }
 
 int BroadPhase2DBasic::cull_segment(const Vector2 &p_from, const Vector2 &p_to, CollisionObject2DSW **p_results,
-        int p_max_results, int *p_result_indices) {
+        int p_max_results, int *p_result_indices) const {
     int rc = 0;
 
-    for (eastl::pair<const ID, Element> &E : element_map) {
+    for (const eastl::pair<const ID, Element> &E : element_map) {
         const Rect2 aabb = E.second.aabb;
         if (aabb.intersects_segment(p_from, p_to)) {
             p_results[rc] = E.second.owner;
@@ -96,10 +96,10 @@ int BroadPhase2DBasic::cull_segment(const Vector2 &p_from, const Vector2 &p_to,
     return rc;
 }
 int BroadPhase2DBasic::cull_aabb(
-        const Rect2 &p_aabb, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices) {
+        const Rect2 &p_aabb, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices) const {
     int rc = 0;
 
-    for (eastl::pair<const ID, Element> &E : element_map) {
+    for (const eastl::pair<const ID, Element> &E : element_map) {
         const Rect2 aabb = E.second.aabb;
         if (aabb.intersects(p_aabb)) {
             p_results[rc] = E.second.owner;
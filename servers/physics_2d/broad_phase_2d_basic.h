@@ -94,8 +94,8 @@ public:
     bool is_static(ID p_id) const override;
     int get_subindex(ID p_id) const override;
 
-    int cull_segment(const Vector2 &p_from, const Vector2 &p_to, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices = nullptr) override;
-    int cull_aabb(const Rect2 &p_aabb, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices = nullptr) override;
+    int cull_segment(const Vector2 &p_from, const Vector2 &p_to, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices = nullptr) const override;
+    int cull_aabb(const Rect2 &p_aabb, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices = nullptr) const override;
 
     void set_pair_callback(PairCallback p_pair_callback, void *p_userdata) override;
     void set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata) override;
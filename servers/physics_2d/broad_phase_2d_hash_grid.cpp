@@ -304,7 +304,6 @@ BroadPhase2DHashGrid::ID BroadPhase2DHashGrid::create(CollisionObject2DSW *p_obj
     e.collision_layer = p_object->get_collision_layer();
     e.subindex = p_subindex;
     e.self = current;
-    e.pass = 0;
 
     element_map[current] = e;
     return current;
@@ -403,13 +402,14 @@ int BroadPhase2DHashGrid::get_subindex(ID p_id) const {
 
 template <bool use_aabb, bool use_segment>
 void BroadPhase2DHashGrid::_cull(const Point2i p_cell, const Rect2 &p_aabb, const Point2 &p_from, const Point2 &p_to,
-        CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices, int &index) {
+        const Point2i *p_reference, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices,
+        int &index) const {
     PosKey pk;
     pk.x = p_cell.x;
     pk.y = p_cell.y;
 
     uint32_t idx = pk.hash() % hash_table_size;
-    PosBin *pb = hash_table[idx];
+    const PosBin *pb = hash_table[idx];
 
     while (pb) {
         if (pb->key == pk) {
@@ -423,16 +423,14 @@ void BroadPhase2DHashGrid::_cull(const Point2i p_cell, const Rect2 &p_aabb, cons
         return;
     }
 
-    for (eastl::pair<Element *, RC> E : pb->object_set) {
+    for (const eastl::pair<Element *const, RC> &E : pb->object_set) {
         if (index >= p_max_results) {
             break;
         }
-        if (E.first->pass == pass) {
+        if (!_is_first_visit<use_aabb>(E.first, p_cell, p_reference)) {
             continue;
         }
 
-        E.first->pass = pass;
-
         if (use_aabb && !p_aabb.intersects(E.first->aabb)) {
             continue;
         }
@@ -450,7 +448,7 @@ void BroadPhase2DHashGrid::_cull(const Point2i p_cell, const Rect2 &p_aabb, cons
         if (index >= p_max_results) {
             break;
         }
-        if (E.first->pass == pass) {
+        if (!_is_first_visit<use_aabb>(E.first, p_cell, p_reference)) {
             continue;
         }
 
@@ -462,7 +460,6 @@ void BroadPhase2DHashGrid::_cull(const Point2i p_cell, const Rect2 &p_aabb, cons
             continue;
         }
 
-        E.first->pass = pass;
         p_results[index] = E.first->owner;
         p_result_indices[index] = E.first->subindex;
         index++;
@@ -470,9 +467,7 @@ void BroadPhase2DHashGrid::_cull(const Point2i p_cell, const Rect2 &p_aabb, cons
 }
 
 int BroadPhase2DHashGrid::cull_segment(const Vector2 &p_from, const Vector2 &p_to, CollisionObject2DSW **p_results,
-        int p_max_results, int *p_result_indices) {
-    pass++;
-
+        int p_max_results, int *p_result_indices) const {
     Vector2 dir = (p_to - p_from);
     if (dir == Vector2()) {
         return 0;
@@ -510,12 +505,13 @@ int BroadPhase2DHashGrid::cull_segment(const Vector2 &p_from, const Vector2 &p_t
     }
 
     int cullcount = 0;
-    _cull<false, true>(pos, Rect2(), p_from, p_to, p_results, p_max_results, p_result_indices, cullcount);
+    _cull<false, true>(pos, Rect2(), p_from, p_to, nullptr, p_results, p_max_results, p_result_indices, cullcount);
 
     bool reached_x = false;
     bool reached_y = false;
 
     while (true) {
+        const Point2i prev = pos;
         if (max.x < max.y) {
             max.x += delta.x;
             pos.x += step.x;
@@ -540,7 +536,7 @@ int BroadPhase2DHashGrid::cull_segment(const Vector2 &p_from, const Vector2 &p_t
             reached_y = true;
         }
 
-        _cull<false, true>(pos, Rect2(), p_from, p_to, p_results, p_max_results, p_result_indices, cullcount);
+        _cull<false, true>(pos, Rect2(), p_from, p_to, &prev, p_results, p_max_results, p_result_indices, cullcount);
 
         if (reached_x && reached_y) {
             break;
@@ -551,11 +547,6 @@ int BroadPhase2DHashGrid::cull_segment(const Vector2 &p_from, const Vector2 &p_t
         if (cullcount >= p_max_results) {
             break;
         }
-        if (E.first->pass == pass) {
-            continue;
-        }
-
-        E.first->pass = pass;
 
         /*
         if (use_aabb && !p_aabb.intersects(E.first->aabb))
@@ -575,29 +566,22 @@ int BroadPhase2DHashGrid::cull_segment(const Vector2 &p_from, const Vector2 &p_t
 }
 
 int BroadPhase2DHashGrid::cull_aabb(
-        const Rect2 &p_aabb, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices) {
-    pass++;
-
+        const Rect2 &p_aabb, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices) const {
     Point2i from = (p_aabb.position / cell_size).floor();
     Point2i to = ((p_aabb.position + p_aabb.size) / cell_size).floor();
     int cullcount = 0;
 
     for (int i = from.x; i <= to.x; i++) {
         for (int j = from.y; j <= to.y; j++) {
-            _cull<true, false>(
-                    Point2i(i, j), p_aabb, Point2(), Point2(), p_results, p_max_results, p_result_indices, cullcount);
+            _cull<true, false>(Point2i(i, j), p_aabb, Point2(), Point2(), &from, p_results, p_max_results,
+                    p_result_indices, cullcount);
         }
     }
 
-    for (eastl::pair<Element *, RC> E : large_elements) {
+    for (const eastl::pair<Element *const, RC> &E : large_elements) {
         if (cullcount >= p_max_results) {
             break;
         }
-        if (E.first->pass == pass) {
-            continue;
-        }
-
-        E.first->pass = pass;
 
         if (!p_aabb.intersects(E.first->aabb)) {
             continue;
@@ -651,8 +635,6 @@ BroadPhase2DHashGrid::BroadPhase2DHashGrid() {
     for (uint32_t i = 0; i < hash_table_size; i++) {
         hash_table[i] = nullptr;
     }
-    pass = 1;
-
     current = 0;
 }
 
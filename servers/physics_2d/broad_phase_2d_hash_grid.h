@@ -54,7 +54,6 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
         uint32_t collision_mask;
         uint32_t collision_layer;
         int subindex;
-        uint64_t pass;
         HashMap<Element *, PairData *> paired;
     };
 
@@ -78,8 +77,6 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 
       ID current;
 
-      uint64_t pass;
-
       struct PairKey {
           union {
               struct {
@@ -124,9 +121,27 @@ class BroadPhase2DHashGrid : public BroadPhase2DSW {
 
     void _enter_grid(Element *p_elem, const Rect2 &p_rect, bool p_static, bool p_force_enter);
     void _exit_grid(Element *p_elem, const Rect2 &p_rect, bool p_static, bool p_force_exit);
-      template <bool use_aabb, bool use_segment>
+    // Elements spanning several cells are reported at the first of them the cull visits, rather than stamped
+    // with a pass counter, so culls don't write to the grid and can run from several threads at once.
+    // p_reference is the first cell of an aabb cull, or the previously visited cell of a segment cull.
+    template <bool use_aabb>
+    _FORCE_INLINE_ bool _is_first_visit(
+            const Element *p_elem, const Point2i &p_cell, const Point2i *p_reference) const {
+        const Point2i from = (p_elem->aabb.position / cell_size).floor();
+        if (use_aabb) {
+            return M_MAX(from.x, p_reference->x) == p_cell.x && M_MAX(from.y, p_reference->y) == p_cell.y;
+        }
+        if (!p_reference) {
+            return true;
+        }
+        // Segments walk the cells monotonically, so the cells of an element are visited in a single run.
+        const Point2i to = ((p_elem->aabb.position + p_elem->aabb.size) / cell_size).floor();
+        return p_reference->x < from.x || p_reference->x > to.x || p_reference->y < from.y || p_reference->y > to.y;
+    }
+    template <bool use_aabb, bool use_segment>
     _FORCE_INLINE_ void _cull(const Point2i p_cell, const Rect2 &p_aabb, const Point2 &p_from, const Point2 &p_to,
-            CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices, int &index);
+            const Point2i *p_reference, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices,
+            int &index) const;
 
       struct PosKey {
           union {
@@ -180,9 +195,9 @@ public:
     int get_subindex(ID p_id) const override;
 
     int cull_segment(const Vector2 &p_from, const Vector2 &p_to, CollisionObject2DSW **p_results, int p_max_results,
-            int *p_result_indices = nullptr) override;
+            int *p_result_indices = nullptr) const override;
     int cull_aabb(const Rect2 &p_aabb, CollisionObject2DSW **p_results, int p_max_results,
-            int *p_result_indices = nullptr) override;
+            int *p_result_indices = nullptr) const override;
 
     void set_pair_callback(PairCallback p_pair_callback, void *p_userdata) override;
     void set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata) override;
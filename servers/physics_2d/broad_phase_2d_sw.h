@@ -58,8 +58,9 @@ public:
     virtual bool is_static(ID p_id) const = 0;
     virtual int get_subindex(ID p_id) const = 0;
 
-    virtual int cull_segment(const Vector2 &p_from, const Vector2 &p_to, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices = nullptr) = 0;
-    virtual int cull_aabb(const Rect2 &p_aabb, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices = nullptr) = 0;
+    // Culls only read the broadphase, batched queries run them from several threads while no object moves.
+    virtual int cull_segment(const Vector2 &p_from, const Vector2 &p_to, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices = nullptr) const = 0;
+    virtual int cull_aabb(const Rect2 &p_aabb, CollisionObject2DSW **p_results, int p_max_results, int *p_result_indices = nullptr) const = 0;
 
     virtual void set_pair_callback(PairCallback p_pair_callback, void *p_userdata) = 0;
     virtual void set_unpair_callback(UnpairCallback p_unpair_callback, void *p_userdata) = 0;
@@ -36,6 +36,7 @@
 #include "core/debugger/script_debugger.h"
 #include "core/string_utils.h"
 #include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
 #include "core/project_settings.h"
 #include "core/script_language.h"
 #include "core/class_db.h"
@@ -1342,6 +1343,26 @@ void Physics2DServerSW::init() {
     doing_sync = false;
     iterations = 8; // 8?
     stepper = memnew(Step2DSW);
+    parallel_queries = T_GLOBAL_GET<bool>("physics/2d/parallel_queries") && OS::get_singleton()->get_default_thread_pool_size() > 1;
+}
+
+ThreadWorkPool *Physics2DServerSW::acquire_query_pool() {
+
+    if (!parallel_queries)
+        return nullptr;
+    bool expected = false;
+    if (!query_pool_busy.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        return nullptr;
+
+    if (!query_pool) {
+        query_pool = memnew(ThreadWorkPool);
+        query_pool->init();
+    }
+    return query_pool;
+}
+
+void Physics2DServerSW::release_query_pool() {
+    query_pool_busy.store(false, std::memory_order_release);
 }
 
 void Physics2DServerSW::step(real_t p_step) {
@@ -1427,6 +1448,11 @@ void Physics2DServerSW::end_sync() {
 void Physics2DServerSW::finish() {
 
     memdelete(stepper);
+    if (query_pool) {
+        query_pool->finish();
+        memdelete(query_pool);
+        query_pool = nullptr;
+    }
 }
 
 void Physics2DServerSW::_update_shapes() {
@@ -1460,6 +1486,7 @@ Physics2DServerSW::Physics2DServerSW() {
     GLOBAL_DEF("physics/2d/bp_hash_table_size", 4096);
     GLOBAL_DEF("physics/2d/cell_size", 128);
     GLOBAL_DEF("physics/2d/large_object_surface_threshold_in_cells", 512);
+    GLOBAL_DEF("physics/2d/parallel_queries", true);
     BroadPhase2DSW::create_func = BroadPhase2DHashGrid::_create;
     //BroadPhase2DSW::create_func=BroadPhase2DBasic::_create;
     submission_thread_singleton = this;
@@ -1469,6 +1496,8 @@ Physics2DServerSW::Physics2DServerSW() {
     collision_pairs = 0;
     using_threads = T_GLOBAL_GET<int>("physics/2d/thread_model") == 2;
     flushing_queries = false;
+    query_pool = nullptr;
+    parallel_queries = false;
 }
 
 Physics2DServerSW::~Physics2DServerSW(){
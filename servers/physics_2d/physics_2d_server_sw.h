@@ -37,6 +37,10 @@
 #include "step_2d_sw.h"
 #include "core/rid.h"
 
+#include <atomic>
+
+class ThreadWorkPool;
+
 class Physics2DServerSW : public PhysicsServer2D {
 
     GDCLASS(Physics2DServerSW,PhysicsServer2D)
@@ -58,6 +62,11 @@ class Physics2DServerSW : public PhysicsServer2D {
     Step2DSW *stepper;
     Set<const Space2DSW *> active_spaces;
 
+    /// Runs batched space queries, created by the first batch when physics/2d/parallel_queries is set.
+    ThreadWorkPool *query_pool;
+    bool parallel_queries;
+    std::atomic<bool> query_pool_busy { false };
+
 
     mutable RID_Owner<Shape2DSW> shape_owner;
     mutable RID_Owner<Space2DSW> space_owner;
@@ -75,6 +84,11 @@ class Physics2DServerSW : public PhysicsServer2D {
     RID _shape_create(ShapeType p_shape);
 
 public:
+    /// Returns nullptr when batched queries have to run on the calling thread: parallel queries are
+    /// disabled or another batch holds the pool. A non null pool is given back with release_query_pool().
+    ThreadWorkPool *acquire_query_pool();
+    void release_query_pool();
+
     static Physics2DServerSW *get()
     {
         return (Physics2DServerSW*)submission_thread_singleton;
@@ -34,6 +34,7 @@
 #include "core/class_db.h"
 #include "core/object_db.h"
 #include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
 #include "core/pair.h"
 #include "physics_2d_server_sw.h"
 
@@ -137,14 +138,22 @@ bool Physics2DDirectSpaceStateSW::intersect_ray(const Vector2 &p_from, const Vec
 
     ERR_FAIL_COND_V(space->locked, false);
 
+    return _intersect_ray(space->intersection_query_results, space->intersection_query_subindex_results, p_from, p_to,
+            r_result, p_exclude, p_collision_mask, p_collide_with_bodies, p_collide_with_areas);
+}
+
+bool Physics2DDirectSpaceStateSW::_intersect_ray(CollisionObject2DSW **r_candidates, int *r_candidate_shapes,
+        const Vector2 &p_from, const Vector2 &p_to, RayResult &r_result, const HashSet<RID> &p_exclude,
+        uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) const {
+
     Vector2 begin, end;
     Vector2 normal;
     begin = p_from;
     end = p_to;
     normal = (end - begin).normalized();
 
-    int amount = space->broadphase->cull_segment(begin, end, space->intersection_query_results,
-            Space2DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+    int amount = space->broadphase->cull_segment(
+            begin, end, r_candidates, Space2DSW::INTERSECTION_QUERY_MAX, r_candidate_shapes);
 
     // todo, create another array that references results, compute AABBs and check closest point to ray origin, sort,
     // and stop evaluating results when beyond first collision
@@ -157,16 +166,15 @@ bool Physics2DDirectSpaceStateSW::intersect_ray(const Vector2 &p_from, const Vec
 
     for (int i = 0; i < amount; i++) {
 
-        if (!_can_collide_with(space->intersection_query_results[i], p_collision_mask, p_collide_with_bodies,
-                    p_collide_with_areas))
+        if (!_can_collide_with(r_candidates[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas))
             continue;
 
-        if (p_exclude.contains(space->intersection_query_results[i]->get_self()))
+        if (p_exclude.contains(r_candidates[i]->get_self()))
             continue;
 
-        const CollisionObject2DSW *col_obj = space->intersection_query_results[i];
+        const CollisionObject2DSW *col_obj = r_candidates[i];
 
-        int shape_idx = space->intersection_query_subindex_results[i];
+        int shape_idx = r_candidate_shapes[i];
         Transform2D inv_xform = col_obj->get_shape_inv_transform(shape_idx) * col_obj->get_inv_transform();
 
         Vector2 local_from = inv_xform.xform(begin);
@@ -221,6 +229,16 @@ int Physics2DDirectSpaceStateSW::intersect_shape(const RID &p_shape, const Trans
         const HashSet<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies,
         bool p_collide_with_areas) {
 
+    return _intersect_shape(space->intersection_query_results, space->intersection_query_subindex_results, p_shape,
+            p_xform, p_motion, p_margin, r_results, p_result_max, p_exclude, p_collision_mask, p_collide_with_bodies,
+            p_collide_with_areas);
+}
+
+int Physics2DDirectSpaceStateSW::_intersect_shape(CollisionObject2DSW **r_candidates, int *r_candidate_shapes,
+        const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin,
+        ShapeResult *r_results, int p_result_max, const HashSet<RID> &p_exclude, uint32_t p_collision_mask,
+        bool p_collide_with_bodies, bool p_collide_with_areas) const {
+
     if (p_result_max <= 0)
         return 0;
 
@@ -231,8 +249,8 @@ int Physics2DDirectSpaceStateSW::intersect_shape(const RID &p_shape, const Trans
     aabb = aabb.merge(Rect2(aabb.position + p_motion, aabb.size)); //motion
     aabb.grow_by(p_margin);
 
-    int amount = space->broadphase->cull_aabb(aabb, space->intersection_query_results,
-            Space2DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+    int amount = space->broadphase->cull_aabb(
+            aabb, r_candidates, Space2DSW::INTERSECTION_QUERY_MAX, r_candidate_shapes);
 
     int cc = 0;
 
@@ -241,15 +259,14 @@ int Physics2DDirectSpaceStateSW::intersect_shape(const RID &p_shape, const Trans
         if (cc >= p_result_max)
             break;
 
-        if (!_can_collide_with(space->intersection_query_results[i], p_collision_mask, p_collide_with_bodies,
-                    p_collide_with_areas))
+        if (!_can_collide_with(r_candidates[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas))
             continue;
 
-        if (p_exclude.contains(space->intersection_query_results[i]->get_self()))
+        if (p_exclude.contains(r_candidates[i]->get_self()))
             continue;
 
-        const CollisionObject2DSW *col_obj = space->intersection_query_results[i];
-        int shape_idx = space->intersection_query_subindex_results[i];
+        const CollisionObject2DSW *col_obj = r_candidates[i];
+        int shape_idx = r_candidate_shapes[i];
 
         if (!CollisionSolver2DSW::solve(shape, p_xform, p_motion, col_obj->get_shape(shape_idx),
                     col_obj->get_transform() * col_obj->get_shape_transform(shape_idx), Vector2(), nullptr, nullptr,
@@ -273,6 +290,16 @@ bool Physics2DDirectSpaceStateSW::cast_motion(const RID &p_shape, const Transfor
         real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const HashSet<RID> &p_exclude,
         uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) {
 
+    return _cast_motion(space->intersection_query_results, space->intersection_query_subindex_results, p_shape,
+            p_xform, p_motion, p_margin, p_closest_safe, p_closest_unsafe, p_exclude, p_collision_mask,
+            p_collide_with_bodies, p_collide_with_areas);
+}
+
+bool Physics2DDirectSpaceStateSW::_cast_motion(CollisionObject2DSW **r_candidates, int *r_candidate_shapes,
+        const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin,
+        real_t &p_closest_safe, real_t &p_closest_unsafe, const HashSet<RID> &p_exclude, uint32_t p_collision_mask,
+        bool p_collide_with_bodies, bool p_collide_with_areas) const {
+
     Shape2DSW *shape = Physics2DServerSW::get()->shape_owner.get(p_shape);
     ERR_FAIL_COND_V(!shape, false);
 
@@ -280,23 +307,22 @@ bool Physics2DDirectSpaceStateSW::cast_motion(const RID &p_shape, const Transfor
     aabb = aabb.merge(Rect2(aabb.position + p_motion, aabb.size)); //motion
     aabb.grow_by(p_margin);
 
-    int amount = space->broadphase->cull_aabb(aabb, space->intersection_query_results,
-            Space2DSW::INTERSECTION_QUERY_MAX, space->intersection_query_subindex_results);
+    int amount = space->broadphase->cull_aabb(
+            aabb, r_candidates, Space2DSW::INTERSECTION_QUERY_MAX, r_candidate_shapes);
 
     real_t best_safe = 1;
     real_t best_unsafe = 1;
 
     for (int i = 0; i < amount; i++) {
 
-        if (!_can_collide_with(space->intersection_query_results[i], p_collision_mask, p_collide_with_bodies,
-                    p_collide_with_areas))
+        if (!_can_collide_with(r_candidates[i], p_collision_mask, p_collide_with_bodies, p_collide_with_areas))
             continue;
 
-        if (p_exclude.contains(space->intersection_query_results[i]->get_self()))
+        if (p_exclude.contains(r_candidates[i]->get_self()))
             continue; //ignore excluded
 
-        const CollisionObject2DSW *col_obj = space->intersection_query_results[i];
-        int shape_idx = space->intersection_query_subindex_results[i];
+        const CollisionObject2DSW *col_obj = r_candidates[i];
+        int shape_idx = r_candidate_shapes[i];
 
         Transform2D col_obj_xform = col_obj->get_transform() * col_obj->get_shape_transform(shape_idx);
         //test initial overlap, does it collide if going all the way?
@@ -537,6 +563,131 @@ bool Physics2DDirectSpaceStateSW::rest_info(RID p_shape, const Transform2D &p_sh
     return true;
 }
 
+// Queries handed to a pool task at once, each task culls into candidate buffers of its own.
+constexpr int QUERY_BATCH_GRAIN = 32;
+static const HashSet<RID> no_exclude;
+
+struct Physics2DDirectSpaceStateSW::QueryBatch {
+    int count = 0;
+    const RayQuery *rays = nullptr;
+    const ShapeQuery *shapes = nullptr;
+    RayResult *ray_results = nullptr;
+    bool *ray_hits = nullptr;
+    ShapeResult *shape_results = nullptr;
+    int result_max = 0;
+    int *result_counts = nullptr;
+    CastMotionResult *motion_results = nullptr;
+};
+
+void Physics2DDirectSpaceStateSW::_run_batch(
+        QueryBatch *p_batch, void (Physics2DDirectSpaceStateSW::*p_chunk_method)(uint32_t, QueryBatch *)) {
+
+    const uint32_t chunks = (p_batch->count + QUERY_BATCH_GRAIN - 1) / QUERY_BATCH_GRAIN;
+    Physics2DServerSW *server = Physics2DServerSW::get();
+    ThreadWorkPool *pool = chunks > 1 ? server->acquire_query_pool() : nullptr;
+    if (!pool) {
+        for (uint32_t i = 0; i < chunks; i++) {
+            (this->*p_chunk_method)(i, p_batch);
+        }
+        return;
+    }
+    pool->do_work(chunks, this, p_chunk_method, p_batch);
+    server->release_query_pool();
+}
+
+void Physics2DDirectSpaceStateSW::_intersect_rays_chunk(uint32_t p_chunk, QueryBatch *p_batch) {
+
+    Vector<CollisionObject2DSW *> candidates;
+    Vector<int> candidate_shapes;
+    candidates.resize(Space2DSW::INTERSECTION_QUERY_MAX);
+    candidate_shapes.resize(Space2DSW::INTERSECTION_QUERY_MAX);
+
+    const int end = MIN((int)(p_chunk + 1) * QUERY_BATCH_GRAIN, p_batch->count);
+    for (int i = p_chunk * QUERY_BATCH_GRAIN; i < end; i++) {
+        const RayQuery &q = p_batch->rays[i];
+        p_batch->ray_hits[i] = _intersect_ray(candidates.data(), candidate_shapes.data(), q.from, q.to,
+                p_batch->ray_results[i], q.exclude ? *q.exclude : no_exclude, q.collision_layer,
+                q.collide_with_bodies, q.collide_with_areas);
+    }
+}
+
+void Physics2DDirectSpaceStateSW::_intersect_shapes_chunk(uint32_t p_chunk, QueryBatch *p_batch) {
+
+    Vector<CollisionObject2DSW *> candidates;
+    Vector<int> candidate_shapes;
+    candidates.resize(Space2DSW::INTERSECTION_QUERY_MAX);
+    candidate_shapes.resize(Space2DSW::INTERSECTION_QUERY_MAX);
+
+    const int end = MIN((int)(p_chunk + 1) * QUERY_BATCH_GRAIN, p_batch->count);
+    for (int i = p_chunk * QUERY_BATCH_GRAIN; i < end; i++) {
+        const ShapeQuery &q = p_batch->shapes[i];
+        p_batch->result_counts[i] = _intersect_shape(candidates.data(), candidate_shapes.data(), q.shape,
+                q.transform, q.motion, q.margin, p_batch->shape_results + i * p_batch->result_max,
+                p_batch->result_max, q.exclude ? *q.exclude : no_exclude, q.collision_layer, q.collide_with_bodies,
+                q.collide_with_areas);
+    }
+}
+
+void Physics2DDirectSpaceStateSW::_cast_motions_chunk(uint32_t p_chunk, QueryBatch *p_batch) {
+
+    Vector<CollisionObject2DSW *> candidates;
+    Vector<int> candidate_shapes;
+    candidates.resize(Space2DSW::INTERSECTION_QUERY_MAX);
+    candidate_shapes.resize(Space2DSW::INTERSECTION_QUERY_MAX);
+
+    const int end = MIN((int)(p_chunk + 1) * QUERY_BATCH_GRAIN, p_batch->count);
+    for (int i = p_chunk * QUERY_BATCH_GRAIN; i < end; i++) {
+        const ShapeQuery &q = p_batch->shapes[i];
+        CastMotionResult &r = p_batch->motion_results[i];
+        r.closest_safe = 1;
+        r.closest_unsafe = 1;
+        _cast_motion(candidates.data(), candidate_shapes.data(), q.shape, q.transform, q.motion, q.margin,
+                r.closest_safe, r.closest_unsafe, q.exclude ? *q.exclude : no_exclude, q.collision_layer,
+                q.collide_with_bodies, q.collide_with_areas);
+    }
+}
+
+void Physics2DDirectSpaceStateSW::intersect_rays(
+        const RayQuery *p_queries, int p_count, RayResult *r_results, bool *r_hits) {
+
+    ERR_FAIL_COND(space->locked);
+
+    QueryBatch batch;
+    batch.count = p_count;
+    batch.rays = p_queries;
+    batch.ray_results = r_results;
+    batch.ray_hits = r_hits;
+    _run_batch(&batch, &Physics2DDirectSpaceStateSW::_intersect_rays_chunk);
+}
+
+void Physics2DDirectSpaceStateSW::intersect_shapes(
+        const ShapeQuery *p_queries, int p_count, ShapeResult *r_results, int p_result_max, int *r_counts) {
+
+    if (p_result_max <= 0) {
+        for (int i = 0; i < p_count; i++) {
+            r_counts[i] = 0;
+        }
+        return;
+    }
+
+    QueryBatch batch;
+    batch.count = p_count;
+    batch.shapes = p_queries;
+    batch.shape_results = r_results;
+    batch.result_max = p_result_max;
+    batch.result_counts = r_counts;
+    _run_batch(&batch, &Physics2DDirectSpaceStateSW::_intersect_shapes_chunk);
+}
+
+void Physics2DDirectSpaceStateSW::cast_motions(const ShapeQuery *p_queries, int p_count, CastMotionResult *r_results) {
+
+    QueryBatch batch;
+    batch.count = p_count;
+    batch.shapes = p_queries;
+    batch.motion_results = r_results;
+    _run_batch(&batch, &Physics2DDirectSpaceStateSW::_cast_motions_chunk);
+}
+
 Physics2DDirectSpaceStateSW::Physics2DDirectSpaceStateSW() {
 
     space = nullptr;
@@ -47,6 +47,18 @@ class Physics2DDirectSpaceStateSW : public PhysicsDirectSpaceState2D {
 
     int _intersect_point_impl(const Vector2 &p_point, ShapeResult *r_results, int p_result_max, const HashSet<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas, bool p_pick_point, bool p_filter_by_canvas = false, GameEntity p_canvas_instance_id = entt::null);
 
+    // Broadphase culls go to r_candidates/r_candidate_shapes: the space's buffers for single queries, buffers
+    // of the pool task for batched ones.
+    bool _intersect_ray(CollisionObject2DSW **r_candidates, int *r_candidate_shapes, const Vector2 &p_from, const Vector2 &p_to, RayResult &r_result, const HashSet<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) const;
+    int _intersect_shape(CollisionObject2DSW **r_candidates, int *r_candidate_shapes, const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin, ShapeResult *r_results, int p_result_max, const HashSet<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) const;
+    bool _cast_motion(CollisionObject2DSW **r_candidates, int *r_candidate_shapes, const RID &p_shape, const Transform2D &p_xform, const Vector2 &p_motion, real_t p_margin, real_t &p_closest_safe, real_t &p_closest_unsafe, const HashSet<RID> &p_exclude, uint32_t p_collision_mask, bool p_collide_with_bodies, bool p_collide_with_areas) const;
+
+    struct QueryBatch;
+    void _run_batch(QueryBatch *p_batch, void (Physics2DDirectSpaceStateSW::*p_chunk_method)(uint32_t, QueryBatch *));
+    void _intersect_rays_chunk(uint32_t p_chunk, QueryBatch *p_batch);
+    void _intersect_shapes_chunk(uint32_t p_chunk, QueryBatch *p_batch);
+    void _cast_motions_chunk(uint32_t p_chunk, QueryBatch *p_batch);
+
 public:
     Space2DSW *space;
 
@@ -58,6 +70,10 @@ public:
     bool collide_shape(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, real_t p_margin, Vector2 *r_results, int p_result_max, int &r_result_count, const HashSet<RID> &p_exclude = HashSet<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false) override;
     bool rest_info(RID p_shape, const Transform2D &p_shape_xform, const Vector2 &p_motion, real_t p_margin, ShapeRestInfo *r_info, const HashSet<RID> &p_exclude = HashSet<RID>(), uint32_t p_collision_mask = 0xFFFFFFFF, bool p_collide_with_bodies = true, bool p_collide_with_areas = false) override;
 
+    void intersect_rays(const RayQuery *p_queries, int p_count, RayResult *r_results, bool *r_hits) override;
+    void intersect_shapes(const ShapeQuery *p_queries, int p_count, ShapeResult *r_results, int p_result_max, int *r_counts) override;
+    void cast_motions(const ShapeQuery *p_queries, int p_count, CastMotionResult *r_results) override;
+
     Physics2DDirectSpaceStateSW();
 };
 
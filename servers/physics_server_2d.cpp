@@ -463,6 +463,42 @@ Dictionary PhysicsDirectSpaceState2D::_get_rest_info(const Ref<PhysicsShapeQuery
     return r;
 }
 
+void PhysicsDirectSpaceState2D::intersect_rays(const RayQuery *p_queries, int p_count, RayResult *r_results, bool *r_hits) {
+
+    static const HashSet<RID> no_exclude;
+
+    for (int i = 0; i < p_count; i++) {
+        const RayQuery &q = p_queries[i];
+        r_hits[i] = intersect_ray(q.from, q.to, r_results[i], q.exclude ? *q.exclude : no_exclude, q.collision_layer,
+                q.collide_with_bodies, q.collide_with_areas);
+    }
+}
+
+void PhysicsDirectSpaceState2D::intersect_shapes(const ShapeQuery *p_queries, int p_count, ShapeResult *r_results, int p_result_max, int *r_counts) {
+
+    static const HashSet<RID> no_exclude;
+
+    for (int i = 0; i < p_count; i++) {
+        const ShapeQuery &q = p_queries[i];
+        r_counts[i] = intersect_shape(q.shape, q.transform, q.motion, q.margin, r_results + i * p_result_max,
+                p_result_max, q.exclude ? *q.exclude : no_exclude, q.collision_layer, q.collide_with_bodies,
+                q.collide_with_areas);
+    }
+}
+
+void PhysicsDirectSpaceState2D::cast_motions(const ShapeQuery *p_queries, int p_count, CastMotionResult *r_results) {
+
+    static const HashSet<RID> no_exclude;
+
+    for (int i = 0; i < p_count; i++) {
+        const ShapeQuery &q = p_queries[i];
+        r_results[i].closest_safe = 1;
+        r_results[i].closest_unsafe = 1;
+        cast_motion(q.shape, q.transform, q.motion, q.margin, r_results[i].closest_safe, r_results[i].closest_unsafe,
+                q.exclude ? *q.exclude : no_exclude, q.collision_layer, q.collide_with_bodies, q.collide_with_areas);
+    }
+}
+
 PhysicsDirectSpaceState2D::PhysicsDirectSpaceState2D() {
 }
 
@@ -205,6 +205,43 @@ public:
 
     virtual Vector3 get_closest_point_to_object_volume(RID p_object, const Vector3 p_point) const = 0;
 
+    // Batched queries: p_count independent queries are read from a contiguous array and answered into
+    // caller-owned buffers at the same index. Backends can run them in parallel, the default runs them one by one.
+
+    struct RayQuery {
+
+        Vector3 from;
+        Vector3 to;
+        const HashSet<RID> *exclude = nullptr;
+        uint32_t collision_mask = 0xFFFFFFFF;
+        bool collide_with_bodies = true;
+        bool collide_with_areas = false;
+    };
+
+    struct ShapeQuery {
+
+        RID shape;
+        Transform transform;
+        Vector3 motion; // only used by cast_motions
+        float margin = 0;
+        const HashSet<RID> *exclude = nullptr;
+        uint32_t collision_mask = 0xFFFFFFFF;
+        bool collide_with_bodies = true;
+        bool collide_with_areas = false;
+    };
+
+    struct CastMotionResult {
+
+        float closest_safe;
+        float closest_unsafe;
+    };
+
+    /// r_hits[i] tells if r_results[i] was written.
+    virtual void intersect_rays(const RayQuery *p_queries, int p_count, RayResult *r_results, bool *r_hits);
+    /// r_results holds p_result_max results per query, r_counts[i] how many of them query i wrote.
+    virtual void intersect_shapes(const ShapeQuery *p_queries, int p_count, ShapeResult *r_results, int p_result_max, int *r_counts);
+    virtual void cast_motions(const ShapeQuery *p_queries, int p_count, CastMotionResult *r_results);
+
     PhysicsDirectSpaceState3D();
 };
 
@@ -33,8 +33,10 @@
 #include "portal_renderer.h"
 
 #include "core/bitfield_dynamic.h"
+#include "core/io/marshalls.h"
 #include "core/os/file_access.h"
 #include "core/os/os.h"
+#include "core/os/thread_work_pool.h"
 #include "core/string_utils.h"
 #include "core/print_string.h"
 
@@ -79,18 +81,13 @@ void PVSBuilder::find_neighbors(Vector<Neighbours> &r_neighbors) {
     // the secondary PVS is the primary PVS plus the neighbors
 }
 
-void PVSBuilder::create_secondary_pvs(int p_room_id, const Vector<Neighbours> &p_neighbors, BitFieldDynamic &r_bitfield_rooms) {
-    VSRoom &room = _portal_renderer->get_room(p_room_id);
-    room._secondary_pvs_first = _pvs->get_secondary_pvs_size();
+void PVSBuilder::create_secondary_pvs(const Vector<Neighbours> &p_neighbors, Trace &r_trace) {
+    RoomPVS &result = *r_trace.result;
 
     // go through each primary PVS room, and add the neighbors in the secondary pvs
-    for (int r = 0; r < room._pvs_size; r++) {
-        int pvs_entry = room._pvs_first + r;
-        int pvs_room_id = _pvs->get_pvs_room_id(pvs_entry);
-
+    for (int32_t pvs_room_id : result.pvs) {
         // add the visible rooms first
-        _pvs->add_to_secondary_pvs(pvs_room_id);
-        room._secondary_pvs_size += 1;
+        result.secondary_pvs.push_back(pvs_room_id);
 
         // now any neighbors of this that are not already added
         const Neighbours &neigh = p_neighbors[pvs_room_id];
@@ -99,10 +96,9 @@ void PVSBuilder::create_secondary_pvs(int p_room_id, const Vector<Neighbours> &p
 
             //log("\tconsidering neigh " + itos(neigh_room_id));
 
-            if (r_bitfield_rooms.check_and_set(neigh_room_id)) {
+            if (r_trace.bitfield_rooms.check_and_set(neigh_room_id)) {
                 // add to the secondary pvs for this room
-                _pvs->add_to_secondary_pvs(neigh_room_id);
-                room._secondary_pvs_size += 1;
+                result.secondary_pvs.push_back(neigh_room_id);
             } // neighbor room has not been added yet
         } // go through the neighbors
     } // go through each room in the primary pvs
@@ -110,6 +106,13 @@ void PVSBuilder::create_secondary_pvs(int p_room_id, const Vector<Neighbours> &p
 
 #ifdef GODOT_PVS_SUPPORT_SAVE_FILE
 
+// The file is one block: a header, the room table and both room id lists, so it loads with a single read.
+// header : 'p' 'v' 's' '1', num_rooms, pvs_size, secondary_pvs_size (uint32)
+// rooms : pvs_first, pvs_size, secondary_pvs_first, secondary_pvs_size (uint32) per room
+// pvs, secondary pvs : room ids (uint16)
+static const uint8_t PVS_FILE_MAGIC[4] = { 'p', 'v', 's', '1' };
+static const uint32_t PVS_FILE_HEADER_SIZE = 16;
+
 bool PVSBuilder::load_pvs(String p_filename) {
     if (p_filename == "") {
         return false;
@@ -125,58 +128,48 @@ bool PVSBuilder::load_pvs(String p_filename) {
         return false;
     }
 
-    // goto needs vars declaring ahead of time
-    int32_t num_rooms;
-    int32_t pvs_size;
-
-    if (!((file->get_8() == 'p') &&
-                (file->get_8() == 'v') &&
-                (file->get_8() == 's') &&
-                (file->get_8() == ' '))) {
-        goto failed;
-    }
+    Vector<uint8_t> data;
+    data.resize(file->get_len());
+    uint64_t read = file->get_buffer(data.data(), data.size());
+    memdelete(file);
 
-    num_rooms = file->get_32();
-    if (num_rooms != _portal_renderer->get_num_rooms()) {
-        goto failed;
+    if (read != data.size() || data.size() < PVS_FILE_HEADER_SIZE || memcmp(data.data(), PVS_FILE_MAGIC, 4) != 0) {
+        return false;
     }
 
-    for (int n = 0; n < num_rooms; n++) {
-        if (file->eof_reached())
-            goto failed;
+    const uint8_t *ptr = data.data();
+    uint32_t num_rooms = decode_uint32(ptr + 4);
+    uint32_t pvs_size = decode_uint32(ptr + 8);
+    uint32_t secondary_pvs_size = decode_uint32(ptr + 12);
 
-        VSRoom &room = _portal_renderer->get_room(n);
-        room._pvs_first = file->get_32();
-        room._pvs_size = file->get_32();
-        room._secondary_pvs_first = file->get_32();
-        room._secondary_pvs_size = file->get_32();
+    if (num_rooms != (uint32_t)_portal_renderer->get_num_rooms()) {
+        return false;
     }
-
-    pvs_size = file->get_32();
-
-    for (int n = 0; n < pvs_size; n++) {
-        _pvs->add_to_pvs(file->get_16());
+    if (data.size() != PVS_FILE_HEADER_SIZE + uint64_t(num_rooms) * 16 + (uint64_t(pvs_size) + secondary_pvs_size) * 2) {
+        return false;
     }
+    ptr += PVS_FILE_HEADER_SIZE;
 
-    // secondary pvs
-    pvs_size = file->get_32();
-
-    for (int n = 0; n < pvs_size; n++) {
-        _pvs->add_to_secondary_pvs(file->get_16());
+    for (uint32_t n = 0; n < num_rooms; n++) {
+        VSRoom &room = _portal_renderer->get_room(n);
+        room._pvs_first = decode_uint32(ptr);
+        room._pvs_size = decode_uint32(ptr + 4);
+        room._secondary_pvs_first = decode_uint32(ptr + 8);
+        room._secondary_pvs_size = decode_uint32(ptr + 12);
+        ptr += 16;
     }
 
-    if (file) {
-        memdelete(file);
+    for (uint32_t n = 0; n < pvs_size; n++) {
+        _pvs->add_to_pvs(decode_uint16(ptr));
+        ptr += 2;
     }
 
-    return true;
-
-failed:
-    if (file) {
-        memdelete(file);
+    for (uint32_t n = 0; n < secondary_pvs_size; n++) {
+        _pvs->add_to_secondary_pvs(decode_uint16(ptr));
+        ptr += 2;
     }
 
-    return false;
+    return true;
 }
 
 void PVSBuilder::save_pvs(String p_filename) {
@@ -184,54 +177,53 @@ void PVSBuilder::save_pvs(String p_filename) {
         p_filename = "res://test.pvs";
     }
 
-    Error err;
-    FileAccess *file = FileAccess::open(p_filename, FileAccess::WRITE, &err);
+    int num_rooms = _portal_renderer->get_num_rooms();
+    ERR_FAIL_COND_MSG(num_rooms > 65536, "Too many rooms to save the PVS.");
 
-    if (err || !file) {
-        if (file) {
-            memdelete(file);
-        }
-        return;
-    }
+    int32_t pvs_size = _pvs->get_pvs_size();
+    int32_t secondary_pvs_size = _pvs->get_secondary_pvs_size();
 
-    file->store_8('p');
-    file->store_8('v');
-    file->store_8('s');
-    file->store_8(' ');
+    Vector<uint8_t> data;
+    data.resize(PVS_FILE_HEADER_SIZE + num_rooms * 16 + (pvs_size + secondary_pvs_size) * 2);
+    uint8_t *ptr = data.data();
+
+    memcpy(ptr, PVS_FILE_MAGIC, 4);
+    encode_uint32(num_rooms, ptr + 4);
+    encode_uint32(pvs_size, ptr + 8);
+    encode_uint32(secondary_pvs_size, ptr + 12);
+    ptr += PVS_FILE_HEADER_SIZE;
 
     // hash? NYI
 
     // first save the room indices into the pvs
-    int num_rooms = _portal_renderer->get_num_rooms();
-    file->store_32(num_rooms);
-
     for (int n = 0; n < num_rooms; n++) {
-        VSRoom &room = _portal_renderer->get_room(n);
-        file->store_32(room._pvs_first);
-        file->store_32(room._pvs_size);
-        file->store_32(room._secondary_pvs_first);
-        file->store_32(room._secondary_pvs_size);
+        const VSRoom &room = _portal_renderer->get_room(n);
+        ptr += encode_uint32(room._pvs_first, ptr);
+        ptr += encode_uint32(room._pvs_size, ptr);
+        ptr += encode_uint32(room._secondary_pvs_first, ptr);
+        ptr += encode_uint32(room._secondary_pvs_size, ptr);
     }
 
-    int32_t pvs_size = _pvs->get_pvs_size();
-    file->store_32(pvs_size);
-
     for (int n = 0; n < pvs_size; n++) {
-        int16_t room_id = _pvs->get_pvs_room_id(n);
-        file->store_16(room_id);
+        ptr += encode_uint16(_pvs->get_pvs_room_id(n), ptr);
     }
 
-    pvs_size = _pvs->get_secondary_pvs_size();
-    file->store_32(pvs_size);
-
-    for (int n = 0; n < pvs_size; n++) {
-        int16_t room_id = _pvs->get_secondary_pvs_room_id(n);
-        file->store_16(room_id);
+    for (int n = 0; n < secondary_pvs_size; n++) {
+        ptr += encode_uint16(_pvs->get_secondary_pvs_room_id(n), ptr);
     }
 
-    if (file) {
-        memdelete(file);
+    Error err;
+    FileAccess *file = FileAccess::open(p_filename, FileAccess::WRITE, &err);
+
+    if (err || !file) {
+        if (file) {
+            memdelete(file);
+        }
+        return;
     }
+
+    file->store_buffer(data.data(), data.size());
+    memdelete(file);
 }
 
 #endif
@@ -255,8 +247,7 @@ void PVSBuilder::calculate_pvs(PortalRenderer &p_portal_renderer, String p_filen
     uint32_t time_before = OS::get_singleton()->get_ticks_msec();
 
     int num_rooms = _portal_renderer->get_num_rooms();
-    BitFieldDynamic bf;
-    bf.create(num_rooms);
+    _use_simple_pvs = p_use_simple_pvs;
 
     Vector<Neighbours> neighbors;
     neighbors.resize(num_rooms);
@@ -265,25 +256,38 @@ void PVSBuilder::calculate_pvs(PortalRenderer &p_portal_renderer, String p_filen
     // this is needed to create the secondary pvs
     find_neighbors(neighbors);
 
-    for (int n = 0; n < num_rooms; n++) {
-        bf.blank();
-
-        //_visible_rooms.clear();
+    _room_pvs.clear();
+    _room_pvs.resize(num_rooms);
 
-        Vector<Plane> dummy_planes;
+    // The trace from each source room only reads the room graph, so rooms are traced in parallel.
+    // The log is only readable in room order though, so logging keeps it on this thread.
+    if (_log_active || num_rooms < 2) {
+        for (int n = 0; n < num_rooms; n++) {
+            _trace_room(n, &neighbors);
+        }
+    } else {
+        ThreadWorkPool pool;
+        pool.init();
+        pool.do_work(num_rooms, this, &PVSBuilder::_trace_room, &neighbors);
+        pool.finish();
+    }
 
+    // merge in room order, so the result does not depend on which thread traced what
+    for (int n = 0; n < num_rooms; n++) {
         VSRoom &room = _portal_renderer->get_room(n);
-        room._pvs_first = _pvs->get_pvs_size();
+        const RoomPVS &result = _room_pvs[n];
 
-        log("pvs from room : " + itos(n));
-
-        if (p_use_simple_pvs) {
-            trace_rooms_recursive_simple(0, n, n, -1, false, -1, dummy_planes, bf);
-        } else {
-            trace_rooms_recursive(0, n, n, -1, false, -1, dummy_planes, bf);
+        room._pvs_first = _pvs->get_pvs_size();
+        room._pvs_size = result.pvs.size();
+        for (int32_t room_id : result.pvs) {
+            _pvs->add_to_pvs(room_id);
         }
 
-        create_secondary_pvs(n, neighbors, bf);
+        room._secondary_pvs_first = _pvs->get_secondary_pvs_size();
+        room._secondary_pvs_size = result.secondary_pvs.size();
+        for (int32_t room_id : result.secondary_pvs) {
+            _pvs->add_to_secondary_pvs(room_id);
+        }
 
         if (_log_active) {
             String string = "";
@@ -306,6 +310,8 @@ void PVSBuilder::calculate_pvs(PortalRenderer &p_portal_renderer, String p_filen
         }
     }
 
+    _room_pvs.clear();
+
     _pvs->set_loaded(true);
 
     uint32_t time_after = OS::get_singleton()->get_ticks_msec();
@@ -317,6 +323,24 @@ void PVSBuilder::calculate_pvs(PortalRenderer &p_portal_renderer, String p_filen
 #endif
 }
 
+void PVSBuilder::_trace_room(uint32_t p_room_id, const Vector<Neighbours> *p_neighbors) {
+    Trace trace;
+    trace.result = &_room_pvs[p_room_id];
+    trace.bitfield_rooms.create(_portal_renderer->get_num_rooms());
+
+    Vector<Plane> dummy_planes;
+
+    log("pvs from room : " + itos(p_room_id));
+
+    if (_use_simple_pvs) {
+        trace_rooms_recursive_simple(0, p_room_id, p_room_id, -1, false, -1, dummy_planes, trace);
+    } else {
+        trace_rooms_recursive(0, p_room_id, p_room_id, -1, false, -1, dummy_planes, trace);
+    }
+
+    create_secondary_pvs(*p_neighbors, trace);
+}
+
 void PVSBuilder::logd(int p_depth, String p_string) {
     if (!_log_active) {
         return;
@@ -339,7 +363,7 @@ void PVSBuilder::log(String p_string) {
 // The full routine deals with re-entrant rooms. I.e. more than one portal path can lead into a room.
 // This makes the logic more complex, because we cannot terminate on the second entry to a room,
 // and have to account for internal rooms, and the possibility of portal paths going back on themselves.
-void PVSBuilder::trace_rooms_recursive(int p_depth, int p_source_room_id, int p_room_id, int p_first_portal_id, bool p_first_portal_outgoing, int p_previous_portal_id, const Vector<Plane> &p_planes, BitFieldDynamic &r_bitfield_rooms, int p_from_external_room_id) {
+void PVSBuilder::trace_rooms_recursive(int p_depth, int p_source_room_id, int p_room_id, int p_first_portal_id, bool p_first_portal_outgoing, int p_previous_portal_id, const Vector<Plane> &p_planes, Trace &r_trace, int p_from_external_room_id) {
     // prevent too much depth
     if (p_depth > _depth_limit) {
         WARN_PRINT_ONCE("PVS Depth Limit reached (seeing through too many portals)");
@@ -347,11 +371,9 @@ void PVSBuilder::trace_rooms_recursive(int p_depth, int p_source_room_id, int p_
     }
 
     // is this room hit first time?
-    if (r_bitfield_rooms.check_and_set(p_room_id)) {
+    if (r_trace.bitfield_rooms.check_and_set(p_room_id)) {
         // only add to the room PVS of the source room once
-        VSRoom &source_room = _portal_renderer->get_room(p_source_room_id);
-        _pvs->add_to_pvs(p_room_id);
-        source_room._pvs_size += 1;
+        r_trace.result->pvs.push_back(p_room_id);
     }
 
     logd(p_depth, "trace_rooms_recursive room " + itos(p_room_id));
@@ -386,7 +408,7 @@ void PVSBuilder::trace_rooms_recursive(int p_depth, int p_source_room_id, int p_
         // For pvs there is no real start point, but we will use the centre of the first portal.
         // This is used for checking portals are pointing outward from start point.
         if (p_source_room_id == p_room_id) {
-            _trace_start_point = portal._pt_center;
+            r_trace.start_point = portal._pt_center;
 
             // We will use a small epsilon because we don't want to trace out
             // to coplanar portals for the first to second portals, before planes
@@ -403,16 +425,16 @@ void PVSBuilder::trace_rooms_recursive(int p_depth, int p_source_room_id, int p_
             // The epsilon should be BEHIND the way we are going through the portal,
             // so depends whether it is outgoing or not
             if (outgoing) {
-                _trace_start_point -= portal._plane.normal * 0.1;
+                r_trace.start_point -= portal._plane.normal * 0.1;
             } else {
-                _trace_start_point += portal._plane.normal * 0.1;
+                r_trace.start_point += portal._plane.normal * 0.1;
             }
 
         } else {
             // much better way of culling portals by direction to camera...
             // instead of using dot product with a varying view direction, we simply find which side of the portal
             // plane the camera is on! If it is behind, the portal can be seen through, if in front, it can't
-            real_t dist_cam = portal._plane.distance_to(_trace_start_point);
+            real_t dist_cam = portal._plane.distance_to(r_trace.start_point);
 
             if (!outgoing) {
                 dist_cam = -dist_cam;
@@ -431,7 +453,7 @@ void PVSBuilder::trace_rooms_recursive(int p_depth, int p_source_room_id, int p_
 
         // while clipping to the planes we maintain a list of partial planes, so we can add them to the
         // recursive next iteration of planes to check
-        static Vector<int> partial_planes;
+        Vector<int> &partial_planes = r_trace.partial_planes;
         partial_planes.clear();
 
         for (int32_t l = 0; l < p_planes.size(); l++) {
@@ -527,7 +549,7 @@ void PVSBuilder::trace_rooms_recursive(int p_depth, int p_source_room_id, int p_
                 p_first_portal_outgoing = outgoing != 0;
             }
 
-            trace_rooms_recursive(p_depth + 1, p_source_room_id, linked_room_id, first_portal_id, p_first_portal_outgoing, portal_id, planes, r_bitfield_rooms, p_from_external_room_id);
+            trace_rooms_recursive(p_depth + 1, p_source_room_id, linked_room_id, first_portal_id, p_first_portal_outgoing, portal_id, planes, r_trace, p_from_external_room_id);
         } // linked room is valid
     }
 }
@@ -535,9 +557,9 @@ void PVSBuilder::trace_rooms_recursive(int p_depth, int p_source_room_id, int p_
 // This simpler routine was the first used. It is reliable and no epsilons, and fast.
 // But it will not create the correct result where there are multiple portal paths
 // through a room when building the PVS.
-void PVSBuilder::trace_rooms_recursive_simple(int p_depth, int p_source_room_id, int p_room_id, int p_first_portal_id, bool p_first_portal_outgoing, int p_previous_portal_id, const Vector<Plane> &p_planes, BitFieldDynamic &r_bitfield_rooms) {
+void PVSBuilder::trace_rooms_recursive_simple(int p_depth, int p_source_room_id, int p_room_id, int p_first_portal_id, bool p_first_portal_outgoing, int p_previous_portal_id, const Vector<Plane> &p_planes, Trace &r_trace) {
     // has this room been done already?
-    if (!r_bitfield_rooms.check_and_set(p_room_id)) {
+    if (!r_trace.bitfield_rooms.check_and_set(p_room_id)) {
         return;
     }
 
@@ -553,9 +575,7 @@ void PVSBuilder::trace_rooms_recursive_simple(int p_depth, int p_source_room_id,
     const VSRoom &room = _portal_renderer->get_room(p_room_id);
 
     // add to the room PVS of the source room
-    VSRoom &source_room = _portal_renderer->get_room(p_source_room_id);
-    _pvs->add_to_pvs(p_room_id);
-    source_room._pvs_size += 1;
+    r_trace.result->pvs.push_back(p_room_id);
 
     // go through each portal
     int num_portals = room._portal_ids.size();
@@ -584,7 +604,7 @@ void PVSBuilder::trace_rooms_recursive_simple(int p_depth, int p_source_room_id,
             continue;
 
         // linked room done already?
-        if (r_bitfield_rooms.get_bit(linked_room_id))
+        if (r_trace.bitfield_rooms.get_bit(linked_room_id))
             continue;
 
         // is it culled by the planes?
@@ -592,7 +612,7 @@ void PVSBuilder::trace_rooms_recursive_simple(int p_depth, int p_source_room_id,
 
         // while clipping to the planes we maintain a list of partial planes, so we can add them to the
         // recursive next iteration of planes to check
-        static Vector<int> partial_planes;
+        Vector<int> &partial_planes = r_trace.partial_planes;
         partial_planes.clear();
 
         for (int32_t l = 0; l < p_planes.size(); l++) {
@@ -663,7 +683,7 @@ void PVSBuilder::trace_rooms_recursive_simple(int p_depth, int p_source_room_id,
                 p_first_portal_outgoing = outgoing != 0;
             }
 
-            trace_rooms_recursive(p_depth + 1, p_source_room_id, linked_room_id, first_portal_id, p_first_portal_outgoing, portal_id, planes, r_bitfield_rooms);
+            trace_rooms_recursive(p_depth + 1, p_source_room_id, linked_room_id, first_portal_id, p_first_portal_outgoing, portal_id, planes, r_trace);
         } // linked room is valid
     }
 }
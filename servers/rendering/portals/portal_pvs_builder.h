@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include "core/bitfield_dynamic.h"
 #include "core/vector.h"
 #include "core/math/plane.h"
 
@@ -37,13 +38,26 @@
 
 class PortalRenderer;
 class PVS;
-class BitFieldDynamic;
 
 class PVSBuilder {
     struct Neighbours {
         Vector<int32_t> room_ids;
     };
 
+    // The PVS of one source room, traced independently of the others and merged in room order afterwards.
+    struct RoomPVS {
+        Vector<int32_t> pvs;
+        Vector<int32_t> secondary_pvs;
+    };
+
+    // Everything a trace writes to, one per source room so rooms can be traced on several threads.
+    struct Trace {
+        RoomPVS *result = nullptr;
+        BitFieldDynamic bitfield_rooms;
+        Vector<int> partial_planes;
+        Vector3 start_point;
+    };
+
 public:
     void calculate_pvs(PortalRenderer &p_portal_renderer, String p_filename, int p_depth_limit, bool p_use_simple_pvs, bool p_log_pvs_generation);
 
@@ -53,19 +67,21 @@ private:
     void save_pvs(String p_filename);
 #endif
     void find_neighbors(Vector<Neighbours> &r_neighbors);
+    void _trace_room(uint32_t p_room_id, const Vector<Neighbours> *p_neighbors);
 
     void logd(int p_depth, String p_string);
     void log(String p_string);
 
-    void trace_rooms_recursive(int p_depth, int p_source_room_id, int p_room_id, int p_first_portal_id, bool p_first_portal_outgoing, int p_previous_portal_id, const Vector<Plane> &p_planes, BitFieldDynamic &r_bitfield_rooms, int p_from_external_room_id = -1);
-    void trace_rooms_recursive_simple(int p_depth, int p_source_room_id, int p_room_id, int p_first_portal_id, bool p_first_portal_outgoing, int p_previous_portal_id, const Vector<Plane> &p_planes, BitFieldDynamic &r_bitfield_rooms);
+    void trace_rooms_recursive(int p_depth, int p_source_room_id, int p_room_id, int p_first_portal_id, bool p_first_portal_outgoing, int p_previous_portal_id, const Vector<Plane> &p_planes, Trace &r_trace, int p_from_external_room_id = -1);
+    void trace_rooms_recursive_simple(int p_depth, int p_source_room_id, int p_room_id, int p_first_portal_id, bool p_first_portal_outgoing, int p_previous_portal_id, const Vector<Plane> &p_planes, Trace &r_trace);
 
-    void create_secondary_pvs(int p_room_id, const Vector<Neighbours> &p_neighbors, BitFieldDynamic &r_bitfield_rooms);
+    void create_secondary_pvs(const Vector<Neighbours> &p_neighbors, Trace &r_trace);
 
     PortalRenderer *_portal_renderer = nullptr;
     PVS *_pvs = nullptr;
     int _depth_limit = 16;
-    Vector3 _trace_start_point;
+    bool _use_simple_pvs = false;
+    Vector<RoomPVS> _room_pvs;
 
     static bool _log_active;
 };
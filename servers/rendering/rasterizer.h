@@ -311,6 +311,7 @@ public:
     virtual int skeleton_get_bone_count(RenderingEntity p_skeleton) const = 0;
     virtual void skeleton_bone_set_transform(RenderingEntity p_skeleton, int p_bone, const Transform &p_transform) = 0;
     virtual Transform skeleton_bone_get_transform(RenderingEntity p_skeleton, int p_bone) const = 0;
+    virtual void skeleton_set_bone_transforms(RenderingEntity p_skeleton, Span<const Transform> p_transforms) = 0;
     virtual void skeleton_bone_set_transform_2d(RenderingEntity p_skeleton, int p_bone, const Transform2D &p_transform) = 0;
     virtual Transform2D skeleton_bone_get_transform_2d(RenderingEntity p_skeleton, int p_bone) const = 0;
     virtual void skeleton_set_base_transform_2d(RenderingEntity p_skeleton, const Transform2D &p_base_transform) = 0;
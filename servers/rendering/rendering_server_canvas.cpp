@@ -66,6 +66,319 @@ void _mark_ysort_dirty(RenderingCanvasItemComponent *ysort_owner) {
     } while (ysort_owner && ysort_owner->sort_y);
 }
 
+struct YSortCompare {
+
+    bool operator()(RenderingEntity p_left, RenderingEntity p_right) const {
+        const auto &item_a(VSG::ecs->registry.get<RenderingCanvasItemComponent>(p_left));
+        const auto &item_b(VSG::ecs->registry.get<RenderingCanvasItemComponent>(p_right));
+        if (Math::is_equal_approx(item_a.ysort_pos.y, item_b.ysort_pos.y)) {
+            return item_a.ysort_index < item_b.ysort_index;
+        }
+
+        return item_a.ysort_pos.y < item_b.ysort_pos.y;
+    }
+};
+
+} // namespace
+
+// Uniform grid over the children of a canvas item, built once the item has enough children for walking all of them
+// every frame to matter. Each child is registered in every cell overlapped by the bounds of its whole subtree, in
+// the owner's local space. Children covering too many cells are kept in a separate list, as are children whose
+// extent is unknown until they are drawn; both are visited on every query.
+struct CanvasItemCullIndex {
+    enum {
+        MIN_CHILDREN = 128,
+        MAX_ITEM_CELLS = 16,
+    };
+
+    HashMap<uint64_t, Vector<RenderingEntity>> cells;
+    Vector<RenderingEntity> large;
+    Vector<RenderingEntity> unbounded;
+    Vector<RenderingEntity> dirty; // children whose registration may be stale
+    Vector<RenderingEntity> visible; // result of the last query
+    Rect2 bounds; // grows only, reset when the index is rebuilt
+    real_t cell_size = 16;
+    uint32_t pass = 0;
+    bool has_bounds = false;
+};
+
+namespace {
+
+constexpr real_t CULL_MIN_CELL_SIZE = 16;
+
+uint64_t _cull_cell_key(int p_x, int p_y) {
+    return (uint64_t(uint32_t(p_x)) << 32) | uint32_t(p_y);
+}
+
+bool _cull_cell_range(const CanvasItemCullIndex *p_index, const Rect2 &p_rect, Rect2i &r_cells) {
+    // Also rejects NaN and anything far enough out to overflow the cell coordinates.
+    const real_t limit = p_index->cell_size * real_t(1 << 20);
+    if (!(Math::abs(p_rect.position.x) < limit && Math::abs(p_rect.position.y) < limit && p_rect.size.x < limit &&
+                p_rect.size.y < limit)) {
+        return false;
+    }
+
+    const Point2 end = p_rect.position + p_rect.size;
+    const int from_x = int(Math::floor(p_rect.position.x / p_index->cell_size));
+    const int from_y = int(Math::floor(p_rect.position.y / p_index->cell_size));
+    const int to_x = int(Math::floor(end.x / p_index->cell_size));
+    const int to_y = int(Math::floor(end.y / p_index->cell_size));
+    r_cells = Rect2i(from_x, from_y, to_x - from_x + 1, to_y - from_y + 1);
+    return true;
+}
+
+// Items whose drawn extent can change without any call on the canvas item, or that need processing while visible.
+bool _cull_is_volatile(const RenderingCanvasItemComponent *ci) {
+    if (ci->update_when_visible || ci->vp_render || ci->copy_back_buffer) {
+        return true;
+    }
+    if (ci->custom_rect) {
+        return false;
+    }
+    if (ci->skeleton != entt::null) {
+        return true;
+    }
+    for (const RasterizerCanvas::Item::Command *c : ci->commands) {
+        if (c->type == RasterizerCanvas::Item::Command::TYPE_MESH ||
+                c->type == RasterizerCanvas::Item::Command::TYPE_MULTIMESH ||
+                c->type == RasterizerCanvas::Item::Command::TYPE_PARTICLES) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void _cull_mark_dirty(RenderingCanvasItemComponent *ci) {
+    while (ci) {
+        RenderingCanvasItemComponent *parent = get<RenderingCanvasItemComponent>(ci->parent);
+        if (parent && parent->cull_index && !ci->cull_queued) {
+            ci->cull_queued = true;
+            parent->cull_index->dirty.push_back(ci->self);
+        }
+        // Anything above an already dirty item is dirty as well.
+        if (ci->cull_bounds_dirty) {
+            break;
+        }
+        ci->cull_bounds_dirty = true;
+        ci = parent;
+    }
+}
+
+void _cull_index_remove(CanvasItemCullIndex *p_index, RenderingCanvasItemComponent *p_child) {
+    switch (p_child->cull_slot) {
+        case RenderingCanvasItemComponent::CULL_SLOT_NONE:
+            break;
+        case RenderingCanvasItemComponent::CULL_SLOT_CELLS: {
+            const Rect2i &cells = p_child->cull_cells;
+            for (int y = cells.position.y; y < cells.position.y + cells.size.y; y++) {
+                for (int x = cells.position.x; x < cells.position.x + cells.size.x; x++) {
+                    auto iter = p_index->cells.find(_cull_cell_key(x, y));
+                    if (iter != p_index->cells.end()) {
+                        iter->second.erase_first_unsorted(p_child->self);
+                    }
+                }
+            }
+        } break;
+        case RenderingCanvasItemComponent::CULL_SLOT_LARGE:
+            p_index->large.erase_first_unsorted(p_child->self);
+            break;
+        case RenderingCanvasItemComponent::CULL_SLOT_UNBOUNDED:
+            p_index->unbounded.erase_first_unsorted(p_child->self);
+            break;
+    }
+    p_child->cull_slot = RenderingCanvasItemComponent::CULL_SLOT_NONE;
+}
+
+// p_child bounds must be up to date.
+void _cull_index_insert(CanvasItemCullIndex *p_index, RenderingCanvasItemComponent *p_child) {
+    if (!p_child->visible) {
+        return;
+    }
+    if (p_child->cull_unbounded) {
+        p_index->unbounded.push_back(p_child->self);
+        p_child->cull_slot = RenderingCanvasItemComponent::CULL_SLOT_UNBOUNDED;
+        return;
+    }
+    if (!p_child->cull_has_bounds) {
+        return;
+    }
+
+    const Rect2 rect = p_child->xform.xform(p_child->cull_bounds);
+    p_index->bounds = p_index->has_bounds ? p_index->bounds.merge(rect) : rect;
+    p_index->has_bounds = true;
+
+    Rect2i cells;
+    if (!_cull_cell_range(p_index, rect, cells) || cells.size.x * cells.size.y > CanvasItemCullIndex::MAX_ITEM_CELLS) {
+        p_index->large.push_back(p_child->self);
+        p_child->cull_slot = RenderingCanvasItemComponent::CULL_SLOT_LARGE;
+        return;
+    }
+    for (int y = cells.position.y; y < cells.position.y + cells.size.y; y++) {
+        for (int x = cells.position.x; x < cells.position.x + cells.size.x; x++) {
+            p_index->cells[_cull_cell_key(x, y)].push_back(p_child->self);
+        }
+    }
+    p_child->cull_cells = cells;
+    p_child->cull_slot = RenderingCanvasItemComponent::CULL_SLOT_CELLS;
+}
+
+void _cull_index_free(RenderingCanvasItemComponent *ci) {
+    auto canvas_items_view(VSG::ecs->registry.view<RenderingCanvasItemComponent>());
+    for (RenderingEntity e : ci->child_items) {
+        auto &child = canvas_items_view.get<RenderingCanvasItemComponent>(e);
+        child.cull_slot = RenderingCanvasItemComponent::CULL_SLOT_NONE;
+        child.cull_queued = false;
+    }
+    memdelete(ci->cull_index);
+    ci->cull_index = nullptr;
+}
+
+void _update_cull_bounds(RenderingCanvasItemComponent *ci);
+
+void _cull_index_build(RenderingCanvasItemComponent *ci) {
+    auto canvas_items_view(VSG::ecs->registry.view<RenderingCanvasItemComponent>());
+    CanvasItemCullIndex *index = memnew(CanvasItemCullIndex);
+
+    // Cells a few times the typical child size, but not so small that most of them are empty.
+    real_t extent = 0;
+    int counted = 0;
+    Rect2 total;
+    for (RenderingEntity e : ci->child_items) {
+        auto &child = canvas_items_view.get<RenderingCanvasItemComponent>(e);
+        if (child.cull_bounds_dirty) {
+            _update_cull_bounds(&child);
+        }
+        child.cull_slot = RenderingCanvasItemComponent::CULL_SLOT_NONE;
+        child.cull_queued = false;
+        if (!child.visible || !child.cull_has_bounds || child.cull_unbounded) {
+            continue;
+        }
+        const Rect2 rect = child.xform.xform(child.cull_bounds);
+        total = counted ? total.merge(rect) : rect;
+        extent += rect.size.x + rect.size.y;
+        counted++;
+    }
+    if (counted) {
+        index->cell_size = M_MAX(extent * 2 / counted, CULL_MIN_CELL_SIZE);
+        index->cell_size = M_MAX(index->cell_size, Math::sqrt(total.get_area() / counted));
+    }
+
+    ci->cull_index = index;
+    for (RenderingEntity e : ci->child_items) {
+        _cull_index_insert(index, &canvas_items_view.get<RenderingCanvasItemComponent>(e));
+    }
+}
+
+void _update_cull_bounds(RenderingCanvasItemComponent *ci) {
+    auto canvas_items_view(VSG::ecs->registry.view<RenderingCanvasItemComponent>());
+
+    ci->cull_bounds_dirty = false;
+    ci->cull_unbounded = _cull_is_volatile(ci);
+    ci->cull_has_bounds = !ci->commands.empty();
+    if (ci->cull_has_bounds) {
+        ci->cull_bounds = ci->get_rect();
+    }
+
+    const bool wants_index = !ci->sort_y && ci->child_items.size() >= CanvasItemCullIndex::MIN_CHILDREN;
+    if (ci->cull_index && (ci->sort_y || ci->child_items.size() < CanvasItemCullIndex::MIN_CHILDREN / 2)) {
+        _cull_index_free(ci);
+    } else if (!ci->cull_index && wants_index) {
+        _cull_index_build(ci);
+    } else if (ci->cull_index) {
+        CanvasItemCullIndex *index = ci->cull_index;
+        for (RenderingEntity e : index->dirty) {
+            // Children take themselves off the list when they are freed or reparented, this only guards against a
+            // stale entity reaching try_get(), which asserts on destroyed ones.
+            auto *child = VSG::ecs->valid(e) ? VSG::ecs->try_get<RenderingCanvasItemComponent>(e) : nullptr;
+            if (!child || !(child->parent == ci->self)) {
+                continue;
+            }
+            child->cull_queued = false;
+            if (child->cull_bounds_dirty) {
+                _update_cull_bounds(child);
+            }
+            _cull_index_remove(index, child);
+            _cull_index_insert(index, child);
+        }
+        index->dirty.clear();
+    }
+
+    if (ci->cull_index) {
+        const CanvasItemCullIndex *index = ci->cull_index;
+        if (index->has_bounds) {
+            ci->cull_bounds = ci->cull_has_bounds ? ci->cull_bounds.merge(index->bounds) : index->bounds;
+            ci->cull_has_bounds = true;
+        }
+        ci->cull_unbounded |= !index->unbounded.empty();
+        return;
+    }
+
+    for (RenderingEntity e : ci->child_items) {
+        auto &child = canvas_items_view.get<RenderingCanvasItemComponent>(e);
+        if (child.cull_bounds_dirty) {
+            _update_cull_bounds(&child);
+        }
+        if (!child.visible) {
+            continue;
+        }
+        if (child.cull_unbounded) {
+            ci->cull_unbounded = true;
+        } else if (child.cull_has_bounds) {
+            const Rect2 rect = child.xform.xform(child.cull_bounds);
+            ci->cull_bounds = ci->cull_has_bounds ? ci->cull_bounds.merge(rect) : rect;
+            ci->cull_has_bounds = true;
+        }
+    }
+}
+
+// Children of ci that may be visible in p_view, in draw order. Returns null when walking all of them is cheaper.
+Vector<RenderingEntity> *_cull_index_query(RenderingCanvasItemComponent *ci, const Transform2D &p_xform, const Rect2 &p_view) {
+    auto canvas_items_view(VSG::ecs->registry.view<RenderingCanvasItemComponent>());
+    CanvasItemCullIndex *index = ci->cull_index;
+
+    if (Math::is_zero_approx(p_xform.basis_determinant())) {
+        return nullptr;
+    }
+    const Rect2 local_view = p_xform.affine_inverse().xform(p_view);
+    Rect2i range;
+    if (!_cull_cell_range(index, local_view, range) || int64_t(range.size.x) * range.size.y > int64_t(index->cells.size())) {
+        return nullptr;
+    }
+
+    index->pass++;
+    index->visible.clear();
+    auto visit = [&](RenderingEntity e) {
+        auto &child = canvas_items_view.get<RenderingCanvasItemComponent>(e);
+        if (child.cull_pass != index->pass) {
+            child.cull_pass = index->pass;
+            index->visible.push_back(e);
+        }
+    };
+    for (int y = range.position.y; y < range.position.y + range.size.y; y++) {
+        for (int x = range.position.x; x < range.position.x + range.size.x; x++) {
+            auto iter = index->cells.find(_cull_cell_key(x, y));
+            if (iter == index->cells.end()) {
+                continue;
+            }
+            for (RenderingEntity e : iter->second) {
+                visit(e);
+            }
+        }
+    }
+    for (RenderingEntity e : index->large) {
+        visit(e);
+    }
+    for (RenderingEntity e : index->unbounded) {
+        visit(e);
+    }
+
+    eastl::sort(index->visible.begin(), index->visible.end(), [&](RenderingEntity a, RenderingEntity b) -> bool {
+        return canvas_items_view.get<RenderingCanvasItemComponent>(a).draw_order <
+               canvas_items_view.get<RenderingCanvasItemComponent>(b).draw_order;
+    });
+    return &index->visible;
+}
+
 static void _collect_ysort_children(RenderingCanvasItemComponent *p_canvas_item, Transform2D p_transform,
         RenderingCanvasItemComponent *p_material_owner, const Color &p_modulate, RenderingEntity *r_items,
         int &r_index) {
@@ -78,12 +391,12 @@ static void _collect_ysort_children(RenderingCanvasItemComponent *p_canvas_item,
         if (child.visible) {
             if (r_items) {
                 r_items[r_index] = child_items[i];
-                child.ysort_modulate = p_modulate;
-                child.ysort_xform = p_transform;
-                child.ysort_pos = p_transform.xform(child.xform.elements[2]);
-                child.material_owner = child.use_parent_material ? p_material_owner : nullptr;
-                child.ysort_index = r_index;
             }
+            child.ysort_modulate = p_modulate;
+            child.ysort_xform = p_transform;
+            child.ysort_pos = p_transform.xform(child.xform.elements[2]);
+            child.material_owner = child.use_parent_material ? p_material_owner : nullptr;
+            child.ysort_index = r_index;
 
             r_index++;
 
@@ -105,16 +418,30 @@ void _render_canvas_item(RenderingEntity p_canvas_item, const Transform2D &p_tra
     if (!ci->visible) {
         return;
     }
-    
+
+    if (ci->cull_bounds_dirty) {
+        _update_cull_bounds(ci);
+    }
+
+    Transform2D xform = ci->xform;
+    xform = p_transform * xform;
+    // Same test as the one for drawing the item itself below, applied to the whole subtree. Grown a bit so float
+    // differences between the two never reject something that would have been drawn.
+    const Rect2 view_rect = Rect2(Point2(), p_clip_rect.size).grow(1);
+    if (!ci->cull_unbounded && (!ci->cull_has_bounds || !view_rect.intersects(xform.xform(ci->cull_bounds), true))) {
+        return;
+    }
+
     if (ci->children_order_dirty) {
 
         eastl::sort(ci->child_items.begin(),ci->child_items.end(),ItemIndexSort());
         ci->children_order_dirty = false;
+        for (size_t i = 0; i < ci->child_items.size(); i++) {
+            canvas_items_view.get<RenderingCanvasItemComponent>(ci->child_items[i]).draw_order = i;
+        }
     }
 
     Rect2 rect = ci->get_rect();
-    Transform2D xform = ci->xform;
-    xform = p_transform * xform;
     Rect2 global_rect = xform.xform(rect);
     global_rect.position += p_clip_rect.position;
 
@@ -152,23 +479,27 @@ void _render_canvas_item(RenderingEntity p_canvas_item, const Transform2D &p_tra
         if (ci->ysort_children_count == -1) {
             ci->ysort_children_count = 0;
             _collect_ysort_children(ci, Transform2D(), p_material_owner, Color(1, 1, 1, 1), nullptr, ci->ysort_children_count);
+
+            ci->ysort_order.resize(ci->ysort_children_count);
+            int i = 0;
+            _collect_ysort_children(ci, Transform2D(), p_material_owner, Color(1, 1, 1, 1), ci->ysort_order.data(), i);
+            eastl::sort(ci->ysort_order.begin(), ci->ysort_order.end(), YSortCompare());
+        } else {
+            // Same children as last time, only refresh their positions. The previous order is nearly sorted when
+            // few of them moved, which is the cheap case for insertion sort.
+            int i = 0;
+            _collect_ysort_children(ci, Transform2D(), p_material_owner, Color(1, 1, 1, 1), nullptr, i);
+            eastl::insertion_sort(ci->ysort_order.begin(), ci->ysort_order.end(), YSortCompare());
         }
 
         child_item_count = ci->ysort_children_count;
-        child_items = (RenderingEntity *)alloca(child_item_count * sizeof(RenderingEntity));
-
-        int i = 0;
-        _collect_ysort_children(ci, Transform2D(), p_material_owner, Color(1, 1, 1, 1), child_items, i);
-
-        eastl::sort(child_items,child_items+child_item_count,[&](RenderingEntity a,RenderingEntity b)->bool {
-            auto & item_a(canvas_items_view.get<RenderingCanvasItemComponent>(a));
-            auto & item_b(canvas_items_view.get<RenderingCanvasItemComponent>(b));
-            if (Math::is_equal_approx(item_a.ysort_pos.y, item_b.ysort_pos.y)) {
-                return item_a.ysort_index < item_b.ysort_index;
-            }
-
-            return item_a.ysort_pos.y < item_b.ysort_pos.y;
-        });
+        child_items = ci->ysort_order.data();
+    } else if (ci->cull_index) {
+        Vector<RenderingEntity> *visible = _cull_index_query(ci, xform, view_rect);
+        if (visible) {
+            child_item_count = visible->size();
+            child_items = visible->data();
+        }
     }
 
     if (ci->z_relative)
@@ -392,9 +723,17 @@ void RenderingServerCanvas::canvas_item_set_parent(RenderingEntity p_item, Rende
             if (old_canvas_item_parent->sort_y) {
                 _mark_ysort_dirty(old_canvas_item_parent);
             }
+            if (old_canvas_item_parent->cull_index) {
+                _cull_index_remove(old_canvas_item_parent->cull_index, canvas_item);
+                if (canvas_item->cull_queued) {
+                    old_canvas_item_parent->cull_index->dirty.erase_first_unsorted(p_item);
+                }
+            }
+            _cull_mark_dirty(old_canvas_item_parent);
         }
 
         canvas_item->parent = entt::null;
+        canvas_item->cull_queued = false;
     }
 
     if (new_canvas_parent||new_canvas_item_parent) {
@@ -420,6 +759,9 @@ void RenderingServerCanvas::canvas_item_set_parent(RenderingEntity p_item, Rende
     }
 
     canvas_item->parent = p_parent;
+    // Force the walk up, the item may already be dirty from before it was moved here.
+    canvas_item->cull_bounds_dirty = false;
+    _cull_mark_dirty(canvas_item);
 }
 void RenderingServerCanvas::canvas_item_set_visible(RenderingEntity p_item, bool p_visible) {
 
@@ -429,6 +771,7 @@ void RenderingServerCanvas::canvas_item_set_visible(RenderingEntity p_item, bool
     canvas_item->visible = p_visible;
 
     _mark_ysort_dirty(canvas_item);
+    _cull_mark_dirty(canvas_item);
 }
 void RenderingServerCanvas::canvas_item_set_light_mask(RenderingEntity p_item, int p_mask) {
 
@@ -444,6 +787,7 @@ void RenderingServerCanvas::canvas_item_set_transform(RenderingEntity p_item, co
     ERR_FAIL_COND(!canvas_item);
 
     canvas_item->xform = p_transform;
+    _cull_mark_dirty(canvas_item);
 }
 void RenderingServerCanvas::canvas_item_set_clip(RenderingEntity p_item, bool p_clip) {
 
@@ -466,6 +810,7 @@ void RenderingServerCanvas::canvas_item_set_custom_rect(RenderingEntity p_item,
 
     canvas_item->custom_rect = p_custom_rect;
     canvas_item->rect = p_rect;
+    _cull_mark_dirty(canvas_item);
 }
 void RenderingServerCanvas::canvas_item_set_modulate(RenderingEntity p_item, const Color &p_color) {
 
@@ -496,6 +841,7 @@ void RenderingServerCanvas::canvas_item_set_update_when_visible(RenderingEntity
     ERR_FAIL_COND(!canvas_item);
 
     canvas_item->update_when_visible = p_update;
+    _cull_mark_dirty(canvas_item);
 }
 
 void RenderingServerCanvas::canvas_item_add_line(RenderingEntity p_item, const Point2 &p_from, const Point2 &p_to, const Color &p_color, float p_width, bool p_antialiased) {
@@ -542,6 +888,7 @@ void RenderingServerCanvas::canvas_item_add_line(RenderingEntity p_item, const P
     line->width = p_width;
     line->antialiased = p_antialiased;
     canvas_item->rect_dirty = true;
+    _cull_mark_dirty(canvas_item);
 
     canvas_item->commands.push_back(line);
 }
@@ -625,6 +972,7 @@ void RenderingServerCanvas::canvas_item_add_polyline(RenderingEntity  p_item, Sp
         }
     }
     canvas_item->rect_dirty = true;
+    _cull_mark_dirty(canvas_item);
     canvas_item->commands.push_back(pline);
 }
 
@@ -649,6 +997,7 @@ void RenderingServerCanvas::canvas_item_add_multiline(RenderingEntity  p_item, S
     }
 
     canvas_item->rect_dirty = true;
+    _cull_mark_dirty(canvas_item);
     canvas_item->commands.push_back(pline);
 }
 
@@ -662,6 +1011,7 @@ void RenderingServerCanvas::canvas_item_add_rect(RenderingEntity p_item, const R
     rect->modulate = p_color;
     rect->rect = p_rect;
     canvas_item->rect_dirty = true;
+    _cull_mark_dirty(canvas_item);
 
     canvas_item->commands.push_back(rect);
 }
@@ -676,6 +1026,8 @@ void RenderingServerCanvas::canvas_item_add_circle(RenderingEntity p_item, const
     circle->color = p_color;
     circle->pos = p_pos;
     circle->radius = p_radius;
+    canvas_item->rect_dirty = true;
+    _cull_mark_dirty(canvas_item);
 
     canvas_item->commands.push_back(circle);
 }
@@ -714,6 +1066,7 @@ void RenderingServerCanvas::canvas_item_add_texture_rect(RenderingEntity p_item,
     rect->texture = p_texture;
     rect->normal_map = p_normal_map;
     canvas_item->rect_dirty = true;
+    _cull_mark_dirty(canvas_item);
     canvas_item->commands.push_back(rect);
 }
 
@@ -762,6 +1115,7 @@ void RenderingServerCanvas::canvas_item_add_texture_rect_region(RenderingEntity
     }
 
     canvas_item->rect_dirty = true;
+    _cull_mark_dirty(canvas_item);
 
     canvas_item->commands.push_back(rect);
 }
@@ -786,6 +1140,7 @@ void RenderingServerCanvas::canvas_item_add_nine_patch(RenderingEntity p_item, c
     style->axis_x = p_x_axis_mode;
     style->axis_y = p_y_axis_mode;
     canvas_item->rect_dirty = true;
+    _cull_mark_dirty(canvas_item);
 
     canvas_item->commands.push_back(style);
 }
@@ -803,6 +1158,7 @@ void RenderingServerCanvas::canvas_item_add_primitive(RenderingEntity  p_item, S
     prim->colors.assign(p_colors.begin(),p_colors.end());
     prim->width = p_width;
     canvas_item->rect_dirty = true;
+    _cull_mark_dirty(canvas_item);
 
     canvas_item->commands.push_back(prim);
 }
@@ -834,6 +1190,7 @@ void RenderingServerCanvas::canvas_item_add_polygon(RenderingEntity p_item, Span
     polygon->antialiased = p_antialiased;
     polygon->antialiasing_use_indices = false;
     canvas_item->rect_dirty = true;
+    _cull_mark_dirty(canvas_item);
 
     canvas_item->commands.push_back(polygon);
 }
@@ -881,6 +1238,7 @@ void RenderingServerCanvas::canvas_item_add_triangle_array(RenderingEntity p_ite
     polygon->antialiased = p_antialiased;
     polygon->antialiasing_use_indices = p_antialiasing_use_indices;
     canvas_item->rect_dirty = true;
+    _cull_mark_dirty(canvas_item);
 
     canvas_item->commands.push_back(polygon);
 }
@@ -893,6 +1251,9 @@ void RenderingServerCanvas::canvas_item_add_set_transform(RenderingEntity p_item
     RenderingCanvasItemComponent::CommandTransform *tr = memnew(RenderingCanvasItemComponent::CommandTransform);
     ERR_FAIL_COND(!tr);
     tr->xform = p_transform;
+    // Every command after this one is drawn in the new transform, which moves the item's bounds.
+    canvas_item->rect_dirty = true;
+    _cull_mark_dirty(canvas_item);
 
     canvas_item->commands.push_back(tr);
 }
@@ -910,6 +1271,8 @@ void RenderingServerCanvas::canvas_item_add_mesh(RenderingEntity  p_item, const
     m->transform = p_transform;
     m->modulate = p_modulate;
 
+    canvas_item->rect_dirty = true;
+    _cull_mark_dirty(canvas_item);
     canvas_item->commands.push_back(m);
 }
 void RenderingServerCanvas::canvas_item_add_particles(RenderingEntity p_item, RenderingEntity p_particles, RenderingEntity p_texture, RenderingEntity p_normal) {
@@ -927,6 +1290,7 @@ void RenderingServerCanvas::canvas_item_add_particles(RenderingEntity p_item, Re
     VSG::storage->particles_request_process(p_particles);
 
     canvas_item->rect_dirty = true;
+    _cull_mark_dirty(canvas_item);
     canvas_item->commands.push_back(part);
 }
 
@@ -942,6 +1306,7 @@ void RenderingServerCanvas::canvas_item_add_multimesh(RenderingEntity p_item, Re
     mm->normal_map = p_normal_map;
 
     canvas_item->rect_dirty = true;
+    _cull_mark_dirty(canvas_item);
     canvas_item->commands.push_back(mm);
 }
 
@@ -964,6 +1329,7 @@ void RenderingServerCanvas::canvas_item_set_sort_children_by_y(RenderingEntity p
     canvas_item->sort_y = p_enable;
 
     _mark_ysort_dirty(canvas_item);
+    _cull_mark_dirty(canvas_item);
 }
 void RenderingServerCanvas::canvas_item_set_z_index(RenderingEntity p_item, int p_z) {
 
@@ -988,6 +1354,7 @@ void RenderingServerCanvas::canvas_item_attach_skeleton(RenderingEntity p_item,
     ERR_FAIL_COND(!canvas_item);
 
     canvas_item->skeleton = p_skeleton;
+    _cull_mark_dirty(canvas_item);
 }
 
 void RenderingServerCanvas::canvas_item_set_copy_to_backbuffer(RenderingEntity p_item, bool p_enable, const Rect2 &p_rect) {
@@ -1007,6 +1374,7 @@ void RenderingServerCanvas::canvas_item_set_copy_to_backbuffer(RenderingEntity p
         canvas_item->copy_back_buffer->rect = p_rect;
         canvas_item->copy_back_buffer->full = p_rect == Rect2();
     }
+    _cull_mark_dirty(canvas_item);
 }
 
 void RenderingServerCanvas::canvas_item_clear(RenderingEntity p_item) {
@@ -1015,6 +1383,7 @@ void RenderingServerCanvas::canvas_item_clear(RenderingEntity p_item) {
     ERR_FAIL_COND(!canvas_item);
 
     canvas_item->clear();
+    _cull_mark_dirty(canvas_item);
 }
 void RenderingServerCanvas::canvas_item_set_draw_index(RenderingEntity p_item, int p_index) {
 
@@ -1462,12 +1831,26 @@ void RenderingCanvasItemComponent::release_resources() {
             if (parent_canvas_item->sort_y) {
                 _mark_ysort_dirty(parent_canvas_item);
             }
+            if (parent_canvas_item->cull_index) {
+                _cull_index_remove(parent_canvas_item->cull_index, this);
+                if (cull_queued) {
+                    parent_canvas_item->cull_index->dirty.erase_first_unsorted(self);
+                }
+            }
+            _cull_mark_dirty(parent_canvas_item);
         }
     }
     for (int i = 0; i < child_items.size(); i++) {
-        view.get<RenderingCanvasItemComponent>(child_items[i]).parent = entt::null;
+        auto &child = view.get<RenderingCanvasItemComponent>(child_items[i]);
+        child.parent = entt::null;
+        child.cull_slot = CULL_SLOT_NONE;
+        child.cull_queued = false;
         //child_items[i]->parent = entt::null;
     }
+    if (cull_index) {
+        memdelete(cull_index);
+        cull_index = nullptr;
+    }
     //TODO: investigate releasiong material ownership here ?
     /*
     if (canvas_item->material) {
@@ -1495,6 +1878,19 @@ RenderingCanvasItemComponent &RenderingCanvasItemComponent::operator=(RenderingC
     ysort_xform = from.ysort_xform;
     ysort_pos = from.ysort_pos;
     ysort_index = from.ysort_index;
+    child_items = eastl::move(from.child_items);
+    ysort_order = eastl::move(from.ysort_order);
+    cull_index = from.cull_index;
+    from.cull_index = nullptr;
+    cull_bounds = from.cull_bounds;
+    cull_cells = from.cull_cells;
+    cull_pass = from.cull_pass;
+    draw_order = from.draw_order;
+    cull_slot = from.cull_slot;
+    cull_bounds_dirty = from.cull_bounds_dirty;
+    cull_has_bounds = from.cull_has_bounds;
+    cull_unbounded = from.cull_unbounded;
+    cull_queued = from.cull_queued;
 
     return *this;
 }
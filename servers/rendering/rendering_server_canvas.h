@@ -33,6 +33,8 @@
 #include "rasterizer.h"
 #include "rendering_server_viewport.h"
 
+struct CanvasItemCullIndex;
+
 struct RenderingCanvasItemComponent : public RasterizerCanvas::Item {
 
     MoveOnlyEntityHandle parent; // canvas it belongs to
@@ -50,8 +52,26 @@ struct RenderingCanvasItemComponent : public RasterizerCanvas::Item {
     Transform2D ysort_xform;
     Vector2 ysort_pos;
     int ysort_index=0;
+    // Culling state, see _update_cull_bounds() in rendering_server_canvas.cpp
+    enum CullSlot : uint8_t {
+        CULL_SLOT_NONE, // not registered in the parent's index
+        CULL_SLOT_CELLS,
+        CULL_SLOT_LARGE,
+        CULL_SLOT_UNBOUNDED,
+    };
+    CanvasItemCullIndex *cull_index = nullptr; // spatial index over child_items, only for items with many children
+    Rect2 cull_bounds; // this item and everything below it, in local space
+    Rect2i cull_cells; // cells of the parent's index this item is registered in
+    uint32_t cull_pass = 0;
+    int draw_order = 0; // position in the parent's sorted child_items
+    CullSlot cull_slot = CULL_SLOT_NONE;
+    bool cull_bounds_dirty = true;
+    bool cull_has_bounds = false; // false when nothing below draws
+    bool cull_unbounded = false; // something below has no reliable rect, never culled
+    bool cull_queued = false; // waiting in the parent's index dirty list
 
     Vector<RenderingEntity> child_items;
+    Vector<RenderingEntity> ysort_order; // persistent y-sorted order of the collected children
 
     void release_resources();
     RenderingCanvasItemComponent(const RenderingCanvasItemComponent &) = delete;
@@ -306,6 +306,7 @@ public:
     BIND1RC(int, skeleton_get_bone_count, RenderingEntity)
     BIND3(skeleton_bone_set_transform, RenderingEntity, int, const Transform &)
     BIND2RC(Transform, skeleton_bone_get_transform, RenderingEntity, int)
+    BIND2(skeleton_set_bone_transforms, RenderingEntity, Span<const Transform>)
     BIND3(skeleton_bone_set_transform_2d, RenderingEntity, int, const Transform2D &)
     BIND2RC(Transform2D, skeleton_bone_get_transform_2d, RenderingEntity, int)
     BIND2(skeleton_set_base_transform_2d, RenderingEntity, const Transform2D &)
@@ -245,6 +245,13 @@ public:
     FUNC1RC(int, skeleton_get_bone_count, RenderingEntity)
     FUNC3(skeleton_bone_set_transform, RenderingEntity, int, const Transform &)
     FUNC2RC(Transform, skeleton_bone_get_transform, RenderingEntity, int)
+    void skeleton_set_bone_transforms(RenderingEntity p1, Span<const Transform> p2) override {
+        assert(Thread::get_caller_id() != server_thread);
+        // the caller reuses its buffer every frame, the queued call needs its own copy
+        command_queue.push([p1, p2 = Vector<Transform>(p2.begin(), p2.end())]() {
+            submission_thread_singleton->skeleton_set_bone_transforms(p1, p2);
+        });
+    }
     FUNC3(skeleton_bone_set_transform_2d, RenderingEntity, int, const Transform2D &)
     FUNC2RC(Transform2D, skeleton_bone_get_transform_2d, RenderingEntity, int)
     FUNC2(skeleton_set_base_transform_2d, RenderingEntity, const Transform2D &)
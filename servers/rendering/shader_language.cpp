@@ -489,20 +489,22 @@ ShaderLanguage::Token ShaderLanguage::_get_token() {
                         CASE_MAX,
                     } lut_case = CASE_ALL;
 
-                    static bool suffix_lut[CASE_MAX][127];
-                    if (!is_const_suffix_lut_initialized) {
-                        is_const_suffix_lut_initialized = true;
-
-                        for (int i = 0; i < 127; i++) {
-                            char t = char(i);
-
-                            suffix_lut[CASE_ALL][i] = t == '.' || t == 'x' || t == 'e' || t == 'f' || t == 'u' || t == '-' || t == '+';
-                            suffix_lut[CASE_HEXA_PERIOD][i] = t == 'e' || t == 'f';
-                            suffix_lut[CASE_EXPONENT][i] = t == 'f' || t == '-' || t == '+';
-                            suffix_lut[CASE_SIGN_AFTER_EXPONENT][i] = t == 'f';
-                            suffix_lut[CASE_NONE][i] = false;
+                    // built once by the first parser to get here, shaders may be parsed on several threads
+                    struct SuffixLut {
+                        bool table[CASE_MAX][127];
+                        SuffixLut() {
+                            for (int i = 0; i < 127; i++) {
+                                char t = char(i);
+
+                                table[CASE_ALL][i] = t == '.' || t == 'x' || t == 'e' || t == 'f' || t == 'u' || t == '-' || t == '+';
+                                table[CASE_HEXA_PERIOD][i] = t == 'e' || t == 'f';
+                                table[CASE_EXPONENT][i] = t == 'f' || t == '-' || t == '+';
+                                table[CASE_SIGN_AFTER_EXPONENT][i] = t == 'f';
+                                table[CASE_NONE][i] = false;
+                            }
                         }
-                    }
+                    };
+                    static const SuffixLut suffix_lut;
 
                     String str;
                     int i = 0;
@@ -515,7 +517,7 @@ ShaderLanguage::Token ShaderLanguage::_get_token() {
                                 error = true;
                             }
                         } else {
-                            if (symbol < 0x7F && suffix_lut[lut_case][symbol]) {
+                            if (symbol < 0x7F && suffix_lut.table[lut_case][symbol]) {
                                 if (symbol == 'x') {
                                     hexa_found = true;
                                     lut_case = CASE_HEXA_PERIOD;
@@ -885,7 +887,49 @@ void ShaderLanguage::clear() {
     while (nodes) {
         Node *n = nodes;
         nodes = nodes->next;
-        memdelete(n);
+        n->~Node();
+    }
+    arena.reset();
+}
+
+void *ShaderLanguage::NodeArena::alloc(size_t p_size, size_t p_align) {
+
+    while (current < pages.size()) {
+        const Page &page = pages[current];
+        const size_t start = (offset + p_align - 1) & ~(p_align - 1);
+        if (start + p_size <= page.size) {
+            offset = start + p_size;
+            return page.data + start;
+        }
+        current++;
+        offset = 0;
+    }
+
+    // Pages come from memalloc, which is aligned enough for any node.
+    Page page;
+    page.size = M_MAX(PAGE_SIZE, p_size);
+    page.data = (uint8_t *)memalloc(page.size);
+    pages.push_back(page);
+    current = pages.size() - 1;
+    offset = p_size;
+    return page.data;
+}
+
+void ShaderLanguage::NodeArena::reset() {
+
+    // a few pages are kept for the next shader, anything a huge shader needed on top is returned
+    while (pages.size() > KEPT_PAGES) {
+        memfree(pages.back().data);
+        pages.pop_back();
+    }
+    current = 0;
+    offset = 0;
+}
+
+ShaderLanguage::NodeArena::~NodeArena() {
+
+    for (const Page &page : pages) {
+        memfree(page.data);
     }
 }
 
@@ -912,8 +956,9 @@ bool ShaderLanguage::_find_identifier(const BlockNode *p_block, const HashMap<St
 
     while (p_block) {
 
-        if (p_block->variables.contains(p_identifier)) {
-            const auto &var(p_block->variables.at(p_identifier));
+        auto var_iter = p_block->variables.find(p_identifier);
+        if (var_iter != p_block->variables.end()) {
+            const BlockNode::Variable &var(var_iter->second);
             if (r_data_type) {
                 *r_data_type = var.type;
             }
@@ -2126,7 +2171,6 @@ const ShaderLanguage::BuiltinFuncDef ShaderLanguage::builtin_func_defs[] = {
     { nullptr, TYPE_VOID, { TYPE_VOID }, TAG_GLOBAL, false }
 
 };
-bool ShaderLanguage::is_const_suffix_lut_initialized = false;
 
 const ShaderLanguage::BuiltinFuncOutArgs ShaderLanguage::builtin_func_out_args[] = {
     //constructors
@@ -6466,7 +6510,7 @@ Error ShaderLanguage::_parse_shader(const HashMap<StringName, FunctionInfo> &p_f
                                         return ERR_PARSE_ERROR;
                                     }
                                 }
-                                ConstantNode *expr = memnew(ConstantNode);
+                                ConstantNode *expr = alloc_node<ConstantNode>();
 
                                 expr->datatype = constant.type;
 
@@ -6996,7 +7040,7 @@ Error ShaderLanguage::complete(const String &p_code, const HashMap<StringName, F
             if (completion_class == TAG_GLOBAL) {
                 while (block) {
                     if (comp_ident) {
-                        for (const eastl::pair<const StringName,BlockNode::Variable> &E : block->variables) {
+                        for (const eastl::pair<StringName,BlockNode::Variable> &E : block->variables) {
 
                             if (E.second.line < completion_line) {
                                 matches.emplace(E.first, ScriptCodeCompletionOption::KIND_VARIABLE);
@@ -38,6 +38,8 @@
 #include "core/typedefs.h"
 #include "core/variant.h"
 
+#include "EASTL/vector_map.h"
+
 class ShaderLanguage {
 
 public:
@@ -349,14 +351,39 @@ public:
         virtual ~Node() = default;
     };
 
+    // Bump allocator for the AST of one shader. clear() runs the node destructors and rewinds it,
+    // so parsing the next shader reuses the same pages instead of hitting the heap once per node.
+    class NodeArena {
+        struct Page {
+            uint8_t *data;
+            size_t size;
+        };
+        Vector<Page> pages;
+        size_t current = 0;
+        size_t offset = 0;
+
+    public:
+        static constexpr size_t PAGE_SIZE = 32768;
+        static constexpr size_t KEPT_PAGES = 4;
+
+        void *alloc(size_t p_size, size_t p_align);
+        void reset();
+
+        NodeArena() = default;
+        NodeArena(const NodeArena &) = delete;
+        NodeArena &operator=(const NodeArena &) = delete;
+        ~NodeArena();
+    };
+
     template <class T>
     T *alloc_node() {
-        T *node = memnew(T);
+        T *node = memnew_placement(arena.alloc(sizeof(T), alignof(T)), T);
         node->next = nodes;
         nodes = node;
         return node;
     }
 
+    NodeArena arena;
     Node *nodes=nullptr;
 
     struct OperatorNode : public Node {
@@ -490,7 +517,8 @@ public:
 
         FunctionNode *parent_function=nullptr;
         BlockNode *parent_block=nullptr;
-        HashMap<StringName, Variable> variables;
+        // blocks declare a handful of variables, a sorted vector beats hashing them
+        eastl::vector_map<StringName, Variable> variables;
         Vector<Node *> statements;
         int block_type=BLOCK_TYPE_STANDART;
         SubClassTag block_tag=SubClassTag::TAG_GLOBAL;
@@ -817,8 +845,6 @@ private:
     static const BuiltinFuncDef builtin_func_defs[];
     static const BuiltinFuncOutArgs builtin_func_out_args[];
 
-    static bool is_const_suffix_lut_initialized;
-
     bool _compare_datatypes_in_nodes(Node *a, Node *b) const;
 
     bool _validate_function_call(BlockNode *p_block, OperatorNode *p_func, DataType *r_ret_type, StringName *r_ret_type_str);